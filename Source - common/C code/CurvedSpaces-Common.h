@@ -11,19 +11,19 @@
 #include "GeometryGames-Common.h"
 #include "GeometryGamesMatrix44.h"
 #include "GeometryGamesUtilities-SIMD.h"
+#include <stdatomic.h>	//	for atomic_bool
 
 
-//	Don't let the user open more than one window at once.  
+//	Let the user open more than one window at once.
 //	On my 2006 iMac's Radeon X1600, opening 2 or 3 windows 
 //	with depth buffers, or 3 or 4 windows without depth buffers, 
-//	suddenly brings the computer to a near standstill.
-//	On my 2008 MacBook's GeForce 9400M the problem seems not to occur.
-//	To enable multiple-window support for testing purposes, 
-//	uncomment the following line.
-//#define ALLOW_MULTIPLE_WINDOWS
-#ifdef ALLOW_MULTIPLE_WINDOWS
-#warning ALLOW_MULTIPLE_WINDOWS is enabled
-#endif
+//	once brought the computer to a near standstill.
+//	The renderers now share their pipeline states, textures and
+//	fixed meshes (see CurvedSpacesGPUResourceCache), and each window
+//	keeps its own ModelData and space loader, so an additional window
+//	costs only its own space's honeycomb and per-frame buffers.
+//	To restrict the app to a single window, comment out the following line.
+#define ALLOW_MULTIPLE_WINDOWS
 
 
 //	When the 3-torus is first introduced in the Shape of Space lecture,
@@ -135,6 +135,14 @@
 #warning SHAPE_OF_SPACE_CH_16 is enabled
 #endif
 
+//	To time space construction, mesh building and rendering
+//	over all the bundled Sample Spaces, and write the results
+//	as JSON, so two versions may be compared.
+//#define RUN_BENCHMARKS
+#ifdef RUN_BENCHMARKS
+#warning RUN_BENCHMARKS is enabled
+#endif
+
 #if (defined(SHAPE_OF_SPACE_CH_7) || defined(SHAPE_OF_SPACE_CH_15) || defined(SHAPE_OF_SPACE_CH_16))
 #define PRINT_USER_BODY_PLACEMENT
 #endif
@@ -150,6 +158,11 @@
 #define USER_SPEED_INCREMENT	0.02
 #define MAX_USER_SPEED			0.25
 
+//	A stereo view places the left and right eyes
+//	STEREO_EYE_SEPARATION apart, on either side of
+//	the observer's usual (cyclopean) viewpoint.
+#define STEREO_EYE_SEPARATION	0.01
+
 
 //	Clifford parallels options
 typedef enum
@@ -163,8 +176,9 @@ typedef enum
 } CliffordMode;
 
 
-//	Opaque typedef
-typedef struct HEPolyhedron	DirichletDomain;
+//	Opaque typedefs
+typedef struct HEPolyhedron		DirichletDomain;
+typedef struct TilingInProgress	TilingInProgress;
 
 
 //	Transparent typedefs
@@ -207,19 +221,118 @@ typedef struct
 	Matrix			*itsMatrices;
 } MatrixList;
 
+//	A finite group's Cayley table records the product of each
+//	(extended) generator with each group element, so that
+//	group elements may be referred to by their indices
+//	in the holonomy group, which are also their indices
+//	in the honeycomb's itsCells, and multiplied exactly.
+#define CAYLEY_NO_ELEMENT	0xFFFFFFFF
+typedef struct
+{
+	unsigned int	itsNumElements,			//	matches the holonomy group
+					itsNumGenerators;		//	generators and their distinct inverses
+	unsigned int	*itsProducts;			//	generator g times element e is element itsProducts[g*itsNumElements + e]
+	unsigned int	itsIdentityElement,
+					itsAntipodalElement;	//	CAYLEY_NO_ELEMENT if the group lacks the antipodal map
+} CayleyTable;
+
+//	An Arena hands out fixed-size elements from large blocks,
+//	so a structure with many small elements needs only a handful
+//	of allocations, keeps its elements close together in memory,
+//	and frees them all at once.  A recycled element goes onto
+//	a free list for re-use; its memory returns to the system
+//	only when FreeArena() frees the blocks.
+typedef struct ArenaBlock	ArenaBlock;
+typedef struct
+{
+	size_t			itsElementSize,			//	rounded up for alignment
+					itsElementsPerBlock;
+	ArenaBlock		*itsBlockList;			//	most recent block first
+	size_t			itsNumUsedInFirstBlock;
+	void			*itsFreeList;			//	recycled elements
+} Arena;
+
 typedef struct
 {
 	Matrix			itsMatrix;
 	Vector			itsCellCenterInWorldSpace;
-	double			itsDistanceCameraToCellCenter;
 } Honeycell;
+
+//	A HoneycellCenterBlock holds single-precision copies
+//	of four nearby cells' centers in world space,
+//	arranged so that CullAndSortVisibleCells() may transform
+//	and test all four at once.
+typedef struct
+{
+	simd_float4		itsX,
+					itsY,
+					itsZ,
+					itsW;
+	simd_uint4		itsCellIndices;	//	indices into itsCells, or 0xFFFFFFFF for padding
+} HoneycellCenterBlock;
+
+//	A HoneycellCluster is a ball containing the centers
+//	of the cells in some range of HoneycellCenterBlocks.
+//	The clusters form a binary tree, stored depth first,
+//	so a cluster's descendants immediately follow it,
+//	and itsNextCluster skips past them all.
+typedef struct
+{
+	Vector			itsCenter;			//	in world space
+	double			itsCoshSpread,		//	The cluster's cell centers all sit
+					itsSinhSpread,		//		within distance itsSpread of itsCenter.
+					itsSpread;
+	unsigned int	itsFirstBlock,
+					itsNumBlocks,
+					itsMinCellIndex,	//	lets CullAndSortVisibleCells() skip clusters hidden by TruncateHoneycomb()
+					itsNextCluster;
+	bool			itsLeafFlag;
+} HoneycellCluster;
+
+//	CullAndSortVisibleCells() sorts the visible cells
+//	by a key that increases with the distance from the camera
+//	to the cell center, namely -|cos(d)|, d² or cosh(d)
+//	according to the geometry, which it may compute
+//	without a transcendental function call.
+//	In the spherical case the key measures the distance
+//	to the nearer of the cell center and its antipodal point,
+//	because the two look the same size on the screen.
+//	itsKey holds that key's float bits, rearranged so that
+//	comparing them as unsigned integers gives the same order.
+typedef struct
+{
+	uint32_t		itsKey,
+					itsCellIndex;
+} HoneycellSortEntry;
+
 typedef struct
 {
 	//	A fixed list of the cells, sorted relative
 	//	to their distance from the basepoint (0,0,0,1).
-	unsigned int	itsNumCells;
+	//	TruncateHoneycomb() may hide the more distant cells
+	//	by reducing itsNumCells, but itsCells always holds
+	//	all itsNumAllocatedCells of them, so the hidden cells
+	//	may later be restored at no cost.
+	unsigned int	itsNumCells,
+					itsNumAllocatedCells;
 	Honeycell		*itsCells;
 
+	//	The cell centers again, four cells per block, for a faster cull.
+	//	The blocks appear in the order of the leaves of itsClusters,
+	//	not in the order of itsCells.  The last block gets padded
+	//	if itsNumAllocatedCells isn't a multiple of four.
+	HoneycellCenterBlock	*itsCellCenterBlocks;
+
+	//	A bounding-ball hierarchy over the cells, built once
+	//	when the honeycomb gets created, lets CullAndSortVisibleCells()
+	//	reject whole groups of cells at once.  itsClusters[0] is the root.
+	unsigned int			itsNumClusters;
+	HoneycellCluster		*itsClusters;
+
+	//	Scratch space for sorting the visible cells,
+	//	with room for 2 * itsNumAllocatedCells entries.
+	HoneycellSortEntry		*itsSortEntries;
+
 	//	At render time, we'll let CullAndSortVisibleCells() make a temporary list
 	//	of the visible cells and sort them according to their distance
 	//	from the observer (near to far).  While it's at it, CullAndSortVisibleCells()
@@ -233,8 +346,95 @@ typedef struct
 					itsNumVisiblePlainCells,		//	non mirror-reversed, after accounting for view matrix parity
 					itsNumVisibleReflectedCells;	//	    mirror-reversed, after accounting for view matrix parity
 	Honeycell		**itsVisibleCells;
+
+	//	The visible cells' sort entries, in the same order
+	//	as itsVisibleCells.  They point into itsSortEntries,
+	//	so CountVisibleCellsNearerThan() may find the distance
+	//	at which each level of detail takes over.
+	HoneycellSortEntry	*itsVisibleSortEntries;
 } Honeycomb;
 
+//	ConstructPendingSpace() notes how long each stage took,
+//	for the benchmark suite.
+typedef enum
+{
+	StageReadMatrices,
+	StageHolonomyGroup,		//	all BeginTiling(), ExtendTiling() and CopyTilingToHolonomyGroup() calls
+	StageDirichletDomain,	//	all ConstructDirichletDomain() calls
+	StageHoneycomb,
+	NumConstructionStages
+} ConstructionStage;
+
+//	A quick-and-dirty hack tiles the mirrored dodecahedron
+//	and the Seifert-Weber space (which have relatively large volumes)
+//	more deeply than the smaller-volume hyperbolic spaces.
+//	A more robust algorithm would examine the size
+//	of the fundamental domain.
+typedef enum
+{
+	HyperbolicSpaceGeneric,
+	HyperbolicSpaceMirroredDodecahedron,
+	HyperbolicSpaceSeifertWeber
+} HyperbolicSpaceType;
+
+//	A PendingSpace holds a freshly constructed space until
+//	InstallPendingSpace() moves it into the ModelData.
+//	Because ConstructPendingSpace() never touches the ModelData,
+//	it may run on a background thread while the previous space
+//	keeps animating.
+//
+//	A progressively loaded space arrives in several installments.
+//	InstallPendingSpace() installs the first one, which holds
+//	only the nearest cells, and each ExtendPendingSpace()
+//	prepares a larger honeycomb for InstallPendingHoneycomb()
+//	until the tiling reaches itsFullHorizonRadius.
+typedef struct
+{
+	SpaceType			itsSpaceType;
+	HyperbolicSpaceType	itsHyperbolicSpaceType;
+	double				itsHorizonRadius,		//	how far the current honeycomb reaches
+						itsFullHorizonRadius;	//	how far the complete honeycomb will reach
+	DirichletDomain		*itsDirichletDomain;
+	Honeycomb			*itsHoneycomb;
+	bool				itsDrawBackHemisphere,
+						itsThreeSphereFlag;
+
+	//	While a progressive load is under way, itsTiling keeps
+	//	the partial tiling so ExtendPendingSpace() may resume it.
+	//	Once the space is complete, the tiling and the generators
+	//	move into the ModelData along with the final honeycomb,
+	//	so that BeginHorizonChange() may extend the tiling further.
+	//	A space read from the cache gets its tiling from the cache too.
+	//	BeginHorizonChange() lends the tiling back to a PendingSpace
+	//	(with no generators) while a larger honeycomb gets built.
+	bool				itsCompleteFlag;
+	MatrixList			*itsGeneratorList;
+	TilingInProgress	*itsTiling;
+	double				itsTilingRadiusPadding;
+
+	//	A spherical space's tiling already holds the whole group
+	//	and never grows, so once the Cayley table has been read off it,
+	//	the table takes the tiling's place, here and in the cache.
+	CayleyTable			*itsCayleyTable;
+
+	//	A fresh space cache for the platform-dependent code to save,
+	//	or NULL if it wasn't requested or the existing cache was good.
+	//	By the time a progressive load completes, InstallPendingSpace()
+	//	has already taken the Dirichlet domain, so we keep
+	//	a cached copy of it for WriteSpaceCache().
+	bool				itsFreshCacheRequest;
+	uint64_t			itsCacheKey;
+	Byte				*itsDirichletDomainCacheData;
+	size_t				itsDirichletDomainCacheSize;
+	Byte				*itsFreshCacheData;
+	size_t				itsFreshCacheSize;
+
+	//	Seconds spent in each stage of construction so far.
+	//	A space read from the cache spends no time
+	//	in the later stages.
+	double				itsStageSeconds[NumConstructionStages];
+} PendingSpace;
+
 typedef enum
 {
 	CenterpieceNone,
@@ -287,7 +487,12 @@ struct ModelData
 	//	with the fogging reaching pure black just as it reaches itsHorizonRadius.
 	//	itsHorizonRadius determines how far out we tile.
 	//	Set it carefully to get a good balance between image quality and performance.
-	double			itsHorizonRadius;
+	//	BeginHorizonChange() may change it at run time.  The user steps
+	//	itsRequestedHorizonRadius nearer or farther from itsDefaultHorizonRadius,
+	//	and itsHorizonRadius catches up once any larger honeycomb is ready.
+	double			itsHorizonRadius,
+					itsDefaultHorizonRadius,
+					itsRequestedHorizonRadius;
 	
 	//	Keep track of the user's placement in the world.  itsUserBodyPlacement moves
 	//	the user's body from its default position (0,0,0,1) with right vector (1,0,0,0),
@@ -320,6 +525,20 @@ struct ModelData
 	//	the whole finite group.  For all manifolds the list
 	//	is sorted near-to-far. 
 	Honeycomb		*itsHoneycomb;
+
+	//	Keep the generators and, once BeginHorizonChange() needs it,
+	//	the tiling that produced itsHoneycomb, so that the horizon
+	//	may recede without re-tiling from scratch.  Both stay NULL
+	//	until a progressively loaded space is complete, and itsTiling
+	//	is NULL while BeginHorizonChange() has lent it out,
+	//	or always for a spherical space, whose horizon never moves.
+	//	The honeycomb's full array of cells reaches out to
+	//	itsHoneycombTilingRadius, while the visible cells reach only to
+	//	itsHorizonRadius + itsTilingRadiusPadding.
+	MatrixList		*itsGeneratorList;
+	TilingInProgress	*itsTiling;
+	double			itsTilingRadiusPadding,
+					itsHoneycombTilingRadius;
 	
 	//	The aperture in each face of the Dirichlet domain may be
 	//	fully closed (0.0), fully open (1.0), or anywhere in between.
@@ -334,7 +553,9 @@ struct ModelData
 	//	to re-create the mesh that it uses to represent
 	//	the Dirichlet domain with apertures cut into its faces.
 	//	That mesh will need to be re-created whenever
-	//	either the aperture or the Dirichlet domain itself changes.
+	//	the color coding or the Dirichlet domain itself changes.
+	//	The aperture doesn't enter into the mesh:
+	//	the vertex function applies it.
 	bool			itsDirichletWallsMeshNeedsRefresh;
 	
 	//	Set a flag to let the platform-dependent code know
@@ -343,6 +564,13 @@ struct ModelData
 	//	the Dirichlet domain itself changes.
 	bool			itsVertexFigureMeshNeedsReplacement;
 	
+	//	Set a flag to let the platform-dependent code know
+	//	when the honeycomb has changed, so that it may replace
+	//	any copy of the cells' matrices that it keeps on the GPU.
+	//	This happens whenever a new honeycomb gets installed
+	//	or the horizon radius changes.
+	bool			itsHoneycombBufferNeedsRefresh;
+	
 	//	What centerpiece should we display within each translate
 	//	of the fundamental cell?
 	CenterpieceType	itsCenterpieceType;
@@ -371,6 +599,12 @@ struct ModelData
 	
 	//	Enable fog?
 	bool			itsFogFlag;
+	
+	//	Render a left-eye and a right-eye view in a single pass?
+	//	The renderer reads this flag when it sets up its graphics,
+	//	so the platform code must set up the graphics again
+	//	after changing it.
+	bool			itsStereoFlag;
 
 #ifdef START_OUTSIDE
 	//	View the fundamental domain from within, from without,
@@ -414,11 +648,143 @@ typedef struct
 } RGBAColor;
 
 
+//	Mesh output definitions
+
+//	The two-phase mesh builders (CountXxxMesh() and WriteXxxMesh())
+//	write each vertex attribute wherever the caller's MeshBuffers say,
+//	so the caller may point them directly into interleaved GPU memory,
+//	for example [MTLBuffer contents].
+
+typedef enum
+{
+	MeshComponentDouble,
+	MeshComponentFloat,
+	MeshComponentHalf
+} MeshComponentType;
+
+typedef enum
+{
+	MeshIndexUInt16,
+	MeshIndexUInt32
+} MeshIndexType;
+
+typedef struct
+{
+	Byte				*itsBase;	//	address of vertex 0's attribute, or NULL to skip the attribute
+	size_t				itsStride;	//	bytes from one vertex's attribute to the next vertex's
+	MeshComponentType	itsType;
+} MeshAttribute;
+
+typedef struct
+{
+	MeshAttribute	itsPositions,		//	(x,y,z,w)
+					itsTexCoords,		//	(u,v,-) or cube map (u,v,w)
+					itsColors,			//	pre-multiplied (αR, αG, αB, α)
+					itsClosedPositions,	//	(x,y,z,w) with aperture fully closed (Dirichlet walls only)
+					itsClosedTexCoords;	//	(u,v) with aperture fully closed (Dirichlet walls only)
+	void			*itsFacets;			//	three indices per facet
+	MeshIndexType	itsIndexType;
+} MeshBuffers;
+
+//	For each frame of its fly-through, the benchmark suite times
+//	CullAndSortVisibleCells() itself, and then lets the platform-dependent
+//	code render the frame and report the CPU time it spent preparing
+//	and encoding the frame, along with the GPU time.  A hook that can't
+//	measure some time reports it as negative, and the report shows it as null.
+typedef void	(*BenchmarkFrameHook)(void *aHookContext, ModelData *md, double *aCPUEncodeSeconds, double *aGPUSeconds);
+
+//	The benchmark suite's standard fly-through
+#define BENCHMARK_IMAGE_WIDTH	1920	//	in pixels
+#define BENCHMARK_IMAGE_HEIGHT	1080	//	in pixels
+#define BENCHMARK_NUM_FRAMES	600
+#define BENCHMARK_FRAME_PERIOD	(1.0/60.0)	//	in seconds
+
+//	BenchmarkSpace() appends each space's timings
+//	to a BenchmarkReport, as JSON text.
+typedef struct
+{
+	char			*itsText;		//	zero-terminated
+	size_t			itsLength,		//	not counting the terminating zero
+					itsCapacity;
+	unsigned int	itsNumSpaces;
+
+	//	The fly-through's parameters, the same for all spaces.
+	double			itsImageWidth,	//	in pixels
+					itsImageHeight;	//	in pixels
+	unsigned int	itsNumFrames;
+	double			itsFramePeriod;	//	in seconds
+} BenchmarkReport;
+
+//	Each frame's work falls into several intervals,
+//	which the platform-dependent code may mark for a profiler
+//	(as os_signpost intervals on iOS and macOS) and time
+//	for an on-screen overlay.  The platform-independent code
+//	marks only SimulationUpdate(), which the platform-dependent code
+//	calls from within the Geometry Games framework.
+typedef enum
+{
+	FrameIntervalSimulationUpdate,
+	FrameIntervalCullAndSort,
+	FrameIntervalWriteTiles,	//	includes FrameIntervalCullAndSort
+	FrameIntervalRewriteMeshes,
+	FrameIntervalEncodeCommands,
+	NumFrameIntervals
+} FrameInterval;
+
+//	The quality governor trades image quality for frame rate.
+//	Each knob is a fraction of full quality, except
+//	itsLevelOfDetailBias, which multiplies the screen-space error
+//	that each level-of-detail may have.
+typedef struct
+{
+	double			itsRenderScale,			//	fraction of the drawable's width and height
+					itsHorizonFraction,		//	fraction of itsHorizonRadius
+					itsLevelOfDetailBias;	//	1.0 or more
+} QualitySettings;
+
+//	UpdateQualityGovernor() moves one level at a time
+//	along a fixed ladder of QualitySettings, with hysteresis,
+//	so that the quality never oscillates from frame to frame.
+typedef struct
+{
+	unsigned int	itsLevel;				//	0 = full quality
+	double			itsSmoothedLoad;		//	frame time as a fraction of the target frame period
+	unsigned int	itsNumSlowFrames,		//	consecutive frames over budget
+					itsNumFastFrames,		//	consecutive frames well under budget
+					itsNumFramesToSettle;	//	frames to ignore after a change
+} QualityGovernor;
+
+
+//	Platform-dependent global functions
+
+//	in CurvedSpacesFrameStatistics.m (or GeometryGamesStubs.c in the headless build)
+extern void			BeginFrameInterval(FrameInterval anInterval);
+extern void			EndFrameInterval(FrameInterval anInterval);
+
+
 //	Platform-independent global functions
 
+//	in CurvedSpacesBenchmark.c
+extern double		BenchmarkClock(void);
+extern ErrorText	BeginBenchmarkReport(BenchmarkReport *aReport, double anImageWidth, double anImageHeight, unsigned int aNumFrames, double aFramePeriod);
+extern ErrorText	BenchmarkSpace(BenchmarkReport *aReport, ModelData *md, const char *aSpaceName, const Byte *anInput, size_t anInputSize,
+						BenchmarkFrameHook aFrameHook, void *aHookContext);
+extern ErrorText	EndBenchmarkReport(BenchmarkReport *aReport);
+extern void			FreeBenchmarkReport(BenchmarkReport *aReport);
+
+//	in CurvedSpacesGovernor.c
+extern void			ResetQualityGovernor(QualityGovernor *aGovernor);
+extern void			UpdateQualityGovernor(QualityGovernor *aGovernor, double aCPUSeconds, double aGPUSeconds, double aTargetFramePeriod);
+extern void			GetQualitySettings(const QualityGovernor *aGovernor, QualitySettings *someSettings);
+extern void			GetFullQualitySettings(QualitySettings *someSettings);
+extern void			SettleQualityGovernor(QualityGovernor *aGovernor);
+extern double		EffectiveHorizonRadius(const ModelData *md, const QualitySettings *someSettings);
+
 //	in CurvedSpacesProjection.c
 extern double		CharacteristicViewSize(double aFrameWidth, double aFrameHeight);
 extern void			MakeProjectionMatrix(double aFrameWidth, double aFrameHeight, SpaceType aSpaceType, ClippingBoxPortion aClippingBoxPortion, double aProjectionMatrix[4][4]);
+extern void			MakeEyeViewMatrix(Matrix *aViewMatrix, SpaceType aSpaceType, double anEyeOffset, Matrix *anEyeViewMatrix);
+extern double		LevelOfDetailDistance(double aMeshError, double aMaxScreenError, double aFrameWidth, double aFrameHeight, SpaceType aSpaceType);
 
 //	in CurvedSpacesOptions.c
 extern void			SetCenterpiece(ModelData *md, CenterpieceType aCenterpieceChoice);
@@ -443,24 +809,68 @@ extern void			GesturePinch(ModelData *md, double anExpansionFactor);
 extern void			GestureTap(ModelData *md);
 
 //	in CurvedSpacesFileIO.c
-extern ErrorText	LoadGeneratorFile(ModelData *md, Byte *anInputText);
+extern ErrorText	LoadGeneratorFile(ModelData *md, const Byte *anInputText);
+extern ErrorText	LoadGeneratorFileUsingCache(ModelData *md, const Byte *anInputText, const Byte *aCacheData, size_t aCacheSize, Byte **aFreshCacheData, size_t *aFreshCacheSize);
+extern ErrorText	ConstructPendingSpace(const Byte *anInput, size_t anInputSize, const Byte *aCacheData, size_t aCacheSize, bool aFreshCacheRequest, bool aProgressiveFlag, const atomic_bool *aCancelFlag, PendingSpace **aPendingSpace);
+extern ErrorText	ExtendPendingSpace(PendingSpace *aPendingSpace, const atomic_bool *aCancelFlag);
+extern bool			PendingSpaceIsComplete(PendingSpace *aPendingSpace);
+extern void			InstallPendingSpace(ModelData *md, PendingSpace *aPendingSpace);
+extern void			InstallPendingHoneycomb(ModelData *md, PendingSpace *aPendingSpace);
+extern ErrorText	BeginHorizonChange(ModelData *md, double aHorizonRadius, PendingSpace **aPendingSpace);
+extern ErrorText	FinishHorizonChange(PendingSpace *aPendingSpace, const atomic_bool *aCancelFlag);
+extern bool			HorizonStepIsPossible(const ModelData *md, bool aFartherFlag);
+extern double		StepRequestedHorizonRadius(ModelData *md, bool aFartherFlag);
+extern void			FreePendingSpace(PendingSpace **aPendingSpace);
+extern bool			GeneratorDataIsBinary(const Byte *anInput, size_t anInputSize);
+extern ErrorText	WriteBinaryGenerators(PendingSpace *aSpace, Byte **aBinaryData, size_t *aBinarySize);
+
+//	in CurvedSpacesCache.c
+extern uint64_t		SpaceCacheInputHash(const Byte *anInput, size_t anInputSize);
+extern uint64_t		SpaceCacheKey(uint64_t aTextHash, double aHorizonRadius);
+extern ErrorText	WriteSpaceCache(PendingSpace *aSpace, uint64_t aCacheKey, Byte **aCacheData, size_t *aCacheSize);
+extern ErrorText	ReadSpaceCache(PendingSpace *aSpace, uint64_t aCacheKey, MatrixList *aGeneratorList, const Byte *aCacheData, size_t aCacheSize);
+extern void			FreeSpaceCache(Byte **aCacheData, size_t *aCacheSize);
 
 //	in CurvedSpacesTiling.c
-extern ErrorText	ConstructHolonomyGroup(MatrixList *aGeneratorList, double aTilingRadius, MatrixList **aHolonomyGroup);
-extern ErrorText	NeedsBackHemisphere(MatrixList *aHolonomyGroup, SpaceType aSpaceType, bool *aDrawBackHemisphereFlag);
+extern ErrorText	ConstructHolonomyGroup(MatrixList *aGeneratorList, double aTilingRadius, const atomic_bool *aCancelFlag, MatrixList **aHolonomyGroup);
+extern ErrorText	BeginTiling(MatrixList *aGeneratorList, TilingInProgress **aTiling);
+extern ErrorText	ExtendTiling(TilingInProgress *aTiling, double aTilingRadius, const atomic_bool *aCancelFlag);
+extern double		TilingRadius(TilingInProgress *aTiling);
+extern unsigned int	TilingNumTiles(TilingInProgress *aTiling);
+extern ErrorText	CopyTilingToHolonomyGroup(TilingInProgress *aTiling, MatrixList **aHolonomyGroup);
+extern void			FreeTiling(TilingInProgress **aTiling);
+extern size_t		TilingCacheSize(TilingInProgress *aTiling);
+extern ErrorText	WriteTilingCache(TilingInProgress *aTiling, Byte *aBuffer, size_t aBufferSize);
+extern ErrorText	ReadTilingCache(const Byte *aBuffer, size_t aBufferSize, MatrixList *aGeneratorList, TilingInProgress **aTiling);
+extern double		TranslationDistance(Matrix *aMatrix);
+extern ErrorText	ConstructCayleyTable(TilingInProgress *aTiling, MatrixList *aHolonomyGroup, CayleyTable **aCayleyTable);
+extern void			FreeCayleyTable(CayleyTable **aCayleyTable);
+extern size_t		CayleyTableCacheSize(CayleyTable *aCayleyTable);
+extern ErrorText	WriteCayleyTableCache(CayleyTable *aCayleyTable, Byte *aBuffer, size_t aBufferSize);
+extern ErrorText	ReadCayleyTableCache(const Byte *aBuffer, size_t aBufferSize, CayleyTable **aCayleyTable);
+extern ErrorText	NeedsBackHemisphere(CayleyTable *aCayleyTable, SpaceType aSpaceType, bool *aDrawBackHemisphereFlag);
 
 //	in CurvedSpacesDirichlet.c
 extern ErrorText	ConstructDirichletDomain(MatrixList *aHolonomyGroup, DirichletDomain **aDirichletDomain);
 extern void			FreeDirichletDomain(DirichletDomain **aDirichletDomain);
 extern double		DirichletDomainOutradius(DirichletDomain *aDirichletDomain);
 extern void			StayInDirichletDomain(DirichletDomain *aDirichletDomain, Matrix *aPlacement);
-extern ErrorText	ConstructHoneycomb(MatrixList *aHolonomyGroup, DirichletDomain *aDirichletDomain, Honeycomb **aHoneycomb);
+extern ErrorText	ConstructHoneycomb(MatrixList *aHolonomyGroup, DirichletDomain *aDirichletDomain, SpaceType aSpaceType, Honeycomb **aHoneycomb);
 extern void			FreeHoneycomb(Honeycomb **aHoneycomb);
-extern void			MakeDirichletMesh(DirichletDomain *aDirichletDomain, double aCurrentAperture, bool aShowColorCoding,
-						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
+extern void			TruncateHoneycomb(Honeycomb *aHoneycomb, double aTilingRadius);
+extern size_t		DirichletDomainCacheSize(DirichletDomain *aDirichletDomain);
+extern ErrorText	WriteDirichletDomainCache(DirichletDomain *aDirichletDomain, Byte *aBuffer, size_t aBufferSize);
+extern ErrorText	ReadDirichletDomainCache(const Byte *aBuffer, size_t aBufferSize, DirichletDomain **aDirichletDomain);
+extern size_t		HoneycombCacheSize(Honeycomb *aHoneycomb);
+extern ErrorText	WriteHoneycombCache(Honeycomb *aHoneycomb, Byte *aBuffer, size_t aBufferSize);
+extern ErrorText	ReadHoneycombCache(const Byte *aBuffer, size_t aBufferSize, Honeycomb **aHoneycomb);
+extern void			MakeDirichletMesh(DirichletDomain *aDirichletDomain, bool aShowColorCoding,
+						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3],
+						double (**someMeshVertexClosedPositions)[4], double (**someMeshVertexClosedTexCoords)[2], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets, unsigned int (**someMeshFacets)[3]);
 extern void			FreeDirichletMesh(
-						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
+						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3],
+						double (**someMeshVertexClosedPositions)[4], double (**someMeshVertexClosedTexCoords)[2], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets, unsigned int (**someMeshFacets)[3]);
 extern void			MakeVertexFigureMesh(DirichletDomain *aDirichletDomain,
 						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
@@ -468,8 +878,17 @@ extern void			MakeVertexFigureMesh(DirichletDomain *aDirichletDomain,
 extern void			FreeVertexFigureMesh(
 						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets, unsigned int (**someMeshFacets)[3]);
-extern void			CullAndSortVisibleCells(Honeycomb *aHoneycomb, Matrix *aViewMatrix, double anImageWidth, double anImageHeight,
+extern void			CountDirichletMesh(DirichletDomain *aDirichletDomain, unsigned int *aNumMeshVertices, unsigned int *aNumMeshFacets);
+extern void			WriteDirichletMesh(DirichletDomain *aDirichletDomain, bool aShowColorCoding, const MeshBuffers *someMeshBuffers);
+extern void			CountVertexFigureMesh(DirichletDomain *aDirichletDomain, unsigned int *aNumMeshVertices, unsigned int *aNumMeshFacets);
+extern void			WriteVertexFigureMesh(DirichletDomain *aDirichletDomain, const MeshBuffers *someMeshBuffers);
+extern void			CullAndSortVisibleCells(Honeycomb *aHoneycomb, Matrix *aViewMatrix, double anImageWidth, double anImageHeight, double anEyeSeparation,
 						double aHorizonRadius, double aDirichletDomainRadius, SpaceType aSpaceType);
+extern void			CountVisibleCellsNearerThan(Honeycomb *aHoneycomb, double aDistance, SpaceType aSpaceType, ImageParity aViewParity,
+						unsigned int *aNumPlainCells, unsigned int *aNumReflectedCells);
+extern void			ListVisibleCellsBackToFront(Honeycomb *aHoneycomb, Matrix *aViewMatrix, SpaceType aSpaceType, uint32_t *someCellIndices);
+extern double		AdjustedDirichletDomainRadius(double aDirichletDomainRadius, SpaceType aSpaceType);
+extern void			MakeCullingHyperplanes(double anImageWidth, double anImageHeight, double anEyeSeparation, SpaceType aSpaceType, double someCullingPlanes[4][4]);
 #ifdef START_OUTSIDE
 extern void			SelectFirstCellOnly(Honeycomb *aHoneycomb);
 #endif
@@ -481,6 +900,9 @@ extern void			MakeSphereMesh(double aRadius, unsigned int aNumSubdivisions, cons
 extern void			FreeSphereMesh(
 						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets,unsigned int (**someMeshFacets)[3]);
+extern void			CountSphereMesh(unsigned int aNumSubdivisions, unsigned int *aNumMeshVertices, unsigned int *aNumMeshFacets);
+extern void			WriteSphereMesh(double aRadius, unsigned int aNumSubdivisions, const double aColor[4], const MeshBuffers *someMeshBuffers);
+extern double		SphereMeshError(double aRadius, unsigned int aNumSubdivisions);
 
 //	in CurvedSpacesGyroscope.c
 extern void			MakeGyroscopeMesh(
@@ -489,6 +911,8 @@ extern void			MakeGyroscopeMesh(
 extern void			FreeGyroscopeMesh(
 						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets,unsigned int (**someMeshFacets)[3]);
+extern void			CountGyroscopeMesh(unsigned int *aNumMeshVertices, unsigned int *aNumMeshFacets);
+extern void			WriteGyroscopeMesh(const MeshBuffers *someMeshBuffers);
 
 #ifdef SHAPE_OF_SPACE_CH_7
 //	in CurvedSpacesCube.c
@@ -498,8 +922,22 @@ extern void			MakeCubeMesh(
 extern void			FreeCubeMesh(
 						unsigned int *aNumMeshVertices, double (**someMeshVertexPositions)[4], double (**someMeshVertexTexCoords)[3], double (**someMeshVertexColors)[4],
 						unsigned int *aNumMeshFacets,unsigned int (**someMeshFacets)[3]);
+extern void			CountCubeMesh(unsigned int *aNumMeshVertices, unsigned int *aNumMeshFacets);
+extern void			WriteCubeMesh(const MeshBuffers *someMeshBuffers);
 #endif
 
+//	in CurvedSpacesMesh.c
+extern void			SetMeshBuffersForArrays(MeshBuffers *someMeshBuffers,
+						double (*someMeshVertexPositions)[4], double (*someMeshVertexTexCoords)[3], double (*someMeshVertexColors)[4],
+						double (*someMeshVertexClosedPositions)[4], double (*someMeshVertexClosedTexCoords)[2],
+						unsigned int (*someMeshFacets)[3]);
+extern void			WriteMeshVertex(const MeshBuffers *someMeshBuffers, unsigned int aVertexIndex,
+						const double aPosition[4], const double aTexCoords[3], const double aColor[4]);
+extern void			WriteMeshClosedVertex(const MeshBuffers *someMeshBuffers, unsigned int aVertexIndex,
+						const double aClosedPosition[4], const double aClosedTexCoords[2]);
+extern void			WriteMeshFacet(const MeshBuffers *someMeshBuffers, unsigned int aFacetIndex,
+						unsigned int aVertexIndex0, unsigned int aVertexIndex1, unsigned int aVertexIndex2);
+
 //	in CurvedSpacesMatrices.c
 extern void			MatrixIdentity(Matrix *aMatrix);
 extern bool			MatrixIsIdentity(Matrix *aMatrix);
@@ -511,6 +949,7 @@ extern double		MatrixDeterminant(Matrix *aMatrix);
 extern void			VectorTernaryCrossProduct(Vector *aFactorA, Vector *aFactorB, Vector *aFactorC, Vector *aProduct);
 extern bool			MatrixEquality(Matrix *aMatrixA, Matrix *aMatrixB, double anEpsilon);
 extern void			MatrixProduct(const Matrix *aMatrixA, const Matrix *aMatrixB, Matrix *aProduct);
+extern void			MatricesTimesMatrix(unsigned int aNumMatrices, const Matrix *someMatrices, const Matrix *aMatrix, Matrix *someProducts);
 extern void			VectorNegate(Vector *aVector, Vector *aNegation);
 extern void			VectorSum(Vector *aVectorA, Vector *aVectorB, Vector *aSum);
 extern void			VectorDifference(Vector *aVectorA, Vector *aVectorB, Vector *aDifference);
@@ -528,5 +967,11 @@ extern void			FreeMatrixList(MatrixList **aMatrixList);
 extern double		SafeAcos(double x);
 extern double		SafeAcosh(double x);
 
+//	in CurvedSpacesArena.c
+extern void			InitArena(Arena *anArena, size_t anElementSize, size_t anElementsPerBlock);
+extern void			*ArenaAllocate(Arena *anArena);
+extern void			ArenaRecycle(Arena *anArena, void *anElement);
+extern void			FreeArena(Arena *anArena);
+
 //	in CurvedSpacesColors.c
 extern void			HSLAtoRGBA(HSLAColor *anHSLAColor, RGBAColor *anRGBAColor);
@@ -0,0 +1,108 @@
+//	CurvedSpacesArena.c
+//
+//	A simple block allocator for fixed-size elements.
+//	The tiling keeps its Tiles in an Arena, and the Dirichlet domain
+//	keeps its vertices, half edges and faces in Arenas, so that
+//	building and tearing down those structures costs a handful
+//	of allocations instead of one per element.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include <stddef.h>
+
+
+//	Each block begins with a link to the next block,
+//	followed by its elements, aligned suitably for any type.
+struct ArenaBlock
+{
+	ArenaBlock	*itsNext;
+	max_align_t	itsElements[];
+};
+
+
+void InitArena(
+	Arena	*anArena,
+	size_t	anElementSize,
+	size_t	anElementsPerBlock)
+{
+	size_t	theAlignment	= _Alignof(max_align_t);
+
+	//	A recycled element must have room for the free list's link.
+	if (anElementSize < sizeof(void *))
+		anElementSize = sizeof(void *);
+
+	//	Round the element size up so that every element stays aligned.
+	anElementSize = ((anElementSize + theAlignment - 1) / theAlignment) * theAlignment;
+
+	anArena->itsElementSize			= anElementSize;
+	anArena->itsElementsPerBlock	= (anElementsPerBlock > 0 ? anElementsPerBlock : 1);
+	anArena->itsBlockList			= NULL;
+	anArena->itsNumUsedInFirstBlock	= 0;
+	anArena->itsFreeList			= NULL;
+}
+
+
+void *ArenaAllocate(Arena *anArena)
+{
+	void		*theElement;
+	ArenaBlock	*theNewBlock;
+
+	//	Prefer a recycled element, if one is available.
+	if (anArena->itsFreeList != NULL)
+	{
+		theElement				= anArena->itsFreeList;
+		anArena->itsFreeList	= *(void **)theElement;
+		return theElement;
+	}
+
+	//	If the current block is full (or there's no block yet),
+	//	start a new one.
+	if (anArena->itsBlockList == NULL
+	 || anArena->itsNumUsedInFirstBlock == anArena->itsElementsPerBlock)
+	{
+		theNewBlock = (ArenaBlock *) GET_MEMORY(offsetof(ArenaBlock, itsElements)
+						+ anArena->itsElementsPerBlock * anArena->itsElementSize);
+		if (theNewBlock == NULL)
+			return NULL;
+
+		theNewBlock->itsNext			= anArena->itsBlockList;
+		anArena->itsBlockList			= theNewBlock;
+		anArena->itsNumUsedInFirstBlock	= 0;
+	}
+
+	theElement = (Byte *) anArena->itsBlockList->itsElements
+				+ anArena->itsNumUsedInFirstBlock * anArena->itsElementSize;
+	anArena->itsNumUsedInFirstBlock++;
+
+	return theElement;
+}
+
+
+void ArenaRecycle(
+	Arena	*anArena,
+	void	*anElement)	//	must have come from ArenaAllocate(anArena)
+{
+	if (anElement != NULL)
+	{
+		*(void **)anElement		= anArena->itsFreeList;
+		anArena->itsFreeList	= anElement;
+	}
+}
+
+
+void FreeArena(Arena *anArena)
+{
+	ArenaBlock	*theDeadBlock;
+
+	while (anArena->itsBlockList != NULL)
+	{
+		theDeadBlock			= anArena->itsBlockList;
+		anArena->itsBlockList	= theDeadBlock->itsNext;
+		FREE_MEMORY(theDeadBlock);
+	}
+
+	anArena->itsNumUsedInFirstBlock	= 0;
+	anArena->itsFreeList			= NULL;
+}
@@ -0,0 +1,712 @@
+//	CurvedSpacesBenchmark.c
+//
+//	Time each stage of building a space, building its meshes
+//	and flying through it, and report the results as JSON,
+//	so that comparing two reports shows whether a change
+//	made Curved Spaces faster or slower.
+//
+//	The fly-through is deterministic:  it starts at the origin,
+//	flies at a fixed speed with a fixed frame period, and turns
+//	according to a pseudorandom sequence with a fixed seed.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesUtilities-Common.h"
+#include <math.h>
+#include <stdio.h>		//	for vsnprintf()
+#include <stdarg.h>
+#include <stdlib.h>		//	for qsort()
+#include <string.h>		//	for memcpy()
+#include <time.h>		//	for clock_gettime()
+
+
+//	How fast does the observer fly during the fly-through,
+//	and how fast may the observer turn?
+#define BENCHMARK_USER_SPEED		0.25	//	distance per second
+#define BENCHMARK_MAX_TURN_RATE		0.5		//	radians per second
+#define BENCHMARK_TURN_RATE_STEP	0.05	//	radians per second, per frame
+#define BENCHMARK_RANDOM_SEED		0x5EEDC0DEu
+
+//	Time the sphere mesh at each level of detail the renderer uses.
+#define BENCHMARK_MAX_SPHERE_SUBDIVISIONS	3
+#define BENCHMARK_SPHERE_RADIUS				0.1
+
+//	Flat spaces also get timed at a deeper tiling radius,
+//	where the cost of duplicate detection dominates.
+//	Time the deep tiling several times and keep the fastest run,
+//	to filter out scheduling noise.
+#define BENCHMARK_FLAT_TILING_RADIUS	12.5
+#define BENCHMARK_FLAT_TILING_RUNS		5
+
+//	A report starts with this much room, and doubles as needed.
+#define BENCHMARK_REPORT_INITIAL_CAPACITY	0x10000
+
+
+typedef struct
+{
+	double	itsMean,
+			itsMedian,
+			itsP95,
+			itsMax;
+} BenchmarkStatistics;
+
+
+static ErrorText	AppendToReport(BenchmarkReport *aReport, const char *aFormat, ...);
+static ErrorText	AppendStringToReport(BenchmarkReport *aReport, const char *aString);
+static ErrorText	AppendTimesToReport(BenchmarkReport *aReport, const char *aKey, const double *someSeconds, unsigned int aNumTimes, bool aFinalKeyFlag);
+static bool			ComputeStatistics(const double *someSeconds, unsigned int aNumTimes, BenchmarkStatistics *aStatistics);
+static int			CompareDoubles(const void *a, const void *b);
+static ErrorText	TimeMeshes(DirichletDomain *aDirichletDomain, double someMeshSeconds[4]);
+static ErrorText	TimeFlatTiling(MatrixList *aGeneratorList, unsigned int *aNumTiles, double *aSeconds);
+static ErrorText	TimeMeshBuilder(unsigned int aNumMeshVertices, unsigned int aNumMeshFacets,
+						void (*aWriteFunction)(const void *aContext, const MeshBuffers *someMeshBuffers), const void *aContext, double *aSeconds);
+static void			WriteDirichletMeshThunk(const void *aContext, const MeshBuffers *someMeshBuffers);
+static void			WriteVertexFigureMeshThunk(const void *aContext, const MeshBuffers *someMeshBuffers);
+static void			WriteSphereMeshThunk(const void *aContext, const MeshBuffers *someMeshBuffers);
+static void			WriteGyroscopeMeshThunk(const void *aContext, const MeshBuffers *someMeshBuffers);
+static double		NextRandomNumber(uint64_t *aState);
+static const char	*SpaceTypeName(SpaceType aSpaceType);
+
+
+double BenchmarkClock(void)
+{
+	struct timespec	theTime;
+
+	//	Return seconds on a monotonic clock with an arbitrary origin.
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+
+	return (double) theTime.tv_sec + 1e-9 * (double) theTime.tv_nsec;
+}
+
+
+ErrorText BeginBenchmarkReport(
+	BenchmarkReport	*aReport,			//	output
+	double			anImageWidth,		//	in pixels
+	double			anImageHeight,		//	in pixels
+	unsigned int	aNumFrames,			//	frames per fly-through
+	double			aFramePeriod)		//	in seconds
+{
+	aReport->itsText		= (char *) GET_MEMORY(BENCHMARK_REPORT_INITIAL_CAPACITY);
+	aReport->itsLength		= 0;
+	aReport->itsCapacity	= BENCHMARK_REPORT_INITIAL_CAPACITY;
+	aReport->itsNumSpaces	= 0;
+	aReport->itsImageWidth	= anImageWidth;
+	aReport->itsImageHeight	= anImageHeight;
+	aReport->itsNumFrames	= aNumFrames;
+	aReport->itsFramePeriod	= aFramePeriod;
+
+	if (aReport->itsText == NULL)
+	{
+		aReport->itsCapacity = 0;
+		return u"Couldn't get memory for the benchmark report.";
+	}
+	aReport->itsText[0] = 0;
+
+	//	All times in the report are in milliseconds.
+	return AppendToReport(aReport,
+		"{\n"
+		"\t\"format\": \"Curved Spaces benchmark\",\n"
+		"\t\"version\": 1,\n"
+		"\t\"units\": \"ms\",\n"
+		"\t\"image_size\": [%.0f, %.0f],\n"
+		"\t\"num_frames\": %u,\n"
+		"\t\"frame_period\": %.6f,\n"
+		"\t\"random_seed\": %u,\n"
+		"\t\"spaces\":\n"
+		"\t[",
+		anImageWidth,
+		anImageHeight,
+		aNumFrames,
+		aFramePeriod,
+		BENCHMARK_RANDOM_SEED);
+}
+
+ErrorText EndBenchmarkReport(
+	BenchmarkReport	*aReport)
+{
+	return AppendToReport(aReport, "\n\t]\n}\n");
+}
+
+void FreeBenchmarkReport(
+	BenchmarkReport	*aReport)
+{
+	FREE_MEMORY_SAFELY(aReport->itsText);
+	aReport->itsLength		= 0;
+	aReport->itsCapacity	= 0;
+}
+
+
+ErrorText BenchmarkSpace(
+	BenchmarkReport		*aReport,		//	input and output
+	ModelData			*md,			//	receives the new space
+	const char			*aSpaceName,	//	zero-terminated UTF-8
+	const Byte			*anInput,		//	generator file, as for ConstructPendingSpace()
+	size_t				anInputSize,
+	BenchmarkFrameHook	aFrameHook,		//	may be NULL
+	void				*aHookContext)
+{
+	ErrorText		theErrorMessage		= NULL;
+	PendingSpace	*theSpace			= NULL;
+	double			theStageSeconds[NumConstructionStages],
+					theTotalSeconds,
+					theMeshSeconds[4],
+					theFlatTilingSeconds	= 0.0,
+					theStartTime;
+	double			*theCullSeconds		= NULL,
+					*theEncodeSeconds	= NULL,
+					*theGPUSeconds		= NULL;
+	unsigned int	theFlatTilingNumTiles	= 0;
+	uint64_t		theRandomState;
+	double			theYawRate,
+					thePitchRate;
+	Matrix			theTurn,
+					theViewMatrix;
+	unsigned int	theFrame,
+					i;
+
+	static const char	*theStageNames[NumConstructionStages] =
+						{
+							"read_matrices",
+							"holonomy_group",
+							"dirichlet_domain",
+							"honeycomb"
+						};
+
+	//	Construct the space from scratch, ignoring any cache
+	//	and building the whole honeycomb at once.
+	theStartTime	= BenchmarkClock();
+	theErrorMessage	= ConstructPendingSpace(anInput, anInputSize, NULL, 0, false, false, NULL, &theSpace);
+	theTotalSeconds	= BenchmarkClock() - theStartTime;
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+	for (i = 0; i < NumConstructionStages; i++)
+		theStageSeconds[i] = theSpace->itsStageSeconds[i];
+
+	InstallPendingSpace(md, theSpace);
+
+	theErrorMessage = TimeMeshes(md->itsDirichletDomain, theMeshSeconds);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	if (md->itsSpaceType == SpaceFlat)
+	{
+		theErrorMessage = TimeFlatTiling(md->itsGeneratorList, &theFlatTilingNumTiles, &theFlatTilingSeconds);
+		if (theErrorMessage != NULL)
+			goto CleanUpBenchmarkSpace;
+	}
+
+	//	Fly through the space.
+	theCullSeconds		= (double *) GET_MEMORY(aReport->itsNumFrames * sizeof(double));
+	theEncodeSeconds	= (double *) GET_MEMORY(aReport->itsNumFrames * sizeof(double));
+	theGPUSeconds		= (double *) GET_MEMORY(aReport->itsNumFrames * sizeof(double));
+	if (aReport->itsNumFrames > 0
+	 && (theCullSeconds == NULL || theEncodeSeconds == NULL || theGPUSeconds == NULL))
+	{
+		theErrorMessage = u"Couldn't get memory for the benchmark's frame times.";
+		goto CleanUpBenchmarkSpace;
+	}
+
+	MatrixIdentity(&md->itsUserBodyPlacement);
+	md->itsUserSpeed	= BENCHMARK_USER_SPEED;
+	theRandomState		= BENCHMARK_RANDOM_SEED;
+	theYawRate			= 0.0;
+	thePitchRate		= 0.0;
+
+	for (theFrame = 0; theFrame < aReport->itsNumFrames; theFrame++)
+	{
+		//	Let the turn rates wander randomly, so the observer
+		//	sees a variety of views without jerky motion.
+		theYawRate		+= BENCHMARK_TURN_RATE_STEP * (2.0 * NextRandomNumber(&theRandomState) - 1.0);
+		thePitchRate	+= BENCHMARK_TURN_RATE_STEP * (2.0 * NextRandomNumber(&theRandomState) - 1.0);
+		theYawRate		= fmin(fmax(theYawRate,   -BENCHMARK_MAX_TURN_RATE), BENCHMARK_MAX_TURN_RATE);
+		thePitchRate	= fmin(fmax(thePitchRate, -BENCHMARK_MAX_TURN_RATE), BENCHMARK_MAX_TURN_RATE);
+		MatrixRotation(	&theTurn,
+						thePitchRate * aReport->itsFramePeriod,
+						theYawRate   * aReport->itsFramePeriod,
+						0.0);
+		MatrixProduct(&theTurn, &md->itsUserBodyPlacement, &md->itsUserBodyPlacement);
+
+		SimulationUpdate(md, aReport->itsFramePeriod);
+
+		MatrixGeometricInverse(&md->itsUserBodyPlacement, &theViewMatrix);
+		theStartTime = BenchmarkClock();
+		CullAndSortVisibleCells(md->itsHoneycomb,
+								&theViewMatrix,
+								aReport->itsImageWidth,
+								aReport->itsImageHeight,
+								md->itsStereoFlag ? STEREO_EYE_SEPARATION : 0.0,
+								md->itsHorizonRadius,
+								DirichletDomainOutradius(md->itsDirichletDomain),
+								md->itsSpaceType);
+		theCullSeconds[theFrame] = BenchmarkClock() - theStartTime;
+
+		theEncodeSeconds[theFrame]	= -1.0;
+		theGPUSeconds[theFrame]		= -1.0;
+		if (aFrameHook != NULL)
+			(*aFrameHook)(aHookContext, md, &theEncodeSeconds[theFrame], &theGPUSeconds[theFrame]);
+	}
+
+	//	Report the results.
+
+	theErrorMessage = AppendToReport(aReport, "%s\n\t\t{\n\t\t\t\"name\": ", aReport->itsNumSpaces > 0 ? "," : "");
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+	theErrorMessage = AppendStringToReport(aReport, aSpaceName);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	theErrorMessage = AppendToReport(aReport,
+		",\n"
+		"\t\t\t\"space_type\": \"%s\",\n"
+		"\t\t\t\"num_cells\": %u,\n"
+		"\t\t\t\"construction\":\n"
+		"\t\t\t{\n",
+		SpaceTypeName(md->itsSpaceType),
+		md->itsHoneycomb != NULL ? md->itsHoneycomb->itsNumCells : 0);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+	for (i = 0; i < NumConstructionStages; i++)
+	{
+		theErrorMessage = AppendToReport(aReport, "\t\t\t\t\"%s\": %.4f,\n", theStageNames[i], 1000.0 * theStageSeconds[i]);
+		if (theErrorMessage != NULL)
+			goto CleanUpBenchmarkSpace;
+	}
+
+	theErrorMessage = AppendToReport(aReport,
+		"\t\t\t\t\"total\": %.4f\n"
+		"\t\t\t},\n"
+		"\t\t\t\"meshes\":\n"
+		"\t\t\t{\n"
+		"\t\t\t\t\"dirichlet_walls\": %.4f,\n"
+		"\t\t\t\t\"vertex_figures\": %.4f,\n"
+		"\t\t\t\t\"sphere\": %.4f,\n"
+		"\t\t\t\t\"gyroscope\": %.4f\n"
+		"\t\t\t},\n",
+		1000.0 * theTotalSeconds,
+		1000.0 * theMeshSeconds[0],
+		1000.0 * theMeshSeconds[1],
+		1000.0 * theMeshSeconds[2],
+		1000.0 * theMeshSeconds[3]);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	if (md->itsSpaceType == SpaceFlat)
+	{
+		theErrorMessage = AppendToReport(aReport,
+			"\t\t\t\"deep_tiling\":\n"
+			"\t\t\t{\n"
+			"\t\t\t\t\"radius\": %.2f,\n"
+			"\t\t\t\t\"num_tiles\": %u,\n"
+			"\t\t\t\t\"holonomy_group\": %.4f\n"
+			"\t\t\t},\n",
+			BENCHMARK_FLAT_TILING_RADIUS,
+			theFlatTilingNumTiles,
+			1000.0 * theFlatTilingSeconds);
+		if (theErrorMessage != NULL)
+			goto CleanUpBenchmarkSpace;
+	}
+
+	theErrorMessage = AppendToReport(aReport,
+		"\t\t\t\"frames\":\n"
+		"\t\t\t{\n");
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	theErrorMessage = AppendTimesToReport(aReport, "cull_sort", theCullSeconds, aReport->itsNumFrames, false);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+	theErrorMessage = AppendTimesToReport(aReport, "prepare_and_encode", theEncodeSeconds, aReport->itsNumFrames, false);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+	theErrorMessage = AppendTimesToReport(aReport, "gpu", theGPUSeconds, aReport->itsNumFrames, true);
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	theErrorMessage = AppendToReport(aReport, "\t\t\t}\n\t\t}");
+	if (theErrorMessage != NULL)
+		goto CleanUpBenchmarkSpace;
+
+	aReport->itsNumSpaces++;
+
+CleanUpBenchmarkSpace:
+
+	FreePendingSpace(&theSpace);
+	FREE_MEMORY_SAFELY(theCullSeconds);
+	FREE_MEMORY_SAFELY(theEncodeSeconds);
+	FREE_MEMORY_SAFELY(theGPUSeconds);
+
+	return theErrorMessage;
+}
+
+
+static ErrorText AppendToReport(
+	BenchmarkReport	*aReport,
+	const char		*aFormat,
+	...)
+{
+	va_list	theArguments;
+	int		theLength;
+	size_t	theNewCapacity;
+	char	*theNewText;
+
+	//	Measure the formatted text first...
+	va_start(theArguments, aFormat);
+	theLength = vsnprintf(NULL, 0, aFormat, theArguments);
+	va_end(theArguments);
+	if (theLength < 0)
+		return u"Couldn't format text for the benchmark report.";
+
+	//	...make room for it...
+	if (aReport->itsLength + (size_t)theLength + 1 > aReport->itsCapacity)
+	{
+		theNewCapacity = (aReport->itsCapacity > 0 ? aReport->itsCapacity : BENCHMARK_REPORT_INITIAL_CAPACITY);
+		while (aReport->itsLength + (size_t)theLength + 1 > theNewCapacity)
+			theNewCapacity *= 2;
+
+		theNewText = (char *) GET_MEMORY(theNewCapacity);
+		if (theNewText == NULL)
+			return u"Couldn't get memory to enlarge the benchmark report.";
+		if (aReport->itsText != NULL)
+			memcpy(theNewText, aReport->itsText, aReport->itsLength + 1);
+		else
+			theNewText[0] = 0;
+
+		FREE_MEMORY_SAFELY(aReport->itsText);
+		aReport->itsText		= theNewText;
+		aReport->itsCapacity	= theNewCapacity;
+	}
+
+	//	...and write it.
+	va_start(theArguments, aFormat);
+	vsnprintf(aReport->itsText + aReport->itsLength, aReport->itsCapacity - aReport->itsLength, aFormat, theArguments);
+	va_end(theArguments);
+	aReport->itsLength += (size_t)theLength;
+
+	return NULL;
+}
+
+static ErrorText AppendStringToReport(
+	BenchmarkReport	*aReport,
+	const char		*aString)	//	zero-terminated UTF-8
+{
+	ErrorText	theErrorMessage;
+	const char	*theCharacter;
+
+	//	Write aString as a JSON string literal.
+	//	Non-ASCII UTF-8 passes through unchanged.
+
+	theErrorMessage = AppendToReport(aReport, "\"");
+	for (theCharacter = aString; theErrorMessage == NULL && *theCharacter != 0; theCharacter++)
+	{
+		if (*theCharacter == '"' || *theCharacter == '\\')
+			theErrorMessage = AppendToReport(aReport, "\\%c", *theCharacter);
+		else if ((unsigned char)*theCharacter < 0x20)
+			theErrorMessage = AppendToReport(aReport, "\\u%04x", (unsigned int)(unsigned char)*theCharacter);
+		else
+			theErrorMessage = AppendToReport(aReport, "%c", *theCharacter);
+	}
+	if (theErrorMessage == NULL)
+		theErrorMessage = AppendToReport(aReport, "\"");
+
+	return theErrorMessage;
+}
+
+static ErrorText AppendTimesToReport(
+	BenchmarkReport	*aReport,
+	const char		*aKey,
+	const double	*someSeconds,	//	negative for "not measured"
+	unsigned int	aNumTimes,
+	bool			aFinalKeyFlag)
+{
+	ErrorText			theErrorMessage;
+	BenchmarkStatistics	theStatistics;
+	unsigned int		i;
+
+	//	Report a time that no frame measured as null.
+	if ( ! ComputeStatistics(someSeconds, aNumTimes, &theStatistics) )
+		return AppendToReport(aReport, "\t\t\t\t\"%s\": null%s\n", aKey, aFinalKeyFlag ? "" : ",");
+
+	theErrorMessage = AppendToReport(aReport,
+		"\t\t\t\t\"%s\":\n"
+		"\t\t\t\t{\n"
+		"\t\t\t\t\t\"mean\": %.4f,\n"
+		"\t\t\t\t\t\"median\": %.4f,\n"
+		"\t\t\t\t\t\"p95\": %.4f,\n"
+		"\t\t\t\t\t\"max\": %.4f,\n"
+		"\t\t\t\t\t\"per_frame\": [",
+		aKey,
+		1000.0 * theStatistics.itsMean,
+		1000.0 * theStatistics.itsMedian,
+		1000.0 * theStatistics.itsP95,
+		1000.0 * theStatistics.itsMax);
+
+	for (i = 0; theErrorMessage == NULL && i < aNumTimes; i++)
+	{
+		if (someSeconds[i] >= 0.0)
+			theErrorMessage = AppendToReport(aReport, "%s%.4f", i > 0 ? ", " : "", 1000.0 * someSeconds[i]);
+		else
+			theErrorMessage = AppendToReport(aReport, "%snull", i > 0 ? ", " : "");
+	}
+
+	if (theErrorMessage == NULL)
+		theErrorMessage = AppendToReport(aReport, "]\n\t\t\t\t}%s\n", aFinalKeyFlag ? "" : ",");
+
+	return theErrorMessage;
+}
+
+static bool ComputeStatistics(
+	const double		*someSeconds,	//	negative for "not measured"
+	unsigned int		aNumTimes,
+	BenchmarkStatistics	*aStatistics)	//	output
+{
+	double			*theSortedSeconds,
+					theSum;
+	unsigned int	theNumMeasured,
+					i;
+
+	//	Summarize only the frames that measured this time.
+	//	Returns false if none did.
+
+	theSum			= 0.0;
+	theNumMeasured	= 0;
+	aStatistics->itsMax = 0.0;
+	for (i = 0; i < aNumTimes; i++)
+	{
+		if (someSeconds[i] >= 0.0)
+		{
+			theSum += someSeconds[i];
+			aStatistics->itsMax = fmax(aStatistics->itsMax, someSeconds[i]);
+			theNumMeasured++;
+		}
+	}
+	if (theNumMeasured == 0)
+		return false;
+	aStatistics->itsMean = theSum / theNumMeasured;
+
+	//	If there's no memory to sort a copy,
+	//	report the mean in place of the percentiles.
+	theSortedSeconds = (double *) GET_MEMORY(theNumMeasured * sizeof(double));
+	if (theSortedSeconds != NULL)
+	{
+		theNumMeasured = 0;
+		for (i = 0; i < aNumTimes; i++)
+			if (someSeconds[i] >= 0.0)
+				theSortedSeconds[theNumMeasured++] = someSeconds[i];
+		qsort(theSortedSeconds, theNumMeasured, sizeof(double), CompareDoubles);
+		aStatistics->itsMedian	= theSortedSeconds[theNumMeasured / 2];
+		aStatistics->itsP95		= theSortedSeconds[(95 * (theNumMeasured - 1)) / 100];
+		FREE_MEMORY_SAFELY(theSortedSeconds);
+	}
+	else
+	{
+		aStatistics->itsMedian	= aStatistics->itsMean;
+		aStatistics->itsP95		= aStatistics->itsMean;
+	}
+
+	return true;
+}
+
+static int CompareDoubles(
+	const void	*a,
+	const void	*b)
+{
+	double	theA = *(const double *)a,
+			theB = *(const double *)b;
+
+	return (theA < theB) ? -1 : (theA > theB) ? +1 : 0;
+}
+
+
+static ErrorText TimeMeshes(
+	DirichletDomain	*aDirichletDomain,	//	may be NULL
+	double			someMeshSeconds[4])	//	output:  walls, vertex figures, sphere, gyroscope
+{
+	ErrorText		theErrorMessage	= NULL;
+	unsigned int	theNumMeshVertices,
+					theNumMeshFacets,
+					theNumSubdivisions;
+	double			theSeconds;
+
+	//	Time each two-phase mesh builder, writing into
+	//	plain arrays of doubles as the traditional MakeXxxMesh() functions do.
+
+	someMeshSeconds[0] = 0.0;
+	someMeshSeconds[1] = 0.0;
+	if (aDirichletDomain != NULL)
+	{
+		CountDirichletMesh(aDirichletDomain, &theNumMeshVertices, &theNumMeshFacets);
+		theErrorMessage = TimeMeshBuilder(theNumMeshVertices, theNumMeshFacets,
+							WriteDirichletMeshThunk, aDirichletDomain, &someMeshSeconds[0]);
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+
+		CountVertexFigureMesh(aDirichletDomain, &theNumMeshVertices, &theNumMeshFacets);
+		theErrorMessage = TimeMeshBuilder(theNumMeshVertices, theNumMeshFacets,
+							WriteVertexFigureMeshThunk, aDirichletDomain, &someMeshSeconds[1]);
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+	}
+
+	someMeshSeconds[2] = 0.0;
+	for (theNumSubdivisions = 0; theNumSubdivisions <= BENCHMARK_MAX_SPHERE_SUBDIVISIONS; theNumSubdivisions++)
+	{
+		CountSphereMesh(theNumSubdivisions, &theNumMeshVertices, &theNumMeshFacets);
+		theErrorMessage = TimeMeshBuilder(theNumMeshVertices, theNumMeshFacets,
+							WriteSphereMeshThunk, &theNumSubdivisions, &theSeconds);
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+		someMeshSeconds[2] += theSeconds;
+	}
+
+	CountGyroscopeMesh(&theNumMeshVertices, &theNumMeshFacets);
+	theErrorMessage = TimeMeshBuilder(theNumMeshVertices, theNumMeshFacets,
+						WriteGyroscopeMeshThunk, NULL, &someMeshSeconds[3]);
+
+	return theErrorMessage;
+}
+
+static ErrorText TimeFlatTiling(
+	MatrixList		*aGeneratorList,	//	input
+	unsigned int	*aNumTiles,			//	output
+	double			*aSeconds)			//	output, fastest of BENCHMARK_FLAT_TILING_RUNS
+{
+	ErrorText		theErrorMessage		= NULL;
+	MatrixList		*theHolonomyGroup	= NULL;
+	double			theStartTime,
+					theSeconds;
+	unsigned int	i;
+
+	//	Duplicate detection dominates a deep flat tiling,
+	//	whose lattice translations have simple coordinates
+	//	that a poorly placed hash grid handles badly.
+	//	So a regression in the hash grid shows up clearly here.
+
+	*aNumTiles	= 0;
+	*aSeconds	= 0.0;
+
+	if (aGeneratorList == NULL)
+		return u"TimeFlatTiling() received no generators.";
+
+	for (i = 0; i < BENCHMARK_FLAT_TILING_RUNS; i++)
+	{
+		theStartTime	= BenchmarkClock();
+		theErrorMessage	= ConstructHolonomyGroup(aGeneratorList, BENCHMARK_FLAT_TILING_RADIUS, NULL, &theHolonomyGroup);
+		theSeconds		= BenchmarkClock() - theStartTime;
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+
+		if (i == 0 || theSeconds < *aSeconds)
+			*aSeconds = theSeconds;
+		*aNumTiles = theHolonomyGroup->itsNumMatrices;
+
+		FreeMatrixList(&theHolonomyGroup);
+	}
+
+	return NULL;
+}
+
+
+static ErrorText TimeMeshBuilder(
+	unsigned int	aNumMeshVertices,
+	unsigned int	aNumMeshFacets,
+	void			(*aWriteFunction)(const void *aContext, const MeshBuffers *someMeshBuffers),
+	const void		*aContext,
+	double			*aSeconds)	//	output
+{
+	ErrorText		theErrorMessage	= NULL;
+	double			(*thePositions)[4]	= NULL,
+					(*theTexCoords)[3]	= NULL,
+					(*theColors)[4]		= NULL;
+	unsigned int	(*theFacets)[3]		= NULL;
+	MeshBuffers		theMeshBuffers;
+	double			theStartTime;
+
+	*aSeconds = 0.0;
+
+	//	Allocate the arrays outside the timed interval,
+	//	as the renderer allocates its Metal buffers.
+	thePositions	= GET_MEMORY(aNumMeshVertices * sizeof(double [4]));
+	theTexCoords	= GET_MEMORY(aNumMeshVertices * sizeof(double [3]));
+	theColors		= GET_MEMORY(aNumMeshVertices * sizeof(double [4]));
+	theFacets		= GET_MEMORY(aNumMeshFacets   * sizeof(unsigned int [3]));
+	if (thePositions == NULL || theTexCoords == NULL || theColors == NULL || theFacets == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory to time a mesh builder.";
+		goto CleanUpTimeMeshBuilder;
+	}
+
+	SetMeshBuffersForArrays(&theMeshBuffers, thePositions, theTexCoords, theColors, NULL, NULL, theFacets);
+
+	theStartTime = BenchmarkClock();
+	(*aWriteFunction)(aContext, &theMeshBuffers);
+	*aSeconds = BenchmarkClock() - theStartTime;
+
+CleanUpTimeMeshBuilder:
+
+	FREE_MEMORY_SAFELY(thePositions);
+	FREE_MEMORY_SAFELY(theTexCoords);
+	FREE_MEMORY_SAFELY(theColors);
+	FREE_MEMORY_SAFELY(theFacets);
+
+	return theErrorMessage;
+}
+
+static void WriteDirichletMeshThunk(
+	const void			*aContext,	//	the DirichletDomain
+	const MeshBuffers	*someMeshBuffers)
+{
+	WriteDirichletMesh((DirichletDomain *) aContext, false, someMeshBuffers);
+}
+
+static void WriteVertexFigureMeshThunk(
+	const void			*aContext,	//	the DirichletDomain
+	const MeshBuffers	*someMeshBuffers)
+{
+	WriteVertexFigureMesh((DirichletDomain *) aContext, someMeshBuffers);
+}
+
+static void WriteSphereMeshThunk(
+	const void			*aContext,	//	the number of subdivisions
+	const MeshBuffers	*someMeshBuffers)
+{
+	static const double	theWhiteColor[4]	= {1.0, 1.0, 1.0, 1.0};	//	pre-multiplied (αR, αG, αB, α)
+
+	WriteSphereMesh(BENCHMARK_SPHERE_RADIUS, *(const unsigned int *) aContext, theWhiteColor, someMeshBuffers);
+}
+
+static void WriteGyroscopeMeshThunk(
+	const void			*aContext,	//	unused
+	const MeshBuffers	*someMeshBuffers)
+{
+	UNUSED_PARAMETER(aContext);
+
+	WriteGyroscopeMesh(someMeshBuffers);
+}
+
+
+static double NextRandomNumber(
+	uint64_t	*aState)	//	input and output
+{
+	//	A 64-bit linear congruential generator (Knuth's MMIX constants)
+	//	gives the same sequence on every platform.
+	//	Return a number in [0,1) built from the state's top 53 bits.
+	*aState = 6364136223846793005ull * (*aState) + 1442695040888963407ull;
+
+	return (double)(*aState >> 11) / 9007199254740992.0;	//	2⁵³
+}
+
+static const char *SpaceTypeName(
+	SpaceType	aSpaceType)
+{
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:	return "spherical";
+		case SpaceFlat:			return "flat";
+		case SpaceHyperbolic:	return "hyperbolic";
+		case SpaceNone:			return "none";
+	}
+
+	return "unknown";	//	should never occur
+}
@@ -0,0 +1,319 @@
+//	CurvedSpacesCache.c
+//
+//	Save a space's tiling, Dirichlet domain and honeycomb as a single flat block
+//	of bytes, so that re-opening the same space needn't recompute them.
+//	The platform-dependent code decides where to keep the bytes
+//	(typically in a file in the Caches folder) and may hand them back
+//	to us memory-mapped.
+//
+//	Layout
+//
+//		SpaceCacheHeader
+//		cached Dirichlet domain	(see WriteDirichletDomainCache())
+//		cached honeycomb		(see WriteHoneycombCache())
+//		cached tiling			(see WriteTilingCache())
+//		cached Cayley table		(see WriteCayleyTableCache())
+//
+//	The cached tiling holds the holonomy group's matrices,
+//	so that BeginHorizonChange() may extend a cached space's tiling
+//	instead of re-tiling from the generators.  A spherical space
+//	has no tiling to cache, but has a Cayley table instead,
+//	whose element indices are the cached honeycomb's cell indices
+//	and which says whether to draw the back hemisphere.
+//
+//	All numbers are written in the host's native byte order.
+//	A cache written on a machine with the opposite byte order
+//	simply fails the magic number test and gets rebuilt.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include <string.h>	//	for memcpy()
+
+
+//	"CSpc" in ASCII, read as a native-endian 32-bit integer
+#define SPACE_CACHE_MAGIC			0x63705343
+
+//	Increment SPACE_CACHE_FORMAT_VERSION whenever the cache layout
+//	changes, or whenever a code change would produce a different
+//	Dirichlet domain or honeycomb from the same generators.
+#define SPACE_CACHE_FORMAT_VERSION	5
+
+//	64-bit FNV-1a hash parameters
+#define FNV_OFFSET_BASIS			0xCBF29CE484222325ull
+#define FNV_PRIME					0x00000100000001B3ull
+
+//	Flags for SpaceCacheHeader's itsFlags field
+#define SPACE_CACHE_THREE_SPHERE	0x00000001
+
+
+typedef struct
+{
+	uint32_t	itsMagic,
+				itsFormatVersion;
+	uint64_t	itsCacheKey;
+	uint32_t	itsSpaceType,
+				itsFlags;
+	double		itsHorizonRadius;
+	uint64_t	itsDirichletDomainOffset,
+				itsDirichletDomainSize,
+				itsHoneycombOffset,
+				itsHoneycombSize,
+				itsTilingOffset,
+				itsTilingSize,
+				itsCayleyTableOffset,
+				itsCayleyTableSize;
+} SpaceCacheHeader;
+
+
+static uint64_t	HashBytes(uint64_t aHash, const Byte *someBytes, size_t aNumBytes);
+
+
+uint64_t SpaceCacheInputHash(
+	const Byte	*anInput,		//	text or binary generator file
+	size_t		anInputSize)
+{
+	//	Hash the complete input.  For a text file that includes
+	//	the comments, because they may influence how deep we tile
+	//	(see the special cases in ConstructPendingSpace()).
+	return HashBytes(FNV_OFFSET_BASIS, anInput, anInputSize);
+}
+
+
+uint64_t SpaceCacheKey(
+	uint64_t	aTextHash,
+	double		aHorizonRadius)
+{
+	uint64_t	theHash;
+	uint32_t	theFormatVersion	= SPACE_CACHE_FORMAT_VERSION;
+
+	//	The horizon radius depends on compile-time options
+	//	(for example HIGH_RESOLUTION_SCREENSHOT) as well as on the text,
+	//	so fold it into the key along with the format version.
+	theHash = HashBytes(aTextHash, (const Byte *) &aHorizonRadius,   sizeof(aHorizonRadius)  );
+	theHash = HashBytes(theHash,   (const Byte *) &theFormatVersion, sizeof(theFormatVersion));
+
+	return theHash;
+}
+
+
+static uint64_t HashBytes(
+	uint64_t	aHash,
+	const Byte	*someBytes,
+	size_t		aNumBytes)
+{
+	size_t	i;
+
+	for (i = 0; i < aNumBytes; i++)
+	{
+		aHash ^= someBytes[i];
+		aHash *= FNV_PRIME;
+	}
+
+	return aHash;
+}
+
+
+ErrorText WriteSpaceCache(
+	PendingSpace	*aSpace,		//	input
+	uint64_t		aCacheKey,		//	input
+	Byte			**aCacheData,	//	output, to be freed with FreeSpaceCache()
+	size_t			*aCacheSize)	//	output
+{
+	ErrorText			theErrorMessage	= NULL;
+	SpaceCacheHeader	theHeader;
+
+	if (*aCacheData != NULL)
+		return u"WriteSpaceCache() received a non-NULL output location.";
+
+	if (aSpace->itsHoneycomb == NULL)
+		return u"WriteSpaceCache() received a space with no honeycomb.";
+
+	theHeader.itsMagic					= SPACE_CACHE_MAGIC;
+	theHeader.itsFormatVersion			= SPACE_CACHE_FORMAT_VERSION;
+	theHeader.itsCacheKey				= aCacheKey;
+	theHeader.itsSpaceType				= aSpace->itsSpaceType;
+	theHeader.itsFlags					= (aSpace->itsThreeSphereFlag ? SPACE_CACHE_THREE_SPHERE : 0);
+	theHeader.itsHorizonRadius			= aSpace->itsFullHorizonRadius;
+	theHeader.itsDirichletDomainOffset	= sizeof(SpaceCacheHeader);
+	theHeader.itsDirichletDomainSize	= (aSpace->itsDirichletDomain != NULL ?
+											DirichletDomainCacheSize(aSpace->itsDirichletDomain) :
+											aSpace->itsDirichletDomainCacheSize);
+	theHeader.itsHoneycombOffset		= theHeader.itsDirichletDomainOffset + theHeader.itsDirichletDomainSize;
+	theHeader.itsHoneycombSize			= HoneycombCacheSize(aSpace->itsHoneycomb);
+	theHeader.itsTilingOffset			= theHeader.itsHoneycombOffset + theHeader.itsHoneycombSize;
+	theHeader.itsTilingSize				= TilingCacheSize(aSpace->itsTiling);
+	theHeader.itsCayleyTableOffset		= theHeader.itsTilingOffset + theHeader.itsTilingSize;
+	theHeader.itsCayleyTableSize		= CayleyTableCacheSize(aSpace->itsCayleyTable);
+
+	*aCacheSize = (size_t)(theHeader.itsCayleyTableOffset + theHeader.itsCayleyTableSize);
+	*aCacheData = (Byte *) GET_MEMORY(*aCacheSize);
+	if (*aCacheData == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the space cache in WriteSpaceCache().";
+		goto CleanUpWriteSpaceCache;
+	}
+
+	memcpy(*aCacheData, &theHeader, sizeof(theHeader));
+
+	//	After a progressive load, the ModelData owns the Dirichlet domain
+	//	and aSpace keeps only a cached copy.
+	if (aSpace->itsDirichletDomain != NULL)
+	{
+		theErrorMessage = WriteDirichletDomainCache(
+							aSpace->itsDirichletDomain,
+							*aCacheData + theHeader.itsDirichletDomainOffset,
+							(size_t) theHeader.itsDirichletDomainSize);
+		if (theErrorMessage != NULL)
+			goto CleanUpWriteSpaceCache;
+	}
+	else
+	if (aSpace->itsDirichletDomainCacheData != NULL)
+	{
+		memcpy(	*aCacheData + theHeader.itsDirichletDomainOffset,
+				aSpace->itsDirichletDomainCacheData,
+				aSpace->itsDirichletDomainCacheSize);
+	}
+
+	theErrorMessage = WriteHoneycombCache(
+						aSpace->itsHoneycomb,
+						*aCacheData + theHeader.itsHoneycombOffset,
+						(size_t) theHeader.itsHoneycombSize);
+	if (theErrorMessage != NULL)
+		goto CleanUpWriteSpaceCache;
+
+	theErrorMessage = WriteTilingCache(
+						aSpace->itsTiling,
+						*aCacheData + theHeader.itsTilingOffset,
+						(size_t) theHeader.itsTilingSize);
+	if (theErrorMessage != NULL)
+		goto CleanUpWriteSpaceCache;
+
+	theErrorMessage = WriteCayleyTableCache(
+						aSpace->itsCayleyTable,
+						*aCacheData + theHeader.itsCayleyTableOffset,
+						(size_t) theHeader.itsCayleyTableSize);
+	if (theErrorMessage != NULL)
+		goto CleanUpWriteSpaceCache;
+
+CleanUpWriteSpaceCache:
+
+	if (theErrorMessage != NULL)
+		FreeSpaceCache(aCacheData, aCacheSize);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ReadSpaceCache(
+	PendingSpace	*aSpace,			//	input and output
+	uint64_t		aCacheKey,			//	input
+	MatrixList		*aGeneratorList,	//	input, for the cached tiling
+	const Byte		*aCacheData,		//	input, possibly memory-mapped
+	size_t			aCacheSize)			//	input
+{
+	ErrorText			theErrorMessage	= NULL;
+	SpaceCacheHeader	theHeader;
+
+	//	If ReadSpaceCache() returns an error, the caller should
+	//	simply construct the space from scratch, as if no cache existed.
+	//	aSpace->itsDirichletDomain, aSpace->itsHoneycomb, aSpace->itsTiling
+	//	and aSpace->itsCayleyTable will be left NULL.
+
+	if (aSpace->itsDirichletDomain != NULL || aSpace->itsHoneycomb != NULL
+	 || aSpace->itsTiling != NULL || aSpace->itsCayleyTable != NULL)
+		return u"ReadSpaceCache() expects an empty PendingSpace.";
+
+	if (aCacheData == NULL || aCacheSize < sizeof(SpaceCacheHeader))
+		return u"No space cache is available.";
+
+	memcpy(&theHeader, aCacheData, sizeof(theHeader));
+
+	if (theHeader.itsMagic         != SPACE_CACHE_MAGIC
+	 || theHeader.itsFormatVersion != SPACE_CACHE_FORMAT_VERSION)
+		return u"The space cache has an unrecognized format.";
+
+	if (theHeader.itsCacheKey      != aCacheKey
+	 || theHeader.itsSpaceType     != (uint32_t) aSpace->itsSpaceType
+	 || theHeader.itsHorizonRadius != aSpace->itsFullHorizonRadius)
+		return u"The space cache belongs to a different space.";
+
+	if (theHeader.itsDirichletDomainOffset != sizeof(SpaceCacheHeader)
+	 || theHeader.itsHoneycombOffset != theHeader.itsDirichletDomainOffset + theHeader.itsDirichletDomainSize
+	 || theHeader.itsTilingOffset != theHeader.itsHoneycombOffset + theHeader.itsHoneycombSize
+	 || theHeader.itsCayleyTableOffset != theHeader.itsTilingOffset + theHeader.itsTilingSize
+	 || theHeader.itsCayleyTableOffset + theHeader.itsCayleyTableSize != aCacheSize
+	 || (theHeader.itsCayleyTableSize > 0) != (aSpace->itsSpaceType == SpaceSpherical))
+		return u"The space cache is corrupt.";
+
+	theErrorMessage = ReadDirichletDomainCache(
+						aCacheData + theHeader.itsDirichletDomainOffset,
+						(size_t) theHeader.itsDirichletDomainSize,
+						&aSpace->itsDirichletDomain);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadSpaceCache;
+
+	theErrorMessage = ReadHoneycombCache(
+						aCacheData + theHeader.itsHoneycombOffset,
+						(size_t) theHeader.itsHoneycombSize,
+						&aSpace->itsHoneycomb);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadSpaceCache;
+
+	//	A space whose tiling wasn't available when the cache got written
+	//	will begin a new tiling if BeginHorizonChange() needs one.
+	if (theHeader.itsTilingSize > 0)
+	{
+		theErrorMessage = ReadTilingCache(
+							aCacheData + theHeader.itsTilingOffset,
+							(size_t) theHeader.itsTilingSize,
+							aGeneratorList,
+							&aSpace->itsTiling);
+		if (theErrorMessage != NULL)
+			goto CleanUpReadSpaceCache;
+	}
+
+	if (theHeader.itsCayleyTableSize > 0)
+	{
+		theErrorMessage = ReadCayleyTableCache(
+							aCacheData + theHeader.itsCayleyTableOffset,
+							(size_t) theHeader.itsCayleyTableSize,
+							&aSpace->itsCayleyTable);
+		if (theErrorMessage != NULL)
+			goto CleanUpReadSpaceCache;
+
+		//	The table's elements must be the honeycomb's cells.
+		if (aSpace->itsCayleyTable->itsNumElements != aSpace->itsHoneycomb->itsNumAllocatedCells)
+		{
+			theErrorMessage = u"The space cache is corrupt.";
+			goto CleanUpReadSpaceCache;
+		}
+	}
+
+	theErrorMessage = NeedsBackHemisphere(aSpace->itsCayleyTable, aSpace->itsSpaceType, &aSpace->itsDrawBackHemisphere);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadSpaceCache;
+	aSpace->itsThreeSphereFlag = ((theHeader.itsFlags & SPACE_CACHE_THREE_SPHERE) != 0);
+
+CleanUpReadSpaceCache:
+
+	if (theErrorMessage != NULL)
+	{
+		FreeDirichletDomain(&aSpace->itsDirichletDomain);
+		FreeHoneycomb(&aSpace->itsHoneycomb);
+		FreeTiling(&aSpace->itsTiling);
+		FreeCayleyTable(&aSpace->itsCayleyTable);
+	}
+
+	return theErrorMessage;
+}
+
+
+void FreeSpaceCache(
+	Byte	**aCacheData,
+	size_t	*aCacheSize)
+{
+	FREE_MEMORY_SAFELY(*aCacheData);
+	*aCacheSize = 0;
+}
@@ -41,6 +41,85 @@
 #define COLOR_Z_PLUS	PREMULTIPLY_RGBA(1.0000, 0.5000, 0.0000, 1.0000)	//	orange
 
 
+static const struct
+{
+	double	pos[4],
+			col[4];	//	pre-multiplied (αR, αG, αB, α)
+}
+gCubeVertices[6*4] =
+{
+	//	x = -HW
+	
+	{{-HW, -HW, -HW, 1.0}, COLOR_X_MINUS},
+	{{-HW, -HW, +HW, 1.0}, COLOR_X_MINUS},
+	{{-HW, +HW, -HW, 1.0}, COLOR_X_MINUS},
+	{{-HW, +HW, +HW, 1.0}, COLOR_X_MINUS},
+
+	//	x = +HW
+	
+	{{+HW, -HW, -HW, 1.0}, COLOR_X_PLUS},
+	{{+HW, +HW, -HW, 1.0}, COLOR_X_PLUS},
+	{{+HW, -HW, +HW, 1.0}, COLOR_X_PLUS},
+	{{+HW, +HW, +HW, 1.0}, COLOR_X_PLUS},
+
+	//	y = -HW
+	
+	{{-HW, -HW, -HW, 1.0}, COLOR_Y_MINUS},
+	{{+HW, -HW, -HW, 1.0}, COLOR_Y_MINUS},
+	{{-HW, -HW, +HW, 1.0}, COLOR_Y_MINUS},
+	{{+HW, -HW, +HW, 1.0}, COLOR_Y_MINUS},
+
+	//	y = +HW
+	
+	{{-HW, +HW, -HW, 1.0}, COLOR_Y_PLUS},
+	{{-HW, +HW, +HW, 1.0}, COLOR_Y_PLUS},
+	{{+HW, +HW, -HW, 1.0}, COLOR_Y_PLUS},
+	{{+HW, +HW, +HW, 1.0}, COLOR_Y_PLUS},
+
+	//	z = -HW
+	
+	{{-HW, -HW, -HW, 1.0}, COLOR_Z_MINUS},
+	{{-HW, +HW, -HW, 1.0}, COLOR_Z_MINUS},
+	{{+HW, -HW, -HW, 1.0}, COLOR_Z_MINUS},
+	{{+HW, +HW, -HW, 1.0}, COLOR_Z_MINUS},
+
+	//	z = +HW
+	
+	{{-HW, -HW, +HW, 1.0}, COLOR_Z_PLUS},
+	{{+HW, -HW, +HW, 1.0}, COLOR_Z_PLUS},
+	{{-HW, +HW, +HW, 1.0}, COLOR_Z_PLUS},
+	{{+HW, +HW, +HW, 1.0}, COLOR_Z_PLUS},
+
+};
+
+static const unsigned int	gCubeFacets[6*2][3] =
+{
+	//	x = -HW
+	{  0,  1,  2 },
+	{  2,  1,  3 },
+	
+	//	x = +HW
+	{  4,  5,  6 },
+	{  6,  5,  7 },
+
+	//	y = -HW
+	{  8,  9, 10 },
+	{ 10,  9, 11 },
+	
+	//	y = +HW
+	{ 12, 13, 14 },
+	{ 14, 13, 15 },
+
+	//	z = -HW
+	{ 16, 17, 18 },
+	{ 18, 17, 19 },
+	
+	//	z = +HW
+	{ 20, 21, 22 },
+	{ 22, 21, 23 }
+};
+
+
 void MakeCubeMesh(
 	unsigned int	*aNumMeshVertices,				//	output
 	double			(**someMeshVertexPositions)[4],	//	output
@@ -49,87 +128,7 @@ void MakeCubeMesh(
 	unsigned int	*aNumMeshFacets,				//	output
 	unsigned int	(**someMeshFacets)[3])			//	output
 {
-	unsigned int	i,
-					j;
-
-	static const struct
-	{
-		double	pos[4],
-				col[4];	//	pre-multiplied (αR, αG, αB, α)
-	}
-	v[6*4] =
-	{
-		//	x = -HW
-		
-		{{-HW, -HW, -HW, 1.0}, COLOR_X_MINUS},
-		{{-HW, -HW, +HW, 1.0}, COLOR_X_MINUS},
-		{{-HW, +HW, -HW, 1.0}, COLOR_X_MINUS},
-		{{-HW, +HW, +HW, 1.0}, COLOR_X_MINUS},
-
-		//	x = +HW
-		
-		{{+HW, -HW, -HW, 1.0}, COLOR_X_PLUS},
-		{{+HW, +HW, -HW, 1.0}, COLOR_X_PLUS},
-		{{+HW, -HW, +HW, 1.0}, COLOR_X_PLUS},
-		{{+HW, +HW, +HW, 1.0}, COLOR_X_PLUS},
-
-		//	y = -HW
-		
-		{{-HW, -HW, -HW, 1.0}, COLOR_Y_MINUS},
-		{{+HW, -HW, -HW, 1.0}, COLOR_Y_MINUS},
-		{{-HW, -HW, +HW, 1.0}, COLOR_Y_MINUS},
-		{{+HW, -HW, +HW, 1.0}, COLOR_Y_MINUS},
-
-		//	y = +HW
-		
-		{{-HW, +HW, -HW, 1.0}, COLOR_Y_PLUS},
-		{{-HW, +HW, +HW, 1.0}, COLOR_Y_PLUS},
-		{{+HW, +HW, -HW, 1.0}, COLOR_Y_PLUS},
-		{{+HW, +HW, +HW, 1.0}, COLOR_Y_PLUS},
-
-		//	z = -HW
-		
-		{{-HW, -HW, -HW, 1.0}, COLOR_Z_MINUS},
-		{{-HW, +HW, -HW, 1.0}, COLOR_Z_MINUS},
-		{{+HW, -HW, -HW, 1.0}, COLOR_Z_MINUS},
-		{{+HW, +HW, -HW, 1.0}, COLOR_Z_MINUS},
-
-		//	z = +HW
-		
-		{{-HW, -HW, +HW, 1.0}, COLOR_Z_PLUS},
-		{{+HW, -HW, +HW, 1.0}, COLOR_Z_PLUS},
-		{{-HW, +HW, +HW, 1.0}, COLOR_Z_PLUS},
-		{{+HW, +HW, +HW, 1.0}, COLOR_Z_PLUS},
-
-	};
-
-	static const unsigned int	f[6*2][3] =
-	{
-		//	x = -HW
-		{  0,  1,  2 },
-		{  2,  1,  3 },
-		
-		//	x = +HW
-		{  4,  5,  6 },
-		{  6,  5,  7 },
-
-		//	y = -HW
-		{  8,  9, 10 },
-		{ 10,  9, 11 },
-		
-		//	y = +HW
-		{ 12, 13, 14 },
-		{ 14, 13, 15 },
-
-		//	z = -HW
-		{ 16, 17, 18 },
-		{ 18, 17, 19 },
-		
-		//	z = +HW
-		{ 20, 21, 22 },
-		{ 22, 21, 23 }
-	};
-
+	MeshBuffers	theMeshBuffers;
 
 	GEOMETRY_GAMES_ASSERT(
 			aNumMeshVertices		!= NULL
@@ -149,8 +148,7 @@ void MakeCubeMesh(
 		"Output pointers must point to NULL arrays");
 
 	//	Set the number of vertices and facets.
-	*aNumMeshVertices	= BUFFER_LENGTH(v);
-	*aNumMeshFacets		= BUFFER_LENGTH(f);
+	CountCubeMesh(aNumMeshVertices, aNumMeshFacets);
 
 	//	Allocate the output arrays.
 	//	The caller will take responsibility for calling FreeCubeMesh()
@@ -160,26 +158,55 @@ void MakeCubeMesh(
 	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
 	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
 
-	//	Copy the requested mesh data to the output arrays.
-	
-	for (i = 0; i < *aNumMeshVertices; i++)
+	//	Write the mesh into the output arrays.
+	SetMeshBuffersForArrays(&theMeshBuffers,
+							*someMeshVertexPositions,
+							*someMeshVertexTexCoords,
+							*someMeshVertexColors,
+							NULL,
+							NULL,
+							*someMeshFacets);
+	WriteCubeMesh(&theMeshBuffers);
+}
+
+void CountCubeMesh(
+	unsigned int	*aNumMeshVertices,	//	output
+	unsigned int	*aNumMeshFacets)	//	output
+{
+	*aNumMeshVertices	= BUFFER_LENGTH(gCubeVertices);
+	*aNumMeshFacets		= BUFFER_LENGTH(gCubeFacets);
+}
+
+void WriteCubeMesh(
+	const MeshBuffers	*someMeshBuffers)	//	output;	room for CountCubeMesh()'s vertices and facets
+{
+	unsigned int	i,
+					j;
+	double			theTexCoords[3];
+
+	GEOMETRY_GAMES_ASSERT(
+		someMeshBuffers != NULL,
+		"Output pointer must not be NULL");
+
+	for (i = 0; i < BUFFER_LENGTH(gCubeVertices); i++)
 	{
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexPositions)[i][j]	= v[i].pos[j];
-		
 		//	Set (u,v,w) cubemap texture coordinates, even though
 		//	the Cube centerpiece doesn't use any texture at all.
 		for (j = 0; j < 3; j++)
-			(*someMeshVertexTexCoords)[i][j]	= v[i].pos[j];	//	Use position as texture coordinates.
+			theTexCoords[j] = gCubeVertices[i].pos[j];	//	Use position as texture coordinates.
 
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexColors)[i][j]		= v[i].col[j];
+		WriteMeshVertex(someMeshBuffers, i,
+						gCubeVertices[i].pos,
+						theTexCoords,
+						gCubeVertices[i].col);
 	}
 
-	for (i = 0; i < *aNumMeshFacets; i++)
+	for (i = 0; i < BUFFER_LENGTH(gCubeFacets); i++)
 	{
-		for (j = 0; j < 3; j++)
-			(*someMeshFacets)[i][j]	= f[i][j];
+		WriteMeshFacet(	someMeshBuffers, i,
+						gCubeFacets[i][0],
+						gCubeFacets[i][1],
+						gCubeFacets[i][2]);
 	}
 }
 
@@ -41,7 +41,8 @@
 #include "GeometryGamesUtilities-Common.h"
 #include <stddef.h>	//	for offsetof()
 #include <math.h>
-#include <stdlib.h>	//	for qsort()
+#include <stdlib.h>	//	for qsort() and bsearch()
+#include <string.h>	//	for memcpy()
 
 
 //	Three vectors will be considered linearly independent iff their
@@ -77,6 +78,11 @@
 //	we don't want to be flipping back and forth.
 #define RESTORING_EPSILON		1e-8
 
+//	ConstructDirichletDomain() stops slicing once a group element
+//	translates the basepoint more than twice the provisional outradius
+//	(plus OUTRADIUS_PRUNING_EPSILON, to absorb roundoff error).
+#define OUTRADIUS_PRUNING_EPSILON	1e-6
+
 //	How large should a vertex figure be?
 #define VERTEX_FIGURE_SIZE		0.1	//	in radians of S³
 
@@ -87,6 +93,22 @@
 #define FACE_TEXTURE_MULTIPLE_PLAIN	6
 #define FACE_TEXTURE_MULTIPLE_WOOD	1
 
+//	How many cells may a leaf of the cluster tree hold?
+//	Must be a multiple of 4, to fill whole HoneycellCenterBlocks.
+#define CLUSTER_MAX_NUM_CELLS		32
+
+//	Below how many cells does the cluster tree not pay for itself?
+#define CLUSTER_CULLING_MIN_NUM_CELLS	8192
+
+//	Allocate vertices, half edges and faces in blocks of DIRICHLET_ARENA_BLOCK_SIZE.
+#define DIRICHLET_ARENA_BLOCK_SIZE		64
+
+
+//	A cached Dirichlet domain refers to its vertices, half edges and faces
+//	by their positions on the respective lists.  CACHE_NULL_INDEX stands
+//	for a NULL pointer.
+#define CACHE_NULL_INDEX		0xFFFFFFFF
+
 
 //	__cdecl isn't defined or needed on macOS,
 //	so make it disappear from our callback function prototypes.
@@ -223,6 +245,12 @@ typedef struct HEFace
 	//	Record the defining matrix.
 	Matrix				itsMatrix;
 
+	//	The mate's matrix is the inverse of this face's matrix.
+	//	A face whose matrix is its own inverse is its own mate.
+	//	FindFaceMates() sets itsMate once the Dirichlet domain is complete,
+	//	so StayInDirichletDomain() needn't invert any matrices.
+	struct HEFace		*itsMate;
+
 	//	A face and its mate will have the same color.
 	unsigned int		itsColorIndex;		//	used only temporarily
 	RGBAColor			itsColorRGBA;		//	color as {αr, αg, αb, α}
@@ -252,12 +280,127 @@ typedef struct HEFace
 
 } HEFace;
 
+//	When caching a Dirichlet domain, write each vertex, half edge and face
+//	as a fixed-size record, with pointers replaced by list indices.
+//	The records contain no pointers, so the cache may be memory-mapped
+//	and read back in directly.
+
+typedef struct
+{
+	Vector		itsRawPosition,
+				itsNormalizedPosition,
+				itsCenterPoint;
+	uint32_t	itsOutboundHalfEdge,
+				itsPadding;
+} CachedVertex;
+
+typedef struct
+{
+	uint32_t	itsTip,
+				itsMate,
+				itsCycle,
+				itsFace;
+	double		itsBase,
+				itsAltitude;
+	Vector		itsOuterPoint,
+				itsInnerPoint;
+} CachedHalfEdge;
+
+typedef struct
+{
+	uint32_t	itsHalfEdge,
+				itsColorIndex;
+	Vector		itsHalfspace;
+	double		itsMatrix[4][4];
+	uint32_t	itsParity,
+				itsPadding;
+	RGBAColor	itsColorRGBA;
+	double		itsColorGreyscale;
+	Vector		itsRawCenter,
+				itsNormalizedCenter;
+} CachedFace;
+
+typedef struct
+{
+	uint32_t	itsNumVertices,
+				itsNumHalfEdges,
+				itsNumFaces,
+				itsSpaceType;
+	double		itsOutradius;
+} CachedDirichletDomainHeader;
+
+typedef struct
+{
+	double		itsMatrix[4][4];
+	uint32_t	itsParity,
+				itsPadding;
+	Vector		itsCellCenterInWorldSpace;
+} CachedHoneycell;
+
+//	A cached honeycomb also records its cluster tree
+//	and its cell center blocks, so that ReadHoneycombCache()
+//	may copy them back in rather than re-running BuildCellClusters().
+//	The clusters refer to blocks, cells and one another by index,
+//	so they need no fix-ups.
+typedef struct
+{
+	Vector		itsCenter;
+	double		itsCoshSpread,
+				itsSinhSpread,
+				itsSpread;
+	uint32_t	itsFirstBlock,
+				itsNumBlocks,
+				itsMinCellIndex,
+				itsNextCluster,
+				itsLeafFlag,
+				itsPadding;
+} CachedHoneycellCluster;
+
+typedef struct
+{
+	uint32_t	itsNumCells,
+				itsNumClusters;
+} CachedHoneycombHeader;
+
+//	While writing a cache, look up each element's index by its address.
+typedef struct
+{
+	const void	*itsAddress;
+	uint32_t	itsIndex;
+} AddressIndex;
+
+//	While building the cluster tree, sort the cells by their centers' coordinates.
+typedef struct
+{
+	double			itsCoordinates[4];
+	unsigned int	itsCellIndex;
+} ClusterItem;
+
+//	CullCellCenterBlocks() needs the culling data in single precision.
+typedef struct
+{
+	float		itsViewMatrix[4][4],
+				itsPlanes[4][4],		//	the culling hyperplanes' normals
+				itsMinAdjustedDistance,	//	-(sin, ø or sinh of the Dirichlet domain outradius)
+				itsMaxKey;				//	the distance key at the tiling radius
+	SpaceType	itsSpaceType;
+	ImageParity	itsViewParity;
+} CellCullingParameters;
+
+
 struct HEPolyhedron
 {
 	//	Keep vertices, half edges and faces on NULL-terminated linked lists.
 	HEVertex		*itsVertexList;
 	HEHalfEdge		*itsHalfEdgeList;
 	HEFace			*itsFaceList;
+
+	//	The vertices, half edges and faces live in arenas,
+	//	so the polyhedron costs a handful of allocations
+	//	rather than one per element.
+	Arena			itsVertexArena,
+					itsHalfEdgeArena,
+					itsFaceArena;
 	
 	//	For convenience, record the space type and the outradius.
 	SpaceType		itsSpaceType;
@@ -265,19 +408,33 @@ struct HEPolyhedron
 };
 
 
+static void					InitDirichletDomainArenas(DirichletDomain *aDirichletDomain);
 static ErrorText			MakeBanana(Matrix *aMatrixA, Matrix *aMatrixB, Matrix *aMatrixC, DirichletDomain **aDirichletDomain);
 static ErrorText			MakeLens(Matrix *aMatrixA, Matrix *aMatrixB, DirichletDomain **aDirichletDomain);
 static void					MakeHalfspaceInequality(Matrix *aMatrix, Vector *anInequality);
-static ErrorText			IntersectWithHalfspace(DirichletDomain *aDirichletDomain, Matrix *aMatrix);
+static ErrorText			IntersectWithHalfspace(DirichletDomain *aDirichletDomain, Matrix *aMatrix, bool *aCutWasNontrivial);
+static double				ProvisionalOutradius(DirichletDomain *aDirichletDomain);
+static void					FindFaceMates(DirichletDomain *aDirichletDomain);
 static void					AssignFaceColors(DirichletDomain *aDirichletDomain);
 static void					ComputeFaceCenters(DirichletDomain *aDirichletDomain);
 static void					ComputeWallDimensions(DirichletDomain *aDirichletDomain);
 static ErrorText			ComputeVertexFigures(DirichletDomain *aDirichletDomain);
 static void					ComputeOutradius(DirichletDomain *aDirichletDomain);
 static Honeycomb			*AllocateHoneycomb(unsigned int aNumCells, unsigned int aNumVertices);
-static void					MakeCullingHyperplanes(double anImageWidth, double anImageHeight, double someCullingPlanes[4][4]);
-static bool					BoundingSphereIntersectsViewFrustum(double aCellCenterInCameraSpace[4], double anAdjustedDirichletDomainRadius, double someCullingPlanes[4][4]);
-static __cdecl signed int	CompareCellCenterDistances(const void *p1, const void *p2);
+static ErrorText			BuildCellClusters(Honeycomb *aHoneycomb, SpaceType aSpaceType);
+static void					BuildClusterSubtree(Honeycomb *aHoneycomb, SpaceType aSpaceType, ClusterItem *someItems, unsigned int aNumItems, unsigned int aFirstBlock);
+static void					SelectClusterItems(ClusterItem *someItems, unsigned int aNumItems, unsigned int anAxis, unsigned int aNumLowItems);
+static void					CountDirichletDomainElements(DirichletDomain *aDirichletDomain, unsigned int *aNumVertices, unsigned int *aNumHalfEdges, unsigned int *aNumFaces);
+static AddressIndex			*MakeAddressIndexTable(const void *aFirstElement, size_t aNextFieldOffset, unsigned int aNumElements);
+static uint32_t				IndexOfAddress(AddressIndex *aTable, unsigned int aNumElements, const void *anAddress);
+static __cdecl signed int	CompareAddresses(const void *p1, const void *p2);
+static bool					ClusterMayBeVisible(HoneycellCluster *aCluster, Matrix *aViewMatrix, double aDirichletDomainRadius, double anAdjustedDirichletDomainRadius,
+								double aCoshDirichletDomainRadius, double aTilingRadius, double aCoshTilingRadius, double aSinhTilingRadius,
+								double someCullingPlanes[4][4], SpaceType aSpaceType);
+static void					CullCellCenterBlocks(Honeycomb *aHoneycomb, unsigned int aFirstBlock, unsigned int aNumBlocks, CellCullingParameters *someParameters);
+static uint32_t				SortKeyForDistance(double aDistance, SpaceType aSpaceType);
+static uint32_t				SortableFloatBits(float aValue);
+static HoneycellSortEntry	*RadixSortEntries(HoneycellSortEntry *someEntries, HoneycellSortEntry *someScratchEntries, unsigned int aNumEntries);
 
 
 ErrorText ConstructDirichletDomain(
@@ -293,6 +450,8 @@ ErrorText ConstructDirichletDomain(
 	unsigned int	theThirdIndex,
 					theFourthIndex,
 					i;
+	bool			theCutWasNontrivial;
+	double			theOutradiusBound;
 	HEVertex		*theVertex;
 
 	if (aHolonomyGroup == NULL)
@@ -374,7 +533,7 @@ ErrorText ConstructDirichletDomain(
 		{
 			//	Slice the banana with the (independent!) fourth hemisphere
 			//	to get a tetrahedron.
-			theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[theFourthIndex]);
+			theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[theFourthIndex], NULL);
 			if (theErrorMessage != NULL)
 				goto CleanUpConstructDirichletDomain;
 		}
@@ -401,30 +560,43 @@ ErrorText ConstructDirichletDomain(
 			goto CleanUpConstructDirichletDomain;
 	}
 
+	//	Record the space type.
+	if (aHolonomyGroup->itsMatrices[1].m[3][3] <  1.0)
+		(*aDirichletDomain)->itsSpaceType = SpaceSpherical;
+	else
+	if (aHolonomyGroup->itsMatrices[1].m[3][3] == 1.0)
+		(*aDirichletDomain)->itsSpaceType = SpaceFlat;
+	else
+		(*aDirichletDomain)->itsSpaceType = SpaceHyperbolic;
+
 	//	Intersect the initial banana with the halfspace determined
 	//	by each matrix in aHolonomyGroup.  For best numerical accuracy
 	//	(and least work!) start with the nearest group elements and work
 	//	towards the more distance ones.
 	//
-	//	Technical note:  For large tilings all but the first handful
-	//	of group elements will be irrelevant.  If desired one could
-	//	modify this code to break the loop when the slicing halfspaces
-	//	lie further away than the most distance vertices.
+	//	For large tilings all but the first handful of group elements
+	//	will be irrelevant.  If every point of the provisional polyhedron
+	//	lies within a distance r of the basepoint, then by the triangle
+	//	inequality a group element that translates the basepoint
+	//	a distance greater than 2r has a bisector lying entirely
+	//	beyond the polyhedron.  Because aHolonomyGroup comes sorted
+	//	by translation distance, all subsequent group elements translate
+	//	at least as far, and we may stop.  The provisional outradius
+	//	changes only when a cut is nontrivial, so recompute it only then.
+	theOutradiusBound = ProvisionalOutradius(*aDirichletDomain);
 	for (i = 0; i < aHolonomyGroup->itsNumMatrices; i++)
 	{
-		theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[i]);
+		if (TranslationDistance(&aHolonomyGroup->itsMatrices[i])
+				> 2.0 * theOutradiusBound + OUTRADIUS_PRUNING_EPSILON)
+			break;
+
+		theErrorMessage = IntersectWithHalfspace(*aDirichletDomain, &aHolonomyGroup->itsMatrices[i], &theCutWasNontrivial);
 		if (theErrorMessage != NULL)
 			goto CleanUpConstructDirichletDomain;
-	}
 
-	//	Record the space type.
-	if (aHolonomyGroup->itsMatrices[1].m[3][3] <  1.0)
-		(*aDirichletDomain)->itsSpaceType = SpaceSpherical;
-	else
-	if (aHolonomyGroup->itsMatrices[1].m[3][3] == 1.0)
-		(*aDirichletDomain)->itsSpaceType = SpaceFlat;
-	else
-		(*aDirichletDomain)->itsSpaceType = SpaceHyperbolic;
+		if (theCutWasNontrivial)
+			theOutradiusBound = ProvisionalOutradius(*aDirichletDomain);
+	}
 
 	//	Normalize each vertex's position relative to the geometry.
 //WILL NEED TO THINK ABOUT THIS STEP WITH VERTICES-AT-INFINITY.
@@ -460,8 +632,9 @@ ErrorText ConstructDirichletDomain(
 			goto CleanUpConstructDirichletDomain;
 	}
 
-	//	Assign colors to the Dirichlet domain's faces
+	//	Pair up the faces, and assign colors to them
 	//	so that matching faces have the same color.
+	FindFaceMates(*aDirichletDomain);
 	AssignFaceColors(*aDirichletDomain);
 
 	//	Compute the center of each face,
@@ -494,39 +667,27 @@ CleanUpConstructDirichletDomain:
 
 void FreeDirichletDomain(DirichletDomain **aDirichletDomain)
 {
-	HEVertex	*theDeadVertex;
-	HEHalfEdge	*theDeadHalfEdge;
-	HEFace		*theDeadFace;
-
 	if (aDirichletDomain != NULL
 	 && *aDirichletDomain != NULL)
 	{
-		while ((*aDirichletDomain)->itsVertexList != NULL)
-		{
-			theDeadVertex						= (*aDirichletDomain)->itsVertexList;
-			(*aDirichletDomain)->itsVertexList	= theDeadVertex->itsNext;
-			FREE_MEMORY(theDeadVertex);
-		}
-
-		while ((*aDirichletDomain)->itsHalfEdgeList != NULL)
-		{
-			theDeadHalfEdge							= (*aDirichletDomain)->itsHalfEdgeList;
-			(*aDirichletDomain)->itsHalfEdgeList	= theDeadHalfEdge->itsNext;
-			FREE_MEMORY(theDeadHalfEdge);
-		}
-
-		while ((*aDirichletDomain)->itsFaceList != NULL)
-		{
-			theDeadFace							= (*aDirichletDomain)->itsFaceList;
-			(*aDirichletDomain)->itsFaceList	= theDeadFace->itsNext;
-			FREE_MEMORY(theDeadFace);
-		}
+		//	Every vertex, half edge and face lives in one of the arenas.
+		FreeArena(&(*aDirichletDomain)->itsVertexArena);
+		FreeArena(&(*aDirichletDomain)->itsHalfEdgeArena);
+		FreeArena(&(*aDirichletDomain)->itsFaceArena);
 
 		FREE_MEMORY_SAFELY(*aDirichletDomain);
 	}
 }
 
 
+static void InitDirichletDomainArenas(DirichletDomain *aDirichletDomain)
+{
+	InitArena(&aDirichletDomain->itsVertexArena,	sizeof(HEVertex),	DIRICHLET_ARENA_BLOCK_SIZE);
+	InitArena(&aDirichletDomain->itsHalfEdgeArena,	sizeof(HEHalfEdge),	DIRICHLET_ARENA_BLOCK_SIZE);
+	InitArena(&aDirichletDomain->itsFaceArena,		sizeof(HEFace),		DIRICHLET_ARENA_BLOCK_SIZE);
+}
+
+
 static ErrorText MakeBanana(
 	Matrix			*aMatrixA,			//	input
 	Matrix			*aMatrixB,			//	input
@@ -560,7 +721,7 @@ static ErrorText MakeBanana(
 		MakeHalfspaceInequality(theMatrices[i], &theHalfspaces[i]);
 
 	//	Allocate the base DirichletDomain structure.
-	//	Initialize its lists to NULL immediately, so everything will be kosher
+	//	Initialize its lists and arenas immediately, so everything will be kosher
 	//	if we encounter an error later in the construction.
 	*aDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
 	if (*aDirichletDomain == NULL)
@@ -571,13 +732,14 @@ static ErrorText MakeBanana(
 	(*aDirichletDomain)->itsVertexList		= NULL;
 	(*aDirichletDomain)->itsHalfEdgeList	= NULL;
 	(*aDirichletDomain)->itsFaceList		= NULL;
+	InitDirichletDomainArenas(*aDirichletDomain);
 
 	//	Allocate memory for the new vertices, half edges and faces.
 	//	Put them on the Dirichlet domain's linked lists immediately,
 	//	so that if anything goes wrong all memory will get freed.
 	for (i = 0; i < 2; i++)
 	{
-		theVertices[i] = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
+		theVertices[i] = (HEVertex *) ArenaAllocate(&(*aDirichletDomain)->itsVertexArena);
 		if (theVertices[i] == NULL)
 		{
 			theErrorMessage = theOutOfMemoryMessage;
@@ -589,7 +751,7 @@ static ErrorText MakeBanana(
 	for (i = 0; i < 3; i++)
 		for (j = 0; j < 2; j++)
 		{
-			theHalfEdges[i][j] = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+			theHalfEdges[i][j] = (HEHalfEdge *) ArenaAllocate(&(*aDirichletDomain)->itsHalfEdgeArena);
 			if (theHalfEdges[i][j] == NULL)
 			{
 				theErrorMessage = theOutOfMemoryMessage;
@@ -600,7 +762,7 @@ static ErrorText MakeBanana(
 		}
 	for (i = 0; i < 3; i++)
 	{
-		theFaces[i] = (HEFace *) GET_MEMORY(sizeof(HEFace));
+		theFaces[i] = (HEFace *) ArenaAllocate(&(*aDirichletDomain)->itsFaceArena);
 		if (theFaces[i] == NULL)
 		{
 			theErrorMessage = theOutOfMemoryMessage;
@@ -760,7 +922,7 @@ static ErrorText MakeLens(
 	}
 
 	//	Allocate the base DirichletDomain structure.
-	//	Initialize its lists to NULL immediately, so everything will be kosher
+	//	Initialize its lists and arenas immediately, so everything will be kosher
 	//	if we encounter an error later in the construction.
 	*aDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
 	if (*aDirichletDomain == NULL)
@@ -771,6 +933,7 @@ static ErrorText MakeLens(
 	(*aDirichletDomain)->itsVertexList		= NULL;
 	(*aDirichletDomain)->itsHalfEdgeList	= NULL;
 	(*aDirichletDomain)->itsFaceList		= NULL;
+	InitDirichletDomainArenas(*aDirichletDomain);
 
 	//	Allocate memory for the new vertices, half edges and faces.
 	//	Put them on the Dirichlet domain's linked lists immediately,
@@ -784,7 +947,7 @@ static ErrorText MakeLens(
 	}
 	for (i = 0; i < n; i++)
 	{
-		theVertices[i] = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
+		theVertices[i] = (HEVertex *) ArenaAllocate(&(*aDirichletDomain)->itsVertexArena);
 		if (theVertices[i] == NULL)
 		{
 			theErrorMessage = theOutOfMemoryMessage;
@@ -803,7 +966,7 @@ static ErrorText MakeLens(
 	for (i = 0; i < n; i++)
 		for (j = 0; j < 2; j++)
 		{
-			theHalfEdges[i][j] = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+			theHalfEdges[i][j] = (HEHalfEdge *) ArenaAllocate(&(*aDirichletDomain)->itsHalfEdgeArena);
 			if (theHalfEdges[i][j] == NULL)
 			{
 				theErrorMessage = theOutOfMemoryMessage;
@@ -815,7 +978,7 @@ static ErrorText MakeLens(
 
 	for (i = 0; i < 2; i++)
 	{
-		theFaces[i] = (HEFace *) GET_MEMORY(sizeof(HEFace));
+		theFaces[i] = (HEFace *) ArenaAllocate(&(*aDirichletDomain)->itsFaceArena);
 		if (theFaces[i] == NULL)
 		{
 			theErrorMessage = theOutOfMemoryMessage;
@@ -930,7 +1093,8 @@ static void MakeHalfspaceInequality(
 
 static ErrorText IntersectWithHalfspace(
 	DirichletDomain	*aDirichletDomain,	//	input and output
-	Matrix			*aMatrix)			//	input
+	Matrix			*aMatrix,			//	input
+	bool			*aCutWasNontrivial)	//	output, may be NULL
 {
 	ErrorText	theMemoryError = u"Memory request failed in IntersectWithHalfspace().";
 	Vector		theHalfspace;
@@ -962,6 +1126,9 @@ static ErrorText IntersectWithHalfspace(
 	HEFace		**theFacePtr,
 				*theDeadFace;
 
+	if (aCutWasNontrivial != NULL)
+		*aCutWasNontrivial = false;
+
 	//	Ignore the identity matrix.
 	if (MatrixIsIdentity(aMatrix))
 		return NULL;	//	Nothing to do, but not an error.
@@ -1002,6 +1169,9 @@ static ErrorText IntersectWithHalfspace(
 	if ( ! theCutIsNontrivial )
 		return NULL;
 
+	if (aCutWasNontrivial != NULL)
+		*aCutWasNontrivial = true;
+
 	//	Wherever the slicing halfspace crosses an edge,
 	//	introduce a new vertex at the cut point.
 	for (	theHalfEdge1 = aDirichletDomain->itsHalfEdgeList;
@@ -1035,7 +1205,7 @@ static ErrorText IntersectWithHalfspace(
 			//
 
 			//	Create a new vertex and put it on the list.
-			theNewVertex = (HEVertex *) GET_MEMORY(sizeof(HEVertex));
+			theNewVertex = (HEVertex *) ArenaAllocate(&aDirichletDomain->itsVertexArena);
 			if (theNewVertex == NULL)
 				return theMemoryError;
 			theNewVertex->itsNext			= aDirichletDomain->itsVertexList;
@@ -1062,13 +1232,13 @@ static ErrorText IntersectWithHalfspace(
 
 			//	Create two new edges and put them on the list.
 
-			theHalfEdge1a = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+			theHalfEdge1a = (HEHalfEdge *) ArenaAllocate(&aDirichletDomain->itsHalfEdgeArena);
 			if (theHalfEdge1a == NULL)
 				return theMemoryError;
 			theHalfEdge1a->itsNext				= aDirichletDomain->itsHalfEdgeList;
 			aDirichletDomain->itsHalfEdgeList	= theHalfEdge1a;
 
-			theHalfEdge2a = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+			theHalfEdge2a = (HEHalfEdge *) ArenaAllocate(&aDirichletDomain->itsHalfEdgeArena);
 			if (theHalfEdge2a == NULL)
 				return theMemoryError;
 			theHalfEdge2a->itsNext				= aDirichletDomain->itsHalfEdgeList;
@@ -1147,19 +1317,19 @@ static ErrorText IntersectWithHalfspace(
 		//	The face will eventually be discarded,
 		//	but install it anyhow to keep the data structure clean.
 
-		theInnerHalfEdge = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+		theInnerHalfEdge = (HEHalfEdge *) ArenaAllocate(&aDirichletDomain->itsHalfEdgeArena);
 		if (theInnerHalfEdge == NULL)
 			return theMemoryError;
 		theInnerHalfEdge->itsNext			= aDirichletDomain->itsHalfEdgeList;
 		aDirichletDomain->itsHalfEdgeList	= theInnerHalfEdge;
 
-		theOuterHalfEdge = (HEHalfEdge *) GET_MEMORY(sizeof(HEHalfEdge));
+		theOuterHalfEdge = (HEHalfEdge *) ArenaAllocate(&aDirichletDomain->itsHalfEdgeArena);
 		if (theOuterHalfEdge == NULL)
 			return theMemoryError;
 		theOuterHalfEdge->itsNext			= aDirichletDomain->itsHalfEdgeList;
 		aDirichletDomain->itsHalfEdgeList	= theOuterHalfEdge;
 
-		theOuterFace = (HEFace *) GET_MEMORY(sizeof(HEFace));
+		theOuterFace = (HEFace *) ArenaAllocate(&aDirichletDomain->itsFaceArena);
 		if (theOuterFace == NULL)
 			return theMemoryError;
 		theOuterFace->itsNext			= aDirichletDomain->itsFaceList;
@@ -1197,7 +1367,7 @@ static ErrorText IntersectWithHalfspace(
 	}
 
 	//	Allocate a new face to lie on the boundary of the halfspace.
-	theNewFace = (HEFace *) GET_MEMORY(sizeof(HEFace));
+	theNewFace = (HEFace *) ArenaAllocate(&aDirichletDomain->itsFaceArena);
 	if (theNewFace == NULL)
 		return theMemoryError;
 	theNewFace->itsNext				= aDirichletDomain->itsFaceList;
@@ -1262,7 +1432,8 @@ static ErrorText IntersectWithHalfspace(
 	theNewFace->itsHalfspace	= theHalfspace;
 	theNewFace->itsMatrix		= *aMatrix;
 
-	//	Delete excluded vertices, half edges and faces.
+	//	Delete excluded vertices, half edges and faces,
+	//	leaving their memory in the arenas for re-use.
 
 	theVertexPtr = &aDirichletDomain->itsVertexList;
 	while (*theVertexPtr != NULL)
@@ -1271,7 +1442,7 @@ static ErrorText IntersectWithHalfspace(
 		{
 			theDeadVertex	= *theVertexPtr;
 			*theVertexPtr	= theDeadVertex->itsNext;
-			FREE_MEMORY(theDeadVertex);
+			ArenaRecycle(&aDirichletDomain->itsVertexArena, theDeadVertex);
 		}
 		else
 			theVertexPtr = &(*theVertexPtr)->itsNext;
@@ -1284,7 +1455,7 @@ static ErrorText IntersectWithHalfspace(
 		{
 			theDeadHalfEdge	= *theHalfEdgePtr;
 			*theHalfEdgePtr	= theDeadHalfEdge->itsNext;
-			FREE_MEMORY(theDeadHalfEdge);
+			ArenaRecycle(&aDirichletDomain->itsHalfEdgeArena, theDeadHalfEdge);
 		}
 		else
 			theHalfEdgePtr = &(*theHalfEdgePtr)->itsNext;
@@ -1297,7 +1468,7 @@ static ErrorText IntersectWithHalfspace(
 		{
 			theDeadFace	= *theFacePtr;
 			*theFacePtr	= theDeadFace->itsNext;
-			FREE_MEMORY(theDeadFace);
+			ArenaRecycle(&aDirichletDomain->itsFaceArena, theDeadFace);
 		}
 		else
 			theFacePtr = &(*theFacePtr)->itsNext;
@@ -1308,12 +1479,112 @@ static ErrorText IntersectWithHalfspace(
 }
 
 
+static double ProvisionalOutradius(
+	DirichletDomain	*aDirichletDomain)
+{
+	double		theOutradius,
+				theSpatialLengthSquared,
+				theLength,
+				theDistance;
+	HEVertex	*theVertex;
+
+	//	Return the distance from the basepoint (0,0,0,1)
+	//	to the farthest vertex of the provisional polyhedron,
+	//	or INFINITY if some vertex lies at or beyond infinity.
+	//	Unlike ComputeOutradius(), this function works directly
+	//	with the vertices' raw positions, which the construction
+	//	hasn't yet normalized.
+
+	theOutradius = 0.0;
+
+	for (	theVertex = aDirichletDomain->itsVertexList;
+			theVertex != NULL;
+			theVertex = theVertex->itsNext)
+	{
+		theSpatialLengthSquared	= theVertex->itsRawPosition.v[0] * theVertex->itsRawPosition.v[0]
+								+ theVertex->itsRawPosition.v[1] * theVertex->itsRawPosition.v[1]
+								+ theVertex->itsRawPosition.v[2] * theVertex->itsRawPosition.v[2];
+
+		switch (aDirichletDomain->itsSpaceType)
+		{
+			case SpaceSpherical:
+				theLength = sqrt(theSpatialLengthSquared
+							+ theVertex->itsRawPosition.v[3] * theVertex->itsRawPosition.v[3]);
+				if (theLength <= 0.0)
+					return INFINITY;
+				theDistance = SafeAcos(theVertex->itsRawPosition.v[3] / theLength);
+				break;
+
+			case SpaceFlat:
+				if (theVertex->itsRawPosition.v[3] <= 0.0)
+					return INFINITY;
+				theDistance = sqrt(theSpatialLengthSquared) / theVertex->itsRawPosition.v[3];
+				break;
+
+			case SpaceHyperbolic:
+				if (theVertex->itsRawPosition.v[3] <= 0.0
+				 || theVertex->itsRawPosition.v[3] * theVertex->itsRawPosition.v[3] <= theSpatialLengthSquared)
+					return INFINITY;
+				theLength = sqrt(theVertex->itsRawPosition.v[3] * theVertex->itsRawPosition.v[3]
+							- theSpatialLengthSquared);
+				theDistance = SafeAcosh(theVertex->itsRawPosition.v[3] / theLength);
+				break;
+
+			default:
+				return INFINITY;	//	should never occur
+		}
+
+		if (theOutradius < theDistance)
+			theOutradius = theDistance;
+	}
+
+	return theOutradius;
+}
+
+static void FindFaceMates(DirichletDomain *aDirichletDomain)
+{
+	HEFace	*theFace,
+			*theMate;
+	Matrix	theInverseMatrix;
+
+	for (	theFace = aDirichletDomain->itsFaceList;
+			theFace != NULL;
+			theFace = theFace->itsNext)
+	{
+		theFace->itsMate = NULL;
+	}
+
+	//	Look for each unmatched face's mate among the unmatched faces
+	//	from theFace onwards.  Starting with theFace itself
+	//	lets a face whose matrix is its own inverse be its own mate.
+	for (	theFace = aDirichletDomain->itsFaceList;
+			theFace != NULL;
+			theFace = theFace->itsNext)
+	{
+		if (theFace->itsMate == NULL)
+		{
+			MatrixGeometricInverse(&theFace->itsMatrix, &theInverseMatrix);
+			for (	theMate = theFace;
+					theMate != NULL;
+					theMate = theMate->itsNext)
+			{
+				if (theMate->itsMate == NULL
+				 && MatrixEquality(&theMate->itsMatrix, &theInverseMatrix, MATE_MATRIX_EPSILON))
+				{
+					theFace->itsMate = theMate;
+					theMate->itsMate = theFace;
+					break;
+				}
+			}
+		}
+	}
+}
+
+
 static void AssignFaceColors(DirichletDomain *aDirichletDomain)
 {
 	HEFace			*theFace;
 	unsigned int	theCount;
-	Matrix			theInverseMatrix;
-	HEFace			*theMate;
 	double			theColorParameter;
 
 	//	Initialize each color index to 0xFFFFFFFF as a marker.
@@ -1337,19 +1608,9 @@ static void AssignFaceColors(DirichletDomain *aDirichletDomain)
 			//	Assign to theFace the next available color index.
 			theFace->itsColorIndex = theCount++;
 
-			//	If theFace has a distinct mate,
-			//	assign the same index to the mate.
-			MatrixGeometricInverse(&theFace->itsMatrix, &theInverseMatrix);
-			for (	theMate = theFace->itsNext;
-					theMate != NULL;
-					theMate = theMate->itsNext)
-			{
-				if (MatrixEquality(&theMate->itsMatrix, &theInverseMatrix, MATE_MATRIX_EPSILON))
-				{
-					theMate->itsColorIndex = theFace->itsColorIndex;
-					break;
-				}
-			}
+			//	Assign the same index to theFace's mate.
+			if (theFace->itsMate != NULL)
+				theFace->itsMate->itsColorIndex = theFace->itsColorIndex;
 		}
 	}
 
@@ -1602,7 +1863,7 @@ void StayInDirichletDomain(
 {
 	HEFace			*theFace;
 	double			theFaceValue;
-	Matrix			theRestoringMatrix;
+	Matrix			theInverseMatrix;
 	unsigned int	i;
 
 	if (aDirichletDomain == NULL)	//	occurs for the 3-sphere and projective 3-space
@@ -1630,8 +1891,16 @@ void StayInDirichletDomain(
 		{
 			//	Apply the inverse of the face-pairing matrix
 			//	to bring the user back closer to the origin.
-			MatrixGeometricInverse(&theFace->itsMatrix, &theRestoringMatrix);
-			MatrixProduct(aPlacement, &theRestoringMatrix, aPlacement);
+			//	The mate's matrix is that inverse.
+			if (theFace->itsMate != NULL)
+			{
+				MatrixProduct(aPlacement, &theFace->itsMate->itsMatrix, aPlacement);
+			}
+			else	//	should never occur
+			{
+				MatrixGeometricInverse(&theFace->itsMatrix, &theInverseMatrix);
+				MatrixProduct(aPlacement, &theInverseMatrix, aPlacement);
+			}
 		}
 	}
 }
@@ -1640,6 +1909,7 @@ void StayInDirichletDomain(
 ErrorText ConstructHoneycomb(
 	MatrixList		*aHolonomyGroup,	//	input
 	DirichletDomain	*aDirichletDomain,	//	input
+	SpaceType		aSpaceType,			//	input
 	Honeycomb		**aHoneycomb)		//	output
 {
 	ErrorText		theErrorMessage	= NULL;
@@ -1694,10 +1964,12 @@ ErrorText ConstructHoneycomb(
 							&(*aHoneycomb)->itsCells[i].itsCellCenterInWorldSpace);
 	}
 
-CleanUpConstructHoneycomb:
+	//	Group nearby cells into clusters, for faster culling.
+	theErrorMessage = BuildCellClusters(*aHoneycomb, aSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHoneycomb;
 
-	//	The present code flags an error only when *aHoneycomb == NULL,
-	//	but let's include clean-up code anyhow, for future robustness.
+CleanUpConstructHoneycomb:
 	if (theErrorMessage != NULL)
 		FreeHoneycomb(aHoneycomb);
 
@@ -1720,14 +1992,42 @@ static Honeycomb *AllocateHoneycomb(
 	if (theHoneycomb != NULL)
 	{
 		//	For safe error handling, immediately set all pointers to NULL.
-		theHoneycomb->itsCells			= NULL;
-		theHoneycomb->itsVisibleCells	= NULL;
+		theHoneycomb->itsCells				= NULL;
+		theHoneycomb->itsCellCenterBlocks	= NULL;
+		theHoneycomb->itsSortEntries		= NULL;
+		theHoneycomb->itsClusters			= NULL;
+		theHoneycomb->itsVisibleCells		= NULL;
+		theHoneycomb->itsVisibleSortEntries	= NULL;
 	}
 	else
 		goto CleanUpAllocateHoneycomb;
 
-	theHoneycomb->itsNumCells	= aNumCells;
-	theHoneycomb->itsCells		= (Honeycell *) GET_MEMORY(aNumCells * sizeof(Honeycell));
+	theHoneycomb->itsNumCells			= aNumCells;
+	theHoneycomb->itsNumAllocatedCells	= aNumCells;
+	theHoneycomb->itsCells				= (Honeycell *) GET_MEMORY(aNumCells * sizeof(Honeycell));
+	if (theHoneycomb->itsCells == NULL)
+		goto CleanUpAllocateHoneycomb;
+
+	//	Allocate itsCellCenterBlocks, rounding up to a whole number of blocks.
+	//	BuildCellClusters() will fill them in once the cells are known.
+	theHoneycomb->itsCellCenterBlocks	= (HoneycellCenterBlock *) GET_MEMORY(((aNumCells + 3) / 4) * sizeof(HoneycellCenterBlock));
+	if (theHoneycomb->itsCellCenterBlocks == NULL)
+		goto CleanUpAllocateHoneycomb;
+
+	//	Each leaf of the cluster tree holds at least 4 cells
+	//	(unless the whole honeycomb has fewer), so a binary tree
+	//	needs fewer than 2 * (aNumCells/4 + 1) clusters.
+	//	BuildCellClusters() will fill them in.
+	theHoneycomb->itsNumClusters		= 0;
+	theHoneycomb->itsClusters			= (HoneycellCluster *) GET_MEMORY((2 * (aNumCells / 4) + 2) * sizeof(HoneycellCluster));
+	if (theHoneycomb->itsClusters == NULL)
+		goto CleanUpAllocateHoneycomb;
+
+	//	CullAndSortVisibleCells() sorts back and forth between two halves of itsSortEntries.
+	theHoneycomb->itsSortEntries		= (HoneycellSortEntry *) GET_MEMORY(2 * aNumCells * sizeof(HoneycellSortEntry));
+	if (theHoneycomb->itsSortEntries == NULL)
+		goto CleanUpAllocateHoneycomb;
+	theHoneycomb->itsVisibleSortEntries	= theHoneycomb->itsSortEntries;
 
 	//	Allocate itsVisibleCells and initialize to an empty array.
 	//	For simplicity allocate the maximal buffer size, even though
@@ -1759,131 +2059,1046 @@ CleanUpAllocateHoneycomb:
 }
 
 
-void FreeHoneycomb(Honeycomb **aHoneycomb)
+static ErrorText BuildCellClusters(
+	Honeycomb	*aHoneycomb,
+	SpaceType	aSpaceType)
 {
-	if (aHoneycomb != NULL
-	 && *aHoneycomb != NULL)
+	ClusterItem		*theItems	= NULL;
+	unsigned int	i,
+					j;
+
+	//	Group the cells by proximity, splitting each group in half
+	//	along the axis of its greatest extent, and write their centers
+	//	into itsCellCenterBlocks in the order of the resulting leaves.
+
+	aHoneycomb->itsNumClusters = 0;
+	if (aHoneycomb->itsNumAllocatedCells == 0)
+		return NULL;
+
+	theItems = (ClusterItem *) GET_MEMORY(aHoneycomb->itsNumAllocatedCells * sizeof(ClusterItem));
+	if (theItems == NULL)
+		return u"Couldn't get memory for theItems in BuildCellClusters().";
+
+	for (i = 0; i < aHoneycomb->itsNumAllocatedCells; i++)
 	{
-		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCells);
-		FREE_MEMORY_SAFELY((*aHoneycomb)->itsVisibleCells);
-		FREE_MEMORY_SAFELY(*aHoneycomb);
+		for (j = 0; j < 4; j++)
+			theItems[i].itsCoordinates[j] = aHoneycomb->itsCells[i].itsCellCenterInWorldSpace.v[j];
+		theItems[i].itsCellIndex = i;
 	}
-}
 
+	BuildClusterSubtree(aHoneycomb, aSpaceType, theItems, aHoneycomb->itsNumAllocatedCells, 0);
 
-void MakeDirichletMesh(
-	DirichletDomain	*aDirichletDomain,				//	input
-	double			aCurrentAperture,				//	input
-	bool			aShowColorCoding,				//	input
-	unsigned int	*aNumMeshVertices,				//	output
-	double			(**someMeshVertexPositions)[4],	//	output
-	double			(**someMeshVertexTexCoords)[3],	//	output
-	double			(**someMeshVertexColors)[4],	//	output;	pre-multiplied (αR, αG, αB, α)
-	unsigned int	*aNumMeshFacets,				//	output
-	unsigned int	(**someMeshFacets)[3])			//	output
+	FREE_MEMORY(theItems);
+
+	return NULL;
+}
+
+static void BuildClusterSubtree(
+	Honeycomb		*aHoneycomb,
+	SpaceType		aSpaceType,
+	ClusterItem		*someItems,
+	unsigned int	aNumItems,	//	≥ 1
+	unsigned int	aFirstBlock)
 {
-	HEFace			*theFace;
-	HEHalfEdge		*theHalfEdge;
-	unsigned int	theFaceOrder;
-	double			theTextureMultiple,
-					(*thePosition)[4],
-					(*theTexCoords)[3],
-					(*theColor)[4];					//	pre-multiplied (αR, αG, αB, α)
-	unsigned int	theMeshVertexIndex,
-					(*theMeshFace)[3];
-	double			theDirichletDomainFaceColor[4];	//	pre-multiplied (αR, αG, αB, α)
-	Vector			*theFaceCenter;		//	normalized to the SpaceType
-	bool			theParity;
-	Vector			*theNearOuterVertex,//	normalized to the SpaceType
-					theNearInnerVertex,	//	normalized to the SpaceType
-					*theFarOuterVertex,	//	normalized to the SpaceType
-					theFarInnerVertex;	//	normalized to the SpaceType
-	double			theBaseTex,
-					theAltitudeTex;
+	HoneycellCluster		*theCluster;
+	unsigned int			theNumAxes,
+							theSplitAxis,
+							theNumLeftItems,
+							i,
+							j;
+	double					theMin[4],
+							theMax[4],
+							theCosh;
+	Vector					theSum;
+	HoneycellCenterBlock	*theBlock;
+	Vector					*theCellCenter;
 
 	GEOMETRY_GAMES_ASSERT(
-			aDirichletDomain		!= NULL
-		 && aNumMeshVertices		!= NULL
-		 && aNumMeshFacets			!= NULL
-		 && someMeshVertexPositions	!= NULL
-		 && someMeshVertexTexCoords	!= NULL
-		 && someMeshVertexColors	!= NULL
-		 && someMeshFacets			!= NULL,
-		"Output pointers must not be NULL");
-	GEOMETRY_GAMES_ASSERT(
-			*aNumMeshVertices			== 0
-		 && *aNumMeshFacets				== 0
-		 && *someMeshVertexPositions	== NULL
-		 && *someMeshVertexTexCoords	== NULL
-		 && *someMeshVertexColors		== NULL
-		 && *someMeshFacets				== NULL,
-		"Output pointers must point to NULL arrays");
-
-	//	Create a mesh for a Dirichlet polyhedron with windows cut in its faces.
-	//	Each face will be a polygonal annulus.
-	//
-	//		Note:
-	//		Less vertex sharing is possible than you might at first think,
-	//		because even when vertices belonging to adjacent facets
-	//		share the same position in space, they typically have
-	//		different texture coordinates.  Moreover, if we think
-	//		of each polygonal annulus as the union of n quads,
-	//		then not even consecutive quads can share vertices,
-	//		because their required texture coordinates differ.
-	//		(If an underlying face of the Dirichlet domain is regular,
-	//		then texture coordinates may be assigned in such a way
-	//		that consecutive quads may share vertices, but if
-	//		an underlying face isn't regular, then that trick doesn't work.)
-	//
+		aHoneycomb->itsNumClusters < 2 * (aHoneycomb->itsNumAllocatedCells / 4) + 2,
+		"BuildClusterSubtree() ran out of clusters");
+
+	theCluster = &aHoneycomb->itsClusters[aHoneycomb->itsNumClusters++];
+
+	theCluster->itsFirstBlock	= aFirstBlock;
+	theCluster->itsNumBlocks	= (aNumItems + 3) / 4;
+
+	theCluster->itsMinCellIndex = 0xFFFFFFFF;
+	for (i = 0; i < aNumItems; i++)
+		if (theCluster->itsMinCellIndex > someItems[i].itsCellIndex)
+			theCluster->itsMinCellIndex = someItems[i].itsCellIndex;
+
+	//	Center the bounding ball at the cell centers' normalized mean.
+	//	CullAndSortVisibleCells() accepts all cells in a spherical space,
+	//	so it never consults the bounding balls, and the mean
+	//	might not even be normalizable, so use any cell center instead.
+	for (j = 0; j < 4; j++)
+		theSum.v[j] = 0.0;
+	for (i = 0; i < aNumItems; i++)
+		for (j = 0; j < 4; j++)
+			theSum.v[j] += someItems[i].itsCoordinates[j];
+	if (aSpaceType == SpaceSpherical
+	 || VectorNormalize(&theSum, aSpaceType, &theCluster->itsCenter) != NULL)
+	{
+		for (j = 0; j < 4; j++)
+			theCluster->itsCenter.v[j] = someItems[0].itsCoordinates[j];
+	}
 
-	//	Each n-sided face contributes an annular region,
-	//	realized as n trapezoids, each with 4 vertices and 2 facets.
-	//	Count the mesh's total number of vertices and total number of facets.
-	
-	*aNumMeshVertices	= 0;
-	*aNumMeshFacets		= 0;
-	
-	for (	theFace = aDirichletDomain->itsFaceList;
-			theFace != NULL;
-			theFace = theFace->itsNext)
+	//	Let the ball reach the farthest cell center.
+	theCluster->itsSpread = 0.0;
+	for (i = 0; i < aNumItems; i++)
 	{
-		//	Compute the face order n.
-		theFaceOrder = 0;
-		theHalfEdge = theFace->itsHalfEdge;
-		do
+		theCellCenter = &aHoneycomb->itsCells[someItems[i].itsCellIndex].itsCellCenterInWorldSpace;
+		switch (aSpaceType)
 		{
-			theFaceOrder++;							//	count this edge
-			theHalfEdge	= theHalfEdge->itsCycle;	//	move on to the next edge
-		} while (theHalfEdge != theFace->itsHalfEdge);
-	
-		//	Increment the counts.
-		*aNumMeshVertices	+= 4 * theFaceOrder;
-		*aNumMeshFacets		+= 2 * theFaceOrder;
-	}
-	
-	//	Allocate the arrays.  The caller will take responsibility
-	//	for calling FreeDirichletMesh() to free these arrays
-	//	when they're no longer needed.
-	//
-	*someMeshVertexPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshVertexTexCoords	= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
-	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
+			case SpaceFlat:
+				theCluster->itsSpread = fmax(theCluster->itsSpread,
+					sqrt( (theCellCenter->v[0] - theCluster->itsCenter.v[0]) * (theCellCenter->v[0] - theCluster->itsCenter.v[0])
+						+ (theCellCenter->v[1] - theCluster->itsCenter.v[1]) * (theCellCenter->v[1] - theCluster->itsCenter.v[1])
+						+ (theCellCenter->v[2] - theCluster->itsCenter.v[2]) * (theCellCenter->v[2] - theCluster->itsCenter.v[2])));
+				break;
 
-	theTextureMultiple = (aShowColorCoding ? FACE_TEXTURE_MULTIPLE_PLAIN : FACE_TEXTURE_MULTIPLE_WOOD);
+			case SpaceHyperbolic:
+				theCosh = theCellCenter->v[3] * theCluster->itsCenter.v[3]
+						- theCellCenter->v[0] * theCluster->itsCenter.v[0]
+						- theCellCenter->v[1] * theCluster->itsCenter.v[1]
+						- theCellCenter->v[2] * theCluster->itsCenter.v[2];
+				theCluster->itsSpread = fmax(theCluster->itsSpread, SafeAcosh(theCosh));
+				break;
 
-	//	Keep running pointers to the current vertex's attributes...
-	thePosition		= *someMeshVertexPositions;
-	theTexCoords	= *someMeshVertexTexCoords;
-	theColor		= *someMeshVertexColors;
-	
-	//	... and also keep track of its index in the array.
-	theMeshVertexIndex = 0;
+			default:
+				theCluster->itsSpread = PI;
+				break;
+		}
+	}
+	theCluster->itsCoshSpread = cosh(theCluster->itsSpread);
+	theCluster->itsSinhSpread = sinh(theCluster->itsSpread);
 
-	//	Keep a running pointer to the current entry in the index buffer.
-	theMeshFace = *someMeshFacets;
+	if (aNumItems <= CLUSTER_MAX_NUM_CELLS)
+	{
+		//	Write the leaf's cell centers into its blocks,
+		//	padding the last block if necessary.
+		theCluster->itsLeafFlag		= true;
+		theCluster->itsNextCluster	= aHoneycomb->itsNumClusters;
 
-	//	Process each of the Dirichlet domain's faces in turn.
+		for (i = 0; i < theCluster->itsNumBlocks; i++)
+		{
+			theBlock = &aHoneycomb->itsCellCenterBlocks[aFirstBlock + i];
+			for (j = 0; j < 4; j++)
+			{
+				if (4*i + j < aNumItems)
+				{
+					theBlock->itsX[j]			= (float) someItems[4*i + j].itsCoordinates[0];
+					theBlock->itsY[j]			= (float) someItems[4*i + j].itsCoordinates[1];
+					theBlock->itsZ[j]			= (float) someItems[4*i + j].itsCoordinates[2];
+					theBlock->itsW[j]			= (float) someItems[4*i + j].itsCoordinates[3];
+					theBlock->itsCellIndices[j]	= someItems[4*i + j].itsCellIndex;
+				}
+				else
+				{
+					theBlock->itsX[j]			= 0.0f;
+					theBlock->itsY[j]			= 0.0f;
+					theBlock->itsZ[j]			= 0.0f;
+					theBlock->itsW[j]			= 0.0f;
+					theBlock->itsCellIndices[j]	= 0xFFFFFFFF;
+				}
+			}
+		}
+	}
+	else
+	{
+		theCluster->itsLeafFlag = false;
+
+		//	Split along the axis of greatest extent.  In a flat or hyperbolic
+		//	space a cell center's w-coordinate says only how far it is
+		//	from the basepoint, not in which direction, so ignore it.
+		theNumAxes = (aSpaceType == SpaceSpherical ? 4 : 3);
+		for (j = 0; j < theNumAxes; j++)
+		{
+			theMin[j] = someItems[0].itsCoordinates[j];
+			theMax[j] = someItems[0].itsCoordinates[j];
+		}
+		for (i = 1; i < aNumItems; i++)
+		{
+			for (j = 0; j < theNumAxes; j++)
+			{
+				theMin[j] = fmin(theMin[j], someItems[i].itsCoordinates[j]);
+				theMax[j] = fmax(theMax[j], someItems[i].itsCoordinates[j]);
+			}
+		}
+		theSplitAxis = 0;
+		for (j = 1; j < theNumAxes; j++)
+			if (theMax[j] - theMin[j] > theMax[theSplitAxis] - theMin[theSplitAxis])
+				theSplitAxis = j;
+
+		//	Give the first child a whole number of blocks,
+		//	so only the very last block in the tree needs padding.
+		theNumLeftItems = 4 * ((aNumItems/2 + 3) / 4);
+		SelectClusterItems(someItems, aNumItems, theSplitAxis, theNumLeftItems);
+
+		BuildClusterSubtree(aHoneycomb, aSpaceType, someItems, theNumLeftItems, aFirstBlock);
+		BuildClusterSubtree(aHoneycomb, aSpaceType, someItems + theNumLeftItems, aNumItems - theNumLeftItems, aFirstBlock + theNumLeftItems/4);
+
+		//	Note that theCluster still points to the right place,
+		//	because itsClusters never gets reallocated.
+		theCluster->itsNextCluster = aHoneycomb->itsNumClusters;
+	}
+}
+
+static void SelectClusterItems(
+	ClusterItem		*someItems,
+	unsigned int	aNumItems,
+	unsigned int	anAxis,
+	unsigned int	aNumLowItems)	//	0 < aNumLowItems < aNumItems
+{
+	unsigned int	theLow,
+					theHigh,
+					i,
+					j;
+	double			thePivot;
+	ClusterItem		theSwap;
+
+	//	Rearrange someItems so that the first aNumLowItems of them
+	//	have coordinates along anAxis no greater than
+	//	any of the remaining items.
+
+	theLow	= 0;
+	theHigh	= aNumItems - 1;
+	while (theLow < theHigh)
+	{
+		thePivot = someItems[theLow + (theHigh - theLow) / 2].itsCoordinates[anAxis];
+
+		//	Hoare partition
+		i = theLow;
+		j = theHigh;
+		while (i <= j)
+		{
+			while (someItems[i].itsCoordinates[anAxis] < thePivot)
+				i++;
+			while (someItems[j].itsCoordinates[anAxis] > thePivot)
+				j--;
+			if (i <= j)
+			{
+				theSwap			= someItems[i];
+				someItems[i]	= someItems[j];
+				someItems[j]	= theSwap;
+				i++;
+				if (j == 0)
+					break;
+				j--;
+			}
+		}
+
+		//	Now items theLow…j are ≤ thePivot and items i…theHigh are ≥ thePivot.
+		if (aNumLowItems <= j)
+			theHigh = j;
+		else
+		if (aNumLowItems > i)
+			theLow = i;
+		else
+			break;
+	}
+}
+
+
+void FreeHoneycomb(Honeycomb **aHoneycomb)
+{
+	if (aHoneycomb != NULL
+	 && *aHoneycomb != NULL)
+	{
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCells);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsCellCenterBlocks);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsSortEntries);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsClusters);
+		FREE_MEMORY_SAFELY((*aHoneycomb)->itsVisibleCells);
+		FREE_MEMORY_SAFELY(*aHoneycomb);
+	}
+}
+
+
+void TruncateHoneycomb(
+	Honeycomb	*aHoneycomb,
+	double		aTilingRadius)
+{
+	unsigned int	theLow,
+					theHigh,
+					theMiddle;
+
+	//	Show exactly those cells whose centers sit within aTilingRadius
+	//	of the basepoint, assuming that itsCells is sorted near-to-far.
+	//	The cells beyond aTilingRadius stay in itsCells,
+	//	so a later call may bring them back.
+	//
+	//	Use a binary search to find the first cell beyond aTilingRadius.
+	theLow	= 0;
+	theHigh	= aHoneycomb->itsNumAllocatedCells;
+	while (theLow < theHigh)
+	{
+		theMiddle = theLow + (theHigh - theLow) / 2;
+		if (TranslationDistance(&aHoneycomb->itsCells[theMiddle].itsMatrix) <= aTilingRadius)
+			theLow = theMiddle + 1;
+		else
+			theHigh = theMiddle;
+	}
+
+	aHoneycomb->itsNumCells = theLow;
+
+	//	itsVisibleCells may still refer to cells that are now hidden,
+	//	so clear it until the next call to CullAndSortVisibleCells().
+	aHoneycomb->itsNumVisibleCells			= 0;
+	aHoneycomb->itsNumVisiblePlainCells		= 0;
+	aHoneycomb->itsNumVisibleReflectedCells	= 0;
+}
+
+
+static void CountDirichletDomainElements(
+	DirichletDomain	*aDirichletDomain,
+	unsigned int	*aNumVertices,
+	unsigned int	*aNumHalfEdges,
+	unsigned int	*aNumFaces)
+{
+	HEVertex	*theVertex;
+	HEHalfEdge	*theHalfEdge;
+	HEFace		*theFace;
+
+	*aNumVertices	= 0;
+	*aNumHalfEdges	= 0;
+	*aNumFaces		= 0;
+
+	if (aDirichletDomain == NULL)
+		return;
+
+	for (theVertex = aDirichletDomain->itsVertexList; theVertex != NULL; theVertex = theVertex->itsNext)
+		(*aNumVertices)++;
+	for (theHalfEdge = aDirichletDomain->itsHalfEdgeList; theHalfEdge != NULL; theHalfEdge = theHalfEdge->itsNext)
+		(*aNumHalfEdges)++;
+	for (theFace = aDirichletDomain->itsFaceList; theFace != NULL; theFace = theFace->itsNext)
+		(*aNumFaces)++;
+}
+
+
+size_t DirichletDomainCacheSize(
+	DirichletDomain	*aDirichletDomain)
+{
+	unsigned int	theNumVertices,
+					theNumHalfEdges,
+					theNumFaces;
+
+	//	A NULL Dirichlet domain (the 3-sphere or projective 3-space)
+	//	needs no cache space at all.
+	if (aDirichletDomain == NULL)
+		return 0;
+
+	CountDirichletDomainElements(aDirichletDomain, &theNumVertices, &theNumHalfEdges, &theNumFaces);
+
+	return sizeof(CachedDirichletDomainHeader)
+		 + theNumVertices  * sizeof(CachedVertex)
+		 + theNumHalfEdges * sizeof(CachedHalfEdge)
+		 + theNumFaces     * sizeof(CachedFace);
+}
+
+
+ErrorText WriteDirichletDomainCache(
+	DirichletDomain	*aDirichletDomain,	//	input
+	Byte			*aBuffer,			//	output, of length DirichletDomainCacheSize(aDirichletDomain)
+	size_t			aBufferSize)
+{
+	ErrorText					theErrorMessage		= NULL;
+	CachedDirichletDomainHeader	theHeader;
+	AddressIndex				*theVertexTable		= NULL,
+								*theHalfEdgeTable	= NULL,
+								*theFaceTable		= NULL;
+	Byte						*theWriteLocation;
+	HEVertex					*theVertex;
+	HEHalfEdge					*theHalfEdge;
+	HEFace						*theFace;
+	CachedVertex				theCachedVertex;
+	CachedHalfEdge				theCachedHalfEdge;
+	CachedFace					theCachedFace;
+
+	if (aDirichletDomain == NULL)
+		return NULL;	//	nothing to write
+
+	if (aBufferSize != DirichletDomainCacheSize(aDirichletDomain))
+		return u"WriteDirichletDomainCache() received a buffer of the wrong size.";
+
+	CountDirichletDomainElements(aDirichletDomain, &theHeader.itsNumVertices, &theHeader.itsNumHalfEdges, &theHeader.itsNumFaces);
+	theHeader.itsSpaceType	= aDirichletDomain->itsSpaceType;
+	theHeader.itsOutradius	= aDirichletDomain->itsOutradius;
+
+	//	Prepare to convert pointers to list indices.
+	theVertexTable		= MakeAddressIndexTable(aDirichletDomain->itsVertexList,   offsetof(HEVertex,   itsNext), theHeader.itsNumVertices );
+	theHalfEdgeTable	= MakeAddressIndexTable(aDirichletDomain->itsHalfEdgeList, offsetof(HEHalfEdge, itsNext), theHeader.itsNumHalfEdges);
+	theFaceTable		= MakeAddressIndexTable(aDirichletDomain->itsFaceList,     offsetof(HEFace,     itsNext), theHeader.itsNumFaces    );
+	if ((theVertexTable   == NULL && theHeader.itsNumVertices  > 0)
+	 || (theHalfEdgeTable == NULL && theHeader.itsNumHalfEdges > 0)
+	 || (theFaceTable     == NULL && theHeader.itsNumFaces     > 0))
+	{
+		theErrorMessage = u"Couldn't get memory for address tables in WriteDirichletDomainCache().";
+		goto CleanUpWriteDirichletDomainCache;
+	}
+
+	//	Write the header, followed by the vertices, half edges and faces, in list order.
+	//	Use memcpy() throughout, so that aBuffer needn't be aligned.
+
+	theWriteLocation = aBuffer;
+
+	memcpy(theWriteLocation, &theHeader, sizeof(theHeader));
+	theWriteLocation += sizeof(theHeader);
+
+	for (theVertex = aDirichletDomain->itsVertexList; theVertex != NULL; theVertex = theVertex->itsNext)
+	{
+		theCachedVertex.itsRawPosition			= theVertex->itsRawPosition;
+		theCachedVertex.itsNormalizedPosition	= theVertex->itsNormalizedPosition;
+		theCachedVertex.itsCenterPoint			= theVertex->itsCenterPoint;
+		theCachedVertex.itsOutboundHalfEdge		= IndexOfAddress(theHalfEdgeTable, theHeader.itsNumHalfEdges, theVertex->itsOutboundHalfEdge);
+		theCachedVertex.itsPadding				= 0;
+
+		memcpy(theWriteLocation, &theCachedVertex, sizeof(theCachedVertex));
+		theWriteLocation += sizeof(theCachedVertex);
+	}
+
+	for (theHalfEdge = aDirichletDomain->itsHalfEdgeList; theHalfEdge != NULL; theHalfEdge = theHalfEdge->itsNext)
+	{
+		theCachedHalfEdge.itsTip		= IndexOfAddress(theVertexTable,   theHeader.itsNumVertices,  theHalfEdge->itsTip  );
+		theCachedHalfEdge.itsMate		= IndexOfAddress(theHalfEdgeTable, theHeader.itsNumHalfEdges, theHalfEdge->itsMate );
+		theCachedHalfEdge.itsCycle		= IndexOfAddress(theHalfEdgeTable, theHeader.itsNumHalfEdges, theHalfEdge->itsCycle);
+		theCachedHalfEdge.itsFace		= IndexOfAddress(theFaceTable,     theHeader.itsNumFaces,     theHalfEdge->itsFace );
+		theCachedHalfEdge.itsBase		= theHalfEdge->itsBase;
+		theCachedHalfEdge.itsAltitude	= theHalfEdge->itsAltitude;
+		theCachedHalfEdge.itsOuterPoint	= theHalfEdge->itsOuterPoint;
+		theCachedHalfEdge.itsInnerPoint	= theHalfEdge->itsInnerPoint;
+
+		memcpy(theWriteLocation, &theCachedHalfEdge, sizeof(theCachedHalfEdge));
+		theWriteLocation += sizeof(theCachedHalfEdge);
+	}
+
+	for (theFace = aDirichletDomain->itsFaceList; theFace != NULL; theFace = theFace->itsNext)
+	{
+		theCachedFace.itsHalfEdge			= IndexOfAddress(theHalfEdgeTable, theHeader.itsNumHalfEdges, theFace->itsHalfEdge);
+		theCachedFace.itsColorIndex			= theFace->itsColorIndex;
+		theCachedFace.itsHalfspace			= theFace->itsHalfspace;
+		memcpy(theCachedFace.itsMatrix, theFace->itsMatrix.m, sizeof(theCachedFace.itsMatrix));
+		theCachedFace.itsParity				= theFace->itsMatrix.itsParity;
+		theCachedFace.itsPadding			= 0;
+		theCachedFace.itsColorRGBA			= theFace->itsColorRGBA;
+		theCachedFace.itsColorGreyscale		= theFace->itsColorGreyscale;
+		theCachedFace.itsRawCenter			= theFace->itsRawCenter;
+		theCachedFace.itsNormalizedCenter	= theFace->itsNormalizedCenter;
+
+		memcpy(theWriteLocation, &theCachedFace, sizeof(theCachedFace));
+		theWriteLocation += sizeof(theCachedFace);
+	}
+
+	if (theWriteLocation != aBuffer + aBufferSize)
+		theErrorMessage = u"Grave error while writing cache in WriteDirichletDomainCache().";
+
+CleanUpWriteDirichletDomainCache:
+
+	FREE_MEMORY_SAFELY(theVertexTable);
+	FREE_MEMORY_SAFELY(theHalfEdgeTable);
+	FREE_MEMORY_SAFELY(theFaceTable);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ReadDirichletDomainCache(
+	const Byte		*aBuffer,			//	input
+	size_t			aBufferSize,
+	DirichletDomain	**aDirichletDomain)	//	output
+{
+	ErrorText					theErrorMessage		= NULL,
+								theCorruptMessage	= u"The cached Dirichlet domain is corrupt.";
+	CachedDirichletDomainHeader	theHeader;
+	HEVertex					**theVertices		= NULL;
+	HEHalfEdge					**theHalfEdges		= NULL;
+	HEFace						**theFaces			= NULL;
+	const Byte					*theReadLocation;
+	CachedVertex				theCachedVertex;
+	CachedHalfEdge				theCachedHalfEdge;
+	CachedFace					theCachedFace;
+	unsigned int				i;
+
+	if (*aDirichletDomain != NULL)
+		return u"ReadDirichletDomainCache() received a non-NULL output location.";
+
+	//	An empty cache represents a NULL Dirichlet domain.
+	if (aBufferSize == 0)
+		return NULL;
+
+	if (aBufferSize < sizeof(theHeader))
+		return theCorruptMessage;
+	memcpy(&theHeader, aBuffer, sizeof(theHeader));
+	theReadLocation = aBuffer + sizeof(theHeader);
+
+	if (theHeader.itsNumVertices  > aBufferSize / sizeof(CachedVertex)		//	for safety
+	 || theHeader.itsNumHalfEdges > aBufferSize / sizeof(CachedHalfEdge)
+	 || theHeader.itsNumFaces     > aBufferSize / sizeof(CachedFace)
+	 || aBufferSize != sizeof(theHeader)
+						+ theHeader.itsNumVertices  * sizeof(CachedVertex)
+						+ theHeader.itsNumHalfEdges * sizeof(CachedHalfEdge)
+						+ theHeader.itsNumFaces     * sizeof(CachedFace))
+		return theCorruptMessage;
+
+	//	Allocate the polyhedron itself, with empty lists and arenas.
+	*aDirichletDomain = (DirichletDomain *) GET_MEMORY(sizeof(DirichletDomain));
+	if (*aDirichletDomain == NULL)
+		return u"Couldn't get memory for the Dirichlet domain in ReadDirichletDomainCache().";
+	(*aDirichletDomain)->itsVertexList		= NULL;
+	(*aDirichletDomain)->itsHalfEdgeList	= NULL;
+	(*aDirichletDomain)->itsFaceList		= NULL;
+	InitDirichletDomainArenas(*aDirichletDomain);
+	(*aDirichletDomain)->itsSpaceType		= (SpaceType) theHeader.itsSpaceType;
+	(*aDirichletDomain)->itsOutradius		= theHeader.itsOutradius;
+
+	//	Allocate temporary arrays to convert list indices back to pointers.
+	theVertices		= (HEVertex   **) GET_MEMORY(theHeader.itsNumVertices  * sizeof(HEVertex   *));
+	theHalfEdges	= (HEHalfEdge **) GET_MEMORY(theHeader.itsNumHalfEdges * sizeof(HEHalfEdge *));
+	theFaces		= (HEFace     **) GET_MEMORY(theHeader.itsNumFaces     * sizeof(HEFace     *));
+	if ((theVertices  == NULL && theHeader.itsNumVertices  > 0)
+	 || (theHalfEdges == NULL && theHeader.itsNumHalfEdges > 0)
+	 || (theFaces     == NULL && theHeader.itsNumFaces     > 0))
+	{
+		theErrorMessage = u"Couldn't get memory for index tables in ReadDirichletDomainCache().";
+		goto CleanUpReadDirichletDomainCache;
+	}
+
+	//	Allocate the vertices, half edges and faces,
+	//	and link each onto the end of its list, so that
+	//	the lists come out in the same order they were written.
+	//	Link each new element onto the list immediately,
+	//	so FreeDirichletDomain() can clean up if anything goes wrong.
+	for (i = theHeader.itsNumVertices; i-- > 0; )
+	{
+		theVertices[i] = (HEVertex *) ArenaAllocate(&(*aDirichletDomain)->itsVertexArena);
+		if (theVertices[i] == NULL)
+		{
+			theErrorMessage = u"Out of memory in ReadDirichletDomainCache().";
+			goto CleanUpReadDirichletDomainCache;
+		}
+		theVertices[i]->itsNext				= (*aDirichletDomain)->itsVertexList;
+		(*aDirichletDomain)->itsVertexList	= theVertices[i];
+	}
+	for (i = theHeader.itsNumHalfEdges; i-- > 0; )
+	{
+		theHalfEdges[i] = (HEHalfEdge *) ArenaAllocate(&(*aDirichletDomain)->itsHalfEdgeArena);
+		if (theHalfEdges[i] == NULL)
+		{
+			theErrorMessage = u"Out of memory in ReadDirichletDomainCache().";
+			goto CleanUpReadDirichletDomainCache;
+		}
+		theHalfEdges[i]->itsNext				= (*aDirichletDomain)->itsHalfEdgeList;
+		(*aDirichletDomain)->itsHalfEdgeList	= theHalfEdges[i];
+	}
+	for (i = theHeader.itsNumFaces; i-- > 0; )
+	{
+		theFaces[i] = (HEFace *) ArenaAllocate(&(*aDirichletDomain)->itsFaceArena);
+		if (theFaces[i] == NULL)
+		{
+			theErrorMessage = u"Out of memory in ReadDirichletDomainCache().";
+			goto CleanUpReadDirichletDomainCache;
+		}
+		theFaces[i]->itsNext				= (*aDirichletDomain)->itsFaceList;
+		(*aDirichletDomain)->itsFaceList	= theFaces[i];
+	}
+
+	//	Read the records, converting list indices back to pointers.
+
+	for (i = 0; i < theHeader.itsNumVertices; i++)
+	{
+		memcpy(&theCachedVertex, theReadLocation, sizeof(theCachedVertex));
+		theReadLocation += sizeof(theCachedVertex);
+
+		if (theCachedVertex.itsOutboundHalfEdge >= theHeader.itsNumHalfEdges)
+		{
+			theErrorMessage = theCorruptMessage;
+			goto CleanUpReadDirichletDomainCache;
+		}
+
+		theVertices[i]->itsRawPosition			= theCachedVertex.itsRawPosition;
+		theVertices[i]->itsNormalizedPosition	= theCachedVertex.itsNormalizedPosition;
+		theVertices[i]->itsCenterPoint			= theCachedVertex.itsCenterPoint;
+		theVertices[i]->itsOutboundHalfEdge		= theHalfEdges[theCachedVertex.itsOutboundHalfEdge];
+		theVertices[i]->itsHalfspaceStatus		= VertexOnBoundary;	//	unused, but let's not leave it undefined
+	}
+
+	for (i = 0; i < theHeader.itsNumHalfEdges; i++)
+	{
+		memcpy(&theCachedHalfEdge, theReadLocation, sizeof(theCachedHalfEdge));
+		theReadLocation += sizeof(theCachedHalfEdge);
+
+		if (theCachedHalfEdge.itsTip   >= theHeader.itsNumVertices
+		 || theCachedHalfEdge.itsMate  >= theHeader.itsNumHalfEdges
+		 || theCachedHalfEdge.itsCycle >= theHeader.itsNumHalfEdges
+		 || theCachedHalfEdge.itsFace  >= theHeader.itsNumFaces)
+		{
+			theErrorMessage = theCorruptMessage;
+			goto CleanUpReadDirichletDomainCache;
+		}
+
+		theHalfEdges[i]->itsTip				= theVertices [theCachedHalfEdge.itsTip  ];
+		theHalfEdges[i]->itsMate			= theHalfEdges[theCachedHalfEdge.itsMate ];
+		theHalfEdges[i]->itsCycle			= theHalfEdges[theCachedHalfEdge.itsCycle];
+		theHalfEdges[i]->itsFace			= theFaces    [theCachedHalfEdge.itsFace ];
+		theHalfEdges[i]->itsBase			= theCachedHalfEdge.itsBase;
+		theHalfEdges[i]->itsAltitude		= theCachedHalfEdge.itsAltitude;
+		theHalfEdges[i]->itsDeletionFlag	= false;
+		theHalfEdges[i]->itsOuterPoint		= theCachedHalfEdge.itsOuterPoint;
+		theHalfEdges[i]->itsInnerPoint		= theCachedHalfEdge.itsInnerPoint;
+	}
+
+	for (i = 0; i < theHeader.itsNumFaces; i++)
+	{
+		memcpy(&theCachedFace, theReadLocation, sizeof(theCachedFace));
+		theReadLocation += sizeof(theCachedFace);
+
+		if (theCachedFace.itsHalfEdge >= theHeader.itsNumHalfEdges)
+		{
+			theErrorMessage = theCorruptMessage;
+			goto CleanUpReadDirichletDomainCache;
+		}
+
+		theFaces[i]->itsHalfEdge			= theHalfEdges[theCachedFace.itsHalfEdge];
+		theFaces[i]->itsHalfspace			= theCachedFace.itsHalfspace;
+		memcpy(theFaces[i]->itsMatrix.m, theCachedFace.itsMatrix, sizeof(theCachedFace.itsMatrix));
+		theFaces[i]->itsMatrix.itsParity	= (theCachedFace.itsParity == ImageNegative ? ImageNegative : ImagePositive);
+		theFaces[i]->itsColorIndex			= theCachedFace.itsColorIndex;
+		theFaces[i]->itsColorRGBA			= theCachedFace.itsColorRGBA;
+		theFaces[i]->itsColorGreyscale		= theCachedFace.itsColorGreyscale;
+		theFaces[i]->itsRawCenter			= theCachedFace.itsRawCenter;
+		theFaces[i]->itsNormalizedCenter	= theCachedFace.itsNormalizedCenter;
+		theFaces[i]->itsDeletionFlag		= false;
+	}
+
+	//	The cache doesn't record the face pairings, so find them afresh.
+	FindFaceMates(*aDirichletDomain);
+
+CleanUpReadDirichletDomainCache:
+
+	if (theErrorMessage != NULL)
+		FreeDirichletDomain(aDirichletDomain);
+
+	FREE_MEMORY_SAFELY(theVertices);
+	FREE_MEMORY_SAFELY(theHalfEdges);
+	FREE_MEMORY_SAFELY(theFaces);
+
+	return theErrorMessage;
+}
+
+
+static AddressIndex *MakeAddressIndexTable(
+	const void		*aFirstElement,		//	first element on a NULL-terminated linked list
+	size_t			aNextFieldOffset,	//	offset of the itsNext field within each element
+	unsigned int	aNumElements)
+{
+	AddressIndex	*theTable;
+	const void		*theElement;
+	unsigned int	i;
+
+	//	Record each element's address along with its position on the list,
+	//	and then sort by address so IndexOfAddress() may use a binary search.
+
+	if (aNumElements == 0)
+		return NULL;
+
+	theTable = (AddressIndex *) GET_MEMORY(aNumElements * sizeof(AddressIndex));
+	if (theTable == NULL)
+		return NULL;
+
+	for (theElement = aFirstElement, i = 0;
+		 theElement != NULL && i < aNumElements;
+		 theElement = *(const void **)((const Byte *)theElement + aNextFieldOffset), i++)
+	{
+		theTable[i].itsAddress	= theElement;
+		theTable[i].itsIndex	= i;
+	}
+
+	qsort(theTable, aNumElements, sizeof(AddressIndex), CompareAddresses);
+
+	return theTable;
+}
+
+
+static uint32_t IndexOfAddress(
+	AddressIndex	*aTable,
+	unsigned int	aNumElements,
+	const void		*anAddress)
+{
+	AddressIndex	theKey,
+					*theEntry;
+
+	if (anAddress == NULL || aTable == NULL)
+		return CACHE_NULL_INDEX;
+
+	theKey.itsAddress	= anAddress;
+	theKey.itsIndex		= CACHE_NULL_INDEX;
+	theEntry = (AddressIndex *) bsearch(&theKey, aTable, aNumElements, sizeof(AddressIndex), CompareAddresses);
+
+	return (theEntry != NULL ? theEntry->itsIndex : CACHE_NULL_INDEX);
+}
+
+
+static __cdecl signed int CompareAddresses(
+	const void	*p1,
+	const void	*p2)
+{
+	uintptr_t	theAddress1,
+				theAddress2;
+
+	theAddress1 = (uintptr_t) ((const AddressIndex *) p1)->itsAddress;
+	theAddress2 = (uintptr_t) ((const AddressIndex *) p2)->itsAddress;
+
+	if (theAddress1 < theAddress2)
+		return -1;
+
+	if (theAddress1 > theAddress2)
+		return +1;
+
+	return 0;
+}
+
+
+size_t HoneycombCacheSize(
+	Honeycomb	*aHoneycomb)
+{
+	if (aHoneycomb == NULL)
+		return 0;
+
+	return sizeof(CachedHoneycombHeader)
+		 + aHoneycomb->itsNumCells * sizeof(CachedHoneycell)
+		 + ((aHoneycomb->itsNumCells + 3) / 4) * sizeof(HoneycellCenterBlock)
+		 + aHoneycomb->itsNumClusters * sizeof(CachedHoneycellCluster);
+}
+
+
+ErrorText WriteHoneycombCache(
+	Honeycomb	*aHoneycomb,	//	input
+	Byte		*aBuffer,		//	output, of length HoneycombCacheSize(aHoneycomb)
+	size_t		aBufferSize)
+{
+	CachedHoneycombHeader	theHeader;
+	CachedHoneycell			theCachedCell;
+	CachedHoneycellCluster	theCachedCluster;
+	HoneycellCluster		*theCluster;
+	Byte					*theWriteLocation;
+	size_t					theBlocksSize;
+	unsigned int			i;
+
+	if (aHoneycomb == NULL)
+		return NULL;	//	nothing to write
+
+	//	The cluster tree covers all itsNumAllocatedCells cells.
+	if (aHoneycomb->itsNumCells != aHoneycomb->itsNumAllocatedCells)
+		return u"WriteHoneycombCache() received a truncated honeycomb.";
+
+	if (aBufferSize != HoneycombCacheSize(aHoneycomb))
+		return u"WriteHoneycombCache() received a buffer of the wrong size.";
+
+	theHeader.itsNumCells		= aHoneycomb->itsNumCells;
+	theHeader.itsNumClusters	= aHoneycomb->itsNumClusters;
+
+	theWriteLocation = aBuffer;
+	memcpy(theWriteLocation, &theHeader, sizeof(theHeader));
+	theWriteLocation += sizeof(theHeader);
+
+	//	Write only the permanent part of each cell.
+	//	The visible cell list and the camera distances
+	//	get recomputed every frame anyhow.
+	for (i = 0; i < aHoneycomb->itsNumCells; i++)
+	{
+		memcpy(theCachedCell.itsMatrix, aHoneycomb->itsCells[i].itsMatrix.m, sizeof(theCachedCell.itsMatrix));
+		theCachedCell.itsParity					= aHoneycomb->itsCells[i].itsMatrix.itsParity;
+		theCachedCell.itsPadding				= 0;
+		theCachedCell.itsCellCenterInWorldSpace	= aHoneycomb->itsCells[i].itsCellCenterInWorldSpace;
+
+		memcpy(theWriteLocation, &theCachedCell, sizeof(theCachedCell));
+		theWriteLocation += sizeof(theCachedCell);
+	}
+
+	//	The center blocks contain only floats and integers,
+	//	so write them as they are.
+	theBlocksSize = ((aHoneycomb->itsNumCells + 3) / 4) * sizeof(HoneycellCenterBlock);
+	memcpy(theWriteLocation, aHoneycomb->itsCellCenterBlocks, theBlocksSize);
+	theWriteLocation += theBlocksSize;
+
+	for (i = 0; i < aHoneycomb->itsNumClusters; i++)
+	{
+		theCluster = &aHoneycomb->itsClusters[i];
+
+		theCachedCluster.itsCenter			= theCluster->itsCenter;
+		theCachedCluster.itsCoshSpread		= theCluster->itsCoshSpread;
+		theCachedCluster.itsSinhSpread		= theCluster->itsSinhSpread;
+		theCachedCluster.itsSpread			= theCluster->itsSpread;
+		theCachedCluster.itsFirstBlock		= theCluster->itsFirstBlock;
+		theCachedCluster.itsNumBlocks		= theCluster->itsNumBlocks;
+		theCachedCluster.itsMinCellIndex	= theCluster->itsMinCellIndex;
+		theCachedCluster.itsNextCluster		= theCluster->itsNextCluster;
+		theCachedCluster.itsLeafFlag		= theCluster->itsLeafFlag;
+		theCachedCluster.itsPadding			= 0;
+
+		memcpy(theWriteLocation, &theCachedCluster, sizeof(theCachedCluster));
+		theWriteLocation += sizeof(theCachedCluster);
+	}
+
+	if (theWriteLocation != aBuffer + aBufferSize)
+		return u"Grave error while writing cache in WriteHoneycombCache().";
+
+	return NULL;
+}
+
+
+ErrorText ReadHoneycombCache(
+	const Byte	*aBuffer,		//	input
+	size_t		aBufferSize,
+	Honeycomb	**aHoneycomb)	//	output
+{
+	ErrorText				theCorruptMessage	= u"The cached honeycomb is corrupt.";
+	CachedHoneycombHeader	theHeader;
+	CachedHoneycell			theCachedCell;
+	CachedHoneycellCluster	theCachedCluster;
+	HoneycellCluster		*theCluster;
+	const Byte				*theReadLocation;
+	unsigned int			theNumBlocks,
+							i,
+							j;
+
+	if (*aHoneycomb != NULL)
+		return u"ReadHoneycombCache() received a non-NULL output location.";
+
+	if (aBufferSize < sizeof(theHeader))
+		return theCorruptMessage;
+	memcpy(&theHeader, aBuffer, sizeof(theHeader));
+	theReadLocation = aBuffer + sizeof(theHeader);
+	theNumBlocks = (theHeader.itsNumCells + 3) / 4;
+
+	if (theHeader.itsNumCells > aBufferSize / sizeof(CachedHoneycell)	//	for safety
+	 || theHeader.itsNumClusters > 2 * (theHeader.itsNumCells / 4) + 2	//	the most AllocateHoneycomb() makes room for
+	 || (theHeader.itsNumClusters == 0) != (theHeader.itsNumCells == 0)
+	 || aBufferSize != sizeof(theHeader)
+						+ theHeader.itsNumCells    * sizeof(CachedHoneycell)
+						+ theNumBlocks             * sizeof(HoneycellCenterBlock)
+						+ theHeader.itsNumClusters * sizeof(CachedHoneycellCluster))
+		return theCorruptMessage;
+
+	*aHoneycomb = AllocateHoneycomb(theHeader.itsNumCells, 0);
+	if (*aHoneycomb == NULL)
+		return u"Couldn't get memory for aHoneycomb in ReadHoneycombCache().";
+
+	for (i = 0; i < theHeader.itsNumCells; i++)
+	{
+		memcpy(&theCachedCell, theReadLocation, sizeof(theCachedCell));
+		theReadLocation += sizeof(theCachedCell);
+
+		memcpy((*aHoneycomb)->itsCells[i].itsMatrix.m, theCachedCell.itsMatrix, sizeof(theCachedCell.itsMatrix));
+		(*aHoneycomb)->itsCells[i].itsMatrix.itsParity				= (theCachedCell.itsParity == ImageNegative ? ImageNegative : ImagePositive);
+		(*aHoneycomb)->itsCells[i].itsCellCenterInWorldSpace		= theCachedCell.itsCellCenterInWorldSpace;
+	}
+
+	memcpy((*aHoneycomb)->itsCellCenterBlocks, theReadLocation, theNumBlocks * sizeof(HoneycellCenterBlock));
+	theReadLocation += theNumBlocks * sizeof(HoneycellCenterBlock);
+
+	for (i = 0; i < theNumBlocks; i++)
+		for (j = 0; j < 4; j++)
+			if ((*aHoneycomb)->itsCellCenterBlocks[i].itsCellIndices[j] >= theHeader.itsNumCells
+			 && (*aHoneycomb)->itsCellCenterBlocks[i].itsCellIndices[j] != 0xFFFFFFFF)
+				goto CorruptHoneycombCache;
+
+	//	CullAndSortVisibleCells() trusts the tree's indices,
+	//	so check that each cluster stays within its subtree.
+	(*aHoneycomb)->itsNumClusters = theHeader.itsNumClusters;
+	for (i = 0; i < theHeader.itsNumClusters; i++)
+	{
+		memcpy(&theCachedCluster, theReadLocation, sizeof(theCachedCluster));
+		theReadLocation += sizeof(theCachedCluster);
+
+		if (theCachedCluster.itsFirstBlock > theNumBlocks
+		 || theCachedCluster.itsNumBlocks  > theNumBlocks - theCachedCluster.itsFirstBlock
+		 || theCachedCluster.itsNextCluster <= i
+		 || theCachedCluster.itsNextCluster > theHeader.itsNumClusters
+		 || (theCachedCluster.itsLeafFlag != 0) != (theCachedCluster.itsNextCluster == i + 1))
+			goto CorruptHoneycombCache;
+
+		theCluster = &(*aHoneycomb)->itsClusters[i];
+		theCluster->itsCenter		= theCachedCluster.itsCenter;
+		theCluster->itsCoshSpread	= theCachedCluster.itsCoshSpread;
+		theCluster->itsSinhSpread	= theCachedCluster.itsSinhSpread;
+		theCluster->itsSpread		= theCachedCluster.itsSpread;
+		theCluster->itsFirstBlock	= theCachedCluster.itsFirstBlock;
+		theCluster->itsNumBlocks	= theCachedCluster.itsNumBlocks;
+		theCluster->itsMinCellIndex	= theCachedCluster.itsMinCellIndex;
+		theCluster->itsNextCluster	= theCachedCluster.itsNextCluster;
+		theCluster->itsLeafFlag		= (theCachedCluster.itsLeafFlag != 0);
+	}
+
+	return NULL;
+
+CorruptHoneycombCache:
+
+	FreeHoneycomb(aHoneycomb);
+	return theCorruptMessage;
+}
+
+
+void MakeDirichletMesh(
+	DirichletDomain	*aDirichletDomain,						//	input
+	bool			aShowColorCoding,						//	input
+	unsigned int	*aNumMeshVertices,						//	output
+	double			(**someMeshVertexPositions)[4],			//	output;	with aperture fully open
+	double			(**someMeshVertexTexCoords)[3],			//	output;	with aperture fully open
+	double			(**someMeshVertexClosedPositions)[4],	//	output;	with aperture fully closed
+	double			(**someMeshVertexClosedTexCoords)[2],	//	output;	with aperture fully closed
+	double			(**someMeshVertexColors)[4],			//	output;	pre-multiplied (αR, αG, αB, α)
+	unsigned int	*aNumMeshFacets,						//	output
+	unsigned int	(**someMeshFacets)[3])					//	output
+{
+	MeshBuffers	theMeshBuffers;
+
+	GEOMETRY_GAMES_ASSERT(
+			aDirichletDomain				!= NULL
+		 && aNumMeshVertices				!= NULL
+		 && aNumMeshFacets					!= NULL
+		 && someMeshVertexPositions			!= NULL
+		 && someMeshVertexTexCoords			!= NULL
+		 && someMeshVertexClosedPositions	!= NULL
+		 && someMeshVertexClosedTexCoords	!= NULL
+		 && someMeshVertexColors			!= NULL
+		 && someMeshFacets					!= NULL,
+		"Output pointers must not be NULL");
+	GEOMETRY_GAMES_ASSERT(
+			*aNumMeshVertices				== 0
+		 && *aNumMeshFacets					== 0
+		 && *someMeshVertexPositions		== NULL
+		 && *someMeshVertexTexCoords		== NULL
+		 && *someMeshVertexClosedPositions	== NULL
+		 && *someMeshVertexClosedTexCoords	== NULL
+		 && *someMeshVertexColors			== NULL
+		 && *someMeshFacets					== NULL,
+		"Output pointers must point to NULL arrays");
+
+	//	Count the mesh's total number of vertices and total number of facets.
+	CountDirichletMesh(aDirichletDomain, aNumMeshVertices, aNumMeshFacets);
+	
+	//	Allocate the arrays.  The caller will take responsibility
+	//	for calling FreeDirichletMesh() to free these arrays
+	//	when they're no longer needed.
+	//
+	*someMeshVertexPositions		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshVertexTexCoords		= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
+	*someMeshVertexClosedPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshVertexClosedTexCoords	= (double (*)[2]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [2]) );
+	*someMeshVertexColors			= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshFacets					= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
+
+	//	Write the mesh into the arrays.
+	SetMeshBuffersForArrays(&theMeshBuffers,
+							*someMeshVertexPositions,
+							*someMeshVertexTexCoords,
+							*someMeshVertexColors,
+							*someMeshVertexClosedPositions,
+							*someMeshVertexClosedTexCoords,
+							*someMeshFacets);
+	WriteDirichletMesh(aDirichletDomain, aShowColorCoding, &theMeshBuffers);
+}
+
+void CountDirichletMesh(
+	DirichletDomain	*aDirichletDomain,	//	input
+	unsigned int	*aNumMeshVertices,	//	output
+	unsigned int	*aNumMeshFacets)	//	output
+{
+	HEFace			*theFace;
+	HEHalfEdge		*theHalfEdge;
+	unsigned int	theFaceOrder;
+
+	//	Each n-sided face contributes an annular region,
+	//	realized as n trapezoids, each with 4 vertices and 2 facets.
+	//	Count the mesh's total number of vertices and total number of facets.
+	
+	*aNumMeshVertices	= 0;
+	*aNumMeshFacets		= 0;
+	
+	for (	theFace = aDirichletDomain->itsFaceList;
+			theFace != NULL;
+			theFace = theFace->itsNext)
+	{
+		//	Compute the face order n.
+		theFaceOrder = 0;
+		theHalfEdge = theFace->itsHalfEdge;
+		do
+		{
+			theFaceOrder++;							//	count this edge
+			theHalfEdge	= theHalfEdge->itsCycle;	//	move on to the next edge
+		} while (theHalfEdge != theFace->itsHalfEdge);
+	
+		//	Increment the counts.
+		*aNumMeshVertices	+= 4 * theFaceOrder;
+		*aNumMeshFacets		+= 2 * theFaceOrder;
+	}
+}
+
+void WriteDirichletMesh(
+	DirichletDomain		*aDirichletDomain,	//	input
+	bool				aShowColorCoding,	//	input
+	const MeshBuffers	*someMeshBuffers)	//	output;	room for CountDirichletMesh()'s vertices and facets
+{
+	HEFace			*theFace;
+	HEHalfEdge		*theHalfEdge;
+	double			theTextureMultiple;
+	unsigned int	theMeshVertexIndex,
+					theMeshFacetIndex;
+	double			theDirichletDomainFaceColor[4];	//	pre-multiplied (αR, αG, αB, α)
+	Vector			*theFaceCenter;		//	normalized to the SpaceType
+	bool			theParity;
+	Vector			*theNearOuterVertex,//	normalized to the SpaceType
+					*theFarOuterVertex;	//	normalized to the SpaceType
+	double			theBaseTex,
+					theAltitudeTex,
+					theNearTexCoords[3],
+					theFarTexCoords[3],
+					theCenterTexCoords[2];
+
+	GEOMETRY_GAMES_ASSERT(
+			aDirichletDomain	!= NULL
+		 && someMeshBuffers		!= NULL,
+		"Input and output pointers must not be NULL");
+
+	//	Create a mesh for a Dirichlet polyhedron with windows cut in its faces.
+	//	Each face will be a polygonal annulus.
+	//
+	//	The mesh doesn't depend on the aperture.  Instead each vertex
+	//	comes in two versions, one for a fully open aperture
+	//	and one for a fully closed aperture, and the vertex function
+	//	interpolates between them.  So a pinch gesture needn't
+	//	rebuild the mesh.  If the aperture is a, then an inner vertex
+	//	sits at the normalized interpolation
+	//
+	//		(1 - a)·(face center)  +  a·(outer vertex)
+	//
+	//	and its texture coordinates run linearly in a.
+	//	An outer vertex's two versions coincide.
+	//
+	//		Note:
+	//		Less vertex sharing is possible than you might at first think,
+	//		because even when vertices belonging to adjacent facets
+	//		share the same position in space, they typically have
+	//		different texture coordinates.  Moreover, if we think
+	//		of each polygonal annulus as the union of n quads,
+	//		then not even consecutive quads can share vertices,
+	//		because their required texture coordinates differ.
+	//		(If an underlying face of the Dirichlet domain is regular,
+	//		then texture coordinates may be assigned in such a way
+	//		that consecutive quads may share vertices, but if
+	//		an underlying face isn't regular, then that trick doesn't work.)
+	//
+
+	theTextureMultiple = (aShowColorCoding ? FACE_TEXTURE_MULTIPLE_PLAIN : FACE_TEXTURE_MULTIPLE_WOOD);
+
+	//	Keep track of the current vertex's index...
+	theMeshVertexIndex = 0;
+
+	//	... and the current facet's index.
+	theMeshFacetIndex = 0;
+
+	//	Process each of the Dirichlet domain's faces in turn.
 	for (	theFace = aDirichletDomain->itsFaceList;
 			theFace != NULL;
 			theFace = theFace->itsNext)
@@ -1935,19 +3150,8 @@ void MakeDirichletMesh(
 			//		to facilitate texturing.  See details below.
 			//
 
-			theNearOuterVertex = &theHalfEdge->itsTip->itsNormalizedPosition;
-			VectorInterpolate(	theFaceCenter,
-								theNearOuterVertex,
-								aCurrentAperture,
-								&theNearInnerVertex);
-			(void) VectorNormalize(&theNearInnerVertex, aDirichletDomain->itsSpaceType, &theNearInnerVertex);
-
-			theFarOuterVertex = &theHalfEdge->itsCycle->itsTip->itsNormalizedPosition;
-			VectorInterpolate(	theFaceCenter,
-								theFarOuterVertex,
-								aCurrentAperture,
-								&theFarInnerVertex);
-			(void) VectorNormalize(&theFarInnerVertex, aDirichletDomain->itsSpaceType, &theFarInnerVertex);
+			theNearOuterVertex	= &theHalfEdge->itsTip->itsNormalizedPosition;
+			theFarOuterVertex	= &theHalfEdge->itsCycle->itsTip->itsNormalizedPosition;
 
 			//	Convert the triangle's dimensions from physical units
 			//	to texture coordinate units.
@@ -1970,81 +3174,40 @@ void MakeDirichletMesh(
 			//		Vertices-at-infinity would further complicate matters.
 			//
 
+			theNearTexCoords[0]		= ( theBaseTex * ( theParity ? 0.0 : 1.0 ) );
+			theNearTexCoords[1]		= 0.0;
+			theNearTexCoords[2]		= 0.0;	//	unused for non-cubemap texture
+
+			theFarTexCoords[0]		= ( theBaseTex * ( theParity ? 1.0 : 0.0 ) );
+			theFarTexCoords[1]		= 0.0;
+			theFarTexCoords[2]		= 0.0;	//	unused for non-cubemap texture
+
+			theCenterTexCoords[0]	= 0.5 * theBaseTex;
+			theCenterTexCoords[1]	= theAltitudeTex;
+
 			//	near inner vertex
-			
-			(*thePosition)[0] = theNearInnerVertex.v[0];
-			(*thePosition)[1] = theNearInnerVertex.v[1];
-			(*thePosition)[2] = theNearInnerVertex.v[2];
-			(*thePosition)[3] = theNearInnerVertex.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = ( theBaseTex * ( theParity ? 0.5 - 0.5*aCurrentAperture : 0.5 + 0.5*aCurrentAperture ) );
-			(*theTexCoords)[1] = ( theAltitudeTex * (1.0 - aCurrentAperture) );
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theDirichletDomainFaceColor[0];
-			(*theColor)[1] = theDirichletDomainFaceColor[1];
-			(*theColor)[2] = theDirichletDomainFaceColor[2];
-			(*theColor)[3] = theDirichletDomainFaceColor[3];
-			theColor++;
+			WriteMeshVertex(		someMeshBuffers, theMeshVertexIndex + 0,
+									theNearOuterVertex->v, theNearTexCoords, theDirichletDomainFaceColor);
+			WriteMeshClosedVertex(	someMeshBuffers, theMeshVertexIndex + 0,
+									theFaceCenter->v, theCenterTexCoords);
 
 			//	far inner vertex
-
-			(*thePosition)[0] = theFarInnerVertex.v[0];
-			(*thePosition)[1] = theFarInnerVertex.v[1];
-			(*thePosition)[2] = theFarInnerVertex.v[2];
-			(*thePosition)[3] = theFarInnerVertex.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = ( theBaseTex * ( theParity ? 0.5 + 0.5*aCurrentAperture : 0.5 - 0.5*aCurrentAperture ) );
-			(*theTexCoords)[1] = ( theAltitudeTex * (1.0 - aCurrentAperture) );
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theDirichletDomainFaceColor[0];
-			(*theColor)[1] = theDirichletDomainFaceColor[1];
-			(*theColor)[2] = theDirichletDomainFaceColor[2];
-			(*theColor)[3] = theDirichletDomainFaceColor[3];
-			theColor++;
+			WriteMeshVertex(		someMeshBuffers, theMeshVertexIndex + 1,
+									theFarOuterVertex->v, theFarTexCoords, theDirichletDomainFaceColor);
+			WriteMeshClosedVertex(	someMeshBuffers, theMeshVertexIndex + 1,
+									theFaceCenter->v, theCenterTexCoords);
 
 			//	near outer vertex
-
-			(*thePosition)[0] = theNearOuterVertex->v[0];
-			(*thePosition)[1] = theNearOuterVertex->v[1];
-			(*thePosition)[2] = theNearOuterVertex->v[2];
-			(*thePosition)[3] = theNearOuterVertex->v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = ( theBaseTex * ( theParity ? 0.0 : 1.0 ) );
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theDirichletDomainFaceColor[0];
-			(*theColor)[1] = theDirichletDomainFaceColor[1];
-			(*theColor)[2] = theDirichletDomainFaceColor[2];
-			(*theColor)[3] = theDirichletDomainFaceColor[3];
-			theColor++;
+			WriteMeshVertex(		someMeshBuffers, theMeshVertexIndex + 2,
+									theNearOuterVertex->v, theNearTexCoords, theDirichletDomainFaceColor);
+			WriteMeshClosedVertex(	someMeshBuffers, theMeshVertexIndex + 2,
+									theNearOuterVertex->v, theNearTexCoords);
 
 			//	far outer vertex
-
-			(*thePosition)[0] = theFarOuterVertex->v[0];
-			(*thePosition)[1] = theFarOuterVertex->v[1];
-			(*thePosition)[2] = theFarOuterVertex->v[2];
-			(*thePosition)[3] = theFarOuterVertex->v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = ( theBaseTex * ( theParity ? 1.0 : 0.0 ) );
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theDirichletDomainFaceColor[0];
-			(*theColor)[1] = theDirichletDomainFaceColor[1];
-			(*theColor)[2] = theDirichletDomainFaceColor[2];
-			(*theColor)[3] = theDirichletDomainFaceColor[3];
-			theColor++;
+			WriteMeshVertex(		someMeshBuffers, theMeshVertexIndex + 3,
+									theFarOuterVertex->v, theFarTexCoords, theDirichletDomainFaceColor);
+			WriteMeshClosedVertex(	someMeshBuffers, theMeshVertexIndex + 3,
+									theFarOuterVertex->v, theFarTexCoords);
 			
 			//	Create a pair of triangles.
 			//
@@ -2053,15 +3216,15 @@ void MakeDirichletMesh(
 			//		clockwise winding number when viewed from inside the Dirichlet domain.
 			//
 
-			(*theMeshFace)[0] = theMeshVertexIndex + 0;
-			(*theMeshFace)[1] = theMeshVertexIndex + 1;
-			(*theMeshFace)[2] = theMeshVertexIndex + 2;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 0,
+							theMeshVertexIndex + 1,
+							theMeshVertexIndex + 2);
 
-			(*theMeshFace)[0] = theMeshVertexIndex + 2;
-			(*theMeshFace)[1] = theMeshVertexIndex + 1;
-			(*theMeshFace)[2] = theMeshVertexIndex + 3;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 2,
+							theMeshVertexIndex + 1,
+							theMeshVertexIndex + 3);
 		
 			//	Advance theMeshVertexIndex.
 			theMeshVertexIndex += 4;
@@ -2075,42 +3238,34 @@ void MakeDirichletMesh(
 
 		} while (theHalfEdge != theFace->itsHalfEdge);
 	}
-	
-	//	Did we write the correct number of entries into each of the arrays?
-	GEOMETRY_GAMES_ASSERT(
-		thePosition  - (*someMeshVertexPositions) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexPositions in MakeDirichletMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theTexCoords - (*someMeshVertexTexCoords) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexTexCoords in MakeDirichletMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theColor     - (*someMeshVertexColors   ) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexColors in MakeDirichletMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theMeshFace - (*someMeshFacets) == *aNumMeshFacets,
-		"Wrong number of elements written into someMeshFacets in MakeDirichletMesh()");
 }
 
 void FreeDirichletMesh(
-	unsigned int	*aNumMeshVertices,				//	output
-	double			(**someMeshVertexPositions)[4],	//	output
-	double			(**someMeshVertexTexCoords)[3],	//	output
-	double			(**someMeshVertexColors)[4],	//	output
-	unsigned int	*aNumMeshFacets,				//	output
-	unsigned int	(**someMeshFacets)[3])			//	output
+	unsigned int	*aNumMeshVertices,						//	output
+	double			(**someMeshVertexPositions)[4],			//	output
+	double			(**someMeshVertexTexCoords)[3],			//	output
+	double			(**someMeshVertexClosedPositions)[4],	//	output
+	double			(**someMeshVertexClosedTexCoords)[2],	//	output
+	double			(**someMeshVertexColors)[4],			//	output
+	unsigned int	*aNumMeshFacets,						//	output
+	unsigned int	(**someMeshFacets)[3])					//	output
 {
 	GEOMETRY_GAMES_ASSERT(
-			aNumMeshVertices		!= NULL
-		 && aNumMeshFacets			!= NULL
-		 && someMeshVertexPositions	!= NULL
-		 && someMeshVertexTexCoords	!= NULL
-		 && someMeshVertexColors	!= NULL
-		 && someMeshFacets			!= NULL,
+			aNumMeshVertices				!= NULL
+		 && aNumMeshFacets					!= NULL
+		 && someMeshVertexPositions			!= NULL
+		 && someMeshVertexTexCoords			!= NULL
+		 && someMeshVertexClosedPositions	!= NULL
+		 && someMeshVertexClosedTexCoords	!= NULL
+		 && someMeshVertexColors			!= NULL
+		 && someMeshFacets					!= NULL,
 		"Output pointers must not be NULL");
 	
 	*aNumMeshVertices	= 0;
 	FREE_MEMORY_SAFELY(*someMeshVertexPositions);
 	FREE_MEMORY_SAFELY(*someMeshVertexTexCoords);
+	FREE_MEMORY_SAFELY(*someMeshVertexClosedPositions);
+	FREE_MEMORY_SAFELY(*someMeshVertexClosedTexCoords);
 	FREE_MEMORY_SAFELY(*someMeshVertexColors);
 
 	*aNumMeshFacets		= 0;
@@ -2123,23 +3278,11 @@ void MakeVertexFigureMesh(
 	unsigned int	*aNumMeshVertices,				//	output
 	double			(**someMeshVertexPositions)[4],	//	output
 	double			(**someMeshVertexTexCoords)[3],	//	output
-	double			(**someMeshVertexColors)[4],	//	output;	pre-multiplied (αR, αG, αB, α)
-	unsigned int	*aNumMeshFacets,				//	output
-	unsigned int	(**someMeshFacets)[3])			//	output
-{
-	HEVertex		*theVertex;
-	HEHalfEdge		*theHalfEdge;
-	unsigned int	theVertexOrder;
-	double			(*thePosition)[4],
-					(*theTexCoords)[3],
-					(*theColor)[4];		//	pre-multiplied (αR, αG, αB, α)
-	unsigned int	theMeshVertexIndex,
-					(*theMeshFace)[3];
-	bool			theParity;
-	HEHalfEdge		*theNextHalfEdge;
-	
-	static const double	theWhiteColor[4]	= {1.0, 1.0, 1.0, 1.0},	//	pre-multiplied (αR, αG, αB, α)
-						theGreyColor[4]		= {0.5, 0.5, 0.5, 1.0};	//	pre-multiplied (αR, αG, αB, α)
+	double			(**someMeshVertexColors)[4],	//	output;	pre-multiplied (αR, αG, αB, α)
+	unsigned int	*aNumMeshFacets,				//	output
+	unsigned int	(**someMeshFacets)[3])			//	output
+{
+	MeshBuffers	theMeshBuffers;
 
 	GEOMETRY_GAMES_ASSERT(
 			aDirichletDomain		!= NULL
@@ -2159,18 +3302,37 @@ void MakeVertexFigureMesh(
 		 && *someMeshFacets				== NULL,
 		"Output pointers must point to NULL arrays");
 
-	//	Create a mesh for the vertex figure faces belonging to this Dirichlet domain.
-	//	Each face will be a polygon with a window cut in its center,
-	//	in other words, each face will be a polygonal annulus.
-	//	Note that we're not create a whole vertex figure in one place,
-	//	but rather we're create on polygonal annulus at each
-	//	of the Dirichlet domains vertices.  They'll ultimately get
-	//	pieced together in the tiling.
-	//
-	//		Note:
-	//		Less vertex sharing is possible than you might at first think,
-	//		for the same reason as explained in MakeDirichletMesh().
+	//	Count the mesh's total number of vertices and total number of facets.
+	CountVertexFigureMesh(aDirichletDomain, aNumMeshVertices, aNumMeshFacets);
+	
+	//	Allocate the arrays.  The caller will take responsibility
+	//	for calling FreeVertexFigureMesh() to free these arrays
+	//	when they're no longer needed.
 	//
+	*someMeshVertexPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshVertexTexCoords	= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
+	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
+
+	//	Write the mesh into the arrays.
+	SetMeshBuffersForArrays(&theMeshBuffers,
+							*someMeshVertexPositions,
+							*someMeshVertexTexCoords,
+							*someMeshVertexColors,
+							NULL,
+							NULL,
+							*someMeshFacets);
+	WriteVertexFigureMesh(aDirichletDomain, &theMeshBuffers);
+}
+
+void CountVertexFigureMesh(
+	DirichletDomain	*aDirichletDomain,	//	input
+	unsigned int	*aNumMeshVertices,	//	output
+	unsigned int	*aNumMeshFacets)	//	output
+{
+	HEVertex		*theVertex;
+	HEHalfEdge		*theHalfEdge;
+	unsigned int	theVertexOrder;
 
 	//	Each vertex (of the Dirichlet domain) of order n contributes
 	//	an annular region, realized as n pairs of trapezoids.
@@ -2198,26 +3360,49 @@ void MakeVertexFigureMesh(
 		*aNumMeshVertices	+= 2 * 4 * theVertexOrder;
 		*aNumMeshFacets		+= 2 * 2 * theVertexOrder;
 	}
+}
+
+void WriteVertexFigureMesh(
+	DirichletDomain		*aDirichletDomain,	//	input
+	const MeshBuffers	*someMeshBuffers)	//	output;	room for CountVertexFigureMesh()'s vertices and facets
+{
+	HEVertex		*theVertex;
+	HEHalfEdge		*theHalfEdge;
+	unsigned int	theMeshVertexIndex,
+					theMeshFacetIndex;
+	bool			theParity;
+	HEHalfEdge		*theNextHalfEdge;
+	double			theNearInnerTexCoords[3],
+					theNearOuterTexCoords[3],
+					theFarInnerTexCoords[3],
+					theFarOuterTexCoords[3];
 	
-	//	Allocate the arrays.  The caller will take responsibility
-	//	for calling FreeVertexFigureMesh() to free these arrays
-	//	when they're no longer needed.
+	static const double	theWhiteColor[4]	= {1.0, 1.0, 1.0, 1.0},	//	pre-multiplied (αR, αG, αB, α)
+						theGreyColor[4]		= {0.5, 0.5, 0.5, 1.0};	//	pre-multiplied (αR, αG, αB, α)
+
+	GEOMETRY_GAMES_ASSERT(
+			aDirichletDomain	!= NULL
+		 && someMeshBuffers		!= NULL,
+		"Input and output pointers must not be NULL");
+
+	//	Create a mesh for the vertex figure faces belonging to this Dirichlet domain.
+	//	Each face will be a polygon with a window cut in its center,
+	//	in other words, each face will be a polygonal annulus.
+	//	Note that we're not create a whole vertex figure in one place,
+	//	but rather we're create on polygonal annulus at each
+	//	of the Dirichlet domains vertices.  They'll ultimately get
+	//	pieced together in the tiling.
+	//
+	//		Note:
+	//		Less vertex sharing is possible than you might at first think,
+	//		for the same reason as explained in MakeDirichletMesh().
 	//
-	*someMeshVertexPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshVertexTexCoords	= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
-	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
 
-	//	Keep running pointers to the current vertex's attributes...
-	thePosition		= *someMeshVertexPositions;
-	theTexCoords	= *someMeshVertexTexCoords;
-	theColor		= *someMeshVertexColors;
-	
-	//	... and also keep track of its index in the array.
+	//	Keep track of the current vertex's index...
 	theMeshVertexIndex = 0;
 
-	//	Keep a running pointer to the current entry in the index buffer.
-	theMeshFace = *someMeshFacets;
+	//	... and the current facet's index.
+	theMeshFacetIndex = 0;
 
 	//	Process each of the Dirichlet domain's vertices in turn.
 	for (	theVertex = aDirichletDomain->itsVertexList;
@@ -2236,186 +3421,85 @@ void MakeVertexFigureMesh(
 			theNextHalfEdge = theHalfEdge->itsMate->itsCycle;
 
 
+			//	Texture coordinates
+
+			theNearInnerTexCoords[0] = (theParity ? 0.15 : 0.85);
+			theNearInnerTexCoords[1] = 1.0;
+			theNearInnerTexCoords[2] = 0.0;	//	unused for non-cubemap texture
+
+			theNearOuterTexCoords[0] = (theParity ? 0.00 : 1.00);
+			theNearOuterTexCoords[1] = 0.0;
+			theNearOuterTexCoords[2] = 0.0;	//	unused for non-cubemap texture
+
+			theFarInnerTexCoords[0]  = (theParity ? 0.85 : 0.15);
+			theFarInnerTexCoords[1]  = 1.0;
+			theFarInnerTexCoords[2]  = 0.0;	//	unused for non-cubemap texture
+
+			theFarOuterTexCoords[0]  = (theParity ? 1.00 : 0.00);
+			theFarOuterTexCoords[1]  = 0.0;
+			theFarOuterTexCoords[2]  = 0.0;	//	unused for non-cubemap texture
+
+
 			//	Vertices
-			
+
 			//		light near inner vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 0,
+				theHalfEdge->itsInnerPoint.v, theNearInnerTexCoords, theWhiteColor);
 
-			(*thePosition)[0] = theHalfEdge->itsInnerPoint.v[0];
-			(*thePosition)[1] = theHalfEdge->itsInnerPoint.v[1];
-			(*thePosition)[2] = theHalfEdge->itsInnerPoint.v[2];
-			(*thePosition)[3] = theHalfEdge->itsInnerPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.15 : 0.85);
-			(*theTexCoords)[1] = 1.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theWhiteColor[0];
-			(*theColor)[1] = theWhiteColor[1];
-			(*theColor)[2] = theWhiteColor[2];
-			(*theColor)[3] = theWhiteColor[3];
-			theColor++;
-			
 			//		light near outer vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 1,
+				theHalfEdge->itsOuterPoint.v, theNearOuterTexCoords, theWhiteColor);
 
-			(*thePosition)[0] = theHalfEdge->itsOuterPoint.v[0];
-			(*thePosition)[1] = theHalfEdge->itsOuterPoint.v[1];
-			(*thePosition)[2] = theHalfEdge->itsOuterPoint.v[2];
-			(*thePosition)[3] = theHalfEdge->itsOuterPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.00 : 1.00);
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theWhiteColor[0];
-			(*theColor)[1] = theWhiteColor[1];
-			(*theColor)[2] = theWhiteColor[2];
-			(*theColor)[3] = theWhiteColor[3];
-			theColor++;
-			
 			//		light far inner vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 2,
+				theNextHalfEdge->itsInnerPoint.v, theFarInnerTexCoords, theWhiteColor);
 
-			(*thePosition)[0] = theNextHalfEdge->itsInnerPoint.v[0];
-			(*thePosition)[1] = theNextHalfEdge->itsInnerPoint.v[1];
-			(*thePosition)[2] = theNextHalfEdge->itsInnerPoint.v[2];
-			(*thePosition)[3] = theNextHalfEdge->itsInnerPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.85 : 0.15);
-			(*theTexCoords)[1] = 1.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theWhiteColor[0];
-			(*theColor)[1] = theWhiteColor[1];
-			(*theColor)[2] = theWhiteColor[2];
-			(*theColor)[3] = theWhiteColor[3];
-			theColor++;
-			
 			//		light far outer vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 3,
+				theNextHalfEdge->itsOuterPoint.v, theFarOuterTexCoords, theWhiteColor);
 
-			(*thePosition)[0] = theNextHalfEdge->itsOuterPoint.v[0];
-			(*thePosition)[1] = theNextHalfEdge->itsOuterPoint.v[1];
-			(*thePosition)[2] = theNextHalfEdge->itsOuterPoint.v[2];
-			(*thePosition)[3] = theNextHalfEdge->itsOuterPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 1.00 : 0.00);
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theWhiteColor[0];
-			(*theColor)[1] = theWhiteColor[1];
-			(*theColor)[2] = theWhiteColor[2];
-			(*theColor)[3] = theWhiteColor[3];
-			theColor++;
-			
 			//		dark near inner vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 4,
+				theHalfEdge->itsInnerPoint.v, theNearInnerTexCoords, theGreyColor);
 
-			(*thePosition)[0] = theHalfEdge->itsInnerPoint.v[0];
-			(*thePosition)[1] = theHalfEdge->itsInnerPoint.v[1];
-			(*thePosition)[2] = theHalfEdge->itsInnerPoint.v[2];
-			(*thePosition)[3] = theHalfEdge->itsInnerPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.15 : 0.85);
-			(*theTexCoords)[1] = 1.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theGreyColor[0];
-			(*theColor)[1] = theGreyColor[1];
-			(*theColor)[2] = theGreyColor[2];
-			(*theColor)[3] = theGreyColor[3];
-			theColor++;
-			
 			//		dark near outer vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 5,
+				theHalfEdge->itsOuterPoint.v, theNearOuterTexCoords, theGreyColor);
 
-			(*thePosition)[0] = theHalfEdge->itsOuterPoint.v[0];
-			(*thePosition)[1] = theHalfEdge->itsOuterPoint.v[1];
-			(*thePosition)[2] = theHalfEdge->itsOuterPoint.v[2];
-			(*thePosition)[3] = theHalfEdge->itsOuterPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.00 : 1.00);
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theGreyColor[0];
-			(*theColor)[1] = theGreyColor[1];
-			(*theColor)[2] = theGreyColor[2];
-			(*theColor)[3] = theGreyColor[3];
-			theColor++;
-			
 			//		dark far inner vertex
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 6,
+				theNextHalfEdge->itsInnerPoint.v, theFarInnerTexCoords, theGreyColor);
 
-			(*thePosition)[0] = theNextHalfEdge->itsInnerPoint.v[0];
-			(*thePosition)[1] = theNextHalfEdge->itsInnerPoint.v[1];
-			(*thePosition)[2] = theNextHalfEdge->itsInnerPoint.v[2];
-			(*thePosition)[3] = theNextHalfEdge->itsInnerPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 0.85 : 0.15);
-			(*theTexCoords)[1] = 1.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theGreyColor[0];
-			(*theColor)[1] = theGreyColor[1];
-			(*theColor)[2] = theGreyColor[2];
-			(*theColor)[3] = theGreyColor[3];
-			theColor++;
-			
 			//		dark far outer vertex
-
-			(*thePosition)[0] = theNextHalfEdge->itsOuterPoint.v[0];
-			(*thePosition)[1] = theNextHalfEdge->itsOuterPoint.v[1];
-			(*thePosition)[2] = theNextHalfEdge->itsOuterPoint.v[2];
-			(*thePosition)[3] = theNextHalfEdge->itsOuterPoint.v[3];
-			thePosition++;
-			
-			(*theTexCoords)[0] = (theParity ? 1.00 : 0.00);
-			(*theTexCoords)[1] = 0.0;
-			(*theTexCoords)[2] = 0.0;	//	unused for non-cubemap texture
-			theTexCoords++;
-			
-			(*theColor)[0] = theGreyColor[0];
-			(*theColor)[1] = theGreyColor[1];
-			(*theColor)[2] = theGreyColor[2];
-			(*theColor)[3] = theGreyColor[3];
-			theColor++;
+			WriteMeshVertex(someMeshBuffers, theMeshVertexIndex + 7,
+				theNextHalfEdge->itsOuterPoint.v, theFarOuterTexCoords, theGreyColor);
 
 
 			//	Facets
 			
 			//		light facets
 			
-			(*theMeshFace)[0] = theMeshVertexIndex + 0;
-			(*theMeshFace)[1] = theMeshVertexIndex + 1;
-			(*theMeshFace)[2] = theMeshVertexIndex + 2;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 0,
+							theMeshVertexIndex + 1,
+							theMeshVertexIndex + 2);
 			
-			(*theMeshFace)[0] = theMeshVertexIndex + 2;
-			(*theMeshFace)[1] = theMeshVertexIndex + 1;
-			(*theMeshFace)[2] = theMeshVertexIndex + 3;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 2,
+							theMeshVertexIndex + 1,
+							theMeshVertexIndex + 3);
 			
 			//		dark facets
 			
-			(*theMeshFace)[0] = theMeshVertexIndex + 4;
-			(*theMeshFace)[1] = theMeshVertexIndex + 6;
-			(*theMeshFace)[2] = theMeshVertexIndex + 5;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 4,
+							theMeshVertexIndex + 6,
+							theMeshVertexIndex + 5);
 			
-			(*theMeshFace)[0] = theMeshVertexIndex + 5;
-			(*theMeshFace)[1] = theMeshVertexIndex + 6;
-			(*theMeshFace)[2] = theMeshVertexIndex + 7;
-			theMeshFace++;
+			WriteMeshFacet(	someMeshBuffers, theMeshFacetIndex++,
+							theMeshVertexIndex + 5,
+							theMeshVertexIndex + 6,
+							theMeshVertexIndex + 7);
 		
 			//		advance theMeshVertexIndex
 			theMeshVertexIndex += 8;
@@ -2430,20 +3514,6 @@ void MakeVertexFigureMesh(
 
 		} while (theHalfEdge != theVertex->itsOutboundHalfEdge);
 	}
-	
-	//	Did we write the correct number of entries into each of the arrays?
-	GEOMETRY_GAMES_ASSERT(
-		thePosition  - (*someMeshVertexPositions) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexPositions in MakeVertexFigureMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theTexCoords - (*someMeshVertexTexCoords) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexTexCoords in MakeVertexFigureMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theColor     - (*someMeshVertexColors   ) == *aNumMeshVertices,
-		"Wrong number of elements written into someMeshVertexColors in MakeVertexFigureMesh()");
-	GEOMETRY_GAMES_ASSERT(
-		theMeshFace - (*someMeshFacets) == *aNumMeshFacets,
-		"Wrong number of elements written into someMeshFacets in MakeVertexFigureMesh()");
 }
 
 void FreeVertexFigureMesh(
@@ -2478,16 +3548,22 @@ void CullAndSortVisibleCells(
 	Matrix		*aViewMatrix,
 	double		anImageWidth,
 	double		anImageHeight,
+	double		anEyeSeparation,	//	0.0 for a single view, STEREO_EYE_SEPARATION for a stereo pair
 	double		aHorizonRadius,
 	double		aDirichletDomainRadius,
 	SpaceType	aSpaceType)
 {
-	double			theCullingHyperplanes[4][4];
-	double			theTilingRadius,
-					theAdjustedDirichletDomainRadius;
-	Honeycell		*theHoneycell;
-	unsigned int	i;
-	Vector			theCellCenterInCameraSpace;
+	double					theCullingHyperplanes[4][4];
+	double					theTilingRadius,
+							theAdjustedDirichletDomainRadius,
+							theCoshDirichletDomainRadius,
+							theCoshTilingRadius,
+							theSinhTilingRadius;
+	CellCullingParameters	theParameters;
+	unsigned int			i,
+							j;
+	HoneycellCluster		*theCluster;
+	HoneycellSortEntry		*theSortedEntries;
 
 	if (aHoneycomb != NULL)
 	{
@@ -2502,137 +3578,441 @@ void CullAndSortVisibleCells(
 		//
 		//		aHorizonRadius + aDirichletDomainRadius
 		//
-		//	units of the observer.
-		theTilingRadius = aHorizonRadius + aDirichletDomainRadius;
+		//	units of the observer.  In a stereo pair each eye
+		//	sits anEyeSeparation/2 from the observer.
+		theTilingRadius = aHorizonRadius + aDirichletDomainRadius + 0.5 * anEyeSeparation;
 		
-		//	For best efficiency in BoundingSphereIntersectsViewFrustum(),
-		//	pre-compute sine/ø/sinh of aDirichletDomainRadius.
+		//	Rather than computing each cell's distance d
+		//	from the observer, compare a key that increases with d,
+		//	computed directly from the cell center (x,y,z,w) in camera space:
+		//
+		//		spherical		-|cos(d)| = -|w|
+		//		flat			   d²     = x² + y² + z²
+		//		hyperbolic		 cosh(d)  =  w
+		//
+		//	The spherical case accepts all cells (see below),
+		//	so its key serves only for sorting.  It sorts a cell
+		//	at distance d together with one at distance π - d,
+		//	because the two look equally big on the screen:
+		//	in a space with antipodal symmetry each is
+		//	the other's antipodal image.  That's the right order
+		//	for front-to-back drawing and levels of detail,
+		//	but not for compositing transparent cells,
+		//	so ListVisibleCellsBackToFront() restores the true order.
 		switch (aSpaceType)
 		{
-			case SpaceNone:
-				GEOMETRY_GAMES_ABORT("unexpected SpaceNone");
-				break;
-				
-			case SpaceSpherical:
-				//	This approach works poorly in the spherical case,
-				//	because sin(θ) starts decreasing as θ goes past π/2.
-				//	To avoid complicating an algorithm that works correctly
-				//	and is wonderfully efficient in the more demanding
-				//	Euclidean and hyperbolic cases, we'll ignore
-				//	theAdjustedDirichletDomainRadius in the spherical case
-				//	and simply accept all cells, knowing that performance
-				//	isn't an issue in the spherical case anyhow.
-				theAdjustedDirichletDomainRadius = sin(aDirichletDomainRadius);
-				break;
-				
-			case SpaceFlat:
-				theAdjustedDirichletDomainRadius = aDirichletDomainRadius;
-				break;
-				
-			case SpaceHyperbolic:
-				theAdjustedDirichletDomainRadius = sinh(aDirichletDomainRadius);
-				break;
+			case SpaceSpherical:	theParameters.itsMaxKey = 0.0f;											break;
+			case SpaceFlat:			theParameters.itsMaxKey = (float)(theTilingRadius * theTilingRadius);	break;
+			case SpaceHyperbolic:	theParameters.itsMaxKey = (float) cosh(theTilingRadius);				break;
+			default:				theParameters.itsMaxKey = 0.0f;											break;
 		}
 		
+		//	For best efficiency in the frustum test below,
+		//	pre-compute sine/ø/sinh of aDirichletDomainRadius.
+		theAdjustedDirichletDomainRadius = AdjustedDirichletDomainRadius(aDirichletDomainRadius, aSpaceType);
+		theParameters.itsMinAdjustedDistance = (float)( - theAdjustedDirichletDomainRadius );
+		
 		//	We'll want to cull to the view frustum's side faces.
 		//	Extend each side to a hyperplane through the origin
 		//	in the 4-dimensional embedding space,
 		//	and prepare the inward-pointing unit normal vector
 		//	to each such hyperplane.
 		//
-		//		Note:  The frustum's side faces all pass through
-		//		the origin (0,0,0,1), so these normal vectors
-		//		will all lie in the "horizontal" hyperplane w = 0.
+		//		Note:  For a single view, the frustum's side faces
+		//		all pass through the origin (0,0,0,1), so these
+		//		normal vectors will all lie in the "horizontal"
+		//		hyperplane w = 0.  A stereo pair's widened planes don't.
 		//
-		MakeCullingHyperplanes(anImageWidth, anImageHeight, theCullingHyperplanes);
+		MakeCullingHyperplanes(anImageWidth, anImageHeight, anEyeSeparation, aSpaceType, theCullingHyperplanes);
+		for (i = 0; i < 4; i++)
+			for (j = 0; j < 4; j++)
+				theParameters.itsPlanes[i][j] = (float) theCullingHyperplanes[i][j];
 
-		//	Examine each cell, and put those that are visible
-		//	onto itsVisibleCells list.
-		theHoneycell = aHoneycomb->itsCells;
-		for (i = 0; i < aHoneycomb->itsNumCells; i++)
-		{
-			VectorTimesMatrix(	&theHoneycell->itsCellCenterInWorldSpace,
-								aViewMatrix,
-								&theCellCenterInCameraSpace);
+		for (i = 0; i < 4; i++)
+			for (j = 0; j < 4; j++)
+				theParameters.itsViewMatrix[i][j] = (float) aViewMatrix->m[i][j];
 
-			theHoneycell->itsDistanceCameraToCellCenter = VectorGeometricDistance(&theCellCenterInCameraSpace);
+		theParameters.itsSpaceType	= aSpaceType;
+		theParameters.itsViewParity	= aViewMatrix->itsParity;
 
-			//	Technical note:
-			//
-			//		On the one hand, culling against z > 0 is redundant,
-			//		given that we'll be culling against the view frustum anyhow.
-			//		On the other hand, it's a computationally inexpensive test
-			//		to do first, to eliminate almost half the cells
-			//		without calling BoundingSphereIntersectsViewFrustum()
-			//		on them at all.
+		if (aSpaceType == SpaceSpherical
+		 || aHoneycomb->itsNumCells < CLUSTER_CULLING_MIN_NUM_CELLS)
+		{
+			//	Accept all cells if the space is spherical,
+			//	for the reason explained in AdjustedDirichletDomainRadius().
+			//	CullCellCenterBlocks() still computes their sort keys.
 			//
-			//		(As an added bonus, the few cells that do get culled by z > 0
-			//		and wouldn't get culled by the view frustum are cells
-			//		sitting close to -- but behind -- the origin.  Such cells
-			//		would "steal" one of the maximum level-of-detail slots.
-			//		By culling such cells, the level-of-detail code will
-			//		work a little better.)
+			//	A small honeycomb's clusters are big compared to
+			//	their distance from the observer, so nearly every cluster
+			//	would pass its test anyway.  Testing the blocks directly
+			//	is faster in that case.
+			CullCellCenterBlocks(aHoneycomb, 0, (aHoneycomb->itsNumAllocatedCells + 3) / 4, &theParameters);
+		}
+		else
+		{
+			//	Walk the cluster tree, skipping each cluster whose bounding ball
+			//	(enlarged by aDirichletDomainRadius) misses the view frustum
+			//	or the horizon, and testing the cells of each leaf
+			//	that survives.  Because a cluster's descendants follow it
+			//	directly in itsClusters, the walk needs no stack:
+			//	to skip a cluster's subtree, jump to itsNextCluster.
+			theCoshDirichletDomainRadius	= cosh(aDirichletDomainRadius);
+			theCoshTilingRadius				= cosh(theTilingRadius);
+			theSinhTilingRadius				= sinh(theTilingRadius);
+
+			i = 0;
+			while (i < aHoneycomb->itsNumClusters)
+			{
+				theCluster = &aHoneycomb->itsClusters[i];
+
+				if (theCluster->itsMinCellIndex < aHoneycomb->itsNumCells	//	not hidden by TruncateHoneycomb()
+				 && ClusterMayBeVisible(theCluster,
+										aViewMatrix,
+										aDirichletDomainRadius,
+										theAdjustedDirichletDomainRadius,
+										theCoshDirichletDomainRadius,
+										theTilingRadius,
+										theCoshTilingRadius,
+										theSinhTilingRadius,
+										theCullingHyperplanes,
+										aSpaceType))
+				{
+					if (theCluster->itsLeafFlag)
+						CullCellCenterBlocks(aHoneycomb, theCluster->itsFirstBlock, theCluster->itsNumBlocks, &theParameters);
+
+					i++;	//	descend into the cluster's children, if any
+				}
+				else
+				{
+					i = theCluster->itsNextCluster;
+				}
+			}
+		}
+
+		//	Sort the visible cells in increasing distance
+		//	from the observer.  A radix sort on the keys takes time
+		//	proportional to the number of visible cells, with no
+		//	indirect comparison calls, which matters for hyperbolic spaces
+		//	with thousands of visible cells.  It also keeps cells
+		//	with equal keys in a fixed order, so ties can't flicker
+		//	from one frame to the next.
+		theSortedEntries = RadixSortEntries(aHoneycomb->itsSortEntries,
+											aHoneycomb->itsSortEntries + aHoneycomb->itsNumAllocatedCells,
+											aHoneycomb->itsNumVisibleCells);
+
+		for (i = 0; i < aHoneycomb->itsNumVisibleCells; i++)
+			aHoneycomb->itsVisibleCells[i] = &aHoneycomb->itsCells[theSortedEntries[i].itsCellIndex];
+		aHoneycomb->itsVisibleSortEntries = theSortedEntries;
+	}
+}
+
+void CountVisibleCellsNearerThan(
+	Honeycomb		*aHoneycomb,			//	input
+	double			aDistance,				//	input;  HUGE_VAL counts all visible cells
+	SpaceType		aSpaceType,				//	input
+	ImageParity		aViewParity,			//	input
+	unsigned int	*aNumPlainCells,		//	output
+	unsigned int	*aNumReflectedCells)	//	output
+{
+	uint32_t		theKey;
+	unsigned int	i;
+
+	//	Count the visible cells whose centers lie nearer than aDistance,
+	//	split into plain and reflected cells as in CullAndSortVisibleCells().
+	//	The visible cells are sorted near to far, so the renderer
+	//	may use the counts as the boundaries between levels of detail.
+	//	In a spherical space, aDistance is measured to the nearer of
+	//	each cell center and its antipodal point, as in the sort keys.
+
+	*aNumPlainCells		= 0;
+	*aNumReflectedCells	= 0;
+
+	if (aHoneycomb == NULL)
+		return;
+
+	theKey = SortKeyForDistance(aDistance, aSpaceType);
+
+	for (i = 0; i < aHoneycomb->itsNumVisibleCells; i++)
+	{
+		if (aHoneycomb->itsVisibleSortEntries[i].itsKey >= theKey)
+			break;
+
+		if (aHoneycomb->itsVisibleCells[i]->itsMatrix.itsParity == aViewParity)
+			(*aNumPlainCells)++;
+		else
+			(*aNumReflectedCells)++;
+	}
+}
+
+void ListVisibleCellsBackToFront(
+	Honeycomb	*aHoneycomb,		//	input, as sorted by CullAndSortVisibleCells()
+	Matrix		*aViewMatrix,		//	input, the same view matrix
+	SpaceType	aSpaceType,			//	input
+	uint32_t	*someCellIndices)	//	output, room for itsNumVisibleCells indices into itsCells
+{
+	unsigned int	i;
+	Honeycell		*theCell;
+	Vector			theCellCenterInCameraSpace;
+
+	//	Write the visible cells' indices in order of decreasing distance
+	//	from the observer, for compositing transparent cells back to front.
+	//
+	//	In a flat or hyperbolic space, that's simply the sorted order reversed.
+	//	In a spherical space, CullAndSortVisibleCells() sorted by the distance
+	//	to the nearer of each cell and its antipodal point, which puts
+	//	the back hemisphere's cells (w < 0) farthest first and
+	//	the front hemisphere's cells (w ≥ 0) nearest first, interleaved.
+	//	So list the back hemisphere's cells in sorted order,
+	//	followed by the front hemisphere's cells in reverse sorted order.
+	//	That gives the true back-to-front order with no second sort.
+
+	if (aHoneycomb == NULL)
+		return;
+
+	if (aSpaceType == SpaceSpherical)
+	{
+		for (i = 0; i < aHoneycomb->itsNumVisibleCells; i++)
+		{
+			theCell = aHoneycomb->itsVisibleCells[i];
+			VectorTimesMatrix(&theCell->itsCellCenterInWorldSpace, aViewMatrix, &theCellCenterInCameraSpace);
+			if (theCellCenterInCameraSpace.v[3] < 0.0)
+				*someCellIndices++ = (uint32_t)(theCell - aHoneycomb->itsCells);
+		}
+	}
+
+	for (i = aHoneycomb->itsNumVisibleCells; i-- > 0; )
+	{
+		theCell = aHoneycomb->itsVisibleCells[i];
+		if (aSpaceType == SpaceSpherical)
+		{
+			VectorTimesMatrix(&theCell->itsCellCenterInWorldSpace, aViewMatrix, &theCellCenterInCameraSpace);
+			if (theCellCenterInCameraSpace.v[3] < 0.0)
+				continue;
+		}
+		*someCellIndices++ = (uint32_t)(theCell - aHoneycomb->itsCells);
+	}
+}
+
+
+static bool ClusterMayBeVisible(
+	HoneycellCluster	*aCluster,
+	Matrix				*aViewMatrix,
+	double				aDirichletDomainRadius,
+	double				anAdjustedDirichletDomainRadius,	//	= r or sinh(r), as appropriate for the geometry
+	double				aCoshDirichletDomainRadius,			//	used only in hyperbolic case
+	double				aTilingRadius,
+	double				aCoshTilingRadius,					//	used only in hyperbolic case
+	double				aSinhTilingRadius,					//	used only in hyperbolic case
+	double				someCullingPlanes[4][4],
+	SpaceType			aSpaceType)							//	flat or hyperbolic
+{
+	Vector			theCenterInCameraSpace;
+	double			theAdjustedRadius;
+	bool			theHorizonTest;
+	unsigned int	i;
+
+	//	Every cell center lies within aCluster->itsSpread of the cluster's center,
+	//	so by the triangle inequality, if some cell passes the tests
+	//	in CullCellCenterBlocks(), then the cluster's center passes
+	//	those same tests with aDirichletDomainRadius and aTilingRadius
+	//	each enlarged by itsSpread.  Expand sinh(r + s) and cosh(r + s)
+	//	using the addition formulas, to avoid any transcendental
+	//	function calls here.
+
+	VectorTimesMatrix(&aCluster->itsCenter, aViewMatrix, &theCenterInCameraSpace);
+
+	if (aSpaceType == SpaceFlat)
+	{
+		theAdjustedRadius	= aDirichletDomainRadius + aCluster->itsSpread;
+		theHorizonTest		= theCenterInCameraSpace.v[0] * theCenterInCameraSpace.v[0]
+							+ theCenterInCameraSpace.v[1] * theCenterInCameraSpace.v[1]
+							+ theCenterInCameraSpace.v[2] * theCenterInCameraSpace.v[2]
+							< (aTilingRadius + aCluster->itsSpread) * (aTilingRadius + aCluster->itsSpread);
+	}
+	else	//	aSpaceType == SpaceHyperbolic
+	{
+		theAdjustedRadius	= anAdjustedDirichletDomainRadius * aCluster->itsCoshSpread
+							+ aCoshDirichletDomainRadius      * aCluster->itsSinhSpread;
+		theHorizonTest		= theCenterInCameraSpace.v[3]
+							< aCoshTilingRadius * aCluster->itsCoshSpread
+							+ aSinhTilingRadius * aCluster->itsSinhSpread;
+	}
+
+	if ( ! theHorizonTest )
+		return false;
+
+	if (theCenterInCameraSpace.v[2] <= - theAdjustedRadius)
+		return false;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (theCenterInCameraSpace.v[0] * someCullingPlanes[i][0]
+		  + theCenterInCameraSpace.v[1] * someCullingPlanes[i][1]
+		  + theCenterInCameraSpace.v[2] * someCullingPlanes[i][2]
+		  + theCenterInCameraSpace.v[3] * someCullingPlanes[i][3]
+		  < - theAdjustedRadius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void CullCellCenterBlocks(
+	Honeycomb				*aHoneycomb,
+	unsigned int			aFirstBlock,
+	unsigned int			aNumBlocks,
+	CellCullingParameters	*someParameters)
+{
+	unsigned int			i,
+							k;
+	HoneycellCenterBlock	*theBlock;
+	simd_float4				x,
+							y,
+							z,
+							w,
+							theKeys;
+	simd_int4				theVisibility;
+	unsigned int			theCellIndex;
+	float					(*v)[4],
+							(*p)[4],
+							theMinAdjustedDistance;
+
+	v						= someParameters->itsViewMatrix;
+	p						= someParameters->itsPlanes;
+	theMinAdjustedDistance	= someParameters->itsMinAdjustedDistance;
+
+	//	Examine the cells four at a time, and put those
+	//	that are visible onto the list of sort entries.
+	for (i = aFirstBlock; i < aFirstBlock + aNumBlocks; i++)
+	{
+		theBlock = &aHoneycomb->itsCellCenterBlocks[i];
+
+		//	Transform the cell centers to camera space.
+		x = theBlock->itsX * v[0][0] + theBlock->itsY * v[1][0] + theBlock->itsZ * v[2][0] + theBlock->itsW * v[3][0];
+		y = theBlock->itsX * v[0][1] + theBlock->itsY * v[1][1] + theBlock->itsZ * v[2][1] + theBlock->itsW * v[3][1];
+		z = theBlock->itsX * v[0][2] + theBlock->itsY * v[1][2] + theBlock->itsZ * v[2][2] + theBlock->itsW * v[3][2];
+		w = theBlock->itsX * v[0][3] + theBlock->itsY * v[1][3] + theBlock->itsZ * v[2][3] + theBlock->itsW * v[3][3];
+
+		switch (someParameters->itsSpaceType)
+		{
+			case SpaceSpherical:	theKeys = -simd_abs(w);			break;
+			case SpaceFlat:			theKeys = x*x + y*y + z*z;		break;
+			default:				theKeys =  w;					break;
+		}
+
+		//	Technical note:
+		//
+		//		On the one hand, culling against z > 0 is redundant,
+		//		given that we'll be culling against the view frustum anyhow.
+		//		On the other hand, it's a computationally inexpensive test,
+		//		and the few cells that do get culled by z > 0
+		//		and wouldn't get culled by the view frustum are cells
+		//		sitting close to -- but behind -- the origin.  Such cells
+		//		would get drawn at the finest level-of-detail,
+		//		because they're so close.  By culling such cells,
+		//		we save drawing them for nothing.
+		//
+		//	The frustum test evaluates each culling plane's
+		//	linear functional at each cell center, which gives
+		//	sin(d), d, or sinh(d) according to the geometry.
+		//	MakeCullingHyperplanes() has already absorbed
+		//	the geometry-dependent sign into the planes' w-components,
+		//	which are zero except for a stereo pair's widened planes.
+		//
+		theVisibility = (z > theMinAdjustedDistance)
+					  & (theKeys < someParameters->itsMaxKey)
+					  & (x*p[0][0] + y*p[0][1] + z*p[0][2] + w*p[0][3] >= theMinAdjustedDistance)
+					  & (x*p[1][0] + y*p[1][1] + z*p[1][2] + w*p[1][3] >= theMinAdjustedDistance)
+					  & (x*p[2][0] + y*p[2][1] + z*p[2][2] + w*p[2][3] >= theMinAdjustedDistance)
+					  & (x*p[3][0] + y*p[3][1] + z*p[3][2] + w*p[3][3] >= theMinAdjustedDistance);
+
+		for (k = 0; k < 4; k++)
+		{
+			theCellIndex = theBlock->itsCellIndices[k];
+
 			if
 			(
-				//	Accept all cells if the space is spherical,
-				//	for the reason explained in the comment accompanying
-				//	"sin(aDirichletDomainRadius)" above.
-				aSpaceType == SpaceSpherical
-			 ||
+				//	Skip padding and cells hidden by TruncateHoneycomb().
+				theCellIndex < aHoneycomb->itsNumCells
+			 &&
 				(
-					theCellCenterInCameraSpace.v[2] > - theAdjustedDirichletDomainRadius
-				 &&
-					theHoneycell->itsDistanceCameraToCellCenter < theTilingRadius
-				 &&
-					BoundingSphereIntersectsViewFrustum(theCellCenterInCameraSpace.v,
-														theAdjustedDirichletDomainRadius,
-														theCullingHyperplanes)
+					//	Accept all cells if the space is spherical,
+					//	for the reason explained in AdjustedDirichletDomainRadius().
+					someParameters->itsSpaceType == SpaceSpherical
+				 ||
+					theVisibility[k]
 				)
 			)
 			{
-				aHoneycomb->itsVisibleCells[aHoneycomb->itsNumVisibleCells] = theHoneycell;
+				aHoneycomb->itsSortEntries[aHoneycomb->itsNumVisibleCells].itsKey		= SortableFloatBits(theKeys[k]);
+				aHoneycomb->itsSortEntries[aHoneycomb->itsNumVisibleCells].itsCellIndex	= theCellIndex;
 				aHoneycomb->itsNumVisibleCells++;
 				
-				if (theHoneycell->itsMatrix.itsParity == aViewMatrix->itsParity)
+				if (aHoneycomb->itsCells[theCellIndex].itsMatrix.itsParity == someParameters->itsViewParity)
 					aHoneycomb->itsNumVisiblePlainCells++;
 				else
 					aHoneycomb->itsNumVisibleReflectedCells++;
 			}
-			
-			theHoneycell++;
 		}
+	}
+}
 
-		//	Sort the visible cells in increasing distance
-		//	from the observer.  The cells should be roughly sorted
-		//	to begin with (because they are sorted in order of
-		//	increasing distance from the basepoint (0,0,0,1))
-		//	so it makes little difference whether we use qsort()
-		//	or a bubble sort.  The important thing is that we're sorting
-		//	only the visible cells, not the whole honeycomb.
-		//
-		//		Note:  Profiling confirms that in practice
-		//		the time spent in qsort() is small compared
-		//		to the time spent in culling (above).
-		//
-		qsort(	aHoneycomb->itsVisibleCells,
-				aHoneycomb->itsNumVisibleCells,
-				sizeof(Honeycell *),
-				CompareCellCenterDistances);
+double AdjustedDirichletDomainRadius(
+	double		aDirichletDomainRadius,
+	SpaceType	aSpaceType)
+{
+	//	The frustum test in CullAndSortVisibleCells() and its GPU counterpart
+	//	compare distances to the culling planes against
+	//	sine/ø/sinh of aDirichletDomainRadius.
+	switch (aSpaceType)
+	{
+		case SpaceNone:
+			GEOMETRY_GAMES_ABORT("unexpected SpaceNone");
+			return 0.0;
+			
+		case SpaceSpherical:
+			//	This approach works poorly in the spherical case,
+			//	because sin(θ) starts decreasing as θ goes past π/2.
+			//	To avoid complicating an algorithm that works correctly
+			//	and is wonderfully efficient in the more demanding
+			//	Euclidean and hyperbolic cases, the caller will ignore
+			//	the adjusted Dirichlet domain radius in the spherical case
+			//	and simply accept all cells, knowing that performance
+			//	isn't an issue in the spherical case anyhow.
+			return sin(aDirichletDomainRadius);
+			
+		case SpaceFlat:
+			return aDirichletDomainRadius;
+			
+		case SpaceHyperbolic:
+			return sinh(aDirichletDomainRadius);
 	}
+	
+	return 0.0;	//	should never occur
 }
 
-static void MakeCullingHyperplanes(
-	double	anImageWidth,				//	input
-	double	anImageHeight,				//	input
-	double	someCullingPlanes[4][4])	//	output;  inward-pointing unit normal vectors to the hyperplanes
-										//		that pass through the side faces of view frustum
-										//		and through the origin (0,0,0,0)
+void MakeCullingHyperplanes(
+	double		anImageWidth,				//	input
+	double		anImageHeight,				//	input
+	double		anEyeSeparation,			//	input;  0.0 for a single view, STEREO_EYE_SEPARATION for a stereo pair
+	SpaceType	aSpaceType,					//	input;  used only when anEyeSeparation > 0.0
+	double		someCullingPlanes[4][4])	//	output;  inward-pointing unit normal vectors to the hyperplanes
+											//		that pass through the side faces of view frustum
+											//		and through the origin (0,0,0,0)
 {
-	double	w,
-			h,
-			c,
-			theInverseLengthWC,
-			theInverseLengthHC;
+	double			w,
+					h,
+					c,
+					theInverseLengthWC,
+					theInverseLengthHC,
+					theEyeOffset,
+					thePlane[4];
+	Matrix			theInverseEyePlacement;
+	unsigned int	i,
+					j,
+					k;
 
 	//	Note #1:  The frustum's side faces all pass through
 	//	the origin (0,0,0,1), so these normal vectors
@@ -2696,57 +4076,141 @@ static void MakeCullingHyperplanes(
 	someCullingPlanes[3][1] = +c * theInverseLengthHC;
 	someCullingPlanes[3][2] =  h * theInverseLengthHC;
 	someCullingPlanes[3][3] = 0.0;
+
+	//	For a stereo pair, cull to the union of the two eyes' frusta.
+	//	The eyes sit at (±anEyeSeparation/2, 0, 0, 1) and look
+	//	straight ahead, so the union is bounded on the right
+	//	by the right eye's right-hand face (plane 0), on the left
+	//	by the left eye's left-hand face (plane 1), and above and below
+	//	by the same planes as before, because a translation
+	//	along the x-axis takes each of those planes to itself.
+	//
+	//	If the hyperplane {p | p·n ≥ 0} bounds the cyclopean frustum,
+	//	then {p | p·T⁻¹·n ≥ 0} bounds the frustum of the eye
+	//	whose placement is T, and T⁻¹·n is still a unit normal vector,
+	//	so the culling tests still measure sin(d), d or sinh(d).
+	//	The widened planes no longer pass through (0,0,0,1),
+	//	so their w-components are no longer zero.
+	if (anEyeSeparation > 0.0)
+	{
+		for (i = 0; i < 2; i++)
+		{
+			theEyeOffset = (i == 0 ? +0.5 : -0.5) * anEyeSeparation;
+			MatrixTranslation(&theInverseEyePlacement, aSpaceType, -theEyeOffset, 0.0, 0.0);
+
+			for (j = 0; j < 4; j++)
+			{
+				thePlane[j] = 0.0;
+				for (k = 0; k < 4; k++)
+					thePlane[j] += theInverseEyePlacement.m[j][k] * someCullingPlanes[i][k];
+			}
+			for (j = 0; j < 4; j++)
+				someCullingPlanes[i][j] = thePlane[j];
+		}
+	}
 }
 
-static bool BoundingSphereIntersectsViewFrustum(
-	double	aCellCenterInCameraSpace[4],
-	double	anAdjustedDirichletDomainRadius,	//	= sin(r), r, or sinh(r), as appropriate for the geometry
-	double	someCullingPlanes[4][4])			//	inward-pointing unit normals to sides of view frustum
+
+static uint32_t SortKeyForDistance(
+	double		aDistance,
+	SpaceType	aSpaceType)
 {
-	unsigned int	i;
-	double			theAdjustedDistance;	//	distance from center of bounding sphere to culling plane
-	
-	for (i = 0; i < 4; i++)
+	//	Convert a distance to the same kind of key
+	//	that CullCellCenterBlocks() computes for each cell.
+	//	A distance too large to occur in the sort
+	//	gets a key larger than every cell's key.
+	switch (aSpaceType)
 	{
-		//	Taking the dot product of aCellCenterInCameraSpace
-		//	with a unit normal vector to a culling plane
-		//	gives sin(d), d, or sinh(d), according to the geometry.
-		//
-		//		Note:  someCullingPlanes[i][3] is always zero,
-		//		so don't need to know the sign of geometry-dependent component
-		//		of the inner product.  Very convenient!
-		//
-		theAdjustedDistance	= aCellCenterInCameraSpace[0] * someCullingPlanes[i][0]
-							+ aCellCenterInCameraSpace[1] * someCullingPlanes[i][1]
-							+ aCellCenterInCameraSpace[2] * someCullingPlanes[i][2]
-						//  ± aCellCenterInCameraSpace[3] * 0.0
-							;
-						
-		
-		if (theAdjustedDistance < - anAdjustedDirichletDomainRadius)
-			return false;
+		case SpaceSpherical:
+			if (aDistance >= 0.5 * PI)
+				return 0xFFFFFFFF;
+			return SortableFloatBits((float)( - cos(aDistance) ));
+
+		case SpaceFlat:
+			if (aDistance == HUGE_VAL)
+				return 0xFFFFFFFF;
+			return SortableFloatBits((float)( aDistance * aDistance ));
+
+		case SpaceHyperbolic:
+			if (aDistance == HUGE_VAL)
+				return 0xFFFFFFFF;
+			return SortableFloatBits((float) cosh(aDistance));
+
+		default:
+			return 0xFFFFFFFF;
 	}
-	
-	return true;
 }
 
+static uint32_t SortableFloatBits(
+	float	aValue)
+{
+	uint32_t	theBits;
+
+	//	Flip the sign bit of a non-negative float, and all the bits
+	//	of a negative float, so that unsigned integer comparison
+	//	of the results agrees with floating-point comparison
+	//	of the original values.
+	memcpy(&theBits, &aValue, sizeof(theBits));
+	if (theBits & 0x80000000)
+		return ~theBits;
+	else
+		return theBits | 0x80000000;
+}
 
-static __cdecl signed int CompareCellCenterDistances(
-	const void	*p1,
-	const void	*p2)
+static HoneycellSortEntry *RadixSortEntries(
+	HoneycellSortEntry	*someEntries,			//	input, and possibly output
+	HoneycellSortEntry	*someScratchEntries,	//	room for aNumEntries more entries
+	unsigned int		aNumEntries)
 {
-	double	theDifference;
+	unsigned int		theShift,
+						theCounts[256],
+						theTotal,
+						theCount,
+						i;
+	HoneycellSortEntry	*theSource,
+						*theDestination,
+						*theSwap;
+
+	//	Sort by one byte at a time, least significant byte first.
+	//	Each pass is stable, so the entries end up sorted by the full key.
+	//	Returns whichever buffer holds the sorted entries.
+
+	theSource		= someEntries;
+	theDestination	= someScratchEntries;
+
+	if (aNumEntries == 0)
+		return theSource;
+
+	for (theShift = 0; theShift < 32; theShift += 8)
+	{
+		for (i = 0; i < 256; i++)
+			theCounts[i] = 0;
+		for (i = 0; i < aNumEntries; i++)
+			theCounts[(theSource[i].itsKey >> theShift) & 0xFF]++;
+
+		//	Nearby cells often share the key's most significant byte,
+		//	in which case the pass would leave the order unchanged.
+		if (theCounts[(theSource[0].itsKey >> theShift) & 0xFF] == aNumEntries)
+			continue;
 
-	theDifference = (*((Honeycell **) p1))->itsDistanceCameraToCellCenter
-				  - (*((Honeycell **) p2))->itsDistanceCameraToCellCenter;
+		//	Convert the counts to starting positions.
+		theTotal = 0;
+		for (i = 0; i < 256; i++)
+		{
+			theCount		= theCounts[i];
+			theCounts[i]	= theTotal;
+			theTotal		+= theCount;
+		}
 
-	if (theDifference < 0.0)
-		return -1;
+		for (i = 0; i < aNumEntries; i++)
+			theDestination[theCounts[(theSource[i].itsKey >> theShift) & 0xFF]++] = theSource[i];
 
-	if (theDifference > 0.0)
-		return +1;
+		theSwap			= theSource;
+		theSource		= theDestination;
+		theDestination	= theSwap;
+	}
 
-	return 0;
+	return theSource;
 }
 
 
@@ -2763,6 +4227,12 @@ void SelectFirstCellOnly(
 	aHoneycomb->itsNumVisibleReflectedCells	= 0;
 	
 	aHoneycomb->itsVisibleCells[0] = &aHoneycomb->itsCells[0];
+
+	//	Let the one cell count as the nearest possible,
+	//	so it gets the finest level of detail.
+	aHoneycomb->itsSortEntries[0].itsKey		= 0;
+	aHoneycomb->itsSortEntries[0].itsCellIndex	= 0;
+	aHoneycomb->itsVisibleSortEntries			= aHoneycomb->itsSortEntries;
 }
 
 #endif	//	START_OUTSIDE
@@ -6,100 +6,353 @@
 //	the matrix entries are written using plain 7-bit ASCII only.
 //	If using UTF-8, allow but do not require a byte-order-mark.
 //
+//	Machine-generated groups may instead come in a compact binary format,
+//	which ConstructPendingSpace() recognizes by its magic number:
+//
+//		BINARY_GENERATOR_HEADER_SIZE bytes of header
+//			magic number			8 bytes, BINARY_GENERATOR_MAGIC
+//			format version			uint32_t, BINARY_GENERATOR_FORMAT_VERSION
+//			space type				uint32_t, a SpaceType
+//			number of matrices		uint32_t
+//			hyperbolic special case	uint32_t, a HyperbolicSpaceType
+//		parity bits					one bit per matrix, set for ImageNegative,
+//									least significant bit first,
+//									padded to a multiple of 8 bytes
+//		matrix entries				16 IEEE doubles per matrix, row by row
+//
+//	All numbers are little-endian.  A memory-mapped file may be handed
+//	directly to ConstructPendingSpace(), which reads the fixed layout
+//	with no text parsing.  ReadBinaryMatrices() still copies each entry
+//	into the MatrixList, swapping bytes if the host is big-endian,
+//	but that costs far less than strtod() would.
+//
 //	© 2021 by Jeff Weeks
 //	See TermsOfUse.txt
 
 #include "CurvedSpaces-Common.h"
-#if (defined(HIGH_RESOLUTION_SCREENSHOT) || defined(SHAPE_OF_SPACE_CH_15) || defined(SHAPE_OF_SPACE_CH_16))
-#include <math.h>
-#endif
+#include <math.h>	//	for fmin(), fmax(), floor(), log() and pow()
+#include <stdlib.h>	//	for strtod()
+#include <string.h>	//	for memcpy(), memcmp(), memset() and strlen()
 
 
 #define HYPERBOLIC_TILING_RADIUS_PADDING	1.0
 
+//	ConstructSpace() builds the Dirichlet domain from a modest tiling,
+//	and enlarges it only if the result isn't at least
+//	DIRICHLET_TILING_RADIUS_MARGIN smaller than twice the tiling radius.
+#define DIRICHLET_TILING_RADIUS_INITIAL		2.0
+#define DIRICHLET_TILING_RADIUS_MARGIN		0.05
+
+//	A progressive load shows at least PROGRESSIVE_FIRST_NUM_CELLS cells
+//	in its first installment, and extends the tiling
+//	in steps of PROGRESSIVE_RADIUS_STEP.
+#define PROGRESSIVE_FIRST_NUM_CELLS			500
+#define PROGRESSIVE_RADIUS_STEP				0.25
+
+//	Each step nearer or farther roughly halves or doubles
+//	the number of cells within the horizon:  a flat space's
+//	cell count grows as the cube of the radius, a hyperbolic
+//	space's as exp(2 × radius).  The user may take at most
+//	MAX_HORIZON_STEPS steps either way from the default horizon.
+#define HORIZON_STEP_FACTOR_FLAT			1.25
+#define HORIZON_STEP_HYPERBOLIC				0.35
+#define MAX_HORIZON_STEPS					3
+
+//	ReadMatrices() starts with room for INITIAL_MATRIX_CAPACITY matrices
+//	and doubles the room whenever it runs out.
+#define INITIAL_MATRIX_CAPACITY				16
+
+//	The binary generator format (see the top of this file)
+#define BINARY_GENERATOR_MAGIC				"CSGENBIN"
+#define BINARY_GENERATOR_MAGIC_SIZE			8
+#define BINARY_GENERATOR_FORMAT_VERSION		1
+#define BINARY_GENERATOR_HEADER_SIZE		24
+
+
+static bool			StringBeginsWith(const Byte *anInputText, const Byte *aPossibleBeginning);
+static ErrorText	ReadMatrices(const Byte *anInputText, MatrixList **aMatrixList);
+static bool			ReadOneNumber(const Byte *aString, double *aValue, const Byte **aStoppingPoint, ErrorText *anError);
+static ErrorText	ReadBinaryMatrices(const Byte *aBinaryData, size_t aBinarySize, MatrixList **aMatrixList, SpaceType *aSpaceType, HyperbolicSpaceType *aHyperbolicSpaceType);
+static size_t		BinaryParityBitsSize(unsigned int aNumMatrices);
+static uint32_t		ReadLittleEndianUInt32(const Byte *aLocation);
+static double		ReadLittleEndianDouble(const Byte *aLocation);
+static void			WriteLittleEndianUInt32(Byte *aLocation, uint32_t aValue);
+static void			WriteLittleEndianDouble(Byte *aLocation, double aValue);
+static double		HorizonRadius(SpaceType aSpaceType, HyperbolicSpaceType aHyperbolicSpaceType);
+static signed int	HorizonStep(SpaceType aSpaceType, double aDefaultHorizonRadius, double aHorizonRadius);
+static double		HorizonRadiusAtStep(SpaceType aSpaceType, double aDefaultHorizonRadius, signed int aStep);
+static PendingSpace	*AllocatePendingSpace(void);
+static ErrorText	ConstructSpace(PendingSpace *aSpace, MatrixList *aGeneratorList, bool aProgressiveFlag, const atomic_bool *aCancelFlag);
+static ErrorText	GrowPendingSpace(PendingSpace *aSpace, unsigned int aMinNumCells, const atomic_bool *aCancelFlag);
+static double		TilingRadiusPadding(SpaceType aSpaceType, DirichletDomain *aDirichletDomain);
+static void			InstallCompleteTiling(ModelData *md, PendingSpace *aPendingSpace);
+static ErrorText	DetectSpaceType(MatrixList *aGeneratorList, SpaceType *aSpaceType);
+
 
-//	A quick-and-dirty hack tiles the mirrored dodecahedron
-//	and the Seifert-Weber space (which have relatively large volumes)
-//	more deeply than the smaller-volume hyperbolic spaces.
-//	A more robust algorithm would examine the size
-//	of the fundamental domain.
-typedef enum
+ErrorText LoadGeneratorFile(
+	ModelData	*md,
+	const Byte	*anInputText)	//	zero-terminated, and hopefully UTF-8 or Latin-1
 {
-	HyperbolicSpaceGeneric,
-	HyperbolicSpaceMirroredDodecahedron,
-	HyperbolicSpaceSeifertWeber
-} HyperbolicSpaceType;
+	return LoadGeneratorFileUsingCache(md, anInputText, NULL, 0, NULL, NULL);
+}
 
+ErrorText LoadGeneratorFileUsingCache(
+	ModelData	*md,
+	const Byte	*anInputText,		//	zero-terminated, and hopefully UTF-8 or Latin-1
+	const Byte	*aCacheData,		//	input,  may be NULL; as written earlier via *aFreshCacheData
+	size_t		aCacheSize,			//	input
+	Byte		**aFreshCacheData,	//	output, may be NULL; caller must call FreeSpaceCache()
+	size_t		*aFreshCacheSize)	//	output, may be NULL
+{
+	ErrorText		theErrorMessage	= NULL;
+	PendingSpace	*theNewSpace	= NULL;
+
+	//	If the caller provides aCacheData from an earlier call
+	//	with the same anInputText, we'll read the Dirichlet domain
+	//	and the honeycomb from the cache instead of re-computing them.
+	//	Otherwise, if the caller provides a non-NULL aFreshCacheData,
+	//	we'll return a fresh cache for the caller to save.
+	//	*aFreshCacheData stays NULL whenever the existing cache was good.
+	//	In all cases the caller owns the cache data.
+	//
+	//	This is the synchronous version.  A caller that doesn't want
+	//	to block while the space gets built may call ConstructPendingSpace()
+	//	on a background thread, and then InstallPendingSpace()
+	//	with the ModelData locked.
+
+	theErrorMessage = ConstructPendingSpace(anInputText,
+											strlen((const char *) anInputText),
+											aCacheData,
+											aCacheSize,
+											aFreshCacheData != NULL && aFreshCacheSize != NULL,
+											false,
+											NULL,
+											&theNewSpace);
+	if (theErrorMessage != NULL)
+		goto CleanUpLoadGeneratorFile;
 
-static bool			StringBeginsWith(Byte *anInputText, Byte *aPossibleBeginning);
-static void			RemoveComments(Byte *anInputText);
-static ErrorText	ReadMatrices(Byte *anInputText, MatrixList **aMatrixList);
-static bool			ReadOneNumber(Byte *aString, double *aValue, Byte **aStoppingPoint, ErrorText *anError);
-static ErrorText	LoadGenerators(ModelData *md, MatrixList *aGeneratorList, HyperbolicSpaceType aHyperbolicSpaceType);
-static ErrorText	DetectSpaceType(MatrixList *aGeneratorList, SpaceType *aSpaceType);
+	InstallPendingSpace(md, theNewSpace);
 
+	if (aFreshCacheData != NULL && aFreshCacheSize != NULL)
+	{
+		*aFreshCacheData	= theNewSpace->itsFreshCacheData;
+		*aFreshCacheSize	= theNewSpace->itsFreshCacheSize;
+		theNewSpace->itsFreshCacheData	= NULL;
+		theNewSpace->itsFreshCacheSize	= 0;
+	}
 
-ErrorText LoadGeneratorFile(
-	ModelData	*md,
-	Byte		*anInputText)	//	zero-terminated, and hopefully UTF-8 or Latin-1
+CleanUpLoadGeneratorFile:
+
+	FreePendingSpace(&theNewSpace);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ConstructPendingSpace(
+	const Byte			*anInput,				//	a binary generator file, or a text file that's
+												//		zero-terminated, and hopefully UTF-8 or Latin-1
+	size_t				anInputSize,			//	not counting any terminating zero
+	const Byte			*aCacheData,			//	may be NULL
+	size_t				aCacheSize,
+	bool				aFreshCacheRequest,		//	provide itsFreshCacheData if aCacheData is missing or stale?
+	bool				aProgressiveFlag,		//	build only the nearest cells now, the rest via ExtendPendingSpace()?
+	const atomic_bool	*aCancelFlag,			//	may be NULL; if set, construction stops early and fails
+	PendingSpace		**aPendingSpace)		//	output, to be freed with FreePendingSpace()
 {
 	ErrorText			theErrorMessage	= NULL;
-	HyperbolicSpaceType	theHyperbolicSpaceType;
+	uint64_t			theInputHash;
 	MatrixList			*theGenerators	= NULL;
+	PendingSpace		*theSpace		= NULL;
+	double				theStartTime;
 
-	//	Make sure we didn't get UTF-16 data by mistake.
-	if ((anInputText[0] == 0xFF && anInputText[1] == 0xFE)
-	 || (anInputText[0] == 0xFE && anInputText[1] == 0xFF))
+	//	ConstructPendingSpace() reads and writes no global state,
+	//	so the caller may run it on any thread.
+
+	if (*aPendingSpace != NULL)
+		return u"ConstructPendingSpace() received a non-NULL output location.";
+
+	theSpace = AllocatePendingSpace();
+	if (theSpace == NULL)
 	{
-		theErrorMessage = u"The matrix file is in UTF-16 format.  Please convert to UTF-8.";
-		goto CleanUpLoadGeneratorFile;
+		theErrorMessage = u"Couldn't get memory for the PendingSpace in ConstructPendingSpace().";
+		goto CleanUpConstructPendingSpace;
 	}
-	
-	//	If a UTF-8 byte-order-mark is present, skip over it.
-	if (anInputText[0] == 0xEF && anInputText[1] == 0xBB && anInputText[2] == 0xBF)
-		anInputText += 3;
+	theSpace->itsFreshCacheRequest = aFreshCacheRequest;
 
-	//	As special cases, check whether anInputText begins with
-	//
-	//		#	Mirrored Right-Angled Dodecahedron
-	//	or
-	//		#	Seifert-Weber Dodecahedral Space
-	//
-	if (StringBeginsWith(anInputText, (Byte *)"#	Mirrored Right-Angled Dodecahedron"))
-		theHyperbolicSpaceType = HyperbolicSpaceMirroredDodecahedron;
-	else
-	if (StringBeginsWith(anInputText, (Byte *)"#	Seifert-Weber Dodecahedral Space"))
-		theHyperbolicSpaceType = HyperbolicSpaceSeifertWeber;
+	if (GeneratorDataIsBinary(anInput, anInputSize))
+	{
+		theInputHash = SpaceCacheInputHash(anInput, anInputSize);
+
+		//	Read the matrices, the space type and the hyperbolic special case, if any.
+		theStartTime = BenchmarkClock();
+		theErrorMessage = ReadBinaryMatrices(	anInput,
+												anInputSize,
+												&theGenerators,
+												&theSpace->itsSpaceType,
+												&theSpace->itsHyperbolicSpaceType);
+		theSpace->itsStageSeconds[StageReadMatrices] += BenchmarkClock() - theStartTime;
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructPendingSpace;
+	}
 	else
-		theHyperbolicSpaceType = HyperbolicSpaceGeneric;
+	{
+		//	Make sure we didn't get UTF-16 data by mistake.
+		if (anInputSize >= 2
+		 && ((anInput[0] == 0xFF && anInput[1] == 0xFE)
+		  || (anInput[0] == 0xFE && anInput[1] == 0xFF)))
+		{
+			theErrorMessage = u"The matrix file is in UTF-16 format.  Please convert to UTF-8.";
+			goto CleanUpConstructPendingSpace;
+		}
+		
+		//	If a UTF-8 byte-order-mark is present, skip over it.
+		if (anInputSize >= 3 && anInput[0] == 0xEF && anInput[1] == 0xBB && anInput[2] == 0xBF)
+		{
+			anInput		+= 3;
+			anInputSize	-= 3;
+		}
 
-	//	Remove comments.
-	//	What remains should be plain 7-bit ASCII (common to both UTF-8 and Latin-1).
-	RemoveComments(anInputText);
+		//	As special cases, check whether anInput begins with
+		//
+		//		#	Mirrored Right-Angled Dodecahedron
+		//	or
+		//		#	Seifert-Weber Dodecahedral Space
+		//
+		if (StringBeginsWith(anInput, (const Byte *)"#	Mirrored Right-Angled Dodecahedron"))
+			theSpace->itsHyperbolicSpaceType = HyperbolicSpaceMirroredDodecahedron;
+		else
+		if (StringBeginsWith(anInput, (const Byte *)"#	Seifert-Weber Dodecahedral Space"))
+			theSpace->itsHyperbolicSpaceType = HyperbolicSpaceSeifertWeber;
+		else
+			theSpace->itsHyperbolicSpaceType = HyperbolicSpaceGeneric;
+
+		//	Hash the complete text, comments included,
+		//	because the comments may influence how deep we tile.
+		theInputHash = SpaceCacheInputHash(anInput, anInputSize);
+
+		//	Parse the input text into 4×4 matrices, skipping comments as we go.
+		//	What remains outside the comments should be plain 7-bit ASCII
+		//	(common to both UTF-8 and Latin-1).
+		theStartTime = BenchmarkClock();
+		theErrorMessage = ReadMatrices(anInput, &theGenerators);
+		theSpace->itsStageSeconds[StageReadMatrices] += BenchmarkClock() - theStartTime;
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructPendingSpace;
 
-	//	Parse the input text into 4×4 matrices.
-	theErrorMessage = ReadMatrices(anInputText, &theGenerators);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGeneratorFile;
-		
-	//	Load theGenerators.
-	theErrorMessage = LoadGenerators(md, theGenerators, theHyperbolicSpaceType);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGeneratorFile;
+		//	Detect the new geometry and make sure it's consistent.
+		theErrorMessage = DetectSpaceType(theGenerators, &theSpace->itsSpaceType);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructPendingSpace;
+	}
 
-CleanUpLoadGeneratorFile:
+	//	Decide how far to tile.
+	theSpace->itsFullHorizonRadius	= HorizonRadius(theSpace->itsSpaceType, theSpace->itsHyperbolicSpaceType);
+	theSpace->itsHorizonRadius		= theSpace->itsFullHorizonRadius;
+
+	//	Read the tiling, the Dirichlet domain and the honeycomb from the cache if possible,
+	//	otherwise construct them from scratch.  The cache key depends
+	//	on itsFullHorizonRadius, so we couldn't check the cache any sooner.
+	//	A cached space is always complete, so there's no need to load it progressively.
+	theSpace->itsCacheKey = SpaceCacheKey(theInputHash, theSpace->itsFullHorizonRadius);
+	if (ReadSpaceCache(theSpace, theSpace->itsCacheKey, theGenerators, aCacheData, aCacheSize) != NULL)
+	{
+		theErrorMessage = ConstructSpace(theSpace, theGenerators, aProgressiveFlag, aCancelFlag);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructPendingSpace;
+
+		//	Offer the caller a fresh cache.  Failure to create one
+		//	is no reason not to show the space, so ignore any error.
+		//	An incomplete space gets its fresh cache
+		//	from the last call to ExtendPendingSpace() instead.
+		if (aFreshCacheRequest && theSpace->itsCompleteFlag)
+			(void) WriteSpaceCache(	theSpace,
+									theSpace->itsCacheKey,
+									&theSpace->itsFreshCacheData,
+									&theSpace->itsFreshCacheSize);
+	}
+	else
+	{
+		theSpace->itsTilingRadiusPadding	= TilingRadiusPadding(theSpace->itsSpaceType, theSpace->itsDirichletDomain);
+		theSpace->itsCompleteFlag			= true;
+	}
+
+	//	Keep the generators, so BeginHorizonChange() may tile further later.
+	theSpace->itsGeneratorList	= theGenerators;
+	theGenerators				= NULL;
+
+CleanUpConstructPendingSpace:
 
 	FreeMatrixList(&theGenerators);
 
+	if (theErrorMessage != NULL)
+		FreePendingSpace(&theSpace);
+
+	*aPendingSpace = theSpace;
+
 	return theErrorMessage;
 }
 
+
+static PendingSpace *AllocatePendingSpace(void)
+{
+	PendingSpace	*theSpace;
+	unsigned int	i;
+
+	theSpace = (PendingSpace *) GET_MEMORY(sizeof(PendingSpace));
+	if (theSpace == NULL)
+		return NULL;
+
+	theSpace->itsSpaceType					= SpaceNone;
+	theSpace->itsHyperbolicSpaceType		= HyperbolicSpaceGeneric;
+	theSpace->itsHorizonRadius				= 0.0;
+	theSpace->itsFullHorizonRadius			= 0.0;
+	theSpace->itsDirichletDomain			= NULL;
+	theSpace->itsHoneycomb					= NULL;
+	theSpace->itsDrawBackHemisphere			= false;
+	theSpace->itsThreeSphereFlag			= false;
+	theSpace->itsCompleteFlag				= false;
+	theSpace->itsGeneratorList				= NULL;
+	theSpace->itsTiling						= NULL;
+	theSpace->itsTilingRadiusPadding		= 0.0;
+	theSpace->itsCayleyTable				= NULL;
+	theSpace->itsFreshCacheRequest			= false;
+	theSpace->itsCacheKey					= 0;
+	theSpace->itsDirichletDomainCacheData	= NULL;
+	theSpace->itsDirichletDomainCacheSize	= 0;
+	theSpace->itsFreshCacheData				= NULL;
+	theSpace->itsFreshCacheSize				= 0;
+	for (i = 0; i < NumConstructionStages; i++)
+		theSpace->itsStageSeconds[i]		= 0.0;
+
+	return theSpace;
+}
+
+
+void FreePendingSpace(
+	PendingSpace	**aPendingSpace)
+{
+	if (*aPendingSpace != NULL)
+	{
+		FreeDirichletDomain(&(*aPendingSpace)->itsDirichletDomain);
+		FreeHoneycomb(&(*aPendingSpace)->itsHoneycomb);
+		FreeTiling(&(*aPendingSpace)->itsTiling);
+		FreeCayleyTable(&(*aPendingSpace)->itsCayleyTable);
+		FreeMatrixList(&(*aPendingSpace)->itsGeneratorList);
+		FreeSpaceCache(&(*aPendingSpace)->itsDirichletDomainCacheData, &(*aPendingSpace)->itsDirichletDomainCacheSize);
+		FreeSpaceCache(&(*aPendingSpace)->itsFreshCacheData, &(*aPendingSpace)->itsFreshCacheSize);
+
+		FREE_MEMORY_SAFELY(*aPendingSpace);
+	}
+}
+
+
 static bool StringBeginsWith(
-	Byte	*anInputText,			//	zero-terminated, UTF-8 or Latin-1
-	Byte	*aPossibleBeginning)	//	zero-terminated, UTF-8 or Latin-1
+	const Byte	*anInputText,			//	zero-terminated, UTF-8 or Latin-1
+	const Byte	*aPossibleBeginning)	//	zero-terminated, UTF-8 or Latin-1
 {
-	Byte	*a,
-			*b;
+	const Byte	*a,
+				*b;
 	
 	a = anInputText;
 	b = aPossibleBeginning;
@@ -113,95 +366,84 @@ static bool StringBeginsWith(
 	return true;
 }
 
-static void RemoveComments(
-	Byte *anInputText)	//	Zero-terminated input string also serves for output.
-{
-	//	Remove comments in place.
-	//	A comment begins with a '#' character and runs to the end of the line,
-	//	which may be marked by '\r' or '\n' or both.
-	//	The input text must be zero-terminated.
-	//	Both UTF-8 and Latin-1 are acceptable.
-
-	Byte	*r,	//	read  location
-			*w;	//	write location
-
-	r = anInputText;
-	w = anInputText;
-
-	do
-	{
-		if (*r == '#')
-		{
-			do
-			{
-				r++;
-			} while (*r != '\r' && *r != '\n' && *r != 0);
-		}
-	} while ((*w++ = *r++) != 0);
-}
-
-
 static ErrorText ReadMatrices(
-	Byte			*anInputText,	//	zero-terminated comment-free input string
+	const Byte		*anInputText,	//	zero-terminated input string, possibly with comments
 	MatrixList		**aMatrixList)
 {
 	ErrorText		theErrorMessage		= NULL;
 	unsigned int	theNumNumbers		= 0,
-					theNumGenerators	= 0;
-	Byte			*theMarker			= NULL;
-	unsigned int	i,
+					theCapacity			= 0,
+					i,
 					j,
 					k;
+	const Byte		*theMarker			= NULL;
+	double			theNumber;
+	MatrixList		*theLargerList		= NULL;
 
 	//	Check the input parameters.
 	if (*aMatrixList != NULL)
 		return u"ReadMatrices() was passed a non-NULL output pointer.";
 
-	//	Count the number of numbers in anInputText.
-	theNumNumbers	= 0;
-	theMarker		= anInputText;
-	while (ReadOneNumber(theMarker, NULL, &theMarker, &theErrorMessage))
+	//	Allocate space for a modest number of matrices.
+	theCapacity = INITIAL_MATRIX_CAPACITY;
+	*aMatrixList = AllocateMatrixList(theCapacity);
+	if (*aMatrixList == NULL)
 	{
+		theErrorMessage = u"Couldn't allocate memory for matrix generators.";
+		goto CleanUpReadMatrices;
+	}
+
+	//	Read the string in a single pass, writing the numbers
+	//	directly into the matrices.  Whenever a matrix is complete,
+	//	compute its determinant to determine the parity.
+	theMarker = anInputText;
+	while (ReadOneNumber(theMarker, &theNumber, &theMarker, &theErrorMessage))
+	{
+		i = theNumNumbers / 16;
+		j = (theNumNumbers / 4) % 4;
+		k = theNumNumbers % 4;
+
+		//	If the list is full, move the matrices to a list twice as large.
+		if (i == theCapacity)
+		{
+			theLargerList = (theCapacity <= 0xFFFFFFFF / 2) ? AllocateMatrixList(2 * theCapacity) : NULL;
+			if (theLargerList == NULL)
+			{
+				theErrorMessage = u"Couldn't allocate memory for matrix generators.";
+				goto CleanUpReadMatrices;
+			}
+			memcpy(theLargerList->itsMatrices, (*aMatrixList)->itsMatrices, theCapacity * sizeof(Matrix));
+			FreeMatrixList(aMatrixList);
+			*aMatrixList	= theLargerList;
+			theLargerList	= NULL;
+			theCapacity		*= 2;
+		}
+
+		(*aMatrixList)->itsMatrices[i].m[j][k] = theNumber;
+
+		if (j == 3 && k == 3)
+		{
+			(*aMatrixList)->itsMatrices[i].itsParity =
+				(MatrixDeterminant(&(*aMatrixList)->itsMatrices[i]) > 0.0) ?
+				ImagePositive : ImageNegative;
+		}
+
 		theNumNumbers++;
 	}
 	if (theErrorMessage != NULL)
 		goto CleanUpReadMatrices;
 
 	//	If anInputText contains a set of 4×4 matrices,
-	//	the number of numbers should be a positive multiple of 16.
+	//	the number of numbers should be a multiple of 16.
 	if (theNumNumbers % 16 != 0)
 	{
 		theErrorMessage = u"A matrix generator file should contain a list of 4×4 matrices and nothing else.\nUnfortunately the number of entries in the present file is not a multiple of 16.";
 		goto CleanUpReadMatrices;
 	}
 
-	//	How many generators?
-	theNumGenerators = theNumNumbers / 16;
-
-	//	Allocate space for the matrices.
-	*aMatrixList = AllocateMatrixList(theNumGenerators);
-	if (*aMatrixList == NULL)
-	{
-		theErrorMessage = u"Couldn't allocate memory for matrix generators.";
-		goto CleanUpReadMatrices;
-	}
-
-	//	Reread the string, writing the numbers directly into the matrices,
-	//	and then compute the determinant to determine the parity.
-	theMarker = anInputText;
-	for (i = 0; i < theNumGenerators; i++)
-	{
-		for (j = 0; j < 4; j++)
-			for (k = 0; k < 4; k++)
-				if ( ! ReadOneNumber(theMarker, &(*aMatrixList)->itsMatrices[i].m[j][k], &theMarker, NULL) )
-				{
-					theErrorMessage = u"\"Impossible\" error in ReadMatrices().";
-					goto CleanUpReadMatrices;
-				}
-		(*aMatrixList)->itsMatrices[i].itsParity =
-			(MatrixDeterminant(&(*aMatrixList)->itsMatrices[i]) > 0.0) ?
-			ImagePositive : ImageNegative;
-	}
+	//	Report only the matrices we actually read.
+	//	FreeMatrixList() doesn't care about the unused room at the end.
+	(*aMatrixList)->itsNumMatrices = theNumNumbers / 16;
 
 CleanUpReadMatrices:
 
@@ -213,27 +455,42 @@ CleanUpReadMatrices:
 
 
 static bool ReadOneNumber(
-	Byte		*aString,			//	input, null-terminated string
+	const Byte	*aString,			//	input, null-terminated string
 	double		*aValue,			//	output, may be null
-	Byte		**aStoppingPoint,	//	output, may be null, *aStoppingPoint may equal aString
+	const Byte	**aStoppingPoint,	//	output, may be null, *aStoppingPoint may equal aString
 	ErrorText	*anError)			//	output, may be null
 {
-	char		*theStartingPoint	= NULL,
-				*theStoppingPoint	= NULL;
+	const char	*theStartingPoint	= NULL;
+	char		*theStoppingPoint	= NULL;
 	double		theNumber			= 0.0;
 
-	theStartingPoint = (char *) aString;
+	theStartingPoint = (const char *) aString;
 
 	//	The strtod() documentation defines whitespace as spaces and tabs only.
 	//	In practice strtod() also skips over newlines, but one hates
 	//	to rely on undocumented behavior, so skip over all whitespace
-	//	before calling strtod().
-	while (*theStartingPoint == ' '
-		|| *theStartingPoint == '\t'
-		|| *theStartingPoint == '\r'
-		|| *theStartingPoint == '\n')
+	//	before calling strtod().  Skip comments too.  A comment begins
+	//	with a '#' character and runs to the end of the line,
+	//	which may be marked by '\r' or '\n' or both.
+	while (true)
 	{
-		theStartingPoint++;
+		if (*theStartingPoint == ' '
+		 || *theStartingPoint == '\t'
+		 || *theStartingPoint == '\r'
+		 || *theStartingPoint == '\n')
+		{
+			theStartingPoint++;
+		}
+		else
+		if (*theStartingPoint == '#')
+		{
+			do
+			{
+				theStartingPoint++;
+			} while (*theStartingPoint != '\r' && *theStartingPoint != '\n' && *theStartingPoint != 0);
+		}
+		else
+			break;
 	}
 
 	//	Try to read a number.
@@ -247,86 +504,662 @@ static bool ReadOneNumber(
 	//	The practical (and safe) approach seems to be to check whether
 	//	theStoppingPoint differs from the theStartingPoint.
 
-	if (theStoppingPoint != theStartingPoint)	//	success
-	{
-		if (aValue != NULL)
-			*aValue = theNumber;
+	if (theStoppingPoint != theStartingPoint)	//	success
+	{
+		if (aValue != NULL)
+			*aValue = theNumber;
+
+		if (aStoppingPoint != NULL)
+			*aStoppingPoint = (const Byte *) theStoppingPoint;
+
+		if (anError != NULL)
+			*anError = NULL;
+
+		return true;
+	}
+	else										//	failure
+	{
+		if (aValue != NULL)
+			*aValue = 0.0;
+
+		if (aStoppingPoint != NULL)
+			*aStoppingPoint = aString;
+
+		//	The only valid reason not to get a number is reaching the end of the string.
+		if (anError != NULL)
+			*anError = (*theStoppingPoint != 0) ?
+				u"Matrix file contains text other than numbers." :	//	bad characters
+				NULL;												//	no error
+
+		return false;
+	}
+}
+
+
+bool GeneratorDataIsBinary(
+	const Byte	*anInput,
+	size_t		anInputSize)
+{
+	return anInputSize >= BINARY_GENERATOR_HEADER_SIZE
+		&& memcmp(anInput, BINARY_GENERATOR_MAGIC, BINARY_GENERATOR_MAGIC_SIZE) == 0;
+}
+
+
+static ErrorText ReadBinaryMatrices(
+	const Byte	*aBinaryData,	//	input, in the binary generator format
+	size_t		aBinarySize,	//	input
+	MatrixList			**aMatrixList,			//	output
+	SpaceType			*aSpaceType,			//	output
+	HyperbolicSpaceType	*aHyperbolicSpaceType)	//	output
+{
+	ErrorText		theErrorMessage		= NULL,
+					theCorruptMessage	= u"The binary matrix file is corrupt.";
+	uint32_t		theFormatVersion,
+					theSpaceType,
+					theNumMatrices,
+					theHyperbolicSpaceType;
+	const Byte		*theParityBits,
+					*theReadLocation;
+	SpaceType		theDetectedSpaceType;
+	unsigned int	i,
+					j,
+					k;
+
+	if (*aMatrixList != NULL)
+		return u"ReadBinaryMatrices() was passed a non-NULL output pointer.";
+
+	if ( ! GeneratorDataIsBinary(aBinaryData, aBinarySize) )
+		return theCorruptMessage;
+
+	theFormatVersion	= ReadLittleEndianUInt32(aBinaryData +  8);
+	theSpaceType		= ReadLittleEndianUInt32(aBinaryData + 12);
+	theNumMatrices		= ReadLittleEndianUInt32(aBinaryData + 16);
+	theHyperbolicSpaceType	= ReadLittleEndianUInt32(aBinaryData + 20);
+
+	if (theFormatVersion != BINARY_GENERATOR_FORMAT_VERSION)
+		return u"The binary matrix file was written in an unknown format version.";
+
+	if (theSpaceType != SpaceSpherical
+	 && theSpaceType != SpaceFlat
+	 && theSpaceType != SpaceHyperbolic)
+		return theCorruptMessage;
+
+	if (theHyperbolicSpaceType != HyperbolicSpaceGeneric
+	 && theHyperbolicSpaceType != HyperbolicSpaceMirroredDodecahedron
+	 && theHyperbolicSpaceType != HyperbolicSpaceSeifertWeber)
+		return theCorruptMessage;
+
+	if (theNumMatrices > aBinarySize / (16 * sizeof(double))	//	for safety
+	 || aBinarySize != BINARY_GENERATOR_HEADER_SIZE
+						+ BinaryParityBitsSize(theNumMatrices)
+						+ theNumMatrices * 16 * sizeof(double))
+		return theCorruptMessage;
+
+	*aMatrixList = AllocateMatrixList(theNumMatrices);
+	if (*aMatrixList == NULL)
+	{
+		theErrorMessage = u"Couldn't allocate memory for matrix generators.";
+		goto CleanUpReadBinaryMatrices;
+	}
+
+	//	The file records each matrix's parity, so there's no need
+	//	to compute determinants.
+	theParityBits	= aBinaryData + BINARY_GENERATOR_HEADER_SIZE;
+	theReadLocation	= theParityBits + BinaryParityBitsSize(theNumMatrices);
+	for (i = 0; i < theNumMatrices; i++)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			for (k = 0; k < 4; k++)
+			{
+				(*aMatrixList)->itsMatrices[i].m[j][k] = ReadLittleEndianDouble(theReadLocation);
+				theReadLocation += sizeof(double);
+			}
+		}
+		(*aMatrixList)->itsMatrices[i].itsParity =
+			(theParityBits[i / 8] & (1 << (i % 8))) ? ImageNegative : ImagePositive;
+	}
+
+	//	Trust the recorded space type only if the matrices agree with it.
+	theErrorMessage = DetectSpaceType(*aMatrixList, &theDetectedSpaceType);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadBinaryMatrices;
+	if (theDetectedSpaceType != (SpaceType) theSpaceType)
+	{
+		theErrorMessage = u"The binary matrix file's space type doesn't match its matrices.";
+		goto CleanUpReadBinaryMatrices;
+	}
+	*aSpaceType				= theDetectedSpaceType;
+	*aHyperbolicSpaceType	= (HyperbolicSpaceType) theHyperbolicSpaceType;
+
+CleanUpReadBinaryMatrices:
+
+	if (theErrorMessage != NULL)
+		FreeMatrixList(aMatrixList);
+
+	return theErrorMessage;
+}
+
+
+ErrorText WriteBinaryGenerators(
+	PendingSpace	*aSpace,		//	input
+	Byte			**aBinaryData,	//	output, to be freed with FREE_MEMORY
+	size_t			*aBinarySize)	//	output
+{
+	MatrixList		*theGeneratorList;
+	size_t			theParityBitsSize,
+					theBinarySize;
+	Byte			*theWriteLocation;
+	unsigned int	i,
+					j,
+					k;
+
+	if (*aBinaryData != NULL)
+		return u"WriteBinaryGenerators() was passed a non-NULL output pointer.";
+
+	//	The generators move into the ModelData along with a progressively
+	//	loaded space's last installment, so write aSpace before installing it.
+	theGeneratorList = aSpace->itsGeneratorList;
+	if (theGeneratorList == NULL)
+		return u"WriteBinaryGenerators() received a space with no generators.";
+
+	if (aSpace->itsSpaceType != SpaceSpherical
+	 && aSpace->itsSpaceType != SpaceFlat
+	 && aSpace->itsSpaceType != SpaceHyperbolic)
+		return u"WriteBinaryGenerators() received an invalid space type.";
+
+	theParityBitsSize	= BinaryParityBitsSize(theGeneratorList->itsNumMatrices);
+	theBinarySize		= BINARY_GENERATOR_HEADER_SIZE
+						+ theParityBitsSize
+						+ (size_t) theGeneratorList->itsNumMatrices * 16 * sizeof(double);
+
+	*aBinaryData = (Byte *) GET_MEMORY(theBinarySize);
+	if (*aBinaryData == NULL)
+		return u"Couldn't get memory for the binary matrix file.";
+
+	//	Header
+	memcpy(*aBinaryData, BINARY_GENERATOR_MAGIC, BINARY_GENERATOR_MAGIC_SIZE);
+	WriteLittleEndianUInt32(*aBinaryData +  8, BINARY_GENERATOR_FORMAT_VERSION);
+	WriteLittleEndianUInt32(*aBinaryData + 12, (uint32_t) aSpace->itsSpaceType);
+	WriteLittleEndianUInt32(*aBinaryData + 16, theGeneratorList->itsNumMatrices);
+	WriteLittleEndianUInt32(*aBinaryData + 20, (uint32_t) aSpace->itsHyperbolicSpaceType);
+
+	//	Parity bits
+	theWriteLocation = *aBinaryData + BINARY_GENERATOR_HEADER_SIZE;
+	memset(theWriteLocation, 0, theParityBitsSize);
+	for (i = 0; i < theGeneratorList->itsNumMatrices; i++)
+		if (theGeneratorList->itsMatrices[i].itsParity == ImageNegative)
+			theWriteLocation[i / 8] |= (Byte) (1 << (i % 8));
+	theWriteLocation += theParityBitsSize;
+
+	//	Matrix entries
+	for (i = 0; i < theGeneratorList->itsNumMatrices; i++)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			for (k = 0; k < 4; k++)
+			{
+				WriteLittleEndianDouble(theWriteLocation, theGeneratorList->itsMatrices[i].m[j][k]);
+				theWriteLocation += sizeof(double);
+			}
+		}
+	}
+
+	*aBinarySize = theBinarySize;
+
+	return NULL;
+}
+
+
+static size_t BinaryParityBitsSize(
+	unsigned int	aNumMatrices)
+{
+	//	One bit per matrix, rounded up to a multiple of 8 bytes,
+	//	so the doubles that follow stay 8-byte aligned.
+	return (((size_t) aNumMatrices + 63) / 64) * 8;
+}
+
+
+static uint32_t ReadLittleEndianUInt32(
+	const Byte	*aLocation)
+{
+	return	((uint32_t) aLocation[0]      )
+		  | ((uint32_t) aLocation[1] <<  8)
+		  | ((uint32_t) aLocation[2] << 16)
+		  | ((uint32_t) aLocation[3] << 24);
+}
+
+static double ReadLittleEndianDouble(
+	const Byte	*aLocation)
+{
+	uint64_t		theBits;
+	double			theValue;
+	unsigned int	i;
+
+	//	Assemble the bits byte by byte, so the code works
+	//	on a host of either byte order.  On a little-endian host
+	//	the compiler reduces the loop to a single load.
+	theBits = 0;
+	for (i = 8; i-- > 0; )
+		theBits = (theBits << 8) | aLocation[i];
+
+	memcpy(&theValue, &theBits, sizeof(theValue));
+
+	return theValue;
+}
+
+static void WriteLittleEndianUInt32(
+	Byte		*aLocation,
+	uint32_t	aValue)
+{
+	unsigned int	i;
+
+	for (i = 0; i < 4; i++)
+	{
+		aLocation[i] = (Byte) (aValue & 0xFF);
+		aValue >>= 8;
+	}
+}
+
+static void WriteLittleEndianDouble(
+	Byte	*aLocation,
+	double	aValue)
+{
+	uint64_t		theBits;
+	unsigned int	i;
+
+	memcpy(&theBits, &aValue, sizeof(theBits));
+
+	for (i = 0; i < 8; i++)
+	{
+		aLocation[i] = (Byte) (theBits & 0xFF);
+		theBits >>= 8;
+	}
+}
+
+void InstallPendingSpace(
+	ModelData		*md,
+	PendingSpace	*aPendingSpace)	//	input; its Dirichlet domain and honeycomb get moved into md
+{
+#if (defined(HIGH_RESOLUTION_SCREENSHOT) || defined(SHAPE_OF_SPACE_CH_15) || defined(SHAPE_OF_SPACE_CH_16))
+	Matrix		theRotation,
+				theTranslation;
+#endif
+
+	//	InstallPendingSpace() does no heavy computation,
+	//	so the caller may lock the ModelData while it runs
+	//	without stalling the animation.
+
+	//	Delete the previous Dirichlet domain and honeycomb,
+	//	and take ownership of the new ones.
+	FreeDirichletDomain(&md->itsDirichletDomain);
+	FreeHoneycomb(&md->itsHoneycomb);
+	md->itsSpaceType				= aPendingSpace->itsSpaceType;
+	md->itsHorizonRadius			= aPendingSpace->itsHorizonRadius;
+	md->itsDefaultHorizonRadius		= aPendingSpace->itsFullHorizonRadius;
+	md->itsRequestedHorizonRadius	= aPendingSpace->itsFullHorizonRadius;
+	md->itsDirichletDomain			= aPendingSpace->itsDirichletDomain;
+	md->itsHoneycomb				= aPendingSpace->itsHoneycomb;
+	md->itsDrawBackHemisphere		= aPendingSpace->itsDrawBackHemisphere;
+	md->itsThreeSphereFlag			= aPendingSpace->itsThreeSphereFlag;
+	aPendingSpace->itsDirichletDomain	= NULL;
+	aPendingSpace->itsHoneycomb			= NULL;
+
+	//	Discard the previous space's tiling, and take the new one
+	//	if the new space is already complete.
+	FreeTiling(&md->itsTiling);
+	FreeMatrixList(&md->itsGeneratorList);
+	InstallCompleteTiling(md, aPendingSpace);
+
+	//	Reset the user's placement and speed, and reset the centerpiece.
+	MatrixIdentity(&md->itsUserBodyPlacement);
+#ifdef START_OUTSIDE
+	md->itsUserSpeed = 2.0 * USER_SPEED_INCREMENT;
+#elif defined(PREPARE_FOR_SCREENSHOT)
+	md->itsUserSpeed = 0.0;
+#else
+	md->itsUserSpeed = 8.0 * USER_SPEED_INCREMENT;	//	slow forward motion (but not too slow!)
+#endif
+#ifdef CENTERPIECE_DISPLACEMENT
+	MatrixIdentity(&md->itsCenterpiecePlacement);
+#endif
+
+	//	The Dirichlet domain has changed, so let the platform-dependent code
+	//	know that it needs to re-create the meshes that it uses
+	//	to represent the walls and the vertex figures (if present),
+	//	and that the honeycomb has changed too.
+	md->itsDirichletWallsMeshNeedsRefresh	= true;
+	md->itsVertexFigureMeshNeedsReplacement	= true;
+	md->itsHoneycombBufferNeedsRefresh		= true;
+
+#ifdef CENTERPIECE_DISPLACEMENT
+	//	For ad hoc convenience in the Shape of Space lecture,
+	//	move the user back a bit, move the centerpiece forward a bit,
+	//	and set the speed to zero.
+	//	This will look good when the fundamental domain is a unit cube.
+	//
+	//	Technical note:  When the aperture is closed and 
+	//	only the central Dirichlet domain is drawn, it's crucial that 
+	//	we place the user at -1/2 + ε rather that at -1/2, so the user
+	//	doesn't land at +1/2 instead.  Also, we want to have at least
+	//	a near clipping distance's margin between the user and the back wall,
+	//	in case s/he turns around!
+	//
+	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.0, 0.0, -0.49);
+	MatrixTranslation(&md->itsCenterpiecePlacement, md->itsSpaceType, 0.0, 0.0, 0.25);
+	md->itsUserSpeed = 0.0;
+#endif
+#ifdef START_STILL
+	//	For ad hoc convenience in the Shape of Space lecture,
+	//	move the user back a bit and set the speed to zero.
+	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.0, 0.0, -0.49);
+	md->itsUserSpeed = 0.0;
+#endif
+#if (defined(HIGH_RESOLUTION_SCREENSHOT) || (SHAPE_OF_SPACE_CH_16 == 3))
+	//	Ad hoc placement for viewing dodecahedron
+	MatrixRotation(&theRotation, 0.0, SafeAcos(cos(PI/3)/sin(PI/5)), 0.0);
+#if (defined(HIGH_RESOLUTION_SCREENSHOT))
+	MatrixTranslation(&theTranslation, md->itsSpaceType, 0.0, 0.0, -0.125);
+#else
+	MatrixIdentity(&theTranslation);
+#endif
+	//	Ultimately theViewMatrix will be the inverse of itsUserBodyPlacement,
+	//	so we must multiply the factors here in a possibly unexpected order.
+	MatrixProduct(&theTranslation, &theRotation, &md->itsUserBodyPlacement);
+	md->itsUserSpeed = 0.0;
+#endif	//	HIGH_RESOLUTION_SCREENSHOT || SHAPE_OF_SPACE_CH_16
+#ifdef SHAPE_OF_SPACE_CH_15
+	Matrix	theInitialPlacementInMirroredDodecahedron =
+	{
+		{
+			{ 0.85065080835203999,  0.00000000000000000, -0.52573111211913359,  0.00000000000000055},
+			{ 0.00000000000000000,  1.00000000000000000,  0.00000000000000000,  0.00000000000000000},
+			{ 0.70261593828905788,  0.00000000000000000,  1.13685646918909544, -0.88662945376008673},
+			{-0.46612868876286961,  0.00000000000000000, -0.75421206154974574,  1.33645493312528485}
+		},
+		ImagePositive
+	};
+
+	md->itsUserBodyPlacement	= theInitialPlacementInMirroredDodecahedron;
+	md->itsUserSpeed			= 0.0;
+#endif
+#if (SHAPE_OF_SPACE_CH_16 == 6)
+	Matrix	theInitialPlacementInPDS =
+	{
+		{
+			{ 0.80640807679039528, -0.30789150884337557, -0.50487771385008196,  0.00270675578517899},
+			{ 0.24471800986291653,  0.95095974716323428, -0.18901291012249430,  0.00792305061178555},
+			{ 0.53714479936460013,  0.02928877281824072,  0.83968564844840987, -0.07446908145088317},
+			{ 0.03598018692993523, -0.00453275238554037,  0.06557915563892300,  0.99718817414266625}
+		},
+		ImagePositive
+	};
+
+	md->itsUserBodyPlacement	= theInitialPlacementInPDS;
+	md->itsUserSpeed			= 0.0;
+#endif
+#ifdef SHAPE_OF_SPACE_CH_7
+	//	Set z ~ -1.0 to ensure that the cube at the lower left is in "home position",
+	//	with a red right face, a yellow top face and a a blue near face.
+	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.5, 0.5, -0.804);
+	md->itsUserSpeed = 0.0;
+#endif
+
+	md->itsChangeCount++;
+}
+
+
+void InstallPendingHoneycomb(
+	ModelData		*md,
+	PendingSpace	*aPendingSpace)	//	input; its honeycomb gets moved into md
+{
+	//	Replace the already installed space's honeycomb
+	//	with the larger one that ExtendPendingSpace()
+	//	or FinishHorizonChange() just built.
+	//	The Dirichlet domain and the user's placement stay as they are,
+	//	so the user never notices the switch, except that
+	//	the horizon recedes a little further.
+
+	if (aPendingSpace->itsHoneycomb == NULL)
+		return;
+
+	FreeHoneycomb(&md->itsHoneycomb);
+	md->itsHoneycomb				= aPendingSpace->itsHoneycomb;
+	md->itsHorizonRadius			= aPendingSpace->itsHorizonRadius;
+	md->itsDrawBackHemisphere		= aPendingSpace->itsDrawBackHemisphere;
+	md->itsThreeSphereFlag			= aPendingSpace->itsThreeSphereFlag;
+	aPendingSpace->itsHoneycomb		= NULL;
+
+	InstallCompleteTiling(md, aPendingSpace);
+
+	md->itsHoneycombBufferNeedsRefresh = true;
+
+	md->itsChangeCount++;
+}
+
+
+static void InstallCompleteTiling(
+	ModelData		*md,
+	PendingSpace	*aPendingSpace)	//	input; its generators and tiling get moved into md
+{
+	//	Once the space is complete, give its generators and tiling
+	//	to the ModelData, for BeginHorizonChange()'s use.
+	//	While a progressive load is still under way,
+	//	the PendingSpace needs them itself.
+	if ( ! aPendingSpace->itsCompleteFlag )
+		return;
+
+	//	A horizon change borrows only the tiling,
+	//	so the ModelData keeps its own generators.
+	if (aPendingSpace->itsGeneratorList != NULL)
+	{
+		FreeMatrixList(&md->itsGeneratorList);
+		md->itsGeneratorList			= aPendingSpace->itsGeneratorList;
+		aPendingSpace->itsGeneratorList	= NULL;
+	}
+
+	FreeTiling(&md->itsTiling);
+	md->itsTiling					= aPendingSpace->itsTiling;
+	md->itsTilingRadiusPadding		= aPendingSpace->itsTilingRadiusPadding;
+	md->itsHoneycombTilingRadius	= aPendingSpace->itsFullHorizonRadius + aPendingSpace->itsTilingRadiusPadding;
+	aPendingSpace->itsTiling		= NULL;
+}
+
+
+ErrorText BeginHorizonChange(
+	ModelData		*md,
+	double			aHorizonRadius,
+	PendingSpace	**aPendingSpace)	//	output, or NULL if the change is already complete
+{
+	ErrorText		theErrorMessage	= NULL;
+	double			theTilingRadius;
+	PendingSpace	*theSpace		= NULL;
+
+	//	Let the horizon advance or recede without reloading the space.
+	//	Shrinking merely hides the more distant cells, which stay
+	//	in the honeycomb in case the horizon recedes again.
+	//	Growing beyond the honeycomb's reach resumes the tiling
+	//	from its outermost shell and builds a larger honeycomb.
+	//	Neither case touches the Dirichlet domain.
+	//
+	//	BeginHorizonChange() does no heavy computation,
+	//	so the caller may lock the ModelData while it runs.
+	//	If the honeycomb already reaches far enough, the change
+	//	takes effect immediately.  Otherwise BeginHorizonChange()
+	//	lends the tiling to a new PendingSpace, for FinishHorizonChange()
+	//	to extend on a background thread, while the current honeycomb
+	//	keeps animating.  InstallPendingHoneycomb() then installs
+	//	the larger honeycomb and returns the tiling.
+
+	if (*aPendingSpace != NULL)
+		return u"BeginHorizonChange() received a non-NULL output location.";
+
+	if (md->itsHoneycomb == NULL)
+		return u"BeginHorizonChange() found no honeycomb.";
+
+	if (md->itsGeneratorList == NULL)
+		return u"BeginHorizonChange() can't change the horizon until the space has finished loading.";
+
+	if (aHorizonRadius <= 0.0)
+		return u"BeginHorizonChange() received a non-positive horizon radius.";
+
+	theTilingRadius = aHorizonRadius + md->itsTilingRadiusPadding;
+
+	if (theTilingRadius <= md->itsHoneycombTilingRadius)
+	{
+		TruncateHoneycomb(md->itsHoneycomb, theTilingRadius);
+
+		md->itsHorizonRadius = aHorizonRadius;
+
+		md->itsHoneycombBufferNeedsRefresh = true;
+
+		md->itsChangeCount++;
+
+		return NULL;
+	}
+
+	theSpace = AllocatePendingSpace();
+	if (theSpace == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the PendingSpace in BeginHorizonChange().";
+		goto CleanUpBeginHorizonChange;
+	}
+	theSpace->itsSpaceType				= md->itsSpaceType;
+	theSpace->itsHorizonRadius			= md->itsHorizonRadius;
+	theSpace->itsFullHorizonRadius		= aHorizonRadius;
+	theSpace->itsDrawBackHemisphere		= md->itsDrawBackHemisphere;
+	theSpace->itsThreeSphereFlag		= md->itsThreeSphereFlag;
+	theSpace->itsTilingRadiusPadding	= md->itsTilingRadiusPadding;
+
+	//	Take the ModelData's tiling if it has one.  A space whose tiling
+	//	wasn't available when its cache got written, or whose previous
+	//	horizon change got abandoned, must tile afresh from the generators.
+	if (md->itsTiling != NULL)
+	{
+		theSpace->itsTiling	= md->itsTiling;
+		md->itsTiling		= NULL;
+	}
+	else
+	{
+		theErrorMessage = BeginTiling(md->itsGeneratorList, &theSpace->itsTiling);
+		if (theErrorMessage != NULL)
+			goto CleanUpBeginHorizonChange;
+	}
+
+	*aPendingSpace	= theSpace;
+	theSpace		= NULL;
+
+CleanUpBeginHorizonChange:
+
+	FreePendingSpace(&theSpace);
+
+	return theErrorMessage;
+}
+
+
+ErrorText FinishHorizonChange(
+	PendingSpace		*aPendingSpace,	//	as prepared by BeginHorizonChange()
+	const atomic_bool	*aCancelFlag)	//	may be NULL
+{
+	//	FinishHorizonChange() never touches the ModelData,
+	//	so the caller may run it on any thread.
+	//	Growing a hyperbolic space's honeycomb may take a while.
+
+	if (aPendingSpace->itsCompleteFlag
+	 || aPendingSpace->itsHoneycomb != NULL
+	 || aPendingSpace->itsTiling == NULL)
+		return u"FinishHorizonChange() received a PendingSpace that BeginHorizonChange() didn't prepare.";
+
+	return GrowPendingSpace(aPendingSpace, 0xFFFFFFFF, aCancelFlag);
+}
+
+
+bool HorizonStepIsPossible(
+	const ModelData	*md,
+	bool			aFartherFlag)
+{
+	signed int	theStep;
+
+	//	A spherical space's honeycomb already holds the whole group.
+	//	Any other space must have finished loading.
+	if (md->itsSpaceType == SpaceSpherical
+	 || md->itsGeneratorList == NULL
+	 || md->itsDefaultHorizonRadius <= 0.0)
+		return false;
+
+	theStep = HorizonStep(md->itsSpaceType, md->itsDefaultHorizonRadius, md->itsRequestedHorizonRadius)
+			+ (aFartherFlag ? +1 : -1);
+
+	return (theStep >= -MAX_HORIZON_STEPS && theStep <= +MAX_HORIZON_STEPS);
+}
+
 
-		if (aStoppingPoint != NULL)
-			*aStoppingPoint = (Byte *) theStoppingPoint;
+double StepRequestedHorizonRadius(
+	ModelData	*md,
+	bool		aFartherFlag)
+{
+	signed int	theStep;
 
-		if (anError != NULL)
-			*anError = NULL;
+	//	Step from the most recently requested horizon,
+	//	not the installed one, so that a second step
+	//	while the first is still being built goes further.
+	//	Returns the new itsRequestedHorizonRadius, for the caller
+	//	to pass to BeginHorizonChange().
 
-		return true;
-	}
-	else										//	failure
+	if (HorizonStepIsPossible(md, aFartherFlag))
 	{
-		if (aValue != NULL)
-			*aValue = 0.0;
+		theStep = HorizonStep(md->itsSpaceType, md->itsDefaultHorizonRadius, md->itsRequestedHorizonRadius)
+				+ (aFartherFlag ? +1 : -1);
+		md->itsRequestedHorizonRadius = HorizonRadiusAtStep(md->itsSpaceType, md->itsDefaultHorizonRadius, theStep);
+	}
 
-		if (aStoppingPoint != NULL)
-			*aStoppingPoint = aString;
+	return md->itsRequestedHorizonRadius;
+}
 
-		//	The only valid reason not to get a number is reaching the end of the string.
-		if (anError != NULL)
-			*anError = (*theStoppingPoint != 0) ?
-				u"Matrix file contains text other than numbers." :	//	bad characters
-				NULL;												//	no error
 
-		return false;
-	}
+static signed int HorizonStep(
+	SpaceType	aSpaceType,
+	double		aDefaultHorizonRadius,
+	double		aHorizonRadius)
+{
+	//	Round to the nearest step, to absorb any roundoff error.
+	if (aSpaceType == SpaceHyperbolic)
+		return (signed int) floor((aHorizonRadius - aDefaultHorizonRadius) / HORIZON_STEP_HYPERBOLIC + 0.5);
+	else
+		return (signed int) floor(log(aHorizonRadius / aDefaultHorizonRadius) / log(HORIZON_STEP_FACTOR_FLAT) + 0.5);
 }
 
 
-static ErrorText LoadGenerators(
-	ModelData			*md,
-	MatrixList			*aGeneratorList,
-	HyperbolicSpaceType	aHyperbolicSpaceType)
+static double HorizonRadiusAtStep(
+	SpaceType	aSpaceType,
+	double		aDefaultHorizonRadius,
+	signed int	aStep)
 {
-	ErrorText	theErrorMessage					= NULL;
-	double		theDirichletDomainOutradius;
-	MatrixList	*theProvisionalHolonomyGroup	= NULL,
-				*theFullHolonomyGroup			= NULL;
-#if (defined(HIGH_RESOLUTION_SCREENSHOT) || defined(SHAPE_OF_SPACE_CH_15) || defined(SHAPE_OF_SPACE_CH_16))
-	Matrix		theRotation,
-				theTranslation;
-#endif
+	if (aSpaceType == SpaceHyperbolic)
+		return aDefaultHorizonRadius + aStep * HORIZON_STEP_HYPERBOLIC;
+	else
+		return aDefaultHorizonRadius * pow(HORIZON_STEP_FACTOR_FLAT, aStep);
+}
 
-	//	Delete any pre-existing Dirichlet domain and honeycomb,
-	//	reset the user's placement and speed, and reset the centerpiece.
-	md->itsSpaceType = SpaceNone;
-	FreeDirichletDomain(&md->itsDirichletDomain);
-	FreeHoneycomb(&md->itsHoneycomb);
-	MatrixIdentity(&md->itsUserBodyPlacement);
-#ifdef START_OUTSIDE
-	md->itsUserSpeed = 2.0 * USER_SPEED_INCREMENT;
-#elif defined(PREPARE_FOR_SCREENSHOT)
-	md->itsUserSpeed = 0.0;
-#else
-	md->itsUserSpeed = 8.0 * USER_SPEED_INCREMENT;	//	slow forward motion (but not too slow!)
-#endif
-#ifdef CENTERPIECE_DISPLACEMENT
-	MatrixIdentity(&md->itsCenterpiecePlacement);
-#endif
 
-	//	Detect the new geometry and make sure it's consistent.
-	theErrorMessage = DetectSpaceType(aGeneratorList, &md->itsSpaceType);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-	
-	//	Set itsHorizonRadius according to the SpaceType.
+static double HorizonRadius(
+	SpaceType			aSpaceType,
+	HyperbolicSpaceType	aHyperbolicSpaceType)
+{
+	double	theHorizonRadius;
+
+	//	Set the horizon radius according to the SpaceType.
 	//
 	//	A more sophisticated approach would take into account
 	//	the translation distances of the generators (assuming
 	//	the generators have been efficiently chosen) to tile 
 	//	more/less deeply when the fundamental domain is likely 
 	//	to be large/small, but the present code doesn't do that.
-	switch (md->itsSpaceType)
+	switch (aSpaceType)
 	{
 		case SpaceSpherical:
 			//	Any value greater than π will suffice to tile all of S³.
-			md->itsHorizonRadius = 3.15;
+			theHorizonRadius = 3.15;
 			break;
 
 		case SpaceFlat:
@@ -361,7 +1194,7 @@ static ErrorText LoadGenerators(
 			//	The number of tiles grows cubicly with the radius,
 			//	so we can afford to tile deeper in the flat case
 			//	than in the hyperbolic case.
-			md->itsHorizonRadius = 11.0;
+			theHorizonRadius = 11.0;
 
 			break;
 
@@ -386,20 +1219,20 @@ static ErrorText LoadGenerators(
 			//
 			//		in the GPU vertex function.
 			//
-			md->itsHorizonRadius = 5.5;
+			theHorizonRadius = 5.5;
 
 #elif defined(MAKE_SCREENSHOTS)
 
 			//	See comment above about iid needing
 			//	to become a uint instead of a ushort
 			//	if we go to radius 6.5.
-			md->itsHorizonRadius = 5.5;
+			theHorizonRadius = 5.5;
 
 #elif defined(SHAPE_OF_SPACE_CH_15)
 
 			//	See comment below about iid needing
 			//	to become a uint instead of a ushort.
-			md->itsHorizonRadius = 6.5;
+			theHorizonRadius = 6.5;
 
 #elif defined(SHAPE_OF_SPACE_CH_16)
 
@@ -414,7 +1247,7 @@ static ErrorText LoadGenerators(
 			//
 			//		in the GPU vertex function.
 			//
-			md->itsHorizonRadius = 7.0;
+			theHorizonRadius = 7.0;
 
 #else	//	normal resolution
 
@@ -423,7 +1256,7 @@ static ErrorText LoadGenerators(
 				//	Tile deeper for larger spaces like the mirrored dodecahedron
 				//	or the Seifert-Weber space.  Setting
 				//
-				//		md->itsHorizonRadius = 6.0;  or 5.5 -- see Note immediately above
+				//		theHorizonRadius = 6.0;  or 5.5 -- see Note immediately above
 				//
 				//	looks best, but it's still a little slow
 				//	on integrated graphics from 2008
@@ -432,13 +1265,13 @@ static ErrorText LoadGenerators(
 				//	Maybe in a few more years I can use that radius.
 				//	For now be satisfied with a less impressive radius,
 				//	to keep a smooth 60 fps even on iOS devices.
-				md->itsHorizonRadius = 4.0;
+				theHorizonRadius = 4.0;
 			}
 			else
 			{
 				//	Tile less deep for other hyperbolic spaces,
 				//	typically the lowest-volume ones.
-				md->itsHorizonRadius = 3.0;
+				theHorizonRadius = 3.0;
 			}
 
 #endif	//	HIGH_RESOLUTION_SCREENSHOT or not
@@ -446,45 +1279,299 @@ static ErrorText LoadGenerators(
 			break;
 		
 		default:
-			md->itsHorizonRadius = 0.0;
+			theHorizonRadius = 0.0;
 			break;
 	}
 
-	if (md->itsSpaceType != SpaceHyperbolic)
-	{
-		//	We face a chicken-and-egg problem:
-		//	We need a holonomy group in order to construct a Dirichlet domain,
-		//	but we need to know the Dirichlet domain's radius
-		//	to ensure that the holonomy group tiles out
-		//	to the required radius but no further.
-		//	The solution is to create a provisional holonomy group,
-		//	use it to construct the Dirichlet domain,
-		//	and then replace the provisional holonomy group
-		//	with a slight larger permanent one.
+	return theHorizonRadius;
+}
+
 
-		//	Use the generators to construct the provisional holonomy group
-		//	out to the desired tiling radius, but with no allowance
-		//	for the radius of the Dirichlet domain.
+static ErrorText ConstructSpace(
+	PendingSpace		*aSpace,			//	itsSpaceType and itsFullHorizonRadius already set
+	MatrixList			*aGeneratorList,
+	bool				aProgressiveFlag,	//	build only the first installment?
+	const atomic_bool	*aCancelFlag)		//	may be NULL
+{
+	ErrorText	theErrorMessage				= NULL;
+	double		theMaxDirichletTilingRadius,
+				theDirichletTilingRadius,
+				theDirichletDomainOutradius;
+	MatrixList	*theProvisionalHolonomyGroup	= NULL;
+	double		theStartTime;
+
+	//	We face a chicken-and-egg problem:
+	//	We need a holonomy group in order to construct a Dirichlet domain,
+	//	but we need to know the Dirichlet domain's radius
+	//	to ensure that the holonomy group tiles out
+	//	to the required radius but no further.
+	//	The solution is to create a provisional holonomy group,
+	//	use it to construct the Dirichlet domain,
+	//	and then extend the provisional holonomy group
+	//	to a slightly larger permanent one.
+
+	//	Begin a tiling that we may extend as needed.
+	theStartTime = BenchmarkClock();
+	theErrorMessage = BeginTiling(aGeneratorList, &aSpace->itsTiling);
+	aSpace->itsStageSeconds[StageHolonomyGroup] += BenchmarkClock() - theStartTime;
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructSpace;
+
+	//	No group element more than twice the Dirichlet domain's outradius
+	//	from the origin can contribute a face to the Dirichlet domain.
+	//	So start with a small provisional holonomy group,
+	//	and enlarge it only if the resulting Dirichlet domain turns out
+	//	to be too big to be trustworthy.  This keeps the wait
+	//	for the first frame short even when the final tiling is deep.
+	//	In no case tile deeper than the old fixed provisional radius
+	//	(itsHorizonRadius, or for hyperbolic spaces the full tiling radius),
+	//	and at that radius accept whatever Dirichlet domain we get.
+	if (aSpace->itsSpaceType != SpaceHyperbolic)
+		theMaxDirichletTilingRadius = aSpace->itsFullHorizonRadius;
+	else
+		theMaxDirichletTilingRadius = aSpace->itsFullHorizonRadius + HYPERBOLIC_TILING_RADIUS_PADDING;
+	theDirichletTilingRadius = fmin(DIRICHLET_TILING_RADIUS_INITIAL, theMaxDirichletTilingRadius);
+	while (true)
+	{
+		//	Use the generators to construct the provisional holonomy group.
 		//	Assume the group is discrete and no element fixes the origin.
-		theErrorMessage = ConstructHolonomyGroup(
-							aGeneratorList,
-							md->itsHorizonRadius,
-							&theProvisionalHolonomyGroup);
+		theStartTime = BenchmarkClock();
+		theErrorMessage = ExtendTiling(aSpace->itsTiling, theDirichletTilingRadius, aCancelFlag);
+		if (theErrorMessage == NULL)
+			theErrorMessage = CopyTilingToHolonomyGroup(aSpace->itsTiling, &theProvisionalHolonomyGroup);
+		aSpace->itsStageSeconds[StageHolonomyGroup] += BenchmarkClock() - theStartTime;
 		if (theErrorMessage != NULL)
-			goto CleanUpLoadGenerators;
+			goto CleanUpConstructSpace;
 
 		//	Use the provisional holonomy group to construct a Dirichlet domain.
+		FreeDirichletDomain(&aSpace->itsDirichletDomain);
+		theStartTime = BenchmarkClock();
 		theErrorMessage = ConstructDirichletDomain(
 							theProvisionalHolonomyGroup,
-							&md->itsDirichletDomain);
-		if (theErrorMessage != NULL)
-			goto CleanUpLoadGenerators;
-		
-		//	Free theProvisionalHolonomyGroup before constructing theFullHolonomyGroup.
+							&aSpace->itsDirichletDomain);
+		aSpace->itsStageSeconds[StageDirichletDomain] += BenchmarkClock() - theStartTime;
 		FreeMatrixList(&theProvisionalHolonomyGroup);
 
-		//	Use the generators and the Dirichlet domain radius
-		//	to construct the full holonomy group, allowing for the fact
+		if (theDirichletTilingRadius >= theMaxDirichletTilingRadius)
+		{
+			if (theErrorMessage != NULL)
+				goto CleanUpConstructSpace;
+			break;
+		}
+
+		if (theErrorMessage == NULL && aSpace->itsDirichletDomain != NULL)
+		{
+			theDirichletDomainOutradius = DirichletDomainOutradius(aSpace->itsDirichletDomain);
+			if (2.0 * theDirichletDomainOutradius + DIRICHLET_TILING_RADIUS_MARGIN <= theDirichletTilingRadius)
+				break;	//	success!
+			theDirichletTilingRadius = fmax(2.0 * theDirichletTilingRadius,
+											2.0 * theDirichletDomainOutradius + DIRICHLET_TILING_RADIUS_MARGIN);
+		}
+		else
+		{
+			theErrorMessage = NULL;
+			theDirichletTilingRadius = 2.0 * theDirichletTilingRadius;
+		}
+		theDirichletTilingRadius = fmin(theDirichletTilingRadius, theMaxDirichletTilingRadius);
+	}
+
+	//	How far beyond the horizon must we tile?
+	aSpace->itsTilingRadiusPadding = TilingRadiusPadding(aSpace->itsSpaceType, aSpace->itsDirichletDomain);
+
+	//	A progressive space shows its nearest cells
+	//	while ExtendPendingSpace() adds the more distant ones.
+	//	Spherical spaces tile all of S³ right away, because the groups
+	//	are small, and because the Cayley table needs the full group.
+	if (aProgressiveFlag && aSpace->itsSpaceType != SpaceSpherical)
+	{
+		//	InstallPendingSpace() will take the Dirichlet domain
+		//	long before the space is complete, so if the caller
+		//	wants a fresh cache, save a copy of the Dirichlet domain now.
+		if (aSpace->itsFreshCacheRequest)
+		{
+			aSpace->itsDirichletDomainCacheSize = DirichletDomainCacheSize(aSpace->itsDirichletDomain);
+			if (aSpace->itsDirichletDomainCacheSize > 0)
+			{
+				aSpace->itsDirichletDomainCacheData = (Byte *) GET_MEMORY(aSpace->itsDirichletDomainCacheSize);
+				if (aSpace->itsDirichletDomainCacheData == NULL)
+				{
+					theErrorMessage = u"Couldn't get memory for the cached Dirichlet domain in ConstructSpace().";
+					goto CleanUpConstructSpace;
+				}
+				theErrorMessage = WriteDirichletDomainCache(aSpace->itsDirichletDomain,
+															aSpace->itsDirichletDomainCacheData,
+															aSpace->itsDirichletDomainCacheSize);
+				if (theErrorMessage != NULL)
+					goto CleanUpConstructSpace;
+			}
+		}
+
+		theErrorMessage = GrowPendingSpace(aSpace, PROGRESSIVE_FIRST_NUM_CELLS, aCancelFlag);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructSpace;
+	}
+	else
+	{
+		theErrorMessage = GrowPendingSpace(aSpace, 0xFFFFFFFF, aCancelFlag);
+		if (theErrorMessage != NULL)
+			goto CleanUpConstructSpace;
+	}
+
+CleanUpConstructSpace:
+
+	FreeMatrixList(&theProvisionalHolonomyGroup);
+
+	return theErrorMessage;
+}
+
+
+ErrorText ExtendPendingSpace(
+	PendingSpace		*aPendingSpace,
+	const atomic_bool	*aCancelFlag)	//	may be NULL
+{
+	ErrorText	theErrorMessage	= NULL;
+
+	//	Each call roughly doubles the number of cells,
+	//	so the total work stays proportional to the final honeycomb,
+	//	and the caller gets to install each intermediate honeycomb
+	//	before the next one is ready.
+
+	if (aPendingSpace->itsCompleteFlag)
+		return u"ExtendPendingSpace() received a complete space.";
+
+	if (aPendingSpace->itsHoneycomb != NULL)
+		return u"ExtendPendingSpace() expects the previous honeycomb to have been installed.";
+
+	theErrorMessage = GrowPendingSpace(	aPendingSpace,
+										2 * TilingNumTiles(aPendingSpace->itsTiling),
+										aCancelFlag);
+	if (theErrorMessage != NULL)
+		return theErrorMessage;
+
+	//	If the space is now complete, offer the caller a fresh cache.
+	//	Failure to create one is no reason not to show the space,
+	//	so ignore any error.
+	if (aPendingSpace->itsCompleteFlag && aPendingSpace->itsFreshCacheRequest)
+		(void) WriteSpaceCache(	aPendingSpace,
+								aPendingSpace->itsCacheKey,
+								&aPendingSpace->itsFreshCacheData,
+								&aPendingSpace->itsFreshCacheSize);
+
+	return NULL;
+}
+
+
+bool PendingSpaceIsComplete(
+	PendingSpace	*aPendingSpace)
+{
+	return aPendingSpace->itsCompleteFlag;
+}
+
+
+static ErrorText GrowPendingSpace(
+	PendingSpace		*aSpace,
+	unsigned int		aMinNumCells,	//	stop growing once the honeycomb has this many cells
+	const atomic_bool	*aCancelFlag)	//	may be NULL
+{
+	ErrorText	theErrorMessage		= NULL;
+	double		theFullTilingRadius,
+				theTilingRadius;
+	MatrixList	*theHolonomyGroup	= NULL;
+	double		theStartTime;
+
+	theFullTilingRadius = aSpace->itsFullHorizonRadius + aSpace->itsTilingRadiusPadding;
+
+	//	Extend the tiling in small steps until it's big enough.
+	//	The first chunk must also reach beyond the padding,
+	//	so that the visible horizon isn't trivially small.
+	theStartTime = BenchmarkClock();
+	theTilingRadius = TilingRadius(aSpace->itsTiling);
+	do
+	{
+		theTilingRadius = fmin(theTilingRadius + PROGRESSIVE_RADIUS_STEP, theFullTilingRadius);
+
+		theErrorMessage = ExtendTiling(aSpace->itsTiling, theTilingRadius, aCancelFlag);
+		if (theErrorMessage != NULL)
+			goto CleanUpGrowPendingSpace;
+
+	} while (theTilingRadius < theFullTilingRadius
+		  && (TilingNumTiles(aSpace->itsTiling) < aMinNumCells
+		   || theTilingRadius < aSpace->itsTilingRadiusPadding + PROGRESSIVE_RADIUS_STEP));
+
+	theErrorMessage = CopyTilingToHolonomyGroup(aSpace->itsTiling, &theHolonomyGroup);
+	if (theErrorMessage == NULL && aSpace->itsSpaceType == SpaceSpherical)
+	{
+		//	A spherical space's tiling covers all of S³,
+		//	so it contains the whole (finite) group.
+		//	Record how the generators act on it.
+		theErrorMessage = ConstructCayleyTable(aSpace->itsTiling, theHolonomyGroup, &aSpace->itsCayleyTable);
+	}
+	aSpace->itsStageSeconds[StageHolonomyGroup] += BenchmarkClock() - theStartTime;
+	if (theErrorMessage != NULL)
+		goto CleanUpGrowPendingSpace;
+
+	//	Let fog hide the not-yet-loaded shell:  the visible horizon
+	//	sits one padding's width inside the tiling radius.
+	if (theTilingRadius < theFullTilingRadius)
+		aSpace->itsHorizonRadius = theTilingRadius - aSpace->itsTilingRadiusPadding;
+	else
+		aSpace->itsHorizonRadius = aSpace->itsFullHorizonRadius;
+
+	//	In the case of a spherical space, we'll want to draw the back hemisphere
+	//	if and only if the holonomy group does not contain the antipodal matrix.
+	theErrorMessage = NeedsBackHemisphere(aSpace->itsCayleyTable, aSpace->itsSpaceType, &aSpace->itsDrawBackHemisphere);
+	if (theErrorMessage != NULL)
+		goto CleanUpGrowPendingSpace;
+
+	//	The space is a 3-sphere iff theHolonomyGroup
+	//	contains the identity matrix alone.
+	aSpace->itsThreeSphereFlag = (theHolonomyGroup->itsNumMatrices == 1);
+
+	//	Give the caller one last chance to cancel
+	//	before the honeycomb gets built.
+	if (aCancelFlag != NULL && atomic_load(aCancelFlag))
+	{
+		theErrorMessage = u"Space construction was cancelled.";
+		goto CleanUpGrowPendingSpace;
+	}
+
+	//	Use the holonomy group and the Dirichlet domain
+	//	to construct a honeycomb.  ConstructHoneycomb() accepts
+	//	a NULL Dirichlet domain, as happens here once
+	//	InstallPendingSpace() has taken ownership of it,
+	//	and always for a horizon change.
+	theStartTime = BenchmarkClock();
+	theErrorMessage = ConstructHoneycomb(	theHolonomyGroup,
+											aSpace->itsDirichletDomain,
+											aSpace->itsSpaceType,
+											&aSpace->itsHoneycomb);
+	aSpace->itsStageSeconds[StageHoneycomb] += BenchmarkClock() - theStartTime;
+	if (theErrorMessage != NULL)
+		goto CleanUpGrowPendingSpace;
+
+	//	Once the tiling reaches its full radius, the space is complete.
+	//	Keep the tiling anyhow, for BeginHorizonChange(),
+	//	except in the spherical case, where the Cayley table replaces it.
+	if (theTilingRadius >= theFullTilingRadius)
+		aSpace->itsCompleteFlag = true;
+	if (aSpace->itsSpaceType == SpaceSpherical)
+		FreeTiling(&aSpace->itsTiling);
+
+CleanUpGrowPendingSpace:
+
+	FreeMatrixList(&theHolonomyGroup);
+
+	return theErrorMessage;
+}
+
+
+static double TilingRadiusPadding(
+	SpaceType		aSpaceType,
+	DirichletDomain	*aDirichletDomain)
+{
+	if (aSpaceType != SpaceHyperbolic)
+	{
+		//	Extend the holonomy group, allowing for the fact
 		//	that a translate of the Dirichlet domain might overlap
 		//	the tiling sphere even if that translate's center
 		//	lies outside the tiling sphere.  More precisely,
@@ -499,25 +1586,16 @@ static ErrorText LoadGenerators(
 		//
 		//	units of the origin.
 		//
-		//	Assume the group is discrete and no element fixes the origin.
-		//
-		theDirichletDomainOutradius = DirichletDomainOutradius(md->itsDirichletDomain);
-		theErrorMessage = ConstructHolonomyGroup(
-							aGeneratorList,
-							md->itsHorizonRadius  +  2.0 * theDirichletDomainOutradius,
-							&theFullHolonomyGroup);
-		if (theErrorMessage != NULL)
-			goto CleanUpLoadGenerators;
+		return 2.0 * DirichletDomainOutradius(aDirichletDomain);
 	}
-	else	//	md->itsSpaceType == SpaceHyperbolic
+	else	//	aSpaceType == SpaceHyperbolic
 	{
 		//	The number of images in a hyperbolic tiling
 		//	grows exponentially fast as a function of the tiling radius.
 		//	For a space with a large fundamental domain
 		//	-- for example the mirrored dodecahedron, which
-		//	has outradius 1.22… -- asking ConstructHolonomyGroup()
-		//	to tile out an extra 2.44… units would make
-		//	the computation unacceptably slow,
+		//	has outradius 1.22… -- tiling out an extra 2.44… units
+		//	would make the computation unacceptably slow,
 		//	and on my iPod Touch it even causes iOS
 		//	to terminate the app for using too much memory.
 		//
@@ -529,140 +1607,8 @@ static ErrorText LoadGenerators(
 		//	because the scenery elements already very thin
 		//	at this distance in hyperbolic space.
 		//
-
-		//	Use the generators to construct the provisional holonomy group
-		//	out to the desired tiling radius, but with no allowance
-		//	for the radius of the Dirichlet domain.
-		//	Assume the group is discrete and no element fixes the origin.
-		theErrorMessage = ConstructHolonomyGroup(
-							aGeneratorList,
-							md->itsHorizonRadius + HYPERBOLIC_TILING_RADIUS_PADDING,
-							&theFullHolonomyGroup);
-		if (theErrorMessage != NULL)
-			goto CleanUpLoadGenerators;
-
-		//	Use the provisional holonomy group to construct a Dirichlet domain.
-		theErrorMessage = ConstructDirichletDomain(
-							theFullHolonomyGroup,
-							&md->itsDirichletDomain);
-		if (theErrorMessage != NULL)
-			goto CleanUpLoadGenerators;
-	}
-
-	//	In the case of a spherical space, we'll want to draw the back hemisphere
-	//	if and only if the holonomy group does not contain the antipodal matrix.
-	theErrorMessage = NeedsBackHemisphere(theFullHolonomyGroup, md->itsSpaceType, &md->itsDrawBackHemisphere);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-	
-	//	The space is a 3-sphere iff theHolonomyGroup 
-	//	contains the identity matrix alone.
-	md->itsThreeSphereFlag = (theFullHolonomyGroup->itsNumMatrices == 1);
-
-	//	Use the holonomy group and the Dirichlet domain
-	//	to construct a honeycomb.
-	theErrorMessage = ConstructHoneycomb(	theFullHolonomyGroup,
-											md->itsDirichletDomain,
-											&md->itsHoneycomb);
-	if (theErrorMessage != NULL)
-		goto CleanUpLoadGenerators;
-	
-	//	Free theFullHolonomyGroup.
-	FreeMatrixList(&theFullHolonomyGroup);
-
-	//	The Dirichlet domain has changed, so let the platform-dependent code
-	//	know that it needs to re-create the meshes that it uses
-	//	to represent the walls and the vertex figures (if present).
-	md->itsDirichletWallsMeshNeedsRefresh	= true;
-	md->itsVertexFigureMeshNeedsReplacement	= true;
-
-#ifdef CENTERPIECE_DISPLACEMENT
-	//	For ad hoc convenience in the Shape of Space lecture,
-	//	move the user back a bit, move the centerpiece forward a bit,
-	//	and set the speed to zero.
-	//	This will look good when the fundamental domain is a unit cube.
-	//
-	//	Technical note:  When the aperture is closed and 
-	//	only the central Dirichlet domain is drawn, it's crucial that 
-	//	we place the user at -1/2 + ε rather that at -1/2, so the user
-	//	doesn't land at +1/2 instead.  Also, we want to have at least
-	//	a near clipping distance's margin between the user and the back wall,
-	//	in case s/he turns around!
-	//
-	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.0, 0.0, -0.49);
-	MatrixTranslation(&md->itsCenterpiecePlacement, md->itsSpaceType, 0.0, 0.0, 0.25);
-	md->itsUserSpeed = 0.0;
-#endif
-#ifdef START_STILL
-	//	For ad hoc convenience in the Shape of Space lecture,
-	//	move the user back a bit and set the speed to zero.
-	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.0, 0.0, -0.49);
-	md->itsUserSpeed = 0.0;
-#endif
-#if (defined(HIGH_RESOLUTION_SCREENSHOT) || (SHAPE_OF_SPACE_CH_16 == 3))
-	//	Ad hoc placement for viewing dodecahedron
-	MatrixRotation(&theRotation, 0.0, SafeAcos(cos(PI/3)/sin(PI/5)), 0.0);
-#if (defined(HIGH_RESOLUTION_SCREENSHOT))
-	MatrixTranslation(&theTranslation, md->itsSpaceType, 0.0, 0.0, -0.125);
-#else
-	MatrixIdentity(&theTranslation);
-#endif
-	//	Ultimately theViewMatrix will be the inverse of itsUserBodyPlacement,
-	//	so we must multiply the factors here in a possibly unexpected order.
-	MatrixProduct(&theTranslation, &theRotation, &md->itsUserBodyPlacement);
-	md->itsUserSpeed = 0.0;
-#endif	//	HIGH_RESOLUTION_SCREENSHOT || SHAPE_OF_SPACE_CH_16
-#ifdef SHAPE_OF_SPACE_CH_15
-	Matrix	theInitialPlacementInMirroredDodecahedron =
-	{
-		{
-			{ 0.85065080835203999,  0.00000000000000000, -0.52573111211913359,  0.00000000000000055},
-			{ 0.00000000000000000,  1.00000000000000000,  0.00000000000000000,  0.00000000000000000},
-			{ 0.70261593828905788,  0.00000000000000000,  1.13685646918909544, -0.88662945376008673},
-			{-0.46612868876286961,  0.00000000000000000, -0.75421206154974574,  1.33645493312528485}
-		},
-		ImagePositive
-	};
-
-	md->itsUserBodyPlacement	= theInitialPlacementInMirroredDodecahedron;
-	md->itsUserSpeed			= 0.0;
-#endif
-#if (SHAPE_OF_SPACE_CH_16 == 6)
-	Matrix	theInitialPlacementInPDS =
-	{
-		{
-			{ 0.80640807679039528, -0.30789150884337557, -0.50487771385008196,  0.00270675578517899},
-			{ 0.24471800986291653,  0.95095974716323428, -0.18901291012249430,  0.00792305061178555},
-			{ 0.53714479936460013,  0.02928877281824072,  0.83968564844840987, -0.07446908145088317},
-			{ 0.03598018692993523, -0.00453275238554037,  0.06557915563892300,  0.99718817414266625}
-		},
-		ImagePositive
-	};
-
-	md->itsUserBodyPlacement	= theInitialPlacementInPDS;
-	md->itsUserSpeed			= 0.0;
-#endif
-#ifdef SHAPE_OF_SPACE_CH_7
-	//	Set z ~ -1.0 to ensure that the cube at the lower left is in "home position",
-	//	with a red right face, a yellow top face and a a blue near face.
-	MatrixTranslation(&md->itsUserBodyPlacement, md->itsSpaceType, 0.5, 0.5, -0.804);
-	md->itsUserSpeed = 0.0;
-#endif
-
-CleanUpLoadGenerators:
-
-	if (theErrorMessage != NULL)
-	{
-		FreeDirichletDomain(&md->itsDirichletDomain);
-		FreeHoneycomb(&md->itsHoneycomb);
+		return HYPERBOLIC_TILING_RADIUS_PADDING;
 	}
-
-	md->itsChangeCount++;
-
-	FreeMatrixList(&theProvisionalHolonomyGroup);
-	FreeMatrixList(&theFullHolonomyGroup);
-
-	return theErrorMessage;
 }
 
 
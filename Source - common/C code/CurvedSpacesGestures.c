@@ -55,7 +55,6 @@ void GesturePinch(
 	if (md->itsAperture > 1.0)
 		md->itsAperture = 1.0;
 
-	md->itsDirichletWallsMeshNeedsRefresh = true;
 	md->itsChangeCount++;
 }
 
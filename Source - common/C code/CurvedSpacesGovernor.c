@@ -0,0 +1,180 @@
+//	CurvedSpacesGovernor.c
+//
+//	Watch each on-screen frame's CPU and GPU times and,
+//	when the frames take too long, lower the image quality
+//	one step at a time until the frame rate keeps up
+//	with the display.  When the frames again finish well
+//	within the display's frame period, restore the quality,
+//	again one step at a time.
+//
+//	The governor is much quicker to lower the quality
+//	than to raise it, and it ignores the first few frames
+//	after each change, so the quality never oscillates
+//	between two levels.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesUtilities-Common.h"
+#include <math.h>	//	for fmax()
+
+
+//	Smooth the frame times with an exponential moving average,
+//	giving each new frame this much weight.
+#define GOVERNOR_SMOOTHING_WEIGHT	0.1
+
+//	Lower the quality once the smoothed load has stayed
+//	above GOVERNOR_MAX_LOAD for GOVERNOR_NUM_SLOW_FRAMES
+//	consecutive frames, and raise it once the smoothed load
+//	has stayed below GOVERNOR_MIN_LOAD for GOVERNOR_NUM_FAST_FRAMES
+//	consecutive frames.  The gap between the two loads must exceed
+//	the savings of any one step down the ladder, or the governor
+//	would step back up as soon as it had stepped down.
+#define GOVERNOR_MAX_LOAD			0.90
+#define GOVERNOR_MIN_LOAD			0.60
+#define GOVERNOR_NUM_SLOW_FRAMES	10
+#define GOVERNOR_NUM_FAST_FRAMES	120
+
+//	A change in quality takes a few frames to reach the GPU times,
+//	because several frames may be in flight at once.
+#define GOVERNOR_NUM_SETTLING_FRAMES	30
+
+
+//	Each step down the ladder gives up a little image quality
+//	for a little speed.  The steps alternate among the knobs,
+//	so no one knob bears all the loss.  A smaller render scale
+//	cuts the GPU's fragment work, a smaller horizon cuts both
+//	the CPU's culling and the GPU's vertex work, and a larger
+//	level-of-detail bias cuts the GPU's vertex work.
+static const QualitySettings	gQualityLadder[] =
+{
+	//	render scale	horizon fraction	level-of-detail bias
+	{	1.00,			1.00,				1.0	},	//	full quality
+	{	1.00,			1.00,				2.0	},
+	{	0.85,			1.00,				2.0	},
+	{	0.85,			0.85,				3.0	},
+	{	0.70,			0.85,				3.0	},
+	{	0.70,			0.70,				4.0	},
+	{	0.50,			0.70,				4.0	},
+	{	0.50,			0.55,				4.0	}
+};
+#define NUM_QUALITY_LEVELS	BUFFER_LENGTH(gQualityLadder)
+
+
+void ResetQualityGovernor(
+	QualityGovernor	*aGovernor)
+{
+	aGovernor->itsLevel				= 0;
+	aGovernor->itsSmoothedLoad		= 0.0;
+	aGovernor->itsNumSlowFrames		= 0;
+	aGovernor->itsNumFastFrames		= 0;
+	aGovernor->itsNumFramesToSettle	= GOVERNOR_NUM_SETTLING_FRAMES;
+}
+
+void UpdateQualityGovernor(
+	QualityGovernor	*aGovernor,
+	double			aCPUSeconds,		//	negative if unknown
+	double			aGPUSeconds,		//	negative if unknown
+	double			aTargetFramePeriod)	//	the display's frame period, in seconds
+{
+	double	theLoad;
+
+	//	Whichever processor takes longer limits the frame rate.
+	theLoad = fmax(aCPUSeconds, aGPUSeconds);
+	if (theLoad < 0.0 || aTargetFramePeriod <= 0.0)
+		return;
+	theLoad /= aTargetFramePeriod;
+
+	//	Ignore the frames that were already in flight
+	//	when the quality last changed, and then start
+	//	the moving average afresh.
+	if (aGovernor->itsNumFramesToSettle > 0)
+	{
+		aGovernor->itsNumFramesToSettle--;
+		aGovernor->itsSmoothedLoad = theLoad;
+		return;
+	}
+
+	aGovernor->itsSmoothedLoad += GOVERNOR_SMOOTHING_WEIGHT * (theLoad - aGovernor->itsSmoothedLoad);
+
+	if (aGovernor->itsSmoothedLoad > GOVERNOR_MAX_LOAD)
+	{
+		aGovernor->itsNumSlowFrames++;
+		aGovernor->itsNumFastFrames = 0;
+	}
+	else
+	if (aGovernor->itsSmoothedLoad < GOVERNOR_MIN_LOAD)
+	{
+		aGovernor->itsNumFastFrames++;
+		aGovernor->itsNumSlowFrames = 0;
+	}
+	else
+	{
+		aGovernor->itsNumSlowFrames = 0;
+		aGovernor->itsNumFastFrames = 0;
+	}
+
+	if (aGovernor->itsNumSlowFrames >= GOVERNOR_NUM_SLOW_FRAMES
+	 && aGovernor->itsLevel + 1 < NUM_QUALITY_LEVELS)
+	{
+		aGovernor->itsLevel++;
+	}
+	else
+	if (aGovernor->itsNumFastFrames >= GOVERNOR_NUM_FAST_FRAMES
+	 && aGovernor->itsLevel > 0)
+	{
+		aGovernor->itsLevel--;
+	}
+	else
+	{
+		return;
+	}
+
+	aGovernor->itsNumSlowFrames		= 0;
+	aGovernor->itsNumFastFrames		= 0;
+	aGovernor->itsNumFramesToSettle	= GOVERNOR_NUM_SETTLING_FRAMES;
+}
+
+void GetQualitySettings(
+	const QualityGovernor	*aGovernor,
+	QualitySettings			*someSettings)	//	output
+{
+	GEOMETRY_GAMES_ASSERT(
+		aGovernor->itsLevel < NUM_QUALITY_LEVELS,
+		"invalid quality level");
+
+	*someSettings = gQualityLadder[aGovernor->itsLevel];
+}
+
+void GetFullQualitySettings(
+	QualitySettings	*someSettings)	//	output
+{
+	*someSettings = gQualityLadder[0];
+}
+
+void SettleQualityGovernor(
+	QualityGovernor	*aGovernor)
+{
+	//	When the workload changes for some other reason,
+	//	for example when a larger honeycomb arrives,
+	//	the frames already measured no longer predict the next ones.
+	//	Keep the current level, but let the governor ignore
+	//	the frames in flight and then start its averages afresh.
+	aGovernor->itsNumSlowFrames		= 0;
+	aGovernor->itsNumFastFrames		= 0;
+	aGovernor->itsNumFramesToSettle	= GOVERNOR_NUM_SETTLING_FRAMES;
+}
+
+double EffectiveHorizonRadius(
+	const ModelData			*md,
+	const QualitySettings	*someSettings)
+{
+	//	A spherical space's honeycomb is the whole finite group,
+	//	every element of which is always visible, so a nearer horizon
+	//	would only thicken the fog without saving any work.
+	if (md->itsSpaceType == SpaceSpherical)
+		return md->itsHorizonRadius;
+
+	return someSettings->itsHorizonFraction * md->itsHorizonRadius;
+}
@@ -56,6 +56,121 @@
 #define SIN5	-ROOT_3_OVER_2
 
 
+static const struct
+{
+	double	pos[4],
+			tex[3],	//	(u,v,0) -- last component is unused for non-cubemap texture
+			col[4];	//	pre-multiplied (αR, αG, αB, α)
+}
+gGyroscopeVertices[2*6*3 + 2*(6+1)] =
+{
+	//	arrows, outer surface
+
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
+
+	//	arrows, inner surface
+
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
+	{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
+
+	//	top half of axle (red)
+	{{INNER_RADIUS*COS0, INNER_RADIUS*SIN0, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{INNER_RADIUS*COS1, INNER_RADIUS*SIN1, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{INNER_RADIUS*COS2, INNER_RADIUS*SIN2, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{INNER_RADIUS*COS3, INNER_RADIUS*SIN3, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{INNER_RADIUS*COS4, INNER_RADIUS*SIN4, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{INNER_RADIUS*COS5, INNER_RADIUS*SIN5, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
+	{{0.0,               0.0,              +INNER_HEIGHT, 1.0}, {      0.5,       1.0, 0.0}, COLOR_AXLE_BOTTOM},
+
+	//	bottom half of axle (white)
+	{{INNER_RADIUS*COS0, INNER_RADIUS*SIN0, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{INNER_RADIUS*COS1, INNER_RADIUS*SIN1, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{INNER_RADIUS*COS2, INNER_RADIUS*SIN2, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{INNER_RADIUS*COS3, INNER_RADIUS*SIN3, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{INNER_RADIUS*COS4, INNER_RADIUS*SIN4, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{INNER_RADIUS*COS5, INNER_RADIUS*SIN5, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
+	{{0.0,               0.0,              -INNER_HEIGHT, 1.0}, {      0.5,       1.0, 0.0}, COLOR_AXLE_TOP}
+};
+
+static const unsigned int	gGyroscopeFacets[2*6 + 2*6][3] =
+{
+	//	arrows, outer surface
+	{ 0,  1,  2},
+	{ 3,  4,  5},
+	{ 6,  7,  8},
+	{ 9, 10, 11},
+	{12, 13, 14},
+	{15, 16, 17},
+
+	//	arrows, inner surface
+	{18, 19, 20},
+	{21, 22, 23},
+	{24, 25, 26},
+	{27, 28, 29},
+	{30, 31, 32},
+	{33, 34, 35},
+
+	//	bottom half of axle (red)
+	{36, 37, 42},
+	{37, 38, 42},
+	{38, 39, 42},
+	{39, 40, 42},
+	{40, 41, 42},
+	{41, 36, 42},
+
+	//	top half of axle (white)
+	{44, 43, 49},
+	{45, 44, 49},
+	{46, 45, 49},
+	{47, 46, 49},
+	{48, 47, 49},
+	{43, 48, 49}
+};
+
+
 void MakeGyroscopeMesh(
 	unsigned int	*aNumMeshVertices,				//	output
 	double			(**someMeshVertexPositions)[4],	//	output
@@ -64,123 +179,7 @@ void MakeGyroscopeMesh(
 	unsigned int	*aNumMeshFacets,				//	output
 	unsigned int	(**someMeshFacets)[3])			//	output
 {
-	unsigned int	i,
-					j;
-
-	static const struct
-	{
-		double	pos[4],
-				tex[3],	//	(u,v,0) -- last component is unused for non-cubemap texture
-				col[4];	//	pre-multiplied (αR, αG, αB, α)
-	}
-	v[2*6*3 + 2*(6+1)] =
-	{
-		//	arrows, outer surface
-
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_OUTER},
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_OUTER},
-
-		//	arrows, inner surface
-
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS1, OUTER_RADIUS*SIN1,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS2, OUTER_RADIUS*SIN2,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS3, OUTER_RADIUS*SIN3,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS4, OUTER_RADIUS*SIN4,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, +OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_B, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS0, OUTER_RADIUS*SIN0, -OUTER_HEIGHT, 1.0}, {TEX_ARROW_SIDE_A, 0.0, 0.0}, COLOR_ARROW_INNER},
-		{{OUTER_RADIUS*COS5, OUTER_RADIUS*SIN5,  0.0,          1.0}, {      0.5,        1.0, 0.0}, COLOR_ARROW_INNER},
-
-		//	top half of axle (red)
-		{{INNER_RADIUS*COS0, INNER_RADIUS*SIN0, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{INNER_RADIUS*COS1, INNER_RADIUS*SIN1, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{INNER_RADIUS*COS2, INNER_RADIUS*SIN2, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{INNER_RADIUS*COS3, INNER_RADIUS*SIN3, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{INNER_RADIUS*COS4, INNER_RADIUS*SIN4, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{INNER_RADIUS*COS5, INNER_RADIUS*SIN5, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_BOTTOM},
-		{{0.0,               0.0,              +INNER_HEIGHT, 1.0}, {      0.5,       1.0, 0.0}, COLOR_AXLE_BOTTOM},
-
-		//	bottom half of axle (white)
-		{{INNER_RADIUS*COS0, INNER_RADIUS*SIN0, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{INNER_RADIUS*COS1, INNER_RADIUS*SIN1, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{INNER_RADIUS*COS2, INNER_RADIUS*SIN2, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{INNER_RADIUS*COS3, INNER_RADIUS*SIN3, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{INNER_RADIUS*COS4, INNER_RADIUS*SIN4, 0.0,          1.0}, {TEX_AXLE_SIDE_A, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{INNER_RADIUS*COS5, INNER_RADIUS*SIN5, 0.0,          1.0}, {TEX_AXLE_SIDE_B, 0.0, 0.0}, COLOR_AXLE_TOP},
-		{{0.0,               0.0,              -INNER_HEIGHT, 1.0}, {      0.5,       1.0, 0.0}, COLOR_AXLE_TOP}
-	};
-
-	static const unsigned int	f[2*6 + 2*6][3] =
-	{
-		//	arrows, outer surface
-		{ 0,  1,  2},
-		{ 3,  4,  5},
-		{ 6,  7,  8},
-		{ 9, 10, 11},
-		{12, 13, 14},
-		{15, 16, 17},
-
-		//	arrows, inner surface
-		{18, 19, 20},
-		{21, 22, 23},
-		{24, 25, 26},
-		{27, 28, 29},
-		{30, 31, 32},
-		{33, 34, 35},
-
-		//	bottom half of axle (red)
-		{36, 37, 42},
-		{37, 38, 42},
-		{38, 39, 42},
-		{39, 40, 42},
-		{40, 41, 42},
-		{41, 36, 42},
-
-		//	top half of axle (white)
-		{44, 43, 49},
-		{45, 44, 49},
-		{46, 45, 49},
-		{47, 46, 49},
-		{48, 47, 49},
-		{43, 48, 49}
-	};
-
+	MeshBuffers	theMeshBuffers;
 
 	GEOMETRY_GAMES_ASSERT(
 			aNumMeshVertices		!= NULL
@@ -200,8 +199,7 @@ void MakeGyroscopeMesh(
 		"Output pointers must point to NULL arrays");
 
 	//	Set the number of vertices and facets.
-	*aNumMeshVertices	= BUFFER_LENGTH(v);
-	*aNumMeshFacets		= BUFFER_LENGTH(f);
+	CountGyroscopeMesh(aNumMeshVertices, aNumMeshFacets);
 
 	//	Allocate the output arrays.
 	//	The caller will take responsibility for calling FreeGyroscopeMesh()
@@ -211,24 +209,48 @@ void MakeGyroscopeMesh(
 	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
 	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
 
-	//	Copy the requested mesh data to the output arrays.
-	
-	for (i = 0; i < *aNumMeshVertices; i++)
+	//	Write the mesh into the output arrays.
+	SetMeshBuffersForArrays(&theMeshBuffers,
+							*someMeshVertexPositions,
+							*someMeshVertexTexCoords,
+							*someMeshVertexColors,
+							NULL,
+							NULL,
+							*someMeshFacets);
+	WriteGyroscopeMesh(&theMeshBuffers);
+}
+
+void CountGyroscopeMesh(
+	unsigned int	*aNumMeshVertices,	//	output
+	unsigned int	*aNumMeshFacets)	//	output
+{
+	*aNumMeshVertices	= BUFFER_LENGTH(gGyroscopeVertices);
+	*aNumMeshFacets		= BUFFER_LENGTH(gGyroscopeFacets);
+}
+
+void WriteGyroscopeMesh(
+	const MeshBuffers	*someMeshBuffers)	//	output;	room for CountGyroscopeMesh()'s vertices and facets
+{
+	unsigned int	i;
+
+	GEOMETRY_GAMES_ASSERT(
+		someMeshBuffers != NULL,
+		"Output pointer must not be NULL");
+
+	for (i = 0; i < BUFFER_LENGTH(gGyroscopeVertices); i++)
 	{
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexPositions)[i][j]	= v[i].pos[j];
-		
-		for (j = 0; j < 3; j++)
-			(*someMeshVertexTexCoords)[i][j]	= v[i].tex[j];
-
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexColors)[i][j]		= v[i].col[j];
+		WriteMeshVertex(someMeshBuffers, i,
+						gGyroscopeVertices[i].pos,
+						gGyroscopeVertices[i].tex,
+						gGyroscopeVertices[i].col);
 	}
 
-	for (i = 0; i < *aNumMeshFacets; i++)
+	for (i = 0; i < BUFFER_LENGTH(gGyroscopeFacets); i++)
 	{
-		for (j = 0; j < 3; j++)
-			(*someMeshFacets)[i][j]	= f[i][j];
+		WriteMeshFacet(	someMeshBuffers, i,
+						gGyroscopeFacets[i][0],
+						gGyroscopeFacets[i][1],
+						gGyroscopeFacets[i][2]);
 	}
 }
 
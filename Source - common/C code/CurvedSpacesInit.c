@@ -27,6 +27,8 @@ void SetUpModelData(ModelData *md)
 	md->itsDrawBackHemisphere	= false;
 	md->itsThreeSphereFlag		= false;
 	md->itsHorizonRadius		= 0.0;	//	LoadGenerators() will set the horizon radius.
+	md->itsDefaultHorizonRadius	= 0.0;
+	md->itsRequestedHorizonRadius	= 0.0;
 	MatrixIdentity(&md->itsUserBodyPlacement);
 	md->itsUserSpeed			= 0.0;	//	LoadGenerators() will set the speed.
 	md->itsPrePauseUserSpeed	= 0.0;
@@ -37,6 +39,10 @@ void SetUpModelData(ModelData *md)
 
 	md->itsDirichletDomain		= NULL;
 	md->itsHoneycomb			= NULL;
+	md->itsGeneratorList		= NULL;
+	md->itsTiling				= NULL;
+	md->itsTilingRadiusPadding	= 0.0;
+	md->itsHoneycombTilingRadius	= 0.0;
 
 #if defined(START_STILL)
 	md->itsAperture				= 0.00;
@@ -79,6 +85,7 @@ void SetUpModelData(ModelData *md)
 
 	md->itsDirichletWallsMeshNeedsRefresh	= true;	//	no mesh is present at launch
 	md->itsVertexFigureMeshNeedsReplacement	= true;	//	no mesh is present at launch
+	md->itsHoneycombBufferNeedsRefresh		= true;	//	no honeycomb is present at launch
 
 #if (SHAPE_OF_SPACE_CH_16 == 3)
 	md->itsRotationAngle		= 0.5 * PI;	//	Let the most visible Earth show something other than just the Pacific.
@@ -123,6 +130,7 @@ void SetUpModelData(ModelData *md)
 #else
 	md->itsFogFlag				= true;
 #endif
+	md->itsStereoFlag			= false;
 
 #ifdef START_OUTSIDE
 	md->itsViewpoint			= ViewpointExtrinsic;
@@ -142,4 +150,6 @@ void ShutDownModelData(ModelData *md)
 	//	Leave other information untouched.
 	FreeDirichletDomain(&md->itsDirichletDomain);
 	FreeHoneycomb(&md->itsHoneycomb);
+	FreeMatrixList(&md->itsGeneratorList);
+	FreeTiling(&md->itsTiling);
 }
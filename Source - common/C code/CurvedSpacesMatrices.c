@@ -6,10 +6,21 @@
 #include "CurvedSpaces-Common.h"
 #include "GeometryGamesUtilities-Common.h"
 #include <math.h>
+#include <string.h>	//	for memcpy()
 
 
-static void	RawMatrixSum(double a[4][4], double b[4][4], double sum[4][4]);
-static void	ConstantTimesRawMatrix(double c, double m[4][4], double cm[4][4]);
+//	MatrixProduct(), MatricesTimesMatrix(), VectorTimesMatrix()
+//	and MatrixEquality() work a whole row at a time, using simd_double4
+//	(which the compiler maps onto NEON or SSE/AVX registers).
+//	A Matrix's rows are only 8-byte aligned, while a simd_double4
+//	wants 32-byte alignment, so rows go in and out via memcpy(),
+//	which compiles to unaligned vector loads and stores.
+//	Pass simd_double4 values by address, not by value,
+//	to keep the calling convention the same with or without AVX.
+
+static inline void	RowTimesRows(const double aRow[4], const simd_double4 someRows[4], simd_double4 *aSum);
+static void			RawMatrixSum(double a[4][4], double b[4][4], double sum[4][4]);
+static void			ConstantTimesRawMatrix(double c, double m[4][4], double cm[4][4]);
 
 
 void MatrixIdentity(Matrix *aMatrix)
@@ -489,16 +500,31 @@ bool MatrixEquality(
 	Matrix	*aMatrixB,
 	double	anEpsilon)
 {
-	unsigned int	i,
-					j;
+	simd_double4	theRowA,
+					theRowB,
+					theDifference;
+	simd_long4		theExcess;
+	unsigned int	i;
 
 	if (aMatrixA->itsParity != aMatrixB->itsParity)
 		return false;
 
-	for (i = 0; i < 4; i++)
-		for (j = 0; j < 4; j++)
-			if (fabs(aMatrixA->m[i][j] - aMatrixB->m[i][j]) > anEpsilon)
-				return false;
+	//	Flag each entry whose difference exceeds anEpsilon in either direction.
+	//	Like the comparison fabs(a - b) > anEpsilon, this flags no NaNs.
+	//
+	//	Most calls come from the tiling's duplicate detection,
+	//	where most candidates differ from the stored tile,
+	//	so return as soon as some row differs.  Start with the last row,
+	//	the image of the origin, which tells distinct tiles apart soonest.
+	for (i = 4; i-- > 0; )
+	{
+		memcpy(&theRowA, aMatrixA->m[i], sizeof(theRowA));
+		memcpy(&theRowB, aMatrixB->m[i], sizeof(theRowB));
+		theDifference	= theRowA - theRowB;
+		theExcess		= (theDifference > anEpsilon) | (theDifference < -anEpsilon);
+		if ((theExcess[0] | theExcess[1] | theExcess[2] | theExcess[3]) != 0)
+			return false;
+	}
 
 	return true;
 }
@@ -509,29 +535,67 @@ void MatrixProduct(
 	const Matrix	*aMatrixB,
 	      Matrix	*aProduct)	//	output may coincide with one or both inputs
 {
-	Matrix			theProduct;
-	unsigned int	i,
-					j,
-					k;
+	MatricesTimesMatrix(1, aMatrixA, aMatrixB, aProduct);
+}
 
-	for (i = 0; i < 4; i++)
+
+void MatricesTimesMatrix(
+	unsigned int	aNumMatrices,	//	input
+	const Matrix	*someMatrices,	//	input
+	const Matrix	*aMatrix,		//	input
+	      Matrix	*someProducts)	//	output, which may coincide with someMatrices or aMatrix
+{
+	simd_double4	theRowsOfB[4],
+					theProductRows[4];
+	unsigned int	n,
+					i;
+
+	//	Compute someProducts[n] = someMatrices[n] * aMatrix for each n,
+	//	loading aMatrix's rows only once.  The tiling algorithm
+	//	uses this to multiply all the generators by a given tile at once.
+
+	memcpy(theRowsOfB, aMatrix->m, sizeof(theRowsOfB));
+
+	for (n = 0; n < aNumMatrices; n++)
 	{
-		for (j = 0; j < 4; j++)
-		{
-			theProduct.m[i][j] = 0.0;
+		//	Compute all four rows before storing any of them,
+		//	in case someProducts[n] coincides with someMatrices[n].
+		for (i = 0; i < 4; i++)
+			RowTimesRows(someMatrices[n].m[i], theRowsOfB, &theProductRows[i]);
 
-			for (k = 0; k < 4; k++)
-				theProduct.m[i][j] += aMatrixA->m[i][k] * aMatrixB->m[k][j];
-		}
+		memcpy(someProducts[n].m, theProductRows, sizeof(theProductRows));
+
+		someProducts[n].itsParity =
+			(someMatrices[n].itsParity == aMatrix->itsParity) ?
+			ImagePositive : ImageNegative;
 	}
+}
 
-	for (i = 0; i < 4; i++)
-		for (j = 0; j < 4; j++)
-			aProduct->m[i][j] = theProduct.m[i][j];
 
-	aProduct->itsParity =
-		(aMatrixA->itsParity == aMatrixB->itsParity) ?
-		ImagePositive : ImageNegative;
+static inline void RowTimesRows(
+	const double		aRow[4],		//	input
+	const simd_double4	someRows[4],	//	input
+	simd_double4		*aSum)			//	output
+{
+	simd_double4	theSum;
+
+	//	Compute aRow[0]*someRows[0] + ... + aRow[3]*someRows[3].
+	//
+	//	Accumulate the terms in the same order as the original
+	//	scalar loops did, starting from +0.0 and adding
+	//	one term per statement, so that each component rounds
+	//	exactly as it did before (and gets contracted
+	//	into fused multiply-adds, if at all, exactly as before).
+	//	Starting from +0.0 isn't redundant:  it turns
+	//	a product of -0.0 into +0.0 like the scalar code did,
+	//	so cached spaces stay byte-for-byte the same.
+	theSum  = (simd_double4){0.0, 0.0, 0.0, 0.0};
+	theSum += aRow[0] * someRows[0];
+	theSum += aRow[1] * someRows[1];
+	theSum += aRow[2] * someRows[2];
+	theSum += aRow[3] * someRows[3];
+
+	*aSum = theSum;
 }
 
 
@@ -758,20 +822,12 @@ void VectorTimesMatrix(
 	Matrix	*aMatrix,	//	input
 	Vector	*aProduct)	//	output, which may coincide with aVector
 {
-	Vector			theProduct;
-	unsigned int	i,
-					j;
-
-	for (i = 0; i < 4; i++)
-	{
-		theProduct.v[i] = 0.0;
-
-		for (j = 0; j < 4; j++)
-			theProduct.v[i] += aVector->v[j] * aMatrix->m[j][i];
-	}
+	simd_double4	theRows[4],
+					theProduct;
 
-	for (i = 0; i < 4; i++)
-		aProduct->v[i] = theProduct.v[i];
+	memcpy(theRows, aMatrix->m, sizeof(theRows));
+	RowTimesRows(aVector->v, theRows, &theProduct);
+	memcpy(aProduct->v, &theProduct, sizeof(theProduct));
 }
 
 
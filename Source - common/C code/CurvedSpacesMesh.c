@@ -0,0 +1,136 @@
+//	CurvedSpacesMesh.c
+//
+//	Write mesh vertices and facets wherever a MeshBuffers says.
+//	The two-phase mesh builders call these functions, so a caller
+//	may have them write straight into interleaved GPU memory,
+//	while the traditional MakeXxxMesh() functions use them
+//	to fill separate arrays of doubles.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesUtilities-Common.h"
+
+
+static void	WriteMeshAttribute(const MeshAttribute *anAttribute, unsigned int aVertexIndex, const double *someComponents, unsigned int aNumComponents);
+
+
+void SetMeshBuffersForArrays(
+	MeshBuffers		*someMeshBuffers,						//	output
+	double			(*someMeshVertexPositions)[4],			//	input
+	double			(*someMeshVertexTexCoords)[3],			//	input
+	double			(*someMeshVertexColors)[4],				//	input
+	double			(*someMeshVertexClosedPositions)[4],	//	input;	may be NULL
+	double			(*someMeshVertexClosedTexCoords)[2],	//	input;	may be NULL
+	unsigned int	(*someMeshFacets)[3])					//	input
+{
+	//	Describe a set of separate (non-interleaved) arrays of doubles,
+	//	as the traditional MakeXxxMesh() functions provide.
+
+	someMeshBuffers->itsPositions.itsBase			= (Byte *) someMeshVertexPositions;
+	someMeshBuffers->itsPositions.itsStride			= sizeof(double [4]);
+	someMeshBuffers->itsPositions.itsType			= MeshComponentDouble;
+
+	someMeshBuffers->itsTexCoords.itsBase			= (Byte *) someMeshVertexTexCoords;
+	someMeshBuffers->itsTexCoords.itsStride			= sizeof(double [3]);
+	someMeshBuffers->itsTexCoords.itsType			= MeshComponentDouble;
+
+	someMeshBuffers->itsColors.itsBase				= (Byte *) someMeshVertexColors;
+	someMeshBuffers->itsColors.itsStride			= sizeof(double [4]);
+	someMeshBuffers->itsColors.itsType				= MeshComponentDouble;
+
+	someMeshBuffers->itsClosedPositions.itsBase		= (Byte *) someMeshVertexClosedPositions;
+	someMeshBuffers->itsClosedPositions.itsStride	= sizeof(double [4]);
+	someMeshBuffers->itsClosedPositions.itsType		= MeshComponentDouble;
+
+	someMeshBuffers->itsClosedTexCoords.itsBase		= (Byte *) someMeshVertexClosedTexCoords;
+	someMeshBuffers->itsClosedTexCoords.itsStride	= sizeof(double [2]);
+	someMeshBuffers->itsClosedTexCoords.itsType		= MeshComponentDouble;
+
+	someMeshBuffers->itsFacets		= someMeshFacets;
+	someMeshBuffers->itsIndexType	= MeshIndexUInt32;
+}
+
+
+void WriteMeshVertex(
+	const MeshBuffers	*someMeshBuffers,
+	unsigned int		aVertexIndex,
+	const double		aPosition[4],
+	const double		aTexCoords[3],
+	const double		aColor[4])	//	pre-multiplied (αR, αG, αB, α)
+{
+	WriteMeshAttribute(&someMeshBuffers->itsPositions, aVertexIndex, aPosition,  4);
+	WriteMeshAttribute(&someMeshBuffers->itsTexCoords, aVertexIndex, aTexCoords, 3);
+	WriteMeshAttribute(&someMeshBuffers->itsColors,    aVertexIndex, aColor,     4);
+}
+
+void WriteMeshClosedVertex(
+	const MeshBuffers	*someMeshBuffers,
+	unsigned int		aVertexIndex,
+	const double		aClosedPosition[4],
+	const double		aClosedTexCoords[2])
+{
+	WriteMeshAttribute(&someMeshBuffers->itsClosedPositions, aVertexIndex, aClosedPosition,  4);
+	WriteMeshAttribute(&someMeshBuffers->itsClosedTexCoords, aVertexIndex, aClosedTexCoords, 2);
+}
+
+static void WriteMeshAttribute(
+	const MeshAttribute	*anAttribute,
+	unsigned int		aVertexIndex,
+	const double		*someComponents,
+	unsigned int		aNumComponents)
+{
+	Byte			*theDestination;
+	unsigned int	i;
+
+	if (anAttribute->itsBase == NULL)	//	caller doesn't want this attribute
+		return;
+
+	theDestination = anAttribute->itsBase + aVertexIndex * anAttribute->itsStride;
+
+	switch (anAttribute->itsType)
+	{
+		case MeshComponentDouble:
+			for (i = 0; i < aNumComponents; i++)
+				((double *) theDestination)[i] = someComponents[i];
+			break;
+
+		case MeshComponentFloat:
+			for (i = 0; i < aNumComponents; i++)
+				((float *) theDestination)[i] = (float) someComponents[i];
+			break;
+
+		case MeshComponentHalf:
+			for (i = 0; i < aNumComponents; i++)
+				((__fp16 *) theDestination)[i] = (__fp16) someComponents[i];
+			break;
+	}
+}
+
+
+void WriteMeshFacet(
+	const MeshBuffers	*someMeshBuffers,
+	unsigned int		aFacetIndex,
+	unsigned int		aVertexIndex0,
+	unsigned int		aVertexIndex1,
+	unsigned int		aVertexIndex2)
+{
+	switch (someMeshBuffers->itsIndexType)
+	{
+		case MeshIndexUInt16:
+			GEOMETRY_GAMES_ASSERT(
+				aVertexIndex0 <= 0xFFFF && aVertexIndex1 <= 0xFFFF && aVertexIndex2 <= 0xFFFF,
+				"Vertex index too large for a 16-bit index buffer");
+			((uint16_t (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][0] = (uint16_t) aVertexIndex0;
+			((uint16_t (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][1] = (uint16_t) aVertexIndex1;
+			((uint16_t (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][2] = (uint16_t) aVertexIndex2;
+			break;
+
+		case MeshIndexUInt32:
+			((unsigned int (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][0] = aVertexIndex0;
+			((unsigned int (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][1] = aVertexIndex1;
+			((unsigned int (*)[3]) someMeshBuffers->itsFacets)[aFacetIndex][2] = aVertexIndex2;
+			break;
+	}
+}
@@ -28,6 +28,10 @@ void MouseMoved(
 			dPhi;
 	Matrix	theIncrement;
 
+#ifndef CENTERPIECE_DISPLACEMENT
+	UNUSED_PARAMETER(aCenterpieceFlag);
+#endif
+
 	if (aMouseMotion.itsViewWidth  <= 0.0
 	 || aMouseMotion.itsViewHeight <= 0.0
 	 || aMouseMotion.itsViewWidth  != aMouseLocation.itsViewWidth
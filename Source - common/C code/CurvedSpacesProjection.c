@@ -5,7 +5,7 @@
 
 #include "CurvedSpaces-Common.h"
 #include "GeometryGamesUtilities-Common.h"
-#include <math.h>	//	for sqrt()
+#include <math.h>	//	for sqrt(), asin() and asinh()
 
 
 //	As explained in the comment accompanying the definition of DART_INNER_WIDTH,
@@ -15,6 +15,9 @@
 #define W_NEAR_CLIP			512.0
 
 
+static double	ProjectedViewSize(double aFrameWidth, double aFrameHeight);
+
+
 double CharacteristicViewSize(
 	double	aFrameWidth,	//	typically in pixels or points
 	double	aFrameHeight)	//	typically in pixels or points
@@ -48,6 +51,35 @@ double CharacteristicViewSize(
 	return 0.5 * (aFrameWidth >= aFrameHeight ? aFrameWidth : aFrameHeight);
 }
 
+static double ProjectedViewSize(
+	double	aFrameWidth,	//	typically in pixels or points
+	double	aFrameHeight)	//	typically in pixels or points
+{
+	double	c;
+
+	//	Start with the characteristic view size, and narrow
+	//	the field of view for those figures that want it.
+	//	MakeProjectionMatrix() and LevelOfDetailDistance()
+	//	must agree on this value.
+	c = CharacteristicViewSize(aFrameWidth, aFrameHeight);
+
+#ifdef SHAPE_OF_SPACE_CH_15
+	//	Use a narrower field of view for this figure,
+	//	but a touch wider than for Figure 16.3,
+	//	so that we can get a full large circle visible
+	//	while still including lots of deep images.
+	//	(With c *= 2.5, those deep images just pop out of view
+	//	when the circle becomes fully visible.)
+	c *= 2.3;
+#endif
+#if (SHAPE_OF_SPACE_CH_16 == 3)
+	//	Use a narrower field of view for this figure.
+	c *= 2.5;
+#endif
+
+	return c;
+}
+
 void MakeProjectionMatrix(
 	double				aFrameWidth,				//	input, typically in pixels or points
 	double				aFrameHeight,				//	input, typically in pixels or points
@@ -102,23 +134,9 @@ void MakeProjectionMatrix(
 	//	that subtends a 45° angle in the observer's field-of-view.
 	//	Note that it's measured in pixels or points, which is OK
 	//	because all we really care about are the ratios w/c and h/c.
-	c = CharacteristicViewSize(aFrameWidth, aFrameHeight);
+	c = ProjectedViewSize(aFrameWidth, aFrameHeight);
 	GEOMETRY_GAMES_ASSERT(c > 0.0, "nonpositive characteristic size");
 
-#ifdef SHAPE_OF_SPACE_CH_15
-	//	Use a narrower field of view for this figure,
-	//	but a touch wider than for Figure 16.3,
-	//	so that we can get a full large circle visible
-	//	while still including lots of deep images.
-	//	(With c *= 2.5, those deep images just pop out of view
-	//	when the circle becomes fully visible.)
-	c *= 2.3;
-#endif
-#if (SHAPE_OF_SPACE_CH_16 == 3)
-	//	Use a narrower field of view for this figure.
-	c *= 2.5;
-#endif
-
 	//	For this not-necessarily-square view, the rays through the points
 	//
 	//		(±ZNearClip*(w/c), ±ZNearClip*(h/c), ZNearClip, 1)
@@ -189,6 +207,7 @@ void MakeProjectionMatrix(
 			break;
 		
 		case SpaceNone:
+		default:
 			f = 0.0;
 			break;
 	}
@@ -383,3 +402,83 @@ void MakeProjectionMatrix(
 			break;
 	}
 }
+
+
+void MakeEyeViewMatrix(
+	Matrix		*aViewMatrix,		//	input;  the observer's (cyclopean) view matrix
+	SpaceType	aSpaceType,			//	input
+	double		anEyeOffset,		//	input;  the eye's displacement along the observer's right vector
+	Matrix		*anEyeViewMatrix)	//	output
+{
+	Matrix	theInverseEyePlacement;
+
+	//	The eye sits at (anEyeOffset, 0, 0, 1) in the observer's own frame,
+	//	looking straight ahead, so its placement in the world is
+	//	a translation followed by the observer's placement,
+	//	and its view matrix is the inverse of that product,
+	//	namely aViewMatrix followed by the inverse translation.
+	//	The two eyes' lines of sight are parallel,
+	//	so each eye uses the same projection matrix as the observer.
+	if (anEyeOffset == 0.0)
+	{
+		*anEyeViewMatrix = *aViewMatrix;
+	}
+	else
+	{
+		MatrixTranslation(&theInverseEyePlacement, aSpaceType, -anEyeOffset, 0.0, 0.0);
+		MatrixProduct(aViewMatrix, &theInverseEyePlacement, anEyeViewMatrix);
+	}
+}
+
+
+double LevelOfDetailDistance(
+	double		aMeshError,			//	input;  greatest distance from the mesh to the surface it approximates
+	double		aMaxScreenError,	//	input;  in pixels or points, same as aFrameWidth and aFrameHeight
+	double		aFrameWidth,		//	input;  typically in pixels or points
+	double		aFrameHeight,		//	input;  typically in pixels or points
+	SpaceType	aSpaceType)			//	input
+{
+	double	theMinFalloff;
+
+	//	Beyond what distance from the observer does a mesh
+	//	that strays up to aMeshError from its intended surface
+	//	look no worse than aMaxScreenError on the screen?
+	//
+	//	Near the center of the view, a short segment of length ε
+	//	at distance d from the observer subtends an angle
+	//
+	//		ε/sin(d),  ε/d,  or  ε/sinh(d)
+	//
+	//	according to the geometry, and projects to about c times
+	//	that many pixels, where c is the view size that subtends 45°.
+	//	So the mesh is good enough wherever
+	//
+	//		sin(d), d, or sinh(d)  ≥  c·ε / aMaxScreenError
+	//
+	//	In a spherical space sin(d) never exceeds 1, and nearly
+	//	antipodal images look just as big as nearby ones,
+	//	so the caller should measure each spherical distance
+	//	to the nearer of a cell center and its antipodal point,
+	//	which keeps d ≤ π/2 .
+	//
+	//	Return HUGE_VAL if no such distance exists.
+
+	theMinFalloff = ProjectedViewSize(aFrameWidth, aFrameHeight) * aMeshError / aMaxScreenError;
+
+	switch (aSpaceType)
+	{
+		case SpaceSpherical:
+			return (theMinFalloff < 1.0 ? asin(theMinFalloff) : HUGE_VAL);
+
+		case SpaceFlat:
+			return theMinFalloff;
+
+		case SpaceHyperbolic:
+			return asinh(theMinFalloff);
+
+		case SpaceNone:
+			return HUGE_VAL;
+	}
+
+	return HUGE_VAL;	//	should never occur
+}
@@ -74,6 +74,8 @@ void SimulationUpdate(
 	ModelData	*md,
 	double		aFramePeriod)
 {
+	BeginFrameInterval(FrameIntervalSimulationUpdate);
+
 	//	If some external delay suspends the animation for a few seconds
 	//	(for example if the user holds down a menu) we'll receive
 	//	a huge frame period.  To avoid a discontinuous jump,
@@ -101,6 +103,8 @@ void SimulationUpdate(
 	
 	//	The UI-specific code will need to redraw the scene.
 	md->itsChangeCount++;
+
+	EndFrameInterval(FrameIntervalSimulationUpdate);
 }
 
 
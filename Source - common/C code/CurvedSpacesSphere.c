@@ -72,14 +72,7 @@ void MakeSphereMesh(
 	unsigned int	*aNumMeshFacets,				//	output
 	unsigned int	(**someMeshFacets)[3])			//	output
 {
-	unsigned int	theSphereNumVertices[MAX_SPHERE_REFINEMENT_LEVEL + 1];
-	double			theSphereVertexPositions[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][4],
-					theSphereVertexTexCoords[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][3],
-					theSphereVertexColors[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][4];
-	unsigned int	theSphereNumFacets[MAX_SPHERE_REFINEMENT_LEVEL + 1],
-					theSphereFacets[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_FACETS][3],
-					i,
-					j;
+	MeshBuffers	theMeshBuffers;
 
 	GEOMETRY_GAMES_ASSERT(
 			aNumMeshVertices		!= NULL
@@ -98,6 +91,88 @@ void MakeSphereMesh(
 		 && *someMeshFacets				== NULL,
 		"Output pointers must point to NULL arrays");
 
+	//	Set the number of vertices and facets.
+	CountSphereMesh(aNumSubdivisions, aNumMeshVertices, aNumMeshFacets);
+
+	//	Allocate the output arrays.
+	//	The caller will take responsibility for calling FreeSphereMesh()
+	//	to free these arrays when they're no longer needed.
+	*someMeshVertexPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshVertexTexCoords	= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
+	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
+	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
+
+	//	Write the mesh into the output arrays.
+	SetMeshBuffersForArrays(&theMeshBuffers,
+							*someMeshVertexPositions,
+							*someMeshVertexTexCoords,
+							*someMeshVertexColors,
+							NULL,
+							NULL,
+							*someMeshFacets);
+	WriteSphereMesh(aRadius, aNumSubdivisions, aColor, &theMeshBuffers);
+}
+
+void CountSphereMesh(
+	unsigned int	aNumSubdivisions,	//	input
+	unsigned int	*aNumMeshVertices,	//	output
+	unsigned int	*aNumMeshFacets)	//	output
+{
+	//	Make sure that the requested number of subdivisions isn't too large.
+	GEOMETRY_GAMES_ASSERT(
+		aNumSubdivisions <= MAX_SPHERE_REFINEMENT_LEVEL,
+		"aNumSubdivisions exceeds the maximum supported level.  You may increase MAX_SPHERE_REFINEMENT_LEVEL if desired.");
+
+	//	Each subdivision quadruples the icosahedron's 20 facets.
+	*aNumMeshFacets = 20 << (2 * aNumSubdivisions);
+
+	//	Count the vertices as in SubdivideMesh().
+	*aNumMeshVertices = (3*(*aNumMeshFacets) + 12*(6 - 5)) / 6;
+}
+
+double SphereMeshError(
+	double			aRadius,			//	input
+	unsigned int	aNumSubdivisions)	//	input
+{
+	double	theAngle;
+
+	//	How far may WriteSphereMesh()'s polyhedron fall inside the true sphere?
+	//
+	//	The deepest point of each facet is its center,
+	//	which sits at distance r·cos(θ) from the sphere's center,
+	//	where θ is the angle from the facet's center to its vertices.
+	//	For the icosahedron θ = atan(3 - √5) ≈ 0.6524 exactly.
+	//	Each subdivision roughly halves θ, so estimate the error
+	//	at the finer levels by halving θ once per level.
+	//	The renderer uses this estimate only to decide
+	//	which level of detail is good enough at a given distance.
+	theAngle = atan(3.0 - sqrt(5.0)) / (double)(1 << aNumSubdivisions);
+
+	return aRadius * (1.0 - cos(theAngle));
+}
+
+void WriteSphereMesh(
+	double				aRadius,			//	input
+	unsigned int		aNumSubdivisions,	//	input
+	const double		aColor[4],			//	input;	pre-multiplied (αR, αG, αB, α)
+	const MeshBuffers	*someMeshBuffers)	//	output;	room for CountSphereMesh()'s vertices and facets
+{
+	unsigned int	theSphereNumVertices[MAX_SPHERE_REFINEMENT_LEVEL + 1];
+	double			theSphereVertexPositions[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][4],
+					theSphereVertexTexCoords[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][3],
+					theSphereVertexColors[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_VERTICES][4];
+	unsigned int	theSphereNumFacets[MAX_SPHERE_REFINEMENT_LEVEL + 1],
+					theSphereFacets[MAX_SPHERE_REFINEMENT_LEVEL + 1][MAX_NUM_REFINED_SPHERE_FACETS][3],
+					i;
+
+	GEOMETRY_GAMES_ASSERT(
+		someMeshBuffers != NULL,
+		"Output pointer must not be NULL");
+
+	//	Make sure that the requested number of subdivisions isn't too large.
+	GEOMETRY_GAMES_ASSERT(
+		aNumSubdivisions <= MAX_SPHERE_REFINEMENT_LEVEL,
+		"aNumSubdivisions exceeds the maximum supported level.  You may increase MAX_SPHERE_REFINEMENT_LEVEL if desired.");
 
 	//	Construct an icosahedron for the base level.
 	InitIcosahedron(
@@ -110,8 +185,9 @@ void MakeSphereMesh(
 		&theSphereNumFacets[0],
 		theSphereFacets[0]);
 
-	//	Subdivide each mesh to get the next one in the series.
-	for (i = 0; i < MAX_SPHERE_REFINEMENT_LEVEL; i++)
+	//	Subdivide each mesh to get the next one in the series,
+	//	stopping at the requested level.
+	for (i = 0; i < aNumSubdivisions; i++)
 	{
 		SubdivideMesh
 		(
@@ -135,43 +211,23 @@ void MakeSphereMesh(
 			theSphereFacets[i+1]
 		);
 	}
-	
-	//	Make sure that the requested number of subdivisions isn't too large.
-	GEOMETRY_GAMES_ASSERT(
-		aNumSubdivisions <= MAX_SPHERE_REFINEMENT_LEVEL,
-		"aNumSubdivisions exceeds the maximum supported level.  You may increase MAX_SPHERE_REFINEMENT_LEVEL if desired.");
 
-	//	Set the number of vertices and facets.
-	*aNumMeshVertices	= theSphereNumVertices[aNumSubdivisions];
-	*aNumMeshFacets		= theSphereNumFacets[aNumSubdivisions];
+	//	Write the requested subdivision to the caller's buffers.
 
-	//	Allocate the output arrays.
-	//	The caller will take responsibility for calling FreeSphereMesh()
-	//	to free these arrays when they're no longer needed.
-	*someMeshVertexPositions	= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshVertexTexCoords	= (double (*)[3]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [3]) );
-	*someMeshVertexColors		= (double (*)[4]) GET_MEMORY( (*aNumMeshVertices) * sizeof(double [4]) );
-	*someMeshFacets				= (unsigned int (*)[3]) GET_MEMORY( (*aNumMeshFacets) * sizeof(unsigned int [3]) );
-
-	//	Copy the requested subdivision to the output arrays.
-	//	Factor aRadius into the vertex positions.
-	
-	for (i = 0; i < *aNumMeshVertices; i++)
+	for (i = 0; i < theSphereNumVertices[aNumSubdivisions]; i++)
 	{
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexPositions)[i][j]	= theSphereVertexPositions[aNumSubdivisions][i][j];
-		
-		for (j = 0; j < 3; j++)
-			(*someMeshVertexTexCoords)[i][j]	= theSphereVertexTexCoords[aNumSubdivisions][i][j];
-
-		for (j = 0; j < 4; j++)
-			(*someMeshVertexColors)[i][j]		= theSphereVertexColors[aNumSubdivisions][i][j];
+		WriteMeshVertex(someMeshBuffers, i,
+						theSphereVertexPositions[aNumSubdivisions][i],
+						theSphereVertexTexCoords[aNumSubdivisions][i],
+						theSphereVertexColors[aNumSubdivisions][i]);
 	}
 
-	for (i = 0; i < *aNumMeshFacets; i++)
+	for (i = 0; i < theSphereNumFacets[aNumSubdivisions]; i++)
 	{
-		for (j = 0; j < 3; j++)
-			(*someMeshFacets)[i][j]	= theSphereFacets[aNumSubdivisions][i][j];
+		WriteMeshFacet(	someMeshBuffers, i,
+						theSphereFacets[aNumSubdivisions][i][0],
+						theSphereFacets[aNumSubdivisions][i][1],
+						theSphereFacets[aNumSubdivisions][i][2]);
 	}
 }
 
@@ -343,6 +399,9 @@ static void SubdivideMesh(
 	unsigned int	*v,
 					vv[3];
 
+	//	Every vertex gets aColor, so the source colors go unread.
+	UNUSED_PARAMETER(aSrcVertexColors);
+
 	GEOMETRY_GAMES_ASSERT(
 		aSrcNumVertices <= MAX_NUM_REFINED_SPHERE_VERTICES,
 		"too many source vertices");
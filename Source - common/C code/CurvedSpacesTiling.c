@@ -8,7 +8,10 @@
 #include "CurvedSpaces-Common.h"
 #include "GeometryGamesUtilities-Common.h"
 #include <math.h>
-#include <stdlib.h>	//	for qsort()
+#include <stdlib.h>		//	for qsort()
+#include <string.h>		//	for memcpy()
+#include <pthread.h>
+#include <unistd.h>		//	for sysconf()
 
 
 //	If a generator equals its inverse,
@@ -23,22 +26,46 @@
 //	yet still tight enough to distinguish different matrices.
 #define TILING_EPSILON		1e-5
 
-//	How accurately do we know our sort key?
-//	For sure large hyperbolic tilings will be the worst case.
-//	Happily, tests on a mirrored dodecahedron found sort key errors
-//	running from ~10⁻¹⁴ at a tiling radius of 4.0,
-//	to ~10⁻¹³ at a tiling radius of 6.0.
-//	Of course other hyperbolic manifolds, with less precise
-//	initial generators (and few zeros in the matrices!) will fare worse.
-#define SORT_KEY_EPSILON	1e-8
-
-//	The SORT_KEY_W_DEPENDENCE should be weak enough that it doesn't
-//	disturb the symmetrical distribution of values on flat and hyperbolic
-//	spaces, yet strong enough to reliably distinguish spherical points
-//	differing only in w.
-//	All these epsilons remind me why exact arithmetic is so appealing.  ☺
-//	Yet exact arithmetic is surely too slow for present purposes.  ☹
-#define SORT_KEY_W_DEPENDENCE	1e-4
+//	To detect duplicate tiles quickly, file each Tile in a hash table
+//	according to which cell of a cubical grid the image of the origin
+//	(0,0,0,1) falls into.  Two matrices that agree to within TILING_EPSILON
+//	will have images of the origin within TILING_EPSILON of each other
+//	in each coordinate, so they'll fall either into the same grid cell or,
+//	if they sit near a cell boundary, into adjacent grid cells.
+//	HASH_GRID_CELL_SIZE should be large compared to TILING_EPSILON,
+//	so that neighboring grid cells rarely need to be probed,
+//	but small compared to the spacing between distinct tiles' images
+//	of the origin, so that each grid cell rarely contains more than one tile.
+//
+//	The grid uses only the x, y and z coordinates.  In the spherical case
+//	two distinct group elements may take the origin to images differing
+//	only in the sign of the w-coordinate, but such images will merely
+//	share a hash bucket, where MatrixEquality() will tell them apart.
+#define HASH_GRID_CELL_SIZE		1e-3
+
+//	Flat lattice translations have integer or simple rational coordinates,
+//	which would land exactly on the cell boundaries of a grid
+//	based at the origin, forcing every lookup to probe 8 cells.
+//	So shift the grid by an irrational fraction of a cell
+//	(the golden ratio's fractional part), which keeps every multiple
+//	of 1/2, 1/3, 1/4, 1/5, 1/6 or 1/8 well away from any boundary.
+#define HASH_GRID_OFFSET		0.6180339887498949	//	in grid cells
+
+//	Start with a modest number of hash buckets, and double the number
+//	whenever the number of tiles exceeds it.  The number of buckets
+//	must always be a power of two.
+#define INITIAL_NUM_HASH_BUCKETS	1024
+
+//	Allocate Tiles in blocks of TILE_ARENA_BLOCK_SIZE.
+#define TILE_ARENA_BLOCK_SIZE		1024
+
+//	ConstructHolonomyGroup() expands the tiling one breadth-first level
+//	at a time, handing each worker thread a contiguous slice of the frontier.
+//	Spawning threads isn't free, so give each thread at least
+//	MIN_FRONTIER_TILES_PER_THREAD tiles to work on, and never use
+//	more than MAX_TILING_THREADS threads in all.
+#define MIN_FRONTIER_TILES_PER_THREAD	256
+#define MAX_TILING_THREADS				16
 
 //	For testing whether the antipodal matrix is present,
 //	any reasonable value for ANTIPODAL_EPSILON will do.
@@ -59,71 +86,236 @@ typedef struct Tile
 	//	How far does it translate the origin (0,0,0,1) ?
 	double		itsTranslationDistance;
 
-	//	Support for the binary tree used during construction
-	double		itsSortKey;
-	struct Tile	*itsLeftChild,
-				*itsRightChild;
+	//	Did some neighbor of this Tile lie beyond the tiling radius?
+	//	If so, ExtendTiling() must revisit this Tile when the radius grows.
+	bool		itsFringeFlag;
+
+	//	Support for the hash table used during construction
+	uint64_t	itsHashValue;
+	struct Tile	*itsHashNext;
+
+	//	Support for the list of all tiles, in the order we found them
+	struct Tile	*itsNext;
 
-	//	Support for the queue used during construction
-	struct Tile	*itsQueueNext;
+	//	Where did the most recent call to CopyTilingToHolonomyGroup()
+	//	put this Tile's matrix?  ConstructCayleyTable() uses this index
+	//	to convert the Tiles it finds to holonomy group elements.
+	unsigned int	itsGroupIndex;
 
 } Tile;
 
 
 //	The TilingInProgress serves to group some variable together,
 //	more for conceptual clarity than any profound algorithm reason.
-typedef struct
+//	It survives from one call to ExtendTiling() to the next,
+//	so a tiling may grow in stages without repeating earlier work.
+struct TilingInProgress
 {
+	//	The generators and their inverses
+	MatrixList		*itsExtendedGeneratorList;
+
+	//	How far out does the tiling currently reach?
+	//	Every group element that's reachable from the identity
+	//	via a sequence of neighboring tiles, each lying within
+	//	itsTilingRadius of the origin, is present.
+	double			itsTilingRadius;
+
 	//	How many tiles do we have?
 	unsigned int	itsNumTiles;
 
-	//	Keep the Tiles on a binary tree during construction.
-	//	To keep the tree balanced, the sort key should not correlate
-	//	with the structure of the group.  When the construction
-	//	is complete, destroy the tree and set itsTree to NULL.
-	Tile			*itsTree;
-
-	//	Keep Tiles waiting to be processed on a singly-linked list,
-	//	as well as on the binary tree.  When the construction
-	//	is complete, destroy the list and set itsQueueFirst and
-	//	itsQueueLast to NULL.
-	Tile			*itsQueueFirst,
-					*itsQueueLast;
-
-} TilingInProgress;
-
-
-static void					FreeTree(Tile **aTree);
-static double				MakeSortKey(Matrix *aMatrix);
-static ErrorText			AddToTiling(TilingInProgress *aTiling, Matrix *aMatrix, double aSortKey, double aTranslationDistance);
-static Tile					*GetTileFromQueue(TilingInProgress *aTiling);
-static double				TranslationDistance(Matrix *aMatrix);
-static bool					TreeContainsMatrix(Tile *aTree, Matrix *aMatrix, double aSortKey);
-static void					CopyPointersToArray(Tile *aTree, Tile ***anArray);
+	//	Keep all Tiles on a singly-linked list, in the order we found them.
+	//	Because we find them in breadth-first order, the Tiles waiting
+	//	to be processed are exactly those from itsQueueFirst to the end
+	//	of the list, so the list serves as its own queue.
+	Tile			*itsFirstTile,
+					*itsLastTile,
+					*itsQueueFirst;
+
+	//	Keep the Tiles in a hash table as well, keyed by the grid cell
+	//	containing each Tile's image of the origin, so we can tell
+	//	in constant expected time whether a candidate is new.
+	//	itsNumHashBuckets is always a power of two.
+	unsigned int	itsNumHashBuckets;
+	Tile			**itsHashBuckets;
+
+	//	All the Tiles live in a single arena, so a large tiling
+	//	needs only one allocation per block of Tiles,
+	//	and FreeTiling() frees them all at once.
+	Arena			itsTileArena;
+};
+
+
+//	A Candidate is a potential new Tile that some worker thread
+//	has found while expanding its slice of the frontier.
+typedef struct
+{
+	Matrix	itsMatrix;
+	double	itsTranslationDistance;
+} Candidate;
+
+//	Each worker thread expands the slice of the frontier
+//	from itsFrontierStart to itsFrontierStop - 1,
+//	and reports the resulting Candidates in order.
+//	ExpandFrontier() allocates each slice's buffers before
+//	the workers start, so the workers never touch the allocator.
+typedef struct
+{
+	//	input (read-only, shared by all workers)
+	TilingInProgress	*itsTiling;
+	MatrixList			*itsGeneratorList;
+	double				itsTilingRadius;
+	Tile				**itsFrontier;
+
+	//	input (private to this worker)
+	unsigned int		itsFrontierStart,
+						itsFrontierStop;
+	Matrix				*itsNeighbors;	//	room for one Matrix per generator
+
+	//	output
+	unsigned int		itsNumCandidates,
+						itsCandidateCapacity;	//	one per generator per Tile in the slice
+	Candidate			*itsCandidates;
+	ErrorText			itsErrorMessage;
+} FrontierSlice;
+
+//	A cached tiling records each Tile, in list order,
+//	so ReadTilingCache() may rebuild an identical TilingInProgress.
+typedef struct
+{
+	double		itsTilingRadius;
+	uint32_t	itsNumTiles,
+				itsPadding;
+} CachedTilingHeader;
+
+typedef struct
+{
+	double		itsMatrix[4][4];
+	uint32_t	itsParity,
+				itsFringeFlag;
+	double		itsTranslationDistance;
+} CachedTile;
+
+//	A cached Cayley table is this header followed by
+//	itsNumGenerators * itsNumElements products.
+typedef struct
+{
+	uint32_t	itsNumElements,
+				itsNumGenerators,
+				itsIdentityElement,
+				itsAntipodalElement;
+} CachedCayleyTableHeader;
+
+
+static ErrorText			BeginEmptyTiling(MatrixList *aGeneratorList, TilingInProgress **aTiling);
+static void					MoveFringeTilesToEndOfList(TilingInProgress *aTiling);
+static int64_t				HashGridCoordinate(double aCoordinate);
+static uint64_t				HashGridCell(int64_t i, int64_t j, int64_t k);
+static ErrorText			AddToTiling(TilingInProgress *aTiling, Matrix *aMatrix, double aTranslationDistance);
+static ErrorText			GrowHashTable(TilingInProgress *aTiling);
+static ErrorText			ExpandFrontier(TilingInProgress *aTiling, MatrixList *aGeneratorList, double aTilingRadius);
+static unsigned int			NumTilingThreads(unsigned int aFrontierSize);
+static void					*ExpandFrontierSlice(void *aFrontierSlice);
+static ErrorText			AddCandidate(FrontierSlice *aSlice, Matrix *aMatrix, double aTranslationDistance);
+static Tile					*TilingFindMatrix(TilingInProgress *aTiling, Matrix *aMatrix);
+static void					CopyPointersToArray(Tile *aTileList, Tile ***anArray);
 static __cdecl signed int	CompareTranslationDistances(const void *p1, const void *p2);
+static unsigned int			CayleyProduct(CayleyTable *aCayleyTable, unsigned int *someParents, unsigned int *someParentGenerators,
+								unsigned int *aWordBuffer, unsigned int anElement, unsigned int aFactor);
 
 
 ErrorText ConstructHolonomyGroup(
-	MatrixList		*aGeneratorList,
-	double			aTilingRadius,
-	MatrixList		**aHolonomyGroup)			//	output
-{
-	ErrorText			theErrorMessage				= NULL;
-	MatrixList			*theExtendedGeneratorList	= NULL;
-	TilingInProgress	theTilingInProgress			= {0, NULL, NULL, NULL};
-	Matrix				theIdentityMatrix,
-						theInverse;
-	Tile				*theTile;
-	Matrix				theCandidate;
-	double				theTranslationDistance,
-						theSortKey;
-	Tile				**theTileArray				= NULL,
-						**theWriteLocation;
-	unsigned int		i;
+	MatrixList			*aGeneratorList,
+	double				aTilingRadius,
+	const atomic_bool	*aCancelFlag,		//	may be NULL
+	MatrixList			**aHolonomyGroup)	//	output
+{
+	ErrorText			theErrorMessage	= NULL;
+	TilingInProgress	*theTiling		= NULL;
 
 	if (*aHolonomyGroup != NULL)
 		return u"ConstructHolonomyGroup() received a non-NULL output location.";
 
+	theErrorMessage = BeginTiling(aGeneratorList, &theTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHolonomyGroup;
+
+	theErrorMessage = ExtendTiling(theTiling, aTilingRadius, aCancelFlag);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHolonomyGroup;
+
+	theErrorMessage = CopyTilingToHolonomyGroup(theTiling, aHolonomyGroup);
+	if (theErrorMessage != NULL)
+		goto CleanUpConstructHolonomyGroup;
+
+CleanUpConstructHolonomyGroup:
+
+	FreeTiling(&theTiling);
+
+	return theErrorMessage;
+}
+
+
+ErrorText BeginTiling(
+	MatrixList			*aGeneratorList,
+	TilingInProgress	**aTiling)	//	output, to be freed with FreeTiling()
+{
+	ErrorText			theErrorMessage	= NULL;
+	TilingInProgress	*theTiling		= NULL;
+	Matrix				theIdentityMatrix;
+
+	if (*aTiling != NULL)
+		return u"BeginTiling() received a non-NULL output location.";
+
+	theErrorMessage = BeginEmptyTiling(aGeneratorList, &theTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpBeginTiling;
+
+	//	Add the identity matrix to the tiling.
+	//	Mark it as a fringe tile, so that the first call
+	//	to ExtendTiling() will start the search there.
+	MatrixIdentity(&theIdentityMatrix);
+	theErrorMessage = AddToTiling(	theTiling,
+									&theIdentityMatrix,
+									0.0);
+	if (theErrorMessage != NULL)
+		goto CleanUpBeginTiling;
+	theTiling->itsFirstTile->itsFringeFlag	= true;
+	theTiling->itsQueueFirst				= NULL;
+
+CleanUpBeginTiling:
+
+	if (theErrorMessage != NULL)
+		FreeTiling(&theTiling);
+
+	*aTiling = theTiling;
+
+	return theErrorMessage;
+}
+
+
+static ErrorText BeginEmptyTiling(
+	MatrixList			*aGeneratorList,
+	TilingInProgress	**aTiling)	//	output, to be freed with FreeTiling()
+{
+	ErrorText			theErrorMessage	= NULL;
+	TilingInProgress	*theTiling		= NULL;
+	Matrix				theInverse;
+	unsigned int		i;
+
+	//	Start with an empty tiling, with no tiles at all.
+	theTiling = (TilingInProgress *) GET_MEMORY(sizeof(TilingInProgress));
+	if (theTiling == NULL)
+		return u"Couldn't get memory for the TilingInProgress in BeginEmptyTiling().";
+	theTiling->itsExtendedGeneratorList	= NULL;
+	theTiling->itsTilingRadius			= 0.0;
+	theTiling->itsNumTiles				= 0;
+	theTiling->itsFirstTile				= NULL;
+	theTiling->itsLastTile				= NULL;
+	theTiling->itsQueueFirst			= NULL;
+	theTiling->itsNumHashBuckets		= 0;
+	theTiling->itsHashBuckets			= NULL;
+	InitArena(&theTiling->itsTileArena, sizeof(Tile), TILE_ARENA_BLOCK_SIZE);
+
 	//	Extend the list of generators to include explicit inverses.
 	//
 	//	Warning:  Error checking here is minimal.
@@ -134,77 +326,137 @@ ErrorText ConstructHolonomyGroup(
 	//	that doesn't fix the origin.
 
 	//		Allow space for twice as many matrices as we were given.
-	theExtendedGeneratorList = AllocateMatrixList( 2 * aGeneratorList->itsNumMatrices );
-	if (theExtendedGeneratorList == NULL)
-		return u"Couldn't get memory for theExtendedGeneratorList in ConstructHolonomyGroup().";
+	theTiling->itsExtendedGeneratorList = AllocateMatrixList( 2 * aGeneratorList->itsNumMatrices );
+	if (theTiling->itsExtendedGeneratorList == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for theExtendedGeneratorList in BeginEmptyTiling().";
+		goto CleanUpBeginEmptyTiling;
+	}
 
 	//		Copy the generators and their inverses (when distinct)
 	//		and count them as we go along.
-	theExtendedGeneratorList->itsNumMatrices = 0;
+	theTiling->itsExtendedGeneratorList->itsNumMatrices = 0;
 	for (i = 0; i < aGeneratorList->itsNumMatrices; i++)
 	{
 		//	Always add the generator itself.
-		theExtendedGeneratorList->itsMatrices[theExtendedGeneratorList->itsNumMatrices++]
+		theTiling->itsExtendedGeneratorList->itsMatrices[theTiling->itsExtendedGeneratorList->itsNumMatrices++]
 			= aGeneratorList->itsMatrices[i];
 
 		//	Add the generator's inverse iff it's distinct.
 		MatrixGeometricInverse(&aGeneratorList->itsMatrices[i], &theInverse);
 		if ( ! MatrixEquality(&aGeneratorList->itsMatrices[i], &theInverse, GENERATOR_EPSILON) )
-			theExtendedGeneratorList->itsMatrices[theExtendedGeneratorList->itsNumMatrices++]
+			theTiling->itsExtendedGeneratorList->itsMatrices[theTiling->itsExtendedGeneratorList->itsNumMatrices++]
 				= theInverse;
 	}
 
-	//	Initialize theTilingInProgress to an empty tiling.
-	//	(Redundant but makes our meaning clear.)
-	theTilingInProgress.itsNumTiles		= 0;
-	theTilingInProgress.itsTree			= NULL;
-	theTilingInProgress.itsQueueFirst	= NULL;
-	theTilingInProgress.itsQueueLast	= NULL;
+	//	Allocate an empty hash table.
+	theTiling->itsNumHashBuckets	= INITIAL_NUM_HASH_BUCKETS;
+	theTiling->itsHashBuckets		= (Tile **) GET_MEMORY(INITIAL_NUM_HASH_BUCKETS * sizeof(Tile *));
+	if (theTiling->itsHashBuckets == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the hash table in BeginEmptyTiling().";
+		goto CleanUpBeginEmptyTiling;
+	}
+	for (i = 0; i < INITIAL_NUM_HASH_BUCKETS; i++)
+		theTiling->itsHashBuckets[i] = NULL;
+
+CleanUpBeginEmptyTiling:
 
-	//	Add the identity matrix to the tiling.
-	MatrixIdentity(&theIdentityMatrix);
-	theErrorMessage = AddToTiling(	&theTilingInProgress,
-									&theIdentityMatrix,
-									MakeSortKey(&theIdentityMatrix),
-									0.0);
 	if (theErrorMessage != NULL)
-		goto CleanUpConstructHolonomyGroup;
+		FreeTiling(&theTiling);
+
+	*aTiling = theTiling;
+
+	return theErrorMessage;
+}
+
 
-	//	Process the queue.
-	while ((theTile = GetTileFromQueue(&theTilingInProgress)) != NULL)
+ErrorText ExtendTiling(
+	TilingInProgress	*aTiling,
+	double				aTilingRadius,
+	const atomic_bool	*aCancelFlag)	//	may be NULL
+{
+	ErrorText	theErrorMessage	= NULL;
+	Tile		*theTile;
+
+	//	A tiling never shrinks.  To use a smaller tiling,
+	//	simply ignore the tiles beyond the desired radius
+	//	in the output of CopyTilingToHolonomyGroup().
+	if (aTilingRadius <= aTiling->itsTilingRadius)
+		return NULL;
+
+	aTiling->itsTilingRadius = aTilingRadius;
+
+	//	Any group element that lies within the new radius
+	//	but wasn't found before must be reachable via a path
+	//	whose first new tile neighbors some fringe tile.
+	//	So it suffices to re-process the fringe tiles.
+	//	ExpandFrontier() expects its frontier to sit at the end
+	//	of the list of all tiles, so move the fringe tiles there.
+	//	The order of the list is otherwise irrelevant,
+	//	because CopyTilingToHolonomyGroup() sorts the tiles anyhow.
+	MoveFringeTilesToEndOfList(aTiling);
+
+	//	Process the queue one breadth-first level at a time.
+	//	Check aCancelFlag between levels, so that the caller
+	//	may abandon a slow construction running on a background thread.
+	while (aTiling->itsQueueFirst != NULL)
 	{
-		//	For each generator...
-		for (i = 0; i < theExtendedGeneratorList->itsNumMatrices; i++)
+		if (aCancelFlag != NULL && atomic_load(aCancelFlag))
 		{
-			//	...pre-multiplying (not post-multiplying!) a matrix
-			//	by a generator yields a neighbor of the given tile.
-			MatrixProduct(	&theExtendedGeneratorList->itsMatrices[i],
-							&theTile->itsMatrix,
-							&theCandidate);
+			theErrorMessage = u"ExtendTiling() was cancelled.";
+			goto CleanUpExtendTiling;
+		}
 
-			//	Note the candidate's translation distance.
-			theTranslationDistance = TranslationDistance(&theCandidate);
+		theErrorMessage = ExpandFrontier(	aTiling,
+											aTiling->itsExtendedGeneratorList,
+											aTiling->itsTilingRadius);
+		if (theErrorMessage != NULL)
+			goto CleanUpExtendTiling;
+	}
 
-			//	Reject candidates that translate too far.
-			if (theTranslationDistance > aTilingRadius)
-				continue;
+CleanUpExtendTiling:
 
-			//	Note the candidate's sort key.
-			theSortKey = MakeSortKey(&theCandidate);
+	//	If we got interrupted, the tiling is no longer consistent
+	//	with its radius, so mark every tile as a fringe tile
+	//	to let a future call to ExtendTiling() start afresh.
+	if (theErrorMessage != NULL)
+	{
+		for (theTile = aTiling->itsFirstTile; theTile != NULL; theTile = theTile->itsNext)
+			theTile->itsFringeFlag = true;
+		aTiling->itsQueueFirst		= NULL;
+		aTiling->itsTilingRadius	= 0.0;
+	}
 
-			//	Reject candidates already found earlier.
-			if (TreeContainsMatrix(theTilingInProgress.itsTree, &theCandidate, theSortKey))
-				continue;
+	return theErrorMessage;
+}
 
-			//	Add the candidate to the tiling.
-			theErrorMessage = AddToTiling(	&theTilingInProgress,
-											&theCandidate,
-											theSortKey,
-											theTranslationDistance);
-			if (theErrorMessage != NULL)
-				goto CleanUpConstructHolonomyGroup;
-		}
-	}
+
+double TilingRadius(
+	TilingInProgress	*aTiling)
+{
+	return aTiling->itsTilingRadius;
+}
+
+
+unsigned int TilingNumTiles(
+	TilingInProgress	*aTiling)
+{
+	return aTiling->itsNumTiles;
+}
+
+
+ErrorText CopyTilingToHolonomyGroup(
+	TilingInProgress	*aTiling,
+	MatrixList			**aHolonomyGroup)	//	output
+{
+	ErrorText		theErrorMessage	= NULL;
+	Tile			**theTileArray	= NULL,
+					**theWriteLocation;
+	unsigned int	i;
+
+	if (*aHolonomyGroup != NULL)
+		return u"CopyTilingToHolonomyGroup() received a non-NULL output location.";
 
 	//	Sort the Tiles.
 	//
@@ -216,42 +468,45 @@ ErrorText ConstructHolonomyGroup(
 	//	sorts relative to the distance to the observer.
 
 	//		Allocate an array to hold pointers to the Tiles.
-	theTileArray = (Tile **) GET_MEMORY(theTilingInProgress.itsNumTiles * sizeof(Tile *));
+	theTileArray = (Tile **) GET_MEMORY(aTiling->itsNumTiles * sizeof(Tile *));
 	if (theTileArray == NULL)
 	{
-		theErrorMessage = u"Can't get memory to sort Tiles in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		theErrorMessage = u"Can't get memory to sort Tiles in CopyTilingToHolonomyGroup().";
+		goto CleanUpCopyTilingToHolonomyGroup;
 	}
 
-	//		Copy the pointers from the tree structure recursively,
-	//		advancing the destination pointer theTile as we go.
+	//		Copy the pointers from the list of all tiles,
+	//		advancing the destination pointer theWriteLocation as we go.
 	//		Afterwards, make sure we wrote exactly the right number of tiles.
 	theWriteLocation = theTileArray;
-	CopyPointersToArray(theTilingInProgress.itsTree, &theWriteLocation);
-	if (theWriteLocation != theTileArray + theTilingInProgress.itsNumTiles)
+	CopyPointersToArray(aTiling->itsFirstTile, &theWriteLocation);
+	if (theWriteLocation != theTileArray + aTiling->itsNumTiles)
 	{
-		theErrorMessage = u"Grave error while copying Tile addresses in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		theErrorMessage = u"Grave error while copying Tile addresses in CopyTilingToHolonomyGroup().";
+		goto CleanUpCopyTilingToHolonomyGroup;
 	}
 
 	//		Call the standard library's QuickSort implementation
 	//		to sort the pointers.
 	qsort(	theTileArray,
-			theTilingInProgress.itsNumTiles,
+			aTiling->itsNumTiles,
 			sizeof(Tile *),
 			CompareTranslationDistances);
 
 	//	Copy the matrices to aHolonomyGroup (our final output variable!).
-	*aHolonomyGroup = AllocateMatrixList(theTilingInProgress.itsNumTiles);
+	*aHolonomyGroup = AllocateMatrixList(aTiling->itsNumTiles);
 	if (*aHolonomyGroup == NULL)
 	{
-		theErrorMessage = u"Couldn't get memory for aHolonomyGroup in ConstructHolonomyGroup().";
-		goto CleanUpConstructHolonomyGroup;
+		theErrorMessage = u"Couldn't get memory for aHolonomyGroup in CopyTilingToHolonomyGroup().";
+		goto CleanUpCopyTilingToHolonomyGroup;
+	}
+	for (i = 0; i < aTiling->itsNumTiles; i++)
+	{
+		(*aHolonomyGroup)->itsMatrices[i]	= theTileArray[i]->itsMatrix;
+		theTileArray[i]->itsGroupIndex		= i;
 	}
-	for (i = 0; i < theTilingInProgress.itsNumTiles; i++)
-		(*aHolonomyGroup)->itsMatrices[i] = theTileArray[i]->itsMatrix;
 
-CleanUpConstructHolonomyGroup:
+CleanUpCopyTilingToHolonomyGroup:
 
 	//	As the code is now written, *aHolonomyGroup will be NULL
 	//	until the last moment.  But best to leave this check in place
@@ -259,154 +514,572 @@ CleanUpConstructHolonomyGroup:
 	if (theErrorMessage != NULL)
 		FreeMatrixList(aHolonomyGroup);
 
-	//	The Tiles get stored on three independent data structures:
-	//	the tree, the queue and the array.  Let's free the Tiles
-	//	as part of the tree, because each Tile goes onto the tree
-	//	immediately upon its creation and remains there thereafter.
-	//	(By contrast, Tiles get taken off the queue, and the array
-	//	doesn't even exist until late in the algorithm.)
-	FreeTree(&theTilingInProgress.itsTree);
-	theTilingInProgress.itsQueueFirst	= NULL;
-	theTilingInProgress.itsQueueLast	= NULL;
 	FREE_MEMORY_SAFELY(theTileArray);
 
+	return theErrorMessage;
+}
+
+
+void FreeTiling(
+	TilingInProgress	**aTiling)
+{
+	if (aTiling == NULL
+	 || *aTiling == NULL)
+		return;
+
+	//	The Tiles get referenced from two independent data structures:
+	//	the list and the hash table.  But all the Tiles live
+	//	in the tile arena, so we may free them all at once.
+	FreeArena(&(*aTiling)->itsTileArena);
+	(*aTiling)->itsFirstTile	= NULL;
+	(*aTiling)->itsLastTile		= NULL;
+	(*aTiling)->itsQueueFirst	= NULL;
+
+	FREE_MEMORY_SAFELY((*aTiling)->itsHashBuckets);
+
 	//	Free the extended generator list.
-	FreeMatrixList(&theExtendedGeneratorList);
+	FreeMatrixList(&(*aTiling)->itsExtendedGeneratorList);
+
+	FREE_MEMORY_SAFELY(*aTiling);
+}
+
+
+size_t TilingCacheSize(
+	TilingInProgress	*aTiling)
+{
+	if (aTiling == NULL)
+		return 0;
+
+	return sizeof(CachedTilingHeader)
+		 + aTiling->itsNumTiles * sizeof(CachedTile);
+}
+
+
+ErrorText WriteTilingCache(
+	TilingInProgress	*aTiling,		//	input
+	Byte				*aBuffer,		//	output, of length TilingCacheSize(aTiling)
+	size_t				aBufferSize)
+{
+	CachedTilingHeader	theHeader;
+	CachedTile			theCachedTile;
+	Byte				*theWriteLocation;
+	Tile				*theTile;
+
+	if (aTiling == NULL)
+		return NULL;	//	nothing to write
+
+	if (aBufferSize != TilingCacheSize(aTiling))
+		return u"WriteTilingCache() received a buffer of the wrong size.";
+
+	theHeader.itsTilingRadius	= aTiling->itsTilingRadius;
+	theHeader.itsNumTiles		= aTiling->itsNumTiles;
+	theHeader.itsPadding		= 0;
+
+	theWriteLocation = aBuffer;
+	memcpy(theWriteLocation, &theHeader, sizeof(theHeader));
+	theWriteLocation += sizeof(theHeader);
+
+	//	Write the Tiles in list order.  The hash table
+	//	gets rebuilt from the matrices.
+	for (theTile = aTiling->itsFirstTile; theTile != NULL; theTile = theTile->itsNext)
+	{
+		memcpy(theCachedTile.itsMatrix, theTile->itsMatrix.m, sizeof(theCachedTile.itsMatrix));
+		theCachedTile.itsParity					= theTile->itsMatrix.itsParity;
+		theCachedTile.itsFringeFlag				= theTile->itsFringeFlag;
+		theCachedTile.itsTranslationDistance	= theTile->itsTranslationDistance;
+
+		memcpy(theWriteLocation, &theCachedTile, sizeof(theCachedTile));
+		theWriteLocation += sizeof(theCachedTile);
+	}
+
+	if (theWriteLocation != aBuffer + aBufferSize)
+		return u"Grave error while writing cache in WriteTilingCache().";
+
+	return NULL;
+}
+
+
+ErrorText ReadTilingCache(
+	const Byte			*aBuffer,			//	input
+	size_t				aBufferSize,
+	MatrixList			*aGeneratorList,	//	the generators the cached tiling came from
+	TilingInProgress	**aTiling)			//	output, to be freed with FreeTiling()
+{
+	ErrorText			theErrorMessage	= NULL;
+	CachedTilingHeader	theHeader;
+	CachedTile			theCachedTile;
+	const Byte			*theReadLocation;
+	Matrix				theMatrix;
+	unsigned int		i;
+
+	if (*aTiling != NULL)
+		return u"ReadTilingCache() received a non-NULL output location.";
+
+	if (aBufferSize < sizeof(theHeader))
+		return u"The cached tiling is corrupt.";
+	memcpy(&theHeader, aBuffer, sizeof(theHeader));
+	theReadLocation = aBuffer + sizeof(theHeader);
+
+	if (theHeader.itsNumTiles == 0
+	 || theHeader.itsNumTiles > aBufferSize / sizeof(CachedTile)	//	for safety
+	 || aBufferSize != sizeof(theHeader) + theHeader.itsNumTiles * sizeof(CachedTile))
+		return u"The cached tiling is corrupt.";
+
+	theErrorMessage = BeginEmptyTiling(aGeneratorList, aTiling);
+	if (theErrorMessage != NULL)
+		goto CleanUpReadTilingCache;
+
+	//	AddToTiling() appends each Tile to the list,
+	//	so the Tiles keep the order in which WriteTilingCache() wrote them.
+	//	Re-inserting the Tiles into the hash table costs about
+	//	a tenth of a microsecond per Tile, far less than re-tiling,
+	//	so the cache stores no hash table.
+	for (i = 0; i < theHeader.itsNumTiles; i++)
+	{
+		memcpy(&theCachedTile, theReadLocation, sizeof(theCachedTile));
+		theReadLocation += sizeof(theCachedTile);
+
+		memcpy(theMatrix.m, theCachedTile.itsMatrix, sizeof(theCachedTile.itsMatrix));
+		theMatrix.itsParity = (theCachedTile.itsParity == ImageNegative ? ImageNegative : ImagePositive);
+
+		theErrorMessage = AddToTiling(*aTiling, &theMatrix, theCachedTile.itsTranslationDistance);
+		if (theErrorMessage != NULL)
+			goto CleanUpReadTilingCache;
+		(*aTiling)->itsLastTile->itsFringeFlag = (theCachedTile.itsFringeFlag != 0);
+	}
+
+	//	The cached tiling was complete to its radius,
+	//	so nothing awaits processing.
+	(*aTiling)->itsQueueFirst	= NULL;
+	(*aTiling)->itsTilingRadius	= theHeader.itsTilingRadius;
+
+CleanUpReadTilingCache:
+
+	if (theErrorMessage != NULL)
+		FreeTiling(aTiling);
 
 	return theErrorMessage;
 }
 
 
-static void FreeTree(Tile **aTree)
+static void MoveFringeTilesToEndOfList(
+	TilingInProgress	*aTiling)
 {
-	if (*aTree != NULL)
+	Tile	*theFringeFirst	= NULL,
+			*theFringeLast	= NULL,
+			**thePrevLink,
+			*theTile;
+
+	//	Split the list of all tiles into two lists,
+	//	the fringe tiles and all the others, preserving the order
+	//	within each, then append the fringe tiles to the others.
+	//	The fringe tiles then form the queue.
+	aTiling->itsLastTile = NULL;
+	thePrevLink = &aTiling->itsFirstTile;
+	while (*thePrevLink != NULL)
 	{
-		FreeTree(&(*aTree)->itsLeftChild );
-		FreeTree(&(*aTree)->itsRightChild);
-		FREE_MEMORY_SAFELY(*aTree);
+		theTile = *thePrevLink;
+
+		if (theTile->itsFringeFlag)
+		{
+			theTile->itsFringeFlag = false;
+
+			*thePrevLink = theTile->itsNext;
+
+			theTile->itsNext = NULL;
+			if (theFringeLast != NULL)
+				theFringeLast->itsNext = theTile;
+			else
+				theFringeFirst = theTile;
+			theFringeLast = theTile;
+		}
+		else
+		{
+			aTiling->itsLastTile	= theTile;
+			thePrevLink				= &theTile->itsNext;
+		}
 	}
+
+	*thePrevLink			= theFringeFirst;
+	aTiling->itsQueueFirst	= theFringeFirst;
+	if (theFringeLast != NULL)
+		aTiling->itsLastTile = theFringeLast;
 }
 
 
-static double MakeSortKey(Matrix *aMatrix)
+static int64_t HashGridCoordinate(double aCoordinate)
 {
-	//	To store the tiles efficiently on a binary tree,
-	//	we need a sort key that is likely to take distinct values
-	//	for distinct matrices.  I don't see any way to achieve
-	//	this goal with complete rigor (one can't map R³ into R
-	//	injectively), but we should obtain fairly good results
-	//	by taking the image of the origin (0,0,0,1) and projecting
-	//	it onto an arbitrarily chosen axis.  If the chosen axis
-	//	doesn't align with the group in any way, the sort keys
-	//	should all be distinct.
-	//
-	//	A further benefit of this scheme is that the binary tree's
-	//	root node, which will contain the identity matrix, will get
-	//	a value of zero, exactly in the middle of the distribution!
-	//	From there, one expects the remaining nodes to fill out
-	//	a more-or-less balanced tree.
-	//
-	//	Uh-oh.  I forgot that in the spherical case different group
-	//	elements will sit "one above the other", meaning their images
-	//	of the origin differ only in the sign of the w-cooordinate.
-	//	So let's throw in a weak dependence on w to resolve such
-	//	degeneracies without making the sort key distribution
-	//	too asymetrical in the flat and hyperbolic cases.
-	//
-	//	Of course, if one were using exact arithmetic then more robust
-	//	schemes would be possible.
-
-	static const double	theArbitraryAxis[4] =
-						{
-							0.16790445172382044311,
-							0.31996944449851782048,
-							0.93243104285444785608,
-							SORT_KEY_W_DEPENDENCE
-						};
-
-	return theArbitraryAxis[0] * aMatrix->m[3][0]
-		 + theArbitraryAxis[1] * aMatrix->m[3][1]
-		 + theArbitraryAxis[2] * aMatrix->m[3][2]
-		 + theArbitraryAxis[3] * aMatrix->m[3][3];
+	//	Which layer of the (shifted) cubical grid contains aCoordinate?
+	return (int64_t) floor(aCoordinate / HASH_GRID_CELL_SIZE + HASH_GRID_OFFSET);
+}
+
+
+static uint64_t HashGridCell(
+	int64_t	i,
+	int64_t	j,
+	int64_t	k)
+{
+	uint64_t	theHashValue;
+
+	//	Mix the grid cell's three integer coordinates so that
+	//	nearby grid cells land in unrelated hash buckets.
+	//	The multipliers are large odd constants with no particular
+	//	relationship to one another, and the final shifts
+	//	stir the high-order bits down into the low-order bits,
+	//	which are the ones that select the bucket.
+	theHashValue	= (uint64_t) i * 0x9E3779B97F4A7C15ull
+					^ (uint64_t) j * 0xC2B2AE3D27D4EB4Full
+					^ (uint64_t) k * 0x165667B19E3779F9ull;
+	theHashValue	^= theHashValue >> 29;
+	theHashValue	*= 0xBF58476D1CE4E5B9ull;
+	theHashValue	^= theHashValue >> 32;
+
+	return theHashValue;
 }
 
 
 static ErrorText AddToTiling(
 	TilingInProgress	*aTiling,
 	Matrix				*aMatrix,
-	double				aSortKey,
 	double				aTranslationDistance)
 {
-	Tile	*theNewTile,
-			**theNewLocation;
+	ErrorText	theErrorMessage;
+	Tile		*theNewTile,
+				**theBucket;
+
+	//	Make sure the hash table stays sparse enough
+	//	that each bucket contains few Tiles.
+	if (aTiling->itsNumTiles >= aTiling->itsNumHashBuckets)
+	{
+		theErrorMessage = GrowHashTable(aTiling);
+		if (theErrorMessage != NULL)
+			return theErrorMessage;
+	}
 
 	//	Allocate a Tile.
-	theNewTile = (Tile *) GET_MEMORY(sizeof(Tile));
+	theNewTile = (Tile *) ArenaAllocate(&aTiling->itsTileArena);
 	if (theNewTile == NULL)
 		return u"Out of memory in AddToTiling().";
 
 	//	Copy the basic data.
 	theNewTile->itsMatrix				= *aMatrix;
-	theNewTile->itsSortKey				= aSortKey;
 	theNewTile->itsTranslationDistance	= aTranslationDistance;
+	theNewTile->itsFringeFlag			= false;
+	theNewTile->itsGroupIndex			= CAYLEY_NO_ELEMENT;
+
+	//	Add theNewTile to the hash table.
+	theNewTile->itsHashValue	= HashGridCell(	HashGridCoordinate(aMatrix->m[3][0]),
+												HashGridCoordinate(aMatrix->m[3][1]),
+												HashGridCoordinate(aMatrix->m[3][2]));
+	theBucket					= &aTiling->itsHashBuckets[theNewTile->itsHashValue & (aTiling->itsNumHashBuckets - 1)];
+	theNewTile->itsHashNext		= *theBucket;
+	*theBucket					= theNewTile;
+
+	//	Put theNewTile onto the end of the list of all tiles.
+	//	If the to-be-processed queue had run empty,
+	//	theNewTile becomes its first (and only) element.
+	if (aTiling->itsLastTile != NULL)
+	{
+		aTiling->itsLastTile->itsNext = theNewTile;
+	}
+	else
+	{
+		aTiling->itsFirstTile = theNewTile;
+	}
+	theNewTile->itsNext		= NULL;
+	aTiling->itsLastTile	= theNewTile;
+	if (aTiling->itsQueueFirst == NULL)
+		aTiling->itsQueueFirst = theNewTile;
 
-	//	Add theNewTile to the tree.
+	//	Update the tile count.
+	aTiling->itsNumTiles++;
+
+	return NULL;
+}
 
-	theNewTile->itsLeftChild	= NULL;
-	theNewTile->itsRightChild	= NULL;
 
-	theNewLocation = &aTiling->itsTree;
-	while (*theNewLocation != NULL)
+static ErrorText GrowHashTable(TilingInProgress *aTiling)
+{
+	unsigned int	theNewNumHashBuckets,
+					i;
+	Tile			**theNewHashBuckets,
+					*theTile,
+					**theBucket;
+
+	//	Double the number of buckets.
+	theNewNumHashBuckets = 2 * aTiling->itsNumHashBuckets;
+	if (theNewNumHashBuckets <= aTiling->itsNumHashBuckets)	//	overflow?
+		return u"Too many tiles in GrowHashTable().";
+
+	theNewHashBuckets = (Tile **) GET_MEMORY(theNewNumHashBuckets * sizeof(Tile *));
+	if (theNewHashBuckets == NULL)
+		return u"Couldn't get memory for a larger hash table in GrowHashTable().";
+	for (i = 0; i < theNewNumHashBuckets; i++)
+		theNewHashBuckets[i] = NULL;
+
+	//	Redistribute the Tiles.  Each Tile remembers its full hash value,
+	//	so there's no need to recompute it.
+	for (theTile = aTiling->itsFirstTile; theTile != NULL; theTile = theTile->itsNext)
 	{
-		if (aSortKey < (*theNewLocation)->itsSortKey)
-			theNewLocation = &(*theNewLocation)->itsLeftChild;
-		else
-			theNewLocation = &(*theNewLocation)->itsRightChild;
+		theBucket				= &theNewHashBuckets[theTile->itsHashValue & (theNewNumHashBuckets - 1)];
+		theTile->itsHashNext	= *theBucket;
+		*theBucket				= theTile;
 	}
-	*theNewLocation = theNewTile;
 
-	//	Put theNewTile onto the end of the to-be-processed queue.
-	if (aTiling->itsQueueLast != NULL)
+	FREE_MEMORY_SAFELY(aTiling->itsHashBuckets);
+	aTiling->itsHashBuckets		= theNewHashBuckets;
+	aTiling->itsNumHashBuckets	= theNewNumHashBuckets;
+
+	return NULL;
+}
+
+
+static ErrorText ExpandFrontier(
+	TilingInProgress	*aTiling,
+	MatrixList			*aGeneratorList,
+	double				aTilingRadius)
+{
+	ErrorText		theErrorMessage	= NULL;
+	unsigned int	theFrontierSize,
+					theNumGenerators,
+					theNumThreads,
+					i,
+					j;
+	Tile			**theFrontier	= NULL,
+					*theTile;
+	Matrix			*theNeighbors	= NULL;
+	Candidate		*theCandidates	= NULL,
+					*theCandidate;
+	FrontierSlice	theSlices[MAX_TILING_THREADS];
+	pthread_t		theThreads[MAX_TILING_THREADS];
+	bool			theThreadStarted[MAX_TILING_THREADS];
+
+	//	The frontier consists of all Tiles from itsQueueFirst
+	//	to the end of the list.  Copy their addresses into an array,
+	//	so we may divide the frontier into slices.
+	theFrontierSize = 0;
+	for (theTile = aTiling->itsQueueFirst; theTile != NULL; theTile = theTile->itsNext)
+		theFrontierSize++;
+
+	theFrontier = (Tile **) GET_MEMORY(theFrontierSize * sizeof(Tile *));
+	if (theFrontier == NULL)
+		return u"Couldn't get memory for the frontier in ExpandFrontier().";
+	for (theTile = aTiling->itsQueueFirst, i = 0; theTile != NULL; theTile = theTile->itsNext, i++)
+		theFrontier[i] = theTile;
+
+	//	The Tiles we add below will form the next frontier.
+	aTiling->itsQueueFirst = NULL;
+
+	//	With no generators, no tile has any neighbors.
+	theNumGenerators = aGeneratorList->itsNumMatrices;
+	if (theNumGenerators == 0)
+		goto CleanUpExpandFrontier;
+
+	//	Each Tile yields at most one Candidate per generator,
+	//	so one allocation here holds every slice's Candidates,
+	//	and another holds every slice's neighbor scratch space.
+	if (theFrontierSize > 0xFFFFFFFF / theNumGenerators)
 	{
-		aTiling->itsQueueLast->itsQueueNext = theNewTile;
+		theErrorMessage = u"Too many candidates in ExpandFrontier().";
+		goto CleanUpExpandFrontier;
 	}
-	else
+	theNumThreads = NumTilingThreads(theFrontierSize);
+	theCandidates = (Candidate *) GET_MEMORY((size_t) theFrontierSize * theNumGenerators * sizeof(Candidate));
+	theNeighbors  = (Matrix *)    GET_MEMORY((size_t) theNumThreads   * theNumGenerators * sizeof(Matrix));
+	if (theCandidates == NULL || theNeighbors == NULL)
 	{
-		aTiling->itsQueueFirst = theNewTile;
+		theErrorMessage = u"Couldn't get memory for the candidates in ExpandFrontier().";
+		goto CleanUpExpandFrontier;
 	}
-	theNewTile->itsQueueNext	= NULL;
-	aTiling->itsQueueLast		= theNewTile;
 
-	//	Update the tile count.
-	aTiling->itsNumTiles++;
+	//	Parallel phase
+	//
+	//	Let each worker thread multiply the Tiles in its slice
+	//	of the frontier by each generator, and report the Candidates
+	//	that don't translate too far and aren't already in the tiling.
+	//	The tiling itself remains read-only throughout this phase,
+	//	so the workers may consult its hash table without any locks.
+	//
+	for (i = 0; i < theNumThreads; i++)
+	{
+		theSlices[i].itsTiling				= aTiling;
+		theSlices[i].itsGeneratorList		= aGeneratorList;
+		theSlices[i].itsTilingRadius		= aTilingRadius;
+		theSlices[i].itsFrontier			= theFrontier;
+		theSlices[i].itsFrontierStart		= (unsigned int)( ((uint64_t) theFrontierSize *  i     ) / theNumThreads );
+		theSlices[i].itsFrontierStop		= (unsigned int)( ((uint64_t) theFrontierSize * (i + 1)) / theNumThreads );
+		theSlices[i].itsNeighbors			= theNeighbors + i * theNumGenerators;
+		theSlices[i].itsNumCandidates		= 0;
+		theSlices[i].itsCandidateCapacity	= (theSlices[i].itsFrontierStop - theSlices[i].itsFrontierStart) * theNumGenerators;
+		theSlices[i].itsCandidates			= theCandidates + theSlices[i].itsFrontierStart * theNumGenerators;
+		theSlices[i].itsErrorMessage		= NULL;
+		theThreadStarted[i]					= false;
+	}
 
-	return NULL;
+	//		Hand slices 1 through theNumThreads - 1 to new threads,
+	//		and process slice 0 on the present thread.
+	//		If a thread won't start, process its slice here instead.
+	for (i = 1; i < theNumThreads; i++)
+	{
+		theThreadStarted[i] = (pthread_create(&theThreads[i], NULL, ExpandFrontierSlice, &theSlices[i]) == 0);
+	}
+	for (i = 0; i < theNumThreads; i++)
+	{
+		if ( ! theThreadStarted[i] )
+			(void) ExpandFrontierSlice(&theSlices[i]);
+	}
+	for (i = 1; i < theNumThreads; i++)
+	{
+		if (theThreadStarted[i])
+			pthread_join(theThreads[i], NULL);
+	}
+
+	//	Serial phase
+	//
+	//	Add the Candidates to the tiling, in order.
+	//	Two Tiles in the same frontier may well have produced
+	//	the same Candidate, so check each Candidate once again.
+	//	Because the slices are contiguous and we merge them in order,
+	//	the Tiles get added in exactly the order that
+	//	a single-threaded breadth-first search would have added them.
+	//
+	for (i = 0; i < theNumThreads; i++)
+	{
+		if (theSlices[i].itsErrorMessage != NULL)
+		{
+			theErrorMessage = theSlices[i].itsErrorMessage;
+			goto CleanUpExpandFrontier;
+		}
+
+		for (j = 0; j < theSlices[i].itsNumCandidates; j++)
+		{
+			theCandidate = &theSlices[i].itsCandidates[j];
+
+			//	Reject candidates already found earlier in this frontier.
+			if (TilingFindMatrix(aTiling, &theCandidate->itsMatrix) != NULL)
+				continue;
+
+			//	Add the candidate to the tiling.
+			theErrorMessage = AddToTiling(	aTiling,
+											&theCandidate->itsMatrix,
+											theCandidate->itsTranslationDistance);
+			if (theErrorMessage != NULL)
+				goto CleanUpExpandFrontier;
+		}
+	}
+
+CleanUpExpandFrontier:
+
+	FREE_MEMORY_SAFELY(theNeighbors);
+	FREE_MEMORY_SAFELY(theCandidates);
+	FREE_MEMORY_SAFELY(theFrontier);
+
+	return theErrorMessage;
 }
 
 
-static Tile *GetTileFromQueue(TilingInProgress *aTiling)
+static unsigned int NumTilingThreads(unsigned int aFrontierSize)
 {
-	//	Remove the first Tile from the to-be-processed queue,
-	//	but do *not* remove it from the permanent data structure.
-
-	Tile	*theTile;
+	long			theNumProcessors;
+	unsigned int	theNumThreads;
+
+	theNumProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+	if (theNumProcessors < 1)
+		theNumProcessors = 1;
+	if (theNumProcessors > MAX_TILING_THREADS)
+		theNumProcessors = MAX_TILING_THREADS;
+
+	theNumThreads = aFrontierSize / MIN_FRONTIER_TILES_PER_THREAD;
+	if (theNumThreads > (unsigned int) theNumProcessors)
+		theNumThreads = (unsigned int) theNumProcessors;
+	if (theNumThreads < 1)
+		theNumThreads = 1;
+
+	return theNumThreads;
+}
 
-	theTile = aTiling->itsQueueFirst;
 
-	if (theTile != NULL)
+static void *ExpandFrontierSlice(void *aFrontierSlice)
+{
+	FrontierSlice	*theSlice;
+	unsigned int	theNumGenerators,
+					i,
+					j;
+	Tile			*theTile;
+	Matrix			*theNeighbors;
+	double			theTranslationDistance;
+
+	//	ExpandFrontierSlice() may run on a worker thread,
+	//	so it uses only the buffers that ExpandFrontier() provides.
+	theSlice			= (FrontierSlice *) aFrontierSlice;
+	theNumGenerators	= theSlice->itsGeneratorList->itsNumMatrices;
+	theNeighbors		= theSlice->itsNeighbors;
+
+	//	For each Tile in the slice...
+	for (i = theSlice->itsFrontierStart; i < theSlice->itsFrontierStop; i++)
 	{
-		aTiling->itsQueueFirst = theTile->itsQueueNext;
-		if (aTiling->itsQueueFirst == NULL)
-			aTiling->itsQueueLast = NULL;
-		theTile->itsQueueNext = NULL;
+		theTile = theSlice->itsFrontier[i];
+
+		//	...pre-multiplying (not post-multiplying!) the tile's matrix
+		//	by each generator yields the tile's neighbors.
+		//	Compute them all in one batch.
+		MatricesTimesMatrix(theNumGenerators,
+							theSlice->itsGeneratorList->itsMatrices,
+							&theTile->itsMatrix,
+							theNeighbors);
+
+		//	Consider each neighbor in turn.
+		for (j = 0; j < theNumGenerators; j++)
+		{
+			//	Note the candidate's translation distance.
+			theTranslationDistance = TranslationDistance(&theNeighbors[j]);
+
+			//	Reject candidates that translate too far,
+			//	but remember that theTile sits on the fringe of the tiling.
+			//	Each worker thread touches only its own slice's Tiles,
+			//	so setting the flag requires no lock.
+			if (theTranslationDistance > theSlice->itsTilingRadius)
+			{
+				theTile->itsFringeFlag = true;
+				continue;
+			}
+
+			//	Reject candidates already found in earlier frontiers.
+			if (TilingFindMatrix(theSlice->itsTiling, &theNeighbors[j]) != NULL)
+				continue;
+
+			//	Report the candidate.
+			theSlice->itsErrorMessage = AddCandidate(theSlice, &theNeighbors[j], theTranslationDistance);
+			if (theSlice->itsErrorMessage != NULL)
+				return NULL;
+		}
 	}
 
-	return theTile;
+	return NULL;
+}
+
+
+static ErrorText AddCandidate(
+	FrontierSlice	*aSlice,
+	Matrix			*aMatrix,
+	double			aTranslationDistance)
+{
+	//	ExpandFrontier() left room for one Candidate
+	//	per generator per Tile, so this should never fail.
+	if (aSlice->itsNumCandidates == aSlice->itsCandidateCapacity)
+		return u"Grave error:  too many candidates in AddCandidate().";
+
+	aSlice->itsCandidates[aSlice->itsNumCandidates].itsMatrix				= *aMatrix;
+	aSlice->itsCandidates[aSlice->itsNumCandidates].itsTranslationDistance	= aTranslationDistance;
+	aSlice->itsNumCandidates++;
+
+	return NULL;
 }
 
 
-static double TranslationDistance(Matrix *aMatrix)
+double TranslationDistance(Matrix *aMatrix)
 {
+	//	How far does aMatrix move the origin (0,0,0,1) ?
 	//	Spherical case O(4)
 	if (aMatrix->m[3][3] <  1.0)
 		return SafeAcos(aMatrix->m[3][3]);
@@ -427,69 +1100,67 @@ static double TranslationDistance(Matrix *aMatrix)
 }
 
 
-static bool TreeContainsMatrix(
-	Tile	*aTree,
-	Matrix	*aMatrix,
-	double	aSortKey)
+static Tile *TilingFindMatrix(
+	TilingInProgress	*aTiling,
+	Matrix				*aMatrix)
 {
-	Tile	*theTile;
-
-	//	Does the given matrix already appear on the tree?
-	//	This seemingly simple tree search is complicated by the fact
-	//	that we know the sort key values only up to some numerical error,
-	//	which may be substantial in the hyperbolic case.
+	int64_t			theLow[3],
+					theHigh[3],
+					i,
+					j,
+					k;
+	unsigned int	c;
+	Tile			*theTile;
+
+	//	Does the given matrix already appear in the tiling?
+	//	If so, return the Tile containing it, otherwise return NULL.
+	//	If it does appear, the stored copy's image of the origin
+	//	will differ from aMatrix's image of the origin by at most
+	//	TILING_EPSILON in each coordinate.  So we must probe
+	//	every grid cell that meets the box of radius TILING_EPSILON
+	//	centered at aMatrix's image of the origin.
+	//	Because HASH_GRID_CELL_SIZE is much larger than TILING_EPSILON,
+	//	and HASH_GRID_OFFSET keeps the simple coordinates of flat
+	//	translations (and of the identity) away from the cell boundaries,
+	//	that box usually meets a single grid cell, and only occasionally
+	//	straddles a boundary to meet two, four or eight of them.
+	for (c = 0; c < 3; c++)
+	{
+		theLow[c]	= HashGridCoordinate(aMatrix->m[3][c] - TILING_EPSILON);
+		theHigh[c]	= HashGridCoordinate(aMatrix->m[3][c] + TILING_EPSILON);
+	}
 
-	theTile = aTree;
-	while (theTile != NULL)
+	for (i = theLow[0]; i <= theHigh[0]; i++)
 	{
-		if (aSortKey < theTile->itsSortKey - SORT_KEY_EPSILON)
-		{
-			theTile = theTile->itsLeftChild;
-		}
-		else
-		if (aSortKey > theTile->itsSortKey + SORT_KEY_EPSILON)
-		{
-			theTile = theTile->itsRightChild;
-		}
-		else
+		for (j = theLow[1]; j <= theHigh[1]; j++)
 		{
-			//	The sort keys match to within SORT_KEY_EPSILON.
-
-			//	If we've found the desired matrix, we're done.
-			if (MatrixEquality(	&theTile->itsMatrix,
-								aMatrix,
-								TILING_EPSILON))
-				return true;
-
-			//	Otherwise the desired matrix could be on the left subtree,
-			//	on the right subtree, or not on the tree at all.
-			//	In practice the algorithm never reaches this point
-			//	(at least not for the Poincaré dodecahedral space,
-			//	the cubic 3-torus or a radius=6 hyperbolic tiling
-			//	by mirrored dodecahedra), but it's good to have
-			//	this code in place in case it's ever needed.
-			//	One wouldn't want to call it often, though, because
-			//	the forking could easily slow an otherwise fast search
-			//	to a near halt.
-			return TreeContainsMatrix(theTile->itsLeftChild,  aMatrix, aSortKey)
-				|| TreeContainsMatrix(theTile->itsRightChild, aMatrix, aSortKey);
+			for (k = theLow[2]; k <= theHigh[2]; k++)
+			{
+				for (theTile = aTiling->itsHashBuckets[HashGridCell(i, j, k) & (aTiling->itsNumHashBuckets - 1)];
+					 theTile != NULL;
+					 theTile = theTile->itsHashNext)
+				{
+					if (MatrixEquality(	&theTile->itsMatrix,
+										aMatrix,
+										TILING_EPSILON))
+						return theTile;
+				}
+			}
 		}
 	}
 
-	return false;
+	return NULL;
 }
 
 
 static void CopyPointersToArray(
-	Tile	*aTree,		//	read from here
+	Tile	*aTileList,	//	read from here
 	Tile	***anArray)	//	write to here
 {
-	if (aTree != NULL)
-	{
-		*(*anArray)++ = aTree;
-		CopyPointersToArray(aTree->itsLeftChild,  anArray);
-		CopyPointersToArray(aTree->itsRightChild, anArray);
-	}
+	Tile	*theTile;
+
+	for (theTile = aTileList; theTile != NULL; theTile = theTile->itsNext)
+		*(*anArray)++ = theTile;
 }
 
 
@@ -512,28 +1183,378 @@ static __cdecl signed int CompareTranslationDistances(
 }
 
 
+ErrorText ConstructCayleyTable(
+	TilingInProgress	*aTiling,			//	input, must tile all of a finite group
+	MatrixList			*aHolonomyGroup,	//	input, from the latest CopyTilingToHolonomyGroup(aTiling)
+	CayleyTable			**aCayleyTable)		//	output, to be freed with FreeCayleyTable()
+{
+	ErrorText		theErrorMessage			= NULL;
+	MatrixList		*theGenerators;
+	unsigned int	theNumElements,
+					theNumGenerators,
+					e,
+					f,
+					g,
+					theQueueStart,
+					theQueueEnd;
+	Matrix			theIdentityMatrix,
+					theAntipodalMatrix,
+					*theProducts			= NULL;
+	Tile			*theTile;
+	unsigned int	*theParents				= NULL,
+					*theParentGenerators	= NULL,
+					*theQueue				= NULL;
+
+	if (*aCayleyTable != NULL)
+		return u"ConstructCayleyTable() received a non-NULL output location.";
+
+	theGenerators		= aTiling->itsExtendedGeneratorList;
+	theNumElements		= aHolonomyGroup->itsNumMatrices;
+	theNumGenerators	= theGenerators->itsNumMatrices;
+
+	//	The Tiles' group indices refer to aHolonomyGroup
+	//	only if it's a copy of the tiling as it now stands.
+	if (theNumElements != aTiling->itsNumTiles)
+		return u"ConstructCayleyTable() received a holonomy group that doesn't match the tiling.";
+
+	if (theNumGenerators > 0
+	 && theNumElements > 0xFFFFFFFF / sizeof(unsigned int) / theNumGenerators)	//	for safety
+		return u"The holonomy group is too large for a Cayley table in ConstructCayleyTable().";
+
+	*aCayleyTable = (CayleyTable *) GET_MEMORY(sizeof(CayleyTable));
+	if (*aCayleyTable == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the CayleyTable in ConstructCayleyTable().";
+		goto CleanUpConstructCayleyTable;
+	}
+	(*aCayleyTable)->itsNumElements			= theNumElements;
+	(*aCayleyTable)->itsNumGenerators		= theNumGenerators;
+	(*aCayleyTable)->itsProducts			= NULL;
+	(*aCayleyTable)->itsIdentityElement		= CAYLEY_NO_ELEMENT;
+	(*aCayleyTable)->itsAntipodalElement	= CAYLEY_NO_ELEMENT;
+
+	//	The 3-sphere has no generators, and so no products.
+	if (theNumGenerators > 0)
+	{
+		(*aCayleyTable)->itsProducts	= (unsigned int *) GET_MEMORY(theNumGenerators * theNumElements * sizeof(unsigned int));
+		theProducts						= (Matrix *)       GET_MEMORY(theNumGenerators * sizeof(Matrix));
+		if ((*aCayleyTable)->itsProducts == NULL
+		 || theProducts == NULL)
+		{
+			theErrorMessage = u"Couldn't get memory for the products in ConstructCayleyTable().";
+			goto CleanUpConstructCayleyTable;
+		}
+	}
+	theParents			= (unsigned int *) GET_MEMORY(theNumElements * sizeof(unsigned int));
+	theParentGenerators	= (unsigned int *) GET_MEMORY(theNumElements * sizeof(unsigned int));
+	theQueue			= (unsigned int *) GET_MEMORY(theNumElements * sizeof(unsigned int));
+	if (theParents == NULL
+	 || theParentGenerators == NULL
+	 || theQueue == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the search tree in ConstructCayleyTable().";
+		goto CleanUpConstructCayleyTable;
+	}
+
+	//	Locate the identity.
+	MatrixIdentity(&theIdentityMatrix);
+	theTile = TilingFindMatrix(aTiling, &theIdentityMatrix);
+	if (theTile == NULL)
+	{
+		theErrorMessage = u"The holonomy group lacks the identity in ConstructCayleyTable().";
+		goto CleanUpConstructCayleyTable;
+	}
+	(*aCayleyTable)->itsIdentityElement = theTile->itsGroupIndex;
+
+	//	Multiply each element by all the generators at once,
+	//	and look up each product in the tiling's hash table.
+	//	Every product must already be present, otherwise
+	//	the tiling doesn't contain the whole group.
+	//	These are the only matrix comparisons the table needs.
+	for (e = 0; e < theNumElements; e++)
+	{
+		MatricesTimesMatrix(theNumGenerators,
+							theGenerators->itsMatrices,
+							&aHolonomyGroup->itsMatrices[e],
+							theProducts);
+
+		for (g = 0; g < theNumGenerators; g++)
+		{
+			theTile = TilingFindMatrix(aTiling, &theProducts[g]);
+			if (theTile == NULL)
+			{
+				theErrorMessage = u"The holonomy group didn't close up in ConstructCayleyTable().";
+				goto CleanUpConstructCayleyTable;
+			}
+
+			(*aCayleyTable)->itsProducts[g*theNumElements + e] = theTile->itsGroupIndex;
+		}
+	}
+
+	//	Spell each element as a word in the generators,
+	//	by recording which neighbor first reached it
+	//	in a breadth-first search outward from the identity.
+	for (e = 0; e < theNumElements; e++)
+		theParents[e] = CAYLEY_NO_ELEMENT;
+	theParents[(*aCayleyTable)->itsIdentityElement] = (*aCayleyTable)->itsIdentityElement;
+	theQueue[0]		= (*aCayleyTable)->itsIdentityElement;
+	theQueueStart	= 0;
+	theQueueEnd		= 1;
+	while (theQueueStart < theQueueEnd)
+	{
+		e = theQueue[theQueueStart++];
+		for (g = 0; g < theNumGenerators; g++)
+		{
+			f = (*aCayleyTable)->itsProducts[g*theNumElements + e];
+			if (theParents[f] == CAYLEY_NO_ELEMENT)
+			{
+				theParents[f]			= e;
+				theParentGenerators[f]	= g;
+				theQueue[theQueueEnd++]	= f;
+			}
+		}
+	}
+	if (theQueueEnd != theNumElements)
+	{
+		theErrorMessage = u"The generators don't reach every tile in ConstructCayleyTable().";
+		goto CleanUpConstructCayleyTable;
+	}
+
+	//	The antipodal map is an involution, so test only
+	//	the elements whose squares the table shows to be the identity.
+	//	A manifold's group acts freely, so its only possible involution
+	//	is the antipodal map itself, but an orbifold's reflections
+	//	and half-turns are involutions too, so confirm each candidate's matrix.
+	MatrixAntipodalMap(&theAntipodalMatrix);
+	for (e = 0; e < theNumElements; e++)
+	{
+		if (e != (*aCayleyTable)->itsIdentityElement
+		 && CayleyProduct(*aCayleyTable, theParents, theParentGenerators, theQueue, e, e)
+				== (*aCayleyTable)->itsIdentityElement
+		 && MatrixEquality(&aHolonomyGroup->itsMatrices[e], &theAntipodalMatrix, ANTIPODAL_EPSILON))
+		{
+			(*aCayleyTable)->itsAntipodalElement = e;
+			break;
+		}
+	}
+
+CleanUpConstructCayleyTable:
+
+	if (theErrorMessage != NULL)
+		FreeCayleyTable(aCayleyTable);
+
+	FREE_MEMORY_SAFELY(theProducts);
+	FREE_MEMORY_SAFELY(theParents);
+	FREE_MEMORY_SAFELY(theParentGenerators);
+	FREE_MEMORY_SAFELY(theQueue);
+
+	return theErrorMessage;
+}
+
+
+static unsigned int CayleyProduct(
+	CayleyTable		*aCayleyTable,
+	unsigned int	*someParents,			//	breadth-first search tree from ConstructCayleyTable()
+	unsigned int	*someParentGenerators,
+	unsigned int	*aWordBuffer,			//	scratch space for itsNumElements letters
+	unsigned int	anElement,
+	unsigned int	aFactor)
+{
+	unsigned int	theWordLength,
+					theProduct;
+
+	//	Follow the search tree from anElement back to the identity,
+	//	to write anElement = g₀ g₁ … gₙ₋₁ as a word in the generators.
+	theWordLength = 0;
+	while (anElement != aCayleyTable->itsIdentityElement)
+	{
+		aWordBuffer[theWordLength++]	= someParentGenerators[anElement];
+		anElement						= someParents[anElement];
+	}
+
+	//	anElement times aFactor is then g₀ (g₁ ( … (gₙ₋₁ aFactor))),
+	//	which the table evaluates one generator at a time.
+	theProduct = aFactor;
+	while (theWordLength > 0)
+		theProduct = aCayleyTable->itsProducts[aWordBuffer[--theWordLength]*aCayleyTable->itsNumElements + theProduct];
+
+	return theProduct;
+}
+
+
+void FreeCayleyTable(
+	CayleyTable	**aCayleyTable)
+{
+	if (aCayleyTable == NULL
+	 || *aCayleyTable == NULL)
+		return;
+
+	FREE_MEMORY_SAFELY((*aCayleyTable)->itsProducts);
+	FREE_MEMORY_SAFELY(*aCayleyTable);
+}
+
+
+size_t CayleyTableCacheSize(
+	CayleyTable	*aCayleyTable)
+{
+	if (aCayleyTable == NULL)
+		return 0;
+
+	return sizeof(CachedCayleyTableHeader)
+		 + (size_t) aCayleyTable->itsNumGenerators * aCayleyTable->itsNumElements * sizeof(uint32_t);
+}
+
+
+ErrorText WriteCayleyTableCache(
+	CayleyTable	*aCayleyTable,	//	input
+	Byte		*aBuffer,		//	output, of length CayleyTableCacheSize(aCayleyTable)
+	size_t		aBufferSize)
+{
+	CachedCayleyTableHeader	theHeader;
+	Byte					*theWriteLocation;
+	size_t					i,
+							theNumProducts;
+	uint32_t				theProduct;
+
+	if (aCayleyTable == NULL)
+		return NULL;	//	nothing to write
+
+	if (aBufferSize != CayleyTableCacheSize(aCayleyTable))
+		return u"WriteCayleyTableCache() received a buffer of the wrong size.";
+
+	theHeader.itsNumElements		= aCayleyTable->itsNumElements;
+	theHeader.itsNumGenerators		= aCayleyTable->itsNumGenerators;
+	theHeader.itsIdentityElement	= aCayleyTable->itsIdentityElement;
+	theHeader.itsAntipodalElement	= aCayleyTable->itsAntipodalElement;
+
+	theWriteLocation = aBuffer;
+	memcpy(theWriteLocation, &theHeader, sizeof(theHeader));
+	theWriteLocation += sizeof(theHeader);
+
+	//	The products are small integers, so unlike the matrices
+	//	in a cached tiling they survive the round trip exactly.
+	theNumProducts = (size_t) aCayleyTable->itsNumGenerators * aCayleyTable->itsNumElements;
+	for (i = 0; i < theNumProducts; i++)
+	{
+		theProduct = aCayleyTable->itsProducts[i];
+		memcpy(theWriteLocation, &theProduct, sizeof(theProduct));
+		theWriteLocation += sizeof(theProduct);
+	}
+
+	if (theWriteLocation != aBuffer + aBufferSize)
+		return u"Grave error while writing cache in WriteCayleyTableCache().";
+
+	return NULL;
+}
+
+
+ErrorText ReadCayleyTableCache(
+	const Byte	*aBuffer,		//	input
+	size_t		aBufferSize,
+	CayleyTable	**aCayleyTable)	//	output, to be freed with FreeCayleyTable()
+{
+	ErrorText				theErrorMessage	= NULL;
+	CachedCayleyTableHeader	theHeader;
+	const Byte				*theReadLocation;
+	bool					*theSeenFlags	= NULL;
+	unsigned int			e,
+							g;
+	uint32_t				theProduct;
+
+	if (*aCayleyTable != NULL)
+		return u"ReadCayleyTableCache() received a non-NULL output location.";
+
+	if (aBufferSize < sizeof(theHeader))
+		return u"The cached Cayley table is corrupt.";
+	memcpy(&theHeader, aBuffer, sizeof(theHeader));
+	theReadLocation = aBuffer + sizeof(theHeader);
+
+	if (theHeader.itsNumElements == 0
+	 || theHeader.itsIdentityElement >= theHeader.itsNumElements
+	 || (theHeader.itsAntipodalElement >= theHeader.itsNumElements
+	  && theHeader.itsAntipodalElement != CAYLEY_NO_ELEMENT)
+	 || theHeader.itsNumGenerators > (aBufferSize / sizeof(uint32_t)) / theHeader.itsNumElements	//	for safety
+	 || aBufferSize != sizeof(theHeader) + (size_t) theHeader.itsNumGenerators * theHeader.itsNumElements * sizeof(uint32_t))
+		return u"The cached Cayley table is corrupt.";
+
+	*aCayleyTable = (CayleyTable *) GET_MEMORY(sizeof(CayleyTable));
+	if (*aCayleyTable == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the CayleyTable in ReadCayleyTableCache().";
+		goto CleanUpReadCayleyTableCache;
+	}
+	(*aCayleyTable)->itsNumElements			= theHeader.itsNumElements;
+	(*aCayleyTable)->itsNumGenerators		= theHeader.itsNumGenerators;
+	(*aCayleyTable)->itsProducts			= NULL;
+	(*aCayleyTable)->itsIdentityElement		= theHeader.itsIdentityElement;
+	(*aCayleyTable)->itsAntipodalElement	= theHeader.itsAntipodalElement;
+
+	if (theHeader.itsNumGenerators > 0)
+	{
+		(*aCayleyTable)->itsProducts = (unsigned int *) GET_MEMORY((size_t) theHeader.itsNumGenerators * theHeader.itsNumElements * sizeof(unsigned int));
+		if ((*aCayleyTable)->itsProducts == NULL)
+		{
+			theErrorMessage = u"Couldn't get memory for the products in ReadCayleyTableCache().";
+			goto CleanUpReadCayleyTableCache;
+		}
+	}
+	theSeenFlags = (bool *) GET_MEMORY(theHeader.itsNumElements * sizeof(bool));
+	if (theSeenFlags == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the permutation check in ReadCayleyTableCache().";
+		goto CleanUpReadCayleyTableCache;
+	}
+
+	//	Multiplication by a group element permutes the group,
+	//	so accept each generator's row only if it's a permutation.
+	for (g = 0; g < theHeader.itsNumGenerators; g++)
+	{
+		for (e = 0; e < theHeader.itsNumElements; e++)
+			theSeenFlags[e] = false;
+
+		for (e = 0; e < theHeader.itsNumElements; e++)
+		{
+			memcpy(&theProduct, theReadLocation, sizeof(theProduct));
+			theReadLocation += sizeof(theProduct);
+
+			if (theProduct >= theHeader.itsNumElements
+			 || theSeenFlags[theProduct])
+			{
+				theErrorMessage = u"The cached Cayley table is corrupt.";
+				goto CleanUpReadCayleyTableCache;
+			}
+			theSeenFlags[theProduct] = true;
+
+			(*aCayleyTable)->itsProducts[g*theHeader.itsNumElements + e] = theProduct;
+		}
+	}
+
+CleanUpReadCayleyTableCache:
+
+	if (theErrorMessage != NULL)
+		FreeCayleyTable(aCayleyTable);
+
+	FREE_MEMORY_SAFELY(theSeenFlags);
+
+	return theErrorMessage;
+}
+
+
 ErrorText NeedsBackHemisphere(
-	MatrixList	*aHolonomyGroup,			//	input
+	CayleyTable	*aCayleyTable,				//	input, needed only for spherical spaces
 	SpaceType	aSpaceType,					//	input
 	bool		*aDrawBackHemisphereFlag)	//	output
 {
-	unsigned int	i;
-
-	//	Test for missing input.
-	if (aHolonomyGroup == NULL)
-		return u"NULL matrix list passed to NeedsBackHemisphere().";
-
 	if (aSpaceType == SpaceSpherical)
 	{
+		//	Test for missing input.
+		if (aCayleyTable == NULL)
+			return u"NULL Cayley table passed to NeedsBackHemisphere().";
+
 		//	If the antipodal matrix is present the scenery will be
 		//	antipodally symmetric and there'll be no need to draw
 		//	the back hemisphere.
-
-		*aDrawBackHemisphereFlag = true;
-
-		for (i = 0; i < aHolonomyGroup->itsNumMatrices; i++)
-			if (fabs(aHolonomyGroup->itsMatrices[i].m[3][3] - (-1.0)) < ANTIPODAL_EPSILON)
-				*aDrawBackHemisphereFlag = false;
+		*aDrawBackHemisphereFlag = (aCayleyTable->itsAntipodalElement == CAYLEY_NO_ELEMENT);
 	}
 	else
 	{
@@ -543,4 +1564,3 @@ ErrorText NeedsBackHemisphere(
 
 	return NULL;
 }
-
@@ -11,21 +11,49 @@
 
 enum
 {
-	VertexAttributePosition		= 0,
-	VertexAttributeTexCoords	= 1,
-	VertexAttributeColor		= 2
+	VertexAttributePosition			= 0,
+	VertexAttributeTexCoords		= 1,
+	VertexAttributeColor			= 2,
+	VertexAttributeClosedPosition	= 3,	//	only for meshes with apertures
+	VertexAttributeClosedTexCoords	= 4		//	only for meshes with apertures
 };
 
 enum
 {
-	BufferIndexVertexAttributes	= 0,
-	BufferIndexTilingGroup		= 1,
-	BufferIndexUniforms			= 2
+	BufferIndexVertexAttributes		= 0,
+	BufferIndexTilingGroup			= 1,	//	indices of the visible cells
+	BufferIndexUniforms				= 2,
+	BufferIndexHoneycombCells		= 3,	//	all the honeycomb's cells
+	BufferIndexMeshPlacement		= 4,	//	the mesh's own placement within its cell
+	BufferIndexApertureAttributes	= 5		//	fully-closed positions and texture coordinates
 };
 
 enum
 {
-	TextureIndexPrimary	= 0
+	BufferIndexCullUniforms			= 0,
+	BufferIndexCullCells			= 1,
+	BufferIndexCullSortEntries		= 2,
+	BufferIndexCullResults			= 3,
+	BufferIndexCullPlainTiles		= 4,
+	BufferIndexCullReflectedTiles	= 5,
+	BufferIndexCullFullTiles		= 6,
+	BufferIndexCullSortStage		= 7
+};
+
+enum
+{
+	TextureIndexPrimary					= 0,
+	TextureIndexTransparencyAccumulation	= 1,	//	only for the transparency composite
+	TextureIndexTransparencyRevealage	= 2		//	only for the transparency composite
+};
+
+//	Order-independent transparency accumulates the partially transparent
+//	fragments in two extra color attachments alongside the usual one.
+enum
+{
+	ColorAttachmentIndexPrimary						= 0,
+	ColorAttachmentIndexTransparencyAccumulation	= 1,	//	Σ w·(αR,αG,αB,α)
+	ColorAttachmentIndexTransparencyRevealage		= 2		//	Π (1 - α)
 };
 enum
 {
@@ -33,11 +61,30 @@ enum
 };
 
 
+//	A stereo pair renders MAX_NUM_VIEWS views (the left eye's and
+//	the right eye's) in a single pass, into the slices of
+//	a layered render target.  A single view uses only the first
+//	entry of each per-view array.
+#define MAX_NUM_VIEWS	2
+
 typedef struct
 {
-	simd_float4x4	itsProjectionMatrixForBoxFull,
-					itsProjectionMatrixForBoxFront,
-					itsProjectionMatrixForBoxBack;
+	//	The vertex function composes each cell's tiling matrix
+	//	with the view's view matrix (or, when rendering the back hemisphere,
+	//	with the antipodal map and the view's view matrix).
+	simd_float4x4	itsViewMatrix[MAX_NUM_VIEWS],
+					itsInvertedViewMatrix[MAX_NUM_VIEWS];
+
+	simd_float4x4	itsProjectionMatrixForBoxFull[MAX_NUM_VIEWS],
+					itsProjectionMatrixForBoxFront[MAX_NUM_VIEWS],
+					itsProjectionMatrixForBoxBack[MAX_NUM_VIEWS];
+
+	//	The vertex function opens the Dirichlet walls' apertures
+	//	by interpolating between each vertex's fully-closed
+	//	and fully-open positions, and then normalizes the result
+	//	by dividing by sqrt(w² + itsCurvature·(x² + y² + z²)).
+	float			itsAperture,	//	0.0 (fully closed) to 1.0 (fully open)
+					itsCurvature;	//	+1 spherical, 0 flat, -1 hyperbolic
 
 	__fp16	itsSphFogSaturationNear,					//	fog saturation at distance  0  (the observer)
 			itsSphFogSaturationMid,						//	fog saturation at distance  π  (the antipode)
@@ -47,6 +94,68 @@ typedef struct
 
 } CurvedSpacesUniformData;
 
+//	How many levels of detail should we support?
+#define MAX_NUM_LOD_LEVELS	4
+
+//	When the GPU culls the honeycomb, it writes the arguments
+//	for each mesh's indirect draw calls.  Each kind of mesh
+//	gets its own slot, because each has its own index counts.
+typedef enum
+{
+	MeshSlotDirichletWalls,
+	MeshSlotVertexFigures,
+	MeshSlotObserver,
+	MeshSlotCenterpiece,
+	NumMeshSlots
+} MeshSlot;
+
+//	One cell of the honeycomb, as the GPU sees it.
+//	The renderer uploads the cells once, whenever the honeycomb changes,
+//	and thereafter the tiling buffers hold only 32-bit indices into them.
+typedef struct
+{
+	simd_float4x4	itsTilingMatrix;
+	simd_float4		itsCellCenter;		//	in world space
+	uint32_t		itsParity;			//	ImagePositive or ImageNegative
+} CurvedSpacesCellData;
+
+typedef struct
+{
+	simd_float4x4	itsViewMatrix;						//	the observer's, even for a stereo pair
+	simd_float4		itsCullingPlanes[4];				//	see MakeCullingHyperplanes()
+	float			itsAdjustedDirichletDomainRadius,	//	see AdjustedDirichletDomainRadius()
+					itsTilingRadius,					//	= horizon radius + Dirichlet domain outradius
+					itsLevelDistances[NumMeshSlots][MAX_NUM_LOD_LEVELS];	//	where each level of detail takes over;
+																			//		infinite for levels never used
+	uint32_t		itsNumCells,
+					itsSortSize,						//	itsNumCells rounded up to a power of two
+					itsViewParity,						//	ImagePositive or ImageNegative
+					itsAcceptAllCells,					//	true in spherical spaces
+					itsNumBlendedInstancesToOmit,		//	nearest images to omit when alpha blending
+					itsNumViews,						//	1, or MAX_NUM_VIEWS for a stereo pair
+					itsWriteFullTiles,					//	false when nothing draws from the full back-to-front buffer
+					itsIndexCounts[NumMeshSlots][MAX_NUM_LOD_LEVELS];	//	0 for absent levels of detail
+} CurvedSpacesCullUniformData;
+
+//	Same layout as MTLDrawIndexedPrimitivesIndirectArguments
+typedef struct
+{
+	uint32_t	itsIndexCount,
+				itsInstanceCount,
+				itsIndexStart;
+	int32_t		itsBaseVertex;
+	uint32_t	itsBaseInstance;
+} CurvedSpacesDrawArguments;
+
+typedef struct
+{
+	uint32_t					itsNumPlainTiles,
+								itsNumReflectedTiles;
+	CurvedSpacesDrawArguments	itsOpaqueDraws[NumMeshSlots][MAX_NUM_LOD_LEVELS][2],	//	[slot][level][plain, reflected]
+								itsBlendedDraws[NumMeshSlots];
+} CurvedSpacesCullResultData;
+
+
 //	For the most part the same GPU vertex function works for all three geometries
 //	(spherical, Euclidean and hyperbolic).  The exceptions are
 //
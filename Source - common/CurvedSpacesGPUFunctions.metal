@@ -56,6 +56,10 @@ constant uint	gFogAndClipBoxType	[[ function_constant(0) ]];	//	32-bit unsigned
 constant bool	gUseCubeMap			[[ function_constant(1) ]];	//	 8-bit boolean
 constant bool	gUsePlainTexture = ! gUseCubeMap;
 constant uint	gShapeOfSpaceFigure	[[ function_constant(2) ]];	//	32-bit unsigned integer
+constant bool	gUseAperture		[[ function_constant(3) ]];	//	 8-bit boolean
+constant uint	gNumViews			[[ function_constant(4) ]];	//	32-bit unsigned integer, 1 or MAX_NUM_VIEWS
+constant bool	gMultiView = (gNumViews > 1);
+constant bool	gSingleView = ! gMultiView;
 
 
 struct VertexInput
@@ -63,6 +67,12 @@ struct VertexInput
 	float4	pos [[ attribute(VertexAttributePosition)	]];
 	float3	tex [[ attribute(VertexAttributeTexCoords)	]];	//	(u,v,-) for regular texture or (u,v,w) for cube map
 	half4	col [[ attribute(VertexAttributeColor)		]];
+
+	//	A mesh with apertures (namely the Dirichlet walls)
+	//	gives pos and tex with the aperture fully open,
+	//	and closedPos and closedTex with the aperture fully closed.
+	float4	closedPos [[ attribute(VertexAttributeClosedPosition), function_constant(gUseAperture) ]];
+	float2	closedTex [[ attribute(VertexAttributeClosedTexCoords), function_constant(gUseAperture) ]];
 };
 
 struct VertexOutput
@@ -70,6 +80,7 @@ struct VertexOutput
 	float4	position	[[ position			]];
 	float3	texCoords	[[ user(texcoords)	]];	//	(u,v,-) for regular texture or (u,v,w) for cube map
 	half4	color		[[ user(color)		]];
+	uint	layer		[[ render_target_array_index, function_constant(gMultiView) ]];	//	which eye's slice
 };
 struct FragmentInput
 {
@@ -80,21 +91,72 @@ struct FragmentInput
 
 vertex VertexOutput CurvedSpacesVertexFunction(
 	VertexInput							in				[[ stage_in							]],
-	const device float4x4				*tilingGroup	[[ buffer(BufferIndexTilingGroup)	]],	//	includes view matrix (and antipodal map where appropriate)
+	const device uint					*tilingGroup	[[ buffer(BufferIndexTilingGroup)	]],	//	indices into cells[]
+	const device CurvedSpacesCellData	*cells			[[ buffer(BufferIndexHoneycombCells)]],
 	constant CurvedSpacesUniformData	&uniforms		[[ buffer(BufferIndexUniforms)		]],
+	constant float4x4					&placement		[[ buffer(BufferIndexMeshPlacement)	]],
 //#warning restore ushort iid [[ instance_id ]]
 //	uint								iid				[[ instance_id						]])
 	ushort								iid				[[ instance_id						]])
 {
 	VertexOutput	out;
-	float4			theTransformedPosition;
+	ushort			theTile,
+					theView;
+	float4			theMeshPosition,
+					theTilePosition,
+					theTransformedPosition;
 	half			theFogValue;
 
+	//	A stereo pair draws gNumViews instances of each tile,
+	//	one for each eye, and sends each to its own eye's
+	//	slice of the layered render target.
+	if (gMultiView)
+	{
+		theTile		= ushort(iid / gNumViews);
+		theView		= ushort(iid % gNumViews);
+		out.layer	= theView;
+	}
+	else
+	{
+		theTile		= iid;
+		theView		= 0;
+	}
+
 	//	position
+
+	//	Slide each Dirichlet wall vertex from its fully-closed position
+	//	towards its fully-open one, and normalize the result
+	//	to the space's geometry, so the fog sees the correct distance.
+	//	For vertices on a face's outer boundary, the two positions agree.
+	if (gUseAperture)
+	{
+		theMeshPosition = mix(in.closedPos, in.pos, uniforms.itsAperture);
+		theMeshPosition *= rsqrt(theMeshPosition.w * theMeshPosition.w
+								+ uniforms.itsCurvature * dot(theMeshPosition.xyz, theMeshPosition.xyz));
+	}
+	else
+	{
+		theMeshPosition = in.pos;
+	}
 	
-	//	tilingGroup[iid] holds the pre-computed product of the tiling matrix and the view matrix
-	//	(and also the antipodal map, in the case of ShaderSphericalFogBoxBack).
-	theTransformedPosition = tilingGroup[iid] * in.pos;
+	//	The mesh's placement (the spinning centerpiece's orientation,
+	//	or the observer's position, or the identity for everything else)
+	//	comes first, then the tiling matrix of the cell
+	//	whose index tilingGroup[theTile] gives, and finally
+	//	the view's view matrix (which, in the case of ShaderSphericalFogBoxBack
+	//	and ShaderNoFogBoxBack, already includes the antipodal map).
+	theTilePosition = cells[tilingGroup[theTile]].itsTilingMatrix * (placement * theMeshPosition);
+	switch (gFogAndClipBoxType)
+	{
+		case ShaderSphericalFogBoxBack:
+		case ShaderNoFogBoxBack:
+			theTransformedPosition = uniforms.itsInvertedViewMatrix[theView] * theTilePosition;
+			break;
+
+		default:
+			theTransformedPosition = uniforms.itsViewMatrix[theView] * theTilePosition;
+			break;
+	}
 
 	//	Typically we render to the full clipping box.
 	//	The only exceptions are spherical spaces that lack antipodal symmetry
@@ -107,22 +169,24 @@ vertex VertexOutput CurvedSpacesVertexFunction(
 		case ShaderEuclideanFogBoxFull:
 		case ShaderHyperbolicFogBoxFull:
 		case ShaderNoFogBoxFull:
-			out.position = uniforms.itsProjectionMatrixForBoxFull  * theTransformedPosition;
+			out.position = uniforms.itsProjectionMatrixForBoxFull [theView] * theTransformedPosition;
 			break;
 
 		case ShaderSphericalFogBoxFront:
 		case ShaderNoFogBoxFront:
-			out.position = uniforms.itsProjectionMatrixForBoxFront * theTransformedPosition;
+			out.position = uniforms.itsProjectionMatrixForBoxFront[theView] * theTransformedPosition;
 			break;
 		
 		case ShaderSphericalFogBoxBack:
 		case ShaderNoFogBoxBack:
-			out.position = uniforms.itsProjectionMatrixForBoxBack  * theTransformedPosition;
+			out.position = uniforms.itsProjectionMatrixForBoxBack [theView] * theTransformedPosition;
 			break;
 	}
 
 	//	texture coordinates
 	out.texCoords = in.tex;
+	if (gUseAperture)
+		out.texCoords.xy = mix(in.closedTex, in.tex.xy, uniforms.itsAperture);
 
 	//	color
 	switch (gFogAndClipBoxType)
@@ -151,7 +215,7 @@ vertex VertexOutput CurvedSpacesVertexFunction(
 			break;
 		
 		case ShaderSphericalFogBoxBack:
-			//	tilingGroup[iid] includes the antipodal map, so at this point
+			//	itsInvertedViewMatrix includes the antipodal map, so at this point
 			//	we're rendering scenery that's already been mapped
 			//	from the back hemisphere into the front hemisphere.
 			//	Of course we nevertheless interpolate the fog
@@ -276,3 +340,501 @@ fragment half4 CurvedSpacesFragmentFunction(
 
 	return tmpFragmentColor;
 }
+
+
+//	Order-independent transparency follows
+//
+//		Morgan McGuire and Louis Bavoil,
+//		Weighted Blended Order-Independent Transparency,
+//		Journal of Computer Graphics Techniques 2 (2013) 122-141.
+//
+//	Instead of blending each partially transparent fragment
+//	over the color buffer, which requires drawing
+//	the fragments back-to-front, the transparent fragment function
+//	adds its weighted premultiplied color to an accumulation attachment
+//	and multiplies a revealage attachment by (1 - α).  Both operations
+//	commute, so the instances may arrive in any order.
+//	The composite functions below then blend the weighted average color
+//	over the opaque scene.
+
+struct TransparentFragmentInput
+{
+	float4	position	[[ position			]];
+	float3	texCoords	[[ user(texcoords)	]];
+	half4	color		[[ user(color)		]];
+};
+struct TransparentFragmentOutput
+{
+	half4	accumulation	[[ color(ColorAttachmentIndexTransparencyAccumulation)	]];
+	half	revealage		[[ color(ColorAttachmentIndexTransparencyRevealage)		]];
+};
+
+fragment TransparentFragmentOutput CurvedSpacesTransparentFragmentFunction(
+	TransparentFragmentInput	in				[[ stage_in						]],
+	texture2d<half>				plainTexture	[[ texture(TextureIndexPrimary)	]],
+	sampler						textureSampler	[[ sampler(SamplerIndexPrimary)	]])
+{
+	half4						tmpFragmentColor;
+	float						tmpWeight;
+	TransparentFragmentOutput	out;
+
+	//	Curved Spaces' only partially transparent content, the galaxy,
+	//	uses a plain texture, never a cube map.
+	tmpFragmentColor = in.color * plainTexture.sample(textureSampler, in.texCoords.xy);
+
+	//	Weight nearer fragments more heavily, using McGuire and Bavoil's
+	//	weight function for a depth buffer value d in [0,1].
+	//	The clamp keeps the accumulated sums within half precision.
+	tmpWeight = clamp(
+					float(tmpFragmentColor.a) * max(1.0e-2, 3.0e3 * pow(1.0 - in.position.z, 3.0)),
+					1.0e-2,
+					3.0e3);
+
+	out.accumulation	= half4(tmpWeight * float4(tmpFragmentColor));
+	out.revealage		= tmpFragmentColor.a;
+
+	return out;
+}
+
+struct FullScreenVertexOutput
+{
+	float4	position	[[ position	]];
+	float2	texCoords	[[ user(texcoords) ]];	//	for CurvedSpacesUpscaleFragmentFunction
+	uint	layer		[[ render_target_array_index, function_constant(gMultiView) ]];	//	which eye's slice
+};
+
+vertex FullScreenVertexOutput CurvedSpacesFullScreenVertexFunction(
+	uint	vid	[[ vertex_id	]],
+	uint	iid	[[ instance_id	]])	//	a stereo pair draws one instance per view
+{
+	float2					tmpCorner;
+	FullScreenVertexOutput	out;
+
+	//	Vertices 0, 1 and 2 give a single triangle with corners
+	//	(-1,-1), (+3,-1) and (-1,+3), which covers the whole viewport.
+	//	Texture coordinates run downwards from the top left corner.
+	tmpCorner		= float2((vid << 1) & 2, vid & 2);
+	out.position	= float4(2.0 * tmpCorner - 1.0, 0.0, 1.0);
+	out.texCoords	= float2(tmpCorner.x, 1.0 - tmpCorner.y);
+
+	if (gMultiView)
+	{
+		out.layer = iid;
+	}
+
+	return out;
+}
+
+fragment half4 CurvedSpacesCompositeFragmentFunction(
+	FullScreenVertexOutput					in						[[ stage_in																			]],
+	texture2d<half, access::read>			accumulationTexture		[[ texture(TextureIndexTransparencyAccumulation),	function_constant(gSingleView)	]],
+	texture2d<half, access::read>			revealageTexture		[[ texture(TextureIndexTransparencyRevealage),		function_constant(gSingleView)	]],
+	texture2d_array<half, access::read>		accumulationTextures	[[ texture(TextureIndexTransparencyAccumulation),	function_constant(gMultiView)	]],
+	texture2d_array<half, access::read>		revealageTextures		[[ texture(TextureIndexTransparencyRevealage),		function_constant(gMultiView)	]])
+{
+	uint2	tmpPixel;
+	float4	tmpAccumulation;
+	float	tmpRevealage;
+	half	tmpCoverage;
+	half3	tmpAverageColor;
+
+	tmpPixel = uint2(in.position.xy);
+
+	if (gSingleView)
+	{
+		tmpAccumulation	= float4(accumulationTexture.read(tmpPixel));
+		tmpRevealage	= float(revealageTexture.read(tmpPixel).r);
+	}
+	if (gMultiView)
+	{
+		tmpAccumulation	= float4(accumulationTextures.read(tmpPixel, in.layer));
+		tmpRevealage	= float(revealageTextures.read(tmpPixel, in.layer).r);
+	}
+
+	//	Where no partially transparent fragment landed,
+	//	the revealage is still 1, and the opaque scene shows through unchanged.
+	tmpCoverage		= half(1.0 - tmpRevealage);
+	tmpAverageColor	= half3(tmpAccumulation.rgb / max(tmpAccumulation.a, 1.0e-5));
+
+	//	premultiplied alpha, for the (1, 1 - α) blend factors
+	return half4(tmpCoverage * tmpAverageColor, tmpCoverage);
+}
+
+fragment half4 CurvedSpacesUpscaleFragmentFunction(
+	FullScreenVertexOutput		in				[[ stage_in														]],
+	texture2d<half>				sceneTexture	[[ texture(TextureIndexPrimary),	function_constant(gSingleView)	]],
+	texture2d_array<half>		sceneTextures	[[ texture(TextureIndexPrimary),	function_constant(gMultiView)	]],
+	sampler						linearSampler	[[ sampler(SamplerIndexPrimary)										]])
+{
+	half4	tmpColor;
+
+	//	Stretch the reduced-scale scene across the full drawable.
+	//	Bilinear filtering softens the image a little,
+	//	but far less than the frame rate would drop otherwise.
+	if (gSingleView)
+	{
+		tmpColor = sceneTexture.sample(linearSampler, in.texCoords);
+	}
+	if (gMultiView)
+	{
+		tmpColor = sceneTextures.sample(linearSampler, in.texCoords, in.layer);
+	}
+
+	return tmpColor;
+}
+
+
+
+//	The following compute functions cull and sort the honeycomb on the GPU,
+//	as CullAndSortVisibleCells() does on the CPU, and then write
+//	the visible cells' indices into the plain, reflected
+//	and full back-to-front tiling buffers
+//	along with the arguments for the indirect draw calls.
+//
+//	Each sort entry is a pair
+//
+//		(sort key, cell index)
+//
+//	where the sort key's top two bits hold the cell's class
+//
+//		0 = visible and plain
+//		1 = visible and reflected
+//		3 = not visible (or padding)
+//
+//	and its remaining 30 bits hold the distance from the observer
+//	to the cell's center (in a spherical space, to the nearer of
+//	the cell's center and its antipodal point, as in
+//	CullAndSortVisibleCells()).  Because the distance is non-negative,
+//	its float representation sorts correctly as an unsigned integer,
+//	and dropping its two least significant bits costs nothing
+//	that matters here.  After sorting, the plain cells come first,
+//	nearest to farthest, then the reflected cells, nearest to farthest,
+//	and the invisible cells last of all.
+
+#define SORT_CLASS_PLAIN		0u
+#define SORT_CLASS_REFLECTED	1u
+#define SORT_CLASS_INVISIBLE	3u
+#define SORT_DISTANCE_MASK		0x3FFFFFFFu
+#define SORT_ENTRY_INVISIBLE	uint2(0xFFFFFFFFu, 0xFFFFFFFFu)
+
+static bool SortEntryPrecedes(uint2 a, uint2 b)
+{
+	return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+static bool SortEntryDistancePrecedes(uint2 a, uint2 b)
+{
+	//	Compare two entries while ignoring their classes.
+	//	The cell indices break ties, so no two distinct
+	//	visible cells ever compare equal.
+	return (a.x & SORT_DISTANCE_MASK) <  (b.x & SORT_DISTANCE_MASK)
+		|| ((a.x & SORT_DISTANCE_MASK) == (b.x & SORT_DISTANCE_MASK) && a.y < b.y);
+}
+
+static uint CountSortEntriesBelowKey(
+	const device uint2	*someSortEntries,
+	uint				aNumEntries,
+	uint				aKey)
+{
+	uint	theLow,
+			theHigh,
+			theMid;
+
+	//	Binary search for the first entry whose key is at least aKey.
+	theLow	= 0;
+	theHigh	= aNumEntries;
+	while (theLow < theHigh)
+	{
+		theMid = (theLow + theHigh) / 2;
+		if (someSortEntries[theMid].x < aKey)
+			theLow	= theMid + 1;
+		else
+			theHigh	= theMid;
+	}
+
+	return theLow;
+}
+
+static uint CountSortEntriesNearerThan(
+	const device uint2	*someSortEntries,	//	a sorted run of a single class
+	uint				aNumEntries,
+	uint2				anEntry)			//	an entry of the other class
+{
+	uint	theLow,
+			theHigh,
+			theMid;
+
+	theLow	= 0;
+	theHigh	= aNumEntries;
+	while (theLow < theHigh)
+	{
+		theMid = (theLow + theHigh) / 2;
+		if (SortEntryDistancePrecedes(someSortEntries[theMid], anEntry))
+			theLow	= theMid + 1;
+		else
+			theHigh	= theMid;
+	}
+
+	return theLow;
+}
+
+kernel void CurvedSpacesCullFunction(
+	constant CurvedSpacesCullUniformData	&uniforms		[[ buffer(BufferIndexCullUniforms)		]],
+	const device CurvedSpacesCellData		*cells			[[ buffer(BufferIndexCullCells)			]],
+	device uint2							*sortEntries	[[ buffer(BufferIndexCullSortEntries)	]],
+	uint									gid				[[ thread_position_in_grid				]])
+{
+	float4	theCellCenterInCameraSpace;
+	float	theDistance;
+	bool	theCellIsVisible;
+	uint	i,
+			theClass;
+
+	if (gid >= uniforms.itsSortSize)
+		return;
+
+	//	Pad the sort entries out to a power of two.
+	if (gid >= uniforms.itsNumCells)
+	{
+		sortEntries[gid] = SORT_ENTRY_INVISIBLE;
+		return;
+	}
+
+	theCellCenterInCameraSpace = uniforms.itsViewMatrix * cells[gid].itsCellCenter;
+
+	//	Compute the distance as VectorGeometricDistance() does,
+	//	except that in the spherical case, a cell and its antipodal image
+	//	look equally big, so measure the distance to the nearer of the two.
+	if (theCellCenterInCameraSpace.w < 1.0)			//	spherical
+		theDistance = acos(min(abs(theCellCenterInCameraSpace.w), 1.0));
+	else
+	if (theCellCenterInCameraSpace.w == 1.0)		//	flat
+		theDistance = length(theCellCenterInCameraSpace.xyz);
+	else											//	hyperbolic
+		theDistance = acosh(theCellCenterInCameraSpace.w);
+
+	//	Apply the same tests as CullAndSortVisibleCells(),
+	//	including the inexpensive z test and the horizon test
+	//	ahead of the frustum test.
+	if (uniforms.itsAcceptAllCells)
+	{
+		theCellIsVisible = true;
+	}
+	else
+	{
+		theCellIsVisible = (theCellCenterInCameraSpace.z > - uniforms.itsAdjustedDirichletDomainRadius
+						 && theDistance < uniforms.itsTilingRadius);
+
+		//	The dot product gives sin(d), d, or sinh(d),
+		//	according to the geometry.  The culling planes'
+		//	w components are zero except for a stereo pair's
+		//	widened planes (see MakeCullingHyperplanes()).
+		for (i = 0; i < 4 && theCellIsVisible; i++)
+			if (dot(theCellCenterInCameraSpace, uniforms.itsCullingPlanes[i])
+				< - uniforms.itsAdjustedDirichletDomainRadius)
+			{
+				theCellIsVisible = false;
+			}
+	}
+
+	if (theCellIsVisible)
+	{
+		theClass = (cells[gid].itsParity == uniforms.itsViewParity ?
+					SORT_CLASS_PLAIN : SORT_CLASS_REFLECTED);
+		sortEntries[gid] = uint2((theClass << 30) | (as_type<uint>(theDistance) >> 2), gid);
+	}
+	else
+	{
+		sortEntries[gid] = uint2(SORT_ENTRY_INVISIBLE.x, gid);
+	}
+}
+
+kernel void CurvedSpacesSortStepFunction(
+	constant CurvedSpacesCullUniformData	&uniforms		[[ buffer(BufferIndexCullUniforms)		]],
+	device uint2							*sortEntries	[[ buffer(BufferIndexCullSortEntries)	]],
+	constant uint2							&stage			[[ buffer(BufferIndexCullSortStage)		]],	//	(k, j)
+	uint									gid				[[ thread_position_in_grid				]])
+{
+	uint	thePartner;
+	bool	theAscendingFlag;
+	uint2	a,
+			b;
+
+	//	One compare-and-swap step of a bitonic sort.
+	//	The CPU dispatches this function log₂(n)·(log₂(n) + 1)/2 times
+	//	for n = itsSortSize, which keeps the CPU's cost
+	//	nearly independent of the size of the honeycomb.
+
+	if (gid >= uniforms.itsSortSize)
+		return;
+
+	thePartner = gid ^ stage.y;
+	if (thePartner > gid)
+	{
+		theAscendingFlag = ((gid & stage.x) == 0);
+
+		a = sortEntries[gid];
+		b = sortEntries[thePartner];
+		if (SortEntryPrecedes(b, a) == theAscendingFlag)
+		{
+			sortEntries[gid]		= b;
+			sortEntries[thePartner]	= a;
+		}
+	}
+}
+
+kernel void CurvedSpacesCullFinishFunction(
+	constant CurvedSpacesCullUniformData	&uniforms		[[ buffer(BufferIndexCullUniforms)		]],
+	const device uint2						*sortEntries	[[ buffer(BufferIndexCullSortEntries)	]],
+	device CurvedSpacesCullResultData		&results		[[ buffer(BufferIndexCullResults)		]],
+	uint									gid				[[ thread_position_in_grid				]])
+{
+	uint	theNumPlainTiles,
+			theNumReflectedTiles,
+			theNumVisibleTiles,
+			theSlot,
+			theNumLevelsOfDetail,
+			theLevel,
+			theDistanceBits,
+			thePlainLevelCutoffs[MAX_NUM_LOD_LEVELS + 1],
+			theReflectedLevelCutoffs[MAX_NUM_LOD_LEVELS + 1];
+
+	//	A single thread suffices to count the tiles
+	//	and write the draw arguments.
+	if (gid != 0)
+		return;
+
+	theNumPlainTiles		= CountSortEntriesBelowKey(sortEntries, uniforms.itsNumCells, SORT_CLASS_REFLECTED << 30);
+	theNumVisibleTiles		= CountSortEntriesBelowKey(sortEntries, uniforms.itsNumCells, (SORT_CLASS_REFLECTED + 1) << 30);
+	theNumReflectedTiles	= theNumVisibleTiles - theNumPlainTiles;
+
+	results.itsNumPlainTiles		= theNumPlainTiles;
+	results.itsNumReflectedTiles	= theNumReflectedTiles;
+
+	//	The plain and the reflected tiles are each sorted near to far,
+	//	so each level of detail covers a run of each.  Find where
+	//	each coarser level takes over, exactly as
+	//	-writeSortedVisibleTilesIntoBufferSet:… does on the CPU.
+	for (theSlot = 0; theSlot < NumMeshSlots; theSlot++)
+	{
+		theNumLevelsOfDetail = 0;
+		while (theNumLevelsOfDetail < MAX_NUM_LOD_LEVELS
+			&& uniforms.itsIndexCounts[theSlot][theNumLevelsOfDetail] > 0)
+		{
+			theNumLevelsOfDetail++;
+		}
+
+		thePlainLevelCutoffs[0]		= 0;
+		theReflectedLevelCutoffs[0]	= 0;
+		for (theLevel = 1; theLevel < theNumLevelsOfDetail; theLevel++)
+		{
+			//	An infinite distance's bits still fit in 30 bits,
+			//	and exceed every finite distance's.
+			theDistanceBits = as_type<uint>(uniforms.itsLevelDistances[theSlot][theLevel]) >> 2;
+
+			thePlainLevelCutoffs[theLevel]		= CountSortEntriesBelowKey(	sortEntries,
+																			theNumPlainTiles,
+																			(SORT_CLASS_PLAIN << 30) | theDistanceBits);
+			theReflectedLevelCutoffs[theLevel]	= CountSortEntriesBelowKey(	sortEntries + theNumPlainTiles,
+																			theNumReflectedTiles,
+																			(SORT_CLASS_REFLECTED << 30) | theDistanceBits);
+		}
+		thePlainLevelCutoffs[theNumLevelsOfDetail]		= theNumPlainTiles;
+		theReflectedLevelCutoffs[theNumLevelsOfDetail]	= theNumReflectedTiles;
+
+		for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+		{
+			device CurvedSpacesDrawArguments	&thePlainDraw		= results.itsOpaqueDraws[theSlot][theLevel][0];
+			device CurvedSpacesDrawArguments	&theReflectedDraw	= results.itsOpaqueDraws[theSlot][theLevel][1];
+
+			thePlainDraw.itsIndexCount			= uniforms.itsIndexCounts[theSlot][theLevel];
+			thePlainDraw.itsIndexStart			= 0;
+			thePlainDraw.itsBaseVertex			= 0;
+			theReflectedDraw.itsIndexCount		= uniforms.itsIndexCounts[theSlot][theLevel];
+			theReflectedDraw.itsIndexStart		= 0;
+			theReflectedDraw.itsBaseVertex		= 0;
+
+			//	A stereo pair draws itsNumViews instances of each tile,
+			//	so the vertex function may recover the tile
+			//	as instance_id / itsNumViews.
+			if (theLevel < theNumLevelsOfDetail)
+			{
+				thePlainDraw.itsInstanceCount		= uniforms.itsNumViews * (thePlainLevelCutoffs[theLevel + 1] - thePlainLevelCutoffs[theLevel]);
+				thePlainDraw.itsBaseInstance		= uniforms.itsNumViews * thePlainLevelCutoffs[theLevel];
+				theReflectedDraw.itsInstanceCount	= uniforms.itsNumViews * (theReflectedLevelCutoffs[theLevel + 1] - theReflectedLevelCutoffs[theLevel]);
+				theReflectedDraw.itsBaseInstance	= uniforms.itsNumViews * theReflectedLevelCutoffs[theLevel];
+			}
+			else
+			{
+				thePlainDraw.itsInstanceCount		= 0;
+				thePlainDraw.itsBaseInstance		= 0;
+				theReflectedDraw.itsInstanceCount	= 0;
+				theReflectedDraw.itsBaseInstance	= 0;
+			}
+		}
+
+		//	Partially transparent content uses the finest level of detail
+		//	and the full back-to-front buffer.
+		results.itsBlendedDraws[theSlot].itsIndexCount		= uniforms.itsIndexCounts[theSlot][0];
+		results.itsBlendedDraws[theSlot].itsInstanceCount	= uniforms.itsNumViews
+															* (theNumVisibleTiles > uniforms.itsNumBlendedInstancesToOmit ?
+																theNumVisibleTiles - uniforms.itsNumBlendedInstancesToOmit : 0);
+		results.itsBlendedDraws[theSlot].itsIndexStart		= 0;
+		results.itsBlendedDraws[theSlot].itsBaseVertex		= 0;
+		results.itsBlendedDraws[theSlot].itsBaseInstance	= 0;
+	}
+}
+
+kernel void CurvedSpacesCullScatterFunction(
+	constant CurvedSpacesCullUniformData	&uniforms		[[ buffer(BufferIndexCullUniforms)			]],
+	const device uint2						*sortEntries	[[ buffer(BufferIndexCullSortEntries)		]],
+	const device CurvedSpacesCullResultData	&results		[[ buffer(BufferIndexCullResults)			]],
+	device uint								*plainTiles		[[ buffer(BufferIndexCullPlainTiles)		]],
+	device uint								*reflectedTiles	[[ buffer(BufferIndexCullReflectedTiles)	]],
+	device uint								*fullTiles		[[ buffer(BufferIndexCullFullTiles)			]],
+	uint									gid				[[ thread_position_in_grid					]])
+{
+	uint	theNumPlainTiles,
+			theNumVisibleTiles,
+			theMergedRank;
+	uint2	theEntry;
+
+	theNumPlainTiles	= results.itsNumPlainTiles;
+	theNumVisibleTiles	= results.itsNumPlainTiles + results.itsNumReflectedTiles;
+
+	if (gid >= theNumVisibleTiles)
+		return;
+
+	theEntry = sortEntries[gid];
+
+	//	The plain and reflected tiles each form a sorted run,
+	//	so a tile's rank within its own run is immediate,
+	//	and a binary search in the other run gives
+	//	its rank in the merged front-to-back order.
+	//	When order-independent transparency draws the galaxy
+	//	from the plain and reflected buffers, nothing reads
+	//	the full buffer, so skip the search and the write.
+	if (gid < theNumPlainTiles)
+	{
+		plainTiles[gid] = theEntry.y;
+		if ( ! uniforms.itsWriteFullTiles )
+			return;
+		theMergedRank = gid
+					  + CountSortEntriesNearerThan(	sortEntries + theNumPlainTiles,
+													results.itsNumReflectedTiles,
+													theEntry);
+	}
+	else
+	{
+		reflectedTiles[gid - theNumPlainTiles] = theEntry.y;
+		if ( ! uniforms.itsWriteFullTiles )
+			return;
+		theMergedRank = (gid - theNumPlainTiles)
+					  + CountSortEntriesNearerThan(	sortEntries,
+													theNumPlainTiles,
+													theEntry);
+	}
+
+	//	Write the full buffer back-to-front.
+	fullTiles[theNumVisibleTiles - 1 - theMergedRank] = theEntry.y;
+}
@@ -0,0 +1,354 @@
+//	CurvedSpacesCLI.c
+//
+//	A command-line driver for the platform-independent C code.
+//
+//		curved-spaces-cli [-c cache-file] [-w binary-file] space.gen
+//
+//			Builds the space's Dirichlet domain and honeycomb,
+//			prints how long each stage took, and optionally writes
+//			the space cache that the app would save in its Caches folder.
+//			If cache-file already holds a valid cache for space.gen,
+//			the space gets read from it instead of being rebuilt.
+//			The -w option also writes the space's generators
+//			in the binary generator format (see CurvedSpacesFileIO.c),
+//			which may then replace space.gen.
+//
+//		curved-spaces-cli -b [-n num-frames] space.gen ...
+//
+//			Runs the benchmark suite on each space, without rendering,
+//			and writes the JSON report to stdout.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesUtilities-Common.h"
+#include <stdio.h>
+#include <stdlib.h>		//	for strtoul()
+#include <string.h>		//	for strcmp()
+
+
+static int			BuildSpace(const char *aGeneratorFileName, const char *aCacheFileName, const char *aBinaryFileName);
+static int			RunBenchmarks(unsigned int aNumFiles, char **someGeneratorFileNames, unsigned int aNumFrames);
+static ErrorText	ReadWholeFile(const char *aFileName, bool aMissingFileIsOK, Byte **someBytes, size_t *aNumBytes);
+static ErrorText	WriteWholeFile(const char *aFileName, const Byte *someBytes, size_t aNumBytes);
+static void			PrintUsage(void);
+
+
+int main(int argc, char **argv)
+{
+	const char		*theCacheFileName	= NULL,
+					*theBinaryFileName	= NULL;
+	bool			theBenchmarkFlag	= false;
+	unsigned int	theNumFrames		= BENCHMARK_NUM_FRAMES;
+	int				i;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++)
+	{
+		if (strcmp(argv[i], "-b") == 0)
+			theBenchmarkFlag = true;
+		else
+		if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+			theCacheFileName = argv[++i];
+		else
+		if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+			theBinaryFileName = argv[++i];
+		else
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			theNumFrames = (unsigned int) strtoul(argv[++i], NULL, 10);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (theBenchmarkFlag)
+	{
+		if (i == argc || theCacheFileName != NULL || theBinaryFileName != NULL)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return RunBenchmarks((unsigned int)(argc - i), &argv[i], theNumFrames);
+	}
+	else
+	{
+		if (i + 1 != argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+		return BuildSpace(argv[i], theCacheFileName, theBinaryFileName);
+	}
+}
+
+static void PrintUsage(void)
+{
+	fputs(	"usage:  curved-spaces-cli [-c cache-file] [-w binary-file] space.gen\n"
+			"        curved-spaces-cli -b [-n num-frames] space.gen ...\n",
+			stderr);
+}
+
+
+static int BuildSpace(
+	const char	*aGeneratorFileName,
+	const char	*aCacheFileName,	//	may be NULL
+	const char	*aBinaryFileName)	//	may be NULL
+{
+	ErrorText		theErrorMessage	= NULL;
+	Byte			*theInputText	= NULL,
+					*theCacheData	= NULL,
+					*theBinaryData	= NULL;
+	size_t			theInputSize	= 0,
+					theCacheSize	= 0,
+					theBinarySize	= 0;
+	PendingSpace	*theSpace		= NULL;
+	double			theTotalSeconds;
+	unsigned int	i;
+
+	static const char	*theStageNames[NumConstructionStages] =
+						{
+							"read matrices",
+							"holonomy group",
+							"Dirichlet domain",
+							"honeycomb"
+						};
+	static const char	*theSpaceTypeNames[] =
+						{
+							"none",
+							"spherical",
+							"flat",
+							"hyperbolic"
+						};
+
+	theErrorMessage = ReadWholeFile(aGeneratorFileName, false, &theInputText, &theInputSize);
+	if (theErrorMessage != NULL)
+		goto CleanUpBuildSpace;
+
+	if (aCacheFileName != NULL)
+	{
+		theErrorMessage = ReadWholeFile(aCacheFileName, true, &theCacheData, &theCacheSize);
+		if (theErrorMessage != NULL)
+			goto CleanUpBuildSpace;
+	}
+
+	theErrorMessage = ConstructPendingSpace(theInputText,
+											theInputSize,
+											theCacheData,
+											theCacheSize,
+											aCacheFileName != NULL,
+											false,
+											NULL,
+											&theSpace);
+	if (theErrorMessage != NULL)
+		goto CleanUpBuildSpace;
+
+	printf("%s\n", aGeneratorFileName);
+	printf("\tspace type        %s\n",	theSpaceTypeNames[theSpace->itsSpaceType]);
+	printf("\thorizon radius    %.3f\n",	theSpace->itsHorizonRadius);
+	printf("\tcells             %u\n",	theSpace->itsHoneycomb->itsNumCells);
+
+	theTotalSeconds = 0.0;
+	for (i = 0; i < NumConstructionStages; i++)
+	{
+		printf("\t%-18s%9.3f ms\n", theStageNames[i], 1000.0 * theSpace->itsStageSeconds[i]);
+		theTotalSeconds += theSpace->itsStageSeconds[i];
+	}
+	printf("\t%-18s%9.3f ms\n", "total", 1000.0 * theTotalSeconds);
+
+	//	ConstructPendingSpace() offers a fresh cache
+	//	only if the existing one was missing or stale.
+	if (theSpace->itsFreshCacheData != NULL)
+	{
+		theErrorMessage = WriteWholeFile(aCacheFileName, theSpace->itsFreshCacheData, theSpace->itsFreshCacheSize);
+		if (theErrorMessage != NULL)
+			goto CleanUpBuildSpace;
+
+		printf("\twrote %zu-byte cache to %s\n", theSpace->itsFreshCacheSize, aCacheFileName);
+	}
+	else
+	if (aCacheFileName != NULL)
+		printf("\tread space from cache %s\n", aCacheFileName);
+
+	if (aBinaryFileName != NULL)
+	{
+		theErrorMessage = WriteBinaryGenerators(theSpace, &theBinaryData, &theBinarySize);
+		if (theErrorMessage != NULL)
+			goto CleanUpBuildSpace;
+
+		theErrorMessage = WriteWholeFile(aBinaryFileName, theBinaryData, theBinarySize);
+		if (theErrorMessage != NULL)
+			goto CleanUpBuildSpace;
+
+		printf("\twrote %zu-byte binary generator file to %s\n", theBinarySize, aBinaryFileName);
+	}
+
+CleanUpBuildSpace:
+
+	FreePendingSpace(&theSpace);
+	FREE_MEMORY_SAFELY(theBinaryData);
+	FREE_MEMORY_SAFELY(theCacheData);
+	FREE_MEMORY_SAFELY(theInputText);
+
+	if (theErrorMessage != NULL)
+	{
+		GeometryGamesErrorMessage(theErrorMessage, u"curved-spaces-cli");
+		return 1;
+	}
+
+	return 0;
+}
+
+
+static int RunBenchmarks(
+	unsigned int	aNumFiles,
+	char			**someGeneratorFileNames,
+	unsigned int	aNumFrames)
+{
+	ErrorText		theErrorMessage	= NULL;
+	ModelData		*md				= NULL;
+	BenchmarkReport	theReport		= {0};
+	Byte			*theInputText	= NULL;
+	size_t			theInputSize;
+	unsigned int	i;
+
+	md = (ModelData *) GET_MEMORY(SizeOfModelData());
+	if (md == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory for the ModelData.";
+		goto CleanUpRunBenchmarks;
+	}
+	SetUpModelData(md);
+
+	//	With no renderer, the report's image size matters only
+	//	to the culling, which uses it to set up the view frustum.
+	theErrorMessage = BeginBenchmarkReport(	&theReport,
+											BENCHMARK_IMAGE_WIDTH,
+											BENCHMARK_IMAGE_HEIGHT,
+											aNumFrames,
+											BENCHMARK_FRAME_PERIOD);
+	if (theErrorMessage != NULL)
+		goto CleanUpRunBenchmarks;
+
+	for (i = 0; i < aNumFiles; i++)
+	{
+		theErrorMessage = ReadWholeFile(someGeneratorFileNames[i], false, &theInputText, &theInputSize);
+		if (theErrorMessage != NULL)
+			goto CleanUpRunBenchmarks;
+
+		//	With no frame hook, the report's prepare_and_encode
+		//	and gpu times come out null.
+		theErrorMessage = BenchmarkSpace(&theReport, md, someGeneratorFileNames[i], theInputText, theInputSize, NULL, NULL);
+		if (theErrorMessage != NULL)
+			goto CleanUpRunBenchmarks;
+
+		FREE_MEMORY_SAFELY(theInputText);
+	}
+
+	theErrorMessage = EndBenchmarkReport(&theReport);
+	if (theErrorMessage != NULL)
+		goto CleanUpRunBenchmarks;
+
+	fwrite(theReport.itsText, 1, theReport.itsLength, stdout);
+
+CleanUpRunBenchmarks:
+
+	if (md != NULL)
+	{
+		ShutDownModelData(md);
+		FREE_MEMORY_SAFELY(md);
+	}
+	FreeBenchmarkReport(&theReport);
+	FREE_MEMORY_SAFELY(theInputText);
+
+	if (theErrorMessage != NULL)
+	{
+		GeometryGamesErrorMessage(theErrorMessage, u"curved-spaces-cli");
+		return 1;
+	}
+
+	return 0;
+}
+
+
+static ErrorText ReadWholeFile(
+	const char	*aFileName,
+	bool		aMissingFileIsOK,	//	if true, a missing file yields *someBytes == NULL
+	Byte		**someBytes,		//	output, zero-terminated, to be freed by the caller
+	size_t		*aNumBytes)			//	output, not counting the terminating zero
+{
+	ErrorText	theErrorMessage	= NULL;
+	FILE		*theFile		= NULL;
+	long		theFileSize;
+
+	*someBytes	= NULL;
+	*aNumBytes	= 0;
+
+	theFile = fopen(aFileName, "rb");
+	if (theFile == NULL)
+	{
+		if ( ! aMissingFileIsOK )
+			theErrorMessage = u"Couldn't open input file.";
+		goto CleanUpReadWholeFile;
+	}
+
+	if (fseek(theFile, 0, SEEK_END) != 0
+	 || (theFileSize = ftell(theFile)) < 0
+	 || fseek(theFile, 0, SEEK_SET) != 0)
+	{
+		theErrorMessage = u"Couldn't determine input file's size.";
+		goto CleanUpReadWholeFile;
+	}
+
+	//	Leave room for a terminating zero,
+	//	because the generator file parser expects one.
+	*someBytes = (Byte *) GET_MEMORY((size_t) theFileSize + 1);
+	if (*someBytes == NULL)
+	{
+		theErrorMessage = u"Couldn't get memory to read input file.";
+		goto CleanUpReadWholeFile;
+	}
+
+	if (fread(*someBytes, 1, (size_t) theFileSize, theFile) != (size_t) theFileSize)
+	{
+		theErrorMessage = u"Couldn't read input file.";
+		goto CleanUpReadWholeFile;
+	}
+	(*someBytes)[theFileSize] = 0;
+	*aNumBytes = (size_t) theFileSize;
+
+CleanUpReadWholeFile:
+
+	if (theFile != NULL)
+		fclose(theFile);
+
+	if (theErrorMessage != NULL)
+	{
+		FREE_MEMORY_SAFELY(*someBytes);
+		*aNumBytes = 0;
+	}
+
+	return theErrorMessage;
+}
+
+static ErrorText WriteWholeFile(
+	const char	*aFileName,
+	const Byte	*someBytes,
+	size_t		aNumBytes)
+{
+	FILE		*theFile;
+	ErrorText	theErrorMessage	= NULL;
+
+	theFile = fopen(aFileName, "wb");
+	if (theFile == NULL)
+		return u"Couldn't open output file for writing.";
+
+	if (fwrite(someBytes, 1, aNumBytes, theFile) != aNumBytes)
+		theErrorMessage = u"Couldn't write output file.";
+
+	if (fclose(theFile) != 0 && theErrorMessage == NULL)
+		theErrorMessage = u"Couldn't finish writing output file.";
+
+	return theErrorMessage;
+}
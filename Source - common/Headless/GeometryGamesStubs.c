@@ -0,0 +1,132 @@
+//	GeometryGamesStubs.c
+//
+//	Minimal implementations of the few Geometry Games framework
+//	functions and platform-dependent functions that the
+//	platform-independent C code calls, so the C code may build
+//	and run without Xcode.
+//	Only the headless build uses this file.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#include "CurvedSpaces-Common.h"
+#include "GeometryGamesMatrix44.h"
+#include "GeometryGamesUtilities-Common.h"
+#include <stdio.h>
+
+
+static void	PrintUTF16AsUTF8(FILE *aStream, const Char16 *aString);
+
+
+void Matrix44Identity(double m[4][4])
+{
+	unsigned int	i,
+					j;
+
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			m[i][j] = (i == j ? 1.0 : 0.0);
+}
+
+void Matrix44Copy(
+	double	aDst[4][4],
+	double	aSrc[4][4])
+{
+	unsigned int	i,
+					j;
+
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 4; j++)
+			aDst[i][j] = aSrc[i][j];
+}
+
+void Matrix44Product(
+	double	a[4][4],
+	double	b[4][4],
+	double	aProduct[4][4])	//	may coincide with a or b
+{
+	unsigned int	i,
+					j,
+					k;
+	double			theProduct[4][4];
+
+	for (i = 0; i < 4; i++)
+	{
+		for (j = 0; j < 4; j++)
+		{
+			theProduct[i][j] = 0.0;
+			for (k = 0; k < 4; k++)
+				theProduct[i][j] += a[i][k] * b[k][j];
+		}
+	}
+
+	Matrix44Copy(aProduct, theProduct);
+}
+
+
+//	The headless build has no profiler to mark frame intervals for.
+//	The benchmark suite does its own timing.
+
+void BeginFrameInterval(FrameInterval anInterval)
+{
+	UNUSED_PARAMETER(anInterval);
+}
+
+void EndFrameInterval(FrameInterval anInterval)
+{
+	UNUSED_PARAMETER(anInterval);
+}
+
+
+void GeometryGamesErrorMessage(
+	ErrorText	aMessage,
+	ErrorText	aTitle)		//	may be NULL
+{
+	//	With no user interface, write the message to stderr.
+	if (aTitle != NULL)
+	{
+		PrintUTF16AsUTF8(stderr, aTitle);
+		fputs(": ", stderr);
+	}
+	PrintUTF16AsUTF8(stderr, aMessage);
+	fputc('\n', stderr);
+}
+
+static void PrintUTF16AsUTF8(
+	FILE			*aStream,
+	const Char16	*aString)	//	zero-terminated UTF-16
+{
+	uint32_t	c;
+
+	while (*aString != 0)
+	{
+		c = *aString++;
+
+		//	Combine a surrogate pair.
+		if (c >= 0xD800 && c <= 0xDBFF && *aString >= 0xDC00 && *aString <= 0xDFFF)
+			c = 0x10000 + ((c - 0xD800) << 10) + (*aString++ - 0xDC00);
+
+		if (c < 0x80)
+			fputc((int) c, aStream);
+		else
+		if (c < 0x800)
+		{
+			fputc((int)(0xC0 | (c >> 6)),			aStream);
+			fputc((int)(0x80 | (c & 0x3F)),			aStream);
+		}
+		else
+		if (c < 0x10000)
+		{
+			fputc((int)(0xE0 | (c >> 12)),			aStream);
+			fputc((int)(0x80 | ((c >> 6) & 0x3F)),	aStream);
+			fputc((int)(0x80 | (c & 0x3F)),			aStream);
+		}
+		else
+		{
+			fputc((int)(0xF0 | (c >> 18)),			aStream);
+			fputc((int)(0x80 | ((c >> 12) & 0x3F)),	aStream);
+			fputc((int)(0x80 | ((c >> 6) & 0x3F)),	aStream);
+			fputc((int)(0x80 | (c & 0x3F)),			aStream);
+		}
+	}
+}
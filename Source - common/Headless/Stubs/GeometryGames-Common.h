@@ -0,0 +1,91 @@
+//	GeometryGames-Common.h
+//
+//	A minimal stand-in for the Geometry Games framework's header
+//	of the same name, providing just what the platform-independent
+//	C code needs, so the C code may build without Xcode.
+//	Only the headless build uses this file.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>		//	for fprintf()
+#include <stdlib.h>		//	for malloc(), free() and abort()
+#include <uchar.h>		//	for char16_t
+
+
+//	Clang supports __fp16 as a storage format on all targets.
+//	GCC supports it only on ARM, but offers _Float16 on x86-64.
+#if defined(__GNUC__) && ! defined(__clang__) && ! defined(__ARM_FP16_FORMAT_IEEE)
+#define __fp16	_Float16
+#endif
+
+
+typedef uint8_t			Byte;
+typedef char16_t		Char16;
+
+//	A NULL ErrorText means success.
+typedef const Char16	*ErrorText;
+
+//	The platform-independent code declares struct ModelData.
+typedef struct ModelData	ModelData;
+
+//	The platform-dependent code reports mouse positions and motions
+//	relative to the view's size.
+typedef struct
+{
+	double	itsX,
+			itsY,
+			itsViewWidth,
+			itsViewHeight;
+} DisplayPoint;
+
+typedef struct
+{
+	double	itsDeltaX,
+			itsDeltaY,
+			itsViewWidth,
+			itsViewHeight;
+} DisplayPointMotion;
+
+
+#define GET_MEMORY(n)			malloc(n)
+#define FREE_MEMORY(p)			free(p)
+#define FREE_MEMORY_SAFELY(p)	do { free(p); (p) = NULL; } while (0)
+
+#define BUFFER_LENGTH(a)		(sizeof(a) / sizeof((a)[0]))
+#define UNUSED_PARAMETER(p)		((void)(p))
+
+//	Colors are pre-multiplied (αR, αG, αB, α).
+#define PREMULTIPLY_RGBA(r,g,b,a)	{(r)*(a), (g)*(a), (b)*(a), (a)}
+
+#define GEOMETRY_GAMES_ABORT(aMessage)												\
+	do																				\
+	{																				\
+		fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, aMessage);				\
+		abort();																	\
+	} while (0)
+
+#ifdef NDEBUG
+#define GEOMETRY_GAMES_ASSERT(aCondition, aMessage)	((void)0)
+#else
+#define GEOMETRY_GAMES_ASSERT(aCondition, aMessage)									\
+	do																				\
+	{																				\
+		if ( ! (aCondition) )														\
+			GEOMETRY_GAMES_ABORT(aMessage);											\
+	} while (0)
+#endif
+
+
+//	The framework declares the model and simulation entry points,
+//	and the application's C code defines them.
+extern unsigned int	SizeOfModelData(void);
+extern void			SetUpModelData(ModelData *md);
+extern void			ShutDownModelData(ModelData *md);
+extern bool			SimulationWantsUpdates(ModelData *md);
+extern void			SimulationUpdate(ModelData *md, double aFramePeriod);
@@ -0,0 +1,16 @@
+//	GeometryGamesLocalization.h
+//
+//	Stand-in for the Geometry Games framework's localization header.
+//	The headless build has no language files, so only
+//	GetLanguageFileBaseName()'s prototype is needed.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#pragma once
+
+#include "GeometryGames-Common.h"
+
+
+//	in CurvedSpacesInit.c
+extern const Char16	*GetLanguageFileBaseName(void);
@@ -0,0 +1,15 @@
+//	GeometryGamesMatrix44.h
+//
+//	Stand-in for the Geometry Games framework's 4×4 matrix utilities.
+//	Only the headless build uses this file.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#pragma once
+
+
+//	in GeometryGamesStubs.c
+extern void	Matrix44Identity(double m[4][4]);
+extern void	Matrix44Copy(double aDst[4][4], /*const*/ double aSrc[4][4]);
+extern void	Matrix44Product(/*const*/ double a[4][4], /*const*/ double b[4][4], double aProduct[4][4]);
@@ -0,0 +1,15 @@
+//	GeometryGamesUtilities-Common.h
+//
+//	Stand-in for the Geometry Games framework's utilities.
+//	Only the headless build uses this file.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#pragma once
+
+#include "GeometryGames-Common.h"
+
+
+//	in GeometryGamesStubs.c
+extern void	GeometryGamesErrorMessage(ErrorText aMessage, ErrorText aTitle);
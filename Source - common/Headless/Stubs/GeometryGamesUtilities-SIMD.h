@@ -0,0 +1,30 @@
+//	GeometryGamesUtilities-SIMD.h
+//
+//	Stand-in for Apple's <simd/simd.h> types, as the framework
+//	would import them.  Only the headless build uses this file.
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#pragma once
+
+
+#ifdef __clang__
+typedef float			simd_float4	__attribute__((ext_vector_type(4)));
+typedef int				simd_int4	__attribute__((ext_vector_type(4)));
+typedef unsigned int	simd_uint4	__attribute__((ext_vector_type(4)));
+typedef double			simd_double4	__attribute__((ext_vector_type(4)));
+typedef long			simd_long4	__attribute__((ext_vector_type(4)));
+#else
+typedef float			simd_float4	__attribute__((vector_size(16)));
+typedef int				simd_int4	__attribute__((vector_size(16)));
+typedef unsigned int	simd_uint4	__attribute__((vector_size(16)));
+typedef double			simd_double4	__attribute__((vector_size(32)));
+typedef long			simd_long4	__attribute__((vector_size(32)));
+#endif
+
+
+static inline simd_float4 simd_abs(simd_float4 x)
+{
+	return (simd_float4){__builtin_fabsf(x[0]), __builtin_fabsf(x[1]), __builtin_fabsf(x[2]), __builtin_fabsf(x[3])};
+}
@@ -0,0 +1,47 @@
+//	CurvedSpacesBatchRenderer.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import "CurvedSpaces-Common.h"
+
+@class CurvedSpacesRenderer;
+@class GeometryGamesModel;
+
+
+//	A CurvedSpacesBatchRenderer renders a sequence of frames offscreen
+//	and writes them to disk as numbered PNG files (frame00000.png,
+//	frame00001.png, …), for example to make a video.
+//
+//	Up to NUM_BATCH_FRAMES_IN_FLIGHT frames are in flight at once:
+//	while the GPU renders one frame, the CPU prepares the next one
+//	and a serial queue encodes and writes a previous one.
+//	Each frame's buffers and render targets get re-used
+//	once the frame's file has been written, so the GPU never waits
+//	on a readback and a long batch allocates no new memory.
+//
+//	An image larger than the GPU's maximum texture size gets rendered
+//	as a grid of tiles, which reassemble into a single file.
+//
+//	The batch renderer shares the on-screen renderer's meshes and buffers,
+//	as well as the model's ModelData, so the caller should pause
+//	the on-screen animation during a batch.  The render methods
+//	don't return until the last file has been written, so call them
+//	from a background thread.
+
+@interface CurvedSpacesBatchRenderer : NSObject
+
+- (id)initWithRenderer:(CurvedSpacesRenderer *)aRenderer model:(GeometryGamesModel *)aModel;
+
+//	Renders one frame for each of someUserBodyPlacements,
+//	leaving the rest of the ModelData unchanged.
+- (ErrorText)renderCameraPath:(const Matrix *)someUserBodyPlacements numFrames:(unsigned int)aNumFrames
+	imageSize:(CGSize)anImageSize outputDirectory:(NSURL *)anOutputDirectory;
+
+//	Renders aNumFrames frames, advancing the simulation
+//	by aFramePeriod seconds before each one.
+- (ErrorText)renderSimulationForNumFrames:(unsigned int)aNumFrames framePeriod:(double)aFramePeriod
+	imageSize:(CGSize)anImageSize outputDirectory:(NSURL *)anOutputDirectory;
+
+@end
@@ -0,0 +1,471 @@
+//	CurvedSpacesBatchRenderer.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesBatchRenderer.h"
+#import "CurvedSpacesRenderer.h"
+#import "GeometryGamesModel.h"
+#import <ImageIO/ImageIO.h>
+
+
+//	Where a finished frame's pixels sit in its readback buffer.
+typedef struct
+{
+	MTLPixelFormat	itsPixelFormat;
+	NSUInteger		itsWidth,
+					itsHeight,
+					itsBytesPerPixel,
+					itsBytesPerRow;
+} ReadbackLayout;
+
+
+static ErrorText	GetBytesPerPixel(MTLPixelFormat aPixelFormat, NSUInteger *aBytesPerPixel);
+static ErrorText	WriteFrameToURL(const Byte *somePixels, ReadbackLayout aLayout, NSURL *aURL);
+static NSData		*ConvertExtendedRangePixels(const Byte *somePixels, ReadbackLayout aLayout);
+static __fp16		DecodeExtendedRangeComponent(unsigned int aTenBitValue);
+
+
+@implementation CurvedSpacesBatchRenderer
+{
+	CurvedSpacesRenderer		*itsRenderer;
+	GeometryGamesModel * __weak	itsModel;
+
+	//	Created with the first batch, on the render targets' device.
+	id<MTLCommandQueue>			itsCommandQueue;
+
+	//	A serial queue, so finished frames get encoded and written
+	//	one at a time, in order.
+	dispatch_queue_t			itsWriterQueue;
+
+	//	Set on itsWriterQueue when a frame fails,
+	//	read on the rendering thread to stop the batch early.
+	atomic_bool					itsFailureFlag;
+}
+
+
+- (id)initWithRenderer:(CurvedSpacesRenderer *)aRenderer model:(GeometryGamesModel *)aModel
+{
+	self = [super init];
+	if (self != nil)
+	{
+		itsRenderer		= aRenderer;
+		itsModel		= aModel;
+		itsCommandQueue	= nil;
+		itsWriterQueue	= dispatch_queue_create("Curved Spaces batch frame writer",
+							dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+		atomic_init(&itsFailureFlag, false);
+	}
+	return self;
+}
+
+
+- (ErrorText)renderCameraPath:(const Matrix *)someUserBodyPlacements numFrames:(unsigned int)aNumFrames
+	imageSize:(CGSize)anImageSize outputDirectory:(NSURL *)anOutputDirectory
+{
+	return [self renderNumFrames:aNumFrames imageSize:anImageSize outputDirectory:anOutputDirectory
+		updatingModelData:^(ModelData *md, unsigned int aFrameIndex)
+		{
+			md->itsUserBodyPlacement = someUserBodyPlacements[aFrameIndex];
+			md->itsChangeCount++;
+		}];
+}
+
+- (ErrorText)renderSimulationForNumFrames:(unsigned int)aNumFrames framePeriod:(double)aFramePeriod
+	imageSize:(CGSize)anImageSize outputDirectory:(NSURL *)anOutputDirectory
+{
+	return [self renderNumFrames:aNumFrames imageSize:anImageSize outputDirectory:anOutputDirectory
+		updatingModelData:^(ModelData *md, unsigned int aFrameIndex)
+		{
+			UNUSED_PARAMETER(aFrameIndex);
+
+			SimulationUpdate(md, aFramePeriod);
+		}];
+}
+
+- (ErrorText)renderNumFrames:(unsigned int)aNumFrames imageSize:(CGSize)anImageSize outputDirectory:(NSURL *)anOutputDirectory
+	updatingModelData:(void (^)(ModelData *md, unsigned int aFrameIndex))anUpdateBlock
+{
+	ErrorText					theErrorMessage	= NULL;
+	__block ErrorText			theFrameError	= NULL;	//	accessed only on itsWriterQueue
+	GeometryGamesModel			*theModel;
+	ModelData					*md				= NULL;
+	NSUInteger					theMaxTileSize,
+								theNumTilesX,
+								theNumTilesY,
+								theTileWidth,
+								theTileHeight;
+	unsigned int				theNumTiles,
+								theFrame,
+								theSlot,
+								i,
+								j;
+	CGRect						*theTiles		= NULL;
+	MTLRenderPassDescriptor		*theRenderPassDescriptors[NUM_BATCH_FRAMES_IN_FLIGHT];
+	id<MTLTexture>				theTileTextures[NUM_BATCH_FRAMES_IN_FLIGHT];
+	id<MTLBuffer>				theReadbackBuffers[NUM_BATCH_FRAMES_IN_FLIGHT];
+	ReadbackLayout				theLayout;
+	dispatch_semaphore_t		theInflightSemaphore;
+	id<MTLCommandBuffer>		theCommandBuffer;
+	NSDictionary<NSString *, id>	*theInflightDataBuffers;
+	NSArray<id<MTLBuffer>>		*theUniformBuffers;
+	MTLOrigin					theTileOrigin;
+	MTLSize						theVisibleTileSize;
+	id<MTLBlitCommandEncoder>	theBlitEncoder;
+	id<MTLBuffer>				theReadbackBuffer;
+	NSURL						*theFileURL;
+
+	theModel = itsModel;
+	if (theModel == nil)
+		return u"The batch renderer has no model";
+
+	if (anImageSize.width < 1.0 || anImageSize.height < 1.0)
+		return u"A batch render's image size must be at least 1×1";
+
+	atomic_store(&itsFailureFlag, false);
+
+	//	Split an image that's too large for a single texture into a grid
+	//	of equal-sized tiles.  The tiles along the right and bottom edges
+	//	may overhang the image, in which case only their visible parts
+	//	get copied out.  Keeping all tiles the same size lets them
+	//	share a single set of render targets.
+	theLayout.itsWidth	= (NSUInteger) anImageSize.width;
+	theLayout.itsHeight	= (NSUInteger) anImageSize.height;
+	theMaxTileSize		= [itsRenderer maxBatchTileSize];
+	theNumTilesX		= (theLayout.itsWidth  + theMaxTileSize - 1) / theMaxTileSize;
+	theNumTilesY		= (theLayout.itsHeight + theMaxTileSize - 1) / theMaxTileSize;
+	theTileWidth		= (theLayout.itsWidth  + theNumTilesX   - 1) / theNumTilesX;
+	theTileHeight		= (theLayout.itsHeight + theNumTilesY   - 1) / theNumTilesY;
+	theNumTiles			= (unsigned int) (theNumTilesX * theNumTilesY);
+
+	theTiles = GET_MEMORY(theNumTiles * sizeof(CGRect));
+	if (theTiles == NULL)
+		return u"Couldn't allocate memory for the batch render's tiles";
+	for (j = 0; j < theNumTilesY; j++)
+		for (i = 0; i < theNumTilesX; i++)
+			theTiles[j*theNumTilesX + i] = CGRectMake(i * theTileWidth, j * theTileHeight, theTileWidth, theTileHeight);
+
+	//	Give each frame in flight its own render targets and readback buffer.
+	[theModel lockModelData:&md];
+	for (theSlot = 0; theSlot < NUM_BATCH_FRAMES_IN_FLIGHT; theSlot++)
+	{
+		theRenderPassDescriptors[theSlot] = [itsRenderer
+			makeBatchRenderPassDescriptorForTileSize:	(CGSize){theTileWidth, theTileHeight}
+			modelData:									md];
+		theTileTextures[theSlot] = [[theRenderPassDescriptors[theSlot] colorAttachments][0] resolveTexture];
+		if (theTileTextures[theSlot] == nil)
+			theTileTextures[theSlot] = [[theRenderPassDescriptors[theSlot] colorAttachments][0] texture];
+	}
+	[theModel unlockModelData:&md];
+
+	if (theTileTextures[0] == nil)
+	{
+		theErrorMessage = u"Couldn't create the batch render's render targets";
+		goto CleanUpRenderNumFrames;
+	}
+
+	theLayout.itsPixelFormat = [theTileTextures[0] pixelFormat];
+	theErrorMessage = GetBytesPerPixel(theLayout.itsPixelFormat, &theLayout.itsBytesPerPixel);
+	if (theErrorMessage != NULL)
+		goto CleanUpRenderNumFrames;
+	theLayout.itsBytesPerRow = theLayout.itsWidth * theLayout.itsBytesPerPixel;
+
+	if (itsCommandQueue == nil)
+		itsCommandQueue = [[theTileTextures[0] device] newCommandQueue];
+
+	for (theSlot = 0; theSlot < NUM_BATCH_FRAMES_IN_FLIGHT; theSlot++)
+	{
+		theReadbackBuffers[theSlot] = [[theTileTextures[0] device]
+			newBufferWithLength:	theLayout.itsBytesPerRow * theLayout.itsHeight
+			options:				MTLResourceStorageModeShared];
+		if (theReadbackBuffers[theSlot] == nil)
+		{
+			theErrorMessage = u"Couldn't allocate the batch render's readback buffers";
+			goto CleanUpRenderNumFrames;
+		}
+	}
+
+	//	Each frame in flight holds one count of theInflightSemaphore,
+	//	from the time the CPU starts preparing it until its file
+	//	has been written.
+	theInflightSemaphore = dispatch_semaphore_create(NUM_BATCH_FRAMES_IN_FLIGHT);
+
+	for (theFrame = 0; theFrame < aNumFrames; theFrame++)
+	{
+		dispatch_semaphore_wait(theInflightSemaphore, DISPATCH_TIME_FOREVER);
+
+		//	If an earlier frame failed, don't bother with the rest.
+		if (atomic_load(&itsFailureFlag))
+		{
+			dispatch_semaphore_signal(theInflightSemaphore);
+			break;
+		}
+
+		theSlot				= theFrame % NUM_BATCH_FRAMES_IN_FLIGHT;
+		theReadbackBuffer	= theReadbackBuffers[theSlot];
+		theFileURL			= [anOutputDirectory URLByAppendingPathComponent:
+								[NSString stringWithFormat:@"frame%05u.png", theFrame]];
+		theCommandBuffer	= [itsCommandQueue commandBuffer];
+
+		[theModel lockModelData:&md];
+
+		anUpdateBlock(md, theFrame);
+
+		theInflightDataBuffers	= [itsRenderer
+									prepareInflightDataBuffersForBatchFrameAtIndex:	theSlot
+									imageSize:										anImageSize
+									tiles:											theTiles
+									numTiles:										theNumTiles
+									modelData:										md];
+		theUniformBuffers		= [theInflightDataBuffers objectForKey:@"uniform buffers"];
+
+		//	Render each tile in turn into the slot's render targets,
+		//	and copy its visible part into place in the readback buffer.
+		//	Metal's hazard tracking keeps each tile's render pass
+		//	from starting before the previous tile's copy has finished.
+		for (i = 0; i < theNumTiles; i++)
+		{
+			[itsRenderer encodeCommandsToCommandBuffer:	theCommandBuffer
+							withRenderPassDescriptor:	theRenderPassDescriptors[theSlot]
+							inflightDataBuffers:		@{
+															@"uniform buffer":		theUniformBuffers[i],
+															@"tiling buffer set":	[theInflightDataBuffers objectForKey:@"tiling buffer set"]
+														}
+							modelData:					md];
+
+			theTileOrigin		= MTLOriginMake((NSUInteger) theTiles[i].origin.x, (NSUInteger) theTiles[i].origin.y, 0);
+			theVisibleTileSize	= MTLSizeMake(
+									MIN(theTileWidth,  theLayout.itsWidth  - theTileOrigin.x),
+									MIN(theTileHeight, theLayout.itsHeight - theTileOrigin.y),
+									1);
+
+			theBlitEncoder = [theCommandBuffer blitCommandEncoder];
+			[theBlitEncoder
+				copyFromTexture:			theTileTextures[theSlot]
+				sourceSlice:				0
+				sourceLevel:				0
+				sourceOrigin:				MTLOriginMake(0, 0, 0)
+				sourceSize:					theVisibleTileSize
+				toBuffer:					theReadbackBuffer
+				destinationOffset:			theTileOrigin.y * theLayout.itsBytesPerRow
+											  + theTileOrigin.x * theLayout.itsBytesPerPixel
+				destinationBytesPerRow:		theLayout.itsBytesPerRow
+				destinationBytesPerImage:	theVisibleTileSize.height * theLayout.itsBytesPerRow];
+			[theBlitEncoder endEncoding];
+		}
+
+		[theModel unlockModelData:&md];
+
+		//	Rather than waiting for the GPU, hand the finished frame
+		//	to itsWriterQueue and move on to the next one.
+		[theCommandBuffer addCompletedHandler:^(id<MTLCommandBuffer> aCommandBuffer)
+		{
+			dispatch_async(self->itsWriterQueue,
+			^{
+				if (theFrameError == NULL)
+				{
+					if ([aCommandBuffer status] == MTLCommandBufferStatusError)
+						theFrameError = u"The GPU failed to render a batch frame";
+					else
+						theFrameError = WriteFrameToURL([theReadbackBuffer contents], theLayout, theFileURL);
+
+					if (theFrameError != NULL)
+						atomic_store(&self->itsFailureFlag, true);
+				}
+
+				dispatch_semaphore_signal(theInflightSemaphore);
+			});
+		}];
+		[theCommandBuffer commit];
+	}
+
+	//	Wait for the last frames to get written.  Restore the semaphore's
+	//	original count afterwards, as libdispatch requires
+	//	before it releases the semaphore.
+	for (theSlot = 0; theSlot < NUM_BATCH_FRAMES_IN_FLIGHT; theSlot++)
+		dispatch_semaphore_wait(theInflightSemaphore, DISPATCH_TIME_FOREVER);
+	for (theSlot = 0; theSlot < NUM_BATCH_FRAMES_IN_FLIGHT; theSlot++)
+		dispatch_semaphore_signal(theInflightSemaphore);
+
+	//	All frames have been written, so theFrameError is now stable.
+	dispatch_sync(itsWriterQueue, ^{});
+	theErrorMessage = theFrameError;
+
+CleanUpRenderNumFrames:
+
+	FREE_MEMORY_SAFELY(theTiles);
+
+	return theErrorMessage;
+}
+
+@end
+
+
+static ErrorText GetBytesPerPixel(
+	MTLPixelFormat	aPixelFormat,
+	NSUInteger		*aBytesPerPixel)	//	output
+{
+	switch (aPixelFormat)
+	{
+		case MTLPixelFormatBGRA8Unorm:
+		case MTLPixelFormatBGRA8Unorm_sRGB:
+		case MTLPixelFormatBGR10_XR:
+		case MTLPixelFormatBGR10_XR_sRGB:
+			*aBytesPerPixel = 4;
+			return NULL;
+
+		case MTLPixelFormatRGBA16Float:
+		case MTLPixelFormatBGRA10_XR:
+		case MTLPixelFormatBGRA10_XR_sRGB:
+			*aBytesPerPixel = 8;
+			return NULL;
+
+		default:
+			*aBytesPerPixel = 0;
+			return u"The batch renderer doesn't know how to save frames in the renderer's pixel format";
+	}
+}
+
+static ErrorText WriteFrameToURL(
+	const Byte		*somePixels,
+	ReadbackLayout	aLayout,
+	NSURL			*aURL)
+{
+	ErrorText				theErrorMessage	= NULL;
+	NSData					*theConvertedPixels;
+	CFStringRef				theColorSpaceName;
+	CGColorSpaceRef			theColorSpace	= NULL;
+	CGDataProviderRef		theDataProvider	= NULL;
+	CGImageRef				theImage		= NULL;
+	CGImageDestinationRef	theDestination	= NULL;
+
+	//	The renderer works in Display P3.  Linear pixel formats hold
+	//	linear color components, while the _sRGB formats hold
+	//	gamma-encoded ones.  The extended-range formats may hold values
+	//	outside [0,1], which PNG clamps.
+	switch (aLayout.itsPixelFormat)
+	{
+		case MTLPixelFormatBGRA8Unorm:		theColorSpaceName = kCGColorSpaceLinearDisplayP3;			break;
+		case MTLPixelFormatBGRA8Unorm_sRGB:	theColorSpaceName = kCGColorSpaceDisplayP3;					break;
+		case MTLPixelFormatRGBA16Float:
+		case MTLPixelFormatBGR10_XR:
+		case MTLPixelFormatBGRA10_XR:		theColorSpaceName = kCGColorSpaceExtendedLinearDisplayP3;	break;
+		case MTLPixelFormatBGR10_XR_sRGB:
+		case MTLPixelFormatBGRA10_XR_sRGB:	theColorSpaceName = kCGColorSpaceExtendedDisplayP3;			break;
+		default:							return u"Unexpected pixel format in WriteFrameToURL()";
+	}
+	theColorSpace = CGColorSpaceCreateWithName(theColorSpaceName);
+
+	switch (aLayout.itsPixelFormat)
+	{
+		case MTLPixelFormatBGRA8Unorm:
+		case MTLPixelFormatBGRA8Unorm_sRGB:
+
+			//	The readback buffer stays untouched until this function returns,
+			//	so the image may read straight from it.
+			theDataProvider	= CGDataProviderCreateWithData(NULL, somePixels, aLayout.itsBytesPerRow * aLayout.itsHeight, NULL);
+			theImage		= CGImageCreate(aLayout.itsWidth, aLayout.itsHeight, 8, 32, aLayout.itsBytesPerRow,
+								theColorSpace, kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst,
+								theDataProvider, NULL, false, kCGRenderingIntentDefault);
+			break;
+
+		case MTLPixelFormatRGBA16Float:
+
+			theDataProvider	= CGDataProviderCreateWithData(NULL, somePixels, aLayout.itsBytesPerRow * aLayout.itsHeight, NULL);
+			theImage		= CGImageCreate(aLayout.itsWidth, aLayout.itsHeight, 16, 64, aLayout.itsBytesPerRow,
+								theColorSpace, kCGBitmapByteOrder16Little | kCGImageAlphaPremultipliedLast | kCGBitmapFloatComponents,
+								theDataProvider, NULL, false, kCGRenderingIntentDefault);
+			break;
+
+		default:	//	extended-range formats
+
+			//	Core Graphics doesn't understand the XR formats' biased
+			//	10-bit components, so convert them to half-precision RGBA.
+			theConvertedPixels = ConvertExtendedRangePixels(somePixels, aLayout);
+			theDataProvider	= CGDataProviderCreateWithCFData((__bridge CFDataRef) theConvertedPixels);
+			theImage		= CGImageCreate(aLayout.itsWidth, aLayout.itsHeight, 16, 64, aLayout.itsWidth * 4 * sizeof(__fp16),
+								theColorSpace, kCGBitmapByteOrder16Little | kCGImageAlphaPremultipliedLast | kCGBitmapFloatComponents,
+								theDataProvider, NULL, false, kCGRenderingIntentDefault);
+			break;
+	}
+	if (theImage == NULL)
+	{
+		theErrorMessage = u"Couldn't make an image from a batch frame";
+		goto CleanUpWriteFrameToURL;
+	}
+
+	theDestination = CGImageDestinationCreateWithURL((__bridge CFURLRef) aURL, CFSTR("public.png"), 1, NULL);
+	if (theDestination == NULL)
+	{
+		theErrorMessage = u"Couldn't create a batch frame's output file";
+		goto CleanUpWriteFrameToURL;
+	}
+	CGImageDestinationAddImage(theDestination, theImage, NULL);
+	if ( ! CGImageDestinationFinalize(theDestination) )
+	{
+		theErrorMessage = u"Couldn't write a batch frame's output file";
+		goto CleanUpWriteFrameToURL;
+	}
+
+CleanUpWriteFrameToURL:
+
+	if (theDestination != NULL)
+		CFRelease(theDestination);
+	CGImageRelease(theImage);
+	CGDataProviderRelease(theDataProvider);
+	CGColorSpaceRelease(theColorSpace);
+
+	return theErrorMessage;
+}
+
+static NSData *ConvertExtendedRangePixels(
+	const Byte		*somePixels,
+	ReadbackLayout	aLayout)
+{
+	NSMutableData	*theConvertedPixels;
+	__fp16			(*theOutput)[4];
+	NSUInteger		theNumPixels,
+					i;
+	uint32_t		thePackedPixel;
+	const uint16_t	*theComponents;
+
+	theNumPixels		= aLayout.itsWidth * aLayout.itsHeight;
+	theConvertedPixels	= [[NSMutableData alloc] initWithLength:theNumPixels * sizeof(__fp16 [4])];
+	theOutput			= (__fp16 (*)[4]) [theConvertedPixels mutableBytes];
+
+	for (i = 0; i < theNumPixels; i++)
+	{
+		switch (aLayout.itsPixelFormat)
+		{
+			case MTLPixelFormatBGR10_XR:
+			case MTLPixelFormatBGR10_XR_sRGB:
+
+				//	blue in bits 0-9, green in bits 10-19, red in bits 20-29
+				thePackedPixel	= ((const uint32_t *) somePixels)[i];
+				theOutput[i][0]	= DecodeExtendedRangeComponent((thePackedPixel >> 20) & 0x3FF);
+				theOutput[i][1]	= DecodeExtendedRangeComponent((thePackedPixel >> 10) & 0x3FF);
+				theOutput[i][2]	= DecodeExtendedRangeComponent((thePackedPixel >>  0) & 0x3FF);
+				theOutput[i][3]	= 1.0;
+				break;
+
+			default:	//	MTLPixelFormatBGRA10_XR or MTLPixelFormatBGRA10_XR_sRGB
+
+				//	blue, green, red, alpha, each in the top 10 bits of 16
+				theComponents	= (const uint16_t *) (somePixels + i * aLayout.itsBytesPerPixel);
+				theOutput[i][0]	= DecodeExtendedRangeComponent(theComponents[2] >> 6);
+				theOutput[i][1]	= DecodeExtendedRangeComponent(theComponents[1] >> 6);
+				theOutput[i][2]	= DecodeExtendedRangeComponent(theComponents[0] >> 6);
+				theOutput[i][3]	= DecodeExtendedRangeComponent(theComponents[3] >> 6);
+				break;
+		}
+	}
+
+	return theConvertedPixels;
+}
+
+static __fp16 DecodeExtendedRangeComponent(unsigned int aTenBitValue)
+{
+	//	The XR formats map [0,1] onto [384,894],
+	//	leaving room for values from about -0.75 to +1.25.
+	return (__fp16) (((double) aTenBitValue - 384.0) / 510.0);
+}
@@ -0,0 +1,29 @@
+//	CurvedSpacesBenchmark.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import "CurvedSpaces-Common.h"
+
+@class CurvedSpacesRenderer;
+@class GeometryGamesModel;
+
+
+//	A CurvedSpacesBenchmark runs BenchmarkSpace() on every generator file
+//	in the app's Sample Spaces folder, in a fixed order, rendering
+//	each frame of each fly-through offscreen so the report includes
+//	the renderer's CPU time and the GPU time as well.
+//
+//	The benchmark replaces the model's current space, and shares
+//	the on-screen renderer's meshes and buffers, so it's meant
+//	for builds with RUN_BENCHMARKS enabled.  -runWritingReportToURL:
+//	doesn't return until the report has been written,
+//	so call it from a background thread.
+
+@interface CurvedSpacesBenchmark : NSObject
+
+- (id)initWithRenderer:(CurvedSpacesRenderer *)aRenderer model:(GeometryGamesModel *)aModel;
+- (ErrorText)runWritingReportToURL:(NSURL *)aReportURL;
+
+@end
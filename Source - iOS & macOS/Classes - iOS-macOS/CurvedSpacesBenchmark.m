@@ -0,0 +1,201 @@
+//	CurvedSpacesBenchmark.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesBenchmark.h"
+#import "CurvedSpacesRenderer.h"
+#import "GeometryGamesModel.h"
+
+
+static void	RenderBenchmarkFrame(void *aHookContext, ModelData *md, double *aCPUEncodeSeconds, double *aGPUSeconds);
+
+
+@interface CurvedSpacesBenchmark()
+- (void)renderFrameWithModelData:(ModelData *)md encodeSeconds:(double *)aCPUEncodeSeconds gpuSeconds:(double *)aGPUSeconds;
+@end
+
+
+@implementation CurvedSpacesBenchmark
+{
+	CurvedSpacesRenderer		*itsRenderer;
+	GeometryGamesModel * __weak	itsModel;
+
+	//	Each fly-through renders one frame at a time,
+	//	using the first of the renderer's batch buffer sets.
+	id<MTLCommandQueue>			itsCommandQueue;
+	MTLRenderPassDescriptor		*itsRenderPassDescriptor;
+}
+
+
+- (id)initWithRenderer:(CurvedSpacesRenderer *)aRenderer model:(GeometryGamesModel *)aModel
+{
+	self = [super init];
+	if (self != nil)
+	{
+		itsRenderer				= aRenderer;
+		itsModel				= aModel;
+		itsCommandQueue			= nil;
+		itsRenderPassDescriptor	= nil;
+	}
+	return self;
+}
+
+- (ErrorText)runWritingReportToURL:(NSURL *)aReportURL
+{
+	ErrorText						theErrorMessage	= NULL;
+	GeometryGamesModel				*theModel;
+	ModelData						*md				= NULL;
+	NSURL							*theSampleSpacesURL;
+	NSDirectoryEnumerator<NSURL *>	*theEnumerator;
+	NSMutableArray<NSString *>		*theRelativePaths;
+	NSURL							*theURL;
+	NSString						*theRelativePath;
+	NSData							*theFileContents;
+	Byte							*theInputText	= NULL;
+	BenchmarkReport					theReport		= {0};
+
+	theModel = itsModel;
+	if (theModel == nil)
+		return u"The benchmark has no model";
+
+	//	Collect the generator files' paths relative to the Sample Spaces folder,
+	//	and sort them, so every run visits the spaces in the same order
+	//	and reports them under the same names.
+	theSampleSpacesURL	= [[[NSBundle mainBundle] resourceURL] URLByAppendingPathComponent:@"Sample Spaces" isDirectory:YES];
+	theEnumerator		= [[NSFileManager defaultManager] enumeratorAtURL:theSampleSpacesURL
+							includingPropertiesForKeys:nil options:0 errorHandler:nil];
+	theRelativePaths	= [[NSMutableArray<NSString *> alloc] init];
+	for (theURL in theEnumerator)
+	{
+		if ([[theURL pathExtension] isEqualToString:@"gen"])
+			[theRelativePaths addObject:[[theURL path] substringFromIndex:[[theSampleSpacesURL path] length] + 1]];
+	}
+	[theRelativePaths sortUsingSelector:@selector(compare:)];
+	if ([theRelativePaths count] == 0)
+		return u"The benchmark found no Sample Spaces";
+
+	[theModel lockModelData:&md];
+	itsRenderPassDescriptor = [itsRenderer
+		makeBatchRenderPassDescriptorForTileSize:	(CGSize){BENCHMARK_IMAGE_WIDTH, BENCHMARK_IMAGE_HEIGHT}
+		modelData:									md];
+	[theModel unlockModelData:&md];
+	if (itsCommandQueue == nil)
+		itsCommandQueue = [[[[itsRenderPassDescriptor colorAttachments][0] texture] device] newCommandQueue];
+
+	theErrorMessage = BeginBenchmarkReport(	&theReport,
+											BENCHMARK_IMAGE_WIDTH,
+											BENCHMARK_IMAGE_HEIGHT,
+											BENCHMARK_NUM_FRAMES,
+											BENCHMARK_FRAME_PERIOD);
+	if (theErrorMessage != NULL)
+		goto CleanUpRunWritingReport;
+
+	for (theRelativePath in theRelativePaths)
+	{
+		//	BenchmarkSpace() wants a zero-terminated copy of a text file.
+		theFileContents = [NSData dataWithContentsOfURL:[theSampleSpacesURL URLByAppendingPathComponent:theRelativePath]];
+		if (theFileContents == nil)
+		{
+			theErrorMessage = u"The benchmark couldn't read a Sample Space";
+			goto CleanUpRunWritingReport;
+		}
+		theInputText = (Byte *) GET_MEMORY([theFileContents length] + 1);
+		if (theInputText == NULL)
+		{
+			theErrorMessage = u"Couldn't get memory for a Sample Space's text";
+			goto CleanUpRunWritingReport;
+		}
+		[theFileContents getBytes:theInputText length:[theFileContents length]];
+		theInputText[[theFileContents length]] = 0;
+
+		[theModel lockModelData:&md];
+		theErrorMessage = BenchmarkSpace(	&theReport,
+											md,
+											[theRelativePath UTF8String],
+											theInputText,
+											[theFileContents length],
+											RenderBenchmarkFrame,
+											(__bridge void *) self);
+		[theModel unlockModelData:&md];
+
+		FREE_MEMORY_SAFELY(theInputText);
+
+		if (theErrorMessage != NULL)
+			goto CleanUpRunWritingReport;
+	}
+
+	theErrorMessage = EndBenchmarkReport(&theReport);
+	if (theErrorMessage != NULL)
+		goto CleanUpRunWritingReport;
+
+	if ( ! [[NSData dataWithBytes:theReport.itsText length:theReport.itsLength] writeToURL:aReportURL atomically:YES] )
+	{
+		theErrorMessage = u"Couldn't write the benchmark report";
+		goto CleanUpRunWritingReport;
+	}
+
+CleanUpRunWritingReport:
+
+	FREE_MEMORY_SAFELY(theInputText);
+	FreeBenchmarkReport(&theReport);
+
+	return theErrorMessage;
+}
+
+- (void)renderFrameWithModelData:(ModelData *)md encodeSeconds:(double *)aCPUEncodeSeconds gpuSeconds:(double *)aGPUSeconds
+{
+	CGRect							theFullImage;
+	double							theStartTime;
+	NSDictionary<NSString *, id>	*theInflightDataBuffers;
+	id<MTLCommandBuffer>			theCommandBuffer;
+
+	//	Time the CPU's work from preparing the frame's buffers
+	//	(which culls and sorts the honeycomb once again) through committing
+	//	the command buffer.  Then wait for the GPU, so its time
+	//	isn't confounded with the next frame's.
+
+	theFullImage = CGRectMake(0.0, 0.0, BENCHMARK_IMAGE_WIDTH, BENCHMARK_IMAGE_HEIGHT);
+
+	theStartTime = BenchmarkClock();
+
+	theInflightDataBuffers = [itsRenderer
+		prepareInflightDataBuffersForBatchFrameAtIndex:	0
+		imageSize:										theFullImage.size
+		tiles:											&theFullImage
+		numTiles:										1
+		modelData:										md];
+
+	theCommandBuffer = [itsCommandQueue commandBuffer];
+	[itsRenderer encodeCommandsToCommandBuffer:	theCommandBuffer
+					withRenderPassDescriptor:	itsRenderPassDescriptor
+					inflightDataBuffers:		@{
+													@"uniform buffer":		[theInflightDataBuffers objectForKey:@"uniform buffers"][0],
+													@"tiling buffer set":	[theInflightDataBuffers objectForKey:@"tiling buffer set"]
+												}
+					modelData:					md];
+	[theCommandBuffer commit];
+
+	*aCPUEncodeSeconds = BenchmarkClock() - theStartTime;
+
+	[theCommandBuffer waitUntilCompleted];
+	if ([theCommandBuffer status] == MTLCommandBufferStatusCompleted)
+		*aGPUSeconds = [theCommandBuffer GPUEndTime] - [theCommandBuffer GPUStartTime];
+	else
+		*aGPUSeconds = -1.0;	//	reported as null
+}
+
+@end
+
+
+static void RenderBenchmarkFrame(
+	void		*aHookContext,		//	the CurvedSpacesBenchmark
+	ModelData	*md,
+	double		*aCPUEncodeSeconds,	//	output
+	double		*aGPUSeconds)		//	output
+{
+	[(__bridge CurvedSpacesBenchmark *) aHookContext
+		renderFrameWithModelData:	md
+		encodeSeconds:				aCPUEncodeSeconds
+		gpuSeconds:					aGPUSeconds];
+}
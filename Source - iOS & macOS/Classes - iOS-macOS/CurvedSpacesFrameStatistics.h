@@ -0,0 +1,48 @@
+//	CurvedSpacesFrameStatistics.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import "CurvedSpaces-Common.h"
+#import "CurvedSpacesGPUDefinitions.h"	//	for MAX_NUM_LOD_LEVELS
+
+
+//	BeginFrameInterval() and EndFrameInterval() (declared
+//	in CurvedSpaces-Common.h) mark each interval of a frame's work
+//	as an os_signpost interval, for Instruments' Points of Interest track,
+//	and also time it.  The renderer closes each on-screen frame
+//	by calling RecordFrameCounters(), and reports the frame's GPU time
+//	from its command buffer's completion handler.
+//	FrameStatisticsSummary() averages the most recent frames'
+//	times and counters, for an on-screen overlay,
+//	while GetLatestFrameSeconds() reports the most recent frame's
+//	times alone, for the quality governor.
+//
+//	All these functions are thread-safe.
+
+typedef struct
+{
+	//	When the GPU culls the honeycomb, the CPU never learns
+	//	the cell counts, so they're all zero.
+	bool			itsGPUCullingFlag;
+
+	unsigned int	itsNumVisibleCells,
+					itsNumVisiblePlainCells,
+					itsNumVisibleReflectedCells,
+					itsNumInvertedCells;
+
+	//	How many instances of each level-of-detail,
+	//	summed over all meshes, did the frame draw?
+	unsigned int	itsNumInstancesPerLevel[MAX_NUM_LOD_LEVELS];
+
+	//	How many times did the renderer replace a tiling buffer
+	//	with a larger one (at 125% of the required size)?
+	unsigned int	itsNumBufferReallocations;
+} FrameCounters;
+
+
+extern void		RecordFrameCounters(const FrameCounters *someCounters);
+extern void		RecordFrameGPUTime(CFTimeInterval aGPUStartTime, CFTimeInterval aGPUEndTime);
+extern void		GetLatestFrameSeconds(double *aCPUSeconds, double *aGPUSeconds);
+extern NSString	*FrameStatisticsSummary(void);
@@ -0,0 +1,295 @@
+//	CurvedSpacesFrameStatistics.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesFrameStatistics.h"
+#import <QuartzCore/QuartzCore.h>	//	for CACurrentMediaTime()
+#import <os/lock.h>
+#import <os/signpost.h>
+
+
+//	How many frames should the rolling averages cover?
+#define NUM_FRAMES_TO_AVERAGE	60
+
+
+typedef struct
+{
+	double			itsIntervalSeconds[NumFrameIntervals];
+	FrameCounters	itsCounters;
+} FrameRecord;
+
+
+static void		MarkFrameInterval(FrameInterval anInterval, bool aBeginFlag, os_signpost_id_t aSignpostID);
+static os_log_t	GetFrameLog(void);
+
+
+//	Each thread keeps its own intervals' start times and signpost IDs,
+//	so an offscreen render on a background thread doesn't confuse
+//	the on-screen renderer's intervals.
+static __thread CFTimeInterval		gIntervalStartTimes[NumFrameIntervals];
+static __thread os_signpost_id_t	gIntervalSignpostIDs[NumFrameIntervals];
+
+//	gFrameLock protects everything below it.
+static os_unfair_lock	gFrameLock	= OS_UNFAIR_LOCK_INIT;
+
+//	Interval times accumulate here until the renderer
+//	closes the frame with RecordFrameCounters().
+static double			gCurrentIntervalSeconds[NumFrameIntervals];
+
+//	The most recent frames, in ring buffers.  The GPU times
+//	arrive asynchronously, so they get a ring buffer of their own.
+static FrameRecord		gFrameRecords[NUM_FRAMES_TO_AVERAGE];
+static unsigned int		gNextFrameRecord	= 0,
+						gNumFrameRecords	= 0;
+static double			gGPUSeconds[NUM_FRAMES_TO_AVERAGE];
+static unsigned int		gNextGPUTime		= 0,
+						gNumGPUTimes		= 0;
+
+
+//	os_signpost_interval_begin() and os_signpost_interval_end()
+//	require a string literal for the interval's name,
+//	so spell out each case.
+#define MARK_INTERVAL(aBeginFlag, aLog, anID, aName)		\
+	do														\
+	{														\
+		if (aBeginFlag)										\
+			os_signpost_interval_begin(aLog, anID, aName);	\
+		else												\
+			os_signpost_interval_end(aLog, anID, aName);	\
+	} while (0)
+
+static void MarkFrameInterval(
+	FrameInterval		anInterval,
+	bool				aBeginFlag,
+	os_signpost_id_t	aSignpostID)
+{
+	os_log_t	theLog	= GetFrameLog();
+
+	switch (anInterval)
+	{
+		case FrameIntervalSimulationUpdate:	MARK_INTERVAL(aBeginFlag, theLog, aSignpostID, "SimulationUpdate");			break;
+		case FrameIntervalCullAndSort:		MARK_INTERVAL(aBeginFlag, theLog, aSignpostID, "CullAndSortVisibleCells");	break;
+		case FrameIntervalWriteTiles:		MARK_INTERVAL(aBeginFlag, theLog, aSignpostID, "WriteSortedVisibleTiles");	break;
+		case FrameIntervalRewriteMeshes:	MARK_INTERVAL(aBeginFlag, theLog, aSignpostID, "RewriteMeshes");			break;
+		case FrameIntervalEncodeCommands:	MARK_INTERVAL(aBeginFlag, theLog, aSignpostID, "EncodeCommands");			break;
+		case NumFrameIntervals:				break;
+	}
+}
+
+
+void BeginFrameInterval(
+	FrameInterval	anInterval)
+{
+	gIntervalSignpostIDs[anInterval]	= os_signpost_id_generate(GetFrameLog());
+	gIntervalStartTimes[anInterval]		= CACurrentMediaTime();
+
+	MarkFrameInterval(anInterval, true, gIntervalSignpostIDs[anInterval]);
+}
+
+void EndFrameInterval(
+	FrameInterval	anInterval)
+{
+	CFTimeInterval	theElapsedTime;
+
+	theElapsedTime = CACurrentMediaTime() - gIntervalStartTimes[anInterval];
+
+	MarkFrameInterval(anInterval, false, gIntervalSignpostIDs[anInterval]);
+
+	os_unfair_lock_lock(&gFrameLock);
+	gCurrentIntervalSeconds[anInterval] += theElapsedTime;
+	os_unfair_lock_unlock(&gFrameLock);
+}
+
+
+void RecordFrameCounters(
+	const FrameCounters	*someCounters)
+{
+	FrameRecord		*theRecord;
+	unsigned int	i;
+
+	os_unfair_lock_lock(&gFrameLock);
+
+	theRecord = &gFrameRecords[gNextFrameRecord];
+	for (i = 0; i < NumFrameIntervals; i++)
+	{
+		theRecord->itsIntervalSeconds[i]	= gCurrentIntervalSeconds[i];
+		gCurrentIntervalSeconds[i]			= 0.0;
+	}
+	theRecord->itsCounters = *someCounters;
+
+	gNextFrameRecord = (gNextFrameRecord + 1) % NUM_FRAMES_TO_AVERAGE;
+	if (gNumFrameRecords < NUM_FRAMES_TO_AVERAGE)
+		gNumFrameRecords++;
+
+	os_unfair_lock_unlock(&gFrameLock);
+}
+
+void RecordFrameGPUTime(
+	CFTimeInterval	aGPUStartTime,
+	CFTimeInterval	aGPUEndTime)
+{
+	//	A command buffer that never ran on the GPU
+	//	reports zero for both times.
+	if (aGPUEndTime <= aGPUStartTime)
+		return;
+
+	os_unfair_lock_lock(&gFrameLock);
+
+	gGPUSeconds[gNextGPUTime] = aGPUEndTime - aGPUStartTime;
+	gNextGPUTime = (gNextGPUTime + 1) % NUM_FRAMES_TO_AVERAGE;
+	if (gNumGPUTimes < NUM_FRAMES_TO_AVERAGE)
+		gNumGPUTimes++;
+
+	os_unfair_lock_unlock(&gFrameLock);
+}
+
+
+void GetLatestFrameSeconds(
+	double	*aCPUSeconds,	//	output, negative if no frame has been recorded
+	double	*aGPUSeconds)	//	output, negative if no GPU time has arrived
+{
+	FrameRecord		*theRecord;
+	unsigned int	i;
+
+	os_unfair_lock_lock(&gFrameLock);
+
+	if (gNumFrameRecords > 0)
+	{
+		//	FrameIntervalWriteTiles already includes
+		//	FrameIntervalCullAndSort, so don't count it twice.
+		theRecord = &gFrameRecords[(gNextFrameRecord + NUM_FRAMES_TO_AVERAGE - 1) % NUM_FRAMES_TO_AVERAGE];
+		*aCPUSeconds = 0.0;
+		for (i = 0; i < NumFrameIntervals; i++)
+			if (i != FrameIntervalCullAndSort)
+				*aCPUSeconds += theRecord->itsIntervalSeconds[i];
+	}
+	else
+		*aCPUSeconds = -1.0;
+
+	if (gNumGPUTimes > 0)
+		*aGPUSeconds = gGPUSeconds[(gNextGPUTime + NUM_FRAMES_TO_AVERAGE - 1) % NUM_FRAMES_TO_AVERAGE];
+	else
+		*aGPUSeconds = -1.0;
+
+	os_unfair_lock_unlock(&gFrameLock);
+}
+
+
+NSString *FrameStatisticsSummary(void)
+{
+	unsigned int	theNumFrames,
+					theNumGPUCulledFrames,
+					theNumCPUCulledFrames,
+					theTotalNumReallocations,
+					i,
+					j;
+	double			theIntervalSeconds[NumFrameIntervals],
+					theGPUSeconds,
+					theNumVisibleCells,
+					theNumVisiblePlainCells,
+					theNumVisibleReflectedCells,
+					theNumInvertedCells,
+					theNumInstancesPerLevel[MAX_NUM_LOD_LEVELS];
+	FrameCounters	*theCounters;
+	NSMutableString	*theSummary;
+
+	static const char	*theIntervalNames[NumFrameIntervals] =
+						{
+							"simulation",
+							"cull & sort",
+							"write tiles",
+							"rewrite meshes",
+							"encode"
+						};
+
+	os_unfair_lock_lock(&gFrameLock);
+
+	theNumFrames				= gNumFrameRecords;
+	theNumGPUCulledFrames		= 0;
+	theTotalNumReallocations	= 0;
+	theNumVisibleCells			= 0.0;
+	theNumVisiblePlainCells		= 0.0;
+	theNumVisibleReflectedCells	= 0.0;
+	theNumInvertedCells			= 0.0;
+	for (j = 0; j < NumFrameIntervals; j++)
+		theIntervalSeconds[j] = 0.0;
+	for (j = 0; j < MAX_NUM_LOD_LEVELS; j++)
+		theNumInstancesPerLevel[j] = 0.0;
+
+	for (i = 0; i < theNumFrames; i++)
+	{
+		for (j = 0; j < NumFrameIntervals; j++)
+			theIntervalSeconds[j] += gFrameRecords[i].itsIntervalSeconds[j];
+
+		theCounters = &gFrameRecords[i].itsCounters;
+		theTotalNumReallocations += theCounters->itsNumBufferReallocations;
+		if (theCounters->itsGPUCullingFlag)
+		{
+			theNumGPUCulledFrames++;
+		}
+		else
+		{
+			theNumVisibleCells			+= theCounters->itsNumVisibleCells;
+			theNumVisiblePlainCells		+= theCounters->itsNumVisiblePlainCells;
+			theNumVisibleReflectedCells	+= theCounters->itsNumVisibleReflectedCells;
+			theNumInvertedCells			+= theCounters->itsNumInvertedCells;
+			for (j = 0; j < MAX_NUM_LOD_LEVELS; j++)
+				theNumInstancesPerLevel[j] += theCounters->itsNumInstancesPerLevel[j];
+		}
+	}
+
+	theGPUSeconds = 0.0;
+	for (i = 0; i < gNumGPUTimes; i++)
+		theGPUSeconds += gGPUSeconds[i];
+	if (gNumGPUTimes > 0)
+		theGPUSeconds /= gNumGPUTimes;
+
+	os_unfair_lock_unlock(&gFrameLock);
+
+	if (theNumFrames == 0)
+		return @"no frames yet";
+
+	theSummary = [NSMutableString stringWithCapacity:512];
+
+	[theSummary appendFormat:@"average of last %u frames (ms)\n", theNumFrames];
+	for (j = 0; j < NumFrameIntervals; j++)
+		[theSummary appendFormat:@"%-15s%7.3f\n", theIntervalNames[j], 1000.0 * theIntervalSeconds[j] / theNumFrames];
+	[theSummary appendFormat:@"%-15s%7.3f\n", "GPU", 1000.0 * theGPUSeconds];
+
+	theNumCPUCulledFrames = theNumFrames - theNumGPUCulledFrames;
+	if (theNumCPUCulledFrames > 0)
+	{
+		[theSummary appendFormat:@"cells          %.0f visible (%.0f plain, %.0f reflected), %.0f inverted\n",
+			theNumVisibleCells			/ theNumCPUCulledFrames,
+			theNumVisiblePlainCells		/ theNumCPUCulledFrames,
+			theNumVisibleReflectedCells	/ theNumCPUCulledFrames,
+			theNumInvertedCells			/ theNumCPUCulledFrames];
+		[theSummary appendString:@"LOD instances "];
+		for (j = 0; j < MAX_NUM_LOD_LEVELS; j++)
+			[theSummary appendFormat:@" %.0f", theNumInstancesPerLevel[j] / theNumCPUCulledFrames];
+		[theSummary appendString:@"\n"];
+	}
+	if (theNumGPUCulledFrames > 0)
+		[theSummary appendFormat:@"GPU culled %u of %u frames\n", theNumGPUCulledFrames, theNumFrames];
+
+	[theSummary appendFormat:@"buffer reallocations  %u", theTotalNumReallocations];
+
+	return theSummary;
+}
+
+
+static os_log_t GetFrameLog(void)
+{
+	static os_log_t			theFrameLog	= NULL;
+	static dispatch_once_t	theOnceToken;
+
+	//	Use the Points of Interest category, so the intervals
+	//	show up in Instruments without any extra configuration.
+	dispatch_once(&theOnceToken,
+	^{
+		theFrameLog = os_log_create("org.geometrygames.CurvedSpaces", OS_LOG_CATEGORY_POINTS_OF_INTEREST);
+	});
+
+	return theFrameLog;
+}
@@ -0,0 +1,61 @@
+//	CurvedSpacesGPUResourceCache.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+
+//	A CurvedSpacesGPUResourceCache lets all the renderers on a given device
+//	share their immutable GPU resources -- pipeline states, samplers,
+//	textures and the centerpiece and observer meshes -- so that
+//	each additional window costs only its own uniform and tiling buffers,
+//	the meshes that depend on its space, and its render targets.
+//
+//	The cache holds its resources weakly.  Each renderer holds
+//	strong references to the resources it uses, so a resource
+//	lives exactly as long as some renderer still uses it,
+//	and the next renderer to ask for it after that creates it afresh.
+//
+//	A resource's key must identify it completely, including
+//	any pixel format, sample count or view count that went into it.
+//	Because the cache shares whatever the first caller created,
+//	a shared resource must never be modified.
+//
+//	The cache also keeps the device's compiled pipelines
+//	in an MTLBinaryArchive in the app's Caches directory,
+//	so that later launches may skip most shader compilation.
+//	On systems older than macOS 11 and iOS 14, which lack
+//	binary archives, every pipeline gets compiled from source.
+//
+//	All methods are thread-safe.
+
+@interface CurvedSpacesGPUResourceCache : NSObject
+
++ (CurvedSpacesGPUResourceCache *)cacheForDevice:(id<MTLDevice>)aDevice;
+
+//	Returns the resource for aKey, calling aCreator to create it
+//	if no renderer currently holds it.  Returns nil if aCreator does.
+- (id)resourceForKey:(NSString *)aKey creator:(id (^)(void))aCreator;
+
+//	Copies each of someSharedBuffers into a buffer in private storage,
+//	all sub-allocated from a single heap, and waits for the copies
+//	to complete, so the private buffers are ready for any renderer
+//	to draw from.  The caller must keep *aHeap as long as it keeps
+//	the private buffers.
+- (NSArray<id<MTLBuffer>> *)privateCopiesOfBuffers:(NSArray<id<MTLBuffer>> *)someSharedBuffers
+	heap:(id<MTLHeap> *)aHeap;
+
+//	Compile a pipeline state, drawing on the device's binary archive
+//	wherever possible.  A pipeline that's not yet in the archive
+//	gets compiled from source and then added to it, so the next launch
+//	needn't compile it again.  Returns nil if the compilation fails.
+- (id<MTLRenderPipelineState>)newRenderPipelineStateWithDescriptor:(MTLRenderPipelineDescriptor *)aDescriptor;
+- (id<MTLComputePipelineState>)newComputePipelineStateWithDescriptor:(MTLComputePipelineDescriptor *)aDescriptor;
+
+//	Write the binary archive to disk, if it has gained any pipelines
+//	since it was last written.
+- (void)savePipelineArchive;
+
+@end
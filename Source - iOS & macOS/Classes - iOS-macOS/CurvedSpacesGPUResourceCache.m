@@ -0,0 +1,374 @@
+//	CurvedSpacesGPUResourceCache.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesGPUResourceCache.h"
+
+
+@interface CurvedSpacesGPUResourceCache()
+- (id)initWithDevice:(id<MTLDevice>)aDevice;
+- (id<MTLBinaryArchive>)pipelineArchive API_AVAILABLE(macos(11.0), ios(14.0));
+- (NSURL *)pipelineArchiveURL;
+@end
+
+
+@implementation CurvedSpacesGPUResourceCache
+{
+	id<MTLDevice>						itsDevice;
+
+	//	The command queue carries only the private buffers' initial copies.
+	id<MTLCommandQueue>					itsCommandQueue;
+
+	//	itsLock protects itsResources.  It's a recursive lock
+	//	because a creator may itself ask for other resources,
+	//	for example a mesh set's private buffers.
+	NSRecursiveLock						*itsLock;
+	NSMapTable<NSString *, id>			*itsResources;	//	strong keys, weak values
+
+	//	itsArchiveLock protects the binary archive,
+	//	which several threads may compile pipelines into at once.
+	//	itsPipelineArchive stays nil until first needed,
+	//	and itsPipelineArchiveIsDirty records whether it holds
+	//	pipelines that its file on disk doesn't.
+	NSLock								*itsArchiveLock;
+	id<MTLBinaryArchive>				itsPipelineArchive API_AVAILABLE(macos(11.0), ios(14.0));
+	bool								itsPipelineArchiveIsDirty;
+}
+
+
++ (CurvedSpacesGPUResourceCache *)cacheForDevice:(id<MTLDevice>)aDevice
+{
+	static NSMapTable<id<MTLDevice>, CurvedSpacesGPUResourceCache *>	*theCaches	= nil;
+	static NSLock														*theLock	= nil;
+	static dispatch_once_t												theOnceToken;
+	CurvedSpacesGPUResourceCache										*theCache;
+
+	//	Key the caches by the devices' identities, not their equality.
+	//	A device going away takes its cache with it.
+	dispatch_once(&theOnceToken,
+	^{
+		theCaches	= [NSMapTable
+						mapTableWithKeyOptions:	(NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality)
+						valueOptions:			NSPointerFunctionsStrongMemory];
+		theLock		= [[NSLock alloc] init];
+	});
+
+	[theLock lock];
+
+	theCache = [theCaches objectForKey:aDevice];
+	if (theCache == nil)
+	{
+		theCache = [[CurvedSpacesGPUResourceCache alloc] initWithDevice:aDevice];
+		[theCaches setObject:theCache forKey:aDevice];
+	}
+
+	[theLock unlock];
+
+	return theCache;
+}
+
+- (id)initWithDevice:(id<MTLDevice>)aDevice
+{
+	self = [super init];
+	if (self != nil)
+	{
+		itsDevice		= aDevice;
+		itsCommandQueue	= nil;	//	created on demand
+		itsLock			= [[NSRecursiveLock alloc] init];
+		itsResources	= [NSMapTable strongToWeakObjectsMapTable];
+
+		itsArchiveLock				= [[NSLock alloc] init];
+		itsPipelineArchiveIsDirty	= false;
+	}
+	return self;
+}
+
+
+- (id)resourceForKey:(NSString *)aKey creator:(id (^)(void))aCreator
+{
+	id	theResource;
+
+	//	Create the resource while holding the lock,
+	//	so that two renderers setting up at the same time
+	//	never both spend time creating the same resource.
+
+	[itsLock lock];
+
+	theResource = [itsResources objectForKey:aKey];
+	if (theResource == nil)
+	{
+		theResource = aCreator();
+		if (theResource != nil)
+			[itsResources setObject:theResource forKey:aKey];
+	}
+
+	[itsLock unlock];
+
+	return theResource;
+}
+
+- (NSArray<id<MTLBuffer>> *)privateCopiesOfBuffers:	(NSArray<id<MTLBuffer>> *)someSharedBuffers
+											heap:	(id<MTLHeap> *)aHeap
+{
+	NSUInteger					theHeapSize,
+								i;
+	MTLSizeAndAlign				theSizeAndAlign;
+	MTLHeapDescriptor			*theHeapDescriptor;
+	id<MTLHeap>					theHeap;
+	NSMutableArray<id<MTLBuffer>>
+								*thePrivateBuffers;
+	id<MTLBuffer>				thePrivateBuffer;
+	id<MTLCommandBuffer>		theCommandBuffer;
+	id<MTLBlitCommandEncoder>	theBlitEncoder;
+
+	*aHeap = nil;
+
+	if ([someSharedBuffers count] == 0)
+		return @[];
+
+	//	Size the heap to hold all the buffers at once,
+	//	respecting each one's alignment.
+	theHeapSize = 0;
+	for (i = 0; i < [someSharedBuffers count]; i++)
+	{
+		theSizeAndAlign = [itsDevice
+			heapBufferSizeAndAlignWithLength:	[someSharedBuffers[i] length]
+			options:							MTLResourceStorageModePrivate];
+		theHeapSize = ((theHeapSize + theSizeAndAlign.align - 1) / theSizeAndAlign.align) * theSizeAndAlign.align
+					+ theSizeAndAlign.size;
+	}
+
+	//	The buffers never change once they've been copied,
+	//	so the heap needn't track hazards between them.
+	theHeapDescriptor = [[MTLHeapDescriptor alloc] init];
+	[theHeapDescriptor setStorageMode:MTLStorageModePrivate];
+	[theHeapDescriptor setSize:theHeapSize];
+	if (@available(iOS 13.0, macOS 10.15, *))
+		[theHeapDescriptor setHazardTrackingMode:MTLHazardTrackingModeUntracked];
+	theHeap = [itsDevice newHeapWithDescriptor:theHeapDescriptor];
+
+	thePrivateBuffers = [[NSMutableArray<id<MTLBuffer>> alloc] initWithCapacity:[someSharedBuffers count]];
+	for (i = 0; i < [someSharedBuffers count]; i++)
+	{
+		//	If the heap couldn't be created, or somehow runs short,
+		//	fall back to a free-standing private buffer.
+		thePrivateBuffer = [theHeap
+			newBufferWithLength:	[someSharedBuffers[i] length]
+			options:				MTLResourceStorageModePrivate];
+		if (thePrivateBuffer == nil)
+		{
+			thePrivateBuffer = [itsDevice
+				newBufferWithLength:	[someSharedBuffers[i] length]
+				options:				MTLResourceStorageModePrivate];
+		}
+		[thePrivateBuffers addObject:thePrivateBuffer];
+	}
+
+	//	Copy the data and wait for it, so that no renderer
+	//	can draw from a private buffer before it's filled.
+	//	The buffers are small and get copied only once per process,
+	//	so the wait is brief.
+
+	[itsLock lock];
+	if (itsCommandQueue == nil)
+		itsCommandQueue = [itsDevice newCommandQueue];
+	[itsLock unlock];
+
+	theCommandBuffer	= [itsCommandQueue commandBuffer];
+	theBlitEncoder		= [theCommandBuffer blitCommandEncoder];
+	for (i = 0; i < [someSharedBuffers count]; i++)
+	{
+		[theBlitEncoder
+			copyFromBuffer:		someSharedBuffers[i]
+			sourceOffset:		0
+			toBuffer:			thePrivateBuffers[i]
+			destinationOffset:	0
+			size:				[someSharedBuffers[i] length]];
+	}
+	[theBlitEncoder endEncoding];
+	[theCommandBuffer commit];
+	[theCommandBuffer waitUntilCompleted];
+
+	*aHeap = theHeap;
+
+	return thePrivateBuffers;
+}
+
+
+- (id<MTLRenderPipelineState>)newRenderPipelineStateWithDescriptor:(MTLRenderPipelineDescriptor *)aDescriptor
+{
+	id<MTLRenderPipelineState>	thePipelineState;
+
+	if (@available(iOS 14.0, macOS 11.0, *)
+	{
+		id<MTLBinaryArchive>	theArchive;
+
+		theArchive = [self pipelineArchive];
+		if (theArchive != nil)
+		{
+			[aDescriptor setBinaryArchives:@[theArchive]];
+
+			//	Ask for the archived pipeline alone, so that a miss
+			//	tells us the archive needs the new pipeline.
+			thePipelineState = [itsDevice
+				newRenderPipelineStateWithDescriptor:	aDescriptor
+				options:								MTLPipelineOptionFailOnBinaryArchiveMiss
+				reflection:								NULL
+				error:									NULL];
+			if (thePipelineState != nil)
+				return thePipelineState;
+
+			thePipelineState = [itsDevice newRenderPipelineStateWithDescriptor:aDescriptor error:NULL];
+			if (thePipelineState != nil)
+			{
+				[itsArchiveLock lock];
+				if ([theArchive addRenderPipelineFunctionsWithDescriptor:aDescriptor error:NULL])
+					itsPipelineArchiveIsDirty = true;
+				[itsArchiveLock unlock];
+			}
+
+			return thePipelineState;
+		}
+	}
+
+	return [itsDevice newRenderPipelineStateWithDescriptor:aDescriptor error:NULL];
+}
+
+- (id<MTLComputePipelineState>)newComputePipelineStateWithDescriptor:(MTLComputePipelineDescriptor *)aDescriptor
+{
+	id<MTLComputePipelineState>	thePipelineState;
+
+	if (@available(iOS 14.0, macOS 11.0, *)
+	{
+		id<MTLBinaryArchive>	theArchive;
+
+		theArchive = [self pipelineArchive];
+		if (theArchive != nil)
+		{
+			[aDescriptor setBinaryArchives:@[theArchive]];
+
+			thePipelineState = [itsDevice
+				newComputePipelineStateWithDescriptor:	aDescriptor
+				options:								MTLPipelineOptionFailOnBinaryArchiveMiss
+				reflection:								NULL
+				error:									NULL];
+			if (thePipelineState != nil)
+				return thePipelineState;
+
+			thePipelineState = [itsDevice
+				newComputePipelineStateWithDescriptor:	aDescriptor
+				options:								MTLPipelineOptionNone
+				reflection:								NULL
+				error:									NULL];
+			if (thePipelineState != nil)
+			{
+				[itsArchiveLock lock];
+				if ([theArchive addComputePipelineFunctionsWithDescriptor:aDescriptor error:NULL])
+					itsPipelineArchiveIsDirty = true;
+				[itsArchiveLock unlock];
+			}
+
+			return thePipelineState;
+		}
+	}
+
+	return [itsDevice
+		newComputePipelineStateWithDescriptor:	aDescriptor
+		options:								MTLPipelineOptionNone
+		reflection:								NULL
+		error:									NULL];
+}
+
+- (void)savePipelineArchive
+{
+	NSURL	*theURL;
+
+	if (@available(iOS 14.0, macOS 11.0, *)
+	{
+		[itsArchiveLock lock];
+
+		theURL = [self pipelineArchiveURL];
+		if (itsPipelineArchive != nil
+		 && itsPipelineArchiveIsDirty
+		 && theURL != nil)
+		{
+			//	If the write fails, the next launch will simply
+			//	compile the missing pipelines again.
+			if ([itsPipelineArchive serializeToURL:theURL error:NULL])
+				itsPipelineArchiveIsDirty = false;
+		}
+
+		[itsArchiveLock unlock];
+	}
+}
+
+- (id<MTLBinaryArchive>)pipelineArchive
+{
+	NSURL						*theURL;
+	MTLBinaryArchiveDescriptor	*theDescriptor;
+
+	[itsArchiveLock lock];
+
+	if (itsPipelineArchive == nil)
+	{
+		theURL = [self pipelineArchiveURL];
+
+		//	Start from the archive that the previous launch saved, if any.
+		//	If that archive is missing, or was written by an older OS
+		//	whose GPU compiler the present one rejects, start afresh.
+		if (theURL != nil
+		 && [[NSFileManager defaultManager] fileExistsAtPath:[theURL path]])
+		{
+			theDescriptor = [[MTLBinaryArchiveDescriptor alloc] init];
+			[theDescriptor setUrl:theURL];
+			itsPipelineArchive = [itsDevice newBinaryArchiveWithDescriptor:theDescriptor error:NULL];
+		}
+
+		if (itsPipelineArchive == nil)
+		{
+			theDescriptor = [[MTLBinaryArchiveDescriptor alloc] init];
+			itsPipelineArchive = [itsDevice newBinaryArchiveWithDescriptor:theDescriptor error:NULL];
+		}
+	}
+
+	[itsArchiveLock unlock];
+
+	return itsPipelineArchive;
+}
+
+- (NSURL *)pipelineArchiveURL
+{
+	NSURL		*theCachesDirectory,
+				*theDirectory;
+	NSString	*theBundleIdentifier;
+
+	//	A binary archive holds machine code for one particular GPU,
+	//	so a Mac with several GPUs keeps a separate archive for each.
+
+	theCachesDirectory = [[[NSFileManager defaultManager]
+							URLsForDirectory:	NSCachesDirectory
+							inDomains:			NSUserDomainMask] firstObject];
+	if (theCachesDirectory == nil)
+		return nil;
+
+	//	On macOS the Caches directory may be shared among apps.
+	theBundleIdentifier = [[NSBundle mainBundle] bundleIdentifier];
+	theDirectory = [theCachesDirectory URLByAppendingPathComponent:
+						(theBundleIdentifier != nil ? theBundleIdentifier : @"Curved Spaces")
+						isDirectory:YES];
+	if ( ! [[NSFileManager defaultManager]
+				createDirectoryAtURL:			theDirectory
+				withIntermediateDirectories:	YES
+				attributes:						nil
+				error:							NULL] )
+	{
+		return nil;
+	}
+
+	return [theDirectory URLByAppendingPathComponent:
+				[NSString stringWithFormat:@"Pipelines-%016llx.metallib",
+					(unsigned long long)[itsDevice registryID]]];
+}
+
+@end
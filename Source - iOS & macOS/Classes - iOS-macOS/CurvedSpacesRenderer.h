@@ -6,6 +6,12 @@
 
 #import "GeometryGamesRenderer.h"
 
+
+//	A batch render (see CurvedSpacesBatchRenderer) keeps
+//	up to NUM_BATCH_FRAMES_IN_FLIGHT frames in flight at once,
+//	each with its own pooled uniform and tiling buffers.
+#define NUM_BATCH_FRAMES_IN_FLIGHT	3
+
 @interface CurvedSpacesRenderer : GeometryGamesRenderer
 
 - (id)initWithLayer:(CAMetalLayer *)aLayer device:(id<MTLDevice>)aDevice
@@ -16,6 +22,11 @@
 
 - (NSDictionary<NSString *, id> *)prepareInflightDataBuffersAtIndex:(unsigned int)anInflightBufferIndex modelData:(ModelData *)md;
 - (NSDictionary<NSString *, id> *)prepareInflightDataBuffersForOffscreenRenderingAtSize:(CGSize)anImageSize modelData:(ModelData *)md;
+- (NSDictionary<NSString *, id> *)prepareInflightDataBuffersForBatchFrameAtIndex:(unsigned int)aBatchFrameIndex
+		imageSize:(CGSize)anImageSize tiles:(const CGRect *)someTiles numTiles:(unsigned int)aNumTiles modelData:(ModelData *)md;
+- (MTLRenderPassDescriptor *)makeBatchRenderPassDescriptorForTileSize:(CGSize)aTileSize modelData:(ModelData *)md;
+- (MTLRenderPassDescriptor *)makeStereoRenderPassDescriptorForImageSize:(CGSize)anImageSize modelData:(ModelData *)md;
+- (NSUInteger)maxBatchTileSize;
 - (bool)wantsClearWithModelData:(ModelData *)md;
 - (ColorP3Linear)clearColorWithModelData:(ModelData *)md;
 - (void)encodeCommandsToCommandBuffer:(id<MTLCommandBuffer>)aCommandBuffer
@@ -7,10 +7,18 @@
 #import "CurvedSpacesRenderer.h"
 #import "CurvedSpaces-Common.h"
 #import "CurvedSpacesGPUDefinitions.h"
+#import "CurvedSpacesFrameStatistics.h"
+#import "CurvedSpacesGPUResourceCache.h"
 #import "GeometryGamesUtilities-Common.h"
 #import "GeometryGamesUtilities-Mac-iOS.h"
 #import "GeometryGamesFauxSimd.h"	//	Metal file would need explicit path
 #import <MetalKit/MetalKit.h>
+#import <os/lock.h>
+#if TARGET_OS_IOS
+#import <UIKit/UIKit.h>		//	for UIScreen
+#else
+#import <AppKit/AppKit.h>	//	for NSScreen
+#endif
 
 
 //	How big should the possible centerpieces be?
@@ -48,7 +56,61 @@
 #define DART_COLOR_TAIL				PREMULTIPLY_RGBA(0.500, 0.500, 0.500, 1.0)	//	linear sRGB color coordinates
 
 //	How many levels of detail should we support?
-#define MAX_NUM_LOD_LEVELS	4
+//	CurvedSpacesGPUDefinitions.h defines MAX_NUM_LOD_LEVELS,
+//	because the GPU culling functions need it too.
+//	Each MeshSet may use as many levels as it likes, up to that maximum.
+
+//	How far (in pixels) may a coarser level-of-detail stray
+//	from the true surface before we must use a finer one?
+//	Each Mesh records its own geometric error, and LevelOfDetailDistance()
+//	converts it to the distance beyond which that Mesh is good enough.
+//	So a nearby Earth in a hyperbolic space, which looks small,
+//	may use a coarse mesh, while a nearly antipodal Earth
+//	in a spherical space, which looks big, gets a fine one.
+//	LevelOfDetailDistance() already accounts for the narrower fields of view
+//	in The Shape of Space figures.
+#ifdef MAKE_SCREENSHOTS
+//	Let's draw higher level-of-detail images for screenshots.
+#define MAX_SCREEN_SPACE_ERROR	0.25
+#else
+#define MAX_SCREEN_SPACE_ERROR	1.0
+#endif
+
+//	When alpha blending, how many of the nearest images should we omit?
+#if (defined(PREPARE_FOR_SCREENSHOT) || defined(MAKE_SCREENSHOTS) || defined(HIGH_RESOLUTION_SCREENSHOT) || (SHAPE_OF_SPACE_CH_16 == 6))
+//	Omit the two nearest images of the galaxy, to avoid obscuring the view.
+//	Somehow it seems that the second image is the one causing the problem
+//	(the most central image is probably behind the observer), which is
+//	why we must omit two images instead of only one.
+#define NUM_BLENDED_INSTANCES_TO_OMIT	2
+#else
+#define NUM_BLENDED_INSTANCES_TO_OMIT	0
+#endif
+
+//	Weighted blended order-independent transparency
+//	(see CurvedSpacesTransparentFragmentFunction) lets the galaxy's images
+//	get drawn in any order, from the same front-to-back tiling buffers
+//	as the opaque content, with no back-to-front buffer at all.
+//	Omitting the nearest images, however, requires the back-to-front order,
+//	so the screenshot configurations keep the sorted draw.
+#define ORDER_INDEPENDENT_TRANSPARENCY	(NUM_BLENDED_INSTANCES_TO_OMIT == 0)
+#if ORDER_INDEPENDENT_TRANSPARENCY
+//	The accumulation attachment holds weighted sums of premultiplied colors,
+//	which exceed 1, so it needs a floating-point format.
+#define TRANSPARENCY_ACCUMULATION_PIXEL_FORMAT	MTLPixelFormatRGBA16Float
+#define TRANSPARENCY_REVEALAGE_PIXEL_FORMAT		MTLPixelFormatR16Float
+#endif
+
+//	For small honeycombs, culling on the CPU costs less
+//	than encoding the GPU's sorting passes.
+#define MIN_NUM_CELLS_FOR_GPU_CULLING	1024
+
+//	How many threads should each threadgroup of a culling function contain?
+#define CULLING_THREADGROUP_WIDTH		64
+
+//	What frame period should the quality governor aim for
+//	when the display doesn't report its refresh rate?
+#define DEFAULT_TARGET_FRAME_PERIOD		(1.0 / 60.0)
 
 
 #ifdef START_OUTSIDE
@@ -58,13 +120,44 @@
 #endif
 
 
+//	The vertex function reads each vertex of every instance
+//	of every mesh, so keep the vertex data compact:
+//
+//		The position stays in single precision.  Flat and hyperbolic
+//			meshes' homogeneous coordinates needn't lie in [-1,+1],
+//			so snorm16 can't represent them, and half precision
+//			would visibly distort the small centerpieces.
+//			A packed simd type avoids the 16-byte alignment padding.
+//
+//		The texture coordinates travel in half precision.
+//			Even the plain wall texture, which repeats
+//			FACE_TEXTURE_MULTIPLE_PLAIN times across a face,
+//			keeps its (u,v) well within half precision's resolution.
+//
+//		The color stays in half precision, not 8-bit unorm,
+//			because the wide-gamut colors (for example the gyroscope's)
+//			have extended-range linear sRGB components
+//			that fall below 0 or above 1.
+//
+//	The result is 32 bytes per vertex instead of 48.
+//
 typedef struct
 {
-	simd_float4		pos;	//	position (x,y,z,w)
-	simd_float3		tex;	//	2D texture coordinates (u,v,-) or cube map texture coordinates (u,v,w)
-	faux_simd_half4	col;	//	premultiplied (αR,αG,αB,α)
+	simd_packed_float4	pos;	//	position (x,y,z,w)
+	faux_simd_half4		tex;	//	2D texture coordinates (u,v,-,-) or cube map texture coordinates (u,v,w,-)
+	faux_simd_half4		col;	//	premultiplied (αR,αG,αB,α)
 } CurvedSpacesVertexData;
 
+//	A mesh with apertures (namely the Dirichlet walls) keeps
+//	each vertex's fully-closed position and texture coordinates
+//	in a second vertex buffer.  Its CurvedSpacesVertexData
+//	holds the fully-open ones.
+typedef struct
+{
+	simd_packed_float4	pos;	//	position (x,y,z,w) with the aperture fully closed
+	faux_simd_half4		tex;	//	2D texture coordinates (u,v,-,-) with the aperture fully closed
+} CurvedSpacesApertureVertexData;
+
 
 typedef struct
 {
@@ -76,6 +169,22 @@ typedef struct
 
 } ViewProjectionMatrixSet;
 
+//	Each ShaderFogAndClipBoxType comes in several variants,
+//	according to whether it samples a cube map, opens apertures
+//	or blends partially transparent content.  Only the ShaderXxxBoxFull
+//	types need the blended variant, because Curved Spaces draws
+//	no partially transparent content in the spaces that need
+//	their back hemisphere drawn.
+#define NUM_SHADER_FOG_AND_CLIP_BOX_TYPES	(ShaderNoFogBoxBack + 1)
+typedef enum
+{
+	PipelineVariantPlain,
+	PipelineVariantCubeMap,
+	PipelineVariantBlended,
+	PipelineVariantAperture,	//	for the Dirichlet walls
+	NumPipelineVariants
+} PipelineVariant;
+
 
 //	ARC can't handle object references within C structs,
 //	so package up the following as Objective-C objects instead.
@@ -86,8 +195,8 @@ typedef struct
 	//	How many visible cells does this TilingBufferSet hold?
 	//
 	//		The buffers may include empty space at the end,
-	//		following the valid matrices, so we can't rely
-	//		on the buffer sizes to tell us how many matrices are present.
+	//		following the valid indices, so we can't rely
+	//		on the buffer sizes to tell us how many indices are present.
 	//
 	unsigned int	itsNumPlainTiles,
 					itsNumReflectedTiles,
@@ -105,8 +214,9 @@ typedef struct
 	//			shouldn't matter, because the renderer
 	//			sorts all triangles before it draws anything.
 	//
-	//	These buffers contain only the visible tiles' matrices,
-	//	already post-multiplied by the view matrix.
+	//	These buffers contain only the visible tiles' indices
+	//	into itsCellBuffer, as 32-bit unsigned integers.
+	//	The vertex function applies the view matrix itself.
 	//
 	id<MTLBuffer>	itsPlainFrontToBackTilingBuffer,
 					itsReflectedFrontToBackTilingBuffer;
@@ -121,10 +231,28 @@ typedef struct
 	//	with distinct front and back faces, then this approach
 	//	wouldn't work.  Luckily we don't need to do that.
 	//
-	//	This buffer contains only the visible tiles' matrices,
-	//	already post-multiplied by the view matrix.
+	//	This buffer contains only the visible tiles' indices
+	//	into itsCellBuffer.
+	//
+	//	With ORDER_INDEPENDENT_TRANSPARENCY the galaxy gets drawn
+	//	from the plain and reflected buffers instead, so this buffer
+	//	gets written only when -encodeFullSphereWithEncoder:…
+	//	needs it for the front hemisphere.
 	//
 	id<MTLBuffer>	itsFullBackToFrontTilingBuffer;
+
+	//	Which tiles get which level of detail?  For each MeshSlot,
+	//	level-of-detail l draws the plain tiles i with
+	//
+	//		itsPlainLevelCutoffs[slot][l] ≤ i < itsPlainLevelCutoffs[slot][l+1]
+	//
+	//	and likewise for the reflected tiles.
+	//	-writeSortedVisibleTilesIntoBufferSet:… chooses the cutoffs
+	//	according to each mesh's size on the screen.
+	//	When the GPU culls the honeycomb, it chooses the cutoffs itself
+	//	and writes them directly into the indirect draw arguments.
+	unsigned int	itsPlainLevelCutoffs[NumMeshSlots][MAX_NUM_LOD_LEVELS + 1],
+					itsReflectedLevelCutoffs[NumMeshSlots][MAX_NUM_LOD_LEVELS + 1];
 	
 	//	For spherical spaces with antipodal symmetry,
 	//	we need render only the front hemisphere,
@@ -148,10 +276,37 @@ typedef struct
 	//		To avoid this issue, -encodeFullSphereWithEncoder:…
 	//		doesn't render partially transparent scenery.
 	//
-	//	Each matrix in this buffer will be post-multiplied
-	//	by the antipodal map as well as the view matrix.
+	//	The vertex function will post-multiply the tiling matrix
+	//	of each cell listed in this buffer by the antipodal map
+	//	as well as the view matrix.
 	//
 	id<MTLBuffer>	itsInvertedTilingBuffer;
+
+	//	All the tiling buffers index into itsCellBuffer,
+	//	which holds every cell's tiling matrix in private storage.
+	//	All TilingBufferSets share the same itsCellBuffer
+	//	until the honeycomb changes.
+	id<MTLBuffer>	itsCellBuffer;
+
+	//	For large honeycombs, the GPU culls and sorts the cells itself
+	//	and writes the plain, reflected and full back-to-front buffers
+	//	(which then live in private storage).  In that case
+	//	the CPU never learns how many tiles are visible,
+	//	so itsNumPlainTiles, itsNumReflectedTiles and itsTotalNumTiles
+	//	are all zero, and the draw calls take their instance counts
+	//	from itsCullResultBuffer instead.
+	//
+	//		itsCellBuffer			all the honeycomb's cells (see below)
+	//		itsCullUniformBuffer	view matrix, culling planes and index counts
+	//		itsSortEntryBuffer		(sort key, cell index) pairs, itsSortSize of them
+	//		itsCullResultBuffer		tile counts and indirect draw arguments
+	//
+	bool			itsGPUCullingFlag;
+	unsigned int	itsNumCells,
+					itsSortSize;
+	id<MTLBuffer>	itsCullUniformBuffer,
+					itsSortEntryBuffer,
+					itsCullResultBuffer;
 }
 @end
 @implementation TilingBufferSet
@@ -162,8 +317,11 @@ typedef struct
 @public
 	unsigned int	itsNumFacets;
 	id<MTLBuffer>	itsVertexBuffer,
-					itsIndexBuffer;
+					itsIndexBuffer,
+					itsApertureBuffer;	//	CurvedSpacesApertureVertexData, or nil if the mesh has no apertures
 	bool			itsCubeMapFlag;	//	true = cube map;  false = traditional texture
+	double			itsMaxError;	//	greatest distance from the mesh to the surface it approximates,
+									//		used to choose levels-of-detail;  0.0 for an exact mesh
 }
 @end
 @implementation Mesh
@@ -181,6 +339,11 @@ typedef struct
 	//	Unused levels must be set to nil.
 	//
 	Mesh	*itsMeshes[MAX_NUM_LOD_LEVELS];
+
+	//	A mesh set in private storage keeps the heap
+	//	from which its buffers were sub-allocated.
+	//	Otherwise itsHeap is nil.
+	id<MTLHeap>	itsHeap;
 }
 @end
 @implementation MeshSet
@@ -188,8 +351,20 @@ typedef struct
 
 
 
-static id<MTLRenderPipelineState>	MakePipelineState(id<MTLDevice> aDevice, MTLPixelFormat aColorPixelFormat, id<MTLLibrary> aGPUFunctionLibrary,
-										bool aMultisamplingFlag, ShaderFogAndClipBoxType aShaderFogAndClipBoxType, bool aCubeMapFlag, bool anAlphaBlendingFlag);
+static id<MTLRenderPipelineState>	MakePipelineState(CurvedSpacesGPUResourceCache *aResourceCache, MTLPixelFormat aColorPixelFormat, id<MTLLibrary> aGPUFunctionLibrary,
+										bool aMultisamplingFlag, ShaderFogAndClipBoxType aShaderFogAndClipBoxType, bool aCubeMapFlag, bool anAlphaBlendingFlag, bool anApertureFlag,
+										unsigned int aNumViews);
+static id<MTLRenderPipelineState>	SharedPipelineState(CurvedSpacesGPUResourceCache *aResourceCache, MTLPixelFormat aColorPixelFormat, id<MTLLibrary> aGPUFunctionLibrary,
+										bool aMultisamplingFlag, ShaderFogAndClipBoxType aShaderFogAndClipBoxType, PipelineVariant aPipelineVariant, unsigned int aNumViews);
+static bool							PipelineVariantIsUsed(ShaderFogAndClipBoxType aShaderFogAndClipBoxType, PipelineVariant aPipelineVariant);
+static PipelineVariant				GetPipelineVariant(Mesh *aMesh, bool anAlphaBlendingFlag);
+#if ORDER_INDEPENDENT_TRANSPARENCY
+static id<MTLRenderPipelineState>	MakeTransparencyCompositePipelineState(CurvedSpacesGPUResourceCache *aResourceCache, MTLPixelFormat aColorPixelFormat, id<MTLLibrary> aGPUFunctionLibrary, unsigned int aNumViews);
+#endif
+static id<MTLRenderPipelineState>	MakeUpscalePipelineState(CurvedSpacesGPUResourceCache *aResourceCache, MTLPixelFormat aColorPixelFormat, id<MTLLibrary> aGPUFunctionLibrary, unsigned int aNumViews);
+static id<MTLTexture>				MakeRenderTargetTexture(id<MTLDevice> aDevice, MTLPixelFormat aPixelFormat, NSUInteger aWidth, NSUInteger aHeight, unsigned int aNumViews, bool aMultisamplingFlag);
+static id<MTLComputePipelineState>	MakeComputePipelineState(CurvedSpacesGPUResourceCache *aResourceCache, id<MTLLibrary> aGPUFunctionLibrary, NSString *aFunctionName);
+static id<MTLComputePipelineState>	SharedComputePipelineState(CurvedSpacesGPUResourceCache *aResourceCache, id<MTLLibrary> aGPUFunctionLibrary, NSString *aFunctionName);
 static TilingBufferSet				*MakeEmptyTilingBufferSet(void);
 static MeshSet						*MakeEmptyMeshSet(void);
 static Mesh							*MakeEmptyMesh(void);
@@ -203,18 +378,24 @@ static MeshSet						*MakeCubeMeshSet(id<MTLDevice> aDevice);
 #endif
 static MeshSet						*MakeVertexFigureMeshSet(id<MTLDevice> aDevice, ModelData *md);
 static MeshSet						*MakeObserverMeshSet(id<MTLDevice> aDevice);
-static Mesh							*MakeMeshFromArrays(id<MTLDevice> aDevice,
-										unsigned int aNumMeshVertices, double (*someMeshVertexPositions)[4], double (*someMeshVertexTexCoords)[3], double (*someMeshVertexColors)[4],
-										unsigned int aNumMeshFacets, unsigned int (*someMeshFacets)[3],
-										bool aCubeMapFlag);
+static Mesh							*MakeMeshForBuilder(id<MTLDevice> aDevice, unsigned int aNumMeshVertices, unsigned int aNumMeshFacets,
+										bool anApertureFlag, bool aCubeMapFlag, MeshBuffers *someMeshBuffers);
 static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
+static void							GetLevelOfDetailDistances(MeshSet *aMeshSet, CGSize anImageSize, SpaceType aSpaceType, double aLevelOfDetailBias, double someDistances[MAX_NUM_LOD_LEVELS]);
+static void							WriteMeshSetIndexCounts(MeshSet *aMeshSet, uint32_t someIndexCounts[MAX_NUM_LOD_LEVELS]);
+static void							RestrictProjectionToTile(double aProjectionMatrix[4][4], CGSize anImageSize, CGRect aTile);
+static double						GetDisplayFramePeriod(void);
+static NSDictionary<MTKTextureLoaderOption, id>
+									*MakeTextureLoaderOptions(void);
 
 
 //	Privately-declared methods
 @interface CurvedSpacesRenderer()
 
-- (void)   setUpPipelineStates;
+- (void)   setUpPipelineStatesWithModelData:(ModelData *)md;
 - (void)shutDownPipelineStates;
+- (void)compileRenderPipelineStatesInBackground;
+- (id<MTLRenderPipelineState>)renderPipelineStateForType:(ShaderFogAndClipBoxType)aShaderFogAndClipBoxType variant:(PipelineVariant)aPipelineVariant;
 
 - (void)   setUpDepthStencilState;
 - (void)shutDownDepthStencilState;
@@ -232,56 +413,120 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 - (void)shutDownSamplers;
 
 - (ViewProjectionMatrixSet)makeViewProjectionMatrixSetForImageSize:(CGSize)anImageSize modelData:(ModelData *)md;
-- (void)writeUniformsIntoBuffer:(id<MTLBuffer>)aUniformsBuffer forImageSize:(CGSize)anImageSize matrixSet:(ViewProjectionMatrixSet)aMatrixSet modelData:(ModelData *)md;
-- (void)writeSortedVisibleTilesIntoBufferSet:(TilingBufferSet *)aTilingBufferSet forImageSize:(CGSize)anImageSize matrixSet:(ViewProjectionMatrixSet)aMatrixSet modelData:(ModelData *)md;
+- (void)writeUniformsIntoBuffer:(id<MTLBuffer>)aUniformsBuffer forImageSize:(CGSize)anImageSize matrixSet:(ViewProjectionMatrixSet)aMatrixSet quality:(const QualitySettings *)someQualitySettings modelData:(ModelData *)md;
+- (void)writeSortedVisibleTilesIntoBufferSet:(TilingBufferSet *)aTilingBufferSet forImageSize:(CGSize)anImageSize matrixSet:(ViewProjectionMatrixSet)aMatrixSet quality:(const QualitySettings *)someQualitySettings modelData:(ModelData *)md;
+- (void)refreshHoneycombCellBufferWithModelData:(ModelData *)md;
+- (MeshSet *)sharedCenterpieceMeshSet:(CenterpieceType)aCenterpieceType;
+- (MeshSet *)sharedObserverMeshSet;
+- (void)moveMeshSetToPrivateStorage:(MeshSet *)aMeshSet;
+- (id<MTLTexture>)sharedTextureNamed:(NSString *)aTextureName;
+- (id<MTLTexture>)sharedCenterpieceTexture:(CenterpieceType)aCenterpieceType;
+- (MeshSet *)meshSetForSlot:(MeshSlot)aMeshSlot;
+- (void)getCenterpiecePlacement:(Matrix *)aPlacement modelData:(ModelData *)md;
+- (bool)canCullOnGPUWithModelData:(ModelData *)md;
+- (void)writeCullingInputsIntoBufferSet:(TilingBufferSet *)aTilingBufferSet forImageSize:(CGSize)anImageSize matrixSet:(ViewProjectionMatrixSet)aMatrixSet quality:(const QualitySettings *)someQualitySettings modelData:(ModelData *)md;
+- (void)encodeCullingCommandsToCommandBuffer:(id<MTLCommandBuffer>)aCommandBuffer tiling:(TilingBufferSet *)aTilingBufferSet;
+- (void)countTilesInBufferSet:(TilingBufferSet *)aTilingBufferSet counters:(FrameCounters *)someCounters;
+#if ORDER_INDEPENDENT_TRANSPARENCY
+- (MTLRenderPassDescriptor *)addTransparencyAttachmentsToRenderPassDescriptor:(MTLRenderPassDescriptor *)aRenderPassDescriptor drawTransparency:(bool)aTransparencyFlag;
+- (void)encodeTransparencyCompositeToCommandBuffer:(id<MTLCommandBuffer>)aCommandBuffer renderPassDescriptor:(MTLRenderPassDescriptor *)aRenderPassDescriptor;
+#endif
+- (MTLRenderPassDescriptor *)makeScaledRenderPassDescriptorFor:(MTLRenderPassDescriptor *)aRenderPassDescriptor renderScale:(double)aRenderScale;
+- (void)encodeUpscaleToCommandBuffer:(id<MTLCommandBuffer>)aCommandBuffer from:(MTLRenderPassDescriptor *)aScaledRenderPassDescriptor to:(MTLRenderPassDescriptor *)aRenderPassDescriptor;
 
 @end
 
 
 @implementation CurvedSpacesRenderer
 {
-	//	Which centerpiece do itsUnrotatedCenterpieceMeshSet
+	//	Which centerpiece do itsCenterpieceMeshSet
 	//	and itsCenterpieceTexture currently represent?
 	CenterpieceType				itsCenterpieceType;
 
 	id<MTLBuffer>				itsUniformBuffer[NUM_INFLIGHT_BUFFERS];
 	TilingBufferSet				*itsTilingBufferSet[NUM_INFLIGHT_BUFFERS];
-	MeshSet						*itsRotatedCenterpieceMeshSet[NUM_INFLIGHT_BUFFERS],	//	Earth, galaxy or gyroscope, with current rotation applied
-								*itsTransformedObserverMeshSet[NUM_INFLIGHT_BUFFERS];
+
+	//	A batch render needs one uniform buffer per tile,
+	//	but all of a frame's tiles share a single tiling buffer set,
+	//	because culling and level-of-detail see the full image.
+	//	These pools get created on demand, so an app that never
+	//	renders a batch never allocates them.
+	NSMutableArray<id<MTLBuffer>>	*itsBatchUniformBuffers[NUM_BATCH_FRAMES_IN_FLIGHT];
+	TilingBufferSet				*itsBatchTilingBufferSet[NUM_BATCH_FRAMES_IN_FLIGHT];
 	
-	id<MTLRenderPipelineState>	itsRenderPipelineStateSphericalFogBoxFull,
-								itsRenderPipelineStateSphericalFogBoxFullCubeMap,
-								itsRenderPipelineStateSphericalFogBoxFullBlended,
-								itsRenderPipelineStateSphericalFogBoxFront,
-								itsRenderPipelineStateSphericalFogBoxFrontCubeMap,
-								itsRenderPipelineStateSphericalFogBoxBack,
-								itsRenderPipelineStateSphericalFogBoxBackCubeMap,
-								itsRenderPipelineStateEuclideanFogBoxFull,
-								itsRenderPipelineStateEuclideanFogBoxFullCubeMap,
-								itsRenderPipelineStateEuclideanFogBoxFullBlended,
-								itsRenderPipelineStateHyperbolicFogBoxFull,
-								itsRenderPipelineStateHyperbolicFogBoxFullCubeMap,
-								itsRenderPipelineStateHyperbolicFogBoxFullBlended,
-								itsRenderPipelineStateNoFogBoxFull,
-								itsRenderPipelineStateNoFogBoxFullCubeMap,
-								itsRenderPipelineStateNoFogBoxFullBlended,
-								itsRenderPipelineStateNoFogBoxFront,
-								itsRenderPipelineStateNoFogBoxFrontCubeMap,
-								itsRenderPipelineStateNoFogBoxBack,
-								itsRenderPipelineStateNoFogBoxBackCubeMap;
+	//	itsRenderPipelineStates[t][v] holds the pipeline state
+	//	for ShaderFogAndClipBoxType t in PipelineVariant v,
+	//	or nil if it hasn't been compiled yet.  A background queue
+	//	fills in the array while the renderer draws, so itsRenderPipelineLock
+	//	protects it.  itsRenderPipelineGeneration changes whenever
+	//	the pipeline states get set up or shut down, to tell
+	//	the background queue when its work is no longer wanted.
+	id<MTLLibrary>				itsGPUFunctionLibrary;
+	os_unfair_lock				itsRenderPipelineLock;
+	unsigned int				itsRenderPipelineGeneration;
+	id<MTLRenderPipelineState>	itsRenderPipelineStates[NUM_SHADER_FOG_AND_CLIP_BOX_TYPES][NumPipelineVariants];
+
 	id<MTLDepthStencilState>	itsDepthStencilState;
 
-	//	itsDirichletWallsMeshSet and itsVertexFigureMeshSet
-	//	get used directly by the GPU.
-	//	By contrast, itsUnrotatedCenterpieceMeshSet and
-	//	itsUntransformedObserverMeshSet serve only
-	//	as the input data that gets transformed and written to
-	//	itsRotatedCenterpieceMeshSet and itsTransformedObserverMeshSet
-	//	once per frame.
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	//	The galaxy's images arrive in no particular order,
+	//	so they mustn't hide one another.  They still test
+	//	against the opaque content's depths, but write none of their own.
+	id<MTLDepthStencilState>	itsTransparencyDepthStencilState;
+
+	//	The galaxy accumulates into two extra color attachments,
+	//	which a second render pass then composites over the opaque scene.
+	//	The main pass must provide the attachments even when
+	//	no galaxy is present, because every pipeline state declares them.
+	//	The attachment textures get reallocated whenever
+	//	the render target's size changes.  When multisampling,
+	//	the multisample textures resolve into the single-sample ones,
+	//	which the composite pass reads.
+	id<MTLRenderPipelineState>	itsTransparencyCompositePipelineState;
+	id<MTLTexture>				itsTransparencyAccumulationTexture,
+								itsTransparencyRevealageTexture,
+								itsTransparencyAccumulationMultisampleTexture,	//	nil unless multisampling
+								itsTransparencyRevealageMultisampleTexture;		//	nil unless multisampling
+#endif
+
+	//	All renderers on the same device share their pipeline states,
+	//	samplers, textures and centerpiece and observer meshes
+	//	through itsResourceCache, so that additional windows
+	//	cost little additional GPU memory.
+	CurvedSpacesGPUResourceCache	*itsResourceCache;
+
+	//	A stereo pair renders MAX_NUM_VIEWS views in a single pass,
+	//	into the slices of a layered render target
+	//	(see -makeStereoRenderPassDescriptorForImageSize:modelData:).
+	//	The pipeline states get compiled for itsNumViews views,
+	//	so itsNumViews changes only when the graphics get set up again.
+	unsigned int				itsNumViews;
+
+	//	If the GPU supports indirect draw calls with a base instance,
+	//	it may cull and sort large honeycombs itself.
+	bool						itsGPUCullingIsAvailable;
+	id<MTLComputePipelineState>	itsCullPipelineState,
+								itsSortStepPipelineState,
+								itsCullFinishPipelineState,
+								itsCullScatterPipelineState;
+
+	//	itsHoneycombCellBuffer holds the cells' tiling matrices and centers
+	//	in private storage, and gets replaced (never rewritten) whenever
+	//	the honeycomb changes, so frames still in flight may keep using
+	//	the old one.  The next command buffer to get encoded
+	//	copies itsHoneycombCellStagingBuffer into it.
+	id<MTLBuffer>				itsHoneycombCellBuffer,
+								itsHoneycombCellStagingBuffer;
+
+	//	All four mesh sets get used directly by the GPU.
+	//	itsCenterpieceMeshSet and itsObserverMeshSet never change
+	//	once created:  the vertex function applies the centerpiece's
+	//	spin and the observer's placement, so those two mesh sets
+	//	live in private storage, shared with any other renderers.
 	MeshSet						*itsDirichletWallsMeshSet,
-								*itsUnrotatedCenterpieceMeshSet,
+								*itsCenterpieceMeshSet,		//	Earth, galaxy or gyroscope, unrotated
 								*itsVertexFigureMeshSet,
-								*itsUntransformedObserverMeshSet;
+								*itsObserverMeshSet;		//	at the origin, facing forward
 
 	id<MTLTexture>				itsWoodWallTexture,
 								itsPaperWallTexture,
@@ -290,6 +535,34 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 								itsWhiteObserverTexture;
 
 	id<MTLSamplerState>			itsAnisotropicTextureSampler;
+
+	//	The current on-screen frame's counters, for the frame statistics.
+	//	The tiling buffer methods count their reallocations here.
+	FrameCounters				itsFrameCounters;
+
+	//	The quality governor watches the on-screen frames' times
+	//	and lowers the render scale, the horizon and the level-of-detail
+	//	whenever the frames can't keep up with the display.
+	//	Offscreen and batch renders always get full quality.
+	QualityGovernor				itsQualityGovernor;
+	double						itsTargetFramePeriod;	//	in seconds
+
+	//	The horizon radius the governor's recent frames were drawn with.
+	//	When a larger or smaller honeycomb gets installed,
+	//	those frames no longer predict the workload.
+	double						itsGovernedHorizonRadius;
+
+	//	When the governor lowers the render scale, the scene gets drawn
+	//	into these reduced-scale textures and then stretched across
+	//	the drawable.  The textures get reallocated whenever
+	//	the scaled size changes.  When multisampling,
+	//	the multisample color texture resolves into the single-sample one,
+	//	which the upscale pass reads.
+	id<MTLRenderPipelineState>	itsUpscalePipelineState;
+	id<MTLSamplerState>			itsUpscaleSampler;
+	id<MTLTexture>				itsScaledColorTexture,
+								itsScaledColorMultisampleTexture,	//	nil unless multisampling
+								itsScaledDepthTexture;
 }
 
 
@@ -301,6 +574,8 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		mayExportWithTransparentBackground:false];
 	if (self != nil)
 	{
+		itsRenderPipelineLock		= OS_UNFAIR_LOCK_INIT;
+		itsRenderPipelineGeneration	= 0;
 	}
 	return self;
 }
@@ -326,7 +601,28 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	
 	itsCenterpieceType = md->itsCenterpieceType;
 
-	[self setUpPipelineStates];
+	itsResourceCache = [CurvedSpacesGPUResourceCache cacheForDevice:itsDevice];
+
+	//	Start each session at full quality.
+	ResetQualityGovernor(&itsQualityGovernor);
+	itsTargetFramePeriod		= GetDisplayFramePeriod();
+	itsGovernedHorizonRadius	= md->itsHorizonRadius;
+
+	//	Layered rendering requires an A12 or later GPU, or any Mac GPU.
+	//	A multisampled layered render target additionally requires iOS 14.
+	itsNumViews = 1;
+	if (md->itsStereoFlag
+	 && ([itsDevice supportsFamily:MTLGPUFamilyApple5]
+	  || [itsDevice supportsFamily:MTLGPUFamilyMac2]))
+	{
+		if ( ! itsMultisamplingFlag )
+			itsNumViews = MAX_NUM_VIEWS;
+		else
+		if (@available(iOS 14.0, macOS 10.14, *))
+			itsNumViews = MAX_NUM_VIEWS;
+	}
+
+	[self setUpPipelineStatesWithModelData:md];
 	[self setUpDepthStencilState];
 	[self setUpFixedBuffersWithModelData:md];
 	[self setUpInflightBuffers];
@@ -354,74 +650,223 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	[self shutDownInflightBuffers];
 	[self shutDownTextures];
 	[self shutDownSamplers];
+
+	//	Other renderers may still be using the shared resources,
+	//	so let the cache free only those that no renderer holds.
+	itsResourceCache = nil;
 	
 	[super shutDownGraphicsWithModelData:md];
 }
 
-- (void)setUpPipelineStates
+- (void)setUpPipelineStatesWithModelData:(ModelData *)md
 {
-	id<MTLLibrary>	theGPUFunctionLibrary;
+	id<MTLLibrary>			theGPUFunctionLibrary;
+	ShaderFogAndClipBoxType	theBoxFullType,
+							theBoxFrontType,
+							theBoxBackType;
+	unsigned int			theVariant;
 
 	theGPUFunctionLibrary = [itsDevice newDefaultLibrary];
+	itsGPUFunctionLibrary = theGPUFunctionLibrary;
+
+	os_unfair_lock_lock(&itsRenderPipelineLock);
+	itsRenderPipelineGeneration++;
+	os_unfair_lock_unlock(&itsRenderPipelineLock);
+
+	//	Compile only the pipeline states that the initial space
+	//	and options call for, usually 4 of the 28 possible,
+	//	so the first frame needn't wait for the rest.
+	//	Most will come from the binary archive anyhow,
+	//	except on the very first launch or after a system update.
+	if (md->itsFogFlag)
+	{
+		switch (md->itsSpaceType)
+		{
+			case SpaceSpherical:	theBoxFullType = ShaderSphericalFogBoxFull;		break;
+			case SpaceHyperbolic:	theBoxFullType = ShaderHyperbolicFogBoxFull;	break;
+			default:				theBoxFullType = ShaderEuclideanFogBoxFull;		break;
+		}
+		theBoxFrontType	= ShaderSphericalFogBoxFront;
+		theBoxBackType	= ShaderSphericalFogBoxBack;
+	}
+	else
+	{
+		theBoxFullType	= ShaderNoFogBoxFull;
+		theBoxFrontType	= ShaderNoFogBoxFront;
+		theBoxBackType	= ShaderNoFogBoxBack;
+	}
+	for (theVariant = 0; theVariant < NumPipelineVariants; theVariant++)
+	{
+		if (md->itsDrawBackHemisphere)
+		{
+			(void) [self renderPipelineStateForType:theBoxFrontType	variant:theVariant];
+			(void) [self renderPipelineStateForType:theBoxBackType	variant:theVariant];
+		}
+		else
+		{
+			(void) [self renderPipelineStateForType:theBoxFullType	variant:theVariant];
+		}
+	}
 
-	itsRenderPipelineStateSphericalFogBoxFull			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxFull,		false,	false);
-	itsRenderPipelineStateSphericalFogBoxFullCubeMap	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxFull,		true,	false);
-	itsRenderPipelineStateSphericalFogBoxFullBlended	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxFull,		false,	true );
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	itsTransparencyCompositePipelineState = [itsResourceCache
+		resourceForKey:	[NSString stringWithFormat:@"transparency composite pipeline %lu %u", (unsigned long)itsColorPixelFormat, itsNumViews]
+		creator:		^id{ return MakeTransparencyCompositePipelineState(self->itsResourceCache, self->itsColorPixelFormat, theGPUFunctionLibrary, self->itsNumViews); }];
+#endif
+	itsUpscalePipelineState = [itsResourceCache
+		resourceForKey:	[NSString stringWithFormat:@"upscale pipeline %lu %u", (unsigned long)itsColorPixelFormat, itsNumViews]
+		creator:		^id{ return MakeUpscalePipelineState(self->itsResourceCache, self->itsColorPixelFormat, theGPUFunctionLibrary, self->itsNumViews); }];
+
+	//	GPU culling relies on indirect draw calls whose instance_id
+	//	starts at a base instance.  All Macs that run macOS 11
+	//	support them, as do iOS devices with an A9 or later.
+	itsGPUCullingIsAvailable = false;
+	if (@available(iOS 13.0, macOS 10.15, *))
+	{
+		if ([itsDevice supportsFamily:MTLGPUFamilyApple3]
+		 || [itsDevice supportsFamily:MTLGPUFamilyMac2])
+		{
+			itsCullPipelineState		= SharedComputePipelineState(itsResourceCache, theGPUFunctionLibrary, @"CurvedSpacesCullFunction"		);
+			itsSortStepPipelineState	= SharedComputePipelineState(itsResourceCache, theGPUFunctionLibrary, @"CurvedSpacesSortStepFunction"	);
+			itsCullFinishPipelineState	= SharedComputePipelineState(itsResourceCache, theGPUFunctionLibrary, @"CurvedSpacesCullFinishFunction"	);
+			itsCullScatterPipelineState	= SharedComputePipelineState(itsResourceCache, theGPUFunctionLibrary, @"CurvedSpacesCullScatterFunction"	);
+
+			itsGPUCullingIsAvailable = (itsCullPipelineState		!= nil
+									 && itsSortStepPipelineState	!= nil
+									 && itsCullFinishPipelineState	!= nil
+									 && itsCullScatterPipelineState	!= nil);
+		}
+	}
 
-	itsRenderPipelineStateSphericalFogBoxFront			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxFront,	false,	false);
-	itsRenderPipelineStateSphericalFogBoxFrontCubeMap	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxFront,	true,	false);
+	//	Let a background queue compile the remaining render pipeline states
+	//	before they're needed, for example when the user switches
+	//	to a space of a different geometry.
+	[self compileRenderPipelineStatesInBackground];
+}
 
-	itsRenderPipelineStateSphericalFogBoxBack			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxBack,		false,	false);
-	itsRenderPipelineStateSphericalFogBoxBackCubeMap	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderSphericalFogBoxBack,		true,	false);
+- (void)shutDownPipelineStates
+{
+	unsigned int	theType,
+					theVariant;
 
-	itsRenderPipelineStateEuclideanFogBoxFull			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderEuclideanFogBoxFull,		false,	false);
-	itsRenderPipelineStateEuclideanFogBoxFullCubeMap	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderEuclideanFogBoxFull,		true,	false);
-	itsRenderPipelineStateEuclideanFogBoxFullBlended	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderEuclideanFogBoxFull,		false,	true );
+	//	Abandon any background compilation still in progress,
+	//	and save whatever it has already added to the binary archive.
+	os_unfair_lock_lock(&itsRenderPipelineLock);
+	itsRenderPipelineGeneration++;
+	for (theType = 0; theType < NUM_SHADER_FOG_AND_CLIP_BOX_TYPES; theType++)
+		for (theVariant = 0; theVariant < NumPipelineVariants; theVariant++)
+			itsRenderPipelineStates[theType][theVariant] = nil;
+	os_unfair_lock_unlock(&itsRenderPipelineLock);
 
-	itsRenderPipelineStateHyperbolicFogBoxFull			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderHyperbolicFogBoxFull,	false,	false);
-	itsRenderPipelineStateHyperbolicFogBoxFullCubeMap	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderHyperbolicFogBoxFull,	true,	false);
-	itsRenderPipelineStateHyperbolicFogBoxFullBlended	= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderHyperbolicFogBoxFull,	false,	true );
+	[itsResourceCache savePipelineArchive];
 
-	itsRenderPipelineStateNoFogBoxFull					= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxFull,			false,	false);
-	itsRenderPipelineStateNoFogBoxFullCubeMap			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxFull,			true,	false);
-	itsRenderPipelineStateNoFogBoxFullBlended			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxFull,			false,	true );
+	itsGPUFunctionLibrary = nil;
 
-	itsRenderPipelineStateNoFogBoxFront					= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxFront,			false,	false);
-	itsRenderPipelineStateNoFogBoxFrontCubeMap			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxFront,			true,	false);
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	itsTransparencyCompositePipelineState	= nil;
+#endif
+	itsUpscalePipelineState					= nil;
 
-	itsRenderPipelineStateNoFogBoxBack					= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxBack,			false,	false);
-	itsRenderPipelineStateNoFogBoxBackCubeMap			= MakePipelineState(itsDevice, itsColorPixelFormat, theGPUFunctionLibrary, itsMultisamplingFlag, ShaderNoFogBoxBack,			true,	false);
+	itsGPUCullingIsAvailable	= false;
+	itsCullPipelineState		= nil;
+	itsSortStepPipelineState	= nil;
+	itsCullFinishPipelineState	= nil;
+	itsCullScatterPipelineState	= nil;
 }
 
-- (void)shutDownPipelineStates
+- (void)compileRenderPipelineStatesInBackground
 {
-	itsRenderPipelineStateSphericalFogBoxFull			= nil;
-	itsRenderPipelineStateSphericalFogBoxFullCubeMap	= nil;
-	itsRenderPipelineStateSphericalFogBoxFullBlended	= nil;
+	unsigned int					theGeneration;
+	CurvedSpacesGPUResourceCache	*theResourceCache;
+	MTLPixelFormat					theColorPixelFormat;
+	id<MTLLibrary>					theGPUFunctionLibrary;
+	bool							theMultisamplingFlag;
+	unsigned int					theNumViews;
+
+	os_unfair_lock_lock(&itsRenderPipelineLock);
+	theGeneration = itsRenderPipelineGeneration;
+	os_unfair_lock_unlock(&itsRenderPipelineLock);
+
+	//	Copy the settings now, so the block needn't read
+	//	instance variables that -shutDownGraphicsWithModelData:
+	//	may reset meanwhile.
+	theResourceCache		= itsResourceCache;
+	theColorPixelFormat		= itsColorPixelFormat;
+	theGPUFunctionLibrary	= itsGPUFunctionLibrary;
+	theMultisamplingFlag	= itsMultisamplingFlag;
+	theNumViews				= itsNumViews;
+
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0),
+	^{
+		unsigned int				theType,
+									theVariant;
+		bool						theWorkIsWanted;
+		id<MTLRenderPipelineState>	thePipelineState;
+
+		for (theType = 0; theType < NUM_SHADER_FOG_AND_CLIP_BOX_TYPES; theType++)
+		{
+			for (theVariant = 0; theVariant < NumPipelineVariants; theVariant++)
+			{
+				if ( ! PipelineVariantIsUsed(theType, theVariant) )
+					continue;
+
+				os_unfair_lock_lock(&self->itsRenderPipelineLock);
+				if (self->itsRenderPipelineGeneration != theGeneration)
+				{
+					os_unfair_lock_unlock(&self->itsRenderPipelineLock);
+					return;
+				}
+				theWorkIsWanted = (self->itsRenderPipelineStates[theType][theVariant] == nil);
+				os_unfair_lock_unlock(&self->itsRenderPipelineLock);
+
+				if ( ! theWorkIsWanted )
+					continue;
+
+				thePipelineState = SharedPipelineState(theResourceCache, theColorPixelFormat, theGPUFunctionLibrary,
+										theMultisamplingFlag, theType, theVariant, theNumViews);
+
+				os_unfair_lock_lock(&self->itsRenderPipelineLock);
+				if (self->itsRenderPipelineGeneration == theGeneration
+				 && self->itsRenderPipelineStates[theType][theVariant] == nil)
+				{
+					self->itsRenderPipelineStates[theType][theVariant] = thePipelineState;
+				}
+				os_unfair_lock_unlock(&self->itsRenderPipelineLock);
+			}
+		}
 
-	itsRenderPipelineStateSphericalFogBoxFront			= nil;
-	itsRenderPipelineStateSphericalFogBoxFrontCubeMap	= nil;
+		[theResourceCache savePipelineArchive];
+	});
+}
 
-	itsRenderPipelineStateSphericalFogBoxBack			= nil;
-	itsRenderPipelineStateSphericalFogBoxBackCubeMap	= nil;
+- (id<MTLRenderPipelineState>)renderPipelineStateForType:(ShaderFogAndClipBoxType)aShaderFogAndClipBoxType variant:(PipelineVariant)aPipelineVariant
+{
+	id<MTLRenderPipelineState>	thePipelineState;
 
-	itsRenderPipelineStateEuclideanFogBoxFull			= nil;
-	itsRenderPipelineStateEuclideanFogBoxFullCubeMap	= nil;
-	itsRenderPipelineStateEuclideanFogBoxFullBlended	= nil;
+	if ( ! PipelineVariantIsUsed(aShaderFogAndClipBoxType, aPipelineVariant) )
+		return nil;
 
-	itsRenderPipelineStateHyperbolicFogBoxFull			= nil;
-	itsRenderPipelineStateHyperbolicFogBoxFullCubeMap	= nil;
-	itsRenderPipelineStateHyperbolicFogBoxFullBlended	= nil;
+	os_unfair_lock_lock(&itsRenderPipelineLock);
+	thePipelineState = itsRenderPipelineStates[aShaderFogAndClipBoxType][aPipelineVariant];
+	os_unfair_lock_unlock(&itsRenderPipelineLock);
 
-	itsRenderPipelineStateNoFogBoxFull					= nil;
-	itsRenderPipelineStateNoFogBoxFullCubeMap			= nil;
-	itsRenderPipelineStateNoFogBoxFullBlended			= nil;
+	//	If the background queue hasn't reached this pipeline state yet,
+	//	compile it now.  Should the background queue finish it first,
+	//	keep whichever copy arrived first -- they're identical anyhow.
+	if (thePipelineState == nil)
+	{
+		thePipelineState = SharedPipelineState(itsResourceCache, itsColorPixelFormat, itsGPUFunctionLibrary,
+								itsMultisamplingFlag, aShaderFogAndClipBoxType, aPipelineVariant, itsNumViews);
 
-	itsRenderPipelineStateNoFogBoxFront					= nil;
-	itsRenderPipelineStateNoFogBoxFrontCubeMap			= nil;
+		os_unfair_lock_lock(&itsRenderPipelineLock);
+		if (itsRenderPipelineStates[aShaderFogAndClipBoxType][aPipelineVariant] == nil)
+			itsRenderPipelineStates[aShaderFogAndClipBoxType][aPipelineVariant] = thePipelineState;
+		else
+			thePipelineState = itsRenderPipelineStates[aShaderFogAndClipBoxType][aPipelineVariant];
+		os_unfair_lock_unlock(&itsRenderPipelineLock);
+	}
 
-	itsRenderPipelineStateNoFogBoxBack					= nil;
-	itsRenderPipelineStateNoFogBoxBackCubeMap			= nil;
+	return thePipelineState;
 }
 
 - (void)setUpDepthStencilState
@@ -432,29 +877,46 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	[theDepthStencilDescriptor setDepthCompareFunction:MTLCompareFunctionLess];
 	[theDepthStencilDescriptor setDepthWriteEnabled:YES];
 	itsDepthStencilState = [itsDevice newDepthStencilStateWithDescriptor:theDepthStencilDescriptor];
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	[theDepthStencilDescriptor setDepthWriteEnabled:NO];
+	itsTransparencyDepthStencilState = [itsDevice newDepthStencilStateWithDescriptor:theDepthStencilDescriptor];
+#endif
 }
 
 - (void)shutDownDepthStencilState
 {
 	itsDepthStencilState = nil;
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	itsTransparencyDepthStencilState = nil;
+#endif
 }
 
 - (void)setUpFixedBuffersWithModelData:(ModelData *)md
 {
+	//	The Dirichlet walls and the vertex figures depend on the space,
+	//	so each renderer keeps its own.
 	itsDirichletWallsMeshSet = MakeEmptyMeshSet();
 	RefreshDirichletWalls(itsDirichletWallsMeshSet, itsDevice, md);
-	
-	itsUnrotatedCenterpieceMeshSet	= MakeCenterpieceMeshSet(itsCenterpieceType, itsDevice);
-	itsVertexFigureMeshSet			= MakeVertexFigureMeshSet(itsDevice, md);
-	itsUntransformedObserverMeshSet	= MakeObserverMeshSet(itsDevice);
+	itsVertexFigureMeshSet	= MakeVertexFigureMeshSet(itsDevice, md);
+
+	itsCenterpieceMeshSet	= [self sharedCenterpieceMeshSet:itsCenterpieceType];
+	itsObserverMeshSet		= [self sharedObserverMeshSet];
+
+	//	-refreshHoneycombCellBufferWithModelData: will create
+	//	itsHoneycombCellBuffer when it's first needed.
+	itsHoneycombCellBuffer			= nil;
+	itsHoneycombCellStagingBuffer	= nil;
 }
 
 - (void)shutDownFixedBuffers
 {
 	itsDirichletWallsMeshSet		= nil;
-	itsUnrotatedCenterpieceMeshSet	= nil;
+	itsCenterpieceMeshSet			= nil;
 	itsVertexFigureMeshSet			= nil;
-	itsUntransformedObserverMeshSet	= nil;
+	itsObserverMeshSet				= nil;
+	itsHoneycombCellBuffer			= nil;
+	itsHoneycombCellStagingBuffer	= nil;
 }
 
 - (void)setUpInflightBuffers
@@ -463,10 +925,14 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	
 	for (i = 0; i < NUM_INFLIGHT_BUFFERS; i++)
 	{
-		itsUniformBuffer[i]					= [itsDevice newBufferWithLength:sizeof(CurvedSpacesUniformData) options:MTLResourceStorageModeShared];
-		itsTilingBufferSet[i]				= MakeEmptyTilingBufferSet();
-		itsRotatedCenterpieceMeshSet[i]		= MakeEmptyMeshSet();
-		itsTransformedObserverMeshSet[i]	= MakeEmptyMeshSet();
+		itsUniformBuffer[i]		= [itsDevice newBufferWithLength:sizeof(CurvedSpacesUniformData) options:MTLResourceStorageModeShared];
+		itsTilingBufferSet[i]	= MakeEmptyTilingBufferSet();
+	}
+
+	for (i = 0; i < NUM_BATCH_FRAMES_IN_FLIGHT; i++)
+	{
+		itsBatchUniformBuffers[i]	= nil;
+		itsBatchTilingBufferSet[i]	= nil;
 	}
 }
 
@@ -476,30 +942,19 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	
 	for (i = 0; i < NUM_INFLIGHT_BUFFERS; i++)
 	{
-		itsUniformBuffer[i]					= nil;
-		itsTilingBufferSet[i]				= nil;
-		itsRotatedCenterpieceMeshSet[i]		= nil;
-		itsTransformedObserverMeshSet[i]	= nil;
+		itsUniformBuffer[i]		= nil;
+		itsTilingBufferSet[i]	= nil;
+	}
+
+	for (i = 0; i < NUM_BATCH_FRAMES_IN_FLIGHT; i++)
+	{
+		itsBatchUniformBuffers[i]	= nil;
+		itsBatchTilingBufferSet[i]	= nil;
 	}
 }
 
 - (void)setUpTextures
 {
-	MTKTextureLoader							*theTextureLoader;
-	NSDictionary<MTKTextureLoaderOption, id>	*theTextureLoaderOptions;
-	NSError										*theError = nil;
-	
-	theTextureLoader		= [[MTKTextureLoader alloc] initWithDevice:itsDevice];
-	theTextureLoaderOptions	=
-	@{
-		MTKTextureLoaderOptionTextureUsage			:	@(MTLTextureUsageShaderRead),
-		MTKTextureLoaderOptionTextureStorageMode	:	@(MTLStorageModePrivate),
-		MTKTextureLoaderOptionAllocateMipmaps		:	@(YES),
-		MTKTextureLoaderOptionGenerateMipmaps		:	@(YES)	//	-newTextureWithName:… ignores this option
-																//		(as confirmed in its documentation).
-																//	Instead, the Asset Catalog provides the mipmaps.
-	};
-
 #if   (SHAPE_OF_SPACE_CH_16 == 3)
 	itsWoodWallTexture			= [self makeRGBATextureOfColor:(ColorP3Linear){0.00, 1.00, 0.50, 1.00} size:1];
 									//	The 3rd edition of The Shape of Space used a texture
@@ -516,34 +971,16 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 									//	whose gamma-encode color values were sRGB(0.50, 0.50, 1.00).
 									//	See comment immediately above for further discussion.
 #else
-	itsWoodWallTexture			= [theTextureLoader
-									newTextureWithName:@"wood"
-									scaleFactor:1.0
-									bundle:nil
-									options:theTextureLoaderOptions
-									error:&theError];
+	itsWoodWallTexture			= [self sharedTextureNamed:@"wood"];
 #endif
 
-	itsPaperWallTexture			= [theTextureLoader
-									newTextureWithName:@"paper"
-									scaleFactor:1.0
-									bundle:nil
-									options:theTextureLoaderOptions
-									error:&theError];
-
-	itsCenterpieceTexture		= [self loadTextureForCenterpiece:	itsCenterpieceType
-											textureLoader:			theTextureLoader
-											textureLoaderOptions:	theTextureLoaderOptions
-											error:					&theError];
-
-	itsStoneVertexFigureTexture	= [theTextureLoader
-									newTextureWithName:@"stone"
-									scaleFactor:1.0
-									bundle:nil
-									options:theTextureLoaderOptions
-									error:&theError];
+	itsPaperWallTexture			= [self sharedTextureNamed:@"paper"];
+	itsCenterpieceTexture		= [self sharedCenterpieceTexture:itsCenterpieceType];
+	itsStoneVertexFigureTexture	= [self sharedTextureNamed:@"stone"];
 
-	itsWhiteObserverTexture		= [self makeRGBATextureOfColor:(ColorP3Linear){1.0, 1.0, 1.0, 1.0} size:1];
+	itsWhiteObserverTexture		= [itsResourceCache
+									resourceForKey:	@"texture white"
+									creator:		^id{ return [self makeRGBATextureOfColor:(ColorP3Linear){1.0, 1.0, 1.0, 1.0} size:1]; }];
 }
 
 - (void)shutDownTextures
@@ -553,31 +990,64 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	itsCenterpieceTexture		= nil;
 	itsStoneVertexFigureTexture	= nil;
 	itsWhiteObserverTexture		= nil;
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	itsTransparencyAccumulationTexture				= nil;
+	itsTransparencyRevealageTexture					= nil;
+	itsTransparencyAccumulationMultisampleTexture	= nil;
+	itsTransparencyRevealageMultisampleTexture		= nil;
+#endif
+
+	itsScaledColorTexture				= nil;
+	itsScaledColorMultisampleTexture	= nil;
+	itsScaledDepthTexture				= nil;
 }
 
 - (void)setUpSamplers
 {
-	MTLSamplerDescriptor	*theDescriptor;
-	
-	theDescriptor = [[MTLSamplerDescriptor alloc] init];
+	itsAnisotropicTextureSampler = [itsResourceCache
+		resourceForKey:	@"anisotropic sampler"
+		creator:		^id{
+							MTLSamplerDescriptor	*theDescriptor;
 
-	[theDescriptor setNormalizedCoordinates:YES];
+							theDescriptor = [[MTLSamplerDescriptor alloc] init];
 
-	[theDescriptor setSAddressMode:MTLSamplerAddressModeRepeat];
-	[theDescriptor setTAddressMode:MTLSamplerAddressModeRepeat];
+							[theDescriptor setNormalizedCoordinates:YES];
 
-	[theDescriptor setMinFilter:MTLSamplerMinMagFilterLinear];
-	[theDescriptor setMagFilter:MTLSamplerMinMagFilterLinear];
-	[theDescriptor setMipFilter:MTLSamplerMipFilterLinear];
-	
-	[theDescriptor setMaxAnisotropy:16];
-	
-	itsAnisotropicTextureSampler = [itsDevice newSamplerStateWithDescriptor:theDescriptor];
+							[theDescriptor setSAddressMode:MTLSamplerAddressModeRepeat];
+							[theDescriptor setTAddressMode:MTLSamplerAddressModeRepeat];
+
+							[theDescriptor setMinFilter:MTLSamplerMinMagFilterLinear];
+							[theDescriptor setMagFilter:MTLSamplerMinMagFilterLinear];
+							[theDescriptor setMipFilter:MTLSamplerMipFilterLinear];
+
+							[theDescriptor setMaxAnisotropy:16];
+
+							return [self->itsDevice newSamplerStateWithDescriptor:theDescriptor];
+						}];
+
+	//	The upscale pass samples a single mipmap level,
+	//	and must never wrap one edge of the scene onto the other.
+	itsUpscaleSampler = [itsResourceCache
+		resourceForKey:	@"upscale sampler"
+		creator:		^id{
+							MTLSamplerDescriptor	*theDescriptor;
+
+							theDescriptor = [[MTLSamplerDescriptor alloc] init];
+							[theDescriptor setNormalizedCoordinates:YES];
+							[theDescriptor setSAddressMode:MTLSamplerAddressModeClampToEdge];
+							[theDescriptor setTAddressMode:MTLSamplerAddressModeClampToEdge];
+							[theDescriptor setMinFilter:MTLSamplerMinMagFilterLinear];
+							[theDescriptor setMagFilter:MTLSamplerMinMagFilterLinear];
+
+							return [self->itsDevice newSamplerStateWithDescriptor:theDescriptor];
+						}];
 }
 
 - (void)shutDownSamplers
 {
-	itsAnisotropicTextureSampler = nil;
+	itsAnisotropicTextureSampler	= nil;
+	itsUpscaleSampler				= nil;
 }
 
 
@@ -587,35 +1057,72 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 - (NSDictionary<NSString *, id> *)prepareInflightDataBuffersAtIndex:(unsigned int)anInflightBufferIndex modelData:(ModelData *)md
 {
 	NSMutableDictionary<NSString *, id>	*theDictionary;
+	double								theCPUSeconds,
+										theGPUSeconds;
+	QualitySettings						theQualitySettings;
+	CGSize								theImageSize;
 	ViewProjectionMatrixSet				theViewProjectionMatrixSet;
 
-	theDictionary = [[NSMutableDictionary<NSString *, id> alloc] initWithCapacity:2];
+	theDictionary = [[NSMutableDictionary<NSString *, id> alloc] initWithCapacity:4];
+
+	//	Let the most recent frame's times guide this frame's quality.
+	//	The GPU time lags a frame or two behind the CPU time,
+	//	which the governor's settling period allows for.
+	GetLatestFrameSeconds(&theCPUSeconds, &theGPUSeconds);
+	if (md->itsHorizonRadius != itsGovernedHorizonRadius)
+	{
+		SettleQualityGovernor(&itsQualityGovernor);
+		itsGovernedHorizonRadius = md->itsHorizonRadius;
+	}
+	UpdateQualityGovernor(&itsQualityGovernor, theCPUSeconds, theGPUSeconds, itsTargetFramePeriod);
+	GetQualitySettings(&itsQualityGovernor, &theQualitySettings);
+
+	//	A reduced-scale frame culls and chooses its levels-of-detail
+	//	for the pixels it actually renders.  The "render scale" entry asks
+	//	-encodeCommandsToCommandBuffer:… to render at that scale
+	//	and stretch the result across the drawable.
+	if (theQualitySettings.itsRenderScale < 1.0)
+	{
+		theImageSize = (CGSize){
+			MAX(1.0, floor(theQualitySettings.itsRenderScale * itsOnscreenNativeSizePx.width )),
+			MAX(1.0, floor(theQualitySettings.itsRenderScale * itsOnscreenNativeSizePx.height))};
+		[theDictionary setValue:	@(theQualitySettings.itsRenderScale)
+						 forKey:	@"render scale"];
+	}
+	else
+		theImageSize = itsOnscreenNativeSizePx;
+
+	itsFrameCounters = (FrameCounters){0};
 
-	theViewProjectionMatrixSet = [self makeViewProjectionMatrixSetForImageSize:itsOnscreenNativeSizePx modelData:md];
+	theViewProjectionMatrixSet = [self makeViewProjectionMatrixSetForImageSize:theImageSize modelData:md];
 	
 	[self writeUniformsIntoBuffer:	itsUniformBuffer[anInflightBufferIndex]
-					forImageSize:	itsOnscreenNativeSizePx
+					forImageSize:	theImageSize
 					matrixSet:		theViewProjectionMatrixSet
+						quality:	&theQualitySettings
 					modelData:		md];
 	[theDictionary setValue:	itsUniformBuffer[anInflightBufferIndex]
 					 forKey:	@"uniform buffer"];
 
+	//	Bring the meshes up to date first, because the level-of-detail
+	//	cutoffs depend on each mesh's geometric error.
+	[self updateMeshesAndTexturesAsNeededUsingModelData:md];
+
 	[self writeSortedVisibleTilesIntoBufferSet:	itsTilingBufferSet[anInflightBufferIndex]
-								forImageSize:	itsOnscreenNativeSizePx
+								forImageSize:	theImageSize
 								matrixSet:		theViewProjectionMatrixSet
+									quality:	&theQualitySettings
 								modelData:		md];
 	[theDictionary setValue:	itsTilingBufferSet[anInflightBufferIndex]
 					 forKey:	@"tiling buffer set"];
 
-	[self updateMeshesAndTexturesAsNeededUsingModelData:md];
-	
-	[self writeRotatedCenterpieceIntoMeshSet:itsRotatedCenterpieceMeshSet[anInflightBufferIndex] modelData:md];
-	[theDictionary setValue:	itsRotatedCenterpieceMeshSet[anInflightBufferIndex]
-					 forKey:	@"rotated centerpiece mesh set"];
-	
-	[self writeTransformedObserverIntoMeshSet:itsTransformedObserverMeshSet[anInflightBufferIndex] modelData:md];
-	[theDictionary setValue:	itsTransformedObserverMeshSet[anInflightBufferIndex]
-					 forKey:	@"transformed observer mesh set"];
+	//	Only on-screen frames contribute to the frame statistics.
+	//	The "frame statistics" entry asks -encodeCommandsToCommandBuffer:…
+	//	to report the frame's GPU time.
+	[self countTilesInBufferSet:itsTilingBufferSet[anInflightBufferIndex] counters:&itsFrameCounters];
+	RecordFrameCounters(&itsFrameCounters);
+	[theDictionary setValue:	@YES
+					 forKey:	@"frame statistics"];
 
 	return theDictionary;
 }
@@ -626,44 +1133,296 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	ViewProjectionMatrixSet				theViewProjectionMatrixSet;
 	id<MTLBuffer>						theOneShotUniformBuffer;
 	TilingBufferSet						*theOneShotTilingBufferSet;
-	MeshSet								*theOneShotCenterpieceMeshSet,
-										*theOneShotObserverMeshSet;
+	QualitySettings						theQualitySettings;
 	
 	theDictionary = [[NSMutableDictionary<NSString *, id> alloc] initWithCapacity:2];
 
+	//	Offscreen images, for example for copying or saving,
+	//	always get full quality, whatever the on-screen frame rate.
+	GetFullQualitySettings(&theQualitySettings);
+
 	theViewProjectionMatrixSet = [self makeViewProjectionMatrixSetForImageSize:anImageSize modelData:md];
 	
 	theOneShotUniformBuffer	= [itsDevice newBufferWithLength:sizeof(CurvedSpacesUniformData) options:MTLResourceStorageModeShared];
 	[self writeUniformsIntoBuffer:	theOneShotUniformBuffer
 					forImageSize:	anImageSize
 					matrixSet:		theViewProjectionMatrixSet
+						quality:	&theQualitySettings
 					modelData:		md];
 	[theDictionary setValue:	theOneShotUniformBuffer
 					 forKey:	@"uniform buffer"];
 
+	//	Bring the meshes up to date first, as above.
+	[self updateMeshesAndTexturesAsNeededUsingModelData:md];
+
 	theOneShotTilingBufferSet = MakeEmptyTilingBufferSet();
 	[self writeSortedVisibleTilesIntoBufferSet:	theOneShotTilingBufferSet
 								forImageSize:	anImageSize
 								matrixSet:		theViewProjectionMatrixSet
+									quality:	&theQualitySettings
 								modelData:		md];
 	[theDictionary setValue:	theOneShotTilingBufferSet
 					 forKey:	@"tiling buffer set"];
 
+	return theDictionary;
+}
+
+- (NSDictionary<NSString *, id> *)prepareInflightDataBuffersForBatchFrameAtIndex:	(unsigned int)aBatchFrameIndex
+																		imageSize:	(CGSize)anImageSize
+																		tiles:		(const CGRect *)someTiles
+																		numTiles:	(unsigned int)aNumTiles
+																		modelData:	(ModelData *)md
+{
+	NSMutableDictionary<NSString *, id>	*theDictionary;
+	ViewProjectionMatrixSet				theViewProjectionMatrixSet,
+										theTileMatrixSet;
+	NSMutableArray<id<MTLBuffer>>		*theUniformBuffers;
+	TilingBufferSet						*theTilingBufferSet;
+	QualitySettings						theQualitySettings;
+	unsigned int						i;
+
+	//	Like -prepareInflightDataBuffersForOffscreenRenderingAtSize:modelData:
+	//	but with pooled buffers, so a long batch allocates nothing
+	//	once its first NUM_BATCH_FRAMES_IN_FLIGHT frames are under way.
+	//	The caller must not re-use aBatchFrameIndex until the GPU
+	//	has finished with the previous frame at that index.
+	//
+	//	The dictionary's "uniform buffers" entry holds one uniform buffer
+	//	per tile, in the order the tiles were given.
+
+	GEOMETRY_GAMES_ASSERT(
+		aBatchFrameIndex < NUM_BATCH_FRAMES_IN_FLIGHT,
+		"invalid batch frame index");
+
+	theDictionary = [[NSMutableDictionary<NSString *, id> alloc] initWithCapacity:2];
+
+	//	A batch render is a sequence of still images,
+	//	so it always gets full quality too.
+	GetFullQualitySettings(&theQualitySettings);
+
+	theViewProjectionMatrixSet = [self makeViewProjectionMatrixSetForImageSize:anImageSize modelData:md];
+
+	theUniformBuffers = itsBatchUniformBuffers[aBatchFrameIndex];
+	if (theUniformBuffers == nil)
+	{
+		theUniformBuffers = [[NSMutableArray<id<MTLBuffer>> alloc] initWithCapacity:aNumTiles];
+		itsBatchUniformBuffers[aBatchFrameIndex] = theUniformBuffers;
+	}
+	while ([theUniformBuffers count] < aNumTiles)
+		[theUniformBuffers addObject:[itsDevice newBufferWithLength:sizeof(CurvedSpacesUniformData) options:MTLResourceStorageModeShared]];
+
+	//	Each tile sees the same scene as the full image would,
+	//	but with its projection matrices narrowed to the tile.
+	for (i = 0; i < aNumTiles; i++)
+	{
+		theTileMatrixSet = theViewProjectionMatrixSet;
+		RestrictProjectionToTile(theTileMatrixSet.itsProjectionMatrixForBoxFull,  anImageSize, someTiles[i]);
+		RestrictProjectionToTile(theTileMatrixSet.itsProjectionMatrixForBoxFront, anImageSize, someTiles[i]);
+		RestrictProjectionToTile(theTileMatrixSet.itsProjectionMatrixForBoxBack,  anImageSize, someTiles[i]);
+
+		[self writeUniformsIntoBuffer:	theUniformBuffers[i]
+						forImageSize:	anImageSize
+						matrixSet:		theTileMatrixSet
+							quality:	&theQualitySettings
+						modelData:		md];
+	}
+	[theDictionary setValue:	[theUniformBuffers subarrayWithRange:(NSRange){0, aNumTiles}]
+					 forKey:	@"uniform buffers"];
+
+	//	Bring the meshes up to date first, as above.
 	[self updateMeshesAndTexturesAsNeededUsingModelData:md];
 
-	theOneShotCenterpieceMeshSet = MakeEmptyMeshSet();
-	[self writeRotatedCenterpieceIntoMeshSet:theOneShotCenterpieceMeshSet modelData:md];
-	[theDictionary setValue:	theOneShotCenterpieceMeshSet
-					 forKey:	@"rotated centerpiece mesh set"];
-	
-	theOneShotObserverMeshSet = MakeEmptyMeshSet();
-	[self writeTransformedObserverIntoMeshSet:theOneShotObserverMeshSet modelData:md];
-	[theDictionary setValue:	theOneShotObserverMeshSet
-					 forKey:	@"transformed observer mesh set"];
+	//	Cull against the full image, not the individual tiles,
+	//	so the level-of-detail choices don't vary from tile to tile.
+	theTilingBufferSet = itsBatchTilingBufferSet[aBatchFrameIndex];
+	if (theTilingBufferSet == nil)
+	{
+		theTilingBufferSet = MakeEmptyTilingBufferSet();
+		itsBatchTilingBufferSet[aBatchFrameIndex] = theTilingBufferSet;
+	}
+	[self writeSortedVisibleTilesIntoBufferSet:	theTilingBufferSet
+								forImageSize:	anImageSize
+								matrixSet:		theViewProjectionMatrixSet
+									quality:	&theQualitySettings
+								modelData:		md];
+	[theDictionary setValue:	theTilingBufferSet
+					 forKey:	@"tiling buffer set"];
 
 	return theDictionary;
 }
 
+- (MTLRenderPassDescriptor *)makeBatchRenderPassDescriptorForTileSize:(CGSize)aTileSize modelData:(ModelData *)md
+{
+	MTLTextureDescriptor	*theColorDescriptor,
+							*theMultisampleDescriptor,
+							*theDepthDescriptor;
+	id<MTLTexture>			theColorTexture,
+							theMultisampleTexture,
+							theDepthTexture;
+	ColorP3Linear			theClearColor;
+	MTLRenderPassDescriptor	*theRenderPassDescriptor;
+
+	//	The batch renderer blits each finished tile out of its color texture
+	//	(the resolve texture, when multisampling) into a shared buffer,
+	//	so all textures may live in private storage.  The pixel format
+	//	and sample count must match the pipeline states'.
+
+	theColorDescriptor = [MTLTextureDescriptor
+		texture2DDescriptorWithPixelFormat:	itsColorPixelFormat
+		width:								(NSUInteger) aTileSize.width
+		height:								(NSUInteger) aTileSize.height
+		mipmapped:							NO];
+	[theColorDescriptor setUsage:MTLTextureUsageRenderTarget];
+	[theColorDescriptor setStorageMode:MTLStorageModePrivate];
+	theColorTexture = [itsDevice newTextureWithDescriptor:theColorDescriptor];
+
+	theDepthDescriptor = [MTLTextureDescriptor
+		texture2DDescriptorWithPixelFormat:	MTLPixelFormatDepth32Float
+		width:								(NSUInteger) aTileSize.width
+		height:								(NSUInteger) aTileSize.height
+		mipmapped:							NO];
+	[theDepthDescriptor setUsage:MTLTextureUsageRenderTarget];
+	[theDepthDescriptor setStorageMode:MTLStorageModePrivate];
+	if (itsMultisamplingFlag)
+	{
+		[theDepthDescriptor setTextureType:MTLTextureType2DMultisample];
+		[theDepthDescriptor setSampleCount:METAL_MULTISAMPLING_NUM_SAMPLES];
+	}
+	theDepthTexture = [itsDevice newTextureWithDescriptor:theDepthDescriptor];
+
+	theRenderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+
+	theClearColor = [self clearColorWithModelData:md];
+	[[theRenderPassDescriptor colorAttachments][0] setClearColor:
+		MTLClearColorMake(theClearColor.r, theClearColor.g, theClearColor.b, theClearColor.a)];
+	[[theRenderPassDescriptor colorAttachments][0] setLoadAction:MTLLoadActionClear];
+
+	if (itsMultisamplingFlag)
+	{
+		theMultisampleDescriptor = [theColorDescriptor copy];
+		[theMultisampleDescriptor setTextureType:MTLTextureType2DMultisample];
+		[theMultisampleDescriptor setSampleCount:METAL_MULTISAMPLING_NUM_SAMPLES];
+		theMultisampleTexture = [itsDevice newTextureWithDescriptor:theMultisampleDescriptor];
+
+		[[theRenderPassDescriptor colorAttachments][0] setTexture:theMultisampleTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setResolveTexture:theColorTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionMultisampleResolve];
+	}
+	else
+	{
+		[[theRenderPassDescriptor colorAttachments][0] setTexture:theColorTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionStore];
+	}
+
+	[[theRenderPassDescriptor depthAttachment] setTexture:theDepthTexture];
+	[[theRenderPassDescriptor depthAttachment] setClearDepth:1.0];
+	[[theRenderPassDescriptor depthAttachment] setLoadAction:MTLLoadActionClear];
+	[[theRenderPassDescriptor depthAttachment] setStoreAction:MTLStoreActionDontCare];
+
+	return theRenderPassDescriptor;
+}
+
+- (MTLRenderPassDescriptor *)makeStereoRenderPassDescriptorForImageSize:(CGSize)anImageSize modelData:(ModelData *)md
+{
+	MTLTextureDescriptor	*theColorDescriptor,
+							*theMultisampleDescriptor,
+							*theDepthDescriptor;
+	id<MTLTexture>			theColorTexture,
+							theMultisampleTexture,
+							theDepthTexture;
+	ColorP3Linear			theClearColor;
+	MTLRenderPassDescriptor	*theRenderPassDescriptor;
+
+	//	A stereo pair renders each eye's view into its own slice
+	//	of a layered render target, with the left eye in slice 0
+	//	and the right eye in slice 1.  The caller may read
+	//	the color texture's slices once the frame completes,
+	//	for example to present them on a stereo display.
+	//	Returns nil unless the graphics got set up for a stereo pair.
+
+	if (itsNumViews < 2)
+		return nil;
+
+	theColorDescriptor = [MTLTextureDescriptor
+		texture2DDescriptorWithPixelFormat:	itsColorPixelFormat
+		width:								(NSUInteger) anImageSize.width
+		height:								(NSUInteger) anImageSize.height
+		mipmapped:							NO];
+	[theColorDescriptor setTextureType:MTLTextureType2DArray];
+	[theColorDescriptor setArrayLength:itsNumViews];
+	[theColorDescriptor setUsage:(MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead)];
+	[theColorDescriptor setStorageMode:MTLStorageModePrivate];
+	theColorTexture = [itsDevice newTextureWithDescriptor:theColorDescriptor];
+
+	theDepthDescriptor = [MTLTextureDescriptor
+		texture2DDescriptorWithPixelFormat:	MTLPixelFormatDepth32Float
+		width:								(NSUInteger) anImageSize.width
+		height:								(NSUInteger) anImageSize.height
+		mipmapped:							NO];
+	[theDepthDescriptor setTextureType:MTLTextureType2DArray];
+	[theDepthDescriptor setArrayLength:itsNumViews];
+	[theDepthDescriptor setUsage:MTLTextureUsageRenderTarget];
+	[theDepthDescriptor setStorageMode:MTLStorageModePrivate];
+	if (itsMultisamplingFlag)
+	{
+		//	-setUpGraphicsWithModelData: has already checked
+		//	that layered multisampling is available.
+		if (@available(iOS 14.0, macOS 10.14, *))
+		{
+			[theDepthDescriptor setTextureType:MTLTextureType2DMultisampleArray];
+			[theDepthDescriptor setSampleCount:METAL_MULTISAMPLING_NUM_SAMPLES];
+		}
+	}
+	theDepthTexture = [itsDevice newTextureWithDescriptor:theDepthDescriptor];
+
+	theRenderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+	[theRenderPassDescriptor setRenderTargetArrayLength:itsNumViews];
+
+	theClearColor = [self clearColorWithModelData:md];
+	[[theRenderPassDescriptor colorAttachments][0] setClearColor:
+		MTLClearColorMake(theClearColor.r, theClearColor.g, theClearColor.b, theClearColor.a)];
+	[[theRenderPassDescriptor colorAttachments][0] setLoadAction:MTLLoadActionClear];
+
+	if (itsMultisamplingFlag)
+	{
+		theMultisampleDescriptor = [theColorDescriptor copy];
+		if (@available(iOS 14.0, macOS 10.14, *))
+			[theMultisampleDescriptor setTextureType:MTLTextureType2DMultisampleArray];
+		[theMultisampleDescriptor setSampleCount:METAL_MULTISAMPLING_NUM_SAMPLES];
+		[theMultisampleDescriptor setUsage:MTLTextureUsageRenderTarget];
+		theMultisampleTexture = [itsDevice newTextureWithDescriptor:theMultisampleDescriptor];
+
+		[[theRenderPassDescriptor colorAttachments][0] setTexture:theMultisampleTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setResolveTexture:theColorTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionMultisampleResolve];
+	}
+	else
+	{
+		[[theRenderPassDescriptor colorAttachments][0] setTexture:theColorTexture];
+		[[theRenderPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionStore];
+	}
+
+	[[theRenderPassDescriptor depthAttachment] setTexture:theDepthTexture];
+	[[theRenderPassDescriptor depthAttachment] setClearDepth:1.0];
+	[[theRenderPassDescriptor depthAttachment] setLoadAction:MTLLoadActionClear];
+	[[theRenderPassDescriptor depthAttachment] setStoreAction:MTLStoreActionDontCare];
+
+	return theRenderPassDescriptor;
+}
+
+- (NSUInteger)maxBatchTileSize
+{
+	//	Apple3 and later GPUs, and all Mac GPUs,
+	//	support 16384×16384 textures.
+	if ([itsDevice supportsFamily:MTLGPUFamilyApple3]
+	 || [itsDevice supportsFamily:MTLGPUFamilyMac2])
+	{
+		return 16384;
+	}
+	else
+		return 8192;
+}
+
 - (ViewProjectionMatrixSet)makeViewProjectionMatrixSetForImageSize:(CGSize)anImageSize modelData:(ModelData *)md
 {
 	ViewProjectionMatrixSet	theViewProjectionMatrixSet;
@@ -698,9 +1457,20 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 - (void)writeUniformsIntoBuffer:	(id<MTLBuffer>)aUniformsBuffer
 					forImageSize:	(CGSize)anImageSize
 					matrixSet:		(ViewProjectionMatrixSet)aMatrixSet
+						quality:	(const QualitySettings *)someQualitySettings
 					modelData:		(ModelData *)md
 {
 	CurvedSpacesUniformData	*theUniformData;
+	double					theHorizonRadius;
+	unsigned int			theView;
+	double					theEyeOffset;
+	Matrix					theEyeViewMatrix,
+							theViewMatrix,
+							theAntipodalMap,
+							theInvertedViewMatrix;
+#ifdef START_OUTSIDE
+	Matrix					theTranslation;
+#endif
 
 
 	GEOMETRY_GAMES_ASSERT(
@@ -709,9 +1479,57 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	
 	theUniformData = (CurvedSpacesUniformData *) [aUniformsBuffer contents];
 
-	theUniformData->itsProjectionMatrixForBoxFull	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxFull );
-	theUniformData->itsProjectionMatrixForBoxFront	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxFront);
-	theUniformData->itsProjectionMatrixForBoxBack	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxBack );
+	MatrixAntipodalMap(&theAntipodalMap);
+
+	//	A stereo pair's eyes sit on either side of the observer,
+	//	looking straight ahead, so they share the observer's
+	//	projection matrices.  A single view's one eye
+	//	sits at the observer's position.
+	for (theView = 0; theView < itsNumViews; theView++)
+	{
+		theEyeOffset = ((double)theView - 0.5 * (double)(itsNumViews - 1)) * STEREO_EYE_SEPARATION;
+		MakeEyeViewMatrix(&aMatrixSet.itsViewMatrix, md->itsSpaceType, theEyeOffset, &theEyeViewMatrix);
+
+		theUniformData->itsProjectionMatrixForBoxFull [theView]	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxFull );
+		theUniformData->itsProjectionMatrixForBoxFront[theView]	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxFront);
+		theUniformData->itsProjectionMatrixForBoxBack [theView]	= ConvertMatrix44ToSIMD(aMatrixSet.itsProjectionMatrixForBoxBack );
+
+		//	The vertex function composes each tile's matrix with the view matrix,
+		//	so the tiling buffers need contain only the tiles' indices.
+		theViewMatrix = theEyeViewMatrix;
+#ifdef START_OUTSIDE
+		if (md->itsViewpoint != ViewpointIntrinsic)
+		{
+			MatrixTranslation(	&theTranslation,
+								md->itsSpaceType,
+								0.0,
+								0.0,
+								md->itsViewpointTransition * EXTRINSIC_VIEWING_DISTANCE);
+			MatrixProduct(&theViewMatrix, &theTranslation, &theViewMatrix);
+		}
+#endif
+		theUniformData->itsViewMatrix[theView] = ConvertMatrix44ToSIMD(theViewMatrix.m);
+
+		//	Back-hemisphere tiles get the antipodal map as well.
+		MatrixProduct(&theAntipodalMap, &theEyeViewMatrix, &theInvertedViewMatrix);
+		theUniformData->itsInvertedViewMatrix[theView] = ConvertMatrix44ToSIMD(theInvertedViewMatrix.m);
+	}
+
+	//	The vertex function opens the Dirichlet walls' apertures,
+	//	so a change in aperture costs no more than any other uniform.
+	theUniformData->itsAperture = md->itsAperture;
+	switch (md->itsSpaceType)
+	{
+		case SpaceSpherical:	theUniformData->itsCurvature = +1.0;	break;
+		case SpaceFlat:			theUniformData->itsCurvature =  0.0;	break;
+		case SpaceHyperbolic:	theUniformData->itsCurvature = -1.0;	break;
+		case SpaceNone:			theUniformData->itsCurvature =  0.0;	break;
+	}
+
+	//	When the quality governor pulls the horizon in,
+	//	the fog must thicken to match, so that the tiling
+	//	still fades to black just as it ends.
+	theHorizonRadius = EffectiveHorizonRadius(md, someQualitySettings);
 
 	switch (md->itsSpaceType)
 	{
@@ -732,7 +1550,7 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 			//	Better to compute the inverse square once and for all here,
 			//	rather than over and over in the shader, once for each vertex.
 			//
-			theUniformData->itsEucFogInverseSquareSaturationDistance = 1.0 / (md->itsHorizonRadius * md->itsHorizonRadius);
+			theUniformData->itsEucFogInverseSquareSaturationDistance = 1.0 / (theHorizonRadius * theHorizonRadius);
 
 			break;
 		
@@ -752,8 +1570,8 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 				//	they "self-suppress" at large distances).
 				//	We do still need some fog for a depth cue, though,
 				//	so try half-strength fog.
-//				1.0 / log(cosh(md->itsHorizonRadius));
-				0.5 / log(cosh(md->itsHorizonRadius));
+//				1.0 / log(cosh(theHorizonRadius));
+				0.5 / log(cosh(theHorizonRadius));
 
 			break;
 		
@@ -765,32 +1583,29 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 - (void)writeSortedVisibleTilesIntoBufferSet:	(TilingBufferSet *)aTilingBufferSet
 								forImageSize:	(CGSize)anImageSize
 								matrixSet:		(ViewProjectionMatrixSet)aMatrixSet
+									quality:	(const QualitySettings *)someQualitySettings
 								modelData:		(ModelData *)md
 {
 	unsigned int	theRequiredPlainBufferLengthInBytes,
 					theRequiredReflectedBufferLengthInBytes,
 					theRequiredFullBufferLengthInBytes,
 					theRequiredInvertedBufferLengthInBytes;
-	simd_float4x4	*thePlainBufferData,
+	uint32_t		*thePlainBufferData,
 					*theReflectedBufferData,
 					*theFullBufferData,
 					*theInvertedBufferData;
-#ifdef START_OUTSIDE
-	Matrix			theTranslation;
-#endif
 	Honeycell		**theHoneyCellPtr;
-	simd_float4x4	*thePlainMatrix,
-					*theReflectedMatrix,
-					*theFullMatrix;
-	unsigned int	i;
-	Matrix			theTileViewMatrix;
-	simd_float4x4	theTileViewMatrixAsSIMD;
-	Matrix			theAntipodalMap;
-	Honeycell		*theHoneyCell;
-	simd_float4x4	*theInvertedMatrix;
-	Matrix			theInvertedTileMatrix,
-					theInvertedTileViewMatrix;
+	uint32_t		*thePlainIndex,
+					*theReflectedIndex,
+					theCellIndex;
+	bool			theFullBufferFlag;
+	unsigned int	i,
+					theSlot,
+					theLevel;
+	double			theLevelDistances[MAX_NUM_LOD_LEVELS];
+
 
+	BeginFrameInterval(FrameIntervalWriteTiles);
 
 	//	If no honeycomb is present, release all buffers and return.
 	if (md->itsHoneycomb == NULL)
@@ -804,9 +1619,31 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		aTilingBufferSet->itsReflectedFrontToBackTilingBuffer	= nil;
 		aTilingBufferSet->itsFullBackToFrontTilingBuffer		= nil;
 		aTilingBufferSet->itsInvertedTilingBuffer				= nil;
+		aTilingBufferSet->itsCellBuffer							= nil;
+
+		aTilingBufferSet->itsGPUCullingFlag						= false;
+
+		EndFrameInterval(FrameIntervalWriteTiles);
+		return;
+	}
 
+	//	Both the CPU and the GPU culling paths write indices
+	//	into the same GPU-resident list of cells.
+	[self refreshHoneycombCellBufferWithModelData:md];
+	aTilingBufferSet->itsCellBuffer = itsHoneycombCellBuffer;
+
+	//	For a large honeycomb, let the GPU cull and sort the cells itself.
+	if ([self canCullOnGPUWithModelData:md])
+	{
+		[self writeCullingInputsIntoBufferSet:	aTilingBufferSet
+								forImageSize:	anImageSize
+								matrixSet:		aMatrixSet
+									quality:	someQualitySettings
+								modelData:		md];
+		EndFrameInterval(FrameIntervalWriteTiles);
 		return;
 	}
+	aTilingBufferSet->itsGPUCullingFlag = false;
 
 
 	//	Determine which cells are visible relative
@@ -824,28 +1661,33 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		SelectFirstCellOnly(md->itsHoneycomb);
 	else
 #endif
-	CullAndSortVisibleCells(md->itsHoneycomb,
-							&aMatrixSet.itsViewMatrix,
-							anImageSize.width,
-							anImageSize.height,
-							md->itsHorizonRadius,
-							DirichletDomainOutradius(md->itsDirichletDomain),
-							md->itsSpaceType);
+	{
+		BeginFrameInterval(FrameIntervalCullAndSort);
+		CullAndSortVisibleCells(md->itsHoneycomb,
+								&aMatrixSet.itsViewMatrix,
+								anImageSize.width,
+								anImageSize.height,
+								itsNumViews > 1 ? STEREO_EYE_SEPARATION : 0.0,
+								EffectiveHorizonRadius(md, someQualitySettings),
+								DirichletDomainOutradius(md->itsDirichletDomain),
+								md->itsSpaceType);
+		EndFrameInterval(FrameIntervalCullAndSort);
+	}
 
 	//	There should always be a cell containing the origin,
 	//	and it should be visible.  Nevertheless the code below
 	//	allows for the case that no cells are visible, in which case
 	//	it either lets [itsDevice -newBufferWithLength:0 options:…] return nil,
-	//	or it writes 0 matrices into a pre-existing buffer.
+	//	or it writes 0 indices into a pre-existing buffer.
 	aTilingBufferSet->itsNumPlainTiles		= md->itsHoneycomb->itsNumVisiblePlainCells;
 	aTilingBufferSet->itsNumReflectedTiles	= md->itsHoneycomb->itsNumVisibleReflectedCells;
 	aTilingBufferSet->itsTotalNumTiles		= md->itsHoneycomb->itsNumVisibleCells;
 	aTilingBufferSet->itsNumInvertedTiles	= (md->itsDrawBackHemisphere ? md->itsHoneycomb->itsNumCells : 0);
 
-	//	Make sure each buffer is big enough to hold the required number of matrices.
+	//	Make sure each buffer is big enough to hold the required number of indices.
 	//	If it isn't, replace it with a buffer that's 125% the new required size.
 	//	The reason for the factor of 125% is to avoid replacing a buffer over and over,
-	//	adding only one or two more matrices each time.
+	//	adding only one or two more indices each time.
 	//
 	//		Note #1:
 	//			[itsDevice newBufferWithLength:0 options:…] refuses to create
@@ -855,28 +1697,46 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	//			[nil length] returns 0 (and is officially documented to do so),
 	//			so the following code works as intended.
 	//
+	//		Note #3:
+	//			A buffer left over from GPU culling lives in private storage,
+	//			where the CPU can't write to it, so replace it too.
+	//
+	//		Note #4:
+	//			With ORDER_INDEPENDENT_TRANSPARENCY, only the front hemisphere
+	//			of a space with no antipodal symmetry reads the full
+	//			back-to-front buffer, so otherwise leave it alone.
+	//
 
-	theRequiredPlainBufferLengthInBytes		= aTilingBufferSet->itsNumPlainTiles     * sizeof(simd_float4x4);
-	theRequiredReflectedBufferLengthInBytes	= aTilingBufferSet->itsNumReflectedTiles * sizeof(simd_float4x4);
-	theRequiredFullBufferLengthInBytes		= aTilingBufferSet->itsTotalNumTiles     * sizeof(simd_float4x4);
-	theRequiredInvertedBufferLengthInBytes	= aTilingBufferSet->itsNumInvertedTiles  * sizeof(simd_float4x4);
+	theFullBufferFlag = ( ! ORDER_INDEPENDENT_TRANSPARENCY || md->itsDrawBackHemisphere );
 
-	if ([aTilingBufferSet->itsPlainFrontToBackTilingBuffer length] < theRequiredPlainBufferLengthInBytes)
+	theRequiredPlainBufferLengthInBytes		= aTilingBufferSet->itsNumPlainTiles     * sizeof(uint32_t);
+	theRequiredReflectedBufferLengthInBytes	= aTilingBufferSet->itsNumReflectedTiles * sizeof(uint32_t);
+	theRequiredFullBufferLengthInBytes		= aTilingBufferSet->itsTotalNumTiles     * sizeof(uint32_t);
+	theRequiredInvertedBufferLengthInBytes	= aTilingBufferSet->itsNumInvertedTiles  * sizeof(uint32_t);
+
+	if ([aTilingBufferSet->itsPlainFrontToBackTilingBuffer length] < theRequiredPlainBufferLengthInBytes
+	 || [aTilingBufferSet->itsPlainFrontToBackTilingBuffer storageMode] != MTLStorageModeShared)
 	{
+		itsFrameCounters.itsNumBufferReallocations++;
 		aTilingBufferSet->itsPlainFrontToBackTilingBuffer = [itsDevice
 			newBufferWithLength:	(unsigned int)(1.25 * theRequiredPlainBufferLengthInBytes)
 			options:				MTLResourceStorageModeShared];
 	}
 
-	if ([aTilingBufferSet->itsReflectedFrontToBackTilingBuffer length] < theRequiredReflectedBufferLengthInBytes)
+	if ([aTilingBufferSet->itsReflectedFrontToBackTilingBuffer length] < theRequiredReflectedBufferLengthInBytes
+	 || [aTilingBufferSet->itsReflectedFrontToBackTilingBuffer storageMode] != MTLStorageModeShared)
 	{
+		itsFrameCounters.itsNumBufferReallocations++;
 		aTilingBufferSet->itsReflectedFrontToBackTilingBuffer = [itsDevice
 			newBufferWithLength:	(unsigned int)(1.25 * theRequiredReflectedBufferLengthInBytes)
 			options:				MTLResourceStorageModeShared];
 	}
 
-	if ([aTilingBufferSet->itsFullBackToFrontTilingBuffer length] < theRequiredFullBufferLengthInBytes)
+	if (theFullBufferFlag
+	 && ([aTilingBufferSet->itsFullBackToFrontTilingBuffer length] < theRequiredFullBufferLengthInBytes
+	  || [aTilingBufferSet->itsFullBackToFrontTilingBuffer storageMode] != MTLStorageModeShared))
 	{
+		itsFrameCounters.itsNumBufferReallocations++;
 		aTilingBufferSet->itsFullBackToFrontTilingBuffer = [itsDevice
 			newBufferWithLength:	(unsigned int)(1.25 * theRequiredFullBufferLengthInBytes)
 			options:				MTLResourceStorageModeShared];
@@ -884,149 +1744,420 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 
 	if ([aTilingBufferSet->itsInvertedTilingBuffer length] < theRequiredInvertedBufferLengthInBytes)
 	{
+		itsFrameCounters.itsNumBufferReallocations++;
 		aTilingBufferSet->itsInvertedTilingBuffer = [itsDevice
 			newBufferWithLength:	(unsigned int)(1.25 * theRequiredInvertedBufferLengthInBytes)
 			options:				MTLResourceStorageModeShared];
 	}
 
-	thePlainBufferData		= (simd_float4x4 *) [aTilingBufferSet->itsPlainFrontToBackTilingBuffer     contents];
-	theReflectedBufferData	= (simd_float4x4 *) [aTilingBufferSet->itsReflectedFrontToBackTilingBuffer contents];
-	theFullBufferData		= (simd_float4x4 *) [aTilingBufferSet->itsFullBackToFrontTilingBuffer      contents];
-	theInvertedBufferData	= (simd_float4x4 *) [aTilingBufferSet->itsInvertedTilingBuffer             contents];
-
-#ifdef START_OUTSIDE
-	if (md->itsViewpoint != ViewpointIntrinsic)
-	{
-		MatrixTranslation(	&theTranslation,
-							md->itsSpaceType,
-							0.0,
-							0.0,
-							md->itsViewpointTransition * EXTRINSIC_VIEWING_DISTANCE);
-	}
-#endif
+	thePlainBufferData		= (uint32_t *) [aTilingBufferSet->itsPlainFrontToBackTilingBuffer     contents];
+	theReflectedBufferData	= (uint32_t *) [aTilingBufferSet->itsReflectedFrontToBackTilingBuffer contents];
+	theFullBufferData		= (theFullBufferFlag ? (uint32_t *) [aTilingBufferSet->itsFullBackToFrontTilingBuffer contents] : NULL);
+	theInvertedBufferData	= (uint32_t *) [aTilingBufferSet->itsInvertedTilingBuffer             contents];
 
-	//	Copy the visible tiles' tiling matrices into the various buffers.
+	//	Copy the visible tiles' indices into the various buffers.
+	//	The vertex function looks up each tile's matrix in itsCellBuffer
+	//	and applies the view matrix itself, so the per-frame upload
+	//	is only 4 bytes per visible tile.
 	theHoneyCellPtr		= md->itsHoneycomb->itsVisibleCells;						//	source
-	thePlainMatrix		= thePlainBufferData;										//	destination
-	theReflectedMatrix	= theReflectedBufferData;									//	destination
-	theFullMatrix		= theFullBufferData + md->itsHoneycomb->itsNumVisibleCells;	//	destination, but writing in reverse order
+	thePlainIndex		= thePlainBufferData;										//	destination
+	theReflectedIndex	= theReflectedBufferData;									//	destination
 	for (i = 0; i < md->itsHoneycomb->itsNumVisibleCells; i++)
 	{
-		//	Compose each tiling matrix with the view matrix now,
-		//	so the vertex shader doesn't have to multiply
-		//	by the view matrix over and over, for each vertex.
-		MatrixProduct(	&(*theHoneyCellPtr)->itsMatrix,
-						&aMatrixSet.itsViewMatrix,
-						&theTileViewMatrix);
-#ifdef START_OUTSIDE
-		if (md->itsViewpoint != ViewpointIntrinsic)
-			MatrixProduct(&theTileViewMatrix, &theTranslation, &theTileViewMatrix);
-#endif
-		theTileViewMatrixAsSIMD = ConvertMatrix44ToSIMD(theTileViewMatrix.m);
+		theCellIndex = (uint32_t)(*theHoneyCellPtr - md->itsHoneycomb->itsCells);
 
-		//	Write the tile-view matrix to either the plain buffer or the reflected buffer, as appropriate.
-		if (theTileViewMatrix.itsParity == ImagePositive)
+		//	Write the index to either the plain buffer or the reflected buffer, as appropriate.
+		//	The tile-view matrix is plain iff the tiling matrix
+		//	and the view matrix have the same parity.
+		if ((*theHoneyCellPtr)->itsMatrix.itsParity == aMatrixSet.itsViewMatrix.itsParity)
 		{
-			GEOMETRY_GAMES_ASSERT(thePlainMatrix != NULL,     "'impossible' NULL pointer (thePlainMatrix)");		//	suppress static analyzer warning
-			*thePlainMatrix++		= theTileViewMatrixAsSIMD;
+			GEOMETRY_GAMES_ASSERT(thePlainIndex != NULL,     "'impossible' NULL pointer (thePlainIndex)");		//	suppress static analyzer warning
+			*thePlainIndex++		= theCellIndex;
 		}
 		else
 		{
-			GEOMETRY_GAMES_ASSERT(theReflectedMatrix != NULL, "'impossible' NULL pointer (theReflectedMatrix)");	//	suppress static analyzer warning
-			*theReflectedMatrix++	= theTileViewMatrixAsSIMD;
+			GEOMETRY_GAMES_ASSERT(theReflectedIndex != NULL, "'impossible' NULL pointer (theReflectedIndex)");	//	suppress static analyzer warning
+			*theReflectedIndex++	= theCellIndex;
 		}
 
-		//	Write the same matrix to the full back-to-front buffer as well.
-		GEOMETRY_GAMES_ASSERT(theFullMatrix != NULL, "'impossible' NULL pointer (theFullMatrix)");	//	suppress static analyzer warning
-		*--theFullMatrix = theTileViewMatrixAsSIMD;
-		
 		//	Advance to the next HoneyCell pointer.
 		theHoneyCellPtr++;
 	}
 	GEOMETRY_GAMES_ASSERT(
-			thePlainMatrix		== thePlainBufferData     + aTilingBufferSet->itsNumPlainTiles
-		 && theReflectedMatrix	== theReflectedBufferData + aTilingBufferSet->itsNumReflectedTiles
-		 && theFullMatrix		== theFullBufferData      + 0,
-		"Wrote unexpected number of visible-tile matrices in -writeSortedVisibleTilesIntoBufferSet:...");
-	
-	//	If the space is an odd-order lens space or the 3-sphere itself,
-	//	then compose the matrices for back-hemisphere rendering with the antipodal and view matrices,
-	//	and write them into the inverted-matrix buffer.
-	//
-	//		Warning:  This code does not culling or sorting.
-	//		For these small symmetry groups, the simplicity of the code
+			thePlainIndex		== thePlainBufferData     + aTilingBufferSet->itsNumPlainTiles
+		 && theReflectedIndex	== theReflectedBufferData + aTilingBufferSet->itsNumReflectedTiles,
+		"Wrote unexpected number of visible-tile indices in -writeSortedVisibleTilesIntoBufferSet:...");
+
+	//	The full buffer lists the same tiles back to front,
+	//	for the transparent pass.  In a spherical space
+	//	that's not simply the reverse of the near-to-far order,
+	//	which treats distances d and π - d alike.
+	if (theFullBufferFlag)
+	{
+		GEOMETRY_GAMES_ASSERT(theFullBufferData != NULL || md->itsHoneycomb->itsNumVisibleCells == 0,
+			"'impossible' NULL pointer (theFullBufferData)");	//	suppress static analyzer warning
+		ListVisibleCellsBackToFront(md->itsHoneycomb,
+									&aMatrixSet.itsViewMatrix,
+									md->itsSpaceType,
+									theFullBufferData);
+	}
+
+	//	The tiles are sorted near to far, so each mesh's levels-of-detail
+	//	occupy consecutive runs of them, and each coarser level
+	//	takes over at the distance where it looks good enough.
+	for (theSlot = 0; theSlot < NumMeshSlots; theSlot++)
+	{
+		GetLevelOfDetailDistances(	[self meshSetForSlot:theSlot],
+									anImageSize,
+									md->itsSpaceType,
+									someQualitySettings->itsLevelOfDetailBias,
+									theLevelDistances);
+
+		for (theLevel = 0; theLevel <= MAX_NUM_LOD_LEVELS; theLevel++)
+		{
+			if (theLevel == 0)
+			{
+				aTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel]		= 0;
+				aTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel]	= 0;
+			}
+			else
+			if (theLevel < MAX_NUM_LOD_LEVELS
+			 && theLevelDistances[theLevel] < HUGE_VAL)
+			{
+				CountVisibleCellsNearerThan(md->itsHoneycomb,
+											theLevelDistances[theLevel],
+											md->itsSpaceType,
+											aMatrixSet.itsViewMatrix.itsParity,
+											&aTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel],
+											&aTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel]);
+			}
+			else	//	The remaining tiles all get the coarsest level present.
+			{
+				aTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel]		= aTilingBufferSet->itsNumPlainTiles;
+				aTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel]	= aTilingBufferSet->itsNumReflectedTiles;
+			}
+		}
+	}
+	
+	//	If the space is an odd-order lens space or the 3-sphere itself,
+	//	then list all the cells for back-hemisphere rendering.
+	//	The vertex function composes their tiling matrices
+	//	with the antipodal and view matrices.
+	//
+	//		Warning:  This code does not culling or sorting.
+	//		For these small symmetry groups, the simplicity of the code
 	//		is more important than the run-time performance.
 	//		The main drawback is that partially transparent content
 	//		may get rendered incorrectly.
 	//
 	if (md->itsDrawBackHemisphere)
 	{
-		MatrixAntipodalMap(&theAntipodalMap);
-		
-		theHoneyCell 		= md->itsHoneycomb->itsCells;	//	source;  all the cells, not just itsVisibleCells
-		theInvertedMatrix	= theInvertedBufferData;		//	destination
 		for (i = 0; i < md->itsHoneycomb->itsNumCells; i++)
+			theInvertedBufferData[i] = i;
+	}
+
+	EndFrameInterval(FrameIntervalWriteTiles);
+}
+
+
+- (void)refreshHoneycombCellBufferWithModelData:(ModelData *)md
+{
+	unsigned int			theNumCells,
+							i;
+	CurvedSpacesCellData	*theCellData;
+	Honeycell				*theHoneycell;
+
+	theNumCells = md->itsHoneycomb->itsNumCells;
+
+	//	Copy the cells' tiling matrices and centers to the GPU
+	//	only when the honeycomb changes.  Create a new buffer
+	//	rather than rewriting the old one, which a frame
+	//	still in flight may be using.  The new buffer lives
+	//	in private storage, so write the cells into a shared
+	//	staging buffer, which -encodeCommandsToCommandBuffer:…
+	//	will copy into the private buffer before the first frame
+	//	that uses it.
+	if (md->itsHoneycombBufferNeedsRefresh
+	 || [itsHoneycombCellBuffer length] != theNumCells * sizeof(CurvedSpacesCellData))
+	{
+		itsHoneycombCellStagingBuffer = [itsDevice
+			newBufferWithLength:	theNumCells * sizeof(CurvedSpacesCellData)
+			options:				MTLResourceStorageModeShared];
+		itsHoneycombCellBuffer = [itsDevice
+			newBufferWithLength:	theNumCells * sizeof(CurvedSpacesCellData)
+			options:				MTLResourceStorageModePrivate];
+
+		theCellData		= (CurvedSpacesCellData *) [itsHoneycombCellStagingBuffer contents];
+		theHoneycell	= md->itsHoneycomb->itsCells;
+		for (i = 0; i < theNumCells; i++)
 		{
-			MatrixProduct(	&theHoneyCell->itsMatrix,
-							&theAntipodalMap,
-							&theInvertedTileMatrix);
+			theCellData[i].itsTilingMatrix	= ConvertMatrix44ToSIMD(theHoneycell->itsMatrix.m);
+			theCellData[i].itsCellCenter	= simd_make_float4(	theHoneycell->itsCellCenterInWorldSpace.v[0],
+																theHoneycell->itsCellCenterInWorldSpace.v[1],
+																theHoneycell->itsCellCenterInWorldSpace.v[2],
+																theHoneycell->itsCellCenterInWorldSpace.v[3]);
+			theCellData[i].itsParity		= theHoneycell->itsMatrix.itsParity;
+
+			theHoneycell++;
+		}
+
+		md->itsHoneycombBufferNeedsRefresh = false;
+	}
+}
 
-			MatrixProduct(	&theInvertedTileMatrix,
-							&aMatrixSet.itsViewMatrix,
-							&theInvertedTileViewMatrix);
 
-			*theInvertedMatrix++ = ConvertMatrix44ToSIMD(theInvertedTileViewMatrix.m);
-			
-			theHoneyCell++;
+- (bool)canCullOnGPUWithModelData:(ModelData *)md
+{
+	//	The GPU handles only the typical case.  Spherical spaces
+	//	(which have small symmetry groups anyhow) and the extrinsic viewpoint
+	//	stay with -writeSortedVisibleTilesIntoBufferSet:… .
+
+	if ( ! itsGPUCullingIsAvailable )
+		return false;
+
+	if (md->itsHoneycomb == NULL
+	 || md->itsHoneycomb->itsNumCells < MIN_NUM_CELLS_FOR_GPU_CULLING)
+		return false;
+
+	if (md->itsDrawBackHemisphere)
+		return false;
+
+	//	The GPU sorts a spherical space's cells near to far
+	//	by the distance to the nearer of each cell and its antipodal point,
+	//	so its back-to-front list would composite transparent cells
+	//	in the wrong order.
+	if (md->itsSpaceType == SpaceSpherical)
+		return false;
+
+#ifdef START_OUTSIDE
+	if (md->itsViewpoint != ViewpointIntrinsic)
+		return false;
+#endif
+
+	return true;
+}
+
+- (void)writeCullingInputsIntoBufferSet:	(TilingBufferSet *)aTilingBufferSet
+							forImageSize:	(CGSize)anImageSize
+							matrixSet:		(ViewProjectionMatrixSet)aMatrixSet
+								quality:	(const QualitySettings *)someQualitySettings
+							modelData:		(ModelData *)md
+{
+	unsigned int				theNumCells,
+								theSortSize,
+								i,
+								theSlot,
+								theLevel;
+	NSUInteger					theRequiredTileBufferLengthInBytes;
+	CurvedSpacesCullUniformData	*theCullUniformData;
+	double						theEyeSeparation,
+								theCullingPlanes[4][4],
+								theDirichletDomainOutradius,
+								theLevelDistances[MAX_NUM_LOD_LEVELS];
+
+	theNumCells = md->itsHoneycomb->itsNumCells;
+
+	//	The bitonic sort wants a power of two.
+	theSortSize = 1;
+	while (theSortSize < theNumCells)
+		theSortSize *= 2;
+
+	//	The CPU won't know how many tiles are visible.
+	aTilingBufferSet->itsNumPlainTiles		= 0;
+	aTilingBufferSet->itsNumReflectedTiles	= 0;
+	aTilingBufferSet->itsTotalNumTiles		= 0;
+	aTilingBufferSet->itsNumInvertedTiles	= 0;
+
+	aTilingBufferSet->itsGPUCullingFlag	= true;
+	aTilingBufferSet->itsNumCells		= theNumCells;
+	aTilingBufferSet->itsSortSize		= theSortSize;
+
+	//	Make sure each buffer is big enough, as in -writeSortedVisibleTilesIntoBufferSet:… ,
+	//	except that the GPU may write as many tiles as there are cells.
+	//	Only the GPU writes the tiling buffers, so they may live in private storage.
+
+	if (aTilingBufferSet->itsCullUniformBuffer == nil)
+	{
+		aTilingBufferSet->itsCullUniformBuffer = [itsDevice
+			newBufferWithLength:	sizeof(CurvedSpacesCullUniformData)
+			options:				MTLResourceStorageModeShared];
+	}
+
+	if (aTilingBufferSet->itsCullResultBuffer == nil)
+	{
+		aTilingBufferSet->itsCullResultBuffer = [itsDevice
+			newBufferWithLength:	sizeof(CurvedSpacesCullResultData)
+			options:				MTLResourceStorageModePrivate];
+	}
+
+	if ([aTilingBufferSet->itsSortEntryBuffer length] < theSortSize * sizeof(simd_uint2))
+	{
+		aTilingBufferSet->itsSortEntryBuffer = [itsDevice
+			newBufferWithLength:	theSortSize * sizeof(simd_uint2)
+			options:				MTLResourceStorageModePrivate];
+	}
+
+	theRequiredTileBufferLengthInBytes = theNumCells * sizeof(uint32_t);
+
+	if ([aTilingBufferSet->itsPlainFrontToBackTilingBuffer length] < theRequiredTileBufferLengthInBytes
+	 || [aTilingBufferSet->itsPlainFrontToBackTilingBuffer storageMode] != MTLStorageModePrivate)
+	{
+		itsFrameCounters.itsNumBufferReallocations++;
+		aTilingBufferSet->itsPlainFrontToBackTilingBuffer = [itsDevice
+			newBufferWithLength:	(unsigned int)(1.25 * theRequiredTileBufferLengthInBytes)
+			options:				MTLResourceStorageModePrivate];
+	}
+
+	if ([aTilingBufferSet->itsReflectedFrontToBackTilingBuffer length] < theRequiredTileBufferLengthInBytes
+	 || [aTilingBufferSet->itsReflectedFrontToBackTilingBuffer storageMode] != MTLStorageModePrivate)
+	{
+		itsFrameCounters.itsNumBufferReallocations++;
+		aTilingBufferSet->itsReflectedFrontToBackTilingBuffer = [itsDevice
+			newBufferWithLength:	(unsigned int)(1.25 * theRequiredTileBufferLengthInBytes)
+			options:				MTLResourceStorageModePrivate];
+	}
+
+	//	The GPU never culls a space that needs its back hemisphere drawn,
+	//	so with ORDER_INDEPENDENT_TRANSPARENCY nothing reads the full buffer.
+	//	CurvedSpacesCullScatterFunction still takes the full buffer
+	//	as an argument, though, and Metal's API validation rejects
+	//	a nil buffer for it, so bind a placeholder, which the kernel
+	//	never writes to when itsWriteFullTiles is false.
+	if (ORDER_INDEPENDENT_TRANSPARENCY)
+	{
+		if (aTilingBufferSet->itsFullBackToFrontTilingBuffer == nil)
+		{
+			aTilingBufferSet->itsFullBackToFrontTilingBuffer = [itsDevice
+				newBufferWithLength:	sizeof(uint32_t)
+				options:				MTLResourceStorageModePrivate];
 		}
-		GEOMETRY_GAMES_ASSERT(
-			theInvertedMatrix == theInvertedBufferData + aTilingBufferSet->itsNumInvertedTiles,
-			"Wrote unexpected number of inverted back-hemisphere matrices in -writeSortedVisibleTilesIntoBufferSet:...");
+	}
+	else
+	if ([aTilingBufferSet->itsFullBackToFrontTilingBuffer length] < theRequiredTileBufferLengthInBytes
+	 || [aTilingBufferSet->itsFullBackToFrontTilingBuffer storageMode] != MTLStorageModePrivate)
+	{
+		itsFrameCounters.itsNumBufferReallocations++;
+		aTilingBufferSet->itsFullBackToFrontTilingBuffer = [itsDevice
+			newBufferWithLength:	(unsigned int)(1.25 * theRequiredTileBufferLengthInBytes)
+			options:				MTLResourceStorageModePrivate];
+	}
+
+	//	Pass the same culling parameters that CullAndSortVisibleCells() uses.
+
+	theCullUniformData = (CurvedSpacesCullUniformData *) [aTilingBufferSet->itsCullUniformBuffer contents];
+
+	theCullUniformData->itsViewMatrix = ConvertMatrix44ToSIMD(aMatrixSet.itsViewMatrix.m);
+
+	//	A stereo pair culls once, to the union of its eyes' frusta.
+	theEyeSeparation = (itsNumViews > 1 ? STEREO_EYE_SEPARATION : 0.0);
+	MakeCullingHyperplanes(anImageSize.width, anImageSize.height, theEyeSeparation, md->itsSpaceType, theCullingPlanes);
+	for (i = 0; i < 4; i++)
+	{
+		theCullUniformData->itsCullingPlanes[i] = simd_make_float4(	theCullingPlanes[i][0],
+																	theCullingPlanes[i][1],
+																	theCullingPlanes[i][2],
+																	theCullingPlanes[i][3]);
+	}
+
+	theDirichletDomainOutradius = DirichletDomainOutradius(md->itsDirichletDomain);
+	theCullUniformData->itsAdjustedDirichletDomainRadius	= AdjustedDirichletDomainRadius(theDirichletDomainOutradius, md->itsSpaceType);
+	theCullUniformData->itsTilingRadius						= EffectiveHorizonRadius(md, someQualitySettings) + theDirichletDomainOutradius + 0.5 * theEyeSeparation;
+
+	theCullUniformData->itsNumCells						= theNumCells;
+	theCullUniformData->itsSortSize						= theSortSize;
+	theCullUniformData->itsViewParity					= aMatrixSet.itsViewMatrix.itsParity;
+	theCullUniformData->itsAcceptAllCells				= (md->itsSpaceType == SpaceSpherical);
+	theCullUniformData->itsNumBlendedInstancesToOmit	= NUM_BLENDED_INSTANCES_TO_OMIT;
+	theCullUniformData->itsNumViews						= itsNumViews;
+	theCullUniformData->itsWriteFullTiles				= ! ORDER_INDEPENDENT_TRANSPARENCY;
+
+	//	Pass each mesh's index counts, along with the distances
+	//	at which its coarser levels-of-detail take over,
+	//	as in -writeSortedVisibleTilesIntoBufferSet:… .
+	//	HUGE_VAL converts to an infinite float, which the GPU
+	//	understands to mean "never".
+	for (theSlot = 0; theSlot < NumMeshSlots; theSlot++)
+	{
+		WriteMeshSetIndexCounts([self meshSetForSlot:theSlot], theCullUniformData->itsIndexCounts[theSlot]);
+
+		GetLevelOfDetailDistances(	[self meshSetForSlot:theSlot],
+									anImageSize,
+									md->itsSpaceType,
+									someQualitySettings->itsLevelOfDetailBias,
+									theLevelDistances);
+		for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+			theCullUniformData->itsLevelDistances[theSlot][theLevel] = (float) theLevelDistances[theLevel];
 	}
 }
 
 
 - (void)updateMeshesAndTexturesAsNeededUsingModelData:(ModelData *)md
 {
-	MTKTextureLoader							*theTextureLoader;
-	NSDictionary<MTKTextureLoaderOption, id>	*theTextureLoaderOptions;
-	NSError										*theError = nil;
-
 	if (md->itsDirichletWallsMeshNeedsRefresh)
 	{
+		BeginFrameInterval(FrameIntervalRewriteMeshes);
 		RefreshDirichletWalls(itsDirichletWallsMeshSet, itsDevice, md);
 		md->itsDirichletWallsMeshNeedsRefresh = false;
+		EndFrameInterval(FrameIntervalRewriteMeshes);
 	}
 
 	if (itsCenterpieceType != md->itsCenterpieceType)
 	{
-		theTextureLoader		= [[MTKTextureLoader alloc] initWithDevice:itsDevice];
-		theTextureLoaderOptions	=
-		@{
-			MTKTextureLoaderOptionTextureUsage			:	@(MTLTextureUsageShaderRead),
-			MTKTextureLoaderOptionTextureStorageMode	:	@(MTLStorageModePrivate),
-			MTKTextureLoaderOptionAllocateMipmaps		:	@(YES),
-			MTKTextureLoaderOptionGenerateMipmaps		:	@(YES)	//	-newTextureWithName:… ignores this option
-																	//		(as confirmed in its documentation).
-																	//	Instead, the Asset Catalog provides the mipmaps.
-		};
+		BeginFrameInterval(FrameIntervalRewriteMeshes);
 
 		itsCenterpieceType				= md->itsCenterpieceType;
-		itsUnrotatedCenterpieceMeshSet	= MakeCenterpieceMeshSet(md->itsCenterpieceType, itsDevice);
-		itsCenterpieceTexture			= [self
-											loadTextureForCenterpiece:	md->itsCenterpieceType
-											textureLoader:				theTextureLoader
-											textureLoaderOptions:		theTextureLoaderOptions
-											error:						&theError];
+		itsCenterpieceMeshSet			= [self sharedCenterpieceMeshSet:md->itsCenterpieceType];
+		itsCenterpieceTexture			= [self sharedCenterpieceTexture:md->itsCenterpieceType];
+
+		EndFrameInterval(FrameIntervalRewriteMeshes);
 	}
 
 	if (md->itsVertexFigureMeshNeedsReplacement)
 	{
+		BeginFrameInterval(FrameIntervalRewriteMeshes);
 		itsVertexFigureMeshSet = MakeVertexFigureMeshSet(itsDevice, md);
 		md->itsVertexFigureMeshNeedsReplacement = false;
+		EndFrameInterval(FrameIntervalRewriteMeshes);
 	}
 }
 
+- (id<MTLTexture>)sharedTextureNamed:(NSString *)aTextureName
+{
+	return [itsResourceCache
+		resourceForKey:	[@"texture " stringByAppendingString:aTextureName]
+		creator:		^id{
+							MTKTextureLoader	*theTextureLoader;
+							NSError				*theError = nil;
+
+							theTextureLoader = [[MTKTextureLoader alloc] initWithDevice:self->itsDevice];
+
+							return [theTextureLoader
+										newTextureWithName:aTextureName
+										scaleFactor:1.0
+										bundle:nil
+										options:MakeTextureLoaderOptions()
+										error:&theError];
+						}];
+}
+
+- (id<MTLTexture>)sharedCenterpieceTexture:(CenterpieceType)aCenterpieceType
+{
+	return [itsResourceCache
+		resourceForKey:	[NSString stringWithFormat:@"centerpiece texture %d", aCenterpieceType]
+		creator:		^id{
+							MTKTextureLoader	*theTextureLoader;
+							NSError				*theError = nil;
+
+							theTextureLoader = [[MTKTextureLoader alloc] initWithDevice:self->itsDevice];
+
+							return [self
+										loadTextureForCenterpiece:	aCenterpieceType
+										textureLoader:				theTextureLoader
+										textureLoaderOptions:		MakeTextureLoaderOptions()
+										error:						&theError];
+						}];
+}
+
 - (id<MTLTexture>)loadTextureForCenterpiece:(CenterpieceType)aCenterpieceType
 	textureLoader:aTextureLoader textureLoaderOptions:someTextureLoaderOptions error:(NSError **)anError
 {
@@ -1098,23 +2229,103 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 {
 	id<MTLBuffer>				theUniformBuffer;
 	TilingBufferSet				*theTilingBufferSet;
-	MeshSet						*theCenterpieceMeshSet,
-								*theObserverMeshSet;
+	Matrix						theIdentityPlacement,
+								theCenterpiecePlacement;
+	id<MTLBlitCommandEncoder>	theBlitEncoder;
+	bool						theDrawTilingFlag;
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	bool						theTransparencyFlag;
+#endif
+	NSNumber					*theRenderScale;
+	MTLRenderPassDescriptor		*theScenePassDescriptor,
+								*theRenderPassDescriptor;
 	id<MTLRenderCommandEncoder>	theRenderEncoder;
 
+	BeginFrameInterval(FrameIntervalEncodeCommands);
+
+	//	The pipeline states draw itsNumViews views,
+	//	so the render target must provide one slice for each.
+	GEOMETRY_GAMES_ASSERT(
+		MAX([aRenderPassDescriptor renderTargetArrayLength], 1) == itsNumViews,
+		"a stereo pair needs -makeStereoRenderPassDescriptorForImageSize:modelData:");
+
 	//	Unpack the dictionary of inflight data buffers.
-	theUniformBuffer		= [someInflightDataBuffers objectForKey:@"uniform buffer"				];
-	theTilingBufferSet		= [someInflightDataBuffers objectForKey:@"tiling buffer set"			];
-	theCenterpieceMeshSet	= [someInflightDataBuffers objectForKey:@"rotated centerpiece mesh set"	];
-	theObserverMeshSet		= [someInflightDataBuffers objectForKey:@"transformed observer mesh set"];
+	theUniformBuffer		= [someInflightDataBuffers objectForKey:@"uniform buffer"	];
+	theTilingBufferSet		= [someInflightDataBuffers objectForKey:@"tiling buffer set"];
+	theRenderScale			= [someInflightDataBuffers objectForKey:@"render scale"		];	//	nil at full scale
+
+	//	Report an on-screen frame's GPU time once it's known.
+	if ([someInflightDataBuffers objectForKey:@"frame statistics"] != nil)
+	{
+		[aCommandBuffer addCompletedHandler:^(id<MTLCommandBuffer> aCompletedCommandBuffer)
+		{
+			RecordFrameGPUTime([aCompletedCommandBuffer GPUStartTime], [aCompletedCommandBuffer GPUEndTime]);
+		}];
+	}
+
+	//	The Dirichlet walls and vertex figures sit still within each cell,
+	//	while the observer and the centerpiece move.
+	MatrixIdentity(&theIdentityPlacement);
+	[self getCenterpiecePlacement:&theCenterpiecePlacement modelData:md];
+
+	//	If the honeycomb has changed, copy it into private storage
+	//	before anything reads it.  (The shared meshes arrive
+	//	from itsResourceCache already in private storage.)
+	if (itsHoneycombCellStagingBuffer != nil)
+	{
+		theBlitEncoder = [aCommandBuffer blitCommandEncoder];
+
+		[theBlitEncoder
+			copyFromBuffer:		itsHoneycombCellStagingBuffer
+			sourceOffset:		0
+			toBuffer:			itsHoneycombCellBuffer
+			destinationOffset:	0
+			size:				[itsHoneycombCellStagingBuffer length]];
+
+		itsHoneycombCellStagingBuffer = nil;
+
+		[theBlitEncoder endEncoding];
+	}
+
+	//	If the GPU is to cull the honeycomb, let it do so
+	//	before the render pass begins.
+	if (theTilingBufferSet->itsGPUCullingFlag)
+		[self encodeCullingCommandsToCommandBuffer:aCommandBuffer tiling:theTilingBufferSet];
+
+	//	Draw a tiling only if itsTotalNumTiles > 0
+	//	(or if the GPU will decide how many tiles to draw).
+	theDrawTilingFlag = ((theTilingBufferSet->itsTotalNumTiles > 0
+						|| theTilingBufferSet->itsGPUCullingFlag)
+					   && theTilingBufferSet->itsCellBuffer != nil);
+
+	//	At a reduced render scale, draw the scene into
+	//	the reduced-scale textures instead of the drawable.
+	if (theRenderScale != nil)
+	{
+		theScenePassDescriptor = [self makeScaledRenderPassDescriptorFor:	aRenderPassDescriptor
+															renderScale:	[theRenderScale doubleValue]];
+	}
+	else
+		theScenePassDescriptor = aRenderPassDescriptor;
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	//	-encodeFullSphereWithEncoder:… never draws the galaxy.
+	theTransparencyFlag = (theDrawTilingFlag
+						&& itsCenterpieceType == CenterpieceGalaxy
+						&& md->itsSpaceType != SpaceNone
+						&& ! md->itsDrawBackHemisphere);
+	theRenderPassDescriptor = [self addTransparencyAttachmentsToRenderPassDescriptor:	theScenePassDescriptor
+																	drawTransparency:	theTransparencyFlag];
+#else
+	theRenderPassDescriptor = theScenePassDescriptor;
+#endif
 
 	//	Create a MTLRenderCommandEncoder no matter what,
 	//	to ensure that the framebuffer gets cleared to the background color,
-	//	but then...
-	theRenderEncoder = [aCommandBuffer renderCommandEncoderWithDescriptor:aRenderPassDescriptor];
+	//	but then draw the tiling only if theDrawTilingFlag is set.
+	theRenderEncoder = [aCommandBuffer renderCommandEncoderWithDescriptor:theRenderPassDescriptor];
 
-	//	...draw a tiling only if itsTotalNumTiles > 0.
-	if (theTilingBufferSet->itsTotalNumTiles > 0)
+	if (theDrawTilingFlag)
 	{
 		[theRenderEncoder setDepthStencilState:itsDepthStencilState];
 
@@ -1122,20 +2333,30 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 							offset:0
 							atIndex:BufferIndexUniforms];
 
+		[theRenderEncoder setVertexBuffer:theTilingBufferSet->itsCellBuffer
+							offset:0
+							atIndex:BufferIndexHoneycombCells];
+
 		[theRenderEncoder setFragmentSamplerState:itsAnisotropicTextureSampler
 							atIndex:SamplerIndexPrimary];
 
-		//	Dirichlet domain
-		[theRenderEncoder
-			setFragmentTexture:	(md->itsShowColorCoding ? itsPaperWallTexture : itsWoodWallTexture)
-			atIndex:			TextureIndexPrimary];
-		[self encodeMeshWithEncoder:	theRenderEncoder
-							meshSet:	itsDirichletWallsMeshSet	//	always non-nil, but will be empty if no Dirichlet domain is visible
-							 tiling:	theTilingBufferSet
-						  spaceType:	md->itsSpaceType
-				 drawBackHemisphere:	md->itsDrawBackHemisphere
-					  alphaBlending:	false
-								fog:	md->itsFogFlag];
+		//	Dirichlet domain, unless the aperture is fully open
+		//	(meaning the walls are completely invisible)
+		if (md->itsAperture < 1.0)
+		{
+			[theRenderEncoder
+				setFragmentTexture:	(md->itsShowColorCoding ? itsPaperWallTexture : itsWoodWallTexture)
+				atIndex:			TextureIndexPrimary];
+			[self encodeMeshWithEncoder:	theRenderEncoder
+								meshSet:	itsDirichletWallsMeshSet	//	always non-nil, but will be empty if no Dirichlet domain is present
+								   slot:	MeshSlotDirichletWalls
+							  placement:	&theIdentityPlacement
+								 tiling:	theTilingBufferSet
+							  spaceType:	md->itsSpaceType
+					 drawBackHemisphere:	md->itsDrawBackHemisphere
+						  alphaBlending:	false
+									fog:	md->itsFogFlag];
+		}
 		
 		//	vertex figures
 		if (md->itsShowVertexFigures)
@@ -1145,6 +2366,8 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 				atIndex:TextureIndexPrimary];
 			[self encodeMeshWithEncoder:	theRenderEncoder
 								meshSet:	itsVertexFigureMeshSet
+								   slot:	MeshSlotVertexFigures
+							  placement:	&theIdentityPlacement
 								 tiling:	theTilingBufferSet
 							  spaceType:	md->itsSpaceType
 					 drawBackHemisphere:	md->itsDrawBackHemisphere
@@ -1159,7 +2382,9 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 				setFragmentTexture:itsWhiteObserverTexture
 				atIndex:TextureIndexPrimary];
 			[self encodeMeshWithEncoder:	theRenderEncoder
-								meshSet:	theObserverMeshSet
+								meshSet:	itsObserverMeshSet
+								   slot:	MeshSlotObserver
+							  placement:	&md->itsUserBodyPlacement
 								 tiling:	theTilingBufferSet
 							  spaceType:	md->itsSpaceType
 					 drawBackHemisphere:	md->itsDrawBackHemisphere
@@ -1170,13 +2395,16 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		//	centerpiece
 		//
 		//		The galaxy is transparent so, if present,
-		//		it should be drawn last, after all opaque content.
+		//		it should be drawn last, after all opaque content,
+		//		so that the depth buffer already hides its occluded parts.
 		//
 		[theRenderEncoder
 			setFragmentTexture:itsCenterpieceTexture
 			atIndex:TextureIndexPrimary];
 		[self encodeMeshWithEncoder:	theRenderEncoder
-							meshSet:	theCenterpieceMeshSet
+							meshSet:	itsCenterpieceMeshSet
+							   slot:	MeshSlotCenterpiece
+						  placement:	&theCenterpiecePlacement
 							 tiling:	theTilingBufferSet
 						  spaceType:	md->itsSpaceType
 				 drawBackHemisphere:	md->itsDrawBackHemisphere
@@ -1185,28 +2413,360 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	}
 
 	[theRenderEncoder endEncoding];
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	//	Blend the galaxy's accumulated images over the opaque scene.
+	if (theTransparencyFlag)
+	{
+		[self encodeTransparencyCompositeToCommandBuffer:	aCommandBuffer
+									renderPassDescriptor:	theRenderPassDescriptor];
+	}
+#endif
+
+	//	Stretch a reduced-scale scene across the drawable.
+	if (theRenderScale != nil)
+	{
+		[self encodeUpscaleToCommandBuffer:	aCommandBuffer
+									from:	theScenePassDescriptor
+									  to:	aRenderPassDescriptor];
+	}
+
+	EndFrameInterval(FrameIntervalEncodeCommands);
+}
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+
+- (MTLRenderPassDescriptor *)addTransparencyAttachmentsToRenderPassDescriptor:	(MTLRenderPassDescriptor *)aRenderPassDescriptor
+															drawTransparency:	(bool)aTransparencyFlag
+{
+	id<MTLTexture>			theColorTexture;
+	NSUInteger				theWidth,
+							theHeight;
+	MTLRenderPassDescriptor	*theRenderPassDescriptor;
+	MTLRenderPassColorAttachmentDescriptor
+							*theAccumulationAttachment,
+							*theRevealageAttachment;
+
+	//	Size the accumulation and revealage textures
+	//	to match the caller's render target.
+	//	[nil width] returns 0, so the first call creates them.
+	theColorTexture	= [[aRenderPassDescriptor colorAttachments][0] texture];
+	theWidth		= [theColorTexture width];
+	theHeight		= [theColorTexture height];
+	if ([itsTransparencyAccumulationTexture width]  != theWidth
+	 || [itsTransparencyAccumulationTexture height] != theHeight)
+	{
+		itsTransparencyAccumulationTexture	= MakeRenderTargetTexture(itsDevice, TRANSPARENCY_ACCUMULATION_PIXEL_FORMAT,	theWidth, theHeight, itsNumViews, false);
+		itsTransparencyRevealageTexture		= MakeRenderTargetTexture(itsDevice, TRANSPARENCY_REVEALAGE_PIXEL_FORMAT,		theWidth, theHeight, itsNumViews, false);
+		if (itsMultisamplingFlag)
+		{
+			itsTransparencyAccumulationMultisampleTexture	= MakeRenderTargetTexture(itsDevice, TRANSPARENCY_ACCUMULATION_PIXEL_FORMAT,	theWidth, theHeight, itsNumViews, true);
+			itsTransparencyRevealageMultisampleTexture		= MakeRenderTargetTexture(itsDevice, TRANSPARENCY_REVEALAGE_PIXEL_FORMAT,		theWidth, theHeight, itsNumViews, true);
+		}
+		else
+		{
+			itsTransparencyAccumulationMultisampleTexture	= nil;
+			itsTransparencyRevealageMultisampleTexture		= nil;
+		}
+	}
+
+	//	Leave the caller's descriptor untouched,
+	//	because the caller may re-use it.
+	theRenderPassDescriptor		= [aRenderPassDescriptor copy];
+	theAccumulationAttachment	= [theRenderPassDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation];
+	theRevealageAttachment		= [theRenderPassDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage];
+
+	if (itsMultisamplingFlag)
+	{
+		[theAccumulationAttachment	setTexture:itsTransparencyAccumulationMultisampleTexture];
+		[theRevealageAttachment		setTexture:itsTransparencyRevealageMultisampleTexture	];
+	}
+	else
+	{
+		[theAccumulationAttachment	setTexture:itsTransparencyAccumulationTexture];
+		[theRevealageAttachment		setTexture:itsTransparencyRevealageTexture	];
+	}
+
+	//	When no galaxy is present, the opaque pipeline states
+	//	never write the extra attachments, so they cost
+	//	no memory traffic at all.
+	if (aTransparencyFlag)
+	{
+		[theAccumulationAttachment	setClearColor:MTLClearColorMake(0.0, 0.0, 0.0, 0.0)];
+		[theAccumulationAttachment	setLoadAction:MTLLoadActionClear];
+		[theRevealageAttachment		setClearColor:MTLClearColorMake(1.0, 0.0, 0.0, 0.0)];
+		[theRevealageAttachment		setLoadAction:MTLLoadActionClear];
+
+		if (itsMultisamplingFlag)
+		{
+			[theAccumulationAttachment	setResolveTexture:itsTransparencyAccumulationTexture];
+			[theAccumulationAttachment	setStoreAction:MTLStoreActionMultisampleResolve];
+			[theRevealageAttachment		setResolveTexture:itsTransparencyRevealageTexture];
+			[theRevealageAttachment		setStoreAction:MTLStoreActionMultisampleResolve];
+		}
+		else
+		{
+			[theAccumulationAttachment	setStoreAction:MTLStoreActionStore];
+			[theRevealageAttachment		setStoreAction:MTLStoreActionStore];
+		}
+	}
+	else
+	{
+		[theAccumulationAttachment	setLoadAction:MTLLoadActionDontCare];
+		[theAccumulationAttachment	setStoreAction:MTLStoreActionDontCare];
+		[theRevealageAttachment		setLoadAction:MTLLoadActionDontCare];
+		[theRevealageAttachment		setStoreAction:MTLStoreActionDontCare];
+	}
+
+	return theRenderPassDescriptor;
+}
+
+- (void)encodeTransparencyCompositeToCommandBuffer:	(id<MTLCommandBuffer>)aCommandBuffer
+							  renderPassDescriptor:	(MTLRenderPassDescriptor *)aRenderPassDescriptor
+{
+	MTLRenderPassDescriptor		*theCompositePassDescriptor;
+	id<MTLTexture>				theColorTexture;
+	id<MTLRenderCommandEncoder>	theCompositeEncoder;
+
+	//	Blend the weighted average of the galaxy's fragments
+	//	over the finished opaque scene, in the resolved color texture
+	//	when multisampling.  One full-screen triangle per view suffices.
+
+	theColorTexture = [[aRenderPassDescriptor colorAttachments][0] resolveTexture];
+	if (theColorTexture == nil)
+		theColorTexture = [[aRenderPassDescriptor colorAttachments][0] texture];
+
+	theCompositePassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+	[theCompositePassDescriptor setRenderTargetArrayLength:[aRenderPassDescriptor renderTargetArrayLength]];
+	[[theCompositePassDescriptor colorAttachments][0] setTexture:theColorTexture];
+	[[theCompositePassDescriptor colorAttachments][0] setLoadAction:MTLLoadActionLoad];
+	[[theCompositePassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionStore];
+
+	theCompositeEncoder = [aCommandBuffer renderCommandEncoderWithDescriptor:theCompositePassDescriptor];
+	[theCompositeEncoder setRenderPipelineState:itsTransparencyCompositePipelineState];
+	[theCompositeEncoder setFragmentTexture:itsTransparencyAccumulationTexture	atIndex:TextureIndexTransparencyAccumulation];
+	[theCompositeEncoder setFragmentTexture:itsTransparencyRevealageTexture		atIndex:TextureIndexTransparencyRevealage	];
+	[theCompositeEncoder	drawPrimitives:	MTLPrimitiveTypeTriangle
+							vertexStart:	0
+							vertexCount:	3
+							instanceCount:	itsNumViews];
+	[theCompositeEncoder endEncoding];
+}
+
+#endif	//	ORDER_INDEPENDENT_TRANSPARENCY
+
+- (MTLRenderPassDescriptor *)makeScaledRenderPassDescriptorFor:	(MTLRenderPassDescriptor *)aRenderPassDescriptor
+												renderScale:	(double)aRenderScale
+{
+	id<MTLTexture>			theColorTexture;
+	NSUInteger				theWidth,
+							theHeight;
+	MTLRenderPassDescriptor	*theScaledPassDescriptor;
+
+	//	Size the reduced-scale textures as
+	//	-prepareInflightDataBuffersAtIndex:modelData: sized the image.
+	//	[nil width] returns 0, so the first call creates them.
+	theColorTexture	= [[aRenderPassDescriptor colorAttachments][0] texture];
+	theWidth		= MAX(1, (NSUInteger) floor(aRenderScale * [theColorTexture width ]));
+	theHeight		= MAX(1, (NSUInteger) floor(aRenderScale * [theColorTexture height]));
+	if ([itsScaledColorTexture width]  != theWidth
+	 || [itsScaledColorTexture height] != theHeight)
+	{
+		itsScaledColorTexture				= MakeRenderTargetTexture(itsDevice, itsColorPixelFormat,			theWidth, theHeight, itsNumViews, false);
+		itsScaledColorMultisampleTexture	= (itsMultisamplingFlag ?
+											   MakeRenderTargetTexture(itsDevice, itsColorPixelFormat,			theWidth, theHeight, itsNumViews, true) :
+											   nil);
+		itsScaledDepthTexture				= MakeRenderTargetTexture(itsDevice, MTLPixelFormatDepth32Float,	theWidth, theHeight, itsNumViews, itsMultisamplingFlag);
+	}
+
+	//	Keep the caller's clear color and load and store actions,
+	//	but not its textures.
+	theScaledPassDescriptor = [aRenderPassDescriptor copy];
+	if (itsMultisamplingFlag)
+	{
+		[[theScaledPassDescriptor colorAttachments][0] setTexture:itsScaledColorMultisampleTexture];
+		[[theScaledPassDescriptor colorAttachments][0] setResolveTexture:itsScaledColorTexture];
+		[[theScaledPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionMultisampleResolve];
+	}
+	else
+	{
+		[[theScaledPassDescriptor colorAttachments][0] setTexture:itsScaledColorTexture];
+		[[theScaledPassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionStore];
+	}
+	[[theScaledPassDescriptor depthAttachment] setTexture:itsScaledDepthTexture];
+	[[theScaledPassDescriptor depthAttachment] setClearDepth:1.0];
+	[[theScaledPassDescriptor depthAttachment] setLoadAction:MTLLoadActionClear];
+	[[theScaledPassDescriptor depthAttachment] setStoreAction:MTLStoreActionDontCare];
+
+	return theScaledPassDescriptor;
+}
+
+- (void)encodeUpscaleToCommandBuffer:	(id<MTLCommandBuffer>)aCommandBuffer
+								from:	(MTLRenderPassDescriptor *)aScaledRenderPassDescriptor
+								  to:	(MTLRenderPassDescriptor *)aRenderPassDescriptor
+{
+	id<MTLTexture>				theSceneTexture,
+								theDrawableTexture;
+	MTLRenderPassDescriptor		*theUpscalePassDescriptor;
+	id<MTLRenderCommandEncoder>	theUpscaleEncoder;
+
+	//	Draw straight into the single-sample drawable:
+	//	the reduced-scale scene has already been resolved,
+	//	and the full-screen triangle covers every pixel,
+	//	so the drawable's previous contents don't matter.
+
+	theSceneTexture = [[aScaledRenderPassDescriptor colorAttachments][0] resolveTexture];
+	if (theSceneTexture == nil)
+		theSceneTexture = [[aScaledRenderPassDescriptor colorAttachments][0] texture];
+
+	theDrawableTexture = [[aRenderPassDescriptor colorAttachments][0] resolveTexture];
+	if (theDrawableTexture == nil)
+		theDrawableTexture = [[aRenderPassDescriptor colorAttachments][0] texture];
+
+	theUpscalePassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+	[theUpscalePassDescriptor setRenderTargetArrayLength:[aRenderPassDescriptor renderTargetArrayLength]];
+	[[theUpscalePassDescriptor colorAttachments][0] setTexture:theDrawableTexture];
+	[[theUpscalePassDescriptor colorAttachments][0] setLoadAction:MTLLoadActionDontCare];
+	[[theUpscalePassDescriptor colorAttachments][0] setStoreAction:MTLStoreActionStore];
+
+	theUpscaleEncoder = [aCommandBuffer renderCommandEncoderWithDescriptor:theUpscalePassDescriptor];
+	[theUpscaleEncoder setRenderPipelineState:itsUpscalePipelineState];
+	[theUpscaleEncoder setFragmentTexture:theSceneTexture atIndex:TextureIndexPrimary];
+	[theUpscaleEncoder setFragmentSamplerState:itsUpscaleSampler atIndex:SamplerIndexPrimary];
+	[theUpscaleEncoder	drawPrimitives:	MTLPrimitiveTypeTriangle
+						vertexStart:	0
+						vertexCount:	3
+						instanceCount:	itsNumViews];
+	[theUpscaleEncoder endEncoding];
+}
+
+- (void)countTilesInBufferSet:	(TilingBufferSet *)aTilingBufferSet
+					counters:	(FrameCounters *)someCounters	//	input and output
+{
+	unsigned int	theSlot,
+					theLevel;
+
+	//	When the GPU culls the honeycomb, the counts
+	//	exist only in GPU memory.
+	someCounters->itsGPUCullingFlag = aTilingBufferSet->itsGPUCullingFlag;
+	if (aTilingBufferSet->itsGPUCullingFlag)
+		return;
+
+	someCounters->itsNumVisibleCells			= aTilingBufferSet->itsTotalNumTiles;
+	someCounters->itsNumVisiblePlainCells		= aTilingBufferSet->itsNumPlainTiles;
+	someCounters->itsNumVisibleReflectedCells	= aTilingBufferSet->itsNumReflectedTiles;
+	someCounters->itsNumInvertedCells			= aTilingBufferSet->itsNumInvertedTiles;
+
+	//	Each mesh draws every visible tile at one level or another.
+	for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+		someCounters->itsNumInstancesPerLevel[theLevel] = 0;
+	for (theSlot = 0; theSlot < NumMeshSlots; theSlot++)
+	{
+		if ([self meshSetForSlot:theSlot] == nil)
+			continue;
+
+		for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+		{
+			someCounters->itsNumInstancesPerLevel[theLevel]
+				+= (aTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel + 1]
+				  - aTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel])
+				 + (aTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel + 1]
+				  - aTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel]);
+		}
+	}
+}
+
+- (void)encodeCullingCommandsToCommandBuffer:	(id<MTLCommandBuffer>)aCommandBuffer
+										tiling:	(TilingBufferSet *)aTilingBufferSet
+{
+	id<MTLComputeCommandEncoder>	theComputeEncoder;
+	MTLSize							theThreadgroupSize,
+									theSortThreadgroupCount,
+									theCellThreadgroupCount;
+	unsigned int					k,
+									j;
+	simd_uint2						theSortStage;
+
+	theThreadgroupSize		= MTLSizeMake(CULLING_THREADGROUP_WIDTH, 1, 1);
+	theSortThreadgroupCount	= MTLSizeMake((aTilingBufferSet->itsSortSize + CULLING_THREADGROUP_WIDTH - 1) / CULLING_THREADGROUP_WIDTH, 1, 1);
+	theCellThreadgroupCount	= MTLSizeMake((aTilingBufferSet->itsNumCells + CULLING_THREADGROUP_WIDTH - 1) / CULLING_THREADGROUP_WIDTH, 1, 1);
+
+	theComputeEncoder = [aCommandBuffer computeCommandEncoder];
+
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsCullUniformBuffer					offset:0 atIndex:BufferIndexCullUniforms		];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsCellBuffer						offset:0 atIndex:BufferIndexCullCells			];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsSortEntryBuffer					offset:0 atIndex:BufferIndexCullSortEntries		];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsCullResultBuffer					offset:0 atIndex:BufferIndexCullResults			];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsPlainFrontToBackTilingBuffer		offset:0 atIndex:BufferIndexCullPlainTiles		];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsReflectedFrontToBackTilingBuffer	offset:0 atIndex:BufferIndexCullReflectedTiles	];
+	[theComputeEncoder setBuffer:aTilingBufferSet->itsFullBackToFrontTilingBuffer		offset:0 atIndex:BufferIndexCullFullTiles		];
+
+	//	Cull each cell and compute its sort entry.
+	[theComputeEncoder setComputePipelineState:itsCullPipelineState];
+	[theComputeEncoder dispatchThreadgroups:theSortThreadgroupCount threadsPerThreadgroup:theThreadgroupSize];
+
+	//	Sort the entries with a bitonic sort.  The number of passes
+	//	depends only on log₂(itsSortSize), so the CPU's cost
+	//	stays small even for a large honeycomb.
+	[theComputeEncoder setComputePipelineState:itsSortStepPipelineState];
+	for (k = 2; k <= aTilingBufferSet->itsSortSize; k *= 2)
+	{
+		for (j = k / 2; j > 0; j /= 2)
+		{
+			theSortStage = simd_make_uint2(k, j);
+			[theComputeEncoder setBytes:&theSortStage length:sizeof(theSortStage) atIndex:BufferIndexCullSortStage];
+			[theComputeEncoder dispatchThreadgroups:theSortThreadgroupCount threadsPerThreadgroup:theThreadgroupSize];
+		}
+	}
+
+	//	Count the visible tiles and write the indirect draw arguments.
+	[theComputeEncoder setComputePipelineState:itsCullFinishPipelineState];
+	[theComputeEncoder dispatchThreadgroups:MTLSizeMake(1, 1, 1) threadsPerThreadgroup:MTLSizeMake(1, 1, 1)];
+
+	//	Write the visible cells' indices into the plain, reflected
+	//	and full back-to-front tiling buffers.
+	[theComputeEncoder setComputePipelineState:itsCullScatterPipelineState];
+	[theComputeEncoder dispatchThreadgroups:theCellThreadgroupCount threadsPerThreadgroup:theThreadgroupSize];
+
+	[theComputeEncoder endEncoding];
 }
 
 - (void)encodeMeshWithEncoder:	(id<MTLRenderCommandEncoder>)aRenderEncoder
 					  meshSet:	(MeshSet *)aMeshSet
+						 slot:	(MeshSlot)aMeshSlot
+					placement:	(Matrix *)aPlacement
 					   tiling:	(TilingBufferSet *)aTilingBufferSet
 					spaceType:	(SpaceType)aSpaceType
 		   drawBackHemisphere:	(bool)aDrawBackHemisphereFlag
 				alphaBlending:	(bool)anAlphaBlendingFlag
 						  fog:	(bool)aFogFlag
 {
+	simd_float4x4	thePlacementAsSIMD;
+	bool			theReflectionFlag;
+
 	if (aSpaceType == SpaceNone)
 		return;
 	
 	if (aMeshSet->itsMeshes[0] == nil)	//	MeshSet is empty?
 		return;
 
+	//	The vertex function applies aPlacement to each vertex
+	//	before the cell's tiling matrix.  If aPlacement is a reflection,
+	//	it reverses the mesh's winding sense, so the front-facing winding
+	//	must get reversed too.
+	thePlacementAsSIMD = ConvertMatrix44ToSIMD(aPlacement->m);
+	[aRenderEncoder setVertexBytes:	&thePlacementAsSIMD
+							length:	sizeof(thePlacementAsSIMD)
+						   atIndex:	BufferIndexMeshPlacement];
+	theReflectionFlag = (aPlacement->itsParity == ImageNegative);
+
 	if (aDrawBackHemisphereFlag)	//	3-sphere or odd-order lens space?
 	{
 		[self   encodeFullSphereWithEncoder:	aRenderEncoder
 									meshSet:	aMeshSet
 									 tiling:	aTilingBufferSet
 								  spaceType:	aSpaceType
+								 reflection:	theReflectionFlag
 							  alphaBlending:	anAlphaBlendingFlag
 										fog:	aFogFlag];
 	}
@@ -1214,8 +2774,10 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	{
 		[self encodeTypicalSpaceWithEncoder:	aRenderEncoder
 									meshSet:	aMeshSet
+									   slot:	aMeshSlot
 									 tiling:	aTilingBufferSet
 								  spaceType:	aSpaceType
+								 reflection:	theReflectionFlag
 							  alphaBlending:	anAlphaBlendingFlag
 										fog:	aFogFlag];
 	}
@@ -1225,10 +2787,12 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 							meshSet:	(MeshSet *)aMeshSet
 							 tiling:	(TilingBufferSet *)aTilingBufferSet
 						  spaceType:	(SpaceType)aSpaceType
+						 reflection:	(bool)aReflectionFlag	//	Is the mesh's placement a reflection?
 					  alphaBlending:	(bool)anAlphaBlendingFlag
 								fog:	(bool)aFogFlag
 {
 	Mesh						*theMesh;
+	PipelineVariant				theVariant;
 	id<MTLRenderPipelineState>	thePipelineStateBoxFront	= nil,
 								thePipelineStateBoxBack		= nil;
 	
@@ -1241,49 +2805,44 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 	if (anAlphaBlendingFlag)
 		return;
 	
-	//	As explained in -encodeTypicalSpaceWithEncoder: below,
-	//	spherical spaces look best when we use the finest mesh
-	//	for the whole tiling.
+	//	The spaces that need their back hemisphere drawn
+	//	have small symmetry groups, and every image
+	//	gets drawn twice, so to keep the code simple
+	//	use the finest mesh for the whole tiling.
 	theMesh = aMeshSet->itsMeshes[0];
 
 	//	We'll draw each mesh twice, once for the back hemisphere
 	//	and once for the front hemisphere.
-	if (theMesh->itsCubeMapFlag)
+	theVariant = GetPipelineVariant(theMesh, false);
+	if (aFogFlag)
 	{
-		if (aFogFlag)
-		{
-			thePipelineStateBoxFront	= itsRenderPipelineStateSphericalFogBoxFrontCubeMap;
-			thePipelineStateBoxBack		= itsRenderPipelineStateSphericalFogBoxBackCubeMap;
-		}
-		else	//	! aFogFlag
-		{
-			thePipelineStateBoxFront	= itsRenderPipelineStateNoFogBoxFrontCubeMap;
-			thePipelineStateBoxBack		= itsRenderPipelineStateNoFogBoxBackCubeMap;
-		}
+		thePipelineStateBoxFront	= [self renderPipelineStateForType:ShaderSphericalFogBoxFront	variant:theVariant];
+		thePipelineStateBoxBack		= [self renderPipelineStateForType:ShaderSphericalFogBoxBack	variant:theVariant];
 	}
-	else	//	traditional texture
+	else	//	! aFogFlag
 	{
-		if (aFogFlag)
-		{
-			thePipelineStateBoxFront	= itsRenderPipelineStateSphericalFogBoxFront;
-			thePipelineStateBoxBack		= itsRenderPipelineStateSphericalFogBoxBack;
-		}
-		else	//	! aFogFlag
-		{
-			thePipelineStateBoxFront	= itsRenderPipelineStateNoFogBoxFront;
-			thePipelineStateBoxBack		= itsRenderPipelineStateNoFogBoxBack;
-		}
+		thePipelineStateBoxFront	= [self renderPipelineStateForType:ShaderNoFogBoxFront			variant:theVariant];
+		thePipelineStateBoxBack		= [self renderPipelineStateForType:ShaderNoFogBoxBack			variant:theVariant];
 	}
 
 	[aRenderEncoder
 		setVertexBuffer:theMesh->itsVertexBuffer
 		offset:0
 		atIndex:BufferIndexVertexAttributes];
+	if (theMesh->itsApertureBuffer != nil)
+	{
+		[aRenderEncoder
+			setVertexBuffer:theMesh->itsApertureBuffer
+			offset:0
+			atIndex:BufferIndexApertureAttributes];
+	}
 
 	//	All spherical spaces are orientable, so the front-face winding
-	//	is always the same.  Following Metal conventions, we set it to clockwise.
+	//	is the same for all tiles.  Following Metal conventions,
+	//	we set it to clockwise, unless the mesh's own placement
+	//	is a reflection.
 	[aRenderEncoder setCullMode:MTLCullModeBack];
-	[aRenderEncoder setFrontFacingWinding:MTLWindingClockwise];
+	[aRenderEncoder setFrontFacingWinding:(aReflectionFlag ? MTLWindingCounterClockwise : MTLWindingClockwise)];
 
 	//	back hemisphere
 	[aRenderEncoder setRenderPipelineState:thePipelineStateBoxBack];
@@ -1295,7 +2854,7 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 					indexType:				MTLIndexTypeUInt16
 					indexBuffer:			theMesh->itsIndexBuffer
 					indexBufferOffset:		0
-					instanceCount:			aTilingBufferSet->itsNumInvertedTiles];
+					instanceCount:			itsNumViews * aTilingBufferSet->itsNumInvertedTiles];
 
 	//	front hemisphere
 	[aRenderEncoder setRenderPipelineState:thePipelineStateBoxFront];
@@ -1307,111 +2866,40 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 					indexType:				MTLIndexTypeUInt16
 					indexBuffer:			theMesh->itsIndexBuffer
 					indexBufferOffset:		0
-					instanceCount:			aTilingBufferSet->itsTotalNumTiles];
+					instanceCount:			itsNumViews * aTilingBufferSet->itsTotalNumTiles];
 }
 
 - (void)encodeTypicalSpaceWithEncoder:	(id<MTLRenderCommandEncoder>)aRenderEncoder
 							  meshSet:	(MeshSet *)aMeshSet
+								 slot:	(MeshSlot)aMeshSlot
 							   tiling:	(TilingBufferSet *)aTilingBufferSet
 							spaceType:	(SpaceType)aSpaceType
+						   reflection:	(bool)aReflectionFlag	//	Is the mesh's placement a reflection?
 						alphaBlending:	(bool)anAlphaBlendingFlag
 								  fog:	(bool)aFogFlag
 {
 	unsigned int				theNumLevelsOfDetail;
+	ShaderFogAndClipBoxType		theShaderType		= ShaderNoFogBoxFull;
 	id<MTLRenderPipelineState>	thePipelineState	= nil;
-	unsigned int				thePlainLevelCutoffs[MAX_NUM_LOD_LEVELS + 1],
-								theReflectedLevelCutoffs[MAX_NUM_LOD_LEVELS + 1],
-								theLevel;
+	const unsigned int			*thePlainLevelCutoffs,
+								*theReflectedLevelCutoffs;
+	unsigned int				theLevel;
 	Mesh						*theMesh;
 	unsigned int				theNumPlainInstances,
 								theNumReflectedInstances;
+	MTLWinding					thePlainWinding,
+								theReflectedWinding;
+
 
-#if (MAX_NUM_LOD_LEVELS != 4)
-#error The code below assumes the maximum number of levels-of-detail is exactly 4 .
-#endif
-	//	After how many instances should we drop to the next lower level-of-detail?
-	//	With the current values,
-	//
-	//		instance    0        gets rendered with mesh 0
-	//		instances   1 -  63  get  rendered with mesh 1
-	//		instances  64 - 255  get  rendered with mesh 2
-	//		instances 256 -      get  rendered with mesh 3
-	//
-#if (defined(MAKE_SCREENSHOTS) || SHAPE_OF_SPACE_CH_16 == 3)
-	//	In The Shape of Space 3rd edition, Figure 16.3 uses a narrow field of view,
-	//	so let's draw higher level-of-detail images of the Earth.
-	//	And let's also just higher level-of-detail images for screenshots.
-	const unsigned int	theLevelCutoffs[MAX_NUM_LOD_LEVELS + 1] = {0, 32, 256, 4024, UINT_MAX};
-#else
-	const unsigned int	theLevelCutoffs[MAX_NUM_LOD_LEVELS + 1] = {0, 1, 64, 256, UINT_MAX};
-#endif
-	
-	
 	//	How many levels of detail does aMeshSet contain?
 	theNumLevelsOfDetail = GetNumLevelsOfDetail(aMeshSet);
 
-	switch (aSpaceType)
-	{
-		case SpaceSpherical:
-
-			//	For spherical spaces, use the best level of detail for the whole tiling,
-			//	because the number of cells is typically not too large, and
-			//	the spinning Earths near the antipodal point appear large
-			//	and require best quality.
-			for (theLevel = 0; theLevel <= theNumLevelsOfDetail; theLevel++)
-			{
-				thePlainLevelCutoffs[theLevel]		= (theLevel == 0 ? 0 : UINT_MAX);
-				
-				//	Spherical manifolds never have reflected tiles, but
-				//	spherical orbfolds -- for example a mirrored lens -- may have them.
-				theReflectedLevelCutoffs[theLevel]	= (theLevel == 0 ? 0 : UINT_MAX);
-			}
-
-			break;
-		
-		case SpaceFlat:
-		case SpaceHyperbolic:
-
-			//	Either all the tiles will be plain (not reflected)...
-			if (aTilingBufferSet->itsNumReflectedTiles == 0)
-			{
-				for (theLevel = 0; theLevel <= theNumLevelsOfDetail; theLevel++)
-				{
-					thePlainLevelCutoffs[theLevel]		= theLevelCutoffs[theLevel];
-					theReflectedLevelCutoffs[theLevel]	= 0;
-				}
-			}
-			else	//	... or they'll be roughly half plain and half reflected.
-			{
-				//	Split the number of instances at each level
-				//	between the plain tiles and the reflected ones.
-				for (theLevel = 0; theLevel <= theNumLevelsOfDetail; theLevel++)
-				{
-					thePlainLevelCutoffs[theLevel]		= (theLevelCutoffs[theLevel] < UINT_MAX ?
-															(theLevelCutoffs[theLevel] + 1) / 2 :	//	add +1 so integer division rounds up
-															UINT_MAX );
-					theReflectedLevelCutoffs[theLevel]	= thePlainLevelCutoffs[theLevel];
-				}
-			}
-			
-			break;
-		
-		case SpaceNone:
-			GEOMETRY_GAMES_ABORT("The caller should have already excluded SpaceNone");
-	}
-	
-	//	Limit the level cutoffs to the number of tiles actually present.
-	for (theLevel = 0; theLevel <= theNumLevelsOfDetail; theLevel++)
-	{
-		if (thePlainLevelCutoffs[theLevel]     > aTilingBufferSet->itsNumPlainTiles)
-			thePlainLevelCutoffs[theLevel]     = aTilingBufferSet->itsNumPlainTiles;
-		if (theReflectedLevelCutoffs[theLevel] > aTilingBufferSet->itsNumReflectedTiles)
-			theReflectedLevelCutoffs[theLevel] = aTilingBufferSet->itsNumReflectedTiles;
-	}
-	
-	//	The last available level-of-detail should handle all remaining tiles.
-	thePlainLevelCutoffs[theNumLevelsOfDetail]		= aTilingBufferSet->itsNumPlainTiles;
-	theReflectedLevelCutoffs[theNumLevelsOfDetail]	= aTilingBufferSet->itsNumReflectedTiles;
+	//	-writeSortedVisibleTilesIntoBufferSet:… has already decided
+	//	which tiles get which level of detail, according to
+	//	how big aMeshSet's images look on the screen.
+	//	(When the GPU culls the honeycomb, these cutoffs go unused.)
+	thePlainLevelCutoffs		= aTilingBufferSet->itsPlainLevelCutoffs[aMeshSlot];
+	theReflectedLevelCutoffs	= aTilingBufferSet->itsReflectedLevelCutoffs[aMeshSlot];
 
 	if (aFogFlag)
 	{
@@ -1420,51 +2908,19 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		//	it uses a different fog formula in each case.
 		switch (aSpaceType)
 		{
-			case SpaceSpherical:
-				if (anAlphaBlendingFlag)
-					thePipelineState = itsRenderPipelineStateSphericalFogBoxFullBlended;
-				else
-				if (aMeshSet->itsMeshes[0]->itsCubeMapFlag)
-					thePipelineState = itsRenderPipelineStateSphericalFogBoxFullCubeMap;
-				else
-					thePipelineState = itsRenderPipelineStateSphericalFogBoxFull;
-				break;
-			
-			case SpaceFlat:
-				if (anAlphaBlendingFlag)
-					thePipelineState = itsRenderPipelineStateEuclideanFogBoxFullBlended;
-				else
-				if (aMeshSet->itsMeshes[0]->itsCubeMapFlag)
-					thePipelineState = itsRenderPipelineStateEuclideanFogBoxFullCubeMap;
-				else
-					thePipelineState = itsRenderPipelineStateEuclideanFogBoxFull;
-				break;
-				
-			case SpaceHyperbolic:
-				if (anAlphaBlendingFlag)
-					thePipelineState = itsRenderPipelineStateHyperbolicFogBoxFullBlended;
-				else
-				if (aMeshSet->itsMeshes[0]->itsCubeMapFlag)
-					thePipelineState = itsRenderPipelineStateHyperbolicFogBoxFullCubeMap;
-				else
-					thePipelineState = itsRenderPipelineStateHyperbolicFogBoxFull;
-				break;
-				
-			case SpaceNone:	//	should never occur
-				thePipelineState = itsRenderPipelineStateEuclideanFogBoxFull;
-				break;
+			case SpaceSpherical:	theShaderType = ShaderSphericalFogBoxFull;	break;
+			case SpaceFlat:			theShaderType = ShaderEuclideanFogBoxFull;	break;
+			case SpaceHyperbolic:	theShaderType = ShaderHyperbolicFogBoxFull;	break;
+			case SpaceNone:			theShaderType = ShaderEuclideanFogBoxFull;	break;	//	should never occur
 		}
 	}
 	else	//	! aFogFlag
 	{
-		if (anAlphaBlendingFlag)
-			thePipelineState = itsRenderPipelineStateNoFogBoxFullBlended;
-		else
-		if (aMeshSet->itsMeshes[0]->itsCubeMapFlag)
-			thePipelineState = itsRenderPipelineStateNoFogBoxFullCubeMap;
-		else
-			thePipelineState = itsRenderPipelineStateNoFogBoxFull;
+		theShaderType = ShaderNoFogBoxFull;
 	}
+	thePipelineState = [self
+		renderPipelineStateForType:	theShaderType
+		variant:					GetPipelineVariant(aMeshSet->itsMeshes[0], anAlphaBlendingFlag)];
 	[aRenderEncoder setRenderPipelineState:thePipelineState];
 
 
@@ -1483,6 +2939,69 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 		[aRenderEncoder setCullMode:MTLCullModeNone];
 		[aRenderEncoder setFrontFacingWinding:MTLWindingClockwise];	//	unnecessary but harmless
 
+#if ORDER_INDEPENDENT_TRANSPARENCY
+		//	Order-independent transparency lets the instances
+		//	arrive in any order, so draw them from the same
+		//	plain and reflected front-to-back buffers as the opaque content.
+		//	With only one level-of-detail, level 0's draws
+		//	cover all the tiles.
+		//
+		//		Note:  With backface culling disabled, the plain and
+		//		reflected instances need no separate front-facing windings.
+		//
+		[aRenderEncoder setDepthStencilState:itsTransparencyDepthStencilState];
+		if (aTilingBufferSet->itsGPUCullingFlag)
+		{
+			[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsPlainFrontToBackTilingBuffer
+							offset:				0
+							atIndex:			BufferIndexTilingGroup];
+			[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+							indexType:				MTLIndexTypeUInt16
+							indexBuffer:			theMesh->itsIndexBuffer
+							indexBufferOffset:		0
+							indirectBuffer:			aTilingBufferSet->itsCullResultBuffer
+							indirectBufferOffset:	offsetof(CurvedSpacesCullResultData, itsOpaqueDraws[aMeshSlot][0][0])];
+
+			[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsReflectedFrontToBackTilingBuffer
+							offset:				0
+							atIndex:			BufferIndexTilingGroup];
+			[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+							indexType:				MTLIndexTypeUInt16
+							indexBuffer:			theMesh->itsIndexBuffer
+							indexBufferOffset:		0
+							indirectBuffer:			aTilingBufferSet->itsCullResultBuffer
+							indirectBufferOffset:	offsetof(CurvedSpacesCullResultData, itsOpaqueDraws[aMeshSlot][0][1])];
+		}
+		else
+		{
+			if (aTilingBufferSet->itsNumPlainTiles > 0)
+			{
+				[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsPlainFrontToBackTilingBuffer
+								offset:				0
+								atIndex:			BufferIndexTilingGroup];
+				[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+								indexCount:				3 * theMesh->itsNumFacets
+								indexType:				MTLIndexTypeUInt16
+								indexBuffer:			theMesh->itsIndexBuffer
+								indexBufferOffset:		0
+								instanceCount:			itsNumViews * aTilingBufferSet->itsNumPlainTiles];
+			}
+
+			if (aTilingBufferSet->itsNumReflectedTiles > 0)
+			{
+				[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsReflectedFrontToBackTilingBuffer
+								offset:				0
+								atIndex:			BufferIndexTilingGroup];
+				[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+								indexCount:				3 * theMesh->itsNumFacets
+								indexType:				MTLIndexTypeUInt16
+								indexBuffer:			theMesh->itsIndexBuffer
+								indexBufferOffset:		0
+								instanceCount:			itsNumViews * aTilingBufferSet->itsNumReflectedTiles];
+			}
+		}
+		[aRenderEncoder setDepthStencilState:itsDepthStencilState];
+#else
 		//	Draw the instances back-to-front, so more distant instances
 		//	appear underneath nearer ones.
 		//
@@ -1496,24 +3015,24 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 							offset:0
 							atIndex:BufferIndexTilingGroup];
 
-		[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
-						indexCount:				3 * theMesh->itsNumFacets
-						indexType:				MTLIndexTypeUInt16
-						indexBuffer:			theMesh->itsIndexBuffer
-						indexBufferOffset:		0
-#if (defined(PREPARE_FOR_SCREENSHOT) || defined(MAKE_SCREENSHOTS) || defined(HIGH_RESOLUTION_SCREENSHOT) || (SHAPE_OF_SPACE_CH_16 == 6))
-	//	Omit the two nearest images of the galaxy, to avoid obscuring the view.
-	//	Somehow it seems that the second image is the one causing the problem
-	//	(the most central image is probably behind the observer), which is
-	//	why we must omit two images instead of only one.
-						instanceCount:			aTilingBufferSet->itsTotalNumTiles - 2];
-//	NOT NEEDED:
-//		//	omit both the nearest image and the farthest image
-//						instanceCount:			aTilingBufferSet->itsTotalNumTiles - 2
-//						baseInstance:			1
-//						];
-#else	//	typical case
-						instanceCount:			aTilingBufferSet->itsTotalNumTiles];
+		if (aTilingBufferSet->itsGPUCullingFlag)
+		{
+			[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+							indexType:				MTLIndexTypeUInt16
+							indexBuffer:			theMesh->itsIndexBuffer
+							indexBufferOffset:		0
+							indirectBuffer:			aTilingBufferSet->itsCullResultBuffer
+							indirectBufferOffset:	offsetof(CurvedSpacesCullResultData, itsBlendedDraws[aMeshSlot])];
+		}
+		else
+		{
+			[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+							indexCount:				3 * theMesh->itsNumFacets
+							indexType:				MTLIndexTypeUInt16
+							indexBuffer:			theMesh->itsIndexBuffer
+							indexBufferOffset:		0
+							instanceCount:			itsNumViews * (aTilingBufferSet->itsTotalNumTiles - NUM_BLENDED_INSTANCES_TO_OMIT)];
+		}
 #endif
 	}
 	else	//	! anAlphaBlendingFlag
@@ -1525,6 +3044,12 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 #endif
 		[aRenderEncoder setCullMode:MTLCullModeBack];
 
+		//	Plain images keep Metal's default clockwise winding
+		//	and reflected images take the opposite,
+		//	unless the mesh's own placement is a reflection.
+		thePlainWinding		= (aReflectionFlag ? MTLWindingCounterClockwise : MTLWindingClockwise);
+		theReflectedWinding	= (aReflectionFlag ? MTLWindingClockwise : MTLWindingCounterClockwise);
+
 		for (theLevel = 0; theLevel < theNumLevelsOfDetail; theLevel++)
 		{
 			theMesh = aMeshSet->itsMeshes[theLevel];
@@ -1532,37 +3057,77 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 			[aRenderEncoder setVertexBuffer:theMesh->itsVertexBuffer
 								offset:0
 								atIndex:BufferIndexVertexAttributes];
+			if (theMesh->itsApertureBuffer != nil)
+			{
+				[aRenderEncoder setVertexBuffer:theMesh->itsApertureBuffer
+									offset:0
+									atIndex:BufferIndexApertureAttributes];
+			}
 
-			//	plain images
-			theNumPlainInstances = thePlainLevelCutoffs[theLevel + 1] - thePlainLevelCutoffs[theLevel];
-			if (theNumPlainInstances > 0)
+			if (aTilingBufferSet->itsGPUCullingFlag)
 			{
+				//	The GPU has already written each draw call's
+				//	instance count and base instance.  The vertex function's
+				//	instance_id includes the base instance, so bind
+				//	each tiling buffer at offset 0.
+
+				//	plain images
 				[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsPlainFrontToBackTilingBuffer
-								offset:				thePlainLevelCutoffs[theLevel] * sizeof(simd_float4x4)
+								offset:				0
 								atIndex:			BufferIndexTilingGroup];
-				[aRenderEncoder setFrontFacingWinding:MTLWindingClockwise];			//	Metal's default
+				[aRenderEncoder setFrontFacingWinding:thePlainWinding];
 				[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
-								indexCount:				3 * theMesh->itsNumFacets
 								indexType:				MTLIndexTypeUInt16
 								indexBuffer:			theMesh->itsIndexBuffer
 								indexBufferOffset:		0
-								instanceCount:			theNumPlainInstances];
-			}
+								indirectBuffer:			aTilingBufferSet->itsCullResultBuffer
+								indirectBufferOffset:	offsetof(CurvedSpacesCullResultData, itsOpaqueDraws[aMeshSlot][theLevel][0])];
 
-			//	reflected images (if any)
-			theNumReflectedInstances = theReflectedLevelCutoffs[theLevel + 1] - theReflectedLevelCutoffs[theLevel];
-			if (theNumReflectedInstances > 0)
-			{
+				//	reflected images (if any)
 				[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsReflectedFrontToBackTilingBuffer
-								offset:				theReflectedLevelCutoffs[theLevel] * sizeof(simd_float4x4)
+								offset:				0
 								atIndex:			BufferIndexTilingGroup];
-				[aRenderEncoder setFrontFacingWinding:MTLWindingCounterClockwise];	//	the opposite of Metal's default
+				[aRenderEncoder setFrontFacingWinding:theReflectedWinding];
 				[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
-								indexCount:				3 * theMesh->itsNumFacets
 								indexType:				MTLIndexTypeUInt16
 								indexBuffer:			theMesh->itsIndexBuffer
 								indexBufferOffset:		0
-								instanceCount:			theNumReflectedInstances];
+								indirectBuffer:			aTilingBufferSet->itsCullResultBuffer
+								indirectBufferOffset:	offsetof(CurvedSpacesCullResultData, itsOpaqueDraws[aMeshSlot][theLevel][1])];
+			}
+			else
+			{
+				//	plain images
+				theNumPlainInstances = thePlainLevelCutoffs[theLevel + 1] - thePlainLevelCutoffs[theLevel];
+				if (theNumPlainInstances > 0)
+				{
+					[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsPlainFrontToBackTilingBuffer
+									offset:				thePlainLevelCutoffs[theLevel] * sizeof(uint32_t)
+									atIndex:			BufferIndexTilingGroup];
+					[aRenderEncoder setFrontFacingWinding:thePlainWinding];
+					[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+									indexCount:				3 * theMesh->itsNumFacets
+									indexType:				MTLIndexTypeUInt16
+									indexBuffer:			theMesh->itsIndexBuffer
+									indexBufferOffset:		0
+									instanceCount:			itsNumViews * theNumPlainInstances];
+				}
+
+				//	reflected images (if any)
+				theNumReflectedInstances = theReflectedLevelCutoffs[theLevel + 1] - theReflectedLevelCutoffs[theLevel];
+				if (theNumReflectedInstances > 0)
+				{
+					[aRenderEncoder setVertexBuffer:	aTilingBufferSet->itsReflectedFrontToBackTilingBuffer
+									offset:				theReflectedLevelCutoffs[theLevel] * sizeof(uint32_t)
+									atIndex:			BufferIndexTilingGroup];
+					[aRenderEncoder setFrontFacingWinding:theReflectedWinding];
+					[aRenderEncoder	drawIndexedPrimitives:	MTLPrimitiveTypeTriangle
+									indexCount:				3 * theMesh->itsNumFacets
+									indexType:				MTLIndexTypeUInt16
+									indexBuffer:			theMesh->itsIndexBuffer
+									indexBufferOffset:		0
+									instanceCount:			itsNumViews * theNumReflectedInstances];
+				}
 			}
 		}
 	}
@@ -1572,30 +3137,12 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 #pragma mark -
 #pragma mark mesh transformations
 
-- (void)writeRotatedCenterpieceIntoMeshSet:(MeshSet *)aRotatedCenterpieceMeshSet modelData:(ModelData *)md
-{
-	unsigned int			theNumLevelsOfDetail,
-							theLevel;
-	NSUInteger				theVertexBufferLengthInBytes,
-							theIndexBufferLengthInBytes;
-	CurvedSpacesVertexData	*theSrcVertexData,
-							*theDstVertexData;
-	Matrix					theSpin,
-							theTilt,
-							theOrientation;	//	“orientation” in the sense of an element of O(3),
-											//		not a connected component of O(3)
-#ifdef CENTERPIECE_DISPLACEMENT
-	Matrix					thePlacement;
-#endif
-	simd_float4x4			thePlacementAsSIMD;
-	NSUInteger				theNumVertices;
-	unsigned int			i;
-	UInt16					(*theSrcIndexData)[3],
-							(*theDstIndexData)[3];
-#ifdef CENTERPIECE_DISPLACEMENT
-	UInt16					theSwapValue;
-#endif
-
+- (void)getCenterpiecePlacement:(Matrix *)aPlacement modelData:(ModelData *)md
+{
+	Matrix	theSpin,
+			theTilt,
+			theOrientation;	//	“orientation” in the sense of an element of O(3),
+							//		not a connected component of O(3)
 
 	switch (md->itsCenterpieceType)
 	{
@@ -1608,261 +3155,132 @@ static unsigned int					GetNumLevelsOfDetail(MeshSet *aMeshSet);
 			MatrixRotation(&theSpin, 0.0, 0.0, EARTH_SPEED * md->itsRotationAngle);
 			MatrixRotation(&theTilt, -PI/2, 0.0, 0.0);	//	takes Earth's spin axis from z-axis to y-axis
 			break;
-			
+
 		case CenterpieceGalaxy:
 			MatrixRotation(&theSpin, 0.0, 0.0, GALAXY_SPEED * md->itsRotationAngle);
 			MatrixRotation(&theTilt, 0.2, 0.3, 0.0);	//	arbitrary spin axis that looks nice
-			break;
-			
-		case CenterpieceGyroscope:
-			MatrixRotation(&theSpin, 0.0, 0.0, GYROSCOPE_SPEED * md->itsRotationAngle);
-			MatrixRotation(&theTilt, -PI/2, 0.0, 0.0);	//	takes gyroscope's spin axis from z-axis to y-axis
-			break;
-
-#ifdef SHAPE_OF_SPACE_CH_7
-		case CenterpieceCube:
-			MatrixRotation(&theSpin, 0.0, 0.0, 0.0);
-			MatrixRotation(&theTilt, 0.0, 0.0, 0.0);
-			break;
-#endif
-	}
-	MatrixProduct(&theSpin, &theTilt, &theOrientation);
-#ifdef CENTERPIECE_DISPLACEMENT
-	MatrixProduct(&theOrientation, &md->itsCenterpiecePlacement, &thePlacement);
-	thePlacementAsSIMD = ConvertMatrix44ToSIMD(thePlacement.m);
-#else
-	thePlacementAsSIMD = ConvertMatrix44ToSIMD(theOrientation.m);	//	translational component is zero
-#endif
-
-	theNumLevelsOfDetail = GetNumLevelsOfDetail(itsUnrotatedCenterpieceMeshSet);
-
-	for (theLevel = 0; theLevel < theNumLevelsOfDetail; theLevel++)
-	{
-		//	Make sure that this level of detail
-		//	is present in aRotatedCenterpieceMeshSet ...
-		if (aRotatedCenterpieceMeshSet->itsMeshes[theLevel] == nil)
-			aRotatedCenterpieceMeshSet->itsMeshes[theLevel] = MakeEmptyMesh();
-
-		//	... and that it contains buffers of the correct size.
-
-		theVertexBufferLengthInBytes	= [itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsVertexBuffer length];
-		theIndexBufferLengthInBytes		= [itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsIndexBuffer  length];
-
-		GEOMETRY_GAMES_ASSERT(theVertexBufferLengthInBytes > 0, "Source vertex buffer is empty");
-		GEOMETRY_GAMES_ASSERT(theIndexBufferLengthInBytes > 0,  "Source index buffer is empty" );
-
-		[self adjustSizeOfMesh:	aRotatedCenterpieceMeshSet->itsMeshes[theLevel]
-			 vertexBufferBytes:	theVertexBufferLengthInBytes
-			  indexBufferBytes:	theIndexBufferLengthInBytes];
-
-		//	Copy itsNumFacets.
-		aRotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsNumFacets = itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsNumFacets;
-
-		//	Copy the vertex data.
-		theSrcVertexData = (CurvedSpacesVertexData *) [itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsVertexBuffer contents];
-		theDstVertexData = (CurvedSpacesVertexData *) [aRotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsVertexBuffer contents];
-		memcpy(theDstVertexData, theSrcVertexData, theVertexBufferLengthInBytes);
-
-		//	Rotate the vertex data.
-		GEOMETRY_GAMES_ASSERT(
-			theVertexBufferLengthInBytes % sizeof(CurvedSpacesVertexData) == 0,
-			"The vertex buffer length is not an integer multiple of the CurvedSpacesVertexData size.");
-		theNumVertices = theVertexBufferLengthInBytes / sizeof(CurvedSpacesVertexData);
-		for (i = 0; i < theNumVertices; i++)
-		{
-			//	The SIMD library uses right-to-left matrix actions,
-			//	in contrast to our left-to-right actions.
-			//	So to realize our
-			//
-			//		(column vector) (matrix)
-			//
-			//	we need to pass simd_mul(matrix, row vector).
-			//
-			theDstVertexData[i].pos = simd_mul(thePlacementAsSIMD, theSrcVertexData[i].pos);
-		}
-
-		//	Copy the index data.
-		theSrcIndexData = (UInt16 (*)[3]) [itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsIndexBuffer contents];
-		theDstIndexData = (UInt16 (*)[3]) [aRotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsIndexBuffer contents];
-		memcpy(theDstIndexData, theSrcIndexData, theIndexBufferLengthInBytes);
-
-#ifdef CENTERPIECE_DISPLACEMENT
-		//	If itsCenterpiecePlacement has negative chirality,
-		//	then reverse the order of each triangle's indices,
-		//	so that aRotatedCenterpieceMeshSet always has
-		//	the same winding sense as itsUnrotatedCenterpieceMeshSet.
-		//
-		if (md->itsCenterpiecePlacement.itsParity == ImageNegative)
-		{
-			for (i = 0; i < aRotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsNumFacets; i++)
-			{
-				theSwapValue			= theDstIndexData[i][0];
-				theDstIndexData[i][0]	= theDstIndexData[i][2];
-				theDstIndexData[i][2]	= theSwapValue;
-			}
-		}
-#endif
+			break;
 
-		//	Copy itsCubeMapFlag.
-		aRotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsCubeMapFlag = itsUnrotatedCenterpieceMeshSet->itsMeshes[theLevel]->itsCubeMapFlag;
-	}
+		case CenterpieceGyroscope:
+			MatrixRotation(&theSpin, 0.0, 0.0, GYROSCOPE_SPEED * md->itsRotationAngle);
+			MatrixRotation(&theTilt, -PI/2, 0.0, 0.0);	//	takes gyroscope's spin axis from z-axis to y-axis
+			break;
 
-	//	Clear any unneeded levels of detail.
-	for (theLevel = theNumLevelsOfDetail; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
-	{
-		aRotatedCenterpieceMeshSet->itsMeshes[theLevel] = nil;
+#ifdef SHAPE_OF_SPACE_CH_7
+		case CenterpieceCube:
+			MatrixRotation(&theSpin, 0.0, 0.0, 0.0);
+			MatrixRotation(&theTilt, 0.0, 0.0, 0.0);
+			break;
+#endif
 	}
+	MatrixProduct(&theSpin, &theTilt, &theOrientation);
+#ifdef CENTERPIECE_DISPLACEMENT
+	MatrixProduct(&theOrientation, &md->itsCenterpiecePlacement, aPlacement);
+#else
+	*aPlacement = theOrientation;	//	translational component is zero
+#endif
 }
 
-- (void)writeTransformedObserverIntoMeshSet:(MeshSet *)aTransformedObserverMeshSet modelData:(ModelData *)md
+- (MeshSet *)sharedCenterpieceMeshSet:(CenterpieceType)aCenterpieceType
 {
-	NSUInteger				theVertexBufferLengthInBytes,
-							theIndexBufferLengthInBytes;
-	CurvedSpacesVertexData	*theSrcVertexData,
-							*theDstVertexData;
-	simd_float4x4			theUserBodyPlacementAsSIMD;
-	NSUInteger				theNumVertices;
-	unsigned int			i;
-	UInt16					(*theSrcIndexData)[3],
-							(*theDstIndexData)[3],
-							theSwapValue;
-	unsigned int			theLevel;
-
-	//	The observer mesh set has only one level of detail.
-	if (md->itsShowObserver)
-	{
-		//	Make sure that level of detail 0
-		//	is present in aTransformedObserverMeshSet ...
-		if (aTransformedObserverMeshSet->itsMeshes[0] == nil)
-			aTransformedObserverMeshSet->itsMeshes[0] = MakeEmptyMesh();
-
-		//	... and that it contains buffers of the correct size.
+	return [itsResourceCache
+		resourceForKey:	[NSString stringWithFormat:@"centerpiece mesh set %d", aCenterpieceType]
+		creator:		^id{
+							MeshSet	*theMeshSet;
 
-		theVertexBufferLengthInBytes	= [itsUntransformedObserverMeshSet->itsMeshes[0]->itsVertexBuffer length];
-		theIndexBufferLengthInBytes		= [itsUntransformedObserverMeshSet->itsMeshes[0]->itsIndexBuffer  length];
+							theMeshSet = MakeCenterpieceMeshSet(aCenterpieceType, self->itsDevice);
+							[self moveMeshSetToPrivateStorage:theMeshSet];
 
-		GEOMETRY_GAMES_ASSERT(theVertexBufferLengthInBytes > 0, "Source vertex buffer is empty");
-		GEOMETRY_GAMES_ASSERT(theIndexBufferLengthInBytes > 0,  "Source index buffer is empty" );
+							return theMeshSet;
+						}];
+}
 
-		[self adjustSizeOfMesh:	aTransformedObserverMeshSet->itsMeshes[0]
-			 vertexBufferBytes:	theVertexBufferLengthInBytes
-			  indexBufferBytes:	theIndexBufferLengthInBytes];
+- (MeshSet *)sharedObserverMeshSet
+{
+	return [itsResourceCache
+		resourceForKey:	@"observer mesh set"
+		creator:		^id{
+							MeshSet	*theMeshSet;
 
-		//	Copy itsNumFacets.
-		aTransformedObserverMeshSet->itsMeshes[0]->itsNumFacets = itsUntransformedObserverMeshSet->itsMeshes[0]->itsNumFacets;
+							theMeshSet = MakeObserverMeshSet(self->itsDevice);
+							[self moveMeshSetToPrivateStorage:theMeshSet];
 
-		//	Copy the vertex data.
-		theSrcVertexData = (CurvedSpacesVertexData *) [itsUntransformedObserverMeshSet->itsMeshes[0]->itsVertexBuffer contents];
-		theDstVertexData = (CurvedSpacesVertexData *) [aTransformedObserverMeshSet->itsMeshes[0]->itsVertexBuffer contents];
-		memcpy(theDstVertexData, theSrcVertexData, theVertexBufferLengthInBytes);
+							return theMeshSet;
+						}];
+}
 
-		//	Rotate the vertex data.
-		theUserBodyPlacementAsSIMD = ConvertMatrix44ToSIMD(md->itsUserBodyPlacement.m);
-		GEOMETRY_GAMES_ASSERT(
-			theVertexBufferLengthInBytes % sizeof(CurvedSpacesVertexData) == 0,
-			"The vertex buffer length is not an integer multiple of the CurvedSpacesVertexData size.");
-		theNumVertices = theVertexBufferLengthInBytes / sizeof(CurvedSpacesVertexData);
-		for (i = 0; i < theNumVertices; i++)
-		{
-			//	The SIMD library uses right-to-left matrix actions,
-			//	in contrast to our left-to-right actions.
-			//	So to realize our
-			//
-			//		(column vector) (matrix)
-			//
-			//	we need to pass simd_mul(matrix, row vector).
-			//
-			theDstVertexData[i].pos = simd_mul(theUserBodyPlacementAsSIMD, theSrcVertexData[i].pos);
-		}
+- (void)moveMeshSetToPrivateStorage:(MeshSet *)aMeshSet
+{
+	unsigned int					theLevel;
+	Mesh							*theMesh;
+	NSMutableArray<id<MTLBuffer>>	*theSharedBuffers;
+	NSArray<id<MTLBuffer>>			*thePrivateBuffers;
+	NSUInteger						i;
+
+	//	Once created, a centerpiece or observer mesh never changes,
+	//	because the vertex function applies its placement.
+	//	So keep it in private storage, where the GPU reads it fastest,
+	//	with all its levels-of-detail sub-allocated from a single heap.
+	//	itsResourceCache fills the private buffers before returning them,
+	//	so any renderer may draw from them at once.
+
+	theSharedBuffers = [[NSMutableArray<id<MTLBuffer>> alloc] initWithCapacity:2 * MAX_NUM_LOD_LEVELS];
+	for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+	{
+		theMesh = aMeshSet->itsMeshes[theLevel];
+		if (theMesh == nil)
+			continue;
 
-		//	Copy the index data.
-		theSrcIndexData = (UInt16 (*)[3]) [itsUntransformedObserverMeshSet->itsMeshes[0]->itsIndexBuffer contents];
-		theDstIndexData = (UInt16 (*)[3]) [aTransformedObserverMeshSet->itsMeshes[0]->itsIndexBuffer contents];
-		memcpy(theDstIndexData, theSrcIndexData, theIndexBufferLengthInBytes);
+		[theSharedBuffers addObject:theMesh->itsVertexBuffer];
+		[theSharedBuffers addObject:theMesh->itsIndexBuffer ];
+	}
 
-		//	If itsUserBodyPlacement has negative chirality,
-		//	then reverse the order of each triangle's indices,
-		//	so that aTransformedObserverMeshSet always has
-		//	the same winding sense as itsUntransformedObserverMeshSet.
-		//
-		if (md->itsUserBodyPlacement.itsParity == ImageNegative)
-		{
-			for (i = 0; i < aTransformedObserverMeshSet->itsMeshes[0]->itsNumFacets; i++)
-			{
-				theSwapValue			= theDstIndexData[i][0];
-				theDstIndexData[i][0]	= theDstIndexData[i][2];
-				theDstIndexData[i][2]	= theSwapValue;
-			}
-		}
+	thePrivateBuffers = [itsResourceCache privateCopiesOfBuffers:theSharedBuffers heap:&aMeshSet->itsHeap];
 
-		//	Copy itsCubeMapFlag.
-		aTransformedObserverMeshSet->itsMeshes[0]->itsCubeMapFlag = itsUntransformedObserverMeshSet->itsMeshes[0]->itsCubeMapFlag;
-	}
-	else	//	! itsShowObserver
+	i = 0;
+	for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
 	{
-		aTransformedObserverMeshSet->itsMeshes[0] = nil;
-	}
+		theMesh = aMeshSet->itsMeshes[theLevel];
+		if (theMesh == nil)
+			continue;
 
-	//	The remaining levels of detail should always be nil.
-	for (theLevel = 1; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
-		aTransformedObserverMeshSet->itsMeshes[theLevel] = nil;
+		theMesh->itsVertexBuffer	= thePrivateBuffers[i++];
+		theMesh->itsIndexBuffer		= thePrivateBuffers[i++];
+	}
 }
 
-- (void)adjustSizeOfMesh:	(Mesh *)aMesh
-	   vertexBufferBytes:	(NSUInteger)aRequiredVertexBufferLengthInBytes
-		indexBufferBytes:	(NSUInteger)aRequiredIndexBufferLengthInBytes
+- (MeshSet *)meshSetForSlot:(MeshSlot)aMeshSlot
 {
-	//	vertex buffer
-
-	if (aRequiredVertexBufferLengthInBytes > 0)
-	{
-		if (aMesh->itsVertexBuffer == nil
-		 || [aMesh->itsVertexBuffer length] != aRequiredVertexBufferLengthInBytes)
-		{
-			aMesh->itsVertexBuffer = [itsDevice
-				newBufferWithLength:	aRequiredVertexBufferLengthInBytes
-				options:				MTLResourceStorageModeShared];
-		}
-	}
-	else
-	{
-		aMesh->itsVertexBuffer = nil;
-	}
-
-	//	index buffer
-	
-	if (aRequiredIndexBufferLengthInBytes > 0)
-	{
-		if (aMesh->itsIndexBuffer == nil
-		 || [aMesh->itsIndexBuffer length] != aRequiredIndexBufferLengthInBytes)
-		{
-			aMesh->itsIndexBuffer = [itsDevice
-				newBufferWithLength:	aRequiredIndexBufferLengthInBytes
-				options:				MTLResourceStorageModeShared];
-		}
-	}
-	else
+	switch (aMeshSlot)
 	{
-		aMesh->itsIndexBuffer = nil;
+		case MeshSlotDirichletWalls:	return itsDirichletWallsMeshSet;
+		case MeshSlotVertexFigures:		return itsVertexFigureMeshSet;
+		case MeshSlotObserver:			return itsObserverMeshSet;
+		case MeshSlotCenterpiece:		return itsCenterpieceMeshSet;
+		case NumMeshSlots:				return nil;	//	never occurs
 	}
+	return nil;
 }
 
-
 @end
 
 
 static id<MTLRenderPipelineState> MakePipelineState(
-	id<MTLDevice>			aDevice,
+	CurvedSpacesGPUResourceCache	*aResourceCache,
 	MTLPixelFormat			aColorPixelFormat,
 	id<MTLLibrary>			aGPUFunctionLibrary,
 	bool					aMultisamplingFlag,
 	ShaderFogAndClipBoxType	aShaderFogAndClipBoxType,
 	bool					aCubeMapFlag,
-	bool					anAlphaBlendingFlag)
+	bool					anAlphaBlendingFlag,
+	bool					anApertureFlag,
+	unsigned int			aNumViews)		//	1, or MAX_NUM_VIEWS for a stereo pair
 {
 	MTLFunctionConstantValues	*theCompileTimeConstants;
-	uint32_t					theFogAndClipBoxType;
-	uint8_t						theCubeMapFlag;
+	uint32_t					theFogAndClipBoxType,
+								theNumViews;
+	uint8_t						theCubeMapFlag,
+								theApertureFlag;
 	id<MTLFunction>				theGPUVertexFunction,
 								theGPUFragmentFunction;
 	NSError						*theError;
@@ -1887,13 +3305,23 @@ static id<MTLRenderPipelineState> MakePipelineState(
 	theCompileTimeConstants	= [[MTLFunctionConstantValues alloc] init];
 	theFogAndClipBoxType	= aShaderFogAndClipBoxType;	//	copy to 32-bit variable, don't assume that aShaderFogAndClipBoxType is 32-bit
 	theCubeMapFlag			= aCubeMapFlag;				//	copy to  8-bit variable, don't assume that aCubeMapFlag is 8-bit
+	theApertureFlag			= anApertureFlag;			//	copy to  8-bit variable, don't assume that anApertureFlag is 8-bit
+	theNumViews				= aNumViews;				//	copy to 32-bit variable, don't assume that aNumViews is 32-bit
 	[theCompileTimeConstants setConstantValue:&theFogAndClipBoxType		type:MTLDataTypeUInt withName:@"gFogAndClipBoxType"	];
 	[theCompileTimeConstants setConstantValue:&theCubeMapFlag			type:MTLDataTypeBool withName:@"gUseCubeMap"		];
 	[theCompileTimeConstants setConstantValue:&theShapeOfSpaceFigure	type:MTLDataTypeUInt withName:@"gShapeOfSpaceFigure"];
+	[theCompileTimeConstants setConstantValue:&theApertureFlag			type:MTLDataTypeBool withName:@"gUseAperture"		];
+	[theCompileTimeConstants setConstantValue:&theNumViews				type:MTLDataTypeUInt withName:@"gNumViews"			];
 	theGPUVertexFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesVertexFunction"
 								constantValues:theCompileTimeConstants error:&theError];
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	theGPUFragmentFunction	= [aGPUFunctionLibrary newFunctionWithName:
+									(anAlphaBlendingFlag ? @"CurvedSpacesTransparentFragmentFunction" : @"CurvedSpacesFragmentFunction")
+								constantValues:theCompileTimeConstants error:&theError];
+#else
 	theGPUFragmentFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesFragmentFunction"
 								constantValues:theCompileTimeConstants error:&theError];
+#endif
 
 	//	vertex descriptor
 
@@ -1903,7 +3331,7 @@ static id<MTLRenderPipelineState> MakePipelineState(
 	[[theVertexDescriptor attributes][VertexAttributePosition] setBufferIndex:BufferIndexVertexAttributes];
 	[[theVertexDescriptor attributes][VertexAttributePosition] setOffset:offsetof(CurvedSpacesVertexData, pos)];
 
-	[[theVertexDescriptor attributes][VertexAttributeTexCoords] setFormat:MTLVertexFormatFloat3];
+	[[theVertexDescriptor attributes][VertexAttributeTexCoords] setFormat:MTLVertexFormatHalf3];
 	[[theVertexDescriptor attributes][VertexAttributeTexCoords] setBufferIndex:BufferIndexVertexAttributes];
 	[[theVertexDescriptor attributes][VertexAttributeTexCoords] setOffset:offsetof(CurvedSpacesVertexData, tex)];
 
@@ -1914,6 +3342,20 @@ static id<MTLRenderPipelineState> MakePipelineState(
 	[[theVertexDescriptor layouts][BufferIndexVertexAttributes] setStepFunction:MTLVertexStepFunctionPerVertex];
 	[[theVertexDescriptor layouts][BufferIndexVertexAttributes] setStride:sizeof(CurvedSpacesVertexData)];
 
+	if (anApertureFlag)
+	{
+		[[theVertexDescriptor attributes][VertexAttributeClosedPosition] setFormat:MTLVertexFormatFloat4];
+		[[theVertexDescriptor attributes][VertexAttributeClosedPosition] setBufferIndex:BufferIndexApertureAttributes];
+		[[theVertexDescriptor attributes][VertexAttributeClosedPosition] setOffset:offsetof(CurvedSpacesApertureVertexData, pos)];
+
+		[[theVertexDescriptor attributes][VertexAttributeClosedTexCoords] setFormat:MTLVertexFormatHalf2];
+		[[theVertexDescriptor attributes][VertexAttributeClosedTexCoords] setBufferIndex:BufferIndexApertureAttributes];
+		[[theVertexDescriptor attributes][VertexAttributeClosedTexCoords] setOffset:offsetof(CurvedSpacesApertureVertexData, tex)];
+
+		[[theVertexDescriptor layouts][BufferIndexApertureAttributes] setStepFunction:MTLVertexStepFunctionPerVertex];
+		[[theVertexDescriptor layouts][BufferIndexApertureAttributes] setStride:sizeof(CurvedSpacesApertureVertexData)];
+	}
+
 	//	pipeline state
 
 	thePipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
@@ -1923,9 +3365,51 @@ static id<MTLRenderPipelineState> MakePipelineState(
 	[thePipelineDescriptor setFragmentFunction:theGPUFragmentFunction];
 	[thePipelineDescriptor setVertexDescriptor:theVertexDescriptor];
 	[[thePipelineDescriptor colorAttachments][0] setPixelFormat:aColorPixelFormat];
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation]	setPixelFormat:TRANSPARENCY_ACCUMULATION_PIXEL_FORMAT];
+	[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage]	setPixelFormat:TRANSPARENCY_REVEALAGE_PIXEL_FORMAT	];
+#endif
 	[thePipelineDescriptor setDepthAttachmentPixelFormat:MTLPixelFormatDepth32Float];
 	[thePipelineDescriptor setStencilAttachmentPixelFormat:MTLPixelFormatInvalid];	//	redundant -- this is the default
 
+	//	A vertex function that writes [[ render_target_array_index ]]
+	//	must declare the class of primitives it draws.
+	if (aNumViews > 1)
+		[thePipelineDescriptor setInputPrimitiveTopology:MTLPrimitiveTopologyClassTriangle];
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+	//	Partially transparent surfaces leave the primary color attachment alone,
+	//	and instead add their weighted colors into the accumulation attachment
+	//	and multiply the revealage attachment by (1 - α).
+	//	Opaque surfaces leave the transparency attachments alone.
+	if (anAlphaBlendingFlag)
+	{
+		[[thePipelineDescriptor colorAttachments][0] setWriteMask:MTLColorWriteMaskNone];
+
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setBlendingEnabled:YES];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setRgbBlendOperation:MTLBlendOperationAdd];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setAlphaBlendOperation:MTLBlendOperationAdd];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setSourceRGBBlendFactor:MTLBlendFactorOne];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setSourceAlphaBlendFactor:MTLBlendFactorOne];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setDestinationRGBBlendFactor:MTLBlendFactorOne];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation] setDestinationAlphaBlendFactor:MTLBlendFactorOne];
+
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setBlendingEnabled:YES];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setRgbBlendOperation:MTLBlendOperationAdd];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setAlphaBlendOperation:MTLBlendOperationAdd];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setSourceRGBBlendFactor:MTLBlendFactorZero];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setSourceAlphaBlendFactor:MTLBlendFactorZero];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setDestinationRGBBlendFactor:MTLBlendFactorOneMinusSourceColor];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage] setDestinationAlphaBlendFactor:MTLBlendFactorOneMinusSourceColor];
+	}
+	else
+	{
+		[[thePipelineDescriptor colorAttachments][0] setBlendingEnabled:NO];	//	redundant -- this is the default
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyAccumulation]	setWriteMask:MTLColorWriteMaskNone];
+		[[thePipelineDescriptor colorAttachments][ColorAttachmentIndexTransparencyRevealage]	setWriteMask:MTLColorWriteMaskNone];
+	}
+#else
+
 	//	Alpha blending determines how the final fragment
 	//	blends in with the previous color buffer contents.
 	//	For opaque surfaces we may disable blending.
@@ -1947,16 +3431,262 @@ static id<MTLRenderPipelineState> MakePipelineState(
 	{
 		[[thePipelineDescriptor colorAttachments][0] setBlendingEnabled:NO];	//	redundant -- this is the default
 	}
+#endif
 
-	thePipelineState = [aDevice newRenderPipelineStateWithDescriptor:thePipelineDescriptor error:NULL];
+	thePipelineState = [aResourceCache newRenderPipelineStateWithDescriptor:thePipelineDescriptor];
 	
 	return thePipelineState;
 }
 
+static id<MTLRenderPipelineState> SharedPipelineState(
+	CurvedSpacesGPUResourceCache	*aResourceCache,
+	MTLPixelFormat					aColorPixelFormat,
+	id<MTLLibrary>					aGPUFunctionLibrary,
+	bool							aMultisamplingFlag,
+	ShaderFogAndClipBoxType			aShaderFogAndClipBoxType,
+	PipelineVariant					aPipelineVariant,
+	unsigned int					aNumViews)
+{
+	NSString	*theKey;
+
+	//	The key must capture every parameter that MakePipelineState() uses.
+	theKey = [NSString stringWithFormat:@"render pipeline %lu %d %d %d %u",
+				(unsigned long)aColorPixelFormat,
+				aMultisamplingFlag,
+				aShaderFogAndClipBoxType,
+				aPipelineVariant,
+				aNumViews];
+
+	return [aResourceCache
+		resourceForKey:	theKey
+		creator:		^id{ return MakePipelineState(aResourceCache, aColorPixelFormat, aGPUFunctionLibrary, aMultisamplingFlag,
+							aShaderFogAndClipBoxType,
+							aPipelineVariant == PipelineVariantCubeMap,
+							aPipelineVariant == PipelineVariantBlended,
+							aPipelineVariant == PipelineVariantAperture,
+							aNumViews); }];
+}
+
+static bool PipelineVariantIsUsed(
+	ShaderFogAndClipBoxType	aShaderFogAndClipBoxType,
+	PipelineVariant			aPipelineVariant)
+{
+	switch (aShaderFogAndClipBoxType)
+	{
+		case ShaderSphericalFogBoxFull:
+		case ShaderEuclideanFogBoxFull:
+		case ShaderHyperbolicFogBoxFull:
+		case ShaderNoFogBoxFull:
+			return true;
+
+		case ShaderSphericalFogBoxFront:
+		case ShaderSphericalFogBoxBack:
+		case ShaderNoFogBoxFront:
+		case ShaderNoFogBoxBack:
+			return (aPipelineVariant != PipelineVariantBlended);
+	}
+	return false;
+}
+
+static PipelineVariant GetPipelineVariant(
+	Mesh	*aMesh,
+	bool	anAlphaBlendingFlag)
+{
+	if (anAlphaBlendingFlag)
+		return PipelineVariantBlended;
+	else
+	if (aMesh->itsCubeMapFlag)
+		return PipelineVariantCubeMap;
+	else
+	if (aMesh->itsApertureBuffer != nil)
+		return PipelineVariantAperture;
+	else
+		return PipelineVariantPlain;
+}
+
+#if ORDER_INDEPENDENT_TRANSPARENCY
+
+static id<MTLRenderPipelineState> MakeTransparencyCompositePipelineState(
+	CurvedSpacesGPUResourceCache	*aResourceCache,
+	MTLPixelFormat					aColorPixelFormat,
+	id<MTLLibrary>					aGPUFunctionLibrary,
+	unsigned int					aNumViews)		//	1, or MAX_NUM_VIEWS for a stereo pair
+{
+	MTLFunctionConstantValues	*theCompileTimeConstants;
+	uint32_t					theNumViews;
+	id<MTLFunction>				theGPUVertexFunction,
+								theGPUFragmentFunction;
+	NSError						*theError;
+	MTLRenderPipelineDescriptor	*thePipelineDescriptor;
+
+	//	GPU functions
+
+	theCompileTimeConstants	= [[MTLFunctionConstantValues alloc] init];
+	theNumViews				= aNumViews;	//	copy to 32-bit variable, don't assume that aNumViews is 32-bit
+	[theCompileTimeConstants setConstantValue:&theNumViews type:MTLDataTypeUInt withName:@"gNumViews"];
+	theGPUVertexFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesFullScreenVertexFunction"
+								constantValues:theCompileTimeConstants error:&theError];
+	theGPUFragmentFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesCompositeFragmentFunction"
+								constantValues:theCompileTimeConstants error:&theError];
+
+	//	pipeline state
+	//
+	//		The composite pass draws into the resolved color texture,
+	//		so it never multisamples, and it needs no depth buffer.
+	//
+	thePipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
+	[thePipelineDescriptor setLabel:@"Curved Spaces transparency composite pipeline"];
+	[thePipelineDescriptor setSampleCount:1];
+	[thePipelineDescriptor setVertexFunction:  theGPUVertexFunction  ];
+	[thePipelineDescriptor setFragmentFunction:theGPUFragmentFunction];
+	[[thePipelineDescriptor colorAttachments][0] setPixelFormat:aColorPixelFormat];
+	[thePipelineDescriptor setDepthAttachmentPixelFormat:MTLPixelFormatInvalid];
+	if (aNumViews > 1)
+		[thePipelineDescriptor setInputPrimitiveTopology:MTLPrimitiveTopologyClassTriangle];
+
+	//	The composite fragment function returns a premultiplied color,
+	//	so use the same (1, 1 - α) blend factors as elsewhere.
+	[[thePipelineDescriptor colorAttachments][0] setBlendingEnabled:YES];
+	[[thePipelineDescriptor colorAttachments][0] setRgbBlendOperation:MTLBlendOperationAdd];
+	[[thePipelineDescriptor colorAttachments][0] setAlphaBlendOperation:MTLBlendOperationAdd];
+	[[thePipelineDescriptor colorAttachments][0] setSourceRGBBlendFactor:MTLBlendFactorOne];
+	[[thePipelineDescriptor colorAttachments][0] setSourceAlphaBlendFactor:MTLBlendFactorOne];
+	[[thePipelineDescriptor colorAttachments][0] setDestinationRGBBlendFactor:MTLBlendFactorOneMinusSourceAlpha];
+	[[thePipelineDescriptor colorAttachments][0] setDestinationAlphaBlendFactor:MTLBlendFactorOneMinusSourceAlpha];
+
+	return [aResourceCache newRenderPipelineStateWithDescriptor:thePipelineDescriptor];
+}
+
+#endif	//	ORDER_INDEPENDENT_TRANSPARENCY
+
+static id<MTLRenderPipelineState> MakeUpscalePipelineState(
+	CurvedSpacesGPUResourceCache	*aResourceCache,
+	MTLPixelFormat					aColorPixelFormat,
+	id<MTLLibrary>					aGPUFunctionLibrary,
+	unsigned int					aNumViews)		//	1, or MAX_NUM_VIEWS for a stereo pair
+{
+	MTLFunctionConstantValues	*theCompileTimeConstants;
+	uint32_t					theNumViews;
+	id<MTLFunction>				theGPUVertexFunction,
+								theGPUFragmentFunction;
+	NSError						*theError;
+	MTLRenderPipelineDescriptor	*thePipelineDescriptor;
+
+	//	GPU functions
+
+	theCompileTimeConstants	= [[MTLFunctionConstantValues alloc] init];
+	theNumViews				= aNumViews;	//	copy to 32-bit variable, don't assume that aNumViews is 32-bit
+	[theCompileTimeConstants setConstantValue:&theNumViews type:MTLDataTypeUInt withName:@"gNumViews"];
+	theGPUVertexFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesFullScreenVertexFunction"
+								constantValues:theCompileTimeConstants error:&theError];
+	theGPUFragmentFunction	= [aGPUFunctionLibrary newFunctionWithName:@"CurvedSpacesUpscaleFragmentFunction"
+								constantValues:theCompileTimeConstants error:&theError];
+
+	//	pipeline state
+	//
+	//		The upscale pass draws into the single-sample drawable,
+	//		replacing its contents, so it needs neither
+	//		multisampling nor blending nor a depth buffer.
+	//
+	thePipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
+	[thePipelineDescriptor setLabel:@"Curved Spaces upscale pipeline"];
+	[thePipelineDescriptor setSampleCount:1];
+	[thePipelineDescriptor setVertexFunction:  theGPUVertexFunction  ];
+	[thePipelineDescriptor setFragmentFunction:theGPUFragmentFunction];
+	[[thePipelineDescriptor colorAttachments][0] setPixelFormat:aColorPixelFormat];
+	[[thePipelineDescriptor colorAttachments][0] setBlendingEnabled:NO];
+	[thePipelineDescriptor setDepthAttachmentPixelFormat:MTLPixelFormatInvalid];
+	if (aNumViews > 1)
+		[thePipelineDescriptor setInputPrimitiveTopology:MTLPrimitiveTopologyClassTriangle];
+
+	return [aResourceCache newRenderPipelineStateWithDescriptor:thePipelineDescriptor];
+}
+
+static id<MTLTexture> MakeRenderTargetTexture(
+	id<MTLDevice>	aDevice,
+	MTLPixelFormat	aPixelFormat,
+	NSUInteger		aWidth,
+	NSUInteger		aHeight,
+	unsigned int	aNumViews,
+	bool			aMultisamplingFlag)
+{
+	MTLTextureDescriptor	*theDescriptor;
+
+	theDescriptor = [MTLTextureDescriptor
+		texture2DDescriptorWithPixelFormat:	aPixelFormat
+		width:								aWidth
+		height:								aHeight
+		mipmapped:							NO];
+	[theDescriptor setStorageMode:MTLStorageModePrivate];
+
+	if (aMultisamplingFlag)
+	{
+		//	Only the render pass itself touches the multisample textures.
+		[theDescriptor setUsage:MTLTextureUsageRenderTarget];
+		[theDescriptor setSampleCount:METAL_MULTISAMPLING_NUM_SAMPLES];
+		if (aNumViews > 1)
+		{
+			//	-setUpGraphicsWithModelData: has already checked
+			//	that layered multisampling is available.
+			if (@available(iOS 14.0, macOS 10.14, *))
+			{
+				[theDescriptor setTextureType:MTLTextureType2DMultisampleArray];
+				[theDescriptor setArrayLength:aNumViews];
+			}
+		}
+		else
+			[theDescriptor setTextureType:MTLTextureType2DMultisample];
+	}
+	else
+	{
+		//	The transparency composite pass and the upscale pass
+		//	read the single-sample textures.
+		[theDescriptor setUsage:(MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead)];
+		if (aNumViews > 1)
+		{
+			[theDescriptor setTextureType:MTLTextureType2DArray];
+			[theDescriptor setArrayLength:aNumViews];
+		}
+	}
+
+	return [aDevice newTextureWithDescriptor:theDescriptor];
+}
+
+static id<MTLComputePipelineState> MakeComputePipelineState(
+	CurvedSpacesGPUResourceCache	*aResourceCache,
+	id<MTLLibrary>					aGPUFunctionLibrary,
+	NSString						*aFunctionName)
+{
+	id<MTLFunction>					theGPUComputeFunction;
+	MTLComputePipelineDescriptor	*thePipelineDescriptor;
+
+	theGPUComputeFunction = [aGPUFunctionLibrary newFunctionWithName:aFunctionName];
+	if (theGPUComputeFunction == nil)
+		return nil;
+
+	thePipelineDescriptor = [[MTLComputePipelineDescriptor alloc] init];
+	[thePipelineDescriptor setLabel:aFunctionName];
+	[thePipelineDescriptor setComputeFunction:theGPUComputeFunction];
+
+	return [aResourceCache newComputePipelineStateWithDescriptor:thePipelineDescriptor];
+}
+
+static id<MTLComputePipelineState> SharedComputePipelineState(
+	CurvedSpacesGPUResourceCache	*aResourceCache,
+	id<MTLLibrary>					aGPUFunctionLibrary,
+	NSString						*aFunctionName)
+{
+	return [aResourceCache
+		resourceForKey:	[@"compute pipeline " stringByAppendingString:aFunctionName]
+		creator:		^id{ return MakeComputePipelineState(aResourceCache, aGPUFunctionLibrary, aFunctionName); }];
+}
+
 
 static TilingBufferSet *MakeEmptyTilingBufferSet(void)
 {
 	TilingBufferSet	*theTilingBufferSet;
+	unsigned int	theSlot,
+					theLevel;
 	
 	theTilingBufferSet = [[TilingBufferSet alloc] init];
 
@@ -1968,6 +3698,24 @@ static TilingBufferSet *MakeEmptyTilingBufferSet(void)
 	theTilingBufferSet->itsReflectedFrontToBackTilingBuffer	= nil;
 	theTilingBufferSet->itsFullBackToFrontTilingBuffer		= nil;
 
+	for (theSlot = 0; theSlot < NumMeshSlots; theSlot++)
+	{
+		for (theLevel = 0; theLevel <= MAX_NUM_LOD_LEVELS; theLevel++)
+		{
+			theTilingBufferSet->itsPlainLevelCutoffs[theSlot][theLevel]		= 0;
+			theTilingBufferSet->itsReflectedLevelCutoffs[theSlot][theLevel]	= 0;
+		}
+	}
+
+	theTilingBufferSet->itsGPUCullingFlag	= false;
+	theTilingBufferSet->itsNumCells			= 0;
+	theTilingBufferSet->itsSortSize			= 0;
+
+	theTilingBufferSet->itsCellBuffer			= nil;
+	theTilingBufferSet->itsCullUniformBuffer	= nil;
+	theTilingBufferSet->itsSortEntryBuffer		= nil;
+	theTilingBufferSet->itsCullResultBuffer		= nil;
+
 	return theTilingBufferSet;
 }
 
@@ -1994,7 +3742,9 @@ static Mesh *MakeEmptyMesh(void)
 	theMesh->itsNumFacets		= 0;
 	theMesh->itsVertexBuffer	= nil;
 	theMesh->itsIndexBuffer		= nil;
+	theMesh->itsApertureBuffer	= nil;
 	theMesh->itsCubeMapFlag		= false;
+	theMesh->itsMaxError		= 0.0;
 	
 	return theMesh;
 }
@@ -2004,40 +3754,21 @@ static void RefreshDirichletWalls(
 	id<MTLDevice>	aDevice,	//	input
 	ModelData		*md)		//	input
 {
-	unsigned int	theNumMeshVertices				= 0;
-	double			(*theMeshVertexPositions)[4]	= NULL,
-					(*theMeshVertexTexCoords)[3]	= NULL,	//	last tex coord is always zero, because we don't use a cube map texture
-					(*theMeshVertexColors)[4]		= NULL;	//	premultiplied alpha
-	unsigned int	theNumMeshFacets				= 0,
-					(*theMeshFacets)[3]				= NULL,
+	unsigned int	theNumMeshVertices,
+					theNumMeshFacets,
 					theLevel;
+	MeshBuffers		theMeshBuffers;
 
 
-	//	itsMeshes[0] should be present iff
-	//
-	//		a Dirichlet domain is present
-	//	and
-	//		the aperture is at least partly closed.
-	//
-	if (md->itsDirichletDomain == NULL	//	Dirichlet domain not present
-	 || md->itsAperture == 1.0)			//	aperture fully open (meaning walls are completely invisible)
+	//	itsMeshes[0] should be present iff a Dirichlet domain is present.
+	//	-encodeCommandsToCommandBuffer:… skips the walls
+	//	when the aperture is fully open.
+	if (md->itsDirichletDomain == NULL)	//	Dirichlet domain not present
 	{
 		aMeshSet->itsMeshes[0] = nil;
 	}
-	else	//	Dirichlet domain is present and visible
+	else	//	Dirichlet domain is present
 	{
-		//	Create a mesh for the Dirichlet domain
-		//	with windows cut in its walls.
-		MakeDirichletMesh(	md->itsDirichletDomain,
-							md->itsAperture,
-							md->itsShowColorCoding,
-							&theNumMeshVertices,
-							&theMeshVertexPositions,
-							&theMeshVertexTexCoords,
-							&theMeshVertexColors,
-							&theNumMeshFacets,
-							&theMeshFacets);
-
 		//	The Dirichlet domain walls are kept in a single Mesh object,
 		//	(containing one vertex buffer and one index buffer),
 		//	not a series of "inflight" Mesh objects.
@@ -2045,8 +3776,9 @@ static void RefreshDirichletWalls(
 		//	that the GPU might currently be using.
 		//	To rigorously avoid trouble, let's create a new Mesh object
 		//	each time RefreshDirichletWalls() gets called.
-		//	This may be less efficient, but users spend only
-		//	a small amount of time adjusting the aperture size,
+		//	This may be less efficient, but RefreshDirichletWalls()
+		//	gets called only when the Dirichlet domain or its
+		//	color coding changes -- not when the aperture changes --
 		//	so the inefficiency is unlikely to be significant.
 		//
 		//		Comment:  Standard practice seems to be
@@ -2060,23 +3792,22 @@ static void RefreshDirichletWalls(
 		//		between the CPU and the GPU, even if
 		//		buffers in shared memory could be allocated quickly?)
 		//
-		aMeshSet->itsMeshes[0] = MakeMeshFromArrays(
+		CountDirichletMesh(md->itsDirichletDomain, &theNumMeshVertices, &theNumMeshFacets);
+		aMeshSet->itsMeshes[0] = MakeMeshForBuilder(
 									aDevice,
 									theNumMeshVertices,
-									theMeshVertexPositions,
-									theMeshVertexTexCoords,
-									theMeshVertexColors,
 									theNumMeshFacets,
-									theMeshFacets,
-									false);	//	traditional texture (not a cube map)
-		
-		//	Free the Dirichlet mesh data.
-		FreeDirichletMesh(	&theNumMeshVertices,
-							&theMeshVertexPositions,
-							&theMeshVertexTexCoords,
-							&theMeshVertexColors,
-							&theNumMeshFacets,
-							&theMeshFacets);
+									true,	//	with apertures
+									false,	//	traditional texture (not a cube map)
+									&theMeshBuffers);
+
+		//	Let the platform-independent code write the mesh
+		//	for the Dirichlet domain with windows cut in its walls
+		//	directly into the Metal buffers.  The mesh gives
+		//	each vertex's position with the aperture fully open
+		//	and fully closed, and the vertex function
+		//	interpolates between them.
+		WriteDirichletMesh(md->itsDirichletDomain, md->itsShowColorCoding, &theMeshBuffers);
 	}
 	
 	//	The Dirichlet domain walls never need any additional levels of detail.
@@ -2084,7 +3815,6 @@ static void RefreshDirichletWalls(
 		aMeshSet->itsMeshes[theLevel] = nil;
 }
 
-
 static MeshSet *MakeCenterpieceMeshSet(
 	CenterpieceType	aCenterpieceType,
 	id<MTLDevice>	aDevice)
@@ -2106,13 +3836,10 @@ static MeshSet *MakeEarthMeshSet(
 {
 	MeshSet			*theMeshSet;
 	unsigned int	theLevel,
-					theNumSubdivisions;
-	unsigned int	theNumMeshVertices				= 0;
-	double			(*theMeshVertexPositions)[4]	= NULL,
-					(*theMeshVertexTexCoords)[3]	= NULL,	//	3 tex coords for cube map texture
-					(*theMeshVertexColors)[4]		= NULL;	//	premultiplied alpha
-	unsigned int	theNumMeshFacets				= 0,
-					(*theMeshFacets)[3]				= NULL;
+					theNumSubdivisions,
+					theNumMeshVertices,
+					theNumMeshFacets;
+	MeshBuffers		theMeshBuffers;
 
 	static const unsigned int	theNumLevels		= 4;
 	static const double			theWhiteColor[4]	= {1.0, 1.0, 1.0, 1.0};	//	pre-multiplied (αR, αG, αB, α)
@@ -2131,51 +3858,27 @@ static MeshSet *MakeEarthMeshSet(
 		//	Level 3 holds the coarsest subdivision (a plain dodecahedron).
 		theNumSubdivisions = (theNumLevels - 1) - theLevel;
 		
-		//	Let the platform-independent code create the mesh
-		//	and return the data as C arrays
-		//	(which we must free when we're done with them).
-		//
-		//		Design note:  Each call to MakeSphereMesh()
-		//		generates all the subdivisions.  We don't mind
-		//		the inefficiency, because this MakeEarthMeshSet() method
-		//		gets called only once.  The simplicity of the code
-		//		is more important.
-		//
-		MakeSphereMesh(	EARTH_RADIUS,
-						theNumSubdivisions,
-						theWhiteColor,
-						&theNumMeshVertices,
-						&theMeshVertexPositions,
-						&theMeshVertexTexCoords,
-						&theMeshVertexColors,
-						&theNumMeshFacets,
-						&theMeshFacets);
-
-		//	Use the C arrays to construct a Mesh object for this level.
-		theMeshSet->itsMeshes[theLevel] = MakeMeshFromArrays(
+		//	Allocate a Mesh object of the right size for this level,
+		//	and let the platform-independent code write the mesh
+		//	directly into its Metal buffers.
+		CountSphereMesh(theNumSubdivisions, &theNumMeshVertices, &theNumMeshFacets);
+		theMeshSet->itsMeshes[theLevel] = MakeMeshForBuilder(
 												aDevice,
 												theNumMeshVertices,
-												theMeshVertexPositions,
-												theMeshVertexTexCoords,
-												theMeshVertexColors,
 												theNumMeshFacets,
-												theMeshFacets,
-												true);	//	The sphere mesh uses a cube map texture
+												false,	//	no apertures
+												true,	//	The sphere mesh uses a cube map texture
+												&theMeshBuffers);
+		WriteSphereMesh(EARTH_RADIUS, theNumSubdivisions, theWhiteColor, &theMeshBuffers);
 
-		//	Free the temporary C arrays.
-		FreeSphereMesh(	&theNumMeshVertices,
-						&theMeshVertexPositions,
-						&theMeshVertexTexCoords,
-						&theMeshVertexColors,
-						&theNumMeshFacets,
-						&theMeshFacets);
+		//	Let the level-of-detail code know how coarse this level is.
+		theMeshSet->itsMeshes[theLevel]->itsMaxError = SphereMeshError(EARTH_RADIUS, theNumSubdivisions);
 	}
 
 	//	All done!
 	return theMeshSet;
 }
 
-
 static MeshSet *MakeGalaxyMeshSet(
 	id<MTLDevice>	aDevice)
 {
@@ -2184,10 +3887,10 @@ static MeshSet *MakeGalaxyMeshSet(
 
 	const CurvedSpacesVertexData	theSquareVertices[4] =
 	{
-		{{-GALAXY_RADIUS, -GALAXY_RADIUS, 0.0, 1.0}, {0.0, 1.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
-		{{-GALAXY_RADIUS, +GALAXY_RADIUS, 0.0, 1.0}, {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
-		{{+GALAXY_RADIUS, -GALAXY_RADIUS, 0.0, 1.0}, {1.0, 1.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
-		{{+GALAXY_RADIUS, +GALAXY_RADIUS, 0.0, 1.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}}
+		{{-GALAXY_RADIUS, -GALAXY_RADIUS, 0.0, 1.0}, {0.0, 1.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
+		{{-GALAXY_RADIUS, +GALAXY_RADIUS, 0.0, 1.0}, {0.0, 0.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
+		{{+GALAXY_RADIUS, -GALAXY_RADIUS, 0.0, 1.0}, {1.0, 1.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}},
+		{{+GALAXY_RADIUS, +GALAXY_RADIUS, 0.0, 1.0}, {1.0, 0.0, 0.0, 0.0}, {1.0, 1.0, 1.0, 1.0}}
 	};
 	
 	const UInt16					theSquareFacets[2][3] =
@@ -2222,93 +3925,50 @@ static MeshSet *MakeGyroscopeMeshSet(
 	id<MTLDevice>	aDevice)
 {
 	MeshSet			*theMeshSet;
-	unsigned int	theNumMeshVertices				= 0;
-	double			(*theMeshVertexPositions)[4]	= NULL,
-					(*theMeshVertexTexCoords)[3]	= NULL,	//	last tex coord is always zero, because we don't use a cube map texture
-					(*theMeshVertexColors)[4]		= NULL;	//	premultiplied alpha
-	unsigned int	theNumMeshFacets				= 0,
-					(*theMeshFacets)[3]				= NULL;
+	unsigned int	theNumMeshVertices,
+					theNumMeshFacets;
+	MeshBuffers		theMeshBuffers;
 
 	theMeshSet = MakeEmptyMeshSet();
 
-	//	Let the platform-independent code create the mesh
-	//	and return the data as C arrays
-	//	(which we must free when we're done with them).
-	//
-	MakeGyroscopeMesh(	&theNumMeshVertices,
-						&theMeshVertexPositions,
-						&theMeshVertexTexCoords,
-						&theMeshVertexColors,
-						&theNumMeshFacets,
-						&theMeshFacets);
-
-	//	Use the C arrays to construct a Mesh object.
-	theMeshSet->itsMeshes[0] = MakeMeshFromArrays(
+	//	Let the platform-independent code write the mesh
+	//	directly into the new Mesh object's Metal buffers.
+	CountGyroscopeMesh(&theNumMeshVertices, &theNumMeshFacets);
+	theMeshSet->itsMeshes[0] = MakeMeshForBuilder(
 								aDevice,
 								theNumMeshVertices,
-								theMeshVertexPositions,
-								theMeshVertexTexCoords,
-								theMeshVertexColors,
 								theNumMeshFacets,
-								theMeshFacets,
-								false);	//	traditional texture (not a cube map)
-
-	//	Free the temporary C arrays.
-	FreeGyroscopeMesh(	&theNumMeshVertices,
-						&theMeshVertexPositions,
-						&theMeshVertexTexCoords,
-						&theMeshVertexColors,
-						&theNumMeshFacets,
-						&theMeshFacets);
+								false,	//	no apertures
+								false,	//	traditional texture (not a cube map)
+								&theMeshBuffers);
+	WriteGyroscopeMesh(&theMeshBuffers);
 	
 	return theMeshSet;
 }
 
-
 #ifdef SHAPE_OF_SPACE_CH_7
 
 static MeshSet *MakeCubeMeshSet(
 	id<MTLDevice>	aDevice)
 {
 	MeshSet			*theMeshSet;
-	unsigned int	theNumMeshVertices				= 0;
-	double			(*theMeshVertexPositions)[4]	= NULL,
-					(*theMeshVertexTexCoords)[3]	= NULL,	//	last tex coord is always zero, because we don't use a cube map texture
-					(*theMeshVertexColors)[4]		= NULL;	//	premultiplied alpha
-	unsigned int	theNumMeshFacets				= 0,
-					(*theMeshFacets)[3]				= NULL;
+	unsigned int	theNumMeshVertices,
+					theNumMeshFacets;
+	MeshBuffers		theMeshBuffers;
 
 	theMeshSet = MakeEmptyMeshSet();
 
-	//	Let the platform-independent code create the mesh
-	//	and return the data as C arrays
-	//	(which we must free when we're done with them).
-	//
-	MakeCubeMesh(	&theNumMeshVertices,
-					&theMeshVertexPositions,
-					&theMeshVertexTexCoords,
-					&theMeshVertexColors,
-					&theNumMeshFacets,
-					&theMeshFacets);
-
-	//	Use the C arrays to construct a Mesh object.
-	theMeshSet->itsMeshes[0] = MakeMeshFromArrays(
+	//	Let the platform-independent code write the mesh
+	//	directly into the new Mesh object's Metal buffers.
+	CountCubeMesh(&theNumMeshVertices, &theNumMeshFacets);
+	theMeshSet->itsMeshes[0] = MakeMeshForBuilder(
 								aDevice,
 								theNumMeshVertices,
-								theMeshVertexPositions,
-								theMeshVertexTexCoords,
-								theMeshVertexColors,
 								theNumMeshFacets,
-								theMeshFacets,
-								false);	//	traditional texture (not a cube map)
-
-	//	Free the temporary C arrays.
-	FreeCubeMesh(	&theNumMeshVertices,
-					&theMeshVertexPositions,
-					&theMeshVertexTexCoords,
-					&theMeshVertexColors,
-					&theNumMeshFacets,
-					&theMeshFacets);
+								false,	//	no apertures
+								false,	//	traditional texture (not a cube map)
+								&theMeshBuffers);
+	WriteCubeMesh(&theMeshBuffers);
 	
 	return theMeshSet;
 }
@@ -2321,53 +3981,30 @@ static MeshSet *MakeVertexFigureMeshSet(
 	ModelData		*md)
 {
 	MeshSet			*theMeshSet;
-	unsigned int	theNumMeshVertices				= 0;
-	double			(*theMeshVertexPositions)[4]	= NULL,
-					(*theMeshVertexTexCoords)[3]	= NULL,	//	last tex coord is always zero, because we don't use a cube map texture
-					(*theMeshVertexColors)[4]		= NULL;	//	premultiplied alpha
-	unsigned int	theNumMeshFacets				= 0,
-					(*theMeshFacets)[3]				= NULL;
+	unsigned int	theNumMeshVertices,
+					theNumMeshFacets;
+	MeshBuffers		theMeshBuffers;
 
 	theMeshSet = MakeEmptyMeshSet();
 
 	if (md->itsDirichletDomain != NULL)
 	{
-		//	Let the platform-independent code create the mesh
-		//	and return the data as C arrays
-		//	(which we must free when we're done with them).
-		//
-		MakeVertexFigureMesh(	md->itsDirichletDomain,
-								&theNumMeshVertices,
-								&theMeshVertexPositions,
-								&theMeshVertexTexCoords,
-								&theMeshVertexColors,
-								&theNumMeshFacets,
-								&theMeshFacets);
-
-		//	Use the C arrays to construct a Mesh object.
-		theMeshSet->itsMeshes[0] = MakeMeshFromArrays(
+		//	Let the platform-independent code write the mesh
+		//	directly into the new Mesh object's Metal buffers.
+		CountVertexFigureMesh(md->itsDirichletDomain, &theNumMeshVertices, &theNumMeshFacets);
+		theMeshSet->itsMeshes[0] = MakeMeshForBuilder(
 									aDevice,
 									theNumMeshVertices,
-									theMeshVertexPositions,
-									theMeshVertexTexCoords,
-									theMeshVertexColors,
 									theNumMeshFacets,
-									theMeshFacets,
-									false);	//	traditional texture (not a cube map)
-
-		//	Free the temporary C arrays.
-		FreeVertexFigureMesh(	&theNumMeshVertices,
-								&theMeshVertexPositions,
-								&theMeshVertexTexCoords,
-								&theMeshVertexColors,
-								&theNumMeshFacets,
-								&theMeshFacets);
+									false,	//	no apertures
+									false,	//	traditional texture (not a cube map)
+									&theMeshBuffers);
+		WriteVertexFigureMesh(md->itsDirichletDomain, &theMeshBuffers);
 	}
 	
 	return theMeshSet;
 }
 
-
 static MeshSet *MakeObserverMeshSet(
 	id<MTLDevice>	aDevice)
 {
@@ -2379,38 +4016,38 @@ static MeshSet *MakeObserverMeshSet(
 	const CurvedSpacesVertexData	theObserverVertices[4*4 + 8] =
 									{
 										//	left fletch
-										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
-										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
-										{{-DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
-										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
+										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
+										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
+										{{-DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
+										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_LEFT	},
 
 										//	right fletch
-										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
-										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
-										{{+DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
-										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
+										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
+										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
+										{{+DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
+										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_RIGHT	},
 
 										//	bottom fletch
-										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
-										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
-										{{ 0.0,              -DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
-										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
+										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
+										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
+										{{ 0.0,              -DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
+										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_BOTTOM	},
 
 										//	top fletch
-										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
-										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
-										{{ 0.0,              +DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_TOP		},
-										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_FLETCH_TOP		},
+										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
+										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
+										{{ 0.0,              +DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
+										{{ 0.0,               0.0,              +DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_FLETCH_TOP		},
 										
 										//	tail
-										{{-DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_TAIL			},
-										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
-										{{ 0.0,              -DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_TAIL			},
-										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
-										{{+DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_TAIL			},
-										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
-										{{ 0.0,              +DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0}, DART_COLOR_TAIL			},
-										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{-DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{-DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{ 0.0,              -DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{+DART_INNER_WIDTH, -DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{+DART_OUTER_WIDTH,  0.0,              -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{+DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{ 0.0,              +DART_OUTER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 1.0, 0.0, 0.0}, DART_COLOR_TAIL			},
+										{{-DART_INNER_WIDTH, +DART_INNER_WIDTH, -DART_HALF_LENGTH, 1.0}, {0.0, 0.0, 0.0, 0.0}, DART_COLOR_TAIL			},
 									};
 	
 	const UInt16					theObserverFacets[4*2 + 6][3] =
@@ -2462,23 +4099,21 @@ static MeshSet *MakeObserverMeshSet(
 }
 
 
-static Mesh *MakeMeshFromArrays(
+static Mesh *MakeMeshForBuilder(
 	id<MTLDevice>	aDevice,
 	unsigned int	aNumMeshVertices,
-	double			(*someMeshVertexPositions)[4],
-	double			(*someMeshVertexTexCoords)[3],
-	double			(*someMeshVertexColors)[4],
 	unsigned int	aNumMeshFacets,
-	unsigned int	(*someMeshFacets)[3],
-	bool			aCubeMapFlag)
+	bool			anApertureFlag,
+	bool			aCubeMapFlag,
+	MeshBuffers		*someMeshBuffers)	//	output;	tells a WriteXxxMesh() function where to write
 {
-	Mesh					*theMesh;
-	unsigned int			theNumRequiredVertexBufferBytes,
-							theNumRequiredIndexBufferBytes;
-	CurvedSpacesVertexData	*theVertexBufferData;
-	UInt16					(*theIndexBufferData)[3];
-	unsigned int			i,
-							j;
+	Mesh			*theMesh;
+	Byte			*theVertexBufferData,
+					*theApertureBufferData;
+
+	GEOMETRY_GAMES_ASSERT(
+		aNumMeshVertices <= 0x10000,
+		"Too many vertices for 16-bit indices");
 
 	//	Create a new empty Mesh.
 	theMesh = MakeEmptyMesh();
@@ -2487,43 +4122,90 @@ static Mesh *MakeMeshFromArrays(
 	theMesh->itsNumFacets = aNumMeshFacets;
 
 	//	Allocate the Metal vertex buffer.
-	theNumRequiredVertexBufferBytes	= aNumMeshVertices * sizeof(CurvedSpacesVertexData);
 	theMesh->itsVertexBuffer = [aDevice
-		newBufferWithLength:	theNumRequiredVertexBufferBytes
+		newBufferWithLength:	aNumMeshVertices * sizeof(CurvedSpacesVertexData)
 		options:				MTLResourceStorageModeShared];
 
 	//	Allocate the Metal index buffer.
-	theNumRequiredIndexBufferBytes	= aNumMeshFacets * sizeof(UInt16 [3]);
 	theMesh->itsIndexBuffer = [aDevice
-		newBufferWithLength:	theNumRequiredIndexBufferBytes
+		newBufferWithLength:	aNumMeshFacets * sizeof(UInt16 [3])
 		options:				MTLResourceStorageModeShared];
 
-	//	Copy the mesh data into the Metal buffers.
+	//	A mesh with apertures also needs the positions
+	//	and texture coordinates for a fully closed aperture.
+	if (anApertureFlag)
+	{
+		theMesh->itsApertureBuffer = [aDevice
+			newBufferWithLength:	aNumMeshVertices * sizeof(CurvedSpacesApertureVertexData)
+			options:				MTLResourceStorageModeShared];
+	}
+
+	//	Does the mesh expect a cube map texture?
+	theMesh->itsCubeMapFlag = aCubeMapFlag;
+
+	//	Describe the Metal buffers' layout, so the platform-independent code
+	//	can write the mesh directly into them, with no intermediate arrays.
+
+	theVertexBufferData = (Byte *) [theMesh->itsVertexBuffer contents];
+
+	someMeshBuffers->itsPositions.itsBase		= theVertexBufferData + offsetof(CurvedSpacesVertexData, pos);
+	someMeshBuffers->itsPositions.itsStride		= sizeof(CurvedSpacesVertexData);
+	someMeshBuffers->itsPositions.itsType		= MeshComponentFloat;
 
-	theVertexBufferData = (CurvedSpacesVertexData *) [theMesh->itsVertexBuffer contents];
-	for (i = 0; i < aNumMeshVertices; i++)
+	someMeshBuffers->itsTexCoords.itsBase		= theVertexBufferData + offsetof(CurvedSpacesVertexData, tex);
+	someMeshBuffers->itsTexCoords.itsStride		= sizeof(CurvedSpacesVertexData);
+	someMeshBuffers->itsTexCoords.itsType		= MeshComponentHalf;
+
+	someMeshBuffers->itsColors.itsBase			= theVertexBufferData + offsetof(CurvedSpacesVertexData, col);
+	someMeshBuffers->itsColors.itsStride		= sizeof(CurvedSpacesVertexData);
+	someMeshBuffers->itsColors.itsType			= MeshComponentHalf;
+
+	if (anApertureFlag)
 	{
-		for (j = 0; j < 4; j++)
-			theVertexBufferData[i].pos[j] = someMeshVertexPositions[i][j];
+		theApertureBufferData = (Byte *) [theMesh->itsApertureBuffer contents];
 
-		for (j = 0; j < 3; j++)
-			theVertexBufferData[i].tex[j] = someMeshVertexTexCoords[i][j];
+		someMeshBuffers->itsClosedPositions.itsBase		= theApertureBufferData + offsetof(CurvedSpacesApertureVertexData, pos);
+		someMeshBuffers->itsClosedPositions.itsStride	= sizeof(CurvedSpacesApertureVertexData);
+		someMeshBuffers->itsClosedPositions.itsType		= MeshComponentFloat;
 
-		for (j = 0; j < 4; j++)
-			theVertexBufferData[i].col[j] = someMeshVertexColors[i][j];
+		someMeshBuffers->itsClosedTexCoords.itsBase		= theApertureBufferData + offsetof(CurvedSpacesApertureVertexData, tex);
+		someMeshBuffers->itsClosedTexCoords.itsStride	= sizeof(CurvedSpacesApertureVertexData);
+		someMeshBuffers->itsClosedTexCoords.itsType		= MeshComponentHalf;
 	}
+	else
+	{
+		someMeshBuffers->itsClosedPositions.itsBase		= NULL;
+		someMeshBuffers->itsClosedPositions.itsStride	= 0;
+		someMeshBuffers->itsClosedPositions.itsType		= MeshComponentFloat;
 
-	theIndexBufferData = (UInt16 (*)[3]) [theMesh->itsIndexBuffer contents];
-	for (i = 0; i < aNumMeshFacets; i++)
-		for (j = 0; j < 3; j++)
-			theIndexBufferData[i][j] = someMeshFacets[i][j];
+		someMeshBuffers->itsClosedTexCoords.itsBase		= NULL;
+		someMeshBuffers->itsClosedTexCoords.itsStride	= 0;
+		someMeshBuffers->itsClosedTexCoords.itsType		= MeshComponentHalf;
+	}
 
-	//	Does the mesh expect a cube map texture?
-	theMesh->itsCubeMapFlag = aCubeMapFlag;
+	someMeshBuffers->itsFacets		= [theMesh->itsIndexBuffer contents];
+	someMeshBuffers->itsIndexType	= MeshIndexUInt16;
 	
 	return theMesh;
 }
 
+static void WriteMeshSetIndexCounts(
+	MeshSet		*aMeshSet,
+	uint32_t	someIndexCounts[MAX_NUM_LOD_LEVELS])	//	output
+{
+	unsigned int	i;
+
+	//	Record each level of detail's index count for the GPU,
+	//	with 0 for each absent level.
+	for (i = 0; i < MAX_NUM_LOD_LEVELS; i++)
+	{
+		if (aMeshSet != nil && aMeshSet->itsMeshes[i] != nil)
+			someIndexCounts[i] = 3 * aMeshSet->itsMeshes[i]->itsNumFacets;
+		else
+			someIndexCounts[i] = 0;
+	}
+}
+
 
 static unsigned int GetNumLevelsOfDetail(
 	MeshSet	*aMeshSet)
@@ -2560,3 +4242,109 @@ static unsigned int GetNumLevelsOfDetail(
 	
 	return theNumLevelsOfDetail;
 }
+
+static void GetLevelOfDetailDistances(
+	MeshSet			*aMeshSet,				//	may be nil
+	CGSize			anImageSize,			//	in pixels
+	SpaceType		aSpaceType,
+	double			aLevelOfDetailBias,		//	1.0 for full quality, larger to coarsen
+	double			someDistances[MAX_NUM_LOD_LEVELS])	//	output
+{
+	unsigned int	theLevel;
+
+	//	Level 0 serves the nearest tiles.  Each coarser level
+	//	takes over at the distance where it looks good enough,
+	//	but never before the finer level does.
+	//	An absent level never takes over (HUGE_VAL).
+	//	The quality governor's level-of-detail bias tolerates
+	//	a larger screen-space error, so the coarser levels take over sooner.
+	for (theLevel = 0; theLevel < MAX_NUM_LOD_LEVELS; theLevel++)
+	{
+		if (theLevel == 0)
+		{
+			someDistances[theLevel] = 0.0;
+		}
+		else
+		if (aMeshSet != nil && aMeshSet->itsMeshes[theLevel] != nil)
+		{
+			someDistances[theLevel] = fmax(
+				someDistances[theLevel - 1],
+				LevelOfDetailDistance(	aMeshSet->itsMeshes[theLevel]->itsMaxError,
+										aLevelOfDetailBias * MAX_SCREEN_SPACE_ERROR,
+										anImageSize.width,
+										anImageSize.height,
+										aSpaceType));
+		}
+		else
+		{
+			someDistances[theLevel] = HUGE_VAL;
+		}
+	}
+}
+
+
+static void RestrictProjectionToTile(
+	double	aProjectionMatrix[4][4],	//	input and output
+	CGSize	anImageSize,				//	in pixels
+	CGRect	aTile)						//	in pixels, origin at the image's top left
+{
+	double	theTileTransformation[4][4];
+
+	//	Follow aProjectionMatrix with a clip-space scale and offset that
+	//	carries aTile onto the full [-1,+1] × [-1,+1] viewport.
+	//	A pixel x measured from the image's left edge sits at clip-space
+	//	x_clip = 2x/W - 1, so the tile's own clip-space coordinate is
+	//
+	//		x'_clip = x_clip · (W/w) + (W - 2x₀ - w)/w
+	//
+	//	and likewise for y, remembering that clip-space y increases upward
+	//	while pixel rows increase downward.  Because the offset
+	//	multiplies the homogeneous w coordinate, it belongs in the matrix's
+	//	bottom row (the matrices act on row vectors).
+
+	Matrix44Identity(theTileTransformation);
+	theTileTransformation[0][0] = anImageSize.width  / aTile.size.width;
+	theTileTransformation[1][1] = anImageSize.height / aTile.size.height;
+	theTileTransformation[3][0] = (anImageSize.width - 2.0 * aTile.origin.x - aTile.size.width) / aTile.size.width;
+	theTileTransformation[3][1] = (aTile.size.height - anImageSize.height + 2.0 * aTile.origin.y) / aTile.size.height;
+
+	Matrix44Product(aProjectionMatrix, theTileTransformation, aProjectionMatrix);
+}
+
+
+static double GetDisplayFramePeriod(void)
+{
+	NSInteger	theMaxFramesPerSecond;
+
+	//	Aim for the main display's full refresh rate,
+	//	for example 120 frames per second on a ProMotion display.
+	//	The view may later move to a different display,
+	//	but the governor adapts to whatever frame times it sees,
+	//	so a slightly wrong target costs only a little quality.
+	theMaxFramesPerSecond = 0;
+#if TARGET_OS_IOS
+	theMaxFramesPerSecond = [[UIScreen mainScreen] maximumFramesPerSecond];
+#else
+	if (@available(macOS 12.0, *))
+		theMaxFramesPerSecond = [[NSScreen mainScreen] maximumFramesPerSecond];
+#endif
+
+	if (theMaxFramesPerSecond > 0)
+		return 1.0 / (double) theMaxFramesPerSecond;
+	else
+		return DEFAULT_TARGET_FRAME_PERIOD;
+}
+
+
+static NSDictionary<MTKTextureLoaderOption, id> *MakeTextureLoaderOptions(void)
+{
+	return
+	@{
+		MTKTextureLoaderOptionTextureUsage			:	@(MTLTextureUsageShaderRead),
+		MTKTextureLoaderOptionTextureStorageMode	:	@(MTLStorageModePrivate),
+		MTKTextureLoaderOptionAllocateMipmaps		:	@(YES),
+		MTKTextureLoaderOptionGenerateMipmaps		:	@(YES)	//	-newTextureWithName:… ignores this option
+																//		(as confirmed in its documentation).
+																//	Instead, the Asset Catalog provides the mipmaps.
+	};
+}
@@ -0,0 +1,17 @@
+//	CurvedSpacesSpaceCache.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import "CurvedSpaces-Common.h"
+
+
+//	Each space's cache file lives in the app's Caches directory.
+//	aCacheName identifies the space (typically its file path)
+//	and need not be unique, because the cache itself
+//	records a hash of the generator file's full text.
+//	ReadSpaceCacheFile() returns nil if no cache file exists.
+//	Failure to write a cache file is harmless.
+extern NSData	*ReadSpaceCacheFile(NSString *aCacheName);
+extern void		WriteSpaceCacheFile(NSString *aCacheName, const Byte *aCacheData, size_t aCacheSize);
@@ -0,0 +1,70 @@
+//	CurvedSpacesSpaceCache.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesSpaceCache.h"
+
+
+static NSURL	*SpaceCacheURL(NSString *aCacheName);
+
+
+NSData *ReadSpaceCacheFile(NSString *aCacheName)
+{
+	NSURL	*theCacheURL;
+
+	theCacheURL = SpaceCacheURL(aCacheName);
+	if (theCacheURL == nil)
+		return nil;
+
+	//	Memory-map the cached space if possible.
+	//	ConstructPendingSpace() validates its contents,
+	//	so a corrupt or out-of-date file does no harm.
+	return [NSData dataWithContentsOfURL:theCacheURL options:NSDataReadingMappedIfSafe error:NULL];
+}
+
+void WriteSpaceCacheFile(
+	NSString	*aCacheName,
+	const Byte	*aCacheData,
+	size_t		aCacheSize)
+{
+	NSURL	*theCacheURL;
+
+	if (aCacheData == NULL)
+		return;
+
+	theCacheURL = SpaceCacheURL(aCacheName);
+	if (theCacheURL == nil)
+		return;
+
+	[[NSData dataWithBytesNoCopy:(void *)aCacheData length:aCacheSize freeWhenDone:NO]
+		writeToURL:theCacheURL atomically:YES];
+}
+
+
+static NSURL *SpaceCacheURL(NSString *aCacheName)
+{
+	NSURL		*theCachesDirectory,
+				*theSpaceCacheDirectory;
+	NSString	*theFileName;
+
+	if ([aCacheName length] == 0)
+		return nil;
+
+	theCachesDirectory = [[[NSFileManager defaultManager]
+							URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+	if (theCachesDirectory == nil)
+		return nil;
+
+	theSpaceCacheDirectory = [theCachesDirectory URLByAppendingPathComponent:@"Space Cache" isDirectory:YES];
+	if ( ! [[NSFileManager defaultManager] createDirectoryAtURL:theSpaceCacheDirectory
+			withIntermediateDirectories:YES attributes:nil error:NULL] )
+		return nil;
+
+	//	Flatten the space's path into a single file name,
+	//	for example "Flat/Hantzsche Wendt.gen" becomes "Flat-Hantzsche Wendt.gen.cache".
+	theFileName = [[aCacheName stringByReplacingOccurrencesOfString:@"/" withString:@"-"]
+					stringByAppendingPathExtension:@"cache"];
+
+	return [theSpaceCacheDirectory URLByAppendingPathComponent:theFileName isDirectory:NO];
+}
@@ -0,0 +1,60 @@
+//	CurvedSpacesSpaceLoader.h
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import <Foundation/Foundation.h>
+#import "CurvedSpaces-Common.h"
+
+@class GeometryGamesModel;
+
+
+//	A CurvedSpacesSpaceLoader builds a new space's holonomy group,
+//	Dirichlet domain and honeycomb on a background queue,
+//	while the previous space keeps animating, and then swaps
+//	the new space into the ModelData all at once.  The renderer
+//	notices the swap via itsChangeCount and itsDirichletWallsMeshNeedsRefresh,
+//	and re-creates its meshes at the next frame.
+//
+//	A flat or hyperbolic space arrives progressively:  the nearest
+//	few hundred cells appear first, and larger honeycombs replace them
+//	until the tiling reaches the full horizon radius.
+//
+//	Moving the horizon farther likewise builds the larger honeycomb
+//	on the background queue while the current one keeps animating.
+//
+//	All methods must be called on the main thread.
+
+@interface CurvedSpacesSpaceLoader : NSObject
+
+- (id)initWithModel:(GeometryGamesModel *)aModel;
+
+//	Starts loading the given generator file, cancelling any load
+//	that's still in progress.  Calls aCompletionHandler on the main thread,
+//	with ModelData unlocked, once the new space's first installment is installed
+//	(anError == NULL) or has failed to load (anError != NULL,
+//	in which case the previous space remains installed).
+//	If the load gets cancelled, or gets superseded by a newer load,
+//	aCompletionHandler never gets called.
+- (void)loadGeneratorFileContents:(NSData *)someContents cacheName:(NSString *)aCacheName
+	completionHandler:(void (^)(ErrorText anError))aCompletionHandler;
+
+//	Loads the given generator file on the calling thread
+//	before returning.  Useful when the caller needs the new space
+//	immediately, for example to adjust it when making screenshots.
+- (ErrorText)loadGeneratorFileContentsSynchronously:(NSData *)someContents cacheName:(NSString *)aCacheName;
+
+//	Moves the horizon to aHorizonRadius.  A nearer horizon
+//	takes effect immediately, while a farther one takes effect
+//	once its larger honeycomb is ready.  Only one horizon change
+//	runs at a time, and none runs while a space is still arriving,
+//	so a request that comes in meanwhile waits its turn,
+//	superseding any earlier request that's still waiting.
+//	A new space, or a call to -cancel, abandons both.
+//	A failed change leaves the current horizon as it is.
+- (void)changeHorizonRadius:(double)aHorizonRadius;
+
+//	Abandons the load and the horizon change in progress (if any).
+- (void)cancel;
+
+@end
@@ -0,0 +1,382 @@
+//	CurvedSpacesSpaceLoader.m
+//
+//	© 2021 by Jeff Weeks
+//	See TermsOfUse.txt
+
+#import "CurvedSpacesSpaceLoader.h"
+#import "CurvedSpacesSpaceCache.h"
+#import "GeometryGamesModel.h"
+
+
+//	Each load request gets its own cancel flag, so that a request
+//	that's been superseded may still be winding down
+//	while the next request begins.
+@interface CurvedSpacesLoadRequest : NSObject
+{
+@public
+	atomic_bool	itsCancelFlag;
+}
+@end
+
+@implementation CurvedSpacesLoadRequest
+
+- (id)init
+{
+	self = [super init];
+	if (self != nil)
+	{
+		atomic_init(&itsCancelFlag, false);
+	}
+	return self;
+}
+
+@end
+
+
+static ErrorText	ConstructSpaceFromContents(NSData *someContents, NSString *aCacheName,
+						bool aProgressiveFlag, const atomic_bool *aCancelFlag, PendingSpace **aPendingSpace);
+static void			SaveFreshCache(PendingSpace *aPendingSpace, NSString *aCacheName);
+
+
+@implementation CurvedSpacesSpaceLoader
+{
+	GeometryGamesModel * __weak	itsModel;
+
+	//	A serial queue, so that an abandoned construction
+	//	frees its memory before the next one starts allocating.
+	dispatch_queue_t			itsConstructionQueue;
+
+	//	Main thread only
+	CurvedSpacesLoadRequest		*itsCurrentRequest,
+								*itsHorizonRequest;
+	bool						itsHorizonRadiusIsWaiting;
+	double						itsWaitingHorizonRadius;
+}
+
+
+- (id)initWithModel:(GeometryGamesModel *)aModel
+{
+	self = [super init];
+	if (self != nil)
+	{
+		itsModel				= aModel;
+		itsConstructionQueue	= dispatch_queue_create("Curved Spaces space construction",
+									dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
+		itsCurrentRequest		= nil;
+		itsHorizonRequest		= nil;
+		itsHorizonRadiusIsWaiting	= false;
+		itsWaitingHorizonRadius		= 0.0;
+	}
+	return self;
+}
+
+- (void)loadGeneratorFileContents:(NSData *)someContents cacheName:(NSString *)aCacheName
+	completionHandler:(void (^)(ErrorText anError))aCompletionHandler
+{
+	CurvedSpacesLoadRequest	*theRequest;
+
+	[self cancel];
+
+	theRequest			= [[CurvedSpacesLoadRequest alloc] init];
+	itsCurrentRequest	= theRequest;
+
+	dispatch_async(itsConstructionQueue,
+	^{
+		__block PendingSpace	*theNewSpace	= NULL;
+		ErrorText				theError;
+
+		theError = ConstructSpaceFromContents(someContents, aCacheName, true, &theRequest->itsCancelFlag, &theNewSpace);
+
+		dispatch_async(dispatch_get_main_queue(),
+		^{
+			GeometryGamesModel	*theModel;
+			ModelData			*md	= NULL;
+
+			//	Install the new space only if no newer request
+			//	has come along in the meantime.
+			if (theRequest == self->itsCurrentRequest
+			 && ! atomic_load(&theRequest->itsCancelFlag))
+			{
+				theModel = self->itsModel;
+				if (theModel != nil)
+				{
+					if (theError == NULL)
+					{
+						[theModel lockModelData:&md];
+						InstallPendingSpace(md, theNewSpace);
+						[theModel unlockModelData:&md];
+					}
+
+					if (aCompletionHandler != nil)
+						aCompletionHandler(theError);
+				}
+
+				//	If only the nearest cells are ready,
+				//	keep the request current while the rest arrive.
+				if (theModel != nil
+				 && theError == NULL
+				 && ! PendingSpaceIsComplete(theNewSpace))
+				{
+					[self extendPendingSpace:theNewSpace forRequest:theRequest cacheName:aCacheName];
+					theNewSpace = NULL;	//	-extendPendingSpace:… now owns it
+				}
+				else
+				{
+					self->itsCurrentRequest = nil;
+					[self startWaitingHorizonChange];
+				}
+			}
+
+			FreePendingSpace(&theNewSpace);
+		});
+	});
+}
+
+- (void)extendPendingSpace:(PendingSpace *)aPendingSpace forRequest:(CurvedSpacesLoadRequest *)aRequest
+	cacheName:(NSString *)aCacheName
+{
+	//	Build the next, larger honeycomb on the construction queue,
+	//	swap it in on the main thread, and repeat until the space is complete.
+	//	Each installment roughly doubles the number of cells,
+	//	so the user sees the horizon recede in a few quick steps.
+
+	dispatch_async(itsConstructionQueue,
+	^{
+		__block PendingSpace	*theSpace	= aPendingSpace;
+		ErrorText				theError;
+
+		theError = ExtendPendingSpace(theSpace, &aRequest->itsCancelFlag);
+		if (theError == NULL && PendingSpaceIsComplete(theSpace))
+			SaveFreshCache(theSpace, aCacheName);
+
+		dispatch_async(dispatch_get_main_queue(),
+		^{
+			GeometryGamesModel	*theModel;
+			ModelData			*md	= NULL;
+
+			//	A failure here (typically a cancellation) leaves
+			//	the previous installment on display, which is
+			//	a perfectly good space, just with a nearer horizon.
+			if (aRequest == self->itsCurrentRequest
+			 && ! atomic_load(&aRequest->itsCancelFlag))
+			{
+				theModel = self->itsModel;
+				if (theModel != nil && theError == NULL)
+				{
+					[theModel lockModelData:&md];
+					InstallPendingHoneycomb(md, theSpace);
+					[theModel unlockModelData:&md];
+				}
+
+				if (theModel != nil
+				 && theError == NULL
+				 && ! PendingSpaceIsComplete(theSpace))
+				{
+					[self extendPendingSpace:theSpace forRequest:aRequest cacheName:aCacheName];
+					theSpace = NULL;
+				}
+				else
+				{
+					self->itsCurrentRequest = nil;
+					[self startWaitingHorizonChange];
+				}
+			}
+
+			FreePendingSpace(&theSpace);
+		});
+	});
+}
+
+- (ErrorText)loadGeneratorFileContentsSynchronously:(NSData *)someContents cacheName:(NSString *)aCacheName
+{
+	ErrorText		theError;
+	PendingSpace	*theNewSpace	= NULL;
+	ModelData		*md				= NULL;
+
+	[self cancel];
+
+	theError = ConstructSpaceFromContents(someContents, aCacheName, false, NULL, &theNewSpace);
+	if (theError == NULL)
+	{
+		[itsModel lockModelData:&md];
+		InstallPendingSpace(md, theNewSpace);
+		[itsModel unlockModelData:&md];
+	}
+
+	FreePendingSpace(&theNewSpace);
+
+	return theError;
+}
+
+- (void)changeHorizonRadius:(double)aHorizonRadius
+{
+	GeometryGamesModel		*theModel;
+	ModelData				*md					= NULL;
+	ErrorText				theError;
+	__block PendingSpace	*thePendingSpace	= NULL;
+	CurvedSpacesLoadRequest	*theRequest;
+
+	//	Let the load or change in progress, if any, give the tiling
+	//	to the ModelData before the next change begins.
+	if (itsCurrentRequest != nil
+	 || itsHorizonRequest != nil)
+	{
+		itsHorizonRadiusIsWaiting	= true;
+		itsWaitingHorizonRadius		= aHorizonRadius;
+		return;
+	}
+
+	theModel = itsModel;
+	if (theModel == nil)
+		return;
+
+	[theModel lockModelData:&md];
+	theError = BeginHorizonChange(md, aHorizonRadius, &thePendingSpace);
+	[theModel unlockModelData:&md];
+
+	//	If the honeycomb already reached far enough,
+	//	or if the change failed, there's nothing left to do.
+	if (theError != NULL || thePendingSpace == NULL)
+	{
+		FreePendingSpace(&thePendingSpace);
+		return;
+	}
+
+	theRequest			= [[CurvedSpacesLoadRequest alloc] init];
+	itsHorizonRequest	= theRequest;
+
+	dispatch_async(itsConstructionQueue,
+	^{
+		ErrorText	theBuildError;
+
+		theBuildError = FinishHorizonChange(thePendingSpace, &theRequest->itsCancelFlag);
+
+		dispatch_async(dispatch_get_main_queue(),
+		^{
+			GeometryGamesModel	*theModel;
+			ModelData			*md	= NULL;
+
+			//	An abandoned change takes the tiling with it,
+			//	so the next change will tile afresh from the generators.
+			if (theRequest == self->itsHorizonRequest
+			 && ! atomic_load(&theRequest->itsCancelFlag))
+			{
+				theModel = self->itsModel;
+				if (theModel != nil && theBuildError == NULL)
+				{
+					[theModel lockModelData:&md];
+					InstallPendingHoneycomb(md, thePendingSpace);
+					[theModel unlockModelData:&md];
+				}
+
+				self->itsHorizonRequest = nil;
+				[self startWaitingHorizonChange];
+			}
+
+			FreePendingSpace(&thePendingSpace);
+		});
+	});
+}
+
+- (void)startWaitingHorizonChange
+{
+	if (itsHorizonRadiusIsWaiting)
+	{
+		itsHorizonRadiusIsWaiting = false;
+		[self changeHorizonRadius:itsWaitingHorizonRadius];
+	}
+}
+
+- (void)cancel
+{
+	if (itsCurrentRequest != nil)
+	{
+		atomic_store(&itsCurrentRequest->itsCancelFlag, true);
+		itsCurrentRequest = nil;
+	}
+
+	if (itsHorizonRequest != nil)
+	{
+		atomic_store(&itsHorizonRequest->itsCancelFlag, true);
+		itsHorizonRequest = nil;
+	}
+	itsHorizonRadiusIsWaiting = false;
+}
+
+@end
+
+
+static ErrorText ConstructSpaceFromContents(
+	NSData				*someContents,
+	NSString			*aCacheName,
+	bool				aProgressiveFlag,	//	build only the nearest cells for now?
+	const atomic_bool	*aCancelFlag,		//	may be NULL
+	PendingSpace		**aPendingSpace)	//	output
+{
+	ErrorText		theError		= NULL;
+	NSUInteger		theFileSize;
+	const Byte		*theInput		= NULL;
+	Byte			*theRawBytes	= NULL;
+	NSData			*theCacheData	= nil;
+
+	if (someContents == nil)
+		return u"Matrix file is missing or empty.";
+
+	theFileSize = [someContents length];
+	if (GeneratorDataIsBinary((const Byte *) [someContents bytes], theFileSize))
+	{
+		//	A binary file needs no terminating zero, so if someContents
+		//	is memory-mapped, ConstructPendingSpace() may read it in place.
+		theInput = (const Byte *) [someContents bytes];
+	}
+	else
+	{
+		//	Append a terminating zero to the raw data.
+		theRawBytes = (Byte *) GET_MEMORY(theFileSize + 1);	//	allow room for a terminating zero
+		if (theRawBytes == NULL)
+		{
+			theError = u"Couldn't get memory to copy matrices.";
+			goto CleanUpConstructSpaceFromContents;
+		}
+		[someContents getBytes:theRawBytes length:theFileSize];
+		theRawBytes[theFileSize] = 0;	//	terminating zero
+		theInput = theRawBytes;
+	}
+
+	theCacheData = ReadSpaceCacheFile(aCacheName);
+
+	theError = ConstructPendingSpace(	theInput,
+										theFileSize,
+										(const Byte *) [theCacheData bytes],
+										[theCacheData length],
+										true,
+										aProgressiveFlag,
+										aCancelFlag,
+										aPendingSpace);
+	if (theError != NULL)
+		goto CleanUpConstructSpaceFromContents;
+
+	//	A progressively loaded space provides its fresh cache
+	//	only once it's complete.
+	SaveFreshCache(*aPendingSpace, aCacheName);
+
+CleanUpConstructSpaceFromContents:
+
+	FREE_MEMORY_SAFELY(theRawBytes);
+
+	return theError;
+}
+
+static void SaveFreshCache(
+	PendingSpace	*aPendingSpace,
+	NSString		*aCacheName)
+{
+	//	If the cache was missing or stale, save the freshly computed space
+	//	for next time, and then free the fresh cache's memory
+	//	so it doesn't linger while the space is being displayed.
+	if (aPendingSpace->itsFreshCacheData != NULL)
+	{
+		WriteSpaceCacheFile(aCacheName, aPendingSpace->itsFreshCacheData, aPendingSpace->itsFreshCacheSize);
+		FreeSpaceCache(&aPendingSpace->itsFreshCacheData, &aPendingSpace->itsFreshCacheSize);
+	}
+}
@@ -5,6 +5,7 @@
 
 #import "CurvedSpacesGraphicsViewiOS.h"
 #import "CurvedSpacesRenderer.h"
+#import "CurvedSpacesFrameStatistics.h"
 #import "CurvedSpaces-Common.h"
 #import "GeometryGamesModel.h"
 #import "GeometryGamesUtilities-Common.h"
@@ -30,6 +31,9 @@
 //
 #define INCREMENTAL_PITCH_YAW_ROLL_THRESHOLD	0.001
 
+//	How often should the frame statistics overlay refresh?
+#define FRAME_STATISTICS_REFRESH_PERIOD	0.25	//	in seconds
+
 
 static void	ConvertCMRotationMatrixToCurvedSpacesMatrix(CMRotationMatrix *aSrc, Matrix *aDst);
 static bool	IsTwoFingerGesture(UIGestureRecognizer *aGestureRecognizer);
@@ -47,6 +51,8 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 - (void)handleRotationGesture:(UIRotationGestureRecognizer *)aRotationGestureRecognizer;
 - (void)handlePinchGesture:(UIPinchGestureRecognizer *)aPinchGestureRecognizer;
 - (void)handleTapGesture:(UITapGestureRecognizer *)aTapGestureRecognizer;
+- (void)handleFrameStatisticsGesture:(UITapGestureRecognizer *)aTapGestureRecognizer;
+- (void)refreshFrameStatistics:(NSTimer *)aTimer;
 
 - (DisplayPoint)gestureLocationAsDisplayPoint:(CGPoint)aGestureLocation;
 - (DisplayPointMotion)gestureTranslationAsDisplayPointMotion:(CGPoint)aGestureTranslation;
@@ -63,6 +69,10 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 	//	of the previous device attitude.
 	bool	itsPreviousDeviceAttitudeHasBeenInitialized;
 	Matrix	itsPreviousDeviceAttitude;
+
+	//	The frame statistics overlay exists only while it's visible.
+	UILabel	*itsFrameStatisticsLabel;
+	NSTimer	*itsFrameStatisticsTimer;
 }
 
 
@@ -73,7 +83,8 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 								*theTwoFingerPanGestureRecognizer;
 	UIRotationGestureRecognizer	*theRotationGestureRecognizer;
 	UIPinchGestureRecognizer	*thePinchGestureRecognizer;
-	UITapGestureRecognizer		*theTapGestureRecognizer;
+	UITapGestureRecognizer		*theTapGestureRecognizer,
+								*theFrameStatisticsGestureRecognizer;
 
 	self = [super initWithModel:aModel frame:aFrame];
 	if (self != nil)
@@ -137,6 +148,15 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 		[theTapGestureRecognizer setNumberOfTouchesRequired:1];
 		[theTapGestureRecognizer setDelegate:self];
 		[self addGestureRecognizer:theTapGestureRecognizer];
+
+		//	A three-finger double tap shows or hides the frame statistics.
+		theFrameStatisticsGestureRecognizer	= [[UITapGestureRecognizer alloc]
+												initWithTarget:	self
+												action:			@selector(handleFrameStatisticsGesture:)];
+		[theFrameStatisticsGestureRecognizer setNumberOfTapsRequired:2];
+		[theFrameStatisticsGestureRecognizer setNumberOfTouchesRequired:3];
+		[theFrameStatisticsGestureRecognizer setDelegate:self];
+		[self addGestureRecognizer:theFrameStatisticsGestureRecognizer];
 	}
 	return self;
 }
@@ -146,7 +166,8 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 	ModelData	*md	= NULL;
 
 	//	In the case of a GeometryGamesGraphicsViewiOS, a call to -layoutSubviews
-	//	has absolutely nothing to do with subviews, because the view has no subviews.
+	//	has almost nothing to do with subviews, because the view's only possible subview
+	//	is the frame statistics overlay, which positions itself.
 	//	Rather the call is telling us that the view's dimensions may have changed.
 
 	//	Let the GeometryGamesGraphicsViewiOS implementation of this method resize the framebuffer.
@@ -432,6 +453,56 @@ static void	PrintApertureToConsole(GeometryGamesModel *aModel);
 	}
 }
 
+- (void)handleFrameStatisticsGesture:(UITapGestureRecognizer *)aTapGestureRecognizer
+{
+	if ([aTapGestureRecognizer state] != UIGestureRecognizerStateRecognized)
+		return;
+
+	if (itsFrameStatisticsLabel == nil)
+	{
+		itsFrameStatisticsLabel = [[UILabel alloc] initWithFrame:CGRectZero];
+		[itsFrameStatisticsLabel setNumberOfLines:0];
+		[itsFrameStatisticsLabel setFont:[UIFont fontWithName:@"Menlo" size:11.0]];
+		[itsFrameStatisticsLabel setTextColor:[UIColor whiteColor]];
+		[itsFrameStatisticsLabel setBackgroundColor:[UIColor colorWithWhite:0.0 alpha:0.5]];
+		[self addSubview:itsFrameStatisticsLabel];
+
+		itsFrameStatisticsTimer = [NSTimer
+			scheduledTimerWithTimeInterval:	FRAME_STATISTICS_REFRESH_PERIOD
+			target:							self
+			selector:						@selector(refreshFrameStatistics:)
+			userInfo:						nil
+			repeats:						YES];
+
+		[self refreshFrameStatistics:nil];
+	}
+	else
+	{
+		//	Invalidating the timer releases its reference to self.
+		[itsFrameStatisticsTimer invalidate];
+		itsFrameStatisticsTimer = nil;
+
+		[itsFrameStatisticsLabel removeFromSuperview];
+		itsFrameStatisticsLabel = nil;
+	}
+}
+
+- (void)refreshFrameStatistics:(NSTimer *)aTimer
+{
+	CGRect	theSafeArea;
+
+	UNUSED_PARAMETER(aTimer);
+
+	[itsFrameStatisticsLabel setText:FrameStatisticsSummary()];
+	[itsFrameStatisticsLabel sizeToFit];
+
+	//	Keep the overlay clear of the notch and the home indicator.
+	theSafeArea = UIEdgeInsetsInsetRect([self bounds], [self safeAreaInsets]);
+	[itsFrameStatisticsLabel setFrame:(CGRect){
+		{theSafeArea.origin.x + 8.0, theSafeArea.origin.y + 8.0},
+		[itsFrameStatisticsLabel frame].size}];
+}
+
 - (DisplayPoint)gestureLocationAsDisplayPoint:(CGPoint)aGestureLocation
 {
 	CGRect			theViewBounds;
@@ -5,7 +5,8 @@
 
 #import "CurvedSpacesRootController.h"
 #import "CurvedSpacesGraphicsViewiOS.h"
-#import "CurvedSpaces-Common.h"	//	for LoadGeneratorFile()
+#import "CurvedSpaces-Common.h"
+#import "CurvedSpacesSpaceLoader.h"
 #import "GeometryGamesModel.h"
 #import "GeometryGamesUtilities-iOS.h"
 #import "GeometryGamesUtilities-Mac-iOS.h"
@@ -25,6 +26,11 @@
 - (void)userTappedToolbarButton:(id)sender;
 - (void)userSlidSpeedSlider:(id)sender;
 
+- (void)openGeneratorFile:(NSString *)aGeneratorFileRelativePath;
+- (void)openGeneratorFileSynchronously:(NSString *)aGeneratorFileRelativePath;
+- (NSData *)contentsOfGeneratorFile:(NSString *)aGeneratorFileRelativePath;
+- (void)refreshSpeedSlider;
+
 @end
 
 
@@ -46,6 +52,11 @@
 								*itsHelpButton;
 	
 	NSString					*itsGeneratorFileRelativePath;	//	e.g. "Flat/Hantzsche Wendt.gen"
+
+	//	Builds new spaces in the background.
+	CurvedSpacesSpaceLoader		*itsSpaceLoader;
+	bool						itsSpaceIsLoading,
+								itsDodecahedralAlignmentAdjustmentIsPending;
 }
 
 
@@ -56,6 +67,9 @@
 	{
 		itsMotionManager				= aMotionManager;
 		itsGeneratorFileRelativePath	= nil;	//	redundant, but makes our intentions clear
+		itsSpaceLoader					= [[CurvedSpacesSpaceLoader alloc] initWithModel:itsModel];
+		itsSpaceIsLoading				= false;
+		itsDodecahedralAlignmentAdjustmentIsPending	= false;
 
 #ifdef SCREENSHOT_FOR_GEOMETRY_GAMES_CURVED_SPACES_PAGE
 		[self openGeneratorFile:@"Basic/Mirrored Dodecahedron.gen"];	//	sets itsGeneratorFileRelativePath
@@ -372,7 +386,9 @@
 								default:
 									GEOMETRY_GAMES_ABORT("Invalid value of theScreenshotIndex");
 							}
-							[self openGeneratorFile:theGeneratorFileRelativePath];	//	sets itsGeneratorFileRelativePath
+							//	Load synchronously, so the adjustments below
+							//	apply to the new space.
+							[self openGeneratorFileSynchronously:theGeneratorFileRelativePath];	//	sets itsGeneratorFileRelativePath
 
 							[self->itsModel lockModelData:&md];
 
@@ -847,18 +863,55 @@
 
 - (void)openGeneratorFile:(NSString *)aGeneratorFileRelativePath	//	e.g. "Flat/Hantzsche Wendt.gen"
 {
-	ErrorText		theErrorText1,
-					theErrorText2;
+	itsGeneratorFileRelativePath					= aGeneratorFileRelativePath;
+	itsSpaceIsLoading								= true;
+	itsDodecahedralAlignmentAdjustmentIsPending		= false;
+
+	//	Build the new space on a background queue,
+	//	while the current space keeps animating.
+	[itsSpaceLoader loadGeneratorFileContents:[self contentsOfGeneratorFile:aGeneratorFileRelativePath]
+		cacheName:aGeneratorFileRelativePath
+		completionHandler:^(ErrorText anError)
+		{
+			GEOMETRY_GAMES_ASSERT(anError == NULL, "failed to load generators (see anError for more info)");
+
+			self->itsSpaceIsLoading = false;
+
+			//	The adjustment must wait until the new space
+			//	has reset the user's placement.
+			if (self->itsDodecahedralAlignmentAdjustmentIsPending)
+			{
+				self->itsDodecahedralAlignmentAdjustmentIsPending = false;
+				[self spaceNeedsDodecahedralAlignmentAdjustment];
+			}
+
+			[self refreshSpeedSlider];
+		}];
+}
+
+- (void)openGeneratorFileSynchronously:(NSString *)aGeneratorFileRelativePath	//	e.g. "Flat/Hantzsche Wendt.gen"
+{
+	ErrorText	theErrorText;
+
+	itsGeneratorFileRelativePath					= aGeneratorFileRelativePath;
+	itsSpaceIsLoading								= false;
+	itsDodecahedralAlignmentAdjustmentIsPending		= false;
+
+	theErrorText = [itsSpaceLoader loadGeneratorFileContentsSynchronously:[self contentsOfGeneratorFile:aGeneratorFileRelativePath]
+					cacheName:aGeneratorFileRelativePath];
+	GEOMETRY_GAMES_ASSERT(theErrorText == NULL, "failed to load generators (see theErrorText for more info)");
+
+	[self refreshSpeedSlider];
+}
+
+- (NSData *)contentsOfGeneratorFile:(NSString *)aGeneratorFileRelativePath	//	e.g. "Flat/Hantzsche Wendt.gen"
+{
 	NSUInteger		thePathNameLength;
 	Char16			*theGeneratorFileRelativePath;
-	ModelData		*md									= NULL;
-	unsigned int	theFileSize							= 0;
-	Byte			*theFileContents					= NULL,
-					*theFileContentsWithTerminatingZero	= NULL;
-	double			theUserSpeed;
-	
-	itsGeneratorFileRelativePath = aGeneratorFileRelativePath;
-	
+	unsigned int	theFileSize		= 0;
+	Byte			*theFileContents	= NULL;
+	NSData			*theContents		= nil;
+
 	thePathNameLength				= [aGeneratorFileRelativePath length];	//	returns 0 if aGeneratorFileRelativePath == nil
 	theGeneratorFileRelativePath	= (Char16 *) GET_MEMORY( (thePathNameLength + 1) * sizeof(Char16) );
 	[aGeneratorFileRelativePath getCharacters:theGeneratorFileRelativePath range:NSMakeRange(0, thePathNameLength)];
@@ -866,29 +919,21 @@
 
 	if (theGeneratorFileRelativePath != NULL)	//	should never fail
 	{
-		theErrorText1 = GetFileContents(u"Sample Spaces", theGeneratorFileRelativePath, &theFileSize, &theFileContents);
-		if (theErrorText1 == NULL)
-		{
-			theFileContentsWithTerminatingZero = (Byte *) GET_MEMORY( (theFileSize + 1) * sizeof(Byte) );
-			memcpy(theFileContentsWithTerminatingZero, theFileContents, theFileSize);
-			theFileContentsWithTerminatingZero[theFileSize] = 0;
-
-			[itsModel lockModelData:&md];
-
-			//	Caution:  Depending on why LoadGeneratorFile() fails,
-			//	it may or may not free the honeycomb and Dirichlet domain.
-			theErrorText2 = LoadGeneratorFile(md, theFileContentsWithTerminatingZero);
-			GEOMETRY_GAMES_ASSERT(theErrorText2 == NULL, "failed to load generators (see theErrorText2 for more info)");
-
-			[itsModel unlockModelData:&md];
-
-			FREE_MEMORY_SAFELY(theFileContentsWithTerminatingZero);
-		}
+		if (GetFileContents(u"Sample Spaces", theGeneratorFileRelativePath, &theFileSize, &theFileContents) == NULL)
+			theContents = [NSData dataWithBytes:theFileContents length:theFileSize];
 		FreeFileContents(&theFileSize, &theFileContents);
 	}
 
 	FREE_MEMORY_SAFELY(theGeneratorFileRelativePath);
 
+	return theContents;	//	nil if the file couldn't be read
+}
+
+- (void)refreshSpeedSlider
+{
+	ModelData	*md	= NULL;
+	double		theUserSpeed;
+
 	[itsModel lockModelData:&md];
 	theUserSpeed = md->itsUserSpeed;
 	[itsModel unlockModelData:&md];
@@ -899,6 +944,14 @@
 {
 	ModelData	*md	= NULL;
 
+	//	If the space is still loading, apply the adjustment
+	//	once it's ready.  See -openGeneratorFile:.
+	if (itsSpaceIsLoading)
+	{
+		itsDodecahedralAlignmentAdjustmentIsPending = true;
+		return;
+	}
+
 	//	On the one hand, a dodecahedron aligns most naturally
 	//	with a rectangular coordinate system when the coordinate system's
 	//	x-, y- and z-axes run through the midpoints
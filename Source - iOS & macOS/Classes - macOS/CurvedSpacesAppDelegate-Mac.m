@@ -68,15 +68,15 @@ const HelpPageInfo gHelpInfo[NumHelpTypes] =
 	itsHelpPageIndex	= HelpNone;
 	itsHelpPageInfo		= gHelpInfo;
 	
-	//	Curved Spaces is a single-window app, so no tab bar is needed.
-	//	(By default, macOS 10.12 enables window tabbing, and automatically
+	//	Each Curved Spaces window shows its own space full-size,
+	//	so no tab bar is needed.  (By default, macOS 10.12 enables window tabbing, and automatically
 	//	inserts a Show Tab Bar item at the top of the View menu.)
 	[NSWindow setAllowsAutomaticWindowTabbing:NO];
 
 	//	Create a window.
-	//	Typically the window created here will be the only one,
-	//	but if ALLOW_MULTIPLE_WINDOWS is defined,
-	//	the user may choose File : New Window to create additional windows.
+	//	If ALLOW_MULTIPLE_WINDOWS is defined,
+	//	the user may choose File : New Window to create additional windows,
+	//	for example to compare two spaces side by side.
 	[itsWindowControllers addObject:[[CurvedSpacesWindowController alloc] initWithDelegate:self]];
 	
 	if (GetUserPrefBool(u"is first launch"))
@@ -158,14 +158,11 @@ const HelpPageInfo gHelpInfo[NumHelpTypes] =
 
 #ifdef ALLOW_MULTIPLE_WINDOWS
 	//	For the most part, the Geometry Games software doesn't save files,
-	//	so it makes no sense to have a File menu.  Moreover, there's little need
-	//	to open more than one window at once, and doing so could slow
-	//	the animations' frame rates.  Nevertheless, just for testing purposes,
-	//	here's a File menu that lets the user open and close windows.
+	//	so the File menu serves only to open and close windows.
 	theMenu = AddSubmenuWithTitle(theMenuBar, u"File");
-		[theMenu addItemWithTitle:@"New Window"
+		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"New Window")
 			action:@selector(commandNewWindow:) keyEquivalent:@"n"];
-		[theMenu addItemWithTitle:@"Close Window"
+		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"Close Window")
 			action:@selector(performClose:) keyEquivalent:@"w"];
 	theMenu = nil;
 #endif
@@ -193,6 +190,12 @@ const HelpPageInfo gHelpInfo[NumHelpTypes] =
 		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"Fog")
 			action:@selector(commandFog:) keyEquivalent:@""];
 
+		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"Nearer Horizon")
+			action:@selector(commandNearerHorizon:) keyEquivalent:@"["];
+
+		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"Farther Horizon")
+			action:@selector(commandFartherHorizon:) keyEquivalent:@"]"];
+
 		[theMenu addItemWithTitle:GetLocalizedTextAsNSString(u"Color Coding")
 			action:@selector(commandColorCoding:) keyEquivalent:@""];
 
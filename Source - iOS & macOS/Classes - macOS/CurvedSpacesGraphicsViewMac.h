@@ -4,6 +4,7 @@
 //	See TermsOfUse.txt
 
 #import "GeometryGamesGraphicsViewMac.h"
+#import "CurvedSpaces-Common.h"	//	for #definition of RUN_BENCHMARKS
 
 
 @interface CurvedSpacesGraphicsViewMac : GeometryGamesGraphicsViewMac <NSGestureRecognizerDelegate>
@@ -13,6 +14,10 @@
 - (void)keyDown:(NSEvent *)anEvent;
 - (void)mouseDragged:(NSEvent *)anEvent;
 
+#ifdef RUN_BENCHMARKS
+- (void)runBenchmarks;
+#endif
+
 //	NSGestureRecognizerDelegate
 - (BOOL)gestureRecognizer:(NSGestureRecognizer *)gestureRecognizer
 	shouldRecognizeSimultaneouslyWithGestureRecognizer:(NSGestureRecognizer *)otherGestureRecognizer;
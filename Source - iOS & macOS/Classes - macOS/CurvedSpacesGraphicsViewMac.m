@@ -6,6 +6,10 @@
 #import "CurvedSpacesGraphicsViewMac.h"
 #import "CurvedSpaces-Common.h"
 #import "CurvedSpacesRenderer.h"
+#import "CurvedSpacesFrameStatistics.h"
+#ifdef RUN_BENCHMARKS
+#import "CurvedSpacesBenchmark.h"
+#endif
 #import "GeometryGamesModel.h"
 #import "GeometryGamesUtilities-Common.h"
 #import "GeometryGamesUtilities-Mac.h"
@@ -16,16 +20,24 @@
 //	how much should the aperture change?
 #define APERTURE_INCREMENT	0.125
 
+//	How often should the frame statistics overlay refresh?
+#define FRAME_STATISTICS_REFRESH_PERIOD	0.25	//	in seconds
+
 
 //	Privately-declared properties and methods
 @interface CurvedSpacesGraphicsViewMac()
 - (void)handleRotation:(NSRotationGestureRecognizer *)aRotationGestureRecognizer;
 - (void)handlePinch:(NSMagnificationGestureRecognizer *)aPinchGestureRecognizer;
+- (void)toggleFrameStatistics;
+- (void)refreshFrameStatistics:(NSTimer *)aTimer;
 @end
 
 
 @implementation CurvedSpacesGraphicsViewMac
 {
+	//	The frame statistics overlay exists only while it's visible.
+	NSTextField	*itsFrameStatisticsLabel;
+	NSTimer		*itsFrameStatisticsTimer;
 }
 
 
@@ -114,6 +126,10 @@
 			break;
 #endif
 
+		case 3:		//	Key code for the 'f' key, which stands for "frame statistics"
+			[self toggleFrameStatistics];
+			break;
+
 #ifdef PRINT_USER_BODY_PLACEMENT
 		case 35:	//	Key code for the 'p' key, which stands for "print user body placement"
 			[itsModel lockModelData:&md];
@@ -243,6 +259,79 @@
 #pragma mark -
 #pragma mark NSGestureRecognizerDelegate
 
+- (void)toggleFrameStatistics
+{
+	if (itsFrameStatisticsLabel == nil)
+	{
+		itsFrameStatisticsLabel = [NSTextField labelWithString:@""];
+		[itsFrameStatisticsLabel setFont:[NSFont monospacedSystemFontOfSize:11.0 weight:NSFontWeightRegular]];
+		[itsFrameStatisticsLabel setTextColor:[NSColor whiteColor]];
+		[itsFrameStatisticsLabel setDrawsBackground:YES];
+		[itsFrameStatisticsLabel setBackgroundColor:[NSColor colorWithWhite:0.0 alpha:0.5]];
+		[itsFrameStatisticsLabel setFrameOrigin:(NSPoint){8.0, 8.0}];
+		[self addSubview:itsFrameStatisticsLabel];
+
+		itsFrameStatisticsTimer = [NSTimer
+			scheduledTimerWithTimeInterval:	FRAME_STATISTICS_REFRESH_PERIOD
+			target:							self
+			selector:						@selector(refreshFrameStatistics:)
+			userInfo:						nil
+			repeats:						YES];
+
+		[self refreshFrameStatistics:nil];
+	}
+	else
+	{
+		//	Invalidating the timer releases its reference to self.
+		[itsFrameStatisticsTimer invalidate];
+		itsFrameStatisticsTimer = nil;
+
+		[itsFrameStatisticsLabel removeFromSuperview];
+		itsFrameStatisticsLabel = nil;
+	}
+}
+
+- (void)refreshFrameStatistics:(NSTimer *)aTimer
+{
+	UNUSED_PARAMETER(aTimer);
+
+	[itsFrameStatisticsLabel setStringValue:FrameStatisticsSummary()];
+	[itsFrameStatisticsLabel sizeToFit];
+}
+
+
+#ifdef RUN_BENCHMARKS
+
+- (void)runBenchmarks
+{
+	CurvedSpacesBenchmark	*theBenchmark;
+	NSURL					*theReportURL;
+
+	//	Run the benchmark suite on a background thread,
+	//	and write the report to the user's Documents folder.
+	theBenchmark	= [[CurvedSpacesBenchmark alloc] initWithRenderer:(CurvedSpacesRenderer *)itsRenderer model:itsModel];
+	theReportURL	= [[[NSFileManager defaultManager] URLsForDirectory:NSDocumentDirectory inDomains:NSUserDomainMask][0]
+						URLByAppendingPathComponent:@"Curved Spaces Benchmark.json"];
+
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0),
+	^{
+		ErrorText	theError;
+
+		theError = [theBenchmark runWritingReportToURL:theReportURL];
+
+		dispatch_async(dispatch_get_main_queue(),
+		^{
+			if (theError != NULL)
+				GeometryGamesErrorMessage(theError, u"Benchmark failed");
+			else
+				printf("Benchmark report written to %s\n", [[theReportURL path] UTF8String]);
+		});
+	});
+}
+
+#endif	//	RUN_BENCHMARKS
+
+
 - (BOOL)gestureRecognizer:(NSGestureRecognizer *)gestureRecognizer
 	shouldRecognizeSimultaneouslyWithGestureRecognizer:(NSGestureRecognizer *)otherGestureRecognizer
 {
@@ -5,6 +5,7 @@
 
 #import "CurvedSpacesWindowController.h"
 #import "CurvedSpacesGraphicsViewMac.h"
+#import "CurvedSpacesSpaceLoader.h"
 #import "GeometryGamesModel.h"
 #import "GeometryGamesWindowMac.h"
 #import "GeometryGamesUtilities-Mac-iOS.h"
@@ -62,6 +63,9 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 	//	(Similar to NSWindow's representedFilename, 
 	//	but fully under our control.)
 	NSString	*itsGeneratorFilePath;	//	keeps a copy
+
+	//	Builds new spaces in the background.
+	CurvedSpacesSpaceLoader	*itsSpaceLoader;
 }
 
 
@@ -75,6 +79,8 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 		itsOutlineView			= nil;
 		itsSpaceSelectionWindow	= nil;
 
+		itsSpaceLoader			= [[CurvedSpacesSpaceLoader alloc] initWithModel:itsModel];
+
 #if (defined(CENTERPIECE_DISPLACEMENT)	\
   || defined(START_OUTSIDE))
 //	Note:  For START_STILL we want to wait a few seconds, long enough to say
@@ -88,6 +94,11 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 		[itsWindow toggleFullScreen:self];
 #endif
 
+#ifdef RUN_BENCHMARKS
+		//	Skip the space selection and run the benchmark suite,
+		//	which loads each Sample Space in turn.
+		[itsCurvedSpacesView performSelector:@selector(runBenchmarks) withObject:nil afterDelay:0.5];
+#else
 		if (GetUserPrefBool(u"is first launch"))
 		{
 			//	The Help window will already be open, so to avoid clutter,
@@ -104,6 +115,7 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 			//	so the user sees the sheet animate gracefully into place.
 			[self performSelector:@selector(commandChooseSpace:) withObject:self afterDelay:0.125];
 		}
+#endif
 	}
 
 	return self;
@@ -128,6 +140,9 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 //	when waiting for a possible CVDisplayLink callback to complete.
 - (void)windowWillClose:(NSNotification *)aNotification
 {
+	//	Abandon any space that's still being built.
+	[itsSpaceLoader cancel];
+
 	//	Stop the CVDisplayLink and wait for it to finish drawing.
 	[itsCurvedSpacesView pauseAnimation];	//	ModelData must not be locked, to avoid deadlock
 											//	when waiting for a possible CVDisplayLink callback to complete.
@@ -267,6 +282,16 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 		return YES;
 	}
 
+	if (theAction == @selector(commandNearerHorizon:)
+	 || theAction == @selector(commandFartherHorizon:))
+	{
+		[itsModel lockModelData:&md];
+		theEnableFlag = HorizonStepIsPossible(md, theAction == @selector(commandFartherHorizon:));
+		[itsModel unlockModelData:&md];
+
+		return theEnableFlag;
+	}
+
 	return [super validateMenuItem:aMenuItem];
 }
 
@@ -362,6 +387,33 @@ static bool					OpenContainingDirectoriesAndSelectItem(NSOutlineView *anOutlineV
 	[itsModel unlockModelData:&md];
 }
 
+- (void)commandNearerHorizon:(id)sender
+{
+	[self stepHorizon:false];
+}
+
+- (void)commandFartherHorizon:(id)sender
+{
+	[self stepHorizon:true];
+}
+
+- (void)stepHorizon:(bool)aFartherFlag
+{
+	ModelData	*md	= NULL;
+	bool		theStepFlag;
+	double		theHorizonRadius;
+
+	[itsModel lockModelData:&md];
+	theStepFlag			= HorizonStepIsPossible(md, aFartherFlag);
+	theHorizonRadius	= StepRequestedHorizonRadius(md, aFartherFlag);
+	[itsModel unlockModelData:&md];
+
+	//	The space loader builds a farther horizon's honeycomb
+	//	in the background and installs it when it's ready.
+	if (theStepFlag)
+		[itsSpaceLoader changeHorizonRadius:theHorizonRadius];
+}
+
 
 - (void)languageDidChange
 {
@@ -820,55 +872,38 @@ static bool OpenContainingDirectoriesAndSelectItem(
 
 - (void)openGeneratorFile:(NSString *)aFilePath	//	full pathname
 {
-	ErrorText		theError		= NULL;
-	NSData			*theRawData		= nil;
-	unsigned int	theFileSize		= 0;
-	Byte			*theRawBytes	= NULL;
-	ModelData		*md				= NULL;
-
-	//	Read the file's raw bytes.
-	theRawData = [NSData dataWithContentsOfFile:aFilePath];
-	if (theRawData == NULL)
-	{
-		theError = u"Matrix file is missing or empty.";
-		goto CleanUpOpenGeneratorFile;
-	}
-	
-	//	Append a terminating zero to the raw data.
-	theFileSize = (unsigned int)[theRawData length];
-	theRawBytes = (Byte *) GET_MEMORY(theFileSize + 1);	//	allow room for a terminating zero
-	if (theRawBytes == NULL)
-	{
-		theError = u"Could get memory to copy matrices.";
-		goto CleanUpOpenGeneratorFile;
-	}
-	[theRawData getBytes:theRawBytes length:theFileSize];
-	theRawBytes[theFileSize] = 0;	//	terminating zero
-
-	//	Try to parse the file.
-	[itsModel lockModelData:&md];
-	theError = LoadGeneratorFile(md, theRawBytes);
-	[itsModel unlockModelData:&md];
-	if (theError != NULL)
-		goto CleanUpOpenGeneratorFile;
+	NSData	*theRawData;
 
-	//	Set the window title.
-//	[itsWindow setTitleWithRepresentedFilename:aFilePath];	//	window name includes .gen suffix
-	itsGeneratorFilePath = [aFilePath copy];
-	[itsWindow setTitle:[[itsGeneratorFilePath lastPathComponent] stringByDeletingPathExtension]];
+	//	Read the file's raw bytes.  Map rather than copy them when possible,
+	//	so a large binary generator file gets read in place.
+	theRawData = [NSData dataWithContentsOfFile:aFilePath options:NSDataReadingMappedIfSafe error:NULL];
 
+	//	Build the new space on a background queue,
+	//	while the current space keeps animating.
+	[itsSpaceLoader loadGeneratorFileContents:theRawData cacheName:aFilePath
+		completionHandler:^(ErrorText anError)
+		{
 #ifdef HANTZSCHE_WENDT_AXES
-	[itsModel lockModelData:&md];
-	md->itsHantzscheWendtSpaceIsLoaded = [[aFilePath lastPathComponent] isEqualToString:@"Hantzsche Wendt.gen"];
-	[itsModel unlockModelData:&md];
+			ModelData	*md	= NULL;
 #endif
 
-CleanUpOpenGeneratorFile:
+			if (anError != NULL)
+			{
+				GeometryGamesErrorMessage(anError, u"Error reading matrix file");
+				return;
+			}
 
-	FREE_MEMORY_SAFELY(theRawBytes);
-	
-	if (theError != NULL)
-		GeometryGamesErrorMessage(theError, u"Error reading matrix file");
+			//	Set the window title.
+//			[self->itsWindow setTitleWithRepresentedFilename:aFilePath];	//	window name includes .gen suffix
+			self->itsGeneratorFilePath = [aFilePath copy];
+			[self->itsWindow setTitle:[[self->itsGeneratorFilePath lastPathComponent] stringByDeletingPathExtension]];
+
+#ifdef HANTZSCHE_WENDT_AXES
+			[self->itsModel lockModelData:&md];
+			md->itsHantzscheWendtSpaceIsLoaded = [[aFilePath lastPathComponent] isEqualToString:@"Hantzsche Wendt.gen"];
+			[self->itsModel unlockModelData:&md];
+#endif
+		}];
 }
 
 @end